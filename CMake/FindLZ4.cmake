@@ -0,0 +1,28 @@
+# - Try to find LZ4
+# Once done this will define
+#  LZ4_FOUND - System has LZ4
+#  LZ4_INCLUDE_DIRS - The LZ4 include directories
+#  LZ4_LIBRARIES - The libraries needed to use LZ4
+
+find_package(PkgConfig)
+pkg_check_modules(PC_LZ4 liblz4)
+
+find_path(LZ4_INCLUDE_DIR lz4.h
+  HINTS ${PC_LZ4_INCLUDEDIR} ${PC_LZ4_INCLUDE_DIRS}
+  PATHS /usr/local/include /usr/include)
+
+find_library(LZ4_LIBRARY NAMES lz4
+  HINTS ${PC_LZ4_LIBDIR} ${PC_LZ4_LIBRARY_DIRS}
+  PATHS /usr/local/lib64 /usr/local/lib /usr/lib64 /usr/lib)
+
+set(LZ4_INCLUDE_DIRS ${LZ4_INCLUDE_DIR})
+set(LZ4_LIBRARIES ${LZ4_LIBRARY})
+
+include(FindPackageHandleStandardArgs)
+# handle the QUIETLY and REQUIRED arguments and set LZ4_FOUND to TRUE
+# if all listed variables are TRUE
+find_package_handle_standard_args(LZ4 DEFAULT_MSG
+                                  LZ4_INCLUDE_DIR LZ4_LIBRARY)
+
+mark_as_advanced(LZ4_INCLUDE_DIR LZ4_LIBRARY)
+
@@ -0,0 +1,1800 @@
+/*
+ * Copyright (C) 2013-2017 Argonne National Laboratory, Department of Energy,
+ *                    UChicago Argonne, LLC and The HDF Group.
+ * All rights reserved.
+ *
+ * The full copyright notice, including terms governing use, modification,
+ * and redistribution, is contained in the COPYING file that can be
+ * found at the root of the source code distribution tree.
+ */
+
+/*
+ * hg_bench: micro-benchmark suite for the NA and HG layers.
+ *
+ * Origin and target run within a single process: the target uses its own
+ * class (and NA class for NA benchmarks) progressed by a dedicated thread,
+ * so that the suite only needs a plugin that works on one node (na+sm by
+ * default) and no MPI or test driver. Results are written as a text table,
+ * CSV or JSON for regression tracking. Latencies are round-trip times.
+ *
+ * Closed-loop benchmarks keep a fixed number of RPCs in flight, rpc_open
+ * instead issues RPCs at a fixed or Poisson offered rate and measures
+ * latency from each RPC's scheduled send time, so that stalls show up in
+ * the tail instead of lowering the sending rate.
+ */
+
+#include "mercury_bench.h"
+
+#include "mercury.h"
+#include "mercury_bulk.h"
+#include "mercury_proc.h"
+#include "na.h"
+
+#include "mercury_atomic.h"
+#include "mercury_thread.h"
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/****************/
+/* Local Macros */
+/****************/
+
+#define HG_BENCH_NA_INFO        "na+sm"
+#define HG_BENCH_ITERATIONS     10000
+#define HG_BENCH_WARMUP         100
+#define HG_BENCH_MAX_SIZE       (64 * 1024)
+#define HG_BENCH_MAX_BULK_SIZE  (4 * 1024 * 1024)
+#define HG_BENCH_MIN_BULK_SIZE  (4 * 1024)
+#define HG_BENCH_MIN_SEGMENT    1024
+#define HG_BENCH_MAX_SEGMENTS   64
+#define HG_BENCH_MAX_THREADS    4
+#define HG_BENCH_WINDOW         16
+
+/* Open-loop defaults: offered rates (RPC/s), run time per rate (ms) and
+ * handles available to keep RPCs in flight */
+#define HG_BENCH_RATES          "1000,2000,5000,10000,20000,50000,100000"
+#define HG_BENCH_DURATION       1000
+#define HG_BENCH_OPEN_HANDLES   256
+
+/* Operations per sample for benchmarks too short to time individually */
+#define HG_BENCH_BATCH          100
+
+/* Progress timeout (ms) */
+#define HG_BENCH_TIMEOUT        100
+
+#define HG_BENCH_ADDR_MAX       256
+
+/************************************/
+/* Local Type and Struct Definition */
+/************************************/
+
+struct hg_bench_options {
+    const char *na_info;            /* NA info string */
+    const char *benchmarks;         /* Comma separated list or NULL for all */
+    const char *output_name;        /* Output file name or NULL for stdout */
+    hg_bench_format_t format;       /* Output format */
+    unsigned int iterations;        /* Iterations for small sizes */
+    unsigned int warmup;            /* Warmup iterations */
+    size_t max_size;                /* Max RPC payload size */
+    size_t max_bulk_size;           /* Max bulk transfer size */
+    unsigned int max_threads;       /* Max number of origin threads */
+    unsigned int window;            /* RPCs in flight per thread */
+    const char *rates;              /* Open-loop offered rates */
+    unsigned int duration;          /* Open-loop run time per rate (ms) */
+    unsigned int open_handles;      /* Open-loop max RPCs in flight */
+    hg_bool_t poisson;              /* Open-loop Poisson arrivals */
+};
+
+struct hg_bench_info {
+    struct hg_bench_options options;
+    struct hg_bench_output output;
+
+    /* Target */
+    hg_class_t *server_class;
+    hg_context_t *server_context;
+    hg_thread_t server_thread;
+    hg_atomic_int32_t server_stop;
+    void *server_buf;
+    hg_bulk_t server_bulk;
+
+    /* Origin */
+    hg_class_t *client_class;
+    hg_context_t *client_context;
+    hg_addr_t target_addr;
+    hg_id_t rpc_id;
+    hg_id_t bulk_id;
+};
+
+/* Echo RPC input / output */
+struct hg_bench_rpc_in {
+    hg_uint32_t size;
+    void *buf;
+};
+
+/* Bulk RPC input */
+struct hg_bench_bulk_in {
+    hg_bulk_t bulk;
+    hg_uint32_t op;
+};
+
+struct hg_bench_bulk_args {
+    hg_handle_t handle;
+    struct hg_bench_bulk_in in;
+};
+
+/* Window of RPCs kept in flight by one origin thread */
+struct hg_bench_window;
+
+struct hg_bench_slot {
+    struct hg_bench_window *window;
+    unsigned int index;
+    double start;
+};
+
+struct hg_bench_window {
+    hg_context_t *context;
+    hg_addr_t addr;
+    hg_id_t id;
+    void *in_struct;
+    hg_bool_t get_output;
+    unsigned int size;
+    hg_handle_t *handles;
+    struct hg_bench_slot *slots;
+    unsigned int *ready;
+    unsigned int ready_count;
+    size_t issued;
+    size_t completed;
+    struct hg_bench_samples *samples;
+    struct hg_bench_histogram *histogram;
+    hg_return_t ret;
+    double elapsed;
+};
+
+struct hg_bench_thread_args {
+    struct hg_bench_info *info;
+    struct hg_bench_window window;
+    struct hg_bench_samples samples;
+    size_t total;
+};
+
+/* NA target */
+struct hg_bench_na_server {
+    na_class_t *na_class;
+    na_context_t *context;
+    void *recv_buf;
+    void *recv_buf_data;
+    void *send_buf;
+    void *send_buf_data;
+    na_size_t recv_size;
+    na_size_t send_size;
+    na_op_id_t recv_op_id;
+    hg_bool_t recv_posted;
+    int send_count;
+    hg_atomic_int32_t stop;
+    hg_thread_t thread;
+};
+
+struct hg_bench_entry {
+    const char *name;
+    hg_return_t (*run)(struct hg_bench_info *info);
+};
+
+/********************/
+/* Local Prototypes */
+/********************/
+
+static void
+hg_bench_usage(const char *name);
+
+static int
+hg_bench_parse_options(int argc, char *argv[],
+    struct hg_bench_options *options);
+
+static hg_bool_t
+hg_bench_selected(const char *list, const char *name);
+
+static size_t
+hg_bench_iterations(struct hg_bench_info *info, size_t size);
+
+static hg_return_t
+hg_proc_hg_bench_rpc_in(hg_proc_t proc, void *data);
+
+static hg_return_t
+hg_proc_hg_bench_bulk_in(hg_proc_t proc, void *data);
+
+static hg_return_t
+hg_bench_progress(hg_context_t *context, unsigned int timeout);
+
+static hg_return_t
+hg_bench_rpc_cb(hg_handle_t handle);
+
+static hg_return_t
+hg_bench_bulk_cb(hg_handle_t handle);
+
+static hg_return_t
+hg_bench_bulk_transfer_cb(const struct hg_cb_info *callback_info);
+
+static HG_THREAD_RETURN_TYPE
+hg_bench_server_progress(void *arg);
+
+static hg_return_t
+hg_bench_lookup_cb(const struct hg_cb_info *callback_info);
+
+static hg_return_t
+hg_bench_hg_init(struct hg_bench_info *info);
+
+static void
+hg_bench_hg_finalize(struct hg_bench_info *info);
+
+static hg_return_t
+hg_bench_forward_cb(const struct hg_cb_info *callback_info);
+
+static hg_return_t
+hg_bench_window_init(struct hg_bench_window *window, unsigned int size);
+
+static void
+hg_bench_window_free(struct hg_bench_window *window);
+
+static hg_return_t
+hg_bench_window_run(struct hg_bench_window *window, size_t total);
+
+static hg_return_t
+hg_bench_window_measure(struct hg_bench_info *info, hg_context_t *context,
+    hg_id_t id, void *in_struct, hg_bool_t get_output, unsigned int size,
+    size_t total, struct hg_bench_samples *samples, double *elapsed);
+
+static HG_THREAD_RETURN_TYPE
+hg_bench_thread(void *arg);
+
+static int
+hg_bench_na_cb(const struct na_cb_info *callback_info);
+
+static int
+hg_bench_na_lookup_cb(const struct na_cb_info *callback_info);
+
+static int
+hg_bench_na_recv_cb(const struct na_cb_info *callback_info);
+
+static HG_THREAD_RETURN_TYPE
+hg_bench_na_server_progress(void *arg);
+
+static na_return_t
+hg_bench_na_progress(na_class_t *na_class, na_context_t *context);
+
+static hg_return_t
+hg_bench_na_lat(struct hg_bench_info *info);
+
+static hg_return_t
+hg_bench_rpc_lat(struct hg_bench_info *info);
+
+static hg_return_t
+hg_bench_rpc_bw(struct hg_bench_info *info);
+
+static hg_return_t
+hg_bench_rpc_mt(struct hg_bench_info *info);
+
+static hg_return_t
+hg_bench_bulk(struct hg_bench_info *info);
+
+static hg_return_t
+hg_bench_handle(struct hg_bench_info *info);
+
+static hg_return_t
+hg_bench_proc(struct hg_bench_info *info);
+
+/**
+ * Get next open-loop inter-arrival time (in seconds).
+ */
+static double
+hg_bench_interval(double rate, hg_bool_t poisson, hg_uint64_t *state);
+
+static hg_return_t
+hg_bench_rpc_open(struct hg_bench_info *info);
+
+/*******************/
+/* Local Variables */
+/*******************/
+
+static const struct hg_bench_entry hg_bench_entries_g[] = {
+    { "na_lat", hg_bench_na_lat },
+    { "rpc_lat", hg_bench_rpc_lat },
+    { "rpc_bw", hg_bench_rpc_bw },
+    { "rpc_mt", hg_bench_rpc_mt },
+    { "bulk", hg_bench_bulk },
+    { "handle", hg_bench_handle },
+    { "proc", hg_bench_proc },
+    { "rpc_open", hg_bench_rpc_open },
+    { NULL, NULL }
+};
+
+/*---------------------------------------------------------------------------*/
+static void
+hg_bench_usage(const char *name)
+{
+    const struct hg_bench_entry *entry;
+
+    fprintf(stderr, "usage: %s [options]\n"
+        "  -p <na_info>    NA info string (default: %s)\n"
+        "  -b <list>       comma separated benchmarks (default: all)\n"
+        "  -f <format>     text, csv or json (default: text)\n"
+        "  -o <file>       output file (default: stdout)\n"
+        "  -n <count>      iterations for small sizes (default: %d)\n"
+        "  -w <count>      warmup iterations (default: %d)\n"
+        "  -s <size>       max RPC payload size (default: %d)\n"
+        "  -S <size>       max bulk transfer size (default: %d)\n"
+        "  -t <count>      max origin threads (default: %d)\n"
+        "  -q <count>      RPCs in flight per thread (default: %d)\n"
+        "  -r <list>       open-loop offered rates in RPC/s (default: %s)\n"
+        "  -d <ms>         open-loop run time per rate (default: %d)\n"
+        "  -m <count>      open-loop max RPCs in flight (default: %d)\n"
+        "  -a <arrival>    open-loop arrivals, poisson or fixed "
+        "(default: poisson)\n"
+        "benchmarks:", name, HG_BENCH_NA_INFO, HG_BENCH_ITERATIONS,
+        HG_BENCH_WARMUP, HG_BENCH_MAX_SIZE, HG_BENCH_MAX_BULK_SIZE,
+        HG_BENCH_MAX_THREADS, HG_BENCH_WINDOW, HG_BENCH_RATES,
+        HG_BENCH_DURATION, HG_BENCH_OPEN_HANDLES);
+    for (entry = hg_bench_entries_g; entry->name; entry++)
+        fprintf(stderr, " %s", entry->name);
+    fprintf(stderr, "\n");
+}
+
+/*---------------------------------------------------------------------------*/
+static int
+hg_bench_parse_options(int argc, char *argv[],
+    struct hg_bench_options *options)
+{
+    int i;
+
+    options->na_info = HG_BENCH_NA_INFO;
+    options->benchmarks = NULL;
+    options->output_name = NULL;
+    options->format = HG_BENCH_TEXT;
+    options->iterations = HG_BENCH_ITERATIONS;
+    options->warmup = HG_BENCH_WARMUP;
+    options->max_size = HG_BENCH_MAX_SIZE;
+    options->max_bulk_size = HG_BENCH_MAX_BULK_SIZE;
+    options->max_threads = HG_BENCH_MAX_THREADS;
+    options->window = HG_BENCH_WINDOW;
+    options->rates = HG_BENCH_RATES;
+    options->duration = HG_BENCH_DURATION;
+    options->open_handles = HG_BENCH_OPEN_HANDLES;
+    options->poisson = HG_TRUE;
+
+    for (i = 1; i < argc; i++) {
+        const char *arg = argv[i];
+
+        if (arg[0] != '-' || !arg[1] || arg[2] || i + 1 >= argc)
+            return HG_UTIL_FAIL;
+        i++;
+        switch (arg[1]) {
+            case 'p':
+                options->na_info = argv[i];
+                break;
+            case 'b':
+                options->benchmarks = argv[i];
+                break;
+            case 'f':
+                if (hg_bench_format_parse(argv[i], &options->format)
+                    != HG_UTIL_SUCCESS)
+                    return HG_UTIL_FAIL;
+                break;
+            case 'o':
+                options->output_name = argv[i];
+                break;
+            case 'n':
+                options->iterations = (unsigned int) atoi(argv[i]);
+                break;
+            case 'w':
+                options->warmup = (unsigned int) atoi(argv[i]);
+                break;
+            case 's':
+                options->max_size = (size_t) atol(argv[i]);
+                break;
+            case 'S':
+                options->max_bulk_size = (size_t) atol(argv[i]);
+                break;
+            case 't':
+                options->max_threads = (unsigned int) atoi(argv[i]);
+                break;
+            case 'q':
+                options->window = (unsigned int) atoi(argv[i]);
+                break;
+            case 'r':
+                options->rates = argv[i];
+                break;
+            case 'd':
+                options->duration = (unsigned int) atoi(argv[i]);
+                break;
+            case 'm':
+                options->open_handles = (unsigned int) atoi(argv[i]);
+                break;
+            case 'a':
+                if (!strcmp(argv[i], "poisson"))
+                    options->poisson = HG_TRUE;
+                else if (!strcmp(argv[i], "fixed"))
+                    options->poisson = HG_FALSE;
+                else
+                    return HG_UTIL_FAIL;
+                break;
+            default:
+                return HG_UTIL_FAIL;
+        }
+    }
+    if (!options->iterations || !options->max_threads || !options->window
+        || !options->open_handles)
+        return HG_UTIL_FAIL;
+
+    return HG_UTIL_SUCCESS;
+}
+
+/*---------------------------------------------------------------------------*/
+static hg_bool_t
+hg_bench_selected(const char *list, const char *name)
+{
+    size_t len = strlen(name);
+    const char *p = list;
+
+    if (!list)
+        return HG_TRUE;
+
+    while (p && *p) {
+        if (!strncmp(p, name, len) && (p[len] == ',' || p[len] == '\0'))
+            return HG_TRUE;
+        p = strchr(p, ',');
+        if (p)
+            p++;
+    }
+
+    return HG_FALSE;
+}
+
+/*---------------------------------------------------------------------------*/
+static size_t
+hg_bench_iterations(struct hg_bench_info *info, size_t size)
+{
+    size_t iterations = info->options.iterations;
+
+    /* Keep run time roughly constant across sizes */
+    if (size > 1024 * 1024)
+        iterations /= 128;
+    else if (size > 64 * 1024)
+        iterations /= 32;
+    else if (size > 8 * 1024)
+        iterations /= 4;
+
+    return (iterations < 10) ? 10 : iterations;
+}
+
+/*---------------------------------------------------------------------------*/
+static hg_return_t
+hg_proc_hg_bench_rpc_in(hg_proc_t proc, void *data)
+{
+    struct hg_bench_rpc_in *struct_data = (struct hg_bench_rpc_in *) data;
+    hg_return_t ret;
+
+    ret = hg_proc_hg_uint32_t(proc, &struct_data->size);
+    if (ret != HG_SUCCESS || !struct_data->size)
+        return ret;
+
+    switch (hg_proc_get_op(proc)) {
+        case HG_DECODE:
+            struct_data->buf = malloc(struct_data->size);
+            if (!struct_data->buf)
+                return HG_NOMEM_ERROR;
+            HG_FALLTHROUGH();
+        case HG_ENCODE:
+            ret = hg_proc_raw(proc, struct_data->buf, struct_data->size);
+            break;
+        case HG_FREE:
+            free(struct_data->buf);
+            break;
+        default:
+            break;
+    }
+
+    return ret;
+}
+
+/*---------------------------------------------------------------------------*/
+static hg_return_t
+hg_proc_hg_bench_bulk_in(hg_proc_t proc, void *data)
+{
+    struct hg_bench_bulk_in *struct_data = (struct hg_bench_bulk_in *) data;
+    hg_return_t ret;
+
+    ret = hg_proc_hg_bulk_t(proc, &struct_data->bulk);
+    if (ret != HG_SUCCESS)
+        return ret;
+
+    return hg_proc_hg_uint32_t(proc, &struct_data->op);
+}
+
+/*---------------------------------------------------------------------------*/
+static hg_return_t
+hg_bench_progress(hg_context_t *context, unsigned int timeout)
+{
+    unsigned int count, total = 0;
+    hg_return_t ret;
+
+    do {
+        count = 0;
+        ret = HG_Trigger(context, 0, 1, &count);
+        total += count;
+    } while (ret == HG_SUCCESS && count);
+    if (ret != HG_SUCCESS && ret != HG_TIMEOUT)
+        return ret;
+
+    /* Let the caller look at completed operations before blocking */
+    if (total)
+        return HG_SUCCESS;
+
+    ret = HG_Progress(context, timeout);
+
+    return (ret == HG_TIMEOUT) ? HG_SUCCESS : ret;
+}
+
+/*---------------------------------------------------------------------------*/
+static hg_return_t
+hg_bench_rpc_cb(hg_handle_t handle)
+{
+    struct hg_bench_rpc_in in;
+    hg_return_t ret;
+
+    ret = HG_Get_input(handle, &in);
+    if (ret != HG_SUCCESS) {
+        fprintf(stderr, "Could not get input\n");
+        goto done;
+    }
+
+    /* Echo payload back */
+    ret = HG_Respond(handle, NULL, NULL, &in);
+    if (ret != HG_SUCCESS)
+        fprintf(stderr, "Could not respond\n");
+
+    HG_Free_input(handle, &in);
+
+done:
+    HG_Destroy(handle);
+    return ret;
+}
+
+/*---------------------------------------------------------------------------*/
+static hg_return_t
+hg_bench_bulk_cb(hg_handle_t handle)
+{
+    const struct hg_info *hg_info = HG_Get_info(handle);
+    struct hg_bench_info *info =
+        (struct hg_bench_info *) HG_Registered_data(hg_info->hg_class,
+            hg_info->id);
+    struct hg_bench_bulk_args *args;
+    hg_return_t ret;
+
+    args = (struct hg_bench_bulk_args *) malloc(
+        sizeof(struct hg_bench_bulk_args));
+    if (!args) {
+        ret = HG_NOMEM_ERROR;
+        goto error;
+    }
+    args->handle = handle;
+
+    ret = HG_Get_input(handle, &args->in);
+    if (ret != HG_SUCCESS) {
+        fprintf(stderr, "Could not get input\n");
+        goto error;
+    }
+
+    ret = HG_Bulk_transfer(hg_info->context, hg_bench_bulk_transfer_cb, args,
+        (hg_bulk_op_t) args->in.op, hg_info->addr, args->in.bulk, 0,
+        info->server_bulk, 0, HG_Bulk_get_size(args->in.bulk),
+        HG_OP_ID_IGNORE);
+    if (ret != HG_SUCCESS) {
+        fprintf(stderr, "Could not transfer data\n");
+        HG_Free_input(handle, &args->in);
+        goto error;
+    }
+
+    return HG_SUCCESS;
+
+error:
+    free(args);
+    HG_Destroy(handle);
+    return ret;
+}
+
+/*---------------------------------------------------------------------------*/
+static hg_return_t
+hg_bench_bulk_transfer_cb(const struct hg_cb_info *callback_info)
+{
+    struct hg_bench_bulk_args *args =
+        (struct hg_bench_bulk_args *) callback_info->arg;
+    hg_return_t ret;
+
+    HG_Free_input(args->handle, &args->in);
+
+    ret = HG_Respond(args->handle, NULL, NULL, NULL);
+    if (ret != HG_SUCCESS)
+        fprintf(stderr, "Could not respond\n");
+
+    HG_Destroy(args->handle);
+    free(args);
+
+    return ret;
+}
+
+/*---------------------------------------------------------------------------*/
+static HG_THREAD_RETURN_TYPE
+hg_bench_server_progress(void *arg)
+{
+    struct hg_bench_info *info = (struct hg_bench_info *) arg;
+    hg_thread_ret_t tret = (hg_thread_ret_t) 0;
+
+    while (!hg_atomic_get32(&info->server_stop)) {
+        if (hg_bench_progress(info->server_context, HG_BENCH_TIMEOUT) != HG_SUCCESS) {
+            fprintf(stderr, "Target progress failed\n");
+            break;
+        }
+    }
+
+    hg_thread_exit(tret);
+    return tret;
+}
+
+/*---------------------------------------------------------------------------*/
+static hg_return_t
+hg_bench_lookup_cb(const struct hg_cb_info *callback_info)
+{
+    hg_addr_t *addr = (hg_addr_t *) callback_info->arg;
+
+    if (callback_info->ret == HG_SUCCESS)
+        *addr = callback_info->info.lookup.addr;
+
+    return HG_SUCCESS;
+}
+
+/*---------------------------------------------------------------------------*/
+static hg_return_t
+hg_bench_hg_init(struct hg_bench_info *info)
+{
+    char addr_string[HG_BENCH_ADDR_MAX];
+    hg_size_t addr_string_size = HG_BENCH_ADDR_MAX;
+    hg_size_t max_bulk_size = info->options.max_bulk_size;
+    hg_addr_t self_addr = HG_ADDR_NULL;
+    hg_return_t ret;
+
+    /* Target */
+    info->server_class = HG_Init(info->options.na_info, HG_TRUE);
+    if (!info->server_class) {
+        fprintf(stderr, "Could not initialize target class\n");
+        return HG_PROTOCOL_ERROR;
+    }
+    info->server_context = HG_Context_create(info->server_class);
+    if (!info->server_context) {
+        fprintf(stderr, "Could not create target context\n");
+        return HG_PROTOCOL_ERROR;
+    }
+    HG_Register_name(info->server_class, "hg_bench_rpc",
+        hg_proc_hg_bench_rpc_in, hg_proc_hg_bench_rpc_in, hg_bench_rpc_cb);
+    info->bulk_id = HG_Register_name(info->server_class, "hg_bench_bulk",
+        hg_proc_hg_bench_bulk_in, NULL, hg_bench_bulk_cb);
+    HG_Register_data(info->server_class, info->bulk_id, info, NULL);
+
+    info->server_buf = malloc(max_bulk_size ? max_bulk_size : 1);
+    if (!info->server_buf)
+        return HG_NOMEM_ERROR;
+    memset(info->server_buf, 0, max_bulk_size);
+    ret = HG_Bulk_create(info->server_class, 1, &info->server_buf,
+        &max_bulk_size, HG_BULK_READWRITE, &info->server_bulk);
+    if (ret != HG_SUCCESS) {
+        fprintf(stderr, "Could not create target bulk handle\n");
+        return ret;
+    }
+
+    ret = HG_Addr_self(info->server_class, &self_addr);
+    if (ret != HG_SUCCESS)
+        return ret;
+    ret = HG_Addr_to_string(info->server_class, addr_string,
+        &addr_string_size, self_addr);
+    HG_Addr_free(info->server_class, self_addr);
+    if (ret != HG_SUCCESS) {
+        fprintf(stderr, "Could not get target address\n");
+        return ret;
+    }
+
+    hg_atomic_init32(&info->server_stop, 0);
+    if (hg_thread_create(&info->server_thread, hg_bench_server_progress, info)
+        != HG_UTIL_SUCCESS) {
+        fprintf(stderr, "Could not create target thread\n");
+        return HG_PROTOCOL_ERROR;
+    }
+
+    /* Origin */
+    info->client_class = HG_Init(info->options.na_info, HG_FALSE);
+    if (!info->client_class) {
+        fprintf(stderr, "Could not initialize origin class\n");
+        return HG_PROTOCOL_ERROR;
+    }
+    info->client_context = HG_Context_create(info->client_class);
+    if (!info->client_context) {
+        fprintf(stderr, "Could not create origin context\n");
+        return HG_PROTOCOL_ERROR;
+    }
+    info->rpc_id = HG_Register_name(info->client_class, "hg_bench_rpc",
+        hg_proc_hg_bench_rpc_in, hg_proc_hg_bench_rpc_in, NULL);
+    HG_Register_name(info->client_class, "hg_bench_bulk",
+        hg_proc_hg_bench_bulk_in, NULL, NULL);
+
+    ret = HG_Addr_lookup(info->client_context, hg_bench_lookup_cb,
+        &info->target_addr, addr_string, HG_OP_ID_IGNORE);
+    while (ret == HG_SUCCESS && info->target_addr == HG_ADDR_NULL)
+        ret = hg_bench_progress(info->client_context, HG_BENCH_TIMEOUT);
+    if (ret != HG_SUCCESS)
+        fprintf(stderr, "Could not lookup %s\n", addr_string);
+
+    return ret;
+}
+
+/*---------------------------------------------------------------------------*/
+static void
+hg_bench_hg_finalize(struct hg_bench_info *info)
+{
+    if (info->client_class) {
+        if (info->target_addr != HG_ADDR_NULL)
+            HG_Addr_free(info->client_class, info->target_addr);
+        if (info->client_context)
+            HG_Context_destroy(info->client_context);
+        HG_Finalize(info->client_class);
+    }
+
+    if (info->server_class) {
+        if (info->server_context) {
+            hg_atomic_set32(&info->server_stop, 1);
+            hg_thread_join(info->server_thread);
+        }
+        if (info->server_bulk != HG_BULK_NULL)
+            HG_Bulk_free(info->server_bulk);
+        if (info->server_context)
+            HG_Context_destroy(info->server_context);
+        HG_Finalize(info->server_class);
+    }
+    free(info->server_buf);
+}
+
+/*---------------------------------------------------------------------------*/
+static hg_return_t
+hg_bench_forward_cb(const struct hg_cb_info *callback_info)
+{
+    struct hg_bench_slot *slot = (struct hg_bench_slot *) callback_info->arg;
+    struct hg_bench_window *window = slot->window;
+
+    if (callback_info->ret != HG_SUCCESS)
+        window->ret = callback_info->ret;
+    else if (window->get_output) {
+        hg_handle_t handle = callback_info->info.forward.handle;
+        struct hg_bench_rpc_in out;
+
+        if (HG_Get_output(handle, &out) == HG_SUCCESS)
+            HG_Free_output(handle, &out);
+    }
+
+    if (window->samples)
+        hg_bench_samples_add(window->samples, hg_bench_time() - slot->start);
+    if (window->histogram)
+        hg_bench_histogram_add(window->histogram,
+            hg_bench_time() - slot->start);
+    window->completed++;
+    window->ready[window->ready_count++] = slot->index;
+
+    return HG_SUCCESS;
+}
+
+/*---------------------------------------------------------------------------*/
+static hg_return_t
+hg_bench_window_init(struct hg_bench_window *window, unsigned int size)
+{
+    unsigned int i;
+    hg_return_t ret = HG_SUCCESS;
+
+    window->size = size;
+    window->handles = (hg_handle_t *) calloc(size, sizeof(hg_handle_t));
+    window->slots = (struct hg_bench_slot *) calloc(size,
+        sizeof(struct hg_bench_slot));
+    window->ready = (unsigned int *) calloc(size, sizeof(unsigned int));
+    if (!window->handles || !window->slots || !window->ready) {
+        ret = HG_NOMEM_ERROR;
+        goto done;
+    }
+    for (i = 0; i < size; i++) {
+        ret = HG_Create(window->context, window->addr, window->id,
+            &window->handles[i]);
+        if (ret != HG_SUCCESS) {
+            fprintf(stderr, "Could not create handle\n");
+            goto done;
+        }
+        window->slots[i].window = window;
+        window->slots[i].index = i;
+        window->ready[i] = size - i - 1;
+    }
+    window->ready_count = size;
+    window->issued = window->completed = 0;
+    window->ret = HG_SUCCESS;
+
+done:
+    return ret;
+}
+
+/*---------------------------------------------------------------------------*/
+static void
+hg_bench_window_free(struct hg_bench_window *window)
+{
+    unsigned int i;
+
+    if (window->handles)
+        for (i = 0; i < window->size; i++)
+            if (window->handles[i] != HG_HANDLE_NULL)
+                HG_Destroy(window->handles[i]);
+    free(window->handles);
+    free(window->slots);
+    free(window->ready);
+    window->handles = NULL;
+    window->slots = NULL;
+    window->ready = NULL;
+}
+
+/*---------------------------------------------------------------------------*/
+static hg_return_t
+hg_bench_window_run(struct hg_bench_window *window, size_t total)
+{
+    unsigned int size = window->size;
+    hg_return_t ret = HG_SUCCESS;
+    double start;
+
+    if (size > total)
+        size = (unsigned int) total;
+
+    ret = hg_bench_window_init(window, size);
+    if (ret != HG_SUCCESS)
+        goto done;
+
+    start = hg_bench_time();
+    while (window->completed < total) {
+        while (window->ready_count && window->issued < total
+            && window->ret == HG_SUCCESS) {
+            unsigned int index = window->ready[--window->ready_count];
+
+            window->slots[index].start = hg_bench_time();
+            ret = HG_Forward(window->handles[index], hg_bench_forward_cb,
+                &window->slots[index], window->in_struct);
+            if (ret != HG_SUCCESS) {
+                fprintf(stderr, "Could not forward call\n");
+                window->ret = ret;
+                break;
+            }
+            window->issued++;
+        }
+        /* Wait for operations in flight before bailing out */
+        if (window->ret != HG_SUCCESS && window->completed == window->issued)
+            break;
+        ret = hg_bench_progress(window->context, HG_BENCH_TIMEOUT);
+        if (ret != HG_SUCCESS)
+            goto done;
+    }
+    window->elapsed = hg_bench_time() - start;
+    ret = window->ret;
+
+done:
+    hg_bench_window_free(window);
+    return ret;
+}
+
+/*---------------------------------------------------------------------------*/
+static hg_return_t
+hg_bench_window_measure(struct hg_bench_info *info, hg_context_t *context,
+    hg_id_t id, void *in_struct, hg_bool_t get_output, unsigned int size,
+    size_t total, struct hg_bench_samples *samples, double *elapsed)
+{
+    struct hg_bench_window window;
+    hg_return_t ret;
+
+    memset(&window, 0, sizeof(window));
+    window.context = context;
+    window.addr = info->target_addr;
+    window.id = id;
+    window.in_struct = in_struct;
+    window.get_output = get_output;
+    window.size = size;
+
+    if (info->options.warmup) {
+        ret = hg_bench_window_run(&window, info->options.warmup);
+        if (ret != HG_SUCCESS)
+            return ret;
+    }
+
+    window.samples = samples;
+    ret = hg_bench_window_run(&window, total);
+    *elapsed = window.elapsed;
+
+    return ret;
+}
+
+/*---------------------------------------------------------------------------*/
+static HG_THREAD_RETURN_TYPE
+hg_bench_thread(void *arg)
+{
+    struct hg_bench_thread_args *args = (struct hg_bench_thread_args *) arg;
+    hg_thread_ret_t tret = (hg_thread_ret_t) 0;
+
+    args->window.ret = hg_bench_window_run(&args->window, args->total);
+
+    hg_thread_exit(tret);
+    return tret;
+}
+
+/*---------------------------------------------------------------------------*/
+static int
+hg_bench_na_cb(const struct na_cb_info *callback_info)
+{
+    int *completed = (int *) callback_info->arg;
+
+    (*completed)++;
+
+    return NA_SUCCESS;
+}
+
+/*---------------------------------------------------------------------------*/
+static int
+hg_bench_na_lookup_cb(const struct na_cb_info *callback_info)
+{
+    na_addr_t *addr = (na_addr_t *) callback_info->arg;
+
+    if (callback_info->ret == NA_SUCCESS)
+        *addr = callback_info->info.lookup.addr;
+
+    return NA_SUCCESS;
+}
+
+/*---------------------------------------------------------------------------*/
+static int
+hg_bench_na_recv_cb(const struct na_cb_info *callback_info)
+{
+    struct hg_bench_na_server *server =
+        (struct hg_bench_na_server *) callback_info->arg;
+    na_size_t size = callback_info->info.recv_unexpected.actual_buf_size;
+
+    server->recv_posted = HG_FALSE;
+    if (callback_info->ret != NA_SUCCESS)
+        return NA_SUCCESS;
+
+    /* Echo same amount of data */
+    if (size > server->send_size)
+        size = server->send_size;
+    if (NA_Msg_send_expected(server->na_class, server->context,
+        hg_bench_na_cb, &server->send_count, server->send_buf, size, server->send_buf_data,
+        callback_info->info.recv_unexpected.source,
+        callback_info->info.recv_unexpected.tag, NA_OP_ID_IGNORE)
+        != NA_SUCCESS)
+        fprintf(stderr, "Could not send expected message\n");
+
+    NA_Addr_free(server->na_class, callback_info->info.recv_unexpected.source);
+
+    return NA_SUCCESS;
+}
+
+/*---------------------------------------------------------------------------*/
+static na_return_t
+hg_bench_na_progress(na_class_t *na_class, na_context_t *context)
+{
+    unsigned int count, total = 0;
+    na_return_t ret;
+
+    do {
+        count = 0;
+        ret = NA_Trigger(context, 0, 1, NULL, &count);
+        total += count;
+    } while (ret == NA_SUCCESS && count);
+
+    /* Let the caller look at completed operations before blocking */
+    if (total)
+        return NA_SUCCESS;
+
+    /* Only safe to block if there is nothing left to progress */
+    ret = NA_Progress(na_class, context,
+        NA_Poll_try_wait(na_class, context) ? HG_BENCH_TIMEOUT : 0);
+
+    return (ret == NA_TIMEOUT) ? NA_SUCCESS : ret;
+}
+
+/*---------------------------------------------------------------------------*/
+static HG_THREAD_RETURN_TYPE
+hg_bench_na_server_progress(void *arg)
+{
+    struct hg_bench_na_server *server = (struct hg_bench_na_server *) arg;
+    hg_thread_ret_t tret = (hg_thread_ret_t) 0;
+
+    while (!hg_atomic_get32(&server->stop)) {
+        if (!server->recv_posted) {
+            if (NA_Msg_recv_unexpected(server->na_class, server->context,
+                hg_bench_na_recv_cb, server, server->recv_buf,
+                server->recv_size, server->recv_buf_data, 0,
+                &server->recv_op_id) != NA_SUCCESS) {
+                fprintf(stderr, "Could not post unexpected recv\n");
+                break;
+            }
+            server->recv_posted = HG_TRUE;
+        }
+        if (hg_bench_na_progress(server->na_class, server->context)
+            != NA_SUCCESS) {
+            fprintf(stderr, "Target progress failed\n");
+            break;
+        }
+    }
+
+    /* Cancel pending receive */
+    if (server->recv_posted
+        && NA_Cancel(server->na_class, server->context, server->recv_op_id)
+            == NA_SUCCESS)
+        while (server->recv_posted
+            && hg_bench_na_progress(server->na_class, server->context)
+                == NA_SUCCESS)
+            continue;
+
+    hg_thread_exit(tret);
+    return tret;
+}
+
+/*---------------------------------------------------------------------------*/
+static hg_return_t
+hg_bench_na_lat(struct hg_bench_info *info)
+{
+    struct hg_bench_na_server server;
+    struct hg_bench_samples samples = { NULL, 0, 0 };
+    struct hg_bench_result result;
+    na_class_t *na_class = NULL;
+    na_context_t *context = NULL;
+    na_addr_t self_addr = NA_ADDR_NULL, addr = NA_ADDR_NULL;
+    char addr_string[HG_BENCH_ADDR_MAX];
+    na_size_t addr_string_size = HG_BENCH_ADDR_MAX;
+    void *send_buf = NULL, *send_buf_data = NULL;
+    void *recv_buf = NULL, *recv_buf_data = NULL;
+    na_op_id_t send_op_id = NA_OP_ID_NULL, recv_op_id = NA_OP_ID_NULL;
+    na_size_t header_size, max_size, recv_size, size;
+    na_tag_t max_tag;
+    hg_bool_t server_started = HG_FALSE;
+    hg_return_t ret = HG_PROTOCOL_ERROR;
+
+    memset(&server, 0, sizeof(server));
+    hg_atomic_init32(&server.stop, 0);
+
+    /* Target */
+    server.na_class = NA_Initialize(info->options.na_info, NA_TRUE);
+    if (!server.na_class) {
+        fprintf(stderr, "Could not initialize NA target class\n");
+        goto done;
+    }
+    server.context = NA_Context_create(server.na_class);
+    server.recv_size = NA_Msg_get_max_unexpected_size(server.na_class);
+    server.send_size = NA_Msg_get_max_expected_size(server.na_class);
+    server.recv_buf = NA_Msg_buf_alloc(server.na_class, server.recv_size,
+        &server.recv_buf_data);
+    server.send_buf = NA_Msg_buf_alloc(server.na_class, server.send_size,
+        &server.send_buf_data);
+    if (!server.context || !server.recv_buf || !server.send_buf) {
+        fprintf(stderr, "Could not allocate NA target resources\n");
+        goto done;
+    }
+    NA_Msg_init_expected(server.na_class, server.send_buf, server.send_size);
+    server.recv_op_id = NA_Op_create(server.na_class);
+    if (NA_Addr_self(server.na_class, &self_addr) != NA_SUCCESS
+        || NA_Addr_to_string(server.na_class, addr_string, &addr_string_size,
+            self_addr) != NA_SUCCESS) {
+        fprintf(stderr, "Could not get NA target address\n");
+        goto done;
+    }
+    if (hg_thread_create(&server.thread, hg_bench_na_server_progress, &server)
+        != HG_UTIL_SUCCESS) {
+        fprintf(stderr, "Could not create NA target thread\n");
+        goto done;
+    }
+    server_started = HG_TRUE;
+
+    /* Origin */
+    na_class = NA_Initialize(info->options.na_info, NA_FALSE);
+    if (!na_class) {
+        fprintf(stderr, "Could not initialize NA origin class\n");
+        goto done;
+    }
+    context = NA_Context_create(na_class);
+    if (!context) {
+        fprintf(stderr, "Could not create NA origin context\n");
+        goto done;
+    }
+    header_size = NA_Msg_get_unexpected_header_size(na_class);
+    max_size = NA_Msg_get_max_unexpected_size(na_class);
+    if (max_size > server.send_size)
+        max_size = server.send_size;
+    recv_size = NA_Msg_get_max_expected_size(na_class);
+    max_tag = NA_Msg_get_max_tag(na_class);
+    send_buf = NA_Msg_buf_alloc(na_class, max_size, &send_buf_data);
+    recv_buf = NA_Msg_buf_alloc(na_class, recv_size, &recv_buf_data);
+    if (!send_buf || !recv_buf) {
+        fprintf(stderr, "Could not allocate NA origin buffers\n");
+        goto done;
+    }
+    memset(send_buf, 0, max_size);
+    NA_Msg_init_unexpected(na_class, send_buf, max_size);
+    send_op_id = NA_Op_create(na_class);
+    recv_op_id = NA_Op_create(na_class);
+
+    if (NA_Addr_lookup(na_class, context, hg_bench_na_lookup_cb, &addr,
+        addr_string, NA_OP_ID_IGNORE) != NA_SUCCESS) {
+        fprintf(stderr, "Could not lookup %s\n", addr_string);
+        goto done;
+    }
+    while (addr == NA_ADDR_NULL)
+        if (hg_bench_na_progress(na_class, context) != NA_SUCCESS)
+            goto done;
+
+    ret = HG_SUCCESS;
+    /* Plugins may not accept empty messages */
+    for (size = 8; size + header_size <= max_size; size *= 4) {
+        size_t iterations = hg_bench_iterations(info, size), i;
+        double start = 0;
+
+        if (hg_bench_samples_init(&samples, iterations) != HG_UTIL_SUCCESS) {
+            ret = HG_NOMEM_ERROR;
+            break;
+        }
+
+        for (i = 0; i < info->options.warmup + iterations; i++) {
+            na_tag_t tag = (na_tag_t) (i % max_tag);
+            int completed = 0;
+            double t1;
+
+            if (i == info->options.warmup)
+                start = hg_bench_time();
+            t1 = hg_bench_time();
+            if (NA_Msg_recv_expected(na_class, context, hg_bench_na_cb,
+                &completed, recv_buf, recv_size, recv_buf_data, addr, tag,
+                &recv_op_id) != NA_SUCCESS) {
+                fprintf(stderr, "Could not post expected recv\n");
+                ret = HG_PROTOCOL_ERROR;
+                break;
+            }
+            if (NA_Msg_send_unexpected(na_class, context, hg_bench_na_cb,
+                &completed, send_buf, header_size + size, send_buf_data,
+                addr, tag, &send_op_id) != NA_SUCCESS) {
+                fprintf(stderr, "Could not send unexpected message\n");
+                ret = HG_PROTOCOL_ERROR;
+                /* Complete recv before releasing its operation ID */
+                completed++;
+                NA_Cancel(na_class, context, recv_op_id);
+            }
+            while (completed < 2)
+                if (hg_bench_na_progress(na_class, context) != NA_SUCCESS) {
+                    ret = HG_PROTOCOL_ERROR;
+                    goto done;
+                }
+            if (ret != HG_SUCCESS)
+                break;
+            if (i >= info->options.warmup)
+                hg_bench_samples_add(&samples, hg_bench_time() - t1);
+        }
+        if (ret != HG_SUCCESS)
+            break;
+
+        memset(&result, 0, sizeof(result));
+        result.name = "na_lat";
+        result.size = size;
+        result.segments = result.threads = result.window = 1;
+        hg_bench_result_compute(&result, &samples, iterations,
+            hg_bench_time() - start, 2.0 * (double) (size * iterations));
+        hg_bench_output_write(&info->output, &result);
+        hg_bench_samples_free(&samples);
+    }
+
+done:
+    hg_bench_samples_free(&samples);
+    if (server_started) {
+        hg_atomic_set32(&server.stop, 1);
+        hg_thread_join(server.thread);
+    }
+    if (na_class) {
+        if (addr != NA_ADDR_NULL)
+            NA_Addr_free(na_class, addr);
+        if (send_op_id != NA_OP_ID_NULL)
+            NA_Op_destroy(na_class, send_op_id);
+        if (recv_op_id != NA_OP_ID_NULL)
+            NA_Op_destroy(na_class, recv_op_id);
+        NA_Msg_buf_free(na_class, send_buf, send_buf_data);
+        NA_Msg_buf_free(na_class, recv_buf, recv_buf_data);
+        if (context)
+            NA_Context_destroy(na_class, context);
+        NA_Finalize(na_class);
+    }
+    if (server.na_class) {
+        if (self_addr != NA_ADDR_NULL)
+            NA_Addr_free(server.na_class, self_addr);
+        if (server.recv_op_id != NA_OP_ID_NULL)
+            NA_Op_destroy(server.na_class, server.recv_op_id);
+        NA_Msg_buf_free(server.na_class, server.send_buf,
+            server.send_buf_data);
+        NA_Msg_buf_free(server.na_class, server.recv_buf,
+            server.recv_buf_data);
+        if (server.context)
+            NA_Context_destroy(server.na_class, server.context);
+        NA_Finalize(server.na_class);
+    }
+    return ret;
+}
+
+/*---------------------------------------------------------------------------*/
+static hg_return_t
+hg_bench_rpc_lat(struct hg_bench_info *info)
+{
+    struct hg_bench_samples samples = { NULL, 0, 0 };
+    struct hg_bench_result result;
+    struct hg_bench_rpc_in in;
+    char *buf = NULL;
+    size_t size;
+    hg_return_t ret = HG_SUCCESS;
+
+    buf = (char *) calloc(1, info->options.max_size + 1);
+    if (!buf)
+        return HG_NOMEM_ERROR;
+    in.buf = buf;
+
+    for (size = 0; size <= info->options.max_size;
+        size = (size) ? size * 4 : 8) {
+        size_t iterations = hg_bench_iterations(info, size);
+        double elapsed;
+
+        if (hg_bench_samples_init(&samples, iterations) != HG_UTIL_SUCCESS) {
+            ret = HG_NOMEM_ERROR;
+            break;
+        }
+        in.size = (hg_uint32_t) size;
+        ret = hg_bench_window_measure(info, info->client_context,
+            info->rpc_id, &in, HG_TRUE, 1, iterations, &samples, &elapsed);
+        if (ret != HG_SUCCESS)
+            break;
+
+        memset(&result, 0, sizeof(result));
+        result.name = "rpc_lat";
+        result.size = size;
+        result.segments = result.threads = result.window = 1;
+        hg_bench_result_compute(&result, &samples, iterations, elapsed,
+            2.0 * (double) (size * iterations));
+        hg_bench_output_write(&info->output, &result);
+        hg_bench_samples_free(&samples);
+    }
+
+    hg_bench_samples_free(&samples);
+    free(buf);
+    return ret;
+}
+
+/*---------------------------------------------------------------------------*/
+static hg_return_t
+hg_bench_rpc_bw(struct hg_bench_info *info)
+{
+    struct hg_bench_samples samples = { NULL, 0, 0 };
+    struct hg_bench_result result;
+    struct hg_bench_rpc_in in;
+    char *buf = NULL;
+    size_t size;
+    hg_return_t ret = HG_SUCCESS;
+
+    buf = (char *) calloc(1, info->options.max_size + 1);
+    if (!buf)
+        return HG_NOMEM_ERROR;
+    in.buf = buf;
+
+    for (size = 0; size <= info->options.max_size;
+        size = (size) ? size * 4 : 8) {
+        size_t iterations = hg_bench_iterations(info, size);
+        double elapsed;
+
+        if (hg_bench_samples_init(&samples, iterations) != HG_UTIL_SUCCESS) {
+            ret = HG_NOMEM_ERROR;
+            break;
+        }
+        in.size = (hg_uint32_t) size;
+        ret = hg_bench_window_measure(info, info->client_context,
+            info->rpc_id, &in, HG_TRUE, info->options.window, iterations,
+            &samples, &elapsed);
+        if (ret != HG_SUCCESS)
+            break;
+
+        memset(&result, 0, sizeof(result));
+        result.name = "rpc_bw";
+        result.size = size;
+        result.segments = result.threads = 1;
+        result.window = info->options.window;
+        hg_bench_result_compute(&result, &samples, iterations, elapsed,
+            2.0 * (double) (size * iterations));
+        hg_bench_output_write(&info->output, &result);
+        hg_bench_samples_free(&samples);
+    }
+
+    hg_bench_samples_free(&samples);
+    free(buf);
+    return ret;
+}
+
+/*---------------------------------------------------------------------------*/
+static hg_return_t
+hg_bench_rpc_mt(struct hg_bench_info *info)
+{
+    struct hg_bench_thread_args *args = NULL;
+    hg_thread_t *threads = NULL;
+    struct hg_bench_samples samples = { NULL, 0, 0 };
+    struct hg_bench_result result;
+    struct hg_bench_rpc_in in = { 0, NULL };
+    size_t iterations = info->options.iterations;
+    unsigned int max_threads = info->options.max_threads, n, i;
+    hg_return_t ret = HG_SUCCESS;
+
+    args = (struct hg_bench_thread_args *) calloc(max_threads,
+        sizeof(struct hg_bench_thread_args));
+    threads = (hg_thread_t *) calloc(max_threads, sizeof(hg_thread_t));
+    if (!args || !threads
+        || hg_bench_samples_init(&samples, iterations * max_threads)
+            != HG_UTIL_SUCCESS) {
+        ret = HG_NOMEM_ERROR;
+        goto done;
+    }
+
+    /* One context per origin thread */
+    for (i = 0; i < max_threads; i++) {
+        args[i].info = info;
+        args[i].total = iterations;
+        args[i].window.context = (i == 0) ? info->client_context :
+            HG_Context_create(info->client_class);
+        if (!args[i].window.context) {
+            fprintf(stderr, "Could not create origin context\n");
+            ret = HG_PROTOCOL_ERROR;
+            goto done;
+        }
+        args[i].window.addr = info->target_addr;
+        args[i].window.id = info->rpc_id;
+        args[i].window.in_struct = &in;
+        args[i].window.size = info->options.window;
+        if (hg_bench_samples_init(&args[i].samples, iterations)
+            != HG_UTIL_SUCCESS) {
+            ret = HG_NOMEM_ERROR;
+            goto done;
+        }
+    }
+
+    for (n = 1; n <= max_threads; n = (n * 2 > max_threads && n < max_threads) ?
+        max_threads : n * 2) {
+        double start;
+
+        /* Warm up all contexts */
+        for (i = 0; i < n && info->options.warmup; i++) {
+            args[i].window.samples = NULL;
+            ret = hg_bench_window_run(&args[i].window, info->options.warmup);
+            if (ret != HG_SUCCESS)
+                goto done;
+        }
+
+        start = hg_bench_time();
+        for (i = 0; i < n; i++) {
+            args[i].samples.count = 0;
+            args[i].window.samples = &args[i].samples;
+            if (hg_thread_create(&threads[i], hg_bench_thread, &args[i])
+                != HG_UTIL_SUCCESS) {
+                fprintf(stderr, "Could not create origin thread\n");
+                ret = HG_PROTOCOL_ERROR;
+                n = i;
+                break;
+            }
+        }
+        samples.count = 0;
+        for (i = 0; i < n; i++) {
+            hg_thread_join(threads[i]);
+            if (args[i].window.ret != HG_SUCCESS)
+                ret = args[i].window.ret;
+            hg_bench_samples_merge(&samples, &args[i].samples);
+        }
+        if (ret != HG_SUCCESS)
+            goto done;
+
+        memset(&result, 0, sizeof(result));
+        result.name = "rpc_mt";
+        result.segments = 1;
+        result.threads = n;
+        result.window = info->options.window;
+        hg_bench_result_compute(&result, &samples, iterations * n,
+            hg_bench_time() - start, 0);
+        hg_bench_output_write(&info->output, &result);
+    }
+
+done:
+    if (args) {
+        for (i = 0; i < max_threads; i++) {
+            if (i > 0 && args[i].window.context)
+                HG_Context_destroy(args[i].window.context);
+            hg_bench_samples_free(&args[i].samples);
+        }
+    }
+    hg_bench_samples_free(&samples);
+    free(threads);
+    free(args);
+    return ret;
+}
+
+/*---------------------------------------------------------------------------*/
+static hg_return_t
+hg_bench_bulk(struct hg_bench_info *info)
+{
+    static const hg_bulk_op_t ops[] = { HG_BULK_PULL, HG_BULK_PUSH };
+    static const char *names[] = { "bulk_pull", "bulk_push" };
+    struct hg_bench_samples samples = { NULL, 0, 0 };
+    struct hg_bench_result result;
+    struct hg_bench_bulk_in in;
+    void *ptrs[HG_BENCH_MAX_SEGMENTS];
+    hg_size_t sizes[HG_BENCH_MAX_SEGMENTS];
+    char *buf = NULL;
+    size_t size;
+    unsigned int op, segments, i;
+    hg_return_t ret = HG_SUCCESS;
+
+    buf = (char *) calloc(1, info->options.max_bulk_size + 1);
+    if (!buf)
+        return HG_NOMEM_ERROR;
+
+    for (op = 0; op < 2; op++)
+        for (size = HG_BENCH_MIN_BULK_SIZE; size <= info->options.max_bulk_size;
+            size *= 4)
+            for (segments = 1; segments <= HG_BENCH_MAX_SEGMENTS
+                && size / segments >= HG_BENCH_MIN_SEGMENT; segments *= 8) {
+                size_t iterations = hg_bench_iterations(info, size);
+                double elapsed;
+
+                for (i = 0; i < segments; i++) {
+                    ptrs[i] = buf + i * (size / segments);
+                    sizes[i] = size / segments;
+                }
+                ret = HG_Bulk_create(info->client_class, segments, ptrs,
+                    sizes, HG_BULK_READWRITE, &in.bulk);
+                if (ret != HG_SUCCESS) {
+                    fprintf(stderr, "Could not create bulk handle\n");
+                    goto done;
+                }
+                in.op = (hg_uint32_t) ops[op];
+
+                if (hg_bench_samples_init(&samples, iterations)
+                    == HG_UTIL_SUCCESS)
+                    ret = hg_bench_window_measure(info, info->client_context,
+                        info->bulk_id, &in, HG_FALSE, info->options.window,
+                        iterations, &samples, &elapsed);
+                else
+                    ret = HG_NOMEM_ERROR;
+                HG_Bulk_free(in.bulk);
+                if (ret != HG_SUCCESS)
+                    goto done;
+
+                memset(&result, 0, sizeof(result));
+                result.name = names[op];
+                result.size = size / segments * segments;
+                result.segments = segments;
+                result.threads = 1;
+                result.window = info->options.window;
+                hg_bench_result_compute(&result, &samples, iterations,
+                    elapsed, (double) (result.size * iterations));
+                hg_bench_output_write(&info->output, &result);
+                hg_bench_samples_free(&samples);
+            }
+
+done:
+    hg_bench_samples_free(&samples);
+    free(buf);
+    return ret;
+}
+
+/*---------------------------------------------------------------------------*/
+static hg_return_t
+hg_bench_handle(struct hg_bench_info *info)
+{
+    size_t batches = (info->options.iterations + HG_BENCH_BATCH - 1)
+        / HG_BENCH_BATCH, i, j;
+    struct hg_bench_samples samples = { NULL, 0, 0 };
+    struct hg_bench_result result;
+    hg_handle_t handle;
+    hg_return_t ret = HG_SUCCESS;
+    double start;
+
+    if (hg_bench_samples_init(&samples, batches) != HG_UTIL_SUCCESS)
+        return HG_NOMEM_ERROR;
+
+    start = hg_bench_time();
+    for (i = 0; i < batches && ret == HG_SUCCESS; i++) {
+        double t1 = hg_bench_time();
+
+        for (j = 0; j < HG_BENCH_BATCH; j++) {
+            ret = HG_Create(info->client_context, info->target_addr,
+                info->rpc_id, &handle);
+            if (ret != HG_SUCCESS) {
+                fprintf(stderr, "Could not create handle\n");
+                break;
+            }
+            HG_Destroy(handle);
+        }
+        hg_bench_samples_add(&samples,
+            (hg_bench_time() - t1) / HG_BENCH_BATCH);
+    }
+
+    if (ret == HG_SUCCESS) {
+        memset(&result, 0, sizeof(result));
+        result.name = "handle";
+        result.segments = result.threads = result.window = 1;
+        hg_bench_result_compute(&result, &samples, batches * HG_BENCH_BATCH,
+            hg_bench_time() - start, 0);
+        hg_bench_output_write(&info->output, &result);
+    }
+
+    hg_bench_samples_free(&samples);
+    return ret;
+}
+
+/*---------------------------------------------------------------------------*/
+static hg_return_t
+hg_bench_proc(struct hg_bench_info *info)
+{
+    size_t batches = (info->options.iterations + HG_BENCH_BATCH - 1)
+        / HG_BENCH_BATCH, i, j;
+    struct hg_bench_samples samples = { NULL, 0, 0 };
+    struct hg_bench_result result;
+    struct hg_bench_rpc_in in, out;
+    hg_size_t buf_size = info->options.max_size + 64;
+    void *buf = NULL;
+    hg_proc_t proc = HG_PROC_NULL;
+    size_t size;
+    hg_return_t ret;
+
+    in.buf = calloc(1, info->options.max_size + 1);
+    buf = malloc(buf_size);
+    if (!in.buf || !buf) {
+        ret = HG_NOMEM_ERROR;
+        goto done;
+    }
+    ret = hg_proc_create(info->client_class, HG_NOHASH, &proc);
+    if (ret != HG_SUCCESS)
+        goto done;
+
+    for (size = 0; size <= info->options.max_size;
+        size = (size) ? size * 4 : 8) {
+        double start;
+
+        if (hg_bench_samples_init(&samples, batches) != HG_UTIL_SUCCESS) {
+            ret = HG_NOMEM_ERROR;
+            goto done;
+        }
+        in.size = (hg_uint32_t) size;
+
+        /* Encode, decode and free */
+        start = hg_bench_time();
+        for (i = 0; i < batches; i++) {
+            double t1 = hg_bench_time();
+
+            for (j = 0; j < HG_BENCH_BATCH; j++) {
+                hg_proc_reset(proc, buf, buf_size, HG_ENCODE);
+                ret = hg_proc_hg_bench_rpc_in(proc, &in);
+                if (ret != HG_SUCCESS)
+                    goto done;
+                hg_proc_reset(proc, buf, buf_size, HG_DECODE);
+                ret = hg_proc_hg_bench_rpc_in(proc, &out);
+                if (ret != HG_SUCCESS)
+                    goto done;
+                hg_proc_reset(proc, buf, buf_size, HG_FREE);
+                hg_proc_hg_bench_rpc_in(proc, &out);
+            }
+            hg_bench_samples_add(&samples,
+                (hg_bench_time() - t1) / HG_BENCH_BATCH);
+        }
+
+        memset(&result, 0, sizeof(result));
+        result.name = "proc";
+        result.size = size;
+        result.segments = result.threads = result.window = 1;
+        hg_bench_result_compute(&result, &samples, batches * HG_BENCH_BATCH,
+            hg_bench_time() - start,
+            (double) (size * batches * HG_BENCH_BATCH));
+        hg_bench_output_write(&info->output, &result);
+        hg_bench_samples_free(&samples);
+    }
+
+done:
+    hg_bench_samples_free(&samples);
+    if (proc != HG_PROC_NULL)
+        hg_proc_free(proc);
+    free(buf);
+    free(in.buf);
+    return ret;
+}
+
+/*---------------------------------------------------------------------------*/
+static double
+hg_bench_interval(double rate, hg_bool_t poisson, hg_uint64_t *state)
+{
+    double u;
+
+    if (!poisson)
+        return 1.0 / rate;
+
+    /* xorshift64, uniform in (0, 1] */
+    *state ^= *state << 13;
+    *state ^= *state >> 7;
+    *state ^= *state << 17;
+    u = (double) ((*state >> 11) + 1) / 9007199254740992.0;
+
+    return -log(u) / rate;
+}
+
+/*---------------------------------------------------------------------------*/
+static hg_return_t
+hg_bench_rpc_open(struct hg_bench_info *info)
+{
+    struct hg_bench_histogram histogram = { NULL, 0, 0, 0, 0 };
+    struct hg_bench_window window;
+    struct hg_bench_result result;
+    struct hg_bench_rpc_in in = { 0, NULL };
+    hg_uint64_t state = 0x9E3779B97F4A7C15ULL;
+    const char *rates = info->options.rates;
+    hg_return_t ret = HG_SUCCESS;
+
+    memset(&window, 0, sizeof(window));
+    window.context = info->client_context;
+    window.addr = info->target_addr;
+    window.id = info->rpc_id;
+    window.in_struct = &in;
+    window.get_output = HG_TRUE;
+
+    while (*rates) {
+        double rate = strtod(rates, NULL), duration, start, next, end;
+        size_t delayed = 0;
+
+        rates += strcspn(rates, ",");
+        if (*rates)
+            rates++;
+        if (rate <= 0)
+            continue;
+
+        if (info->options.warmup) {
+            window.size = info->options.window;
+            window.histogram = NULL;
+            ret = hg_bench_window_run(&window, info->options.warmup);
+            if (ret != HG_SUCCESS)
+                break;
+        }
+
+        if (hg_bench_histogram_init(&histogram) != HG_UTIL_SUCCESS) {
+            ret = HG_NOMEM_ERROR;
+            break;
+        }
+        ret = hg_bench_window_init(&window, info->options.open_handles);
+        if (ret != HG_SUCCESS)
+            break;
+        window.histogram = &histogram;
+
+        /* Issue RPCs at their scheduled time regardless of completions;
+         * latency is measured from the scheduled time so that a stalled
+         * target cannot hide queueing delay (coordinated omission) */
+        duration = (double) info->options.duration / 1000.0;
+        start = hg_bench_time();
+        end = start + duration;
+        next = start + hg_bench_interval(rate, info->options.poisson, &state);
+        while (window.completed < window.issued || next < end) {
+            double now = hg_bench_time();
+            unsigned int timeout = HG_BENCH_TIMEOUT;
+
+            while (next <= now && next < end && window.ready_count
+                && window.ret == HG_SUCCESS) {
+                unsigned int index = window.ready[--window.ready_count];
+
+                if (now - next > 1.0 / rate)
+                    delayed++;
+                window.slots[index].start = next;
+                ret = HG_Forward(window.handles[index], hg_bench_forward_cb,
+                    &window.slots[index], window.in_struct);
+                if (ret != HG_SUCCESS) {
+                    fprintf(stderr, "Could not forward call\n");
+                    window.ret = ret;
+                    break;
+                }
+                window.issued++;
+                next += hg_bench_interval(rate, info->options.poisson,
+                    &state);
+            }
+            if (window.ret != HG_SUCCESS) {
+                if (window.completed == window.issued)
+                    break;
+                next = end;
+            }
+            if (next < end && window.ready_count) {
+                now = hg_bench_time();
+                timeout = (next > now) ? (unsigned int) ((next - now) * 1000.0)
+                    : 0;
+            }
+            ret = hg_bench_progress(window.context, timeout);
+            if (ret != HG_SUCCESS)
+                break;
+        }
+        window.elapsed = hg_bench_time() - start;
+        hg_bench_window_free(&window);
+        window.histogram = NULL;
+        if (ret == HG_SUCCESS)
+            ret = window.ret;
+        if (ret != HG_SUCCESS)
+            break;
+        if (delayed)
+            fprintf(stderr, "Warning: %zu of %zu RPCs sent late at %.0f RPC/s "
+                "(%u handles)\n", delayed, window.issued, rate,
+                info->options.open_handles);
+
+        memset(&result, 0, sizeof(result));
+        result.name = "rpc_open";
+        result.segments = result.threads = 1;
+        result.window = info->options.open_handles;
+        result.offered = rate;
+        hg_bench_result_compute_histogram(&result, &histogram,
+            window.completed, window.elapsed, 0);
+        hg_bench_output_write(&info->output, &result);
+        hg_bench_histogram_free(&histogram);
+    }
+
+    hg_bench_window_free(&window);
+    hg_bench_histogram_free(&histogram);
+    return ret;
+}
+
+/*---------------------------------------------------------------------------*/
+int
+main(int argc, char *argv[])
+{
+    struct hg_bench_info info;
+    const struct hg_bench_entry *entry;
+    hg_bool_t need_hg = HG_FALSE;
+    int ret = EXIT_SUCCESS;
+
+    memset(&info, 0, sizeof(info));
+    info.server_bulk = HG_BULK_NULL;
+    info.target_addr = HG_ADDR_NULL;
+    if (hg_bench_parse_options(argc, argv, &info.options) != HG_UTIL_SUCCESS) {
+        hg_bench_usage(argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    for (entry = hg_bench_entries_g; entry->name; entry++)
+        if (entry->run != hg_bench_na_lat
+            && hg_bench_selected(info.options.benchmarks, entry->name))
+            need_hg = HG_TRUE;
+    if (need_hg && hg_bench_hg_init(&info) != HG_SUCCESS) {
+        ret = EXIT_FAILURE;
+        goto done;
+    }
+
+    if (hg_bench_output_open(&info.output, info.options.format,
+        info.options.output_name) != HG_UTIL_SUCCESS) {
+        ret = EXIT_FAILURE;
+        goto done;
+    }
+    for (entry = hg_bench_entries_g; entry->name; entry++) {
+        if (!hg_bench_selected(info.options.benchmarks, entry->name))
+            continue;
+        if (entry->run(&info) != HG_SUCCESS) {
+            fprintf(stderr, "Benchmark %s failed\n", entry->name);
+            ret = EXIT_FAILURE;
+            break;
+        }
+    }
+    if (hg_bench_output_close(&info.output) != HG_UTIL_SUCCESS)
+        ret = EXIT_FAILURE;
+
+done:
+    hg_bench_hg_finalize(&info);
+    return ret;
+}
@@ -0,0 +1,778 @@
+/*
+ * Copyright (C) 2013-2017 Argonne National Laboratory, Department of Energy,
+ *                    UChicago Argonne, LLC and The HDF Group.
+ * All rights reserved.
+ *
+ * The full copyright notice, including terms governing use, modification,
+ * and redistribution, is contained in the COPYING file that can be
+ * found at the root of the source code distribution tree.
+ */
+
+/*
+ * hg_bench_proc: serialization micro-benchmark.
+ *
+ * Encodes and decodes representative structs (scalars, strings, bulk
+ * handles, nested structs and large arrays) in a tight loop, the same way
+ * HG_Forward() and the target would (proc reset, encode / decode, flush and
+ * checksum), without any network involved. Results report the time per
+ * operation and the encoded size (bytes per operation, "size" column).
+ * Each struct is run with the default and with the compact (varint)
+ * encoding. When hg_proc_gen is built, the same structs generated from
+ * hg_bench_proc.schema are run right after the MERCURY_GEN_PROC ones
+ * ("_gen" names) so that both can be compared. Checksums and XDR are build options, results carry a "+crc32"
+ * / "+xdr" suffix when enabled so that runs of different builds can be
+ * compared.
+ */
+
+#include "mercury_bench.h"
+#include "mercury_test_config.h"
+
+#include "mercury.h"
+#include "mercury_bulk.h"
+#include "mercury_macros.h"
+#include "mercury_proc.h"
+#include "mercury_proc_string.h"
+#ifdef HG_TESTING_HAS_PROC_GEN
+#include "hg_bench_proc_gen.h"
+#endif
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/****************/
+/* Local Macros */
+/****************/
+
+#define HG_BENCH_NA_INFO        "na+sm"
+#define HG_BENCH_ITERATIONS     100000
+#define HG_BENCH_STRING_LEN     256
+#define HG_BENCH_ARRAY_LEN      4096
+#define HG_BENCH_BULK_SIZE      (1024 * 1024)
+
+/* Operations per sample, single operations are too short to time */
+#define HG_BENCH_BATCH          100
+
+#define HG_BENCH_NAME_MAX       64
+
+#ifdef HG_TESTING_HAS_PROC_GEN
+#define HG_BENCH_STRUCT_COUNT   9
+#else
+#define HG_BENCH_STRUCT_COUNT   5
+#endif
+
+/************************************/
+/* Local Type and Struct Definition */
+/************************************/
+
+/* User defined struct, see MERCURY_GEN_STRUCT_PROC */
+typedef struct {
+    hg_uint64_t cookie;
+    hg_uint32_t version;
+} hg_bench_handle_t;
+
+#ifdef HG_HAS_BOOST
+MERCURY_GEN_STRUCT_PROC( hg_bench_handle_t,
+    ((hg_uint64_t)(cookie)) ((hg_uint32_t)(version)) )
+
+MERCURY_GEN_PROC( hg_bench_scalar_t,
+    ((hg_uint64_t)(id)) ((hg_uint64_t)(offset)) ((hg_uint32_t)(flags))
+    ((hg_int32_t)(mode)) ((hg_int16_t)(prio)) ((hg_uint8_t)(type)) )
+
+MERCURY_GEN_PROC( hg_bench_string_t,
+    ((hg_const_string_t)(path)) ((hg_const_string_t)(name)) )
+
+MERCURY_GEN_PROC( hg_bench_bulk_t,
+    ((hg_bulk_t)(bulk)) ((hg_uint64_t)(offset)) ((hg_uint64_t)(size)) )
+
+MERCURY_GEN_PROC( hg_bench_nested_t,
+    ((hg_bench_handle_t)(handle)) ((hg_bench_scalar_t)(attr))
+    ((hg_const_string_t)(path)) ((hg_bulk_t)(bulk)) )
+#else /* HG_HAS_BOOST */
+/* Define hg_proc_hg_bench_handle_t */
+static HG_INLINE hg_return_t
+hg_proc_hg_bench_handle_t(hg_proc_t proc, void *data)
+{
+    hg_return_t ret = HG_SUCCESS;
+    hg_bench_handle_t *struct_data = (hg_bench_handle_t *) data;
+
+    ret = hg_proc_hg_uint64_t(proc, &struct_data->cookie);
+    if (ret != HG_SUCCESS) {
+        HG_LOG_ERROR("Proc error");
+        return ret;
+    }
+
+    ret = hg_proc_hg_uint32_t(proc, &struct_data->version);
+    if (ret != HG_SUCCESS) {
+        HG_LOG_ERROR("Proc error");
+        return ret;
+    }
+
+    return ret;
+}
+
+/* Define hg_bench_scalar_t */
+typedef struct {
+    hg_uint64_t id;
+    hg_uint64_t offset;
+    hg_uint32_t flags;
+    hg_int32_t mode;
+    hg_int16_t prio;
+    hg_uint8_t type;
+} hg_bench_scalar_t;
+
+/* Define hg_proc_hg_bench_scalar_t */
+static HG_INLINE hg_return_t
+hg_proc_hg_bench_scalar_t(hg_proc_t proc, void *data)
+{
+    hg_return_t ret = HG_SUCCESS;
+    hg_bench_scalar_t *struct_data = (hg_bench_scalar_t *) data;
+
+    ret = hg_proc_hg_uint64_t(proc, &struct_data->id);
+    if (ret != HG_SUCCESS) {
+        HG_LOG_ERROR("Proc error");
+        return ret;
+    }
+
+    ret = hg_proc_hg_uint64_t(proc, &struct_data->offset);
+    if (ret != HG_SUCCESS) {
+        HG_LOG_ERROR("Proc error");
+        return ret;
+    }
+
+    ret = hg_proc_hg_uint32_t(proc, &struct_data->flags);
+    if (ret != HG_SUCCESS) {
+        HG_LOG_ERROR("Proc error");
+        return ret;
+    }
+
+    ret = hg_proc_hg_int32_t(proc, &struct_data->mode);
+    if (ret != HG_SUCCESS) {
+        HG_LOG_ERROR("Proc error");
+        return ret;
+    }
+
+    ret = hg_proc_hg_int16_t(proc, &struct_data->prio);
+    if (ret != HG_SUCCESS) {
+        HG_LOG_ERROR("Proc error");
+        return ret;
+    }
+
+    ret = hg_proc_hg_uint8_t(proc, &struct_data->type);
+    if (ret != HG_SUCCESS) {
+        HG_LOG_ERROR("Proc error");
+        return ret;
+    }
+
+    return ret;
+}
+
+/* Define hg_bench_string_t */
+typedef struct {
+    hg_const_string_t path;
+    hg_const_string_t name;
+} hg_bench_string_t;
+
+/* Define hg_proc_hg_bench_string_t */
+static HG_INLINE hg_return_t
+hg_proc_hg_bench_string_t(hg_proc_t proc, void *data)
+{
+    hg_return_t ret = HG_SUCCESS;
+    hg_bench_string_t *struct_data = (hg_bench_string_t *) data;
+
+    ret = hg_proc_hg_const_string_t(proc, &struct_data->path);
+    if (ret != HG_SUCCESS) {
+        HG_LOG_ERROR("Proc error");
+        return ret;
+    }
+
+    ret = hg_proc_hg_const_string_t(proc, &struct_data->name);
+    if (ret != HG_SUCCESS) {
+        HG_LOG_ERROR("Proc error");
+        return ret;
+    }
+
+    return ret;
+}
+
+/* Define hg_bench_bulk_t */
+typedef struct {
+    hg_bulk_t bulk;
+    hg_uint64_t offset;
+    hg_uint64_t size;
+} hg_bench_bulk_t;
+
+/* Define hg_proc_hg_bench_bulk_t */
+static HG_INLINE hg_return_t
+hg_proc_hg_bench_bulk_t(hg_proc_t proc, void *data)
+{
+    hg_return_t ret = HG_SUCCESS;
+    hg_bench_bulk_t *struct_data = (hg_bench_bulk_t *) data;
+
+    ret = hg_proc_hg_bulk_t(proc, &struct_data->bulk);
+    if (ret != HG_SUCCESS) {
+        HG_LOG_ERROR("Proc error");
+        return ret;
+    }
+
+    ret = hg_proc_hg_uint64_t(proc, &struct_data->offset);
+    if (ret != HG_SUCCESS) {
+        HG_LOG_ERROR("Proc error");
+        return ret;
+    }
+
+    ret = hg_proc_hg_uint64_t(proc, &struct_data->size);
+    if (ret != HG_SUCCESS) {
+        HG_LOG_ERROR("Proc error");
+        return ret;
+    }
+
+    return ret;
+}
+
+/* Define hg_bench_nested_t */
+typedef struct {
+    hg_bench_handle_t handle;
+    hg_bench_scalar_t attr;
+    hg_const_string_t path;
+    hg_bulk_t bulk;
+} hg_bench_nested_t;
+
+/* Define hg_proc_hg_bench_nested_t */
+static HG_INLINE hg_return_t
+hg_proc_hg_bench_nested_t(hg_proc_t proc, void *data)
+{
+    hg_return_t ret = HG_SUCCESS;
+    hg_bench_nested_t *struct_data = (hg_bench_nested_t *) data;
+
+    ret = hg_proc_hg_bench_handle_t(proc, &struct_data->handle);
+    if (ret != HG_SUCCESS) {
+        HG_LOG_ERROR("Proc error");
+        return ret;
+    }
+
+    ret = hg_proc_hg_bench_scalar_t(proc, &struct_data->attr);
+    if (ret != HG_SUCCESS) {
+        HG_LOG_ERROR("Proc error");
+        return ret;
+    }
+
+    ret = hg_proc_hg_const_string_t(proc, &struct_data->path);
+    if (ret != HG_SUCCESS) {
+        HG_LOG_ERROR("Proc error");
+        return ret;
+    }
+
+    ret = hg_proc_hg_bulk_t(proc, &struct_data->bulk);
+    if (ret != HG_SUCCESS) {
+        HG_LOG_ERROR("Proc error");
+        return ret;
+    }
+
+    return ret;
+}
+#endif /* HG_HAS_BOOST */
+
+/* Variable length array, the generator macros do not handle arrays */
+typedef struct {
+    hg_uint32_t count;
+    hg_uint64_t *values;
+} hg_bench_array_t;
+
+/* Struct to benchmark */
+struct hg_bench_proc_struct {
+    const char *name;
+    hg_proc_cb_t proc_cb;
+    void *in;                       /* Encoded struct */
+    size_t out_size;                /* Size of decoded struct */
+};
+
+struct hg_bench_proc_options {
+    const char *na_info;            /* NA info string */
+    const char *output_name;        /* Output file name or NULL for stdout */
+    hg_bench_format_t format;       /* Output format */
+    unsigned int iterations;        /* Operations per run */
+    size_t string_len;              /* Length of strings */
+    unsigned int array_len;         /* Number of array elements */
+};
+
+/********************/
+/* Local Prototypes */
+/********************/
+
+static hg_return_t
+hg_proc_hg_bench_array_t(hg_proc_t proc, void *data);
+
+static void
+hg_bench_proc_usage(const char *name);
+
+static int
+hg_bench_proc_parse_options(int argc, char *argv[],
+    struct hg_bench_proc_options *options);
+
+/**
+ * Encode and flush, set checksum like HG_Forward() does.
+ */
+static hg_return_t
+hg_bench_proc_encode(hg_proc_t proc, void *buf, hg_size_t buf_size,
+    hg_uint8_t flags, const struct hg_bench_proc_struct *bench_struct,
+    hg_uint32_t *hash);
+
+/**
+ * Decode, flush, verify checksum and free decoded struct.
+ */
+static hg_return_t
+hg_bench_proc_decode(hg_proc_t proc, void *buf, hg_size_t buf_size,
+    hg_uint8_t flags, const struct hg_bench_proc_struct *bench_struct,
+    void *out, hg_uint32_t hash);
+
+/**
+ * Run encode and decode benchmarks for one struct.
+ */
+static hg_return_t
+hg_bench_proc_run(struct hg_bench_output *output,
+    const struct hg_bench_proc_options *options, hg_proc_t proc, void *buf,
+    hg_size_t buf_size, hg_uint8_t flags,
+    const struct hg_bench_proc_struct *bench_struct);
+
+/*******************/
+/* Local Variables */
+/*******************/
+
+/* Suffix of result names for build options that change serialization */
+static const char hg_bench_proc_suffix_g[] = ""
+#ifdef HG_HAS_XDR
+    "+xdr"
+#endif
+#ifdef HG_HAS_CHECKSUMS
+    "+crc32"
+#endif
+    ;
+
+/*---------------------------------------------------------------------------*/
+static hg_return_t
+hg_proc_hg_bench_array_t(hg_proc_t proc, void *data)
+{
+    hg_bench_array_t *struct_data = (hg_bench_array_t *) data;
+    hg_uint32_t i;
+    hg_return_t ret;
+
+    ret = hg_proc_hg_uint32_t(proc, &struct_data->count);
+    if (ret != HG_SUCCESS) {
+        HG_LOG_ERROR("Proc error");
+        return ret;
+    }
+
+    switch (hg_proc_get_op(proc)) {
+        case HG_DECODE:
+            struct_data->values = (hg_uint64_t *) malloc(
+                struct_data->count * sizeof(hg_uint64_t));
+            if (!struct_data->values)
+                return HG_NOMEM_ERROR;
+            break;
+        case HG_FREE:
+            free(struct_data->values);
+            struct_data->values = NULL;
+            return HG_SUCCESS;
+        case HG_ENCODE:
+        default:
+            break;
+    }
+
+    for (i = 0; i < struct_data->count; i++) {
+        ret = hg_proc_hg_uint64_t(proc, &struct_data->values[i]);
+        if (ret != HG_SUCCESS) {
+            HG_LOG_ERROR("Proc error");
+            return ret;
+        }
+    }
+
+    return ret;
+}
+
+/*---------------------------------------------------------------------------*/
+static void
+hg_bench_proc_usage(const char *name)
+{
+    fprintf(stderr, "usage: %s [options]\n"
+        "  -p <na_info>    NA info string (default: %s)\n"
+        "  -f <format>     text, csv or json (default: text)\n"
+        "  -o <file>       output file (default: stdout)\n"
+        "  -n <count>      operations per run (default: %d)\n"
+        "  -l <length>     string length (default: %d)\n"
+        "  -a <count>      array elements (default: %d)\n",
+        name, HG_BENCH_NA_INFO, HG_BENCH_ITERATIONS, HG_BENCH_STRING_LEN,
+        HG_BENCH_ARRAY_LEN);
+}
+
+/*---------------------------------------------------------------------------*/
+static int
+hg_bench_proc_parse_options(int argc, char *argv[],
+    struct hg_bench_proc_options *options)
+{
+    int i;
+
+    options->na_info = HG_BENCH_NA_INFO;
+    options->output_name = NULL;
+    options->format = HG_BENCH_TEXT;
+    options->iterations = HG_BENCH_ITERATIONS;
+    options->string_len = HG_BENCH_STRING_LEN;
+    options->array_len = HG_BENCH_ARRAY_LEN;
+
+    for (i = 1; i < argc; i++) {
+        const char *arg = argv[i];
+
+        if (arg[0] != '-' || !arg[1] || arg[2] || i + 1 >= argc)
+            return HG_UTIL_FAIL;
+        i++;
+        switch (arg[1]) {
+            case 'p':
+                options->na_info = argv[i];
+                break;
+            case 'f':
+                if (hg_bench_format_parse(argv[i], &options->format)
+                    != HG_UTIL_SUCCESS)
+                    return HG_UTIL_FAIL;
+                break;
+            case 'o':
+                options->output_name = argv[i];
+                break;
+            case 'n':
+                options->iterations = (unsigned int) atoi(argv[i]);
+                break;
+            case 'l':
+                options->string_len = (size_t) atol(argv[i]);
+                break;
+            case 'a':
+                options->array_len = (unsigned int) atoi(argv[i]);
+                break;
+            default:
+                return HG_UTIL_FAIL;
+        }
+    }
+    if (options->iterations < HG_BENCH_BATCH)
+        return HG_UTIL_FAIL;
+
+    return HG_UTIL_SUCCESS;
+}
+
+/*---------------------------------------------------------------------------*/
+static hg_return_t
+hg_bench_proc_encode(hg_proc_t proc, void *buf, hg_size_t buf_size,
+    hg_uint8_t flags, const struct hg_bench_proc_struct *bench_struct,
+    hg_uint32_t *hash)
+{
+    hg_return_t ret;
+
+    hg_proc_reset(proc, buf, buf_size, HG_ENCODE);
+    hg_proc_set_flags(proc, flags);
+    ret = bench_struct->proc_cb(proc, bench_struct->in);
+    if (ret != HG_SUCCESS)
+        return ret;
+    ret = hg_proc_flush(proc);
+    if (ret != HG_SUCCESS)
+        return ret;
+#ifdef HG_HAS_CHECKSUMS
+    ret = hg_proc_checksum_get(proc, hash, sizeof(*hash));
+#else
+    (void) hash;
+#endif
+
+    return ret;
+}
+
+/*---------------------------------------------------------------------------*/
+static hg_return_t
+hg_bench_proc_decode(hg_proc_t proc, void *buf, hg_size_t buf_size,
+    hg_uint8_t flags, const struct hg_bench_proc_struct *bench_struct,
+    void *out, hg_uint32_t hash)
+{
+    hg_return_t ret;
+
+    hg_proc_reset(proc, buf, buf_size, HG_DECODE);
+    hg_proc_set_flags(proc, flags);
+    ret = bench_struct->proc_cb(proc, out);
+    if (ret != HG_SUCCESS)
+        return ret;
+    ret = hg_proc_flush(proc);
+#ifdef HG_HAS_CHECKSUMS
+    if (ret == HG_SUCCESS)
+        ret = hg_proc_checksum_verify(proc, &hash, sizeof(hash));
+#else
+    (void) hash;
+#endif
+
+    /* Release what decoding allocated (strings, bulk handles, etc) */
+    hg_proc_reset(proc, buf, buf_size, HG_FREE);
+    hg_proc_set_flags(proc, flags);
+    bench_struct->proc_cb(proc, out);
+
+    return ret;
+}
+
+/*---------------------------------------------------------------------------*/
+static hg_return_t
+hg_bench_proc_run(struct hg_bench_output *output,
+    const struct hg_bench_proc_options *options, hg_proc_t proc, void *buf,
+    hg_size_t buf_size, hg_uint8_t flags,
+    const struct hg_bench_proc_struct *bench_struct)
+{
+    size_t batches = options->iterations / HG_BENCH_BATCH, i, j;
+    struct hg_bench_samples samples = { NULL, 0, 0 };
+    struct hg_bench_result result;
+    char name[HG_BENCH_NAME_MAX];
+    hg_uint32_t hash = 0;
+    hg_size_t size;
+    void *out = NULL;
+    int decode;
+    hg_return_t ret;
+
+    out = malloc(bench_struct->out_size);
+    if (!out) {
+        ret = HG_NOMEM_ERROR;
+        goto done;
+    }
+
+    /* Encode once to get encoded size and a buffer to decode from */
+    ret = hg_bench_proc_encode(proc, buf, buf_size, flags, bench_struct,
+        &hash);
+    if (ret != HG_SUCCESS) {
+        fprintf(stderr, "Could not encode %s\n", bench_struct->name);
+        goto done;
+    }
+    size = hg_proc_get_size_used(proc);
+    if (hg_proc_get_extra_buf(proc)) {
+        fprintf(stderr, "Encoded %s does not fit into buffer\n",
+            bench_struct->name);
+        ret = HG_SIZE_ERROR;
+        goto done;
+    }
+
+    for (decode = 0; decode <= 1; decode++) {
+        double start;
+
+        if (hg_bench_samples_init(&samples, batches) != HG_UTIL_SUCCESS) {
+            ret = HG_NOMEM_ERROR;
+            goto done;
+        }
+
+        start = hg_bench_time();
+        for (i = 0; i < batches; i++) {
+            double t1 = hg_bench_time();
+
+            for (j = 0; j < HG_BENCH_BATCH; j++) {
+                ret = (decode) ?
+                    hg_bench_proc_decode(proc, buf, buf_size, flags,
+                        bench_struct, out, hash) :
+                    hg_bench_proc_encode(proc, buf, buf_size, flags,
+                        bench_struct, &hash);
+                if (ret != HG_SUCCESS) {
+                    fprintf(stderr, "Could not %s %s\n",
+                        (decode) ? "decode" : "encode", bench_struct->name);
+                    goto done;
+                }
+            }
+            hg_bench_samples_add(&samples,
+                (hg_bench_time() - t1) / HG_BENCH_BATCH);
+        }
+
+        sprintf(name, "%s_%s%s%s", bench_struct->name,
+            (decode) ? "dec" : "enc",
+            (flags & HG_PROC_COMPACT) ? "+compact" : "",
+            hg_bench_proc_suffix_g);
+        memset(&result, 0, sizeof(result));
+        result.name = name;
+        result.size = (size_t) size;
+        result.segments = result.threads = result.window = 1;
+        hg_bench_result_compute(&result, &samples, batches * HG_BENCH_BATCH,
+            hg_bench_time() - start,
+            (double) size * (double) (batches * HG_BENCH_BATCH));
+        hg_bench_output_write(output, &result);
+        hg_bench_samples_free(&samples);
+    }
+
+done:
+    hg_bench_samples_free(&samples);
+    free(out);
+    return ret;
+}
+
+/*---------------------------------------------------------------------------*/
+int
+main(int argc, char *argv[])
+{
+    struct hg_bench_proc_options options;
+    struct hg_bench_output output;
+    hg_class_t *hg_class = NULL;
+    hg_proc_t proc = HG_PROC_NULL;
+    hg_bulk_t bulk = HG_BULK_NULL;
+    hg_bench_scalar_t scalar_in;
+    hg_bench_string_t string_in;
+    hg_bench_bulk_t bulk_in;
+    hg_bench_nested_t nested_in;
+    hg_bench_array_t array_in;
+#ifdef HG_TESTING_HAS_PROC_GEN
+    hg_bench_gen_scalar_t scalar_gen_in;
+    hg_bench_gen_string_t string_gen_in;
+    hg_bench_gen_bulk_t bulk_gen_in;
+    hg_bench_gen_nested_t nested_gen_in;
+#endif
+    struct hg_bench_proc_struct structs[HG_BENCH_STRUCT_COUNT];
+    unsigned int struct_count = 0;
+    char *string = NULL;
+    void *bulk_buf = NULL, *buf = NULL;
+    hg_size_t bulk_size = HG_BENCH_BULK_SIZE, buf_size;
+    hg_bool_t output_opened = HG_FALSE;
+    unsigned int i, compact;
+    int ret = EXIT_FAILURE;
+
+    array_in.values = NULL;
+    if (hg_bench_proc_parse_options(argc, argv, &options) != HG_UTIL_SUCCESS) {
+        hg_bench_proc_usage(argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    /* Class is needed for bulk handles */
+    hg_class = HG_Init(options.na_info, HG_FALSE);
+    if (!hg_class) {
+        fprintf(stderr, "Could not initialize HG class\n");
+        goto done;
+    }
+    if (hg_proc_create(hg_class, HG_CRC32, &proc) != HG_SUCCESS) {
+        fprintf(stderr, "Could not create proc\n");
+        goto done;
+    }
+
+    /* Payloads */
+    string = (char *) malloc(options.string_len + 1);
+    bulk_buf = calloc(1, bulk_size);
+    array_in.count = options.array_len;
+    array_in.values = (hg_uint64_t *) malloc(
+        options.array_len * sizeof(hg_uint64_t) + 1);
+    buf_size = 2 * options.string_len + options.array_len * 10 + 4096;
+    buf = malloc(buf_size);
+    if (!string || !bulk_buf || !array_in.values || !buf) {
+        fprintf(stderr, "Could not allocate buffers\n");
+        goto done;
+    }
+    memset(string, 'a', options.string_len);
+    string[options.string_len] = '\0';
+    for (i = 0; i < options.array_len; i++)
+        array_in.values[i] = (hg_uint64_t) i * 4096;
+    if (HG_Bulk_create(hg_class, 1, &bulk_buf, &bulk_size, HG_BULK_READ_ONLY,
+        &bulk) != HG_SUCCESS) {
+        fprintf(stderr, "Could not create bulk handle\n");
+        goto done;
+    }
+
+    /* Typical values, some small enough to benefit from varints */
+    scalar_in.id = 0x123456789ULL;
+    scalar_in.offset = 1048576;
+    scalar_in.flags = 0x2;
+    scalar_in.mode = 0644;
+    scalar_in.prio = -1;
+    scalar_in.type = 3;
+    string_in.path = string;
+    string_in.name = string;
+    bulk_in.bulk = bulk;
+    bulk_in.offset = 0;
+    bulk_in.size = bulk_size;
+    nested_in.handle.cookie = 0xdeadbeefULL;
+    nested_in.handle.version = 1;
+    nested_in.attr = scalar_in;
+    nested_in.path = string;
+    nested_in.bulk = bulk;
+
+#ifdef HG_TESTING_HAS_PROC_GEN
+    scalar_gen_in.id = scalar_in.id;
+    scalar_gen_in.offset = scalar_in.offset;
+    scalar_gen_in.flags = scalar_in.flags;
+    scalar_gen_in.mode = scalar_in.mode;
+    scalar_gen_in.prio = scalar_in.prio;
+    scalar_gen_in.type = scalar_in.type;
+    string_gen_in.path = string;
+    string_gen_in.name = string;
+    bulk_gen_in.bulk = bulk;
+    bulk_gen_in.offset = bulk_in.offset;
+    bulk_gen_in.size = bulk_in.size;
+    nested_gen_in.handle.cookie = nested_in.handle.cookie;
+    nested_gen_in.handle.version = nested_in.handle.version;
+    nested_gen_in.attr = scalar_gen_in;
+    nested_gen_in.path = string;
+    nested_gen_in.bulk = bulk;
+#endif
+
+    /* Generated variant of each struct follows the macro one */
+    structs[struct_count].name = "scalar";
+    structs[struct_count].proc_cb = hg_proc_hg_bench_scalar_t;
+    structs[struct_count].in = &scalar_in;
+    structs[struct_count++].out_size = sizeof(hg_bench_scalar_t);
+#ifdef HG_TESTING_HAS_PROC_GEN
+    structs[struct_count].name = "scalar_gen";
+    structs[struct_count].proc_cb = hg_proc_hg_bench_gen_scalar_t;
+    structs[struct_count].in = &scalar_gen_in;
+    structs[struct_count++].out_size = sizeof(hg_bench_gen_scalar_t);
+#endif
+    structs[struct_count].name = "string";
+    structs[struct_count].proc_cb = hg_proc_hg_bench_string_t;
+    structs[struct_count].in = &string_in;
+    structs[struct_count++].out_size = sizeof(hg_bench_string_t);
+#ifdef HG_TESTING_HAS_PROC_GEN
+    structs[struct_count].name = "string_gen";
+    structs[struct_count].proc_cb = hg_proc_hg_bench_gen_string_t;
+    structs[struct_count].in = &string_gen_in;
+    structs[struct_count++].out_size = sizeof(hg_bench_gen_string_t);
+#endif
+    structs[struct_count].name = "bulk";
+    structs[struct_count].proc_cb = hg_proc_hg_bench_bulk_t;
+    structs[struct_count].in = &bulk_in;
+    structs[struct_count++].out_size = sizeof(hg_bench_bulk_t);
+#ifdef HG_TESTING_HAS_PROC_GEN
+    structs[struct_count].name = "bulk_gen";
+    structs[struct_count].proc_cb = hg_proc_hg_bench_gen_bulk_t;
+    structs[struct_count].in = &bulk_gen_in;
+    structs[struct_count++].out_size = sizeof(hg_bench_gen_bulk_t);
+#endif
+    structs[struct_count].name = "nested";
+    structs[struct_count].proc_cb = hg_proc_hg_bench_nested_t;
+    structs[struct_count].in = &nested_in;
+    structs[struct_count++].out_size = sizeof(hg_bench_nested_t);
+#ifdef HG_TESTING_HAS_PROC_GEN
+    structs[struct_count].name = "nested_gen";
+    structs[struct_count].proc_cb = hg_proc_hg_bench_gen_nested_t;
+    structs[struct_count].in = &nested_gen_in;
+    structs[struct_count++].out_size = sizeof(hg_bench_gen_nested_t);
+#endif
+    structs[struct_count].name = "array";
+    structs[struct_count].proc_cb = hg_proc_hg_bench_array_t;
+    structs[struct_count].in = &array_in;
+    structs[struct_count++].out_size = sizeof(hg_bench_array_t);
+
+    if (hg_bench_output_open(&output, options.format, options.output_name)
+        != HG_UTIL_SUCCESS)
+        goto done;
+    output_opened = HG_TRUE;
+
+    for (compact = 0; compact <= 1; compact++)
+        for (i = 0; i < struct_count; i++)
+            if (hg_bench_proc_run(&output, &options, proc, buf, buf_size,
+                (hg_uint8_t) ((compact) ? HG_PROC_COMPACT : 0), &structs[i])
+                != HG_SUCCESS)
+                goto done;
+    ret = EXIT_SUCCESS;
+
+done:
+    if (output_opened && hg_bench_output_close(&output) != HG_UTIL_SUCCESS)
+        ret = EXIT_FAILURE;
+    if (bulk != HG_BULK_NULL)
+        HG_Bulk_free(bulk);
+    if (proc != HG_PROC_NULL)
+        hg_proc_free(proc);
+    if (hg_class)
+        HG_Finalize(hg_class);
+    free(buf);
+    free(array_in.values);
+    free(bulk_buf);
+    free(string);
+    return ret;
+}
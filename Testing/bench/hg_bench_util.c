@@ -0,0 +1,934 @@
+/*
+ * Copyright (C) 2013-2017 Argonne National Laboratory, Department of Energy,
+ *                    UChicago Argonne, LLC and The HDF Group.
+ * All rights reserved.
+ *
+ * The full copyright notice, including terms governing use, modification,
+ * and redistribution, is contained in the COPYING file that can be
+ * found at the root of the source code distribution tree.
+ */
+
+/*
+ * hg_bench_util: throughput and scalability of the util primitives.
+ *
+ * Contended benchmarks are run with 1, 2, 4, ... up to the max number of
+ * threads so that results form scaling curves (one result per thread
+ * count). Latency benchmarks (request, poll) are ping-pongs between two
+ * threads and report round-trip times.
+ */
+
+#include "mercury_bench.h"
+
+#include "mercury_atomic.h"
+#include "mercury_atomic_queue.h"
+#include "mercury_event.h"
+#include "mercury_poll.h"
+#include "mercury_request.h"
+#include "mercury_thread.h"
+#include "mercury_thread_mutex.h"
+#include "mercury_thread_pool.h"
+#include "mercury_thread_rwlock.h"
+#include "mercury_thread_spin.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/****************/
+/* Local Macros */
+/****************/
+
+#define HG_BENCH_ITERATIONS     100000
+#define HG_BENCH_MAX_THREADS    8
+#define HG_BENCH_QUEUE_SIZE     1024
+
+/* Poll timeout (ms) */
+#define HG_BENCH_TIMEOUT        1000
+
+/************************************/
+/* Local Type and Struct Definition */
+/************************************/
+
+struct hg_bench_util_options {
+    const char *benchmarks;         /* Comma separated list or NULL for all */
+    const char *output_name;        /* Output file name or NULL for stdout */
+    hg_bench_format_t format;       /* Output format */
+    unsigned int iterations;        /* Operations per thread */
+    unsigned int max_threads;       /* Max number of threads */
+};
+
+struct hg_bench_util_info;
+
+/* Function run by each thread of a contended benchmark */
+typedef void (*hg_bench_util_func_t)(struct hg_bench_util_info *info,
+    unsigned int index);
+
+struct hg_bench_util_info {
+    struct hg_bench_util_options options;
+    struct hg_bench_output output;
+    hg_bench_util_func_t func;      /* Thread function of current run */
+    unsigned int thread_count;      /* Threads of current run */
+    hg_atomic_int32_t ready;        /* Threads ready to start */
+    hg_atomic_int32_t go;           /* Start flag */
+    hg_atomic_int32_t counter;      /* Shared counter */
+    hg_atomic_int32_t error;        /* Set if a thread failed */
+
+    /* Primitives under test */
+    struct hg_atomic_queue *queue;
+    hg_thread_spin_t spin;
+    hg_thread_mutex_t mutex;
+    hg_thread_rwlock_t rwlock;
+    hg_util_int32_t value;          /* Value protected by lock */
+};
+
+struct hg_bench_util_thread {
+    struct hg_bench_util_info *info;
+    unsigned int index;
+    hg_thread_t thread;
+};
+
+/* Work posted to thread pool */
+struct hg_bench_util_work {
+    struct hg_thread_work work;
+    struct hg_bench_util_info *info;
+    double posted;                  /* Post time */
+    double latency;                 /* Post to execution time */
+};
+
+/* One side of a ping-pong */
+struct hg_bench_util_peer {
+    hg_request_class_t *request_class;
+    hg_request_t *request;          /* Request completed by the other side */
+    hg_poll_set_t *poll_set;
+    int event;                      /* Event set by the other side */
+};
+
+struct hg_bench_util_pingpong {
+    struct hg_bench_util_info *info;
+    struct hg_bench_util_peer peers[2];
+    unsigned int count;             /* Round trips */
+    struct hg_bench_samples *samples;
+    int ret;
+};
+
+struct hg_bench_util_entry {
+    const char *name;
+    int (*run)(struct hg_bench_util_info *info);
+};
+
+/********************/
+/* Local Prototypes */
+/********************/
+
+static void
+hg_bench_util_usage(const char *name);
+
+static int
+hg_bench_util_parse_options(int argc, char *argv[],
+    struct hg_bench_util_options *options);
+
+static hg_util_bool_t
+hg_bench_util_selected(const char *list, const char *name);
+
+/**
+ * Wait for all threads to be ready and for the start flag.
+ */
+static void
+hg_bench_util_barrier(struct hg_bench_util_info *info);
+
+static HG_THREAD_RETURN_TYPE
+hg_bench_util_thread_run(void *arg);
+
+/**
+ * Run func on thread_count threads (plus extra threads that do not count
+ * as operation issuers), report total throughput.
+ */
+static int
+hg_bench_util_scale(struct hg_bench_util_info *info, const char *name,
+    hg_bench_util_func_t func, unsigned int thread_count, unsigned int extra);
+
+/**
+ * Run func on 1, 2, 4, ... up to max threads.
+ */
+static int
+hg_bench_util_scale_all(struct hg_bench_util_info *info, const char *name,
+    hg_bench_util_func_t func, unsigned int extra);
+
+static void
+hg_bench_util_queue_mc(struct hg_bench_util_info *info, unsigned int index);
+
+static void
+hg_bench_util_queue_produce(struct hg_bench_util_info *info,
+    unsigned int index);
+
+static void
+hg_bench_util_spin(struct hg_bench_util_info *info, unsigned int index);
+
+static void
+hg_bench_util_mutex(struct hg_bench_util_info *info, unsigned int index);
+
+static void
+hg_bench_util_rwlock_rd(struct hg_bench_util_info *info, unsigned int index);
+
+static void
+hg_bench_util_rwlock_wr(struct hg_bench_util_info *info, unsigned int index);
+
+static HG_THREAD_RETURN_TYPE
+hg_bench_util_pool_work(void *arg);
+
+static int
+hg_bench_util_request_progress(unsigned int timeout, void *arg);
+
+static int
+hg_bench_util_request_trigger(unsigned int timeout, unsigned int *flag,
+    void *arg);
+
+static int
+hg_bench_util_poll_cb(void *arg, unsigned int timeout,
+    hg_util_bool_t *progressed);
+
+static HG_THREAD_RETURN_TYPE
+hg_bench_util_request_pong(void *arg);
+
+static HG_THREAD_RETURN_TYPE
+hg_bench_util_poll_pong(void *arg);
+
+static int
+hg_bench_util_queue(struct hg_bench_util_info *info);
+
+static int
+hg_bench_util_locks(struct hg_bench_util_info *info);
+
+static int
+hg_bench_util_pool(struct hg_bench_util_info *info);
+
+static int
+hg_bench_util_request(struct hg_bench_util_info *info);
+
+static int
+hg_bench_util_poll(struct hg_bench_util_info *info);
+
+/*******************/
+/* Local Variables */
+/*******************/
+
+static const struct hg_bench_util_entry hg_bench_util_entries_g[] = {
+    { "queue", hg_bench_util_queue },
+    { "lock", hg_bench_util_locks },
+    { "pool", hg_bench_util_pool },
+    { "request", hg_bench_util_request },
+    { "poll", hg_bench_util_poll },
+    { NULL, NULL }
+};
+
+/*---------------------------------------------------------------------------*/
+static void
+hg_bench_util_usage(const char *name)
+{
+    const struct hg_bench_util_entry *entry;
+
+    fprintf(stderr, "usage: %s [options]\n"
+        "  -b <list>       comma separated benchmarks (default: all)\n"
+        "  -f <format>     text, csv or json (default: text)\n"
+        "  -o <file>       output file (default: stdout)\n"
+        "  -n <count>      operations per thread (default: %d)\n"
+        "  -t <count>      max threads (default: %d)\n"
+        "benchmarks:", name, HG_BENCH_ITERATIONS, HG_BENCH_MAX_THREADS);
+    for (entry = hg_bench_util_entries_g; entry->name; entry++)
+        fprintf(stderr, " %s", entry->name);
+    fprintf(stderr, "\n");
+}
+
+/*---------------------------------------------------------------------------*/
+static int
+hg_bench_util_parse_options(int argc, char *argv[],
+    struct hg_bench_util_options *options)
+{
+    int i;
+
+    options->benchmarks = NULL;
+    options->output_name = NULL;
+    options->format = HG_BENCH_TEXT;
+    options->iterations = HG_BENCH_ITERATIONS;
+    options->max_threads = HG_BENCH_MAX_THREADS;
+
+    for (i = 1; i < argc; i++) {
+        const char *arg = argv[i];
+
+        if (arg[0] != '-' || !arg[1] || arg[2] || i + 1 >= argc)
+            return HG_UTIL_FAIL;
+        i++;
+        switch (arg[1]) {
+            case 'b':
+                options->benchmarks = argv[i];
+                break;
+            case 'f':
+                if (hg_bench_format_parse(argv[i], &options->format)
+                    != HG_UTIL_SUCCESS)
+                    return HG_UTIL_FAIL;
+                break;
+            case 'o':
+                options->output_name = argv[i];
+                break;
+            case 'n':
+                options->iterations = (unsigned int) atoi(argv[i]);
+                break;
+            case 't':
+                options->max_threads = (unsigned int) atoi(argv[i]);
+                break;
+            default:
+                return HG_UTIL_FAIL;
+        }
+    }
+    if (!options->iterations || !options->max_threads)
+        return HG_UTIL_FAIL;
+
+    return HG_UTIL_SUCCESS;
+}
+
+/*---------------------------------------------------------------------------*/
+static hg_util_bool_t
+hg_bench_util_selected(const char *list, const char *name)
+{
+    size_t len = strlen(name);
+    const char *p = list;
+
+    if (!list)
+        return HG_UTIL_TRUE;
+
+    while (p && *p) {
+        if (!strncmp(p, name, len) && (p[len] == ',' || p[len] == '\0'))
+            return HG_UTIL_TRUE;
+        p = strchr(p, ',');
+        if (p)
+            p++;
+    }
+
+    return HG_UTIL_FALSE;
+}
+
+/*---------------------------------------------------------------------------*/
+static void
+hg_bench_util_barrier(struct hg_bench_util_info *info)
+{
+    hg_atomic_incr32(&info->ready);
+    while (!hg_atomic_get32(&info->go))
+        hg_thread_yield();
+}
+
+/*---------------------------------------------------------------------------*/
+static HG_THREAD_RETURN_TYPE
+hg_bench_util_thread_run(void *arg)
+{
+    struct hg_bench_util_thread *thread =
+        (struct hg_bench_util_thread *) arg;
+    hg_thread_ret_t tret = (hg_thread_ret_t) 0;
+
+    hg_bench_util_barrier(thread->info);
+    thread->info->func(thread->info, thread->index);
+
+    hg_thread_exit(tret);
+    return tret;
+}
+
+/*---------------------------------------------------------------------------*/
+static int
+hg_bench_util_scale(struct hg_bench_util_info *info, const char *name,
+    hg_bench_util_func_t func, unsigned int thread_count, unsigned int extra)
+{
+    struct hg_bench_util_thread *threads;
+    struct hg_bench_result result;
+    unsigned int i, created = 0;
+    double start;
+    int ret = HG_UTIL_SUCCESS;
+
+    threads = (struct hg_bench_util_thread *) calloc(thread_count + extra,
+        sizeof(struct hg_bench_util_thread));
+    if (!threads)
+        return HG_UTIL_FAIL;
+
+    info->func = func;
+    info->thread_count = thread_count;
+    info->value = 0;
+    hg_atomic_set32(&info->ready, 0);
+    hg_atomic_set32(&info->go, 0);
+    hg_atomic_set32(&info->counter, 0);
+    hg_atomic_set32(&info->error, 0);
+
+    for (i = 0; i < thread_count + extra; i++) {
+        threads[i].info = info;
+        threads[i].index = i;
+        if (hg_thread_create(&threads[i].thread, hg_bench_util_thread_run,
+            &threads[i]) != HG_UTIL_SUCCESS) {
+            fprintf(stderr, "Could not create thread\n");
+            ret = HG_UTIL_FAIL;
+            break;
+        }
+        created++;
+    }
+
+    /* Start all threads at once */
+    while (ret == HG_UTIL_SUCCESS
+        && hg_atomic_get32(&info->ready)
+            != (hg_util_int32_t) (thread_count + extra))
+        hg_thread_yield();
+    if (ret != HG_UTIL_SUCCESS)
+        hg_atomic_set32(&info->error, 1);
+    start = hg_bench_time();
+    hg_atomic_set32(&info->go, 1);
+    for (i = 0; i < created; i++)
+        hg_thread_join(threads[i].thread);
+    free(threads);
+
+    if (ret == HG_UTIL_SUCCESS && hg_atomic_get32(&info->error)) {
+        fprintf(stderr, "Benchmark %s failed\n", name);
+        ret = HG_UTIL_FAIL;
+    }
+    if (ret != HG_UTIL_SUCCESS)
+        return ret;
+
+    /* Average is the cost of one operation seen from one thread */
+    memset(&result, 0, sizeof(result));
+    result.name = name;
+    result.segments = result.window = 1;
+    result.threads = thread_count;
+    hg_bench_result_compute(&result, NULL,
+        (size_t) info->options.iterations * thread_count,
+        hg_bench_time() - start, 0);
+    result.avg *= thread_count;
+    hg_bench_output_write(&info->output, &result);
+
+    return ret;
+}
+
+/*---------------------------------------------------------------------------*/
+static int
+hg_bench_util_scale_all(struct hg_bench_util_info *info, const char *name,
+    hg_bench_util_func_t func, unsigned int extra)
+{
+    unsigned int thread_count;
+
+    for (thread_count = 1; thread_count <= info->options.max_threads;
+        thread_count = (thread_count * 2 > info->options.max_threads
+            && thread_count < info->options.max_threads) ?
+            info->options.max_threads : thread_count * 2)
+        if (hg_bench_util_scale(info, name, func, thread_count, extra)
+            != HG_UTIL_SUCCESS)
+            return HG_UTIL_FAIL;
+
+    return HG_UTIL_SUCCESS;
+}
+
+
+/*---------------------------------------------------------------------------*/
+static void
+hg_bench_util_queue_mc(struct hg_bench_util_info *info, unsigned int index)
+{
+    unsigned int i;
+
+    (void) index;
+
+    /* One operation is one push and one pop, entries only need to be
+     * non-NULL */
+    for (i = 0; i < info->options.iterations; i++) {
+        while (hg_atomic_queue_push(info->queue, &info->value)
+            != HG_UTIL_SUCCESS)
+            hg_thread_yield();
+        while (!hg_atomic_queue_pop_mc(info->queue))
+            hg_thread_yield();
+    }
+}
+
+/*---------------------------------------------------------------------------*/
+static void
+hg_bench_util_queue_produce(struct hg_bench_util_info *info,
+    unsigned int index)
+{
+    unsigned int i;
+
+    if (index == info->thread_count) {
+        /* Single consumer (e.g., progress loop draining completions) */
+        size_t count = (size_t) info->options.iterations * info->thread_count,
+            popped = 0;
+
+        while (popped < count) {
+            if (hg_atomic_queue_pop_sc(info->queue))
+                popped++;
+            else
+                hg_thread_yield();
+        }
+        return;
+    }
+
+    for (i = 0; i < info->options.iterations; i++)
+        while (hg_atomic_queue_push(info->queue, &info->value)
+            != HG_UTIL_SUCCESS)
+            hg_thread_yield();
+}
+
+/*---------------------------------------------------------------------------*/
+static void
+hg_bench_util_spin(struct hg_bench_util_info *info, unsigned int index)
+{
+    unsigned int i;
+
+    (void) index;
+
+    for (i = 0; i < info->options.iterations; i++) {
+        hg_thread_spin_lock(&info->spin);
+        info->value++;
+        hg_thread_spin_unlock(&info->spin);
+    }
+}
+
+/*---------------------------------------------------------------------------*/
+static void
+hg_bench_util_mutex(struct hg_bench_util_info *info, unsigned int index)
+{
+    unsigned int i;
+
+    (void) index;
+
+    for (i = 0; i < info->options.iterations; i++) {
+        hg_thread_mutex_lock(&info->mutex);
+        info->value++;
+        hg_thread_mutex_unlock(&info->mutex);
+    }
+}
+
+/*---------------------------------------------------------------------------*/
+static void
+hg_bench_util_rwlock_rd(struct hg_bench_util_info *info, unsigned int index)
+{
+    hg_util_int32_t value = 0;
+    unsigned int i;
+
+    (void) index;
+
+    for (i = 0; i < info->options.iterations; i++) {
+        hg_thread_rwlock_rdlock(&info->rwlock);
+        value += info->value;
+        hg_thread_rwlock_release_rdlock(&info->rwlock);
+    }
+    if (value < 0)
+        hg_atomic_set32(&info->error, 1);
+}
+
+/*---------------------------------------------------------------------------*/
+static void
+hg_bench_util_rwlock_wr(struct hg_bench_util_info *info, unsigned int index)
+{
+    unsigned int i;
+
+    (void) index;
+
+    for (i = 0; i < info->options.iterations; i++) {
+        hg_thread_rwlock_wrlock(&info->rwlock);
+        info->value++;
+        hg_thread_rwlock_release_wrlock(&info->rwlock);
+    }
+}
+
+/*---------------------------------------------------------------------------*/
+static HG_THREAD_RETURN_TYPE
+hg_bench_util_pool_work(void *arg)
+{
+    struct hg_bench_util_work *work = (struct hg_bench_util_work *) arg;
+    hg_thread_ret_t tret = (hg_thread_ret_t) 0;
+
+    work->latency = hg_bench_time() - work->posted;
+    hg_atomic_incr32(&work->info->counter);
+
+    return tret;
+}
+
+/*---------------------------------------------------------------------------*/
+static int
+hg_bench_util_request_progress(unsigned int timeout, void *arg)
+{
+    (void) timeout;
+    (void) arg;
+
+    /* Nothing to progress, completion comes from the other thread */
+    hg_thread_yield();
+
+    return HG_UTIL_SUCCESS;
+}
+
+/*---------------------------------------------------------------------------*/
+static int
+hg_bench_util_request_trigger(unsigned int timeout, unsigned int *flag,
+    void *arg)
+{
+    (void) timeout;
+    (void) arg;
+
+    *flag = 0;
+
+    return HG_UTIL_SUCCESS;
+}
+
+/*---------------------------------------------------------------------------*/
+static int
+hg_bench_util_poll_cb(void *arg, unsigned int timeout,
+    hg_util_bool_t *progressed)
+{
+    struct hg_bench_util_peer *peer = (struct hg_bench_util_peer *) arg;
+
+    (void) timeout;
+
+    return hg_event_get(peer->event, progressed);
+}
+
+/*---------------------------------------------------------------------------*/
+static HG_THREAD_RETURN_TYPE
+hg_bench_util_request_pong(void *arg)
+{
+    struct hg_bench_util_pingpong *pingpong =
+        (struct hg_bench_util_pingpong *) arg;
+    hg_thread_ret_t tret = (hg_thread_ret_t) 0;
+    unsigned int i;
+
+    for (i = 0; i < pingpong->count; i++) {
+        unsigned int flag = 0;
+
+        hg_request_wait(pingpong->peers[1].request, HG_BENCH_TIMEOUT, &flag);
+        if (!flag) {
+            pingpong->ret = HG_UTIL_FAIL;
+            break;
+        }
+        hg_request_complete(pingpong->peers[0].request);
+    }
+
+    hg_thread_exit(tret);
+    return tret;
+}
+
+/*---------------------------------------------------------------------------*/
+static HG_THREAD_RETURN_TYPE
+hg_bench_util_poll_pong(void *arg)
+{
+    struct hg_bench_util_pingpong *pingpong =
+        (struct hg_bench_util_pingpong *) arg;
+    hg_thread_ret_t tret = (hg_thread_ret_t) 0;
+    unsigned int i;
+
+    for (i = 0; i < pingpong->count; i++) {
+        hg_util_bool_t progressed = HG_UTIL_FALSE;
+
+        if (hg_poll_wait(pingpong->peers[1].poll_set, HG_BENCH_TIMEOUT,
+            &progressed) != HG_UTIL_SUCCESS || !progressed) {
+            pingpong->ret = HG_UTIL_FAIL;
+            break;
+        }
+        hg_event_set(pingpong->peers[0].event);
+    }
+
+    hg_thread_exit(tret);
+    return tret;
+}
+
+/*---------------------------------------------------------------------------*/
+static int
+hg_bench_util_queue(struct hg_bench_util_info *info)
+{
+    int ret;
+
+    info->queue = hg_atomic_queue_alloc(HG_BENCH_QUEUE_SIZE);
+    if (!info->queue) {
+        fprintf(stderr, "Could not allocate queue\n");
+        return HG_UTIL_FAIL;
+    }
+
+    /* All threads push and pop_mc */
+    ret = hg_bench_util_scale_all(info, "queue_mc", hg_bench_util_queue_mc,
+        0);
+    /* Threads push, one extra thread pop_sc */
+    if (ret == HG_UTIL_SUCCESS)
+        ret = hg_bench_util_scale_all(info, "queue_mpsc",
+            hg_bench_util_queue_produce, 1);
+
+    hg_atomic_queue_free(info->queue);
+    info->queue = NULL;
+    return ret;
+}
+
+/*---------------------------------------------------------------------------*/
+static int
+hg_bench_util_locks(struct hg_bench_util_info *info)
+{
+    int ret;
+
+    hg_thread_spin_init(&info->spin);
+    hg_thread_mutex_init(&info->mutex);
+    hg_thread_rwlock_init(&info->rwlock);
+
+    ret = hg_bench_util_scale_all(info, "spin", hg_bench_util_spin, 0);
+    if (ret == HG_UTIL_SUCCESS)
+        ret = hg_bench_util_scale_all(info, "mutex", hg_bench_util_mutex, 0);
+    if (ret == HG_UTIL_SUCCESS)
+        ret = hg_bench_util_scale_all(info, "rwlock_rd",
+            hg_bench_util_rwlock_rd, 0);
+    if (ret == HG_UTIL_SUCCESS)
+        ret = hg_bench_util_scale_all(info, "rwlock_wr",
+            hg_bench_util_rwlock_wr, 0);
+
+    hg_thread_rwlock_destroy(&info->rwlock);
+    hg_thread_mutex_destroy(&info->mutex);
+    hg_thread_spin_destroy(&info->spin);
+    return ret;
+}
+
+/*---------------------------------------------------------------------------*/
+static int
+hg_bench_util_pool(struct hg_bench_util_info *info)
+{
+    unsigned int count = info->options.iterations, thread_count, i;
+    struct hg_bench_util_work *works;
+    struct hg_bench_samples samples = { NULL, 0, 0 };
+    int ret = HG_UTIL_SUCCESS;
+
+    works = (struct hg_bench_util_work *) calloc(count,
+        sizeof(struct hg_bench_util_work));
+    if (!works)
+        return HG_UTIL_FAIL;
+
+    for (thread_count = 1; thread_count <= info->options.max_threads;
+        thread_count = (thread_count * 2 > info->options.max_threads
+            && thread_count < info->options.max_threads) ?
+            info->options.max_threads : thread_count * 2) {
+        struct hg_bench_result result;
+        hg_thread_pool_t *pool = NULL;
+        double start;
+
+        if (hg_thread_pool_init(thread_count, &pool) != HG_UTIL_SUCCESS) {
+            fprintf(stderr, "Could not create thread pool\n");
+            ret = HG_UTIL_FAIL;
+            break;
+        }
+        if (hg_bench_samples_init(&samples, count) != HG_UTIL_SUCCESS) {
+            hg_thread_pool_destroy(pool);
+            ret = HG_UTIL_FAIL;
+            break;
+        }
+        hg_atomic_set32(&info->counter, 0);
+
+        /* Post from one thread, as the HG layer does */
+        start = hg_bench_time();
+        for (i = 0; i < count; i++) {
+            works[i].work.func = hg_bench_util_pool_work;
+            works[i].work.args = &works[i];
+            works[i].info = info;
+            works[i].posted = hg_bench_time();
+            if (hg_thread_pool_post(pool, &works[i].work)
+                != HG_UTIL_SUCCESS) {
+                fprintf(stderr, "Could not post work\n");
+                ret = HG_UTIL_FAIL;
+                break;
+            }
+        }
+        while (hg_atomic_get32(&info->counter) != (hg_util_int32_t) i)
+            hg_thread_yield();
+
+        memset(&result, 0, sizeof(result));
+        result.name = "pool";
+        result.segments = result.window = 1;
+        result.threads = thread_count;
+        for (i = 0; i < count; i++)
+            hg_bench_samples_add(&samples, works[i].latency);
+        hg_bench_result_compute(&result, &samples, count,
+            hg_bench_time() - start, 0);
+        hg_thread_pool_destroy(pool);
+        hg_bench_samples_free(&samples);
+        if (ret != HG_UTIL_SUCCESS)
+            break;
+        hg_bench_output_write(&info->output, &result);
+    }
+
+    free(works);
+    return ret;
+}
+
+/*---------------------------------------------------------------------------*/
+static int
+hg_bench_util_request(struct hg_bench_util_info *info)
+{
+    struct hg_bench_util_pingpong pingpong;
+    struct hg_bench_samples samples = { NULL, 0, 0 };
+    struct hg_bench_result result;
+    hg_thread_t thread;
+    unsigned int i;
+    double start;
+    int ret = HG_UTIL_FAIL;
+
+    memset(&pingpong, 0, sizeof(pingpong));
+    pingpong.count = info->options.iterations;
+    pingpong.ret = HG_UTIL_SUCCESS;
+    for (i = 0; i < 2; i++) {
+        pingpong.peers[i].request_class = hg_request_init(
+            hg_bench_util_request_progress, hg_bench_util_request_trigger,
+            NULL);
+        if (!pingpong.peers[i].request_class)
+            goto done;
+        pingpong.peers[i].request = hg_request_create(
+            pingpong.peers[i].request_class);
+        if (!pingpong.peers[i].request)
+            goto done;
+    }
+    if (hg_bench_samples_init(&samples, pingpong.count) != HG_UTIL_SUCCESS)
+        goto done;
+
+    if (hg_thread_create(&thread, hg_bench_util_request_pong, &pingpong)
+        != HG_UTIL_SUCCESS) {
+        fprintf(stderr, "Could not create thread\n");
+        goto done;
+    }
+    start = hg_bench_time();
+    for (i = 0; i < pingpong.count; i++) {
+        double t1 = hg_bench_time();
+        unsigned int flag = 0;
+
+        hg_request_complete(pingpong.peers[1].request);
+        hg_request_wait(pingpong.peers[0].request, HG_BENCH_TIMEOUT, &flag);
+        if (!flag) {
+            fprintf(stderr, "Request wait timed out\n");
+            break;
+        }
+        hg_bench_samples_add(&samples, hg_bench_time() - t1);
+    }
+    hg_thread_join(thread);
+    if (i != pingpong.count || pingpong.ret != HG_UTIL_SUCCESS)
+        goto done;
+
+    memset(&result, 0, sizeof(result));
+    result.name = "request";
+    result.segments = result.window = 1;
+    result.threads = 2;
+    hg_bench_result_compute(&result, &samples, pingpong.count,
+        hg_bench_time() - start, 0);
+    hg_bench_output_write(&info->output, &result);
+    ret = HG_UTIL_SUCCESS;
+
+done:
+    hg_bench_samples_free(&samples);
+    for (i = 0; i < 2; i++) {
+        if (pingpong.peers[i].request)
+            hg_request_destroy(pingpong.peers[i].request);
+        if (pingpong.peers[i].request_class)
+            hg_request_finalize(pingpong.peers[i].request_class, NULL);
+    }
+    return ret;
+}
+
+/*---------------------------------------------------------------------------*/
+static int
+hg_bench_util_poll(struct hg_bench_util_info *info)
+{
+    struct hg_bench_util_pingpong pingpong;
+    struct hg_bench_samples samples = { NULL, 0, 0 };
+    struct hg_bench_result result;
+    hg_thread_t thread;
+    unsigned int i;
+    double start;
+    int ret = HG_UTIL_FAIL;
+
+    memset(&pingpong, 0, sizeof(pingpong));
+    pingpong.count = info->options.iterations;
+    pingpong.ret = HG_UTIL_SUCCESS;
+    for (i = 0; i < 2; i++)
+        pingpong.peers[i].event = -1;
+    for (i = 0; i < 2; i++) {
+        pingpong.peers[i].poll_set = hg_poll_create();
+        if (!pingpong.peers[i].poll_set)
+            goto done;
+        pingpong.peers[i].event = hg_event_create();
+        if (pingpong.peers[i].event == HG_UTIL_FAIL) {
+            pingpong.peers[i].event = -1;
+            goto done;
+        }
+        if (hg_poll_add(pingpong.peers[i].poll_set, pingpong.peers[i].event,
+            HG_POLLIN, hg_bench_util_poll_cb, &pingpong.peers[i])
+            != HG_UTIL_SUCCESS)
+            goto done;
+    }
+    if (hg_bench_samples_init(&samples, pingpong.count) != HG_UTIL_SUCCESS)
+        goto done;
+
+    if (hg_thread_create(&thread, hg_bench_util_poll_pong, &pingpong)
+        != HG_UTIL_SUCCESS) {
+        fprintf(stderr, "Could not create thread\n");
+        goto done;
+    }
+    start = hg_bench_time();
+    for (i = 0; i < pingpong.count; i++) {
+        hg_util_bool_t progressed = HG_UTIL_FALSE;
+        double t1 = hg_bench_time();
+
+        hg_event_set(pingpong.peers[1].event);
+        if (hg_poll_wait(pingpong.peers[0].poll_set, HG_BENCH_TIMEOUT,
+            &progressed) != HG_UTIL_SUCCESS || !progressed) {
+            fprintf(stderr, "Poll wait failed\n");
+            break;
+        }
+        hg_bench_samples_add(&samples, hg_bench_time() - t1);
+    }
+    hg_thread_join(thread);
+    if (i != pingpong.count || pingpong.ret != HG_UTIL_SUCCESS)
+        goto done;
+
+    memset(&result, 0, sizeof(result));
+    result.name = "poll";
+    result.segments = result.window = 1;
+    result.threads = 2;
+    hg_bench_result_compute(&result, &samples, pingpong.count,
+        hg_bench_time() - start, 0);
+    hg_bench_output_write(&info->output, &result);
+    ret = HG_UTIL_SUCCESS;
+
+done:
+    hg_bench_samples_free(&samples);
+    for (i = 0; i < 2; i++) {
+        if (pingpong.peers[i].poll_set) {
+            if (pingpong.peers[i].event != -1)
+                hg_poll_remove(pingpong.peers[i].poll_set,
+                    pingpong.peers[i].event);
+            hg_poll_destroy(pingpong.peers[i].poll_set);
+        }
+        if (pingpong.peers[i].event != -1)
+            hg_event_destroy(pingpong.peers[i].event);
+    }
+    return ret;
+}
+
+/*---------------------------------------------------------------------------*/
+int
+main(int argc, char *argv[])
+{
+    struct hg_bench_util_info info;
+    const struct hg_bench_util_entry *entry;
+    int ret = EXIT_SUCCESS;
+
+    memset(&info, 0, sizeof(info));
+    if (hg_bench_util_parse_options(argc, argv, &info.options)
+        != HG_UTIL_SUCCESS) {
+        hg_bench_util_usage(argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    if (hg_bench_output_open(&info.output, info.options.format,
+        info.options.output_name) != HG_UTIL_SUCCESS)
+        return EXIT_FAILURE;
+    for (entry = hg_bench_util_entries_g; entry->name; entry++) {
+        if (!hg_bench_util_selected(info.options.benchmarks, entry->name))
+            continue;
+        if (entry->run(&info) != HG_UTIL_SUCCESS) {
+            fprintf(stderr, "Benchmark %s failed\n", entry->name);
+            ret = EXIT_FAILURE;
+            break;
+        }
+    }
+    if (hg_bench_output_close(&info.output) != HG_UTIL_SUCCESS)
+        ret = EXIT_FAILURE;
+
+    return ret;
+}
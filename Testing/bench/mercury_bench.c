@@ -0,0 +1,381 @@
+/*
+ * Copyright (C) 2013-2017 Argonne National Laboratory, Department of Energy,
+ *                    UChicago Argonne, LLC and The HDF Group.
+ * All rights reserved.
+ *
+ * The full copyright notice, including terms governing use, modification,
+ * and redistribution, is contained in the COPYING file that can be
+ * found at the root of the source code distribution tree.
+ */
+
+#include "mercury_bench.h"
+#include "mercury_histogram.h"
+#include "mercury_time.h"
+
+#if defined(HG_UTIL_HAS_TIME_H) && defined(HG_UTIL_HAS_CLOCK_GETTIME)
+# include <time.h>
+#endif
+#include <stdlib.h>
+#include <string.h>
+
+/****************/
+/* Local Macros */
+/****************/
+
+/* Statistics not available (no per-operation samples) */
+#define HG_BENCH_NA (-1.0)
+
+#define HG_BENCH_USEC(s) ((s) * 1000000.0)
+
+/********************/
+/* Local Prototypes */
+/********************/
+
+/**
+ * Compare doubles for qsort().
+ */
+static int
+hg_bench_compare(const void *a, const void *b);
+
+/**
+ * Get percentile of sorted samples (nearest rank).
+ */
+static double
+hg_bench_percentile(const struct hg_bench_samples *samples, double percentile);
+
+/**
+ * Get percentile of histogram (highest equivalent value, in seconds).
+ */
+static double
+hg_bench_histogram_percentile(const struct hg_bench_histogram *histogram,
+    double percentile);
+
+/**
+ * Print optional statistic.
+ */
+static void
+hg_bench_print_stat(FILE *file, const char *format, const char *na_string,
+    double value);
+
+/*---------------------------------------------------------------------------*/
+static int
+hg_bench_compare(const void *a, const void *b)
+{
+    double da = *(const double *) a, db = *(const double *) b;
+
+    return (da > db) - (da < db);
+}
+
+/*---------------------------------------------------------------------------*/
+static double
+hg_bench_percentile(const struct hg_bench_samples *samples, double percentile)
+{
+    size_t rank = (size_t) (percentile / 100.0 * (double) samples->count);
+
+    if (rank >= samples->count)
+        rank = samples->count - 1;
+
+    return samples->values[rank];
+}
+
+/*---------------------------------------------------------------------------*/
+static double
+hg_bench_histogram_percentile(const struct hg_bench_histogram *histogram,
+    double percentile)
+{
+    return (double) hg_histogram_percentile(histogram->buckets,
+        HG_BENCH_HISTOGRAM_SUB_BITS, HG_BENCH_HISTOGRAM_MAX_BITS,
+        histogram->count, histogram->max, percentile) / 1000000000.0;
+}
+
+/*---------------------------------------------------------------------------*/
+static void
+hg_bench_print_stat(FILE *file, const char *format, const char *na_string,
+    double value)
+{
+    if (value == HG_BENCH_NA)
+        fputs(na_string, file);
+    else
+        fprintf(file, format, value);
+}
+
+/*---------------------------------------------------------------------------*/
+double
+hg_bench_time(void)
+{
+#if defined(HG_UTIL_HAS_TIME_H) && defined(HG_UTIL_HAS_CLOCK_GETTIME)
+    struct timespec tp;
+
+    clock_gettime(CLOCK_MONOTONIC, &tp);
+    return (double) tp.tv_sec + (double) tp.tv_nsec / 1000000000.0;
+#else
+    hg_time_t tv;
+
+    hg_time_get_current(&tv);
+    return hg_time_to_double(tv);
+#endif
+}
+
+/*---------------------------------------------------------------------------*/
+int
+hg_bench_samples_init(struct hg_bench_samples *samples, size_t max_count)
+{
+    samples->count = 0;
+    samples->max_count = max_count;
+    samples->values = (double *) malloc((max_count + 1) * sizeof(double));
+
+    return samples->values ? HG_UTIL_SUCCESS : HG_UTIL_FAIL;
+}
+
+/*---------------------------------------------------------------------------*/
+void
+hg_bench_samples_free(struct hg_bench_samples *samples)
+{
+    free(samples->values);
+    samples->values = NULL;
+    samples->count = samples->max_count = 0;
+}
+
+/*---------------------------------------------------------------------------*/
+void
+hg_bench_samples_merge(struct hg_bench_samples *dst,
+    const struct hg_bench_samples *src)
+{
+    size_t count = src->count;
+
+    if (count > dst->max_count - dst->count)
+        count = dst->max_count - dst->count;
+    memcpy(&dst->values[dst->count], src->values, count * sizeof(double));
+    dst->count += count;
+}
+
+/*---------------------------------------------------------------------------*/
+int
+hg_bench_histogram_init(struct hg_bench_histogram *histogram)
+{
+    histogram->count = 0;
+    histogram->sum = 0;
+    histogram->min = histogram->max = 0;
+    histogram->buckets = (hg_util_uint64_t *) calloc(
+        HG_HISTOGRAM_BUCKETS(HG_BENCH_HISTOGRAM_SUB_BITS,
+            HG_BENCH_HISTOGRAM_MAX_BITS), sizeof(hg_util_uint64_t));
+
+    return histogram->buckets ? HG_UTIL_SUCCESS : HG_UTIL_FAIL;
+}
+
+/*---------------------------------------------------------------------------*/
+void
+hg_bench_histogram_free(struct hg_bench_histogram *histogram)
+{
+    free(histogram->buckets);
+    histogram->buckets = NULL;
+    histogram->count = 0;
+}
+
+/*---------------------------------------------------------------------------*/
+void
+hg_bench_histogram_add(struct hg_bench_histogram *histogram, double value)
+{
+    hg_util_uint64_t ns = (value > 0) ?
+        (hg_util_uint64_t) (value * 1000000000.0) : 0;
+
+    histogram->buckets[hg_histogram_index(ns, HG_BENCH_HISTOGRAM_SUB_BITS,
+        HG_BENCH_HISTOGRAM_MAX_BITS)]++;
+    if (!histogram->count || ns < histogram->min)
+        histogram->min = ns;
+    if (ns > histogram->max)
+        histogram->max = ns;
+    histogram->sum += (double) ns;
+    histogram->count++;
+}
+
+/*---------------------------------------------------------------------------*/
+void
+hg_bench_result_compute_histogram(struct hg_bench_result *result,
+    const struct hg_bench_histogram *histogram, size_t count, double elapsed,
+    double bytes)
+{
+    hg_bench_result_compute(result, NULL, count, elapsed, bytes);
+    if (!histogram->count)
+        return;
+
+    result->avg = histogram->sum / (double) histogram->count / 1000.0;
+    result->min = (double) histogram->min / 1000.0;
+    result->p50 = HG_BENCH_USEC(hg_bench_histogram_percentile(histogram, 50.0));
+    result->p90 = HG_BENCH_USEC(hg_bench_histogram_percentile(histogram, 90.0));
+    result->p99 = HG_BENCH_USEC(hg_bench_histogram_percentile(histogram, 99.0));
+    result->p999 =
+        HG_BENCH_USEC(hg_bench_histogram_percentile(histogram, 99.9));
+    result->max = (double) histogram->max / 1000.0;
+}
+
+/*---------------------------------------------------------------------------*/
+void
+hg_bench_result_compute(struct hg_bench_result *result,
+    struct hg_bench_samples *samples, size_t count, double elapsed,
+    double bytes)
+{
+    result->count = count;
+    result->ops_per_sec = (elapsed > 0) ? (double) count / elapsed : 0;
+    result->mb_per_sec = (elapsed > 0 && bytes > 0) ?
+        bytes / (1024.0 * 1024.0) / elapsed : HG_BENCH_NA;
+
+    if (samples && samples->count) {
+        double sum = 0;
+        size_t i;
+
+        qsort(samples->values, samples->count, sizeof(double),
+            hg_bench_compare);
+        for (i = 0; i < samples->count; i++)
+            sum += samples->values[i];
+        result->avg = HG_BENCH_USEC(sum / (double) samples->count);
+        result->min = HG_BENCH_USEC(samples->values[0]);
+        result->p50 = HG_BENCH_USEC(hg_bench_percentile(samples, 50.0));
+        result->p90 = HG_BENCH_USEC(hg_bench_percentile(samples, 90.0));
+        result->p99 = HG_BENCH_USEC(hg_bench_percentile(samples, 99.0));
+        result->p999 = HG_BENCH_USEC(hg_bench_percentile(samples, 99.9));
+        result->max = HG_BENCH_USEC(samples->values[samples->count - 1]);
+    } else {
+        /* Only the average cost is known */
+        result->avg = (count) ? HG_BENCH_USEC(elapsed / (double) count) : 0;
+        result->min = result->p50 = result->p90 = result->p99 =
+            result->p999 = result->max = HG_BENCH_NA;
+    }
+}
+
+/*---------------------------------------------------------------------------*/
+int
+hg_bench_format_parse(const char *name, hg_bench_format_t *format)
+{
+    if (!strcmp(name, "text"))
+        *format = HG_BENCH_TEXT;
+    else if (!strcmp(name, "csv"))
+        *format = HG_BENCH_CSV;
+    else if (!strcmp(name, "json"))
+        *format = HG_BENCH_JSON;
+    else
+        return HG_UTIL_FAIL;
+
+    return HG_UTIL_SUCCESS;
+}
+
+/*---------------------------------------------------------------------------*/
+int
+hg_bench_output_open(struct hg_bench_output *output, hg_bench_format_t format,
+    const char *filename)
+{
+    output->format = format;
+    output->result_count = 0;
+    output->file = (filename) ? fopen(filename, "w") : stdout;
+    if (!output->file) {
+        fprintf(stderr, "Could not open %s\n", filename);
+        return HG_UTIL_FAIL;
+    }
+
+    switch (format) {
+        case HG_BENCH_TEXT:
+            fprintf(output->file, "%-16s %10s %5s %4s %5s %10s %10s %10s "
+                "%10s %10s %10s %10s %12s %12s %10s\n", "# Benchmark", "Size",
+                "Segs", "Thr", "Win", "Avg (us)", "Min", "P50", "P90", "P99",
+                "P99.9", "Max", "Offered/s", "Ops/s", "MB/s");
+            break;
+        case HG_BENCH_CSV:
+            fprintf(output->file, "benchmark,size,segments,threads,window,"
+                "count,avg_us,min_us,p50_us,p90_us,p99_us,p999_us,max_us,"
+                "offered_per_sec,ops_per_sec,mb_per_sec\n");
+            break;
+        case HG_BENCH_JSON:
+            fprintf(output->file, "[");
+            break;
+        default:
+            break;
+    }
+
+    return HG_UTIL_SUCCESS;
+}
+
+/*---------------------------------------------------------------------------*/
+void
+hg_bench_output_write(struct hg_bench_output *output,
+    const struct hg_bench_result *result)
+{
+    FILE *file = output->file;
+    double offered = (result->offered > 0) ? result->offered : HG_BENCH_NA;
+
+    switch (output->format) {
+        case HG_BENCH_TEXT:
+            fprintf(file, "%-16s %10lu %5u %4u %5u %10.3f ", result->name,
+                (unsigned long) result->size, result->segments,
+                result->threads, result->window, result->avg);
+            hg_bench_print_stat(file, "%10.3f ", "         - ", result->min);
+            hg_bench_print_stat(file, "%10.3f ", "         - ", result->p50);
+            hg_bench_print_stat(file, "%10.3f ", "         - ", result->p90);
+            hg_bench_print_stat(file, "%10.3f ", "         - ", result->p99);
+            hg_bench_print_stat(file, "%10.3f ", "         - ", result->p999);
+            hg_bench_print_stat(file, "%10.3f ", "         - ", result->max);
+            hg_bench_print_stat(file, "%12.0f ", "           - ", offered);
+            fprintf(file, "%12.0f ", result->ops_per_sec);
+            hg_bench_print_stat(file, "%10.2f", "         -", result->mb_per_sec);
+            fprintf(file, "\n");
+            break;
+        case HG_BENCH_CSV:
+            fprintf(file, "%s,%lu,%u,%u,%u,%lu,%.3f,", result->name,
+                (unsigned long) result->size, result->segments,
+                result->threads, result->window, (unsigned long) result->count,
+                result->avg);
+            hg_bench_print_stat(file, "%.3f,", ",", result->min);
+            hg_bench_print_stat(file, "%.3f,", ",", result->p50);
+            hg_bench_print_stat(file, "%.3f,", ",", result->p90);
+            hg_bench_print_stat(file, "%.3f,", ",", result->p99);
+            hg_bench_print_stat(file, "%.3f,", ",", result->p999);
+            hg_bench_print_stat(file, "%.3f,", ",", result->max);
+            hg_bench_print_stat(file, "%.1f,", ",", offered);
+            fprintf(file, "%.1f,", result->ops_per_sec);
+            hg_bench_print_stat(file, "%.2f", "", result->mb_per_sec);
+            fprintf(file, "\n");
+            break;
+        case HG_BENCH_JSON:
+            fprintf(file, "%s\n  {\"benchmark\": \"%s\", \"size\": %lu, "
+                "\"segments\": %u, \"threads\": %u, \"window\": %u, "
+                "\"count\": %lu, \"avg_us\": %.3f", output->result_count ?
+                "," : "", result->name, (unsigned long) result->size,
+                result->segments, result->threads, result->window,
+                (unsigned long) result->count, result->avg);
+            hg_bench_print_stat(file, ", \"min_us\": %.3f", "", result->min);
+            hg_bench_print_stat(file, ", \"p50_us\": %.3f", "", result->p50);
+            hg_bench_print_stat(file, ", \"p90_us\": %.3f", "", result->p90);
+            hg_bench_print_stat(file, ", \"p99_us\": %.3f", "", result->p99);
+            hg_bench_print_stat(file, ", \"p999_us\": %.3f", "",
+                result->p999);
+            hg_bench_print_stat(file, ", \"max_us\": %.3f", "", result->max);
+            hg_bench_print_stat(file, ", \"offered_per_sec\": %.1f", "",
+                offered);
+            fprintf(file, ", \"ops_per_sec\": %.1f", result->ops_per_sec);
+            hg_bench_print_stat(file, ", \"mb_per_sec\": %.2f", "",
+                result->mb_per_sec);
+            fprintf(file, "}");
+            break;
+        default:
+            break;
+    }
+    output->result_count++;
+    fflush(file);
+}
+
+/*---------------------------------------------------------------------------*/
+int
+hg_bench_output_close(struct hg_bench_output *output)
+{
+    int ret = HG_UTIL_SUCCESS;
+
+    if (output->format == HG_BENCH_JSON)
+        fprintf(output->file, "\n]\n");
+    if (output->file != stdout) {
+        if (fclose(output->file) != 0)
+            ret = HG_UTIL_FAIL;
+    } else
+        fflush(stdout);
+    output->file = NULL;
+
+    return ret;
+}
@@ -0,0 +1,232 @@
+/*
+ * Copyright (C) 2013-2017 Argonne National Laboratory, Department of Energy,
+ *                    UChicago Argonne, LLC and The HDF Group.
+ * All rights reserved.
+ *
+ * The full copyright notice, including terms governing use, modification,
+ * and redistribution, is contained in the COPYING file that can be
+ * found at the root of the source code distribution tree.
+ */
+
+#ifndef MERCURY_BENCH_H
+#define MERCURY_BENCH_H
+
+#include "mercury_util_config.h"
+
+#include <stddef.h>
+#include <stdio.h>
+
+/*************************************/
+/* Public Type and Struct Definition */
+/*************************************/
+
+/* Output formats */
+typedef enum {
+    HG_BENCH_TEXT,              /*!< human readable table */
+    HG_BENCH_CSV,               /*!< one line per result */
+    HG_BENCH_JSON               /*!< array of result objects */
+} hg_bench_format_t;
+
+/* Per-operation samples (in seconds) */
+struct hg_bench_samples {
+    double *values;
+    size_t count;
+    size_t max_count;
+};
+
+/* Histogram of values in nanoseconds (see mercury_histogram.h): values below
+ * 2^HG_BENCH_HISTOGRAM_SUB_BITS are exact, larger values are within 1%, values
+ * above 2^HG_BENCH_HISTOGRAM_MAX_BITS ns (about 18 minutes) are clamped */
+#define HG_BENCH_HISTOGRAM_SUB_BITS 7
+#define HG_BENCH_HISTOGRAM_MAX_BITS 40
+
+struct hg_bench_histogram {
+    hg_util_uint64_t *buckets;  /* Sample counts */
+    hg_util_uint64_t count;     /* Number of values */
+    double sum;                 /* Sum of values (ns) */
+    hg_util_uint64_t min, max;
+};
+
+/* Result of one benchmark run, all times in microseconds */
+struct hg_bench_result {
+    const char *name;           /* Benchmark name */
+    size_t size;                /* Payload size */
+    unsigned int segments;      /* Number of segments */
+    unsigned int threads;       /* Number of threads */
+    unsigned int window;        /* Operations in flight (per thread) */
+    size_t count;               /* Number of operations */
+    double avg, min, p50, p90, p99, p999, max;
+    double offered;             /* Offered rate (open-loop runs) */
+    double ops_per_sec;         /* Operation rate */
+    double mb_per_sec;          /* Bandwidth (MB/s) */
+};
+
+/* Result output */
+struct hg_bench_output {
+    FILE *file;
+    hg_bench_format_t format;
+    size_t result_count;
+};
+
+/*********************/
+/* Public Prototypes */
+/*********************/
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * Get monotonic time in seconds, with nanosecond resolution if available.
+ *
+ * \return Time in seconds
+ */
+double
+hg_bench_time(void);
+
+/**
+ * Allocate room for samples.
+ *
+ * \param samples [IN/OUT]      pointer to samples
+ * \param max_count [IN]        maximum number of samples
+ *
+ * \return Non-negative on success or negative on failure
+ */
+int
+hg_bench_samples_init(struct hg_bench_samples *samples, size_t max_count);
+
+/**
+ * Free samples.
+ *
+ * \param samples [IN/OUT]      pointer to samples
+ */
+void
+hg_bench_samples_free(struct hg_bench_samples *samples);
+
+/**
+ * Add sample, samples beyond max_count are ignored.
+ *
+ * \param samples [IN/OUT]      pointer to samples
+ * \param value [IN]            sample in seconds
+ */
+static HG_UTIL_INLINE void
+hg_bench_samples_add(struct hg_bench_samples *samples, double value)
+{
+    if (samples->count < samples->max_count)
+        samples->values[samples->count++] = value;
+}
+
+/**
+ * Append samples of src to dst.
+ *
+ * \param dst [IN/OUT]          pointer to samples
+ * \param src [IN]              pointer to samples
+ */
+void
+hg_bench_samples_merge(struct hg_bench_samples *dst,
+    const struct hg_bench_samples *src);
+
+/**
+ * Allocate histogram.
+ *
+ * \param histogram [IN/OUT]    pointer to histogram
+ *
+ * \return Non-negative on success or negative on failure
+ */
+int
+hg_bench_histogram_init(struct hg_bench_histogram *histogram);
+
+/**
+ * Free histogram.
+ *
+ * \param histogram [IN/OUT]    pointer to histogram
+ */
+void
+hg_bench_histogram_free(struct hg_bench_histogram *histogram);
+
+/**
+ * Add value to histogram.
+ *
+ * \param histogram [IN/OUT]    pointer to histogram
+ * \param value [IN]            value in seconds
+ */
+void
+hg_bench_histogram_add(struct hg_bench_histogram *histogram, double value);
+
+/**
+ * Compute result statistics from histogram (see hg_bench_result_compute()).
+ *
+ * \param result [IN/OUT]       pointer to result, parameters already set
+ * \param histogram [IN]        pointer to histogram
+ * \param count [IN]            number of operations
+ * \param elapsed [IN]          wall clock time of the run (in seconds)
+ * \param bytes [IN]            bytes moved during the run
+ */
+void
+hg_bench_result_compute_histogram(struct hg_bench_result *result,
+    const struct hg_bench_histogram *histogram, size_t count, double elapsed,
+    double bytes);
+
+/**
+ * Compute result statistics. Samples get sorted.
+ *
+ * \param result [IN/OUT]       pointer to result, parameters already set
+ * \param samples [IN/OUT]      pointer to per-operation samples (may be NULL)
+ * \param count [IN]            number of operations
+ * \param elapsed [IN]          wall clock time of the run (in seconds)
+ * \param bytes [IN]            bytes moved during the run
+ */
+void
+hg_bench_result_compute(struct hg_bench_result *result,
+    struct hg_bench_samples *samples, size_t count, double elapsed,
+    double bytes);
+
+/**
+ * Parse output format name ("text", "csv" or "json").
+ *
+ * \param name [IN]             format name
+ * \param format [OUT]          pointer to format
+ *
+ * \return Non-negative on success or negative on failure
+ */
+int
+hg_bench_format_parse(const char *name, hg_bench_format_t *format);
+
+/**
+ * Open output, stdout is used if filename is NULL.
+ *
+ * \param output [OUT]          pointer to output
+ * \param format [IN]           output format
+ * \param filename [IN]         file name
+ *
+ * \return Non-negative on success or negative on failure
+ */
+int
+hg_bench_output_open(struct hg_bench_output *output, hg_bench_format_t format,
+    const char *filename);
+
+/**
+ * Write result to output.
+ *
+ * \param output [IN/OUT]       pointer to output
+ * \param result [IN]           pointer to result
+ */
+void
+hg_bench_output_write(struct hg_bench_output *output,
+    const struct hg_bench_result *result);
+
+/**
+ * Terminate and close output.
+ *
+ * \param output [IN/OUT]       pointer to output
+ *
+ * \return Non-negative on success or negative on failure
+ */
+int
+hg_bench_output_close(struct hg_bench_output *output);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* MERCURY_BENCH_H */
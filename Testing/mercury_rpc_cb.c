@@ -101,6 +101,9 @@ struct hg_test_bulk_args {
 static hg_return_t
 hg_test_bulk_transfer_cb(const struct hg_cb_info *hg_cb_info);
 
+static hg_return_t
+hg_test_bulk_read_transfer_cb(const struct hg_cb_info *hg_cb_info);
+
 static hg_return_t
 hg_test_bulk_seg_transfer_cb(const struct hg_cb_info *hg_cb_info);
 
@@ -249,6 +252,62 @@ HG_TEST_RPC_CB(hg_test_rpc_open_no_resp, handle)
     return ret;
 }
 
+/*---------------------------------------------------------------------------*/
+HG_TEST_RPC_CB(hg_test_rpc_delay, handle)
+{
+    hg_time_t delay = {0, HG_TEST_RPC_DELAY * 1000};
+    hg_return_t ret = HG_SUCCESS;
+
+    /* Respond after origin gave up waiting */
+    hg_time_sleep(delay, NULL);
+
+    ret = HG_Respond(handle, NULL, NULL, NULL);
+    if (ret != HG_SUCCESS) {
+        fprintf(stderr, "Could not respond\n");
+        return ret;
+    }
+
+    HG_Destroy(handle);
+
+    return ret;
+}
+
+/*---------------------------------------------------------------------------*/
+HG_TEST_RPC_CB(hg_test_rpc_iov, handle)
+{
+    void *in_buf;
+    hg_size_t in_buf_size, half;
+    void *buf_ptrs[2];
+    hg_size_t buf_sizes[2];
+    hg_return_t ret = HG_SUCCESS;
+
+    /* Get input buffer */
+    ret = HG_Get_input_buf(handle, &in_buf, &in_buf_size);
+    if (ret != HG_SUCCESS) {
+        fprintf(stderr, "Could not get input buffer\n");
+        return ret;
+    }
+
+    /* Payload is a NULL terminated string, echo it back in two pieces */
+    in_buf_size = strlen((const char *) in_buf) + 1;
+    half = in_buf_size / 2;
+    buf_ptrs[0] = in_buf;
+    buf_sizes[0] = half;
+    buf_ptrs[1] = (char *) in_buf + half;
+    buf_sizes[1] = in_buf_size - half;
+
+    /* Send response back */
+    ret = HG_Respond_iov(handle, NULL, NULL, 2, buf_ptrs, buf_sizes);
+    if (ret != HG_SUCCESS) {
+        fprintf(stderr, "Could not respond\n");
+        return ret;
+    }
+
+    HG_Destroy(handle);
+
+    return ret;
+}
+
 /*---------------------------------------------------------------------------*/
 HG_TEST_RPC_CB(hg_test_bulk_write, handle)
 {
@@ -378,6 +437,254 @@ done:
     return ret;
 }
 
+/*---------------------------------------------------------------------------*/
+HG_TEST_RPC_CB(hg_test_bulk_read, handle)
+{
+    const struct hg_info *hg_info = NULL;
+    hg_bulk_t origin_bulk_handle = HG_BULK_NULL;
+    hg_bulk_t local_bulk_handle = HG_BULK_NULL;
+    struct hg_test_bulk_args *bulk_args = NULL;
+    bulk_write_in_t in_struct;
+    hg_return_t ret = HG_SUCCESS;
+    int *buf;
+    size_t i;
+
+    bulk_args = (struct hg_test_bulk_args *) malloc(
+            sizeof(struct hg_test_bulk_args));
+
+    /* Keep handle to pass to callback */
+    bulk_args->handle = handle;
+
+    /* Get info from handle */
+    hg_info = HG_Get_info(handle);
+
+    /* Get input parameters and data */
+    ret = HG_Get_input(handle, &in_struct);
+    if (ret != HG_SUCCESS) {
+        fprintf(stderr, "Could not get input\n");
+        return ret;
+    }
+
+    /* Get parameters */
+    origin_bulk_handle = in_struct.bulk_handle;
+    bulk_args->nbytes = HG_Bulk_get_size(origin_bulk_handle);
+    bulk_args->fildes = in_struct.fildes;
+
+    /* Free input */
+    HG_Bulk_ref_incr(origin_bulk_handle);
+    HG_Free_input(handle, &in_struct);
+
+    /* Create a new block handle and fill it with the data to be read */
+    HG_Bulk_create(hg_info->hg_class, 1, NULL, (hg_size_t *) &bulk_args->nbytes,
+        HG_BULK_READWRITE, &local_bulk_handle);
+    HG_Bulk_access(local_bulk_handle, 0, bulk_args->nbytes, HG_BULK_READWRITE,
+        1, (void **) &buf, NULL, NULL);
+    for (i = 0; i < bulk_args->nbytes / sizeof(int); i++)
+        buf[i] = (int) i + bulk_args->fildes;
+
+    /* Push bulk data */
+    hg_atomic_set32(&bulk_args->completed_transfers, 1);
+    ret = HG_Bulk_transfer(hg_info->context, hg_test_bulk_read_transfer_cb,
+        bulk_args, HG_BULK_PUSH, hg_info->addr, origin_bulk_handle, 0,
+        local_bulk_handle, 0, bulk_args->nbytes, HG_OP_ID_IGNORE);
+    if (ret != HG_SUCCESS) {
+        fprintf(stderr, "Could not push bulk data\n");
+        return ret;
+    }
+
+    return ret;
+}
+
+/*---------------------------------------------------------------------------*/
+HG_TEST_RPC_CB(hg_test_bulk_read_gaps, handle)
+{
+    const struct hg_info *hg_info = NULL;
+    hg_bulk_t origin_bulk_handle = HG_BULK_NULL;
+    hg_bulk_t local_bulk_handle = HG_BULK_NULL;
+    struct hg_test_bulk_args *bulk_args = NULL;
+    bulk_write_in_t in_struct;
+    hg_return_t ret = HG_SUCCESS;
+    size_t quarter;
+    int *buf;
+    size_t i;
+
+    bulk_args = (struct hg_test_bulk_args *) malloc(
+            sizeof(struct hg_test_bulk_args));
+
+    /* Keep handle to pass to callback */
+    bulk_args->handle = handle;
+
+    /* Get info from handle */
+    hg_info = HG_Get_info(handle);
+
+    /* Get input parameters and data */
+    ret = HG_Get_input(handle, &in_struct);
+    if (ret != HG_SUCCESS) {
+        fprintf(stderr, "Could not get input\n");
+        return ret;
+    }
+
+    /* Get parameters */
+    origin_bulk_handle = in_struct.bulk_handle;
+    bulk_args->nbytes = HG_Bulk_get_size(origin_bulk_handle);
+    bulk_args->fildes = in_struct.fildes;
+    quarter = bulk_args->nbytes / 4;
+
+    /* Free input */
+    HG_Bulk_ref_incr(origin_bulk_handle);
+    HG_Free_input(handle, &in_struct);
+
+    /* Create a new block handle and fill it with the data to be read */
+    HG_Bulk_create(hg_info->hg_class, 1, NULL, (hg_size_t *) &bulk_args->nbytes,
+        HG_BULK_READWRITE, &local_bulk_handle);
+    HG_Bulk_access(local_bulk_handle, 0, bulk_args->nbytes, HG_BULK_READWRITE,
+        1, (void **) &buf, NULL, NULL);
+    for (i = 0; i < bulk_args->nbytes / sizeof(int); i++)
+        buf[i] = (int) i + bulk_args->fildes;
+
+    /* Push first and third quarters only, each transfer releases a reference
+     * to both handles */
+    hg_atomic_set32(&bulk_args->completed_transfers, 2);
+    HG_Bulk_ref_incr(origin_bulk_handle);
+    HG_Bulk_ref_incr(local_bulk_handle);
+    ret = HG_Bulk_transfer(hg_info->context, hg_test_bulk_read_transfer_cb,
+        bulk_args, HG_BULK_PUSH, hg_info->addr, origin_bulk_handle, 0,
+        local_bulk_handle, 0, quarter, HG_OP_ID_IGNORE);
+    if (ret != HG_SUCCESS) {
+        fprintf(stderr, "Could not push bulk data\n");
+        return ret;
+    }
+    ret = HG_Bulk_transfer(hg_info->context, hg_test_bulk_read_transfer_cb,
+        bulk_args, HG_BULK_PUSH, hg_info->addr, origin_bulk_handle,
+        2 * quarter, local_bulk_handle, 2 * quarter, quarter, HG_OP_ID_IGNORE);
+    if (ret != HG_SUCCESS) {
+        fprintf(stderr, "Could not push bulk data\n");
+        return ret;
+    }
+
+    return ret;
+}
+
+/*---------------------------------------------------------------------------*/
+HG_TEST_RPC_CB(hg_test_bulk_read_pair, handle)
+{
+    const struct hg_info *hg_info = NULL;
+    hg_bulk_t origin_bulk_handle1 = HG_BULK_NULL;
+    hg_bulk_t origin_bulk_handle2 = HG_BULK_NULL;
+    hg_bulk_t local_bulk_handle = HG_BULK_NULL;
+    struct hg_test_bulk_args *bulk_args = NULL;
+    bulk_read_pair_in_t in_struct;
+    hg_return_t ret = HG_SUCCESS;
+    size_t nbytes1;
+    int *buf;
+    size_t i;
+
+    bulk_args = (struct hg_test_bulk_args *) malloc(
+            sizeof(struct hg_test_bulk_args));
+
+    /* Keep handle to pass to callback */
+    bulk_args->handle = handle;
+
+    /* Get info from handle */
+    hg_info = HG_Get_info(handle);
+
+    /* Get input parameters and data */
+    ret = HG_Get_input(handle, &in_struct);
+    if (ret != HG_SUCCESS) {
+        fprintf(stderr, "Could not get input\n");
+        return ret;
+    }
+
+    /* Get parameters */
+    origin_bulk_handle1 = in_struct.bulk_handle1;
+    origin_bulk_handle2 = in_struct.bulk_handle2;
+    nbytes1 = HG_Bulk_get_size(origin_bulk_handle1);
+    bulk_args->nbytes = nbytes1 + HG_Bulk_get_size(origin_bulk_handle2);
+    bulk_args->fildes = in_struct.fildes;
+
+    /* Free input */
+    HG_Bulk_ref_incr(origin_bulk_handle1);
+    HG_Bulk_ref_incr(origin_bulk_handle2);
+    HG_Free_input(handle, &in_struct);
+
+    /* Create a new block handle and fill it with the data to be read, both
+     * regions are read back to back from it */
+    HG_Bulk_create(hg_info->hg_class, 1, NULL, (hg_size_t *) &bulk_args->nbytes,
+        HG_BULK_READWRITE, &local_bulk_handle);
+    HG_Bulk_access(local_bulk_handle, 0, bulk_args->nbytes, HG_BULK_READWRITE,
+        1, (void **) &buf, NULL, NULL);
+    for (i = 0; i < bulk_args->nbytes / sizeof(int); i++)
+        buf[i] = (int) i + bulk_args->fildes;
+
+    /* Push to both regions, each transfer releases a reference to the local
+     * handle */
+    hg_atomic_set32(&bulk_args->completed_transfers, 2);
+    HG_Bulk_ref_incr(local_bulk_handle);
+    ret = HG_Bulk_transfer(hg_info->context, hg_test_bulk_read_transfer_cb,
+        bulk_args, HG_BULK_PUSH, hg_info->addr, origin_bulk_handle1, 0,
+        local_bulk_handle, 0, nbytes1, HG_OP_ID_IGNORE);
+    if (ret != HG_SUCCESS) {
+        fprintf(stderr, "Could not push bulk data\n");
+        return ret;
+    }
+    ret = HG_Bulk_transfer(hg_info->context, hg_test_bulk_read_transfer_cb,
+        bulk_args, HG_BULK_PUSH, hg_info->addr, origin_bulk_handle2, 0,
+        local_bulk_handle, nbytes1, bulk_args->nbytes - nbytes1,
+        HG_OP_ID_IGNORE);
+    if (ret != HG_SUCCESS) {
+        fprintf(stderr, "Could not push bulk data\n");
+        return ret;
+    }
+
+    return ret;
+}
+
+/*---------------------------------------------------------------------------*/
+static hg_return_t
+hg_test_bulk_read_transfer_cb(const struct hg_cb_info *hg_cb_info)
+{
+    struct hg_test_bulk_args *bulk_args = (struct hg_test_bulk_args *)
+            hg_cb_info->arg;
+    hg_return_t ret = HG_SUCCESS;
+    bulk_write_out_t out_struct;
+
+    if (hg_cb_info->ret != HG_SUCCESS) {
+        HG_LOG_ERROR("Error in callback");
+        ret = HG_PROTOCOL_ERROR;
+        goto done;
+    }
+
+    /* Free block handles */
+    ret = HG_Bulk_free(hg_cb_info->info.bulk.local_handle);
+    if (ret != HG_SUCCESS) {
+        fprintf(stderr, "Could not free HG bulk handle\n");
+        goto done;
+    }
+    ret = HG_Bulk_free(hg_cb_info->info.bulk.origin_handle);
+    if (ret != HG_SUCCESS) {
+        fprintf(stderr, "Could not free HG bulk handle\n");
+        goto done;
+    }
+
+    /* Respond once all pushes have completed */
+    if (hg_atomic_decr32(&bulk_args->completed_transfers) > 0)
+        return ret;
+
+    /* Send response back */
+    out_struct.ret = bulk_args->nbytes;
+    ret = HG_Respond(bulk_args->handle, NULL, NULL, &out_struct);
+    if (ret != HG_SUCCESS) {
+        fprintf(stderr, "Could not respond\n");
+        goto done;
+    }
+
+done:
+    HG_Destroy(bulk_args->handle);
+    free(bulk_args);
+
+    return ret;
+}
+
 /*---------------------------------------------------------------------------*/
 HG_TEST_RPC_CB(hg_test_bulk_seg_write, handle)
 {
@@ -1143,7 +1450,12 @@ HG_TEST_RPC_CB(hg_test_overflow, handle)
 /*---------------------------------------------------------------------------*/
 HG_TEST_THREAD_CB(hg_test_rpc_open)
 HG_TEST_THREAD_CB(hg_test_rpc_open_no_resp)
+HG_TEST_THREAD_CB(hg_test_rpc_delay)
+HG_TEST_THREAD_CB(hg_test_rpc_iov)
 HG_TEST_THREAD_CB(hg_test_bulk_write)
+HG_TEST_THREAD_CB(hg_test_bulk_read)
+HG_TEST_THREAD_CB(hg_test_bulk_read_gaps)
+HG_TEST_THREAD_CB(hg_test_bulk_read_pair)
 HG_TEST_THREAD_CB(hg_test_bulk_seg_write)
 //HG_TEST_THREAD_CB(hg_test_pipeline_write)
 #ifndef _WIN32
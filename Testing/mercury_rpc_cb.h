@@ -23,11 +23,29 @@ hg_test_rpc_open_cb(hg_handle_t handle);
 hg_return_t
 hg_test_rpc_open_no_resp_cb(hg_handle_t handle);
 
+/**
+ * test_rpc (delayed response)
+ */
+hg_return_t
+hg_test_rpc_delay_cb(hg_handle_t handle);
+
+/**
+ * test_rpc (scatter-gather payload)
+ */
+hg_return_t
+hg_test_rpc_iov_cb(hg_handle_t handle);
+
 /**
  * test_bulk
  */
 hg_return_t
 hg_test_bulk_write_cb(hg_handle_t handle);
+hg_return_t
+hg_test_bulk_read_cb(hg_handle_t handle);
+hg_return_t
+hg_test_bulk_read_gaps_cb(hg_handle_t handle);
+hg_return_t
+hg_test_bulk_read_pair_cb(hg_handle_t handle);
 
 /**
  * test_bulk_seg
@@ -64,9 +64,14 @@ extern const struct na_test_opt na_test_opt_g[];
 /* test_rpc */
 hg_id_t hg_test_rpc_open_id_g = 0;
 hg_id_t hg_test_rpc_open_id_no_resp_g = 0;
+hg_id_t hg_test_rpc_delay_id_g = 0;
+hg_id_t hg_test_rpc_iov_id_g = 0;
 
 /* test_bulk */
 hg_id_t hg_test_bulk_write_id_g = 0;
+hg_id_t hg_test_bulk_read_id_g = 0;
+hg_id_t hg_test_bulk_read_gaps_id_g = 0;
+hg_id_t hg_test_bulk_read_pair_id_g = 0;
 
 /* test_bulk_seg */
 hg_id_t hg_test_bulk_seg_write_id_g = 0;
@@ -102,6 +107,9 @@ static void
 hg_test_usage(const char *execname)
 {
     na_test_usage(execname);
+    printf("    -C, --addr_cache    Cache address lookups\n");
+    printf("    -T, --handler_threads\n"
+           "                        Run RPC callbacks on handler threads\n");
 }
 
 /*---------------------------------------------------------------------------*/
@@ -128,6 +136,12 @@ hg_test_parse_options(int argc, char *argv[], struct hg_test_info *hg_test_info)
             case 'm': /* memory */
                 hg_test_info->auto_sm = HG_TRUE;
                 break;
+            case 'C': /* addr cache */
+                hg_test_info->addr_cache = HG_TRUE;
+                break;
+            case 'T': /* handler threads */
+                hg_test_info->handler_threads = HG_TRUE;
+                break;
             case 't': /* number of threads */
                 hg_test_info->thread_count =
                     (unsigned int) atoi(na_test_opt_arg_g);
@@ -236,14 +250,36 @@ hg_test_register(hg_class_t *hg_class)
     HG_Registered_disable_response(hg_class, hg_test_rpc_open_id_no_resp_g,
         HG_TRUE);
 
+    /* Delayed response */
+    hg_test_rpc_delay_id_g = MERCURY_REGISTER(hg_class, "hg_test_rpc_delay",
+        void, void, hg_test_rpc_delay_cb);
+
+    /* Scatter-gather payload, no proc routines */
+    hg_test_rpc_iov_id_g = HG_Register_name(hg_class, "hg_test_rpc_iov", NULL,
+        NULL, hg_test_rpc_iov_cb);
+
     /* test_bulk */
     hg_test_bulk_write_id_g = MERCURY_REGISTER(hg_class, "hg_test_bulk_write",
             bulk_write_in_t, bulk_write_out_t, hg_test_bulk_write_cb);
+    hg_test_bulk_read_id_g = MERCURY_REGISTER(hg_class, "hg_test_bulk_read",
+            bulk_write_in_t, bulk_write_out_t, hg_test_bulk_read_cb);
+    hg_test_bulk_read_gaps_id_g = MERCURY_REGISTER(hg_class,
+            "hg_test_bulk_read_gaps", bulk_write_in_t, bulk_write_out_t,
+            hg_test_bulk_read_gaps_cb);
+    hg_test_bulk_read_pair_id_g = MERCURY_REGISTER(hg_class,
+            "hg_test_bulk_read_pair", bulk_read_pair_in_t, bulk_write_out_t,
+            hg_test_bulk_read_pair_cb);
+#ifdef HG_HAS_EAGER_BULK
+    HG_Registered_eager_push_rw(hg_class, hg_test_bulk_read_gaps_id_g,
+        HG_TRUE);
+#endif
 
     /* test_bulk_seg */
     hg_test_bulk_seg_write_id_g = MERCURY_REGISTER(hg_class,
             "hg_test_bulk_seg_write", bulk_write_in_t, bulk_write_out_t,
             hg_test_bulk_seg_write_cb);
+    HG_Registered_compact_encoding(hg_class, hg_test_bulk_seg_write_id_g,
+        HG_TRUE);
 
 #ifndef _WIN32
     /* test_posix */
@@ -330,6 +366,12 @@ HG_Test_init(int argc, char *argv[], struct hg_test_info *hg_test_info)
     hg_init_info.stats = HG_TRUE;
 #endif
 
+    /* Cache address lookups, keep failed lookups for 1s */
+    if (hg_test_info->addr_cache) {
+        hg_init_info.addr_cache = HG_TRUE;
+        hg_init_info.addr_cache_neg_ttl = 1000;
+    }
+
     /* Set auto SM mode */
     if (hg_test_info->auto_sm)
         hg_init_info.auto_sm = HG_TRUE;
@@ -371,6 +413,18 @@ HG_Test_init(int argc, char *argv[], struct hg_test_info *hg_test_info)
         hg_thread_mutex_init(&hg_test_info->bulk_handle_mutex);
 #endif
 
+        /* Run RPC callbacks on handler threads instead of HG_Trigger() */
+        if (hg_test_info->handler_threads) {
+            ret = HG_Context_set_handler_threads(hg_test_info->context,
+                hg_test_info->thread_count);
+            if (ret != HG_SUCCESS) {
+                HG_LOG_ERROR("Could not set handler threads");
+                goto done;
+            }
+            printf("# Starting server with %d handler threads...\n",
+                hg_test_info->thread_count);
+        }
+
         /* Create bulk buffer that can be used for receiving data */
         HG_Bulk_create(hg_test_info->hg_class, 1, NULL,
             (hg_size_t *) &bulk_size, HG_BULK_READWRITE,
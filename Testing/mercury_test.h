@@ -48,6 +48,8 @@ struct hg_test_info {
     uint32_t cookie;
 #endif
     hg_bool_t auto_sm;
+    hg_bool_t addr_cache;
+    hg_bool_t handler_threads;
     struct na_test_info na_test_info;
     unsigned int thread_count;
 #ifdef MERCURY_TESTING_HAS_THREAD_POOL
@@ -92,6 +94,9 @@ struct hg_test_info {
 
 #define MERCURY_TESTING_NUM_THREADS_DEFAULT 8
 
+/* Time before hg_test_rpc_delay responds (ms) */
+#define HG_TEST_RPC_DELAY 500
+
 /*********************/
 /* Public Prototypes */
 /*********************/
@@ -90,6 +90,7 @@ na_test_usage(const char *execname)
     printf("    -k, --key           Pass auth key\n");
     printf("    -l, --loop          Number of loops (default: 1)\n");
     printf("    -b, --busy          Busy wait\n");
+    printf("    -R, --shared_recv   Use one shared receive ring (SM only)\n");
     printf("    -V, --verbose       Print verbose output\n");
 }
 
@@ -148,6 +149,9 @@ na_test_parse_options(int argc, char *argv[],
             case 'b': /* busy */
                 na_test_info->busy_wait = NA_TRUE;
                 break;
+            case 'R': /* shared recv */
+                na_test_info->shared_recv = NA_TRUE;
+                break;
             case 'V': /* verbose */
                 na_test_info->verbose = NA_TRUE;
                 break;
@@ -405,6 +409,7 @@ NA_Test_init(int argc, char *argv[], struct na_test_info *na_test_info)
     } else
         na_init_info.progress_mode = NA_DEFAULT;
     na_init_info.auth_key = na_test_info->key;
+    na_init_info.sm_shared_recv = na_test_info->shared_recv;
 
     printf("# Using info string: %s\n", info_string);
     na_test_info->na_class = NA_Initialize_opt(info_string,
@@ -17,7 +17,7 @@
 
 int na_test_opt_ind_g = 1; /* token pointer */
 const char *na_test_opt_arg_g = NULL; /* flag argument (or value) */
-const char *na_test_short_opt_g = "hc:p:H:LsSak:l:t:bmV";
+const char *na_test_short_opt_g = "hc:p:H:LsSak:l:t:bmRCTV";
 const struct na_test_opt na_test_opt_g[] = {
     { "help", no_arg, 'h'},
     { "comm", require_arg, 'c' },
@@ -32,6 +32,9 @@ const struct na_test_opt na_test_opt_g[] = {
     { "threads", require_arg, 't'},
     { "busy", no_arg, 'b'},
     { "memory", no_arg, 'm'},
+    { "shared_recv", no_arg, 'R'},
+    { "addr_cache", no_arg, 'C'},
+    { "handler_threads", no_arg, 'T'},
     { "verbose", no_arg, 'V' },
     { NULL, 0, '\0' } /* Must add this at the end */
 };
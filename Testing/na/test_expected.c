@@ -0,0 +1,433 @@
+/*
+ * Copyright (C) 2013-2017 Argonne National Laboratory, Department of Energy,
+ *                    UChicago Argonne, LLC and The HDF Group.
+ * All rights reserved.
+ *
+ * The full copyright notice, including terms governing use, modification,
+ * and redistribution, is contained in the COPYING file that can be
+ * found at the root of the source code distribution tree.
+ */
+
+#include "na_test.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/* Expected recvs posted on one addr. Tags that share their low 6 bits
+ * collide in the SM reply slots, recvs that find their slot taken wait in
+ * the fallback queue. */
+#define TAG_SLOT        1                   /* Gets slot of low bits 1 */
+#define TAG_QUEUE       (TAG_SLOT + 64)     /* Collides, queued */
+#define TAG_QUEUE_CANCEL (TAG_SLOT + 128)   /* Collides, canceled in queue */
+#define TAG_SLOT_CANCEL 2                   /* Gets slot 2, canceled */
+#define TAG_SLOT_REUSE  (TAG_SLOT + 192)    /* Reuses slot once matched */
+#define TAG_CANCEL_REUSE (TAG_SLOT_CANCEL + 64) /* Reuses slot once canceled */
+#define NRECVS          6
+#define NLOOPS          10000
+
+struct recv_args {
+    na_tag_t tag;
+    char *buf;
+    void *buf_plugin_data;
+    na_op_id_t op_id;
+    na_return_t ret;
+    na_bool_t done;
+};
+
+struct target_args {
+    na_class_t *na_class;
+    na_context_t *context;
+    char *recv_buf;
+    void *recv_buf_plugin_data;
+    char *send_buf;
+    void *send_buf_plugin_data;
+    na_op_id_t op_id;
+    na_bool_t posted;
+    na_bool_t error;
+};
+
+struct lookup_args {
+    na_addr_t addr;
+    na_bool_t done;
+};
+
+/*---------------------------------------------------------------------------*/
+static int
+lookup_cb(const struct na_cb_info *callback_info)
+{
+    struct lookup_args *args = (struct lookup_args *) callback_info->arg;
+
+    if (callback_info->ret == NA_SUCCESS)
+        args->addr = callback_info->info.lookup.addr;
+    args->done = NA_TRUE;
+
+    return 0;
+}
+
+/*---------------------------------------------------------------------------*/
+static int
+recv_expected_cb(const struct na_cb_info *callback_info)
+{
+    struct recv_args *args = (struct recv_args *) callback_info->arg;
+
+    args->ret = callback_info->ret;
+    args->done = NA_TRUE;
+
+    return 0;
+}
+
+/*---------------------------------------------------------------------------*/
+static int
+target_recv_cb(const struct na_cb_info *callback_info)
+{
+    struct target_args *args = (struct target_args *) callback_info->arg;
+    const struct na_cb_info_recv_unexpected *info =
+        &callback_info->info.recv_unexpected;
+    na_size_t header_size = NA_Msg_get_expected_header_size(args->na_class);
+    const char *tags;
+    char *tag_end;
+
+    /* Op id is released after callback returns, repost from progress loop */
+    args->posted = NA_FALSE;
+    if (callback_info->ret != NA_SUCCESS)
+        return 0;
+
+    /* Answer each tag listed in request, in that order */
+    tags = args->recv_buf + NA_Msg_get_unexpected_header_size(args->na_class);
+    for (;;) {
+        na_tag_t tag = (na_tag_t) strtoul(tags, &tag_end, 10);
+
+        if (tag_end == tags)
+            break;
+        tags = tag_end;
+
+        NA_Msg_init_expected(args->na_class, args->send_buf,
+            NA_Msg_get_max_expected_size(args->na_class));
+        sprintf(args->send_buf + header_size, "%u", (unsigned int) tag);
+        if (NA_Msg_send_expected(args->na_class, args->context, NULL, NULL,
+            args->send_buf, NA_Msg_get_max_expected_size(args->na_class),
+            args->send_buf_plugin_data, info->source, tag, NA_OP_ID_IGNORE)
+            != NA_SUCCESS) {
+            NA_LOG_ERROR("Could not send expected message");
+            args->error = NA_TRUE;
+        }
+    }
+    NA_Addr_free(args->na_class, info->source);
+
+    return 0;
+}
+
+/*---------------------------------------------------------------------------*/
+static int
+target_post(struct target_args *args)
+{
+    if (NA_Msg_recv_unexpected(args->na_class, args->context, target_recv_cb,
+        args, args->recv_buf, NA_Msg_get_max_unexpected_size(args->na_class),
+        args->recv_buf_plugin_data, 0, &args->op_id) != NA_SUCCESS) {
+        NA_LOG_ERROR("Could not post unexpected recv");
+        return EXIT_FAILURE;
+    }
+    args->posted = NA_TRUE;
+
+    return EXIT_SUCCESS;
+}
+
+/*---------------------------------------------------------------------------*/
+static void
+progress(na_class_t *na_class, na_context_t *context)
+{
+    unsigned int actual_count;
+
+    NA_Progress(na_class, context, 0);
+    do {
+        actual_count = 0;
+        NA_Trigger(context, 0, 1, NULL, &actual_count);
+    } while (actual_count);
+}
+
+/*---------------------------------------------------------------------------*/
+static int
+origin_post(na_class_t *na_class, na_context_t *context, na_addr_t addr,
+    struct recv_args *args)
+{
+    args->ret = NA_PROTOCOL_ERROR;
+    args->done = NA_FALSE;
+    memset(args->buf, 0, NA_Msg_get_max_expected_size(na_class));
+    if (NA_Msg_recv_expected(na_class, context, recv_expected_cb, args,
+        args->buf, NA_Msg_get_max_expected_size(na_class),
+        args->buf_plugin_data, addr, args->tag, &args->op_id) != NA_SUCCESS) {
+        NA_LOG_ERROR("Could not post expected recv (tag %u)",
+            (unsigned int) args->tag);
+        return EXIT_FAILURE;
+    }
+
+    return EXIT_SUCCESS;
+}
+
+/*---------------------------------------------------------------------------*/
+static int
+origin_request(na_class_t *na_class, na_context_t *context, na_addr_t addr,
+    char *buf, void *buf_plugin_data, const char *tags)
+{
+    NA_Msg_init_unexpected(na_class, buf,
+        NA_Msg_get_max_unexpected_size(na_class));
+    strcpy(buf + NA_Msg_get_unexpected_header_size(na_class), tags);
+    if (NA_Msg_send_unexpected(na_class, context, NULL, NULL, buf,
+        NA_Msg_get_max_unexpected_size(na_class), buf_plugin_data, addr, 0,
+        NA_OP_ID_IGNORE) != NA_SUCCESS) {
+        NA_LOG_ERROR("Could not send request");
+        return EXIT_FAILURE;
+    }
+
+    return EXIT_SUCCESS;
+}
+
+/*---------------------------------------------------------------------------*/
+static int
+wait_recvs(na_class_t *na_class, na_context_t *context,
+    na_class_t *target_class, struct target_args *target_args,
+    struct recv_args *recvs[], unsigned int count)
+{
+    unsigned int i, loop, done_count = 0;
+
+    for (loop = 0; loop < NLOOPS && done_count < count; loop++) {
+        progress(target_class, target_args->context);
+        if (!target_args->posted && target_post(target_args) != EXIT_SUCCESS)
+            target_args->error = NA_TRUE;
+        progress(na_class, context);
+        for (i = 0, done_count = 0; i < count; i++)
+            done_count += recvs[i]->done;
+    }
+    if (target_args->error || done_count < count) {
+        fprintf(stderr, "Error: only %u of %u recvs completed\n", done_count,
+            count);
+        return EXIT_FAILURE;
+    }
+
+    return EXIT_SUCCESS;
+}
+
+/*---------------------------------------------------------------------------*/
+static int
+check_recv(na_class_t *na_class, struct recv_args *args, na_return_t ret)
+{
+    unsigned int tag = 0;
+
+    if (args->ret != ret) {
+        fprintf(stderr, "Error: recv of tag %u completed with %s\n",
+            (unsigned int) args->tag, NA_Error_to_string(args->ret));
+        return EXIT_FAILURE;
+    }
+    if (ret == NA_SUCCESS && (sscanf(args->buf
+        + NA_Msg_get_expected_header_size(na_class), "%u", &tag) != 1
+        || tag != (unsigned int) args->tag)) {
+        fprintf(stderr, "Error: recv of tag %u got message of tag %u\n",
+            (unsigned int) args->tag, tag);
+        return EXIT_FAILURE;
+    }
+
+    return EXIT_SUCCESS;
+}
+
+/*---------------------------------------------------------------------------*/
+static int
+test_expected(na_bool_t shared_recv)
+{
+    struct na_init_info na_init_info;
+    na_class_t *target_class = NULL, *na_class = NULL;
+    na_context_t *context = NULL;
+    na_addr_t self_addr = NA_ADDR_NULL;
+    char addr_string[256];
+    na_size_t addr_string_size = sizeof(addr_string);
+    struct target_args target_args;
+    struct lookup_args lookup_args = { NA_ADDR_NULL, NA_FALSE };
+    struct recv_args recvs[NRECVS];
+    struct recv_args *round[NRECVS];
+    char *send_buf = NULL;
+    void *send_buf_plugin_data = NULL;
+    na_tag_t tags[NRECVS] = { TAG_SLOT, TAG_QUEUE, TAG_QUEUE_CANCEL,
+        TAG_SLOT_CANCEL, TAG_SLOT_REUSE, TAG_CANCEL_REUSE };
+    unsigned int i, loop;
+    int ret = EXIT_SUCCESS;
+
+    memset(&target_args, 0, sizeof(target_args));
+    memset(recvs, 0, sizeof(recvs));
+    memset(&na_init_info, 0, sizeof(na_init_info));
+    na_init_info.progress_mode = NA_NO_BLOCK;
+    na_init_info.sm_shared_recv = shared_recv;
+
+    /* Origin and target live in one process */
+    target_class = NA_Initialize_opt("na+sm", NA_TRUE, &na_init_info);
+    na_class = NA_Initialize_opt("na+sm", NA_FALSE, &na_init_info);
+    if (!target_class || !na_class) {
+        fprintf(stderr, "Error: could not initialize NA classes\n");
+        ret = EXIT_FAILURE;
+        goto done;
+    }
+    target_args.na_class = target_class;
+    target_args.context = NA_Context_create(target_class);
+    target_args.op_id = NA_Op_create(target_class);
+    context = NA_Context_create(na_class);
+    if (!target_args.context || !context) {
+        fprintf(stderr, "Error: could not create NA contexts\n");
+        ret = EXIT_FAILURE;
+        goto done;
+    }
+
+    /* Buffers */
+    target_args.recv_buf = (char *) NA_Msg_buf_alloc(target_class,
+        NA_Msg_get_max_unexpected_size(target_class),
+        &target_args.recv_buf_plugin_data);
+    target_args.send_buf = (char *) NA_Msg_buf_alloc(target_class,
+        NA_Msg_get_max_expected_size(target_class),
+        &target_args.send_buf_plugin_data);
+    send_buf = (char *) NA_Msg_buf_alloc(na_class,
+        NA_Msg_get_max_unexpected_size(na_class), &send_buf_plugin_data);
+    if (!target_args.recv_buf || !target_args.send_buf || !send_buf) {
+        fprintf(stderr, "Error: could not allocate buffers\n");
+        ret = EXIT_FAILURE;
+        goto done;
+    }
+    for (i = 0; i < NRECVS; i++) {
+        recvs[i].tag = tags[i];
+        recvs[i].buf = (char *) NA_Msg_buf_alloc(na_class,
+            NA_Msg_get_max_expected_size(na_class),
+            &recvs[i].buf_plugin_data);
+        recvs[i].op_id = NA_Op_create(na_class);
+        if (!recvs[i].buf) {
+            fprintf(stderr, "Error: could not allocate buffers\n");
+            ret = EXIT_FAILURE;
+            goto done;
+        }
+    }
+
+    /* Connect origin to target */
+    if (target_post(&target_args) != EXIT_SUCCESS
+        || NA_Addr_self(target_class, &self_addr) != NA_SUCCESS
+        || NA_Addr_to_string(target_class, addr_string, &addr_string_size,
+            self_addr) != NA_SUCCESS
+        || NA_Addr_lookup(na_class, context, lookup_cb, &lookup_args,
+            addr_string, NA_OP_ID_IGNORE) != NA_SUCCESS) {
+        fprintf(stderr, "Error: could not look up target addr\n");
+        ret = EXIT_FAILURE;
+        goto done;
+    }
+    for (loop = 0; loop < NLOOPS && !lookup_args.done; loop++) {
+        progress(na_class, context);
+        progress(target_class, target_args.context);
+    }
+    if (lookup_args.addr == NA_ADDR_NULL) {
+        fprintf(stderr, "Error: could not look up %s\n", addr_string);
+        ret = EXIT_FAILURE;
+        goto done;
+    }
+
+    /* Post first four recvs, two share a slot, the other two are canceled
+     * from the queue and from their slot */
+    for (i = 0; i < 4; i++) {
+        ret = origin_post(na_class, context, lookup_args.addr, &recvs[i]);
+        if (ret != EXIT_SUCCESS)
+            goto done;
+    }
+    if (NA_Cancel(na_class, context, recvs[2].op_id) != NA_SUCCESS
+        || NA_Cancel(na_class, context, recvs[3].op_id) != NA_SUCCESS) {
+        fprintf(stderr, "Error: could not cancel recvs\n");
+        ret = EXIT_FAILURE;
+        goto done;
+    }
+
+    /* Queued recv is answered first, while slot holds another tag */
+    ret = origin_request(na_class, context, lookup_args.addr, send_buf,
+        send_buf_plugin_data, "65 1");
+    if (ret != EXIT_SUCCESS)
+        goto done;
+    for (i = 0; i < 4; i++)
+        round[i] = &recvs[i];
+    ret = wait_recvs(na_class, context, target_class, &target_args, round, 4);
+    if (ret != EXIT_SUCCESS)
+        goto done;
+    if (check_recv(na_class, &recvs[0], NA_SUCCESS) != EXIT_SUCCESS
+        || check_recv(na_class, &recvs[1], NA_SUCCESS) != EXIT_SUCCESS
+        || check_recv(na_class, &recvs[2], NA_CANCELED) != EXIT_SUCCESS
+        || check_recv(na_class, &recvs[3], NA_CANCELED) != EXIT_SUCCESS) {
+        ret = EXIT_FAILURE;
+        goto done;
+    }
+
+    /* Slots freed by a match and by a cancel are taken again */
+    for (i = 4; i < NRECVS; i++) {
+        ret = origin_post(na_class, context, lookup_args.addr, &recvs[i]);
+        if (ret != EXIT_SUCCESS)
+            goto done;
+    }
+    ret = origin_request(na_class, context, lookup_args.addr, send_buf,
+        send_buf_plugin_data, "66 193");
+    if (ret != EXIT_SUCCESS)
+        goto done;
+    round[0] = &recvs[4];
+    round[1] = &recvs[5];
+    ret = wait_recvs(na_class, context, target_class, &target_args, round, 2);
+    if (ret != EXIT_SUCCESS)
+        goto done;
+    if (check_recv(na_class, &recvs[4], NA_SUCCESS) != EXIT_SUCCESS
+        || check_recv(na_class, &recvs[5], NA_SUCCESS) != EXIT_SUCCESS) {
+        ret = EXIT_FAILURE;
+        goto done;
+    }
+
+done:
+    for (i = 0; i < NRECVS; i++) {
+        if (recvs[i].op_id != NA_OP_ID_NULL)
+            NA_Op_destroy(na_class, recvs[i].op_id);
+        if (recvs[i].buf)
+            NA_Msg_buf_free(na_class, recvs[i].buf, recvs[i].buf_plugin_data);
+    }
+    if (send_buf)
+        NA_Msg_buf_free(na_class, send_buf, send_buf_plugin_data);
+    if (lookup_args.addr != NA_ADDR_NULL)
+        NA_Addr_free(na_class, lookup_args.addr);
+    if (self_addr != NA_ADDR_NULL)
+        NA_Addr_free(target_class, self_addr);
+    if (context)
+        NA_Context_destroy(na_class, context);
+    if (target_args.posted) {
+        /* Complete posted unexpected recv */
+        NA_Cancel(target_class, target_args.context, target_args.op_id);
+        for (loop = 0; loop < NLOOPS && target_args.posted; loop++)
+            progress(target_class, target_args.context);
+    }
+    if (target_args.op_id != NA_OP_ID_NULL)
+        NA_Op_destroy(target_class, target_args.op_id);
+    if (target_args.send_buf)
+        NA_Msg_buf_free(target_class, target_args.send_buf,
+            target_args.send_buf_plugin_data);
+    if (na_class)
+        NA_Finalize(na_class);
+    if (target_class) {
+        if (target_args.context)
+            NA_Context_destroy(target_class, target_args.context);
+        if (target_args.recv_buf)
+            NA_Msg_buf_free(target_class, target_args.recv_buf,
+                target_args.recv_buf_plugin_data);
+        NA_Finalize(target_class);
+    }
+    return ret;
+}
+
+/*---------------------------------------------------------------------------*/
+int
+main(int argc, char *argv[])
+{
+    int ret;
+
+    (void) argc;
+    (void) argv;
+
+    /* Per peer receive rings, then one shared ring */
+    ret = test_expected(NA_FALSE);
+    if (ret == EXIT_SUCCESS)
+        ret = test_expected(NA_TRUE);
+
+    return ret;
+}
@@ -12,8 +12,15 @@
 
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 
 extern hg_id_t hg_test_bulk_write_id_g;
+extern hg_id_t hg_test_bulk_read_id_g;
+extern hg_id_t hg_test_bulk_read_gaps_id_g;
+extern hg_id_t hg_test_bulk_read_pair_id_g;
+
+#define BULK_READ_COUNT 128 /* Small enough to be pushed eagerly */
+#define BULK_READ_PAIR_COUNT 768 /* Both regions do not fit into response */
 
 static hg_return_t
 hg_test_bulk_forward_cb(const struct hg_cb_info *callback_info)
@@ -48,6 +55,190 @@ done:
     return ret;
 }
 
+static int
+hg_test_bulk_read(struct hg_test_info *hg_test_info, hg_id_t id,
+    hg_uint8_t flags, int fildes)
+{
+    hg_request_t *request = NULL;
+    hg_handle_t handle;
+    bulk_write_in_t bulk_read_in_struct;
+    int bulk_buf[BULK_READ_COUNT];
+    void *buf_ptrs[2];
+    hg_size_t buf_sizes[2];
+    hg_bulk_t bulk_handle = HG_BULK_NULL;
+    hg_return_t hg_ret;
+    int i, ret = EXIT_SUCCESS;
+
+    /* Split buffer into two segments, server pushes data into it */
+    memset(bulk_buf, 0xFF, sizeof(bulk_buf));
+    buf_ptrs[0] = bulk_buf;
+    buf_sizes[0] = sizeof(bulk_buf) / 4;
+    buf_ptrs[1] = (char *) bulk_buf + buf_sizes[0];
+    buf_sizes[1] = sizeof(bulk_buf) - buf_sizes[0];
+
+    request = hg_request_create(hg_test_info->request_class);
+
+    hg_ret = HG_Create(hg_test_info->context, hg_test_info->target_addr,
+        id, &handle);
+    if (hg_ret != HG_SUCCESS) {
+        fprintf(stderr, "Could not start call\n");
+        return EXIT_FAILURE;
+    }
+
+    /* Register memory */
+    hg_ret = HG_Bulk_create(hg_test_info->hg_class, 2, buf_ptrs, buf_sizes,
+        flags, &bulk_handle);
+    if (hg_ret != HG_SUCCESS) {
+        fprintf(stderr, "Could not create bulk data handle\n");
+        return EXIT_FAILURE;
+    }
+
+    /* Fill input structure */
+    bulk_read_in_struct.fildes = fildes;
+    bulk_read_in_struct.bulk_handle = bulk_handle;
+
+    /* Forward call to remote addr and get a new request */
+    printf("Forwarding bulk_read, op id: %u...\n", id);
+    hg_ret = HG_Forward(handle, hg_test_bulk_forward_cb, request,
+            &bulk_read_in_struct);
+    if (hg_ret != HG_SUCCESS) {
+        fprintf(stderr, "Could not forward call\n");
+        return EXIT_FAILURE;
+    }
+
+    hg_request_wait(request, HG_MAX_IDLE_TIME, NULL);
+
+    /* Pushed data must be in place once the response has been received, the
+     * gaps RPC only pushes the first and third quarters and data in between
+     * must be left untouched */
+    for (i = 0; i < BULK_READ_COUNT; i++) {
+        int expected = i + fildes;
+
+        if (id == hg_test_bulk_read_gaps_id_g
+            && (i / (BULK_READ_COUNT / 4)) % 2)
+            expected = -1;
+        if (bulk_buf[i] != expected) {
+            fprintf(stderr, "Error detected in bulk read, buf[%d] = %d, "
+                "was expecting %d!\n", i, bulk_buf[i], expected);
+            ret = EXIT_FAILURE;
+            break;
+        }
+    }
+
+    /* Free memory handle */
+    hg_ret = HG_Bulk_free(bulk_handle);
+    if (hg_ret != HG_SUCCESS) {
+        fprintf(stderr, "Could not free bulk data handle\n");
+        return EXIT_FAILURE;
+    }
+
+    /* Complete */
+    hg_ret = HG_Destroy(handle);
+    if (hg_ret != HG_SUCCESS) {
+        fprintf(stderr, "Could not complete\n");
+        return EXIT_FAILURE;
+    }
+
+    hg_request_destroy(request);
+
+    return ret;
+}
+
+static int
+hg_test_bulk_read_pair(struct hg_test_info *hg_test_info, int fildes)
+{
+    hg_request_t *request = NULL;
+    hg_handle_t handle;
+    bulk_read_pair_in_t bulk_read_in_struct;
+    int bulk_buf[2 * BULK_READ_PAIR_COUNT];
+    void *buf_ptrs[2];
+    hg_size_t buf_sizes[2];
+    hg_bulk_t bulk_handle1 = HG_BULK_NULL;
+    hg_bulk_t bulk_handle2 = HG_BULK_NULL;
+    hg_return_t hg_ret;
+    int i, ret = EXIT_SUCCESS;
+
+    /* Server pushes data into two separate 3 KB regions */
+    memset(bulk_buf, 0xFF, sizeof(bulk_buf));
+    buf_ptrs[0] = bulk_buf;
+    buf_ptrs[1] = bulk_buf + BULK_READ_PAIR_COUNT;
+    buf_sizes[0] = buf_sizes[1] = BULK_READ_PAIR_COUNT * sizeof(int);
+
+    request = hg_request_create(hg_test_info->request_class);
+
+    hg_ret = HG_Create(hg_test_info->context, hg_test_info->target_addr,
+        hg_test_bulk_read_pair_id_g, &handle);
+    if (hg_ret != HG_SUCCESS) {
+        fprintf(stderr, "Could not start call\n");
+        return EXIT_FAILURE;
+    }
+
+    /* Register memory */
+    hg_ret = HG_Bulk_create(hg_test_info->hg_class, 1, &buf_ptrs[0],
+        &buf_sizes[0], HG_BULK_WRITE_ONLY, &bulk_handle1);
+    if (hg_ret != HG_SUCCESS) {
+        fprintf(stderr, "Could not create bulk data handle\n");
+        return EXIT_FAILURE;
+    }
+    hg_ret = HG_Bulk_create(hg_test_info->hg_class, 1, &buf_ptrs[1],
+        &buf_sizes[1], HG_BULK_WRITE_ONLY, &bulk_handle2);
+    if (hg_ret != HG_SUCCESS) {
+        fprintf(stderr, "Could not create bulk data handle\n");
+        return EXIT_FAILURE;
+    }
+
+    /* Fill input structure */
+    bulk_read_in_struct.fildes = fildes;
+    bulk_read_in_struct.bulk_handle1 = bulk_handle1;
+    bulk_read_in_struct.bulk_handle2 = bulk_handle2;
+
+    /* Forward call to remote addr and get a new request */
+    printf("Forwarding bulk_read_pair, op id: %u...\n",
+        hg_test_bulk_read_pair_id_g);
+    hg_ret = HG_Forward(handle, hg_test_bulk_forward_cb, request,
+            &bulk_read_in_struct);
+    if (hg_ret != HG_SUCCESS) {
+        fprintf(stderr, "Could not forward call\n");
+        return EXIT_FAILURE;
+    }
+
+    hg_request_wait(request, HG_MAX_IDLE_TIME, NULL);
+
+    /* Data that does not fit into the response must have been transferred
+     * before the response was sent */
+    for (i = 0; i < 2 * BULK_READ_PAIR_COUNT; i++) {
+        if (bulk_buf[i] != i + fildes) {
+            fprintf(stderr, "Error detected in bulk read pair, buf[%d] = %d, "
+                "was expecting %d!\n", i, bulk_buf[i], i + fildes);
+            ret = EXIT_FAILURE;
+            break;
+        }
+    }
+
+    /* Free memory handles */
+    hg_ret = HG_Bulk_free(bulk_handle1);
+    if (hg_ret != HG_SUCCESS) {
+        fprintf(stderr, "Could not free bulk data handle\n");
+        return EXIT_FAILURE;
+    }
+    hg_ret = HG_Bulk_free(bulk_handle2);
+    if (hg_ret != HG_SUCCESS) {
+        fprintf(stderr, "Could not free bulk data handle\n");
+        return EXIT_FAILURE;
+    }
+
+    /* Complete */
+    hg_ret = HG_Destroy(handle);
+    if (hg_ret != HG_SUCCESS) {
+        fprintf(stderr, "Could not complete\n");
+        return EXIT_FAILURE;
+    }
+
+    hg_request_destroy(request);
+
+    return ret;
+}
+
 /******************************************************************************/
 int main(int argc, char *argv[])
 {
@@ -67,6 +258,7 @@ int main(int argc, char *argv[])
 
     hg_return_t hg_ret;
     size_t i;
+    int ret;
 
     /* Prepare bulk_buf */
     bulk_buf = (int *) malloc(bulk_size);
@@ -129,10 +321,26 @@ int main(int argc, char *argv[])
 
     hg_request_destroy(request);
 
+    /* Small bulk read */
+    ret = hg_test_bulk_read(&hg_test_info, hg_test_bulk_read_id_g,
+        HG_BULK_WRITE_ONLY, fildes);
+
+    /* Small bulk read with non-adjacent pushes */
+    if (ret == EXIT_SUCCESS)
+        ret = hg_test_bulk_read(&hg_test_info, hg_test_bulk_read_gaps_id_g,
+            HG_BULK_WRITE_ONLY, fildes);
+    if (ret == EXIT_SUCCESS)
+        ret = hg_test_bulk_read(&hg_test_info, hg_test_bulk_read_gaps_id_g,
+            HG_BULK_READWRITE, fildes);
+
+    /* Small bulk read into regions that do not all fit into the response */
+    if (ret == EXIT_SUCCESS)
+        ret = hg_test_bulk_read_pair(&hg_test_info, fildes);
+
     HG_Test_finalize(&hg_test_info);
 
     /* Free bulk data */
     free(bulk_buf);
 
-    return EXIT_SUCCESS;
+    return ret;
 }
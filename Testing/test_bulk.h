@@ -23,6 +23,9 @@
 MERCURY_GEN_PROC(bulk_write_in_t,
         ((hg_int32_t)(fildes)) ((hg_bulk_t)(bulk_handle)))
 MERCURY_GEN_PROC(bulk_write_out_t, ((hg_uint64_t)(ret)))
+MERCURY_GEN_PROC(bulk_read_pair_in_t,
+        ((hg_int32_t)(fildes)) ((hg_bulk_t)(bulk_handle1))
+        ((hg_bulk_t)(bulk_handle2)))
 #else
 /* Define bulk_write_in_t */
 typedef struct {
@@ -72,6 +75,41 @@ hg_proc_bulk_write_out_t(hg_proc_t proc, void *data)
 
     return ret;
 }
+
+/* Define bulk_read_pair_in_t */
+typedef struct {
+    hg_int32_t fildes;
+    hg_bulk_t bulk_handle1;
+    hg_bulk_t bulk_handle2;
+} bulk_read_pair_in_t;
+
+/* Define hg_proc_bulk_read_pair_in_t */
+static HG_INLINE hg_return_t
+hg_proc_bulk_read_pair_in_t(hg_proc_t proc, void *data)
+{
+    hg_return_t ret = HG_SUCCESS;
+    bulk_read_pair_in_t *struct_data = (bulk_read_pair_in_t *) data;
+
+    ret = hg_proc_int32_t(proc, &struct_data->fildes);
+    if (ret != HG_SUCCESS) {
+        HG_LOG_ERROR("Proc error");
+        return ret;
+    }
+
+    ret = hg_proc_hg_bulk_t(proc, &struct_data->bulk_handle1);
+    if (ret != HG_SUCCESS) {
+        HG_LOG_ERROR("Proc error");
+        return ret;
+    }
+
+    ret = hg_proc_hg_bulk_t(proc, &struct_data->bulk_handle2);
+    if (ret != HG_SUCCESS) {
+        HG_LOG_ERROR("Proc error");
+        return ret;
+    }
+
+    return ret;
+}
 #endif
 
 #endif /* TEST_BULK_H */
@@ -0,0 +1,103 @@
+/*
+ * Copyright (C) 2013-2017 Argonne National Laboratory, Department of Energy,
+ *                    UChicago Argonne, LLC and The HDF Group.
+ * All rights reserved.
+ *
+ * The full copyright notice, including terms governing use, modification,
+ * and redistribution, is contained in the COPYING file that can be
+ * found at the root of the source code distribution tree.
+ */
+
+#include "mercury_compress.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define BUF_SIZE (4 * HG_COMPRESS_THRESHOLD)
+
+int
+main(int argc, char *argv[])
+{
+    char *src = NULL, *dest = NULL, *out = NULL;
+    hg_size_t bound, actual_size = 0;
+    hg_return_t hg_ret;
+    size_t i;
+    int ret = EXIT_SUCCESS;
+
+    (void) argc;
+    (void) argv;
+
+    /* Compressible payload, as an RPC argument with a long path would be */
+    src = (char *) malloc(BUF_SIZE);
+    out = (char *) malloc(BUF_SIZE);
+    bound = hg_compress_bound(BUF_SIZE);
+    dest = (char *) malloc(bound);
+    if (!src || !out || !dest) {
+        fprintf(stderr, "Error: could not allocate buffers\n");
+        ret = EXIT_FAILURE;
+        goto done;
+    }
+    for (i = 0; i < BUF_SIZE; i++)
+        src[i] = (char) ('a' + (i % 64) / 8);
+
+    /* Round trip */
+    hg_ret = hg_compress(src, BUF_SIZE, dest, bound, &actual_size);
+    if (hg_ret != HG_SUCCESS) {
+        fprintf(stderr, "Error: could not compress buffer\n");
+        ret = EXIT_FAILURE;
+        goto done;
+    }
+    if (actual_size == 0 || actual_size >= BUF_SIZE) {
+        fprintf(stderr, "Error: buffer did not shrink (%lu -> %lu)\n",
+            (unsigned long) BUF_SIZE, (unsigned long) actual_size);
+        ret = EXIT_FAILURE;
+        goto done;
+    }
+    memset(out, 0, BUF_SIZE);
+    hg_ret = hg_decompress(dest, actual_size, out, BUF_SIZE);
+    if (hg_ret != HG_SUCCESS) {
+        fprintf(stderr, "Error: could not decompress buffer\n");
+        ret = EXIT_FAILURE;
+        goto done;
+    }
+    if (memcmp(src, out, BUF_SIZE) != 0) {
+        fprintf(stderr, "Error: round trip does not match\n");
+        ret = EXIT_FAILURE;
+        goto done;
+    }
+
+    /* Compressed data that does not fit must fail */
+    hg_ret = hg_compress(src, BUF_SIZE, dest, actual_size / 2, &actual_size);
+    if (hg_ret == HG_SUCCESS) {
+        fprintf(stderr, "Error: compression into short buffer succeeded\n");
+        ret = EXIT_FAILURE;
+        goto done;
+    }
+    hg_ret = hg_compress(src, BUF_SIZE, dest, bound, &actual_size);
+    if (hg_ret != HG_SUCCESS) {
+        fprintf(stderr, "Error: could not compress buffer\n");
+        ret = EXIT_FAILURE;
+        goto done;
+    }
+
+    /* Sizes announced by peers that do not match must fail */
+    hg_ret = hg_decompress(dest, actual_size, out, BUF_SIZE / 2);
+    if (hg_ret == HG_SUCCESS) {
+        fprintf(stderr, "Error: decompression into short buffer succeeded\n");
+        ret = EXIT_FAILURE;
+        goto done;
+    }
+    hg_ret = hg_decompress(dest, actual_size / 2, out, BUF_SIZE);
+    if (hg_ret == HG_SUCCESS) {
+        fprintf(stderr, "Error: decompression of truncated data succeeded\n");
+        ret = EXIT_FAILURE;
+        goto done;
+    }
+
+done:
+    free(src);
+    free(dest);
+    free(out);
+    return ret;
+}
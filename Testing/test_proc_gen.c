@@ -0,0 +1,315 @@
+/*
+ * Copyright (C) 2013-2017 Argonne National Laboratory, Department of Energy,
+ *                    UChicago Argonne, LLC and The HDF Group.
+ * All rights reserved.
+ *
+ * The full copyright notice, including terms governing use, modification,
+ * and redistribution, is contained in the COPYING file that can be
+ * found at the root of the source code distribution tree.
+ */
+
+#include "mercury.h"
+#include "test_proc_gen.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define BUF_SIZE 4096
+#define ARRAY_COUNT 64
+
+/* Length-prefixed array */
+typedef struct {
+    hg_uint64_t count;
+    hg_int32_t *values;
+} packed_in_t;
+
+/* Reference proc, as it would be written with MERCURY_GEN_PROC */
+static hg_return_t
+hg_proc_ref_in_t(hg_proc_t proc, void *data)
+{
+    proc_gen_in_t *struct_data = (proc_gen_in_t *) data;
+    hg_return_t ret = HG_SUCCESS;
+    int i;
+
+    ret = hg_proc_hg_uint64_t(proc, &struct_data->id);
+    if (ret != HG_SUCCESS)
+        return ret;
+    ret = hg_proc_hg_uint32_t(proc, &struct_data->flags);
+    if (ret != HG_SUCCESS)
+        return ret;
+    ret = hg_proc_hg_uint32_t(proc, &struct_data->mode);
+    if (ret != HG_SUCCESS)
+        return ret;
+    ret = hg_proc_hg_const_string_t(proc, &struct_data->path);
+    if (ret != HG_SUCCESS)
+        return ret;
+    ret = hg_proc_hg_uint64_t(proc, &struct_data->handle.cookie);
+    if (ret != HG_SUCCESS)
+        return ret;
+    ret = hg_proc_hg_uint8_t(proc, &struct_data->type);
+    if (ret != HG_SUCCESS)
+        return ret;
+    for (i = 0; i < 8; i++) {
+        ret = hg_proc_hg_uint64_t(proc, &struct_data->offsets[i]);
+        if (ret != HG_SUCCESS)
+            return ret;
+    }
+    ret = hg_proc_hg_int16_t(proc, &struct_data->prio);
+
+    return ret;
+}
+
+static hg_return_t
+hg_proc_packed_in_t(hg_proc_t proc, void *data)
+{
+    packed_in_t *struct_data = (packed_in_t *) data;
+
+    return hg_proc_packed_array(proc, (void **) &struct_data->values,
+        &struct_data->count, sizeof(hg_int32_t), HG_TRUE);
+}
+
+static hg_return_t
+process(hg_class_t *hg_class, hg_proc_cb_t proc_cb, void *buf,
+    hg_size_t buf_size, hg_proc_op_t op, hg_uint8_t flags, void *data,
+    hg_size_t *size_used)
+{
+    hg_proc_t proc;
+    hg_return_t ret;
+
+    ret = hg_proc_create_set(hg_class, buf, buf_size, op, HG_NOHASH, &proc);
+    if (ret != HG_SUCCESS)
+        return ret;
+    hg_proc_set_flags(proc, flags);
+    ret = proc_cb(proc, data);
+    if (size_used)
+        *size_used = hg_proc_get_size_used(proc);
+    hg_proc_free(proc);
+
+    return ret;
+}
+
+static int
+compare(const proc_gen_in_t *in, const proc_gen_in_t *out)
+{
+    return in->id != out->id || in->flags != out->flags
+        || in->mode != out->mode || strcmp(in->path, out->path)
+        || in->handle.cookie != out->handle.cookie || in->type != out->type
+        || memcmp(in->offsets, out->offsets, sizeof(in->offsets))
+        || in->prio != out->prio;
+}
+
+/* Packed array must round-trip in both encodings, compact must be smaller */
+static int
+test_packed_array(hg_class_t *hg_class)
+{
+    hg_int32_t values[ARRAY_COUNT];
+    packed_in_t in_struct, out_struct;
+    char buf[BUF_SIZE];
+    hg_size_t size_used, full_size_used = 0;
+    hg_uint8_t flags[2] = {0, HG_PROC_COMPACT};
+    hg_return_t hg_ret;
+    int i, ret = EXIT_SUCCESS;
+
+    for (i = 0; i < ARRAY_COUNT; i++)
+        values[i] = (i % 2) ? -i : i;
+    in_struct.count = ARRAY_COUNT;
+    in_struct.values = values;
+
+    for (i = 0; i < 2; i++) {
+        memset(buf, 0, BUF_SIZE);
+        hg_ret = process(hg_class, hg_proc_packed_in_t, buf, BUF_SIZE,
+            HG_ENCODE, flags[i], &in_struct, &size_used);
+        if (hg_ret != HG_SUCCESS) {
+            fprintf(stderr, "Error: could not encode packed array\n");
+            return EXIT_FAILURE;
+        }
+        if (!flags[i])
+            full_size_used = size_used;
+        else if (size_used >= full_size_used) {
+            fprintf(stderr, "Error: compact packed array is not smaller\n");
+            ret = EXIT_FAILURE;
+        }
+
+        memset(&out_struct, 0, sizeof(out_struct));
+        hg_ret = process(hg_class, hg_proc_packed_in_t, buf, size_used,
+            HG_DECODE, flags[i], &out_struct, NULL);
+        if (hg_ret != HG_SUCCESS || out_struct.count != ARRAY_COUNT
+            || memcmp(values, out_struct.values, sizeof(values))) {
+            fprintf(stderr, "Error: decoded packed array differs\n");
+            ret = EXIT_FAILURE;
+        }
+        process(hg_class, hg_proc_packed_in_t, buf, BUF_SIZE, HG_FREE, 0,
+            &out_struct, NULL);
+        if (out_struct.values) {
+            fprintf(stderr, "Error: packed array was not freed\n");
+            ret = EXIT_FAILURE;
+        }
+    }
+
+    /* Count larger than what the buffer can hold must be rejected (varint
+     * of 2^20 followed by a few elements) */
+    memset(buf, 0, BUF_SIZE);
+    buf[0] = (char) 0x80;
+    buf[1] = (char) 0x80;
+    buf[2] = (char) 0x40;
+    memset(&out_struct, 0, sizeof(out_struct));
+    hg_ret = process(hg_class, hg_proc_packed_in_t, buf, 8, HG_DECODE,
+        HG_PROC_COMPACT, &out_struct, NULL);
+    if (hg_ret == HG_SUCCESS || out_struct.values) {
+        fprintf(stderr, "Error: decoded packed array with invalid count\n");
+        ret = EXIT_FAILURE;
+    }
+
+    return ret;
+}
+
+/* 10-byte varints may only carry bit 63 in their last byte */
+static int
+test_varint_overflow(hg_class_t *hg_class)
+{
+    hg_uint8_t buf[16];
+    hg_uint64_t value = 0;
+    hg_return_t hg_ret;
+    int ret = EXIT_SUCCESS;
+
+    memset(buf, 0xff, 9);
+    buf[9] = 0x01;
+    hg_ret = process(hg_class, hg_proc_hg_uint64_t, buf, sizeof(buf),
+        HG_DECODE, HG_PROC_COMPACT, &value, NULL);
+    if (hg_ret != HG_SUCCESS || value != ~((hg_uint64_t) 0)) {
+        fprintf(stderr, "Error: could not decode largest varint\n");
+        ret = EXIT_FAILURE;
+    }
+
+    buf[9] = 0x02;
+    hg_ret = process(hg_class, hg_proc_hg_uint64_t, buf, sizeof(buf),
+        HG_DECODE, HG_PROC_COMPACT, &value, NULL);
+    if (hg_ret == HG_SUCCESS) {
+        fprintf(stderr, "Error: decoded varint exceeding 64 bits\n");
+        ret = EXIT_FAILURE;
+    }
+
+    return ret;
+}
+
+int
+main(int argc, char *argv[])
+{
+    hg_class_t *hg_class = NULL;
+    proc_gen_in_t in_struct, out_struct;
+    char buf[BUF_SIZE], ref_buf[BUF_SIZE];
+    hg_size_t size_used, ref_size_used;
+    hg_return_t hg_ret;
+    int i, ret = EXIT_SUCCESS;
+
+    (void) argc;
+    (void) argv;
+
+    hg_class = HG_Init("na+sm", HG_FALSE);
+    if (!hg_class) {
+        fprintf(stderr, "Error: could not initialize HG\n");
+        ret = EXIT_FAILURE;
+        goto done;
+    }
+
+    memset(&in_struct, 0, sizeof(in_struct));
+    in_struct.id = 0x0123456789abcdefULL;
+    in_struct.flags = 0xdeadbeef;
+    in_struct.mode = 0644;
+    in_struct.path = "/proc/gen/test";
+    in_struct.handle.cookie = 42;
+    in_struct.type = 7;
+    for (i = 0; i < 8; i++)
+        in_struct.offsets[i] = (hg_uint64_t) i << 32;
+    in_struct.prio = -3;
+
+    /* Encode with generated and reference procs, wire format must match */
+    memset(buf, 0, BUF_SIZE);
+    memset(ref_buf, 0, BUF_SIZE);
+    hg_ret = process(hg_class, hg_proc_proc_gen_in_t, buf, BUF_SIZE,
+        HG_ENCODE, 0, &in_struct, &size_used);
+    if (hg_ret != HG_SUCCESS) {
+        fprintf(stderr, "Error: could not encode\n");
+        ret = EXIT_FAILURE;
+        goto done;
+    }
+    hg_ret = process(hg_class, hg_proc_ref_in_t, ref_buf, BUF_SIZE,
+        HG_ENCODE, 0, &in_struct, &ref_size_used);
+    if (hg_ret != HG_SUCCESS) {
+        fprintf(stderr, "Error: could not encode reference\n");
+        ret = EXIT_FAILURE;
+        goto done;
+    }
+    if (size_used != ref_size_used || memcmp(buf, ref_buf, size_used)) {
+        fprintf(stderr, "Error: encoded buffers differ\n");
+        ret = EXIT_FAILURE;
+        goto done;
+    }
+
+    /* Decode and compare */
+    memset(&out_struct, 0, sizeof(out_struct));
+    hg_ret = process(hg_class, hg_proc_proc_gen_in_t, buf, BUF_SIZE,
+        HG_DECODE, 0, &out_struct, NULL);
+    if (hg_ret != HG_SUCCESS) {
+        fprintf(stderr, "Error: could not decode\n");
+        ret = EXIT_FAILURE;
+        goto done;
+    }
+    if (compare(&in_struct, &out_struct)) {
+        fprintf(stderr, "Error: decoded struct differs\n");
+        ret = EXIT_FAILURE;
+    }
+    hg_ret = process(hg_class, hg_proc_proc_gen_in_t, buf, BUF_SIZE,
+        HG_FREE, 0, &out_struct, NULL);
+    if (hg_ret != HG_SUCCESS) {
+        fprintf(stderr, "Error: could not free\n");
+        ret = EXIT_FAILURE;
+        goto done;
+    }
+    if (ret != EXIT_SUCCESS)
+        goto done;
+
+    /* Compact encoding must round-trip and produce a smaller payload */
+    memset(buf, 0, BUF_SIZE);
+    hg_ret = process(hg_class, hg_proc_proc_gen_in_t, buf, BUF_SIZE,
+        HG_ENCODE, HG_PROC_COMPACT, &in_struct, &size_used);
+    if (hg_ret != HG_SUCCESS || size_used >= ref_size_used) {
+        fprintf(stderr, "Error: could not encode compact (%zu bytes)\n",
+            (size_t) size_used);
+        ret = EXIT_FAILURE;
+        goto done;
+    }
+    memset(&out_struct, 0, sizeof(out_struct));
+    hg_ret = process(hg_class, hg_proc_proc_gen_in_t, buf, size_used,
+        HG_DECODE, HG_PROC_COMPACT, &out_struct, NULL);
+    if (hg_ret != HG_SUCCESS || compare(&in_struct, &out_struct)) {
+        fprintf(stderr, "Error: compact decoded struct differs\n");
+        ret = EXIT_FAILURE;
+    }
+    process(hg_class, hg_proc_proc_gen_in_t, buf, BUF_SIZE, HG_FREE, 0,
+        &out_struct, NULL);
+    if (ret != EXIT_SUCCESS)
+        goto done;
+
+    /* Decoding a truncated buffer must fail */
+    memset(&out_struct, 0, sizeof(out_struct));
+    hg_ret = process(hg_class, hg_proc_proc_gen_in_t, buf, 8, HG_DECODE, 0,
+        &out_struct, NULL);
+    if (hg_ret == HG_SUCCESS) {
+        fprintf(stderr, "Error: decoded truncated buffer\n");
+        ret = EXIT_FAILURE;
+        goto done;
+    }
+
+    ret = test_packed_array(hg_class);
+    if (ret != EXIT_SUCCESS)
+        goto done;
+
+    ret = test_varint_overflow(hg_class);
+
+done:
+    if (hg_class)
+        HG_Finalize(hg_class);
+    return ret;
+}
@@ -9,20 +9,42 @@
  */
 
 #include "mercury_test.h"
+#include "mercury_time.h"
 
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 
 extern hg_id_t hg_test_rpc_open_id_g;
 extern hg_id_t hg_test_rpc_open_id_no_resp_g;
+extern hg_id_t hg_test_rpc_iov_id_g;
+extern hg_id_t hg_test_rpc_delay_id_g;
 
 #define NINFLIGHT 32
+#define NCREDITS 16 /* Credits of addr before first response */
 
 struct forward_cb_args {
     hg_request_t *request;
     rpc_handle_t *rpc_handle;
 };
 
+struct lookup_cb_args {
+    hg_request_t *request;
+    hg_addr_t addr;
+    hg_return_t ret;
+};
+
+struct forward_ret_cb_args {
+    hg_request_t *request;
+    hg_return_t ret;
+};
+
+struct forward_iov_cb_args {
+    hg_request_t *request;
+    const char *expected;
+    hg_return_t ret;
+};
+
 extern hg_return_t
 HG_Core_set_target_id(hg_handle_t handle, hg_uint8_t target_id);
 
@@ -104,6 +126,62 @@ done:
     return ret;
 }
 
+/*---------------------------------------------------------------------------*/
+/**
+ * HG_Forward_iov callback
+ */
+static hg_return_t
+hg_test_rpc_forward_iov_cb(const struct hg_cb_info *callback_info)
+{
+    hg_handle_t handle = callback_info->info.forward.handle;
+    struct forward_iov_cb_args *args =
+        (struct forward_iov_cb_args *) callback_info->arg;
+    void *out_buf;
+    hg_size_t out_buf_size, expected_size = strlen(args->expected) + 1;
+    hg_return_t ret = HG_SUCCESS;
+
+    if (callback_info->ret != HG_SUCCESS) {
+        HG_TEST_LOG_ERROR("Return from callback info is not HG_SUCCESS");
+        ret = callback_info->ret;
+        goto done;
+    }
+
+    /* Get output buffer */
+    ret = HG_Get_output_buf(handle, &out_buf, &out_buf_size);
+    if (ret != HG_SUCCESS) {
+        HG_TEST_LOG_ERROR("Could not get output buffer");
+        goto done;
+    }
+
+    if (out_buf_size < expected_size
+        || memcmp(out_buf, args->expected, expected_size)) {
+        HG_TEST_LOG_ERROR("Output buffer did not match input buffers");
+        ret = HG_PROTOCOL_ERROR;
+        goto done;
+    }
+
+done:
+    args->ret = ret;
+    hg_request_complete(args->request);
+    return ret;
+}
+
+/*---------------------------------------------------------------------------*/
+/**
+ * HG_Forward callback (only record return code)
+ */
+static hg_return_t
+hg_test_rpc_forward_ret_cb(const struct hg_cb_info *callback_info)
+{
+    struct forward_ret_cb_args *args =
+        (struct forward_ret_cb_args *) callback_info->arg;
+
+    args->ret = callback_info->ret;
+    hg_request_complete(args->request);
+
+    return HG_SUCCESS;
+}
+
 /*---------------------------------------------------------------------------*/
 static hg_return_t
 hg_test_rpc_forward_reset_cb(const struct hg_cb_info *callback_info)
@@ -424,6 +502,906 @@ done:
     return hg_ret;
 }
 
+/*---------------------------------------------------------------------------*/
+static hg_return_t
+hg_test_rpc_iov(hg_context_t *context, hg_request_class_t *request_class,
+    hg_addr_t addr, hg_id_t rpc_id, hg_cb_t callback)
+{
+    hg_request_t *request = NULL;
+    hg_handle_t handle;
+    hg_return_t hg_ret = HG_SUCCESS;
+    struct forward_iov_cb_args forward_cb_args;
+    char buf0[] = "scatter", buf1[] = "-gather-", buf2[] = "payload";
+    void *buf_ptrs[3] = { buf0, buf1, buf2 };
+    hg_size_t buf_sizes[3] = { sizeof(buf0) - 1, sizeof(buf1) - 1,
+        sizeof(buf2) };
+    /* More buffers than NA gathers at once, sent contiguously instead */
+    char long_buf[] = "0123456789abcdef";
+    void *long_buf_ptrs[sizeof(long_buf)];
+    hg_size_t long_buf_sizes[sizeof(long_buf)];
+    unsigned int i;
+
+    for (i = 0; i < sizeof(long_buf); i++) {
+        long_buf_ptrs[i] = &long_buf[i];
+        long_buf_sizes[i] = 1;
+    }
+
+    for (i = 0; i < 2; i++) {
+        request = hg_request_create(request_class);
+
+        /* Create RPC request */
+        hg_ret = HG_Create(context, addr, rpc_id, &handle);
+        if (hg_ret != HG_SUCCESS) {
+            HG_TEST_LOG_ERROR("Could not create handle");
+            goto done;
+        }
+
+        /* Forward user buffers, server echoes them back */
+        forward_cb_args.request = request;
+        forward_cb_args.ret = HG_SUCCESS;
+        if (i == 0) {
+            forward_cb_args.expected = "scatter-gather-payload";
+            hg_ret = HG_Forward_iov(handle, callback, &forward_cb_args, 3,
+                buf_ptrs, buf_sizes);
+        } else {
+            forward_cb_args.expected = long_buf;
+            hg_ret = HG_Forward_iov(handle, callback, &forward_cb_args,
+                (hg_uint32_t) sizeof(long_buf), long_buf_ptrs,
+                long_buf_sizes);
+        }
+        if (hg_ret != HG_SUCCESS) {
+            HG_TEST_LOG_ERROR("Could not forward call");
+            goto done;
+        }
+
+        hg_request_wait(request, HG_MAX_IDLE_TIME, NULL);
+        if (forward_cb_args.ret != HG_SUCCESS) {
+            hg_ret = forward_cb_args.ret;
+            goto done;
+        }
+
+        /* Complete */
+        hg_ret = HG_Destroy(handle);
+        if (hg_ret != HG_SUCCESS) {
+            HG_TEST_LOG_ERROR("Could not destroy handle");
+            goto done;
+        }
+
+        hg_request_destroy(request);
+    }
+
+done:
+    return hg_ret;
+}
+
+/*---------------------------------------------------------------------------*/
+static hg_return_t
+hg_test_rpc_timed(hg_context_t *context, hg_request_class_t *request_class,
+    hg_addr_t addr)
+{
+    hg_request_t *request = NULL;
+    hg_handle_t handle = HG_HANDLE_NULL;
+    struct forward_ret_cb_args forward_ret_cb_args;
+    hg_time_t t1, t2;
+    double elapsed;
+    hg_return_t hg_ret = HG_SUCCESS;
+
+    request = hg_request_create(request_class);
+    forward_ret_cb_args.request = request;
+
+    hg_ret = HG_Create(context, addr, hg_test_rpc_delay_id_g, &handle);
+    if (hg_ret != HG_SUCCESS) {
+        HG_TEST_LOG_ERROR("Could not create handle");
+        goto done;
+    }
+
+    /* Response comes too late, forward must time out */
+    forward_ret_cb_args.ret = HG_SUCCESS;
+    hg_time_get_current(&t1);
+    hg_ret = HG_Forward_timed(handle, hg_test_rpc_forward_ret_cb,
+        &forward_ret_cb_args, NULL, HG_TEST_RPC_DELAY / 10);
+    if (hg_ret != HG_SUCCESS) {
+        HG_TEST_LOG_ERROR("Could not forward call");
+        goto done;
+    }
+    hg_request_wait(request, HG_MAX_IDLE_TIME, NULL);
+    hg_time_get_current(&t2);
+    elapsed = hg_time_to_double(hg_time_subtract(t2, t1)) * 1000.0;
+    if (forward_ret_cb_args.ret != HG_TIMEOUT) {
+        HG_TEST_LOG_ERROR("Forward did not time out (%s)",
+            HG_Error_to_string(forward_ret_cb_args.ret));
+        hg_ret = HG_PROTOCOL_ERROR;
+        goto done;
+    }
+    if (elapsed >= HG_TEST_RPC_DELAY) {
+        HG_TEST_LOG_ERROR("Forward timed out after %f ms", elapsed);
+        hg_ret = HG_PROTOCOL_ERROR;
+        goto done;
+    }
+
+    /* Response comes before deadline */
+    hg_request_reset(request);
+    forward_ret_cb_args.ret = HG_TIMEOUT;
+    hg_ret = HG_Forward_timed(handle, hg_test_rpc_forward_ret_cb,
+        &forward_ret_cb_args, NULL, HG_TEST_RPC_DELAY * 10);
+    if (hg_ret != HG_SUCCESS) {
+        HG_TEST_LOG_ERROR("Could not forward call");
+        goto done;
+    }
+    hg_request_wait(request, HG_MAX_IDLE_TIME, NULL);
+    if (forward_ret_cb_args.ret != HG_SUCCESS) {
+        HG_TEST_LOG_ERROR("Forward did not complete (%s)",
+            HG_Error_to_string(forward_ret_cb_args.ret));
+        hg_ret = HG_PROTOCOL_ERROR;
+        goto done;
+    }
+
+done:
+    if (handle != HG_HANDLE_NULL)
+        HG_Destroy(handle);
+    hg_request_destroy(request);
+    return hg_ret;
+}
+
+/*---------------------------------------------------------------------------*/
+static hg_return_t
+hg_test_rpc_coalesced(hg_context_t *context, hg_request_class_t *request_class,
+    hg_addr_t addr, hg_id_t rpc_id)
+{
+    hg_request_t *request_m[NINFLIGHT];
+    hg_handle_t handle_m[NINFLIGHT];
+    struct forward_ret_cb_args forward_ret_cb_args_m[NINFLIGHT];
+    rpc_open_in_t rpc_open_in_struct;
+    rpc_open_out_t rpc_open_out_struct;
+    hg_const_string_t rpc_open_path = MERCURY_TESTING_TEMP_DIRECTORY "/test.h5";
+#ifdef HG_HAS_COLLECT_STATS
+    struct hg_progress_stats stats;
+#endif
+    hg_return_t hg_ret = HG_SUCCESS;
+    unsigned int i, n = 0;
+
+    hg_ret = HG_Context_set_coalescing(context, HG_TRUE, 10);
+    if (hg_ret != HG_SUCCESS) {
+        HG_TEST_LOG_ERROR("Could not enable coalescing");
+        goto done;
+    }
+#ifdef HG_HAS_COLLECT_STATS
+    hg_ret = HG_Progress_stats_reset(context);
+    if (hg_ret != HG_SUCCESS) {
+        HG_TEST_LOG_ERROR("Could not reset progress stats");
+        goto done;
+    }
+#endif
+
+    /* Forwards issued between two progress calls share messages */
+    for (n = 0; n < NINFLIGHT; n++) {
+        request_m[n] = hg_request_create(request_class);
+        hg_ret = HG_Create(context, addr, rpc_id, &handle_m[n]);
+        if (hg_ret != HG_SUCCESS) {
+            HG_TEST_LOG_ERROR("Could not create handle");
+            hg_request_destroy(request_m[n]);
+            goto done;
+        }
+        rpc_open_in_struct.path = rpc_open_path;
+        rpc_open_in_struct.handle.cookie = n;
+        forward_ret_cb_args_m[n].request = request_m[n];
+        forward_ret_cb_args_m[n].ret = HG_OTHER_ERROR;
+        hg_ret = HG_Forward(handle_m[n], hg_test_rpc_forward_ret_cb,
+            &forward_ret_cb_args_m[n], &rpc_open_in_struct);
+        if (hg_ret != HG_SUCCESS) {
+            HG_TEST_LOG_ERROR("Could not forward call");
+            HG_Destroy(handle_m[n]);
+            hg_request_destroy(request_m[n]);
+            goto done;
+        }
+
+        /* First forward is taken out of its batch before it is sent */
+        if (n == 0) {
+            hg_ret = HG_Cancel(handle_m[n]);
+            if (hg_ret != HG_SUCCESS) {
+                HG_TEST_LOG_ERROR("Could not cancel forward");
+                n++;
+                goto done;
+            }
+        }
+    }
+
+    hg_request_wait(request_m[0], HG_MAX_IDLE_TIME, NULL);
+    if (forward_ret_cb_args_m[0].ret != HG_CANCELED) {
+        HG_TEST_LOG_ERROR("Canceled forward completed with %s",
+            HG_Error_to_string(forward_ret_cb_args_m[0].ret));
+        hg_ret = HG_PROTOCOL_ERROR;
+        goto done;
+    }
+
+    /* Each forward must get its own response */
+    for (i = 1; i < NINFLIGHT; i++) {
+        hg_request_wait(request_m[i], HG_MAX_IDLE_TIME, NULL);
+        if (forward_ret_cb_args_m[i].ret != HG_SUCCESS) {
+            HG_TEST_LOG_ERROR("Forward did not complete (%s)",
+                HG_Error_to_string(forward_ret_cb_args_m[i].ret));
+            hg_ret = HG_PROTOCOL_ERROR;
+            goto done;
+        }
+        hg_ret = HG_Get_output(handle_m[i], &rpc_open_out_struct);
+        if (hg_ret != HG_SUCCESS) {
+            HG_TEST_LOG_ERROR("Could not get output");
+            goto done;
+        }
+        if (rpc_open_out_struct.event_id != (int) i) {
+            HG_TEST_LOG_ERROR("Cookie did not match RPC response");
+            hg_ret = HG_PROTOCOL_ERROR;
+        }
+        HG_Free_output(handle_m[i], &rpc_open_out_struct);
+        if (hg_ret != HG_SUCCESS)
+            goto done;
+    }
+
+#ifdef HG_HAS_COLLECT_STATS
+    /* Forwards must have shared messages, canceled one is not sent */
+    hg_ret = HG_Progress_stats_get(context, &stats);
+    if (hg_ret != HG_SUCCESS) {
+        HG_TEST_LOG_ERROR("Could not get progress stats");
+        goto done;
+    }
+    if (stats.batch_rpc_count != NINFLIGHT - 1
+        || stats.batch_count >= stats.batch_rpc_count) {
+        HG_TEST_LOG_ERROR("Forwards were not coalesced (%lu forwards in %lu "
+            "messages)", (unsigned long) stats.batch_rpc_count,
+            (unsigned long) stats.batch_count);
+        hg_ret = HG_PROTOCOL_ERROR;
+        goto done;
+    }
+#endif
+
+done:
+    HG_Context_set_coalescing(context, HG_FALSE, 0);
+    for (i = 0; i < n; i++) {
+        if (hg_ret != HG_SUCCESS)
+            hg_request_wait(request_m[i], HG_MAX_IDLE_TIME, NULL);
+        HG_Destroy(handle_m[i]);
+        hg_request_destroy(request_m[i]);
+    }
+    return hg_ret;
+}
+
+/*---------------------------------------------------------------------------*/
+static hg_return_t
+hg_test_rpc_multi(hg_context_t *context, hg_request_class_t *request_class,
+    hg_addr_t addr, hg_id_t rpc_id, unsigned int fanout)
+{
+    hg_request_t *request = NULL;
+    hg_handle_t handle = HG_HANDLE_NULL;
+    hg_addr_t addrs[NINFLIGHT];
+    struct forward_ret_cb_args forward_ret_cb_args;
+    rpc_open_in_t rpc_open_in_struct;
+    hg_const_string_t rpc_open_path = MERCURY_TESTING_TEMP_DIRECTORY "/test.h5";
+    hg_return_t hg_ret = HG_SUCCESS;
+    unsigned int i;
+
+    request = hg_request_create(request_class);
+    forward_ret_cb_args.request = request;
+    forward_ret_cb_args.ret = HG_OTHER_ERROR;
+
+    hg_ret = HG_Create(context, addr, rpc_id, &handle);
+    if (hg_ret != HG_SUCCESS) {
+        HG_TEST_LOG_ERROR("Could not create handle");
+        goto done;
+    }
+
+    /* Same target several times */
+    for (i = 0; i < NINFLIGHT; i++)
+        addrs[i] = addr;
+
+    rpc_open_in_struct.path = rpc_open_path;
+    rpc_open_in_struct.handle.cookie = 100;
+    hg_ret = HG_Forward_multi(handle, hg_test_rpc_forward_ret_cb,
+        &forward_ret_cb_args, &rpc_open_in_struct, addrs, NINFLIGHT, fanout);
+    if (hg_ret != HG_SUCCESS) {
+        HG_TEST_LOG_ERROR("Could not forward call");
+        goto done;
+    }
+
+    /* Single callback once all targets responded */
+    hg_request_wait(request, HG_MAX_IDLE_TIME, NULL);
+    if (forward_ret_cb_args.ret != HG_SUCCESS) {
+        HG_TEST_LOG_ERROR("Multi forward did not complete (%s)",
+            HG_Error_to_string(forward_ret_cb_args.ret));
+        hg_ret = HG_PROTOCOL_ERROR;
+        goto done;
+    }
+
+done:
+    if (handle != HG_HANDLE_NULL)
+        HG_Destroy(handle);
+    hg_request_destroy(request);
+    return hg_ret;
+}
+
+/*---------------------------------------------------------------------------*/
+static hg_return_t
+hg_test_rpc_prepared(hg_context_t *context, hg_request_class_t *request_class,
+    hg_addr_t addr, hg_id_t rpc_id)
+{
+    hg_request_t *request = NULL;
+    hg_handle_t handle = HG_HANDLE_NULL;
+    struct forward_ret_cb_args forward_ret_cb_args;
+    rpc_open_in_t rpc_open_in_struct;
+    rpc_open_out_t rpc_open_out_struct;
+    hg_const_string_t rpc_open_path = MERCURY_TESTING_TEMP_DIRECTORY "/test.h5";
+#ifdef HG_HAS_COLLECT_STATS
+    struct hg_progress_stats stats;
+#endif
+    hg_return_t hg_ret = HG_SUCCESS;
+    unsigned int i;
+
+    hg_ret = HG_Create(context, addr, rpc_id, &handle);
+    if (hg_ret != HG_SUCCESS) {
+        HG_TEST_LOG_ERROR("Could not create handle");
+        goto done;
+    }
+#ifdef HG_HAS_COLLECT_STATS
+    hg_ret = HG_Progress_stats_reset(context);
+    if (hg_ret != HG_SUCCESS) {
+        HG_TEST_LOG_ERROR("Could not reset progress stats");
+        goto done;
+    }
+#endif
+
+    /* Same handle is forwarded again, first forward is not prepared and
+     * header must survive a reset */
+    for (i = 0; i < NINFLIGHT; i++) {
+        if (i == 1) {
+            hg_ret = HG_Prepare(handle);
+            if (hg_ret != HG_SUCCESS) {
+                HG_TEST_LOG_ERROR("Could not prepare handle");
+                goto done;
+            }
+        }
+        if (i == NINFLIGHT / 2) {
+            hg_ret = HG_Reset(handle, addr, rpc_id);
+            if (hg_ret != HG_SUCCESS) {
+                HG_TEST_LOG_ERROR("Could not reset handle");
+                goto done;
+            }
+        }
+
+        request = hg_request_create(request_class);
+        rpc_open_in_struct.path = rpc_open_path;
+        rpc_open_in_struct.handle.cookie = i;
+        forward_ret_cb_args.request = request;
+        forward_ret_cb_args.ret = HG_OTHER_ERROR;
+        hg_ret = HG_Forward(handle, hg_test_rpc_forward_ret_cb,
+            &forward_ret_cb_args, &rpc_open_in_struct);
+        if (hg_ret != HG_SUCCESS) {
+            HG_TEST_LOG_ERROR("Could not forward call");
+            goto done;
+        }
+        hg_request_wait(request, HG_MAX_IDLE_TIME, NULL);
+        hg_request_destroy(request);
+        request = NULL;
+
+        if (forward_ret_cb_args.ret != HG_SUCCESS) {
+            HG_TEST_LOG_ERROR("Forward did not complete (%s)",
+                HG_Error_to_string(forward_ret_cb_args.ret));
+            hg_ret = HG_PROTOCOL_ERROR;
+            goto done;
+        }
+        hg_ret = HG_Get_output(handle, &rpc_open_out_struct);
+        if (hg_ret != HG_SUCCESS) {
+            HG_TEST_LOG_ERROR("Could not get output");
+            goto done;
+        }
+        if (rpc_open_out_struct.event_id != (int) i) {
+            HG_TEST_LOG_ERROR("Cookie did not match RPC response");
+            hg_ret = HG_PROTOCOL_ERROR;
+        }
+        HG_Free_output(handle, &rpc_open_out_struct);
+        if (hg_ret != HG_SUCCESS)
+            goto done;
+    }
+
+#ifdef HG_HAS_COLLECT_STATS
+    /* Header is encoded by the unprepared forward and by the first prepared
+     * one, all other forwards must have kept it */
+    hg_ret = HG_Progress_stats_get(context, &stats);
+    if (hg_ret != HG_SUCCESS) {
+        HG_TEST_LOG_ERROR("Could not get progress stats");
+        goto done;
+    }
+    if (stats.header_reuse_count != NINFLIGHT - 2) {
+        HG_TEST_LOG_ERROR("Prepared header was not kept (%lu of %u forwards)",
+            (unsigned long) stats.header_reuse_count, NINFLIGHT - 2);
+        hg_ret = HG_PROTOCOL_ERROR;
+        goto done;
+    }
+#endif
+
+done:
+    if (handle != HG_HANDLE_NULL)
+        HG_Destroy(handle);
+    if (request)
+        hg_request_destroy(request);
+    return hg_ret;
+}
+
+/*---------------------------------------------------------------------------*/
+#ifdef HG_HAS_COLLECT_STATS
+static hg_return_t
+hg_test_rpc_stats(hg_class_t *hg_class, hg_context_t *context,
+    hg_request_class_t *request_class, hg_addr_t addr, hg_id_t rpc_id,
+    hg_cb_t callback)
+{
+    struct hg_stats stats;
+    hg_return_t hg_ret;
+
+    hg_ret = HG_Stats_reset(hg_class, context, rpc_id);
+    if (hg_ret != HG_SUCCESS) {
+        HG_TEST_LOG_ERROR("Could not reset stats");
+        goto done;
+    }
+
+    hg_ret = hg_test_rpc(context, request_class, addr, rpc_id, callback);
+    if (hg_ret != HG_SUCCESS)
+        goto done;
+
+    /* Origin must have recorded one forward and its latency */
+    hg_ret = HG_Stats_get(hg_class, context, rpc_id, &stats);
+    if (hg_ret != HG_SUCCESS) {
+        HG_TEST_LOG_ERROR("Could not get stats");
+        goto done;
+    }
+    if (stats.forward_count != 1 || stats.forward_error_count != 0
+        || stats.forward_time.count != 1
+        || HG_Stats_percentile(&stats.forward_time, 50.0)
+            != stats.forward_time.max) {
+        HG_TEST_LOG_ERROR("Unexpected stats (forward count %lu)",
+            (unsigned long) stats.forward_count);
+        hg_ret = HG_PROTOCOL_ERROR;
+        goto done;
+    }
+
+    /* A zero ID is a regular ID, it must not match other RPCs */
+    hg_ret = HG_Stats_get(hg_class, context, 0, &stats);
+    if (hg_ret != HG_SUCCESS) {
+        HG_TEST_LOG_ERROR("Could not get stats");
+        goto done;
+    }
+    if (stats.forward_count) {
+        HG_TEST_LOG_ERROR("Stats of RPC ID 0 include other RPCs");
+        hg_ret = HG_PROTOCOL_ERROR;
+        goto done;
+    }
+
+    hg_ret = HG_Stats_reset(hg_class, NULL, HG_STATS_ANY);
+    if (hg_ret != HG_SUCCESS) {
+        HG_TEST_LOG_ERROR("Could not reset stats");
+        goto done;
+    }
+    hg_ret = HG_Stats_get(hg_class, NULL, HG_STATS_ANY, &stats);
+    if (hg_ret != HG_SUCCESS) {
+        HG_TEST_LOG_ERROR("Could not get stats");
+        goto done;
+    }
+    if (stats.forward_count || stats.forward_time.count) {
+        HG_TEST_LOG_ERROR("Stats were not reset");
+        hg_ret = HG_PROTOCOL_ERROR;
+        goto done;
+    }
+
+done:
+    return hg_ret;
+}
+
+/*---------------------------------------------------------------------------*/
+static hg_return_t
+hg_test_progress_stats(hg_context_t *context,
+    hg_request_class_t *request_class, hg_addr_t addr, hg_id_t rpc_id,
+    hg_cb_t callback)
+{
+    struct hg_progress_stats stats;
+    hg_return_t hg_ret;
+
+    hg_ret = HG_Progress_stats_reset(context);
+    if (hg_ret != HG_SUCCESS) {
+        HG_TEST_LOG_ERROR("Could not reset progress stats");
+        goto done;
+    }
+
+    hg_ret = hg_test_rpc(context, request_class, addr, rpc_id, callback);
+    if (hg_ret != HG_SUCCESS)
+        goto done;
+
+    /* Origin must have progressed and triggered the forward callback */
+    hg_ret = HG_Progress_stats_get(context, &stats);
+    if (hg_ret != HG_SUCCESS) {
+        HG_TEST_LOG_ERROR("Could not get progress stats");
+        goto done;
+    }
+    if (!stats.progress_count || !stats.trigger_count
+        || !stats.na_trigger_count || stats.empty_count > stats.progress_count
+        || stats.empty_time > stats.progress_time) {
+        HG_TEST_LOG_ERROR("Unexpected progress stats (progress count %lu, "
+            "trigger count %lu)", (unsigned long) stats.progress_count,
+            (unsigned long) stats.trigger_count);
+        hg_ret = HG_PROTOCOL_ERROR;
+        goto done;
+    }
+
+    hg_ret = HG_Progress_stats_reset(context);
+    if (hg_ret != HG_SUCCESS) {
+        HG_TEST_LOG_ERROR("Could not reset progress stats");
+        goto done;
+    }
+    hg_ret = HG_Progress_stats_get(context, &stats);
+    if (hg_ret != HG_SUCCESS) {
+        HG_TEST_LOG_ERROR("Could not get progress stats");
+        goto done;
+    }
+    if (stats.progress_count || stats.trigger_count || stats.na_trigger_count) {
+        HG_TEST_LOG_ERROR("Progress stats were not reset");
+        hg_ret = HG_PROTOCOL_ERROR;
+        goto done;
+    }
+
+done:
+    return hg_ret;
+}
+#endif
+
+/*---------------------------------------------------------------------------*/
+#ifdef HG_HAS_TRACE
+static hg_return_t
+hg_test_rpc_trace(hg_context_t *context, hg_request_class_t *request_class,
+    hg_addr_t addr, hg_id_t rpc_id, hg_cb_t callback)
+{
+    const char *trace_file = "hg_test_rpc_trace.bin";
+    char magic[8];
+    FILE *file;
+    hg_return_t hg_ret;
+
+    hg_ret = hg_test_rpc(context, request_class, addr, rpc_id, callback);
+    if (hg_ret != HG_SUCCESS)
+        goto done;
+
+    hg_ret = HG_Trace_dump(trace_file);
+    if (hg_ret != HG_SUCCESS) {
+        HG_TEST_LOG_ERROR("Could not dump traces");
+        goto done;
+    }
+
+    file = fopen(trace_file, "rb");
+    if (!file) {
+        HG_TEST_LOG_ERROR("Could not open %s", trace_file);
+        hg_ret = HG_PROTOCOL_ERROR;
+        goto done;
+    }
+    if (fread(magic, sizeof(magic), 1, file) != 1
+        || memcmp(magic, "HGTRACE1", sizeof(magic))) {
+        HG_TEST_LOG_ERROR("Invalid trace dump");
+        hg_ret = HG_PROTOCOL_ERROR;
+    }
+    fclose(file);
+    remove(trace_file);
+
+done:
+    return hg_ret;
+}
+#endif
+
+/*---------------------------------------------------------------------------*/
+static hg_return_t
+hg_test_addr_lookup_cb(const struct hg_cb_info *callback_info)
+{
+    struct lookup_cb_args *args = (struct lookup_cb_args *) callback_info->arg;
+
+    args->ret = callback_info->ret;
+    args->addr = callback_info->info.lookup.addr;
+    hg_request_complete(args->request);
+
+    return HG_SUCCESS;
+}
+
+/*---------------------------------------------------------------------------*/
+static hg_return_t
+hg_test_addr_lookup_post(hg_context_t *context,
+    hg_request_class_t *request_class, const char *name,
+    struct lookup_cb_args *args)
+{
+    hg_return_t hg_ret;
+
+    args->request = hg_request_create(request_class);
+    args->addr = HG_ADDR_NULL;
+    args->ret = HG_SUCCESS;
+
+    hg_ret = HG_Addr_lookup(context, hg_test_addr_lookup_cb, args, name,
+        HG_OP_ID_IGNORE);
+    if (hg_ret != HG_SUCCESS) {
+        hg_request_destroy(args->request);
+        args->request = NULL;
+        args->ret = hg_ret;
+    }
+
+    return hg_ret;
+}
+
+/*---------------------------------------------------------------------------*/
+static hg_return_t
+hg_test_addr_lookup_wait(struct lookup_cb_args *args)
+{
+    unsigned int flag = 0;
+
+    if (!args->request)
+        return args->ret;
+
+    hg_request_wait(args->request, HG_MAX_IDLE_TIME, &flag);
+    hg_request_destroy(args->request);
+    args->request = NULL;
+
+    return flag ? args->ret : HG_TIMEOUT;
+}
+
+/*---------------------------------------------------------------------------*/
+static hg_return_t
+hg_test_addr_cache(hg_class_t *hg_class, hg_context_t *context,
+    hg_request_class_t *request_class, const char *target_name,
+    hg_addr_t target_addr)
+{
+    struct lookup_cb_args args1, args2;
+    const char *bogus_name = "na+sm://1/0";
+    hg_return_t hg_ret = HG_SUCCESS;
+
+    /* Target is self */
+    if (!target_name)
+        goto done;
+
+    /* Looking up the target again must return the cached address */
+    hg_test_addr_lookup_post(context, request_class, target_name, &args1);
+    hg_ret = hg_test_addr_lookup_wait(&args1);
+    if (hg_ret != HG_SUCCESS) {
+        HG_TEST_LOG_ERROR("Could not lookup %s", target_name);
+        goto done;
+    }
+    if (args1.addr != target_addr) {
+        HG_TEST_LOG_ERROR("Address was not returned from cache");
+        HG_Addr_free(hg_class, args1.addr);
+        hg_ret = HG_PROTOCOL_ERROR;
+        goto done;
+    }
+    HG_Addr_free(hg_class, args1.addr);
+
+    /* After invalidation, concurrent lookups resolve to one new address */
+    HG_Addr_cache_invalidate(hg_class, target_name);
+    hg_test_addr_lookup_post(context, request_class, target_name, &args1);
+    hg_test_addr_lookup_post(context, request_class, target_name, &args2);
+    hg_ret = hg_test_addr_lookup_wait(&args1);
+    if (hg_test_addr_lookup_wait(&args2) != HG_SUCCESS)
+        hg_ret = args2.ret;
+    if (hg_ret != HG_SUCCESS) {
+        HG_TEST_LOG_ERROR("Could not lookup %s", target_name);
+        goto free_addrs;
+    }
+    if (args1.addr == target_addr || args1.addr != args2.addr) {
+        HG_TEST_LOG_ERROR("Lookups were not coalesced after invalidation");
+        hg_ret = HG_PROTOCOL_ERROR;
+        goto free_addrs;
+    }
+free_addrs:
+    if (args1.addr != HG_ADDR_NULL)
+        HG_Addr_free(hg_class, args1.addr);
+    if (args2.addr != HG_ADDR_NULL)
+        HG_Addr_free(hg_class, args2.addr);
+    if (hg_ret != HG_SUCCESS)
+        goto done;
+
+    /* Lookups of names that do not exist are cached until invalidated, cache
+     * hits report the failure through the callback */
+    if (strcmp(HG_Class_get_protocol(hg_class), "sm") != 0)
+        goto done;
+    hg_test_addr_lookup_post(context, request_class, bogus_name, &args1);
+    if (hg_test_addr_lookup_post(context, request_class, bogus_name, &args2)
+        != HG_SUCCESS) {
+        HG_TEST_LOG_ERROR("Lookup of %s was not completed from cache",
+            bogus_name);
+        hg_test_addr_lookup_wait(&args1);
+        hg_ret = HG_PROTOCOL_ERROR;
+        goto done;
+    }
+    if (hg_test_addr_lookup_wait(&args1) == HG_SUCCESS
+        || hg_test_addr_lookup_wait(&args2) == HG_SUCCESS) {
+        HG_TEST_LOG_ERROR("Lookup of %s did not fail", bogus_name);
+        hg_ret = HG_PROTOCOL_ERROR;
+        goto done;
+    }
+    if (args1.ret != args2.ret) {
+        HG_TEST_LOG_ERROR("Cached lookup failure does not match");
+        hg_ret = HG_PROTOCOL_ERROR;
+        goto done;
+    }
+    HG_Addr_cache_invalidate(hg_class, NULL);
+    hg_test_addr_lookup_post(context, request_class, bogus_name, &args1);
+    if (hg_test_addr_lookup_wait(&args1) == HG_SUCCESS) {
+        HG_TEST_LOG_ERROR("Lookup of %s did not fail", bogus_name);
+        hg_ret = HG_PROTOCOL_ERROR;
+        goto done;
+    }
+
+done:
+    return hg_ret;
+}
+
+/*---------------------------------------------------------------------------*/
+static hg_return_t
+hg_test_addr_lookup_batch(hg_class_t *hg_class, hg_context_t *context,
+    hg_request_class_t *request_class, const char *target_name)
+{
+    const char *names[3];
+    hg_addr_t addrs[3] = { HG_ADDR_NULL, HG_ADDR_NULL, HG_ADDR_NULL };
+    struct lookup_cb_args args;
+    unsigned int count = 2, flag = 0, i;
+    hg_return_t hg_ret;
+
+    /* Target is self */
+    if (!target_name)
+        return HG_SUCCESS;
+
+    names[0] = target_name;
+    names[1] = target_name;
+    names[2] = "na+sm://1/0";
+    if (strcmp(HG_Class_get_protocol(hg_class), "sm") == 0)
+        count = 3;
+
+    args.request = hg_request_create(request_class);
+    args.addr = HG_ADDR_NULL;
+    args.ret = HG_SUCCESS;
+    hg_ret = HG_Addr_lookup_batch(context, hg_test_addr_lookup_cb, &args,
+        names, count, addrs);
+    if (hg_ret != HG_SUCCESS) {
+        HG_TEST_LOG_ERROR("Could not lookup addresses");
+        hg_request_destroy(args.request);
+        goto done;
+    }
+    hg_request_wait(args.request, HG_MAX_IDLE_TIME, &flag);
+    hg_request_destroy(args.request);
+    if (!flag) {
+        HG_TEST_LOG_ERROR("Batch lookup did not complete");
+        hg_ret = HG_TIMEOUT;
+        goto done;
+    }
+
+    /* Only the bogus name may fail */
+    if (addrs[0] == HG_ADDR_NULL || addrs[1] == HG_ADDR_NULL
+        || args.addr != HG_ADDR_NULL
+        || (count == 3 && (addrs[2] != HG_ADDR_NULL || args.ret == HG_SUCCESS))
+        || (count == 2 && args.ret != HG_SUCCESS)) {
+        HG_TEST_LOG_ERROR("Unexpected batch lookup result");
+        hg_ret = HG_PROTOCOL_ERROR;
+        goto done;
+    }
+
+    /* Make sure returned address is usable */
+    hg_ret = hg_test_rpc(context, request_class, addrs[1],
+        hg_test_rpc_open_id_g, hg_test_rpc_forward_cb);
+    if (hg_ret != HG_SUCCESS)
+        goto done;
+
+done:
+    for (i = 0; i < count; i++)
+        if (addrs[i] != HG_ADDR_NULL)
+            HG_Addr_free(hg_class, addrs[i]);
+    return hg_ret;
+}
+
+/*---------------------------------------------------------------------------*/
+static hg_return_t
+hg_test_rpc_queued(hg_class_t *hg_class, hg_context_t *context,
+    hg_request_class_t *request_class, const char *target_name)
+{
+    hg_request_t *request_m[NCREDITS + 2];
+    hg_handle_t handle_m[NCREDITS + 2];
+    struct forward_ret_cb_args forward_ret_cb_args_m[NCREDITS + 2];
+    struct lookup_cb_args lookup_args;
+    hg_time_t t1, t2;
+    double elapsed;
+    hg_return_t hg_ret = HG_SUCCESS;
+    unsigned int i, n = 0;
+
+    lookup_args.addr = HG_ADDR_NULL;
+
+    /* Target is self */
+    if (!target_name)
+        goto done;
+
+    /* New addr has not received any credits from target yet */
+    HG_Addr_cache_invalidate(hg_class, target_name);
+    hg_test_addr_lookup_post(context, request_class, target_name,
+        &lookup_args);
+    hg_ret = hg_test_addr_lookup_wait(&lookup_args);
+    if (hg_ret != HG_SUCCESS) {
+        HG_TEST_LOG_ERROR("Could not lookup %s", target_name);
+        goto done;
+    }
+
+    /* Use all credits, last two forwards must wait for them */
+    for (n = 0; n < NCREDITS + 2; n++) {
+        request_m[n] = hg_request_create(request_class);
+        hg_ret = HG_Create(context, lookup_args.addr, hg_test_rpc_delay_id_g,
+            &handle_m[n]);
+        if (hg_ret != HG_SUCCESS) {
+            HG_TEST_LOG_ERROR("Could not create handle");
+            hg_request_destroy(request_m[n]);
+            goto done;
+        }
+        forward_ret_cb_args_m[n].request = request_m[n];
+        forward_ret_cb_args_m[n].ret = HG_OTHER_ERROR;
+        if (n == NCREDITS + 1) {
+            hg_time_get_current(&t1);
+            hg_ret = HG_Forward_timed(handle_m[n], hg_test_rpc_forward_ret_cb,
+                &forward_ret_cb_args_m[n], NULL, HG_TEST_RPC_DELAY / 10);
+        } else
+            hg_ret = HG_Forward(handle_m[n], hg_test_rpc_forward_ret_cb,
+                &forward_ret_cb_args_m[n], NULL);
+        if (hg_ret != HG_SUCCESS) {
+            HG_TEST_LOG_ERROR("Could not forward call");
+            HG_Destroy(handle_m[n]);
+            hg_request_destroy(request_m[n]);
+            goto done;
+        }
+    }
+
+    /* Queued forward completes as canceled forward */
+    hg_ret = HG_Cancel(handle_m[NCREDITS]);
+    if (hg_ret != HG_SUCCESS) {
+        HG_TEST_LOG_ERROR("Could not cancel call");
+        goto done;
+    }
+    hg_request_wait(request_m[NCREDITS], HG_MAX_IDLE_TIME, NULL);
+    if (forward_ret_cb_args_m[NCREDITS].ret != HG_CANCELED) {
+        HG_TEST_LOG_ERROR("Queued forward was not canceled (%s)",
+            HG_Error_to_string(forward_ret_cb_args_m[NCREDITS].ret));
+        hg_ret = HG_PROTOCOL_ERROR;
+        goto done;
+    }
+
+    /* Queued forward times out before any credit comes back */
+    hg_request_wait(request_m[NCREDITS + 1], HG_MAX_IDLE_TIME, NULL);
+    hg_time_get_current(&t2);
+    elapsed = hg_time_to_double(hg_time_subtract(t2, t1)) * 1000.0;
+    if (forward_ret_cb_args_m[NCREDITS + 1].ret != HG_TIMEOUT) {
+        HG_TEST_LOG_ERROR("Queued forward did not time out (%s)",
+            HG_Error_to_string(forward_ret_cb_args_m[NCREDITS + 1].ret));
+        hg_ret = HG_PROTOCOL_ERROR;
+        goto done;
+    }
+    if (elapsed >= HG_TEST_RPC_DELAY) {
+        HG_TEST_LOG_ERROR("Queued forward timed out after %f ms", elapsed);
+        hg_ret = HG_PROTOCOL_ERROR;
+        goto done;
+    }
+
+    /* Forwards that held credits are not affected */
+    for (i = 0; i < NCREDITS; i++) {
+        hg_request_wait(request_m[i], HG_MAX_IDLE_TIME, NULL);
+        if (forward_ret_cb_args_m[i].ret != HG_SUCCESS) {
+            HG_TEST_LOG_ERROR("Forward did not complete (%s)",
+                HG_Error_to_string(forward_ret_cb_args_m[i].ret));
+            hg_ret = HG_PROTOCOL_ERROR;
+            goto done;
+        }
+    }
+
+done:
+    for (i = 0; i < n; i++) {
+        if (hg_ret != HG_SUCCESS)
+            hg_request_wait(request_m[i], HG_MAX_IDLE_TIME, NULL);
+        HG_Destroy(handle_m[i]);
+        hg_request_destroy(request_m[i]);
+    }
+    if (lookup_args.addr != HG_ADDR_NULL)
+        HG_Addr_free(hg_class, lookup_args.addr);
+    return hg_ret;
+}
+
 /*---------------------------------------------------------------------------*/
 int
 main(int argc, char *argv[])
@@ -502,6 +1480,17 @@ main(int argc, char *argv[])
     }
     HG_PASSED();
 
+    /* RPC test with scatter-gather payload */
+    HG_TEST("scatter-gather RPC");
+    hg_ret = hg_test_rpc_iov(hg_test_info.context, hg_test_info.request_class,
+        hg_test_info.target_addr, hg_test_rpc_iov_id_g,
+        hg_test_rpc_forward_iov_cb);
+    if (hg_ret != HG_SUCCESS) {
+        ret = EXIT_FAILURE;
+        goto done;
+    }
+    HG_PASSED();
+
     /* RPC test with multiple handle in flight */
     HG_TEST("concurrent RPCs");
     hg_ret = hg_test_rpc_multiple(hg_test_info.context,
@@ -513,6 +1502,131 @@ main(int argc, char *argv[])
     }
     HG_PASSED();
 
+    /* RPC test with deadline */
+    HG_TEST("timed RPC");
+    hg_ret = hg_test_rpc_timed(hg_test_info.context,
+        hg_test_info.request_class, hg_test_info.target_addr);
+    if (hg_ret != HG_SUCCESS) {
+        ret = EXIT_FAILURE;
+        goto done;
+    }
+    HG_PASSED();
+
+    /* RPC test with coalesced forwards */
+    HG_TEST("coalesced RPCs");
+    hg_ret = hg_test_rpc_coalesced(hg_test_info.context,
+        hg_test_info.request_class, hg_test_info.target_addr,
+        hg_test_rpc_open_id_g);
+    if (hg_ret != HG_SUCCESS) {
+        ret = EXIT_FAILURE;
+        goto done;
+    }
+    HG_PASSED();
+
+    /* RPC test with same input forwarded to several targets */
+    HG_TEST("multi RPC");
+    hg_ret = hg_test_rpc_multi(hg_test_info.context,
+        hg_test_info.request_class, hg_test_info.target_addr,
+        hg_test_rpc_open_id_g, 0);
+    if (hg_ret != HG_SUCCESS) {
+        ret = EXIT_FAILURE;
+        goto done;
+    }
+    HG_PASSED();
+
+    /* RPC test with targets forwarding again to each other */
+    HG_TEST("multi RPC (tree)");
+    hg_ret = hg_test_rpc_multi(hg_test_info.context,
+        hg_test_info.request_class, hg_test_info.target_addr,
+        hg_test_rpc_open_id_g, 2);
+    if (hg_ret != HG_SUCCESS) {
+        ret = EXIT_FAILURE;
+        goto done;
+    }
+    HG_PASSED();
+
+    /* RPC test with same handle forwarded repeatedly */
+    HG_TEST("prepared RPC");
+    hg_ret = hg_test_rpc_prepared(hg_test_info.context,
+        hg_test_info.request_class, hg_test_info.target_addr,
+        hg_test_rpc_open_id_g);
+    if (hg_ret != HG_SUCCESS) {
+        ret = EXIT_FAILURE;
+        goto done;
+    }
+    HG_PASSED();
+
+    /* Address cache test */
+    if (hg_test_info.addr_cache) {
+        HG_TEST("address cache");
+        hg_ret = hg_test_addr_cache(hg_test_info.hg_class,
+            hg_test_info.context, hg_test_info.request_class,
+            hg_test_info.na_test_info.target_name, hg_test_info.target_addr);
+        if (hg_ret != HG_SUCCESS) {
+            ret = EXIT_FAILURE;
+            goto done;
+        }
+        HG_PASSED();
+    }
+
+    /* Forwards waiting for credits */
+    HG_TEST("queued RPCs");
+    hg_ret = hg_test_rpc_queued(hg_test_info.hg_class, hg_test_info.context,
+        hg_test_info.request_class, hg_test_info.na_test_info.target_name);
+    if (hg_ret != HG_SUCCESS) {
+        ret = EXIT_FAILURE;
+        goto done;
+    }
+    HG_PASSED();
+
+    /* Batch address lookup test */
+    HG_TEST("batch address lookup");
+    hg_ret = hg_test_addr_lookup_batch(hg_test_info.hg_class,
+        hg_test_info.context, hg_test_info.request_class,
+        hg_test_info.na_test_info.target_name);
+    if (hg_ret != HG_SUCCESS) {
+        ret = EXIT_FAILURE;
+        goto done;
+    }
+    HG_PASSED();
+
+#ifdef HG_HAS_COLLECT_STATS
+    /* RPC stats test */
+    HG_TEST("RPC stats");
+    hg_ret = hg_test_rpc_stats(hg_test_info.hg_class, hg_test_info.context,
+        hg_test_info.request_class, hg_test_info.target_addr,
+        hg_test_rpc_open_id_g, hg_test_rpc_forward_cb);
+    if (hg_ret != HG_SUCCESS) {
+        ret = EXIT_FAILURE;
+        goto done;
+    }
+    HG_PASSED();
+
+    /* Progress stats test */
+    HG_TEST("progress stats");
+    hg_ret = hg_test_progress_stats(hg_test_info.context,
+        hg_test_info.request_class, hg_test_info.target_addr,
+        hg_test_rpc_open_id_g, hg_test_rpc_forward_cb);
+    if (hg_ret != HG_SUCCESS) {
+        ret = EXIT_FAILURE;
+        goto done;
+    }
+    HG_PASSED();
+#endif
+
+#ifdef HG_HAS_TRACE
+    /* RPC trace test */
+    HG_TEST("RPC trace");
+    hg_ret = hg_test_rpc_trace(hg_test_info.context,
+        hg_test_info.request_class, hg_test_info.target_addr,
+        hg_test_rpc_open_id_g, hg_test_rpc_forward_cb);
+    if (hg_ret != HG_SUCCESS) {
+        ret = EXIT_FAILURE;
+        goto done;
+    }
+    HG_PASSED();
+#endif
+
 done:
     if (ret != EXIT_SUCCESS)
         HG_FAILED();
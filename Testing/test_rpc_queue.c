@@ -0,0 +1,235 @@
+/*
+ * Copyright (C) 2013-2017 Argonne National Laboratory, Department of Energy,
+ *                    UChicago Argonne, LLC and The HDF Group.
+ * All rights reserved.
+ *
+ * The full copyright notice, including terms governing use, modification,
+ * and redistribution, is contained in the COPYING file that can be
+ * found at the root of the source code distribution tree.
+ */
+
+#include "mercury.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#define NORMAL_COUNT 4  /* Normal RPCs forwarded */
+#define QUEUE_LIMIT 2   /* Normal RPCs that may wait */
+#define RPC_COUNT (NORMAL_COUNT + 1)
+
+struct forward_cb_args {
+    hg_return_t ret;
+    hg_bool_t done;
+};
+
+struct lookup_cb_args {
+    hg_addr_t addr;
+    hg_bool_t done;
+};
+
+static hg_id_t normal_id_g = 0;
+static hg_id_t high_id_g = 0;
+static hg_id_t run_order_g[RPC_COUNT];
+static unsigned int run_count_g = 0;
+
+/*---------------------------------------------------------------------------*/
+static hg_return_t
+rpc_cb(hg_handle_t handle)
+{
+    const struct hg_info *hg_info = HG_Get_info(handle);
+    hg_return_t ret;
+
+    if (run_count_g < RPC_COUNT)
+        run_order_g[run_count_g] = hg_info->id;
+    run_count_g++;
+
+    ret = HG_Respond(handle, NULL, NULL, NULL);
+    HG_Destroy(handle);
+
+    return ret;
+}
+
+/*---------------------------------------------------------------------------*/
+static hg_return_t
+forward_cb(const struct hg_cb_info *callback_info)
+{
+    struct forward_cb_args *args =
+        (struct forward_cb_args *) callback_info->arg;
+
+    args->ret = callback_info->ret;
+    args->done = HG_TRUE;
+
+    return HG_SUCCESS;
+}
+
+/*---------------------------------------------------------------------------*/
+static hg_return_t
+lookup_cb(const struct hg_cb_info *callback_info)
+{
+    struct lookup_cb_args *args = (struct lookup_cb_args *) callback_info->arg;
+
+    args->addr = callback_info->info.lookup.addr;
+    args->done = HG_TRUE;
+
+    return HG_SUCCESS;
+}
+
+/*---------------------------------------------------------------------------*/
+static void
+progress(hg_context_t *context)
+{
+    unsigned int actual_count;
+
+    HG_Progress(context, 10);
+    do {
+        actual_count = 0;
+        HG_Trigger(context, 0, 1, &actual_count);
+    } while (actual_count);
+}
+
+/*---------------------------------------------------------------------------*/
+int
+main(int argc, char *argv[])
+{
+    hg_class_t *hg_class = NULL, *origin_class = NULL;
+    hg_context_t *context = NULL, *origin_context = NULL;
+    hg_addr_t self_addr = HG_ADDR_NULL;
+    char addr_string[256];
+    hg_size_t addr_string_size = sizeof(addr_string);
+    struct lookup_cb_args lookup_args = { HG_ADDR_NULL, HG_FALSE };
+    hg_handle_t handles[RPC_COUNT] = { HG_HANDLE_NULL };
+    struct forward_cb_args args[RPC_COUNT];
+    unsigned int i, busy_count = 0, done_count = 0, loop;
+    int ret = EXIT_SUCCESS;
+
+    (void) argc;
+    (void) argv;
+
+    /* Origin and target live in one process, so that nothing is triggered
+     * on target before all the RPCs were received */
+    hg_class = HG_Init("na+sm", HG_TRUE);
+    origin_class = HG_Init("na+sm", HG_FALSE);
+    if (!hg_class || !origin_class) {
+        fprintf(stderr, "Error: could not initialize HG classes\n");
+        ret = EXIT_FAILURE;
+        goto done;
+    }
+    context = HG_Context_create(hg_class);
+    origin_context = HG_Context_create(origin_class);
+    if (!context || !origin_context) {
+        fprintf(stderr, "Error: could not create HG contexts\n");
+        ret = EXIT_FAILURE;
+        goto done;
+    }
+    normal_id_g = HG_Register_name(hg_class, "queue_normal", NULL, NULL,
+        rpc_cb);
+    high_id_g = HG_Register_name(hg_class, "queue_high", NULL, NULL, rpc_cb);
+    HG_Register_name(origin_class, "queue_normal", NULL, NULL, NULL);
+    HG_Register_name(origin_class, "queue_high", NULL, NULL, NULL);
+    if (HG_Registered_handler_hints(hg_class, high_id_g, HG_HANDLER_HIGH,
+        HG_HANDLER_ANY_THREAD) != HG_SUCCESS
+        || HG_Context_set_queue_limit(context, HG_HANDLER_NORMAL, QUEUE_LIMIT)
+        != HG_SUCCESS) {
+        fprintf(stderr, "Error: could not set handler hints\n");
+        ret = EXIT_FAILURE;
+        goto done;
+    }
+    if (HG_Addr_self(hg_class, &self_addr) != HG_SUCCESS
+        || HG_Addr_to_string(hg_class, addr_string, &addr_string_size,
+            self_addr) != HG_SUCCESS
+        || HG_Addr_lookup(origin_context, lookup_cb, &lookup_args,
+            addr_string, HG_OP_ID_IGNORE) != HG_SUCCESS) {
+        fprintf(stderr, "Error: could not look up target addr\n");
+        ret = EXIT_FAILURE;
+        goto done;
+    }
+    for (loop = 0; loop < 1000 && !lookup_args.done; loop++) {
+        progress(origin_context);
+        HG_Progress(context, 0);
+    }
+    if (lookup_args.addr == HG_ADDR_NULL) {
+        fprintf(stderr, "Error: could not look up %s\n", addr_string);
+        ret = EXIT_FAILURE;
+        goto done;
+    }
+
+    /* High priority RPC is forwarded last */
+    for (i = 0; i < RPC_COUNT; i++) {
+        args[i].ret = HG_OTHER_ERROR;
+        args[i].done = HG_FALSE;
+        if (HG_Create(origin_context, lookup_args.addr,
+            (i < NORMAL_COUNT) ? normal_id_g : high_id_g, &handles[i])
+            != HG_SUCCESS
+            || HG_Forward(handles[i], forward_cb, &args[i], NULL)
+            != HG_SUCCESS) {
+            fprintf(stderr, "Error: could not forward RPC %u\n", i);
+            ret = EXIT_FAILURE;
+            goto done;
+        }
+    }
+
+    /* Receive everything before running anything */
+    for (loop = 0; loop < 20; loop++) {
+        HG_Progress(origin_context, 0);
+        HG_Progress(context, 10);
+    }
+
+    for (loop = 0; loop < 1000 && done_count < RPC_COUNT; loop++) {
+        progress(context);
+        progress(origin_context);
+        for (i = 0, done_count = 0; i < RPC_COUNT; i++)
+            done_count += args[i].done;
+    }
+    if (done_count < RPC_COUNT) {
+        fprintf(stderr, "Error: only %u of %u forwards completed\n",
+            done_count, RPC_COUNT);
+        ret = EXIT_FAILURE;
+        goto done;
+    }
+
+    /* Normal RPCs beyond the limit are answered busy without being run */
+    for (i = 0; i < RPC_COUNT; i++) {
+        if (args[i].ret == HG_BUSY)
+            busy_count++;
+        else if (args[i].ret != HG_SUCCESS) {
+            fprintf(stderr, "Error: RPC %u failed (%s)\n", i,
+                HG_Error_to_string(args[i].ret));
+            ret = EXIT_FAILURE;
+            goto done;
+        }
+    }
+    if (args[NORMAL_COUNT].ret != HG_SUCCESS
+        || busy_count != NORMAL_COUNT - QUEUE_LIMIT
+        || run_count_g != RPC_COUNT - busy_count) {
+        fprintf(stderr, "Error: %u RPCs shed, %u run (expected %u, %u)\n",
+            busy_count, run_count_g, NORMAL_COUNT - QUEUE_LIMIT,
+            QUEUE_LIMIT + 1);
+        ret = EXIT_FAILURE;
+        goto done;
+    }
+
+    /* High priority RPC overtakes the normal ones waiting */
+    if (run_order_g[0] != high_id_g) {
+        fprintf(stderr, "Error: high priority RPC was not run first\n");
+        ret = EXIT_FAILURE;
+        goto done;
+    }
+
+done:
+    for (i = 0; i < RPC_COUNT; i++)
+        if (handles[i] != HG_HANDLE_NULL)
+            HG_Destroy(handles[i]);
+    if (lookup_args.addr != HG_ADDR_NULL)
+        HG_Addr_free(origin_class, lookup_args.addr);
+    if (self_addr != HG_ADDR_NULL)
+        HG_Addr_free(hg_class, self_addr);
+    if (origin_context)
+        HG_Context_destroy(origin_context);
+    if (context)
+        HG_Context_destroy(context);
+    if (origin_class)
+        HG_Finalize(origin_class);
+    if (hg_class)
+        HG_Finalize(hg_class);
+    return ret;
+}
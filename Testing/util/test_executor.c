@@ -0,0 +1,184 @@
+#include "mercury_executor.h"
+#include "mercury_atomic.h"
+#include "mercury_thread.h"
+#include "mercury_time.h"
+
+#include "mercury_test_config.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#define MERCURY_TESTING_NUM_THREADS 4
+#define EXECUTOR_NUM_POSTS 1024
+#define EXECUTOR_NUM_PRIORITY_POSTS 8
+
+static hg_atomic_int32_t ncalls;
+static hg_atomic_int32_t release;
+static hg_atomic_int32_t order;
+static int high_order[EXECUTOR_NUM_PRIORITY_POSTS];
+static int normal_order[EXECUTOR_NUM_PRIORITY_POSTS];
+
+static HG_THREAD_RETURN_TYPE
+count_func(void *args)
+{
+    hg_thread_ret_t ret = 0;
+    (void) args;
+
+    hg_atomic_incr32(&ncalls);
+
+    return ret;
+}
+
+/* Blocks its worker until other work has completed or timeout is reached */
+static HG_THREAD_RETURN_TYPE
+block_func(void *args)
+{
+    hg_thread_ret_t ret = 0;
+    hg_time_t t1, t2;
+    (void) args;
+
+    hg_time_get_current(&t1);
+    do {
+        hg_thread_yield();
+        hg_time_get_current(&t2);
+    } while (!hg_atomic_get32(&release)
+        && hg_time_to_double(hg_time_subtract(t2, t1)) < 10.0);
+
+    return ret;
+}
+
+static HG_THREAD_RETURN_TYPE
+order_func(void *args)
+{
+    hg_thread_ret_t ret = 0;
+
+    *(int *) args = hg_atomic_incr32(&order);
+
+    return ret;
+}
+
+/* All posted work executes, whatever the affinity */
+static int
+test_all(void)
+{
+    hg_executor_t *executor;
+    static struct hg_thread_work work[EXECUTOR_NUM_POSTS];
+    int i, ret = EXIT_SUCCESS;
+
+    hg_atomic_init32(&ncalls, 0);
+    hg_executor_create(MERCURY_TESTING_NUM_THREADS, &executor);
+    for (i = 0; i < EXECUTOR_NUM_POSTS; i++) {
+        work[i].func = count_func;
+        work[i].args = NULL;
+        hg_executor_post(executor, &work[i],
+            (i % 2) ? HG_EXECUTOR_ANY : (unsigned int) i,
+            (i % 3) ? HG_EXECUTOR_NORMAL : HG_EXECUTOR_HIGH);
+    }
+    hg_executor_destroy(executor);
+
+    if (hg_atomic_get32(&ncalls) != EXECUTOR_NUM_POSTS) {
+        fprintf(stderr, "Did not execute all the operations posted (%d/%d)\n",
+            hg_atomic_get32(&ncalls), EXECUTOR_NUM_POSTS);
+        ret = EXIT_FAILURE;
+    }
+    return ret;
+}
+
+/* Work queued behind a blocked worker gets stolen by other workers */
+static int
+test_steal(void)
+{
+    hg_executor_t *executor;
+    struct hg_thread_work block_work;
+    static struct hg_thread_work work[EXECUTOR_NUM_POSTS];
+    hg_time_t t1, t2;
+    int i, ret = EXIT_SUCCESS;
+
+    hg_atomic_init32(&ncalls, 0);
+    hg_atomic_init32(&release, 0);
+    hg_executor_create(2, &executor);
+    block_work.func = block_func;
+    block_work.args = NULL;
+    hg_executor_post(executor, &block_work, 0, HG_EXECUTOR_NORMAL);
+    for (i = 0; i < EXECUTOR_NUM_POSTS; i++) {
+        work[i].func = count_func;
+        work[i].args = NULL;
+        hg_executor_post(executor, &work[i], 0, HG_EXECUTOR_NORMAL);
+    }
+
+    hg_time_get_current(&t1);
+    do {
+        hg_thread_yield();
+        hg_time_get_current(&t2);
+    } while (hg_atomic_get32(&ncalls) != EXECUTOR_NUM_POSTS
+        && hg_time_to_double(hg_time_subtract(t2, t1)) < 5.0);
+    if (hg_atomic_get32(&ncalls) != EXECUTOR_NUM_POSTS) {
+        fprintf(stderr, "Work was not stolen from blocked worker (%d/%d)\n",
+            hg_atomic_get32(&ncalls), EXECUTOR_NUM_POSTS);
+        ret = EXIT_FAILURE;
+    }
+    hg_atomic_set32(&release, 1);
+    hg_executor_destroy(executor);
+
+    return ret;
+}
+
+/* High priority work runs before normal priority work */
+static int
+test_priority(void)
+{
+    hg_executor_t *executor;
+    struct hg_thread_work block_work;
+    struct hg_thread_work high_work[EXECUTOR_NUM_PRIORITY_POSTS];
+    struct hg_thread_work normal_work[EXECUTOR_NUM_PRIORITY_POSTS];
+    int i, ret = EXIT_SUCCESS;
+
+    hg_atomic_init32(&release, 0);
+    hg_atomic_init32(&order, 0);
+    hg_executor_create(1, &executor);
+
+    /* Keep the only worker busy while work is queued */
+    block_work.func = block_func;
+    block_work.args = NULL;
+    hg_executor_post(executor, &block_work, 0, HG_EXECUTOR_NORMAL);
+    for (i = 0; i < EXECUTOR_NUM_PRIORITY_POSTS; i++) {
+        normal_work[i].func = order_func;
+        normal_work[i].args = &normal_order[i];
+        hg_executor_post(executor, &normal_work[i], HG_EXECUTOR_ANY,
+            HG_EXECUTOR_NORMAL);
+        high_work[i].func = order_func;
+        high_work[i].args = &high_order[i];
+        hg_executor_post(executor, &high_work[i], HG_EXECUTOR_ANY,
+            HG_EXECUTOR_HIGH);
+    }
+    hg_atomic_set32(&release, 1);
+    hg_executor_destroy(executor);
+
+    for (i = 0; i < EXECUTOR_NUM_PRIORITY_POSTS; i++) {
+        if (high_order[i] != i + 1
+            || normal_order[i] != EXECUTOR_NUM_PRIORITY_POSTS + i + 1) {
+            fprintf(stderr, "Work did not execute in priority order\n");
+            ret = EXIT_FAILURE;
+            break;
+        }
+    }
+    return ret;
+}
+
+int
+main(int argc, char *argv[])
+{
+    int ret = EXIT_SUCCESS;
+
+    (void) argc;
+    (void) argv;
+
+    if (test_all() != EXIT_SUCCESS)
+        ret = EXIT_FAILURE;
+    if (test_steal() != EXIT_SUCCESS)
+        ret = EXIT_FAILURE;
+    if (test_priority() != EXIT_SUCCESS)
+        ret = EXIT_FAILURE;
+
+    return ret;
+}
@@ -0,0 +1,67 @@
+#include "mercury_log.h"
+
+#include "mercury_test_config.h"
+
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define HG_TEST_LOG_COUNT 100
+#define HG_TEST_LOG_RATE 10
+
+static int hg_test_log_count_g = 0;
+
+static int
+hg_test_log_func(FILE *stream, const char *format, ...)
+{
+    char buf[512];
+    va_list ap;
+
+    (void) stream;
+
+    va_start(ap, format);
+    vsnprintf(buf, sizeof(buf), format, ap);
+    va_end(ap);
+
+    /* Do not count reports of suppressed messages */
+    if (!strstr(buf, "suppressed"))
+        hg_test_log_count_g++;
+
+    return 0;
+}
+
+int
+main(void)
+{
+    unsigned long rate_limited, queue_full;
+    int ret = EXIT_SUCCESS;
+    int i;
+
+    hg_log_set_func(hg_test_log_func);
+    hg_log_set_rate_limit(HG_TEST_LOG_RATE);
+
+    for (i = 0; i < HG_TEST_LOG_COUNT; i++)
+        HG_LOG_WRITE_ERROR("test", "message %d", i);
+    hg_log_flush();
+
+    hg_log_get_dropped(&rate_limited, &queue_full);
+    if (queue_full != 0) {
+        fprintf(stderr, "Error: %lu messages dropped\n", queue_full);
+        ret = EXIT_FAILURE;
+        goto done;
+    }
+    /* Loop may straddle two rate limiting windows */
+    if (hg_test_log_count_g < HG_TEST_LOG_RATE
+        || hg_test_log_count_g > 2 * HG_TEST_LOG_RATE
+        || (unsigned long) hg_test_log_count_g + rate_limited
+            != HG_TEST_LOG_COUNT) {
+        fprintf(stderr, "Error: %d messages written, %lu rate limited\n",
+            hg_test_log_count_g, rate_limited);
+        ret = EXIT_FAILURE;
+        goto done;
+    }
+
+done:
+    return ret;
+}
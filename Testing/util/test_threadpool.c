@@ -8,6 +8,7 @@
 
 #define MERCURY_TESTING_NUM_THREADS 8
 #define POOL_NUM_POSTS 32
+#define POOL_NUM_OVERFLOW_POSTS 4096
 
 /*
 #include <unistd.h>
@@ -44,12 +45,31 @@ myfunc(void *args)
     return ret;
 }
 
+static hg_thread_pool_t *nested_pool;
+static struct hg_thread_work nested_work[POOL_NUM_POSTS];
+
+/* Post work from a pool thread */
+static HG_THREAD_RETURN_TYPE
+nested_func(void *args)
+{
+    hg_thread_ret_t ret = 0;
+    struct hg_thread_work *work = (struct hg_thread_work *) args;
+
+    myfunc(NULL);
+    work->func = myfunc;
+    work->args = NULL;
+    hg_thread_pool_post(nested_pool, work);
+
+    return ret;
+}
+
 int
 main(int argc, char *argv[])
 {
     int i;
     hg_thread_pool_t *thread_pool;
     struct hg_thread_work work[POOL_NUM_POSTS];
+    static struct hg_thread_work overflow_work[POOL_NUM_OVERFLOW_POSTS];
     int ret = EXIT_SUCCESS;
 
     (void) argc;
@@ -65,12 +85,48 @@ main(int argc, char *argv[])
 
     /* printf("Finalizing...\n"); */
     hg_thread_pool_destroy(thread_pool);
-    hg_thread_mutex_destroy(&mymutex);
 
     if (ncalls != POOL_NUM_POSTS) {
         fprintf(stderr, "Did not execute all the operations posted (%u/%d)\n",
                 ncalls, POOL_NUM_POSTS);
         ret = EXIT_FAILURE;
     }
+
+    /* More posts than local queues can hold */
+    ncalls = 0;
+    hg_thread_pool_init(MERCURY_TESTING_NUM_THREADS, &thread_pool);
+    for (i = 0; i < POOL_NUM_OVERFLOW_POSTS; i++) {
+        overflow_work[i].func = myfunc;
+        overflow_work[i].args = NULL;
+        hg_thread_pool_post(thread_pool, &overflow_work[i]);
+    }
+    hg_thread_pool_destroy(thread_pool);
+
+    if (ncalls != POOL_NUM_OVERFLOW_POSTS) {
+        fprintf(stderr, "Did not execute all the operations posted (%u/%d)\n",
+                ncalls, POOL_NUM_OVERFLOW_POSTS);
+        ret = EXIT_FAILURE;
+    }
+
+    /* Posts from pool threads */
+    ncalls = 0;
+    hg_thread_pool_init(MERCURY_TESTING_NUM_THREADS, &nested_pool);
+    for (i = 0; i < POOL_NUM_POSTS; i++) {
+        work[i].func = nested_func;
+        work[i].args = &nested_work[i];
+        hg_thread_pool_post(nested_pool, &work[i]);
+    }
+    while (1) {
+        hg_thread_mutex_lock(&mymutex);
+        if (ncalls == 2 * POOL_NUM_POSTS) {
+            hg_thread_mutex_unlock(&mymutex);
+            break;
+        }
+        hg_thread_mutex_unlock(&mymutex);
+        hg_thread_yield();
+    }
+    hg_thread_pool_destroy(nested_pool);
+    hg_thread_mutex_destroy(&mymutex);
+
     return ret;
 }
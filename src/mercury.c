@@ -14,7 +14,14 @@
 #include "mercury_header.h"
 #include "mercury_proc.h"
 #include "mercury_error.h"
+#ifdef HG_HAS_COMPRESSION
+#include "mercury_compress.h"
+#endif
+#ifdef HG_HAS_COLLECT_STATS
+#include "mercury_stats.h"
+#endif
 
+#include "mercury_atomic.h"
 #include "mercury_hash_string.h"
 #include "mercury_mem.h"
 
@@ -40,6 +47,9 @@ struct hg_proc_info {
     hg_proc_cb_t in_proc_cb;        /* Input proc callback */
     hg_proc_cb_t out_proc_cb;       /* Output proc callback */
     hg_bool_t no_response;          /* RPC response not expected */
+    hg_bool_t compact;              /* Use compact encoding */
+    hg_bool_t compress;             /* Compress extra input */
+    hg_bool_t eager_push_rw;        /* Push read/write bulk data eagerly */
     void *data;                     /* User data */
     void (*free_callback)(void *);  /* User data free callback */
 };
@@ -57,6 +67,16 @@ struct hg_private_data {
     size_t extra_bulk_buf_size;     /* Extra bulk buffer size */
     hg_bulk_t extra_bulk_handle;    /* Extra bulk handle */
     hg_return_t (*extra_bulk_transfer_cb)(hg_handle_t); /* Bulk transfer callback */
+#ifdef HG_HAS_COMPRESSION
+    hg_uint64_t extra_bulk_buf_orig_size; /* Uncompressed size (0 if none) */
+#endif
+#ifdef HG_HAS_EAGER_BULK
+    hg_handle_t handle;             /* Handle, for deferred response */
+    hg_atomic_int32_t push_pending; /* Eager push puts before response */
+    hg_return_t push_ret;           /* Response is not sent if failed */
+    hg_uint8_t respond_flags;       /* Flags of deferred response */
+    hg_size_t respond_payload_size; /* Payload size of deferred response */
+#endif
 };
 
 /***********************/
@@ -72,6 +92,32 @@ hg_core_get_rpc_data(
         struct hg_handle *hg_handle
         );
 
+#ifdef HG_HAS_EAGER_BULK
+/**
+ * Get index-th range of data pushed to handle in eager push mode.
+ */
+extern hg_bool_t
+hg_bulk_get_eager_push_range(
+        struct hg_bulk *hg_bulk,
+        hg_uint32_t index,
+        hg_size_t *offset,
+        hg_size_t *size
+        );
+
+/**
+ * Put data pushed to handle in eager push mode to origin memory.
+ */
+extern hg_return_t
+hg_bulk_eager_push_flush(
+        hg_context_t *context,
+        hg_addr_t origin_addr,
+        struct hg_bulk *hg_bulk,
+        hg_cb_t callback,
+        void *arg,
+        hg_uint32_t *count
+        );
+#endif
+
 /********************/
 /* Local Prototypes */
 /********************/
@@ -144,6 +190,17 @@ hg_set_struct(
         hg_bool_t *more_data
         );
 
+/**
+ * Encode input/output header only, payload is provided separately.
+ */
+static hg_return_t
+hg_set_header(
+        hg_handle_t handle,
+        struct hg_private_data *hg_private_data,
+        hg_op_t op,
+        hg_size_t *payload_size
+        );
+
 /**
  * Free allocated members from input/output structure.
  */
@@ -182,6 +239,118 @@ hg_free_extra_input(
         struct hg_private_data *hg_private_data
         );
 
+#ifdef HG_HAS_COMPRESSION
+/**
+ * Compress extra buffer, buffer is left untouched if compression does not
+ * reduce its size.
+ */
+static hg_return_t
+hg_compress_extra_buf(
+        struct hg_private_data *hg_private_data
+        );
+
+/**
+ * Decompress extra buffer.
+ */
+static hg_return_t
+hg_decompress_extra_buf(
+        struct hg_private_data *hg_private_data
+        );
+#endif
+
+#ifdef HG_HAS_EAGER_BULK
+/**
+ * Check whether bulk handles sent with input can use eager push.
+ */
+static hg_bool_t
+hg_eager_push_enabled(
+        hg_handle_t handle,
+        struct hg_proc_info *hg_proc_info
+        );
+
+/**
+ * Copy data between a contiguous buffer and a bulk handle region.
+ */
+static void
+hg_eager_push_copy(
+        hg_bulk_t handle,
+        hg_size_t offset,
+        void *buf,
+        hg_size_t size,
+        hg_bool_t to_bulk
+        );
+
+/**
+ * Clear eager push offset in output header before forwarding.
+ */
+static hg_return_t
+hg_reset_eager_push(
+        hg_handle_t handle
+        );
+
+/**
+ * Append data pushed to eager bulk handles to output and encode header. Data
+ * of handles that does not fit is put to origin memory, in which case the
+ * response is deferred until all puts have completed.
+ */
+static hg_return_t
+hg_set_eager_push(
+        hg_handle_t handle,
+        struct hg_private_data *hg_private_data,
+        hg_uint8_t flags,
+        hg_size_t *payload_size,
+        hg_bool_t *deferred
+        );
+
+/**
+ * Put data pushed to eager bulk handle to origin memory.
+ */
+static hg_return_t
+hg_flush_eager_push(
+        hg_handle_t handle,
+        struct hg_private_data *hg_private_data,
+        hg_bulk_t bulk_handle,
+        hg_uint32_t count
+        );
+
+/**
+ * Eager push put callback.
+ */
+static hg_return_t
+hg_flush_eager_push_cb(
+        const struct hg_cb_info *callback_info
+        );
+
+/**
+ * Send deferred response once all eager push puts have completed.
+ */
+static hg_return_t
+hg_respond_eager_push(
+        struct hg_private_data *hg_private_data
+        );
+
+/**
+ * Copy data returned with output to eager bulk handles.
+ */
+static hg_return_t
+hg_get_eager_push(
+        hg_handle_t handle,
+        struct hg_private_data *hg_private_data
+        );
+#endif
+
+/**
+ * Serialize input and forward, see HG_Forward_timed().
+ */
+static hg_return_t
+hg_forward(
+        hg_handle_t handle,
+        hg_cb_t callback,
+        void *arg,
+        void *in_struct,
+        unsigned int timeout
+        );
+
 /**
  * Forward callback.
  */
@@ -190,6 +359,14 @@ hg_forward_cb(
         const struct hg_cb_info *callback_info
         );
 
+/**
+ * Multi forward callback.
+ */
+static hg_return_t
+hg_forward_multi_cb(
+        const struct hg_cb_info *callback_info
+        );
+
 /**
  * Respond callback.
  */
@@ -233,6 +410,10 @@ hg_private_data_alloc(hg_class_t *hg_class, hg_handle_t handle)
     }
     memset(hg_private_data, 0, sizeof(struct hg_private_data));
     hg_header_init(&hg_private_data->hg_header, HG_UNDEF);
+#ifdef HG_HAS_EAGER_BULK
+    hg_private_data->handle = handle;
+    hg_atomic_init32(&hg_private_data->push_pending, 0);
+#endif
 
     /* CRC32 is enough for small size buffers */
     ret = hg_proc_create(hg_class, HG_CRC32, &hg_private_data->in_proc);
@@ -283,6 +464,15 @@ hg_more_data_cb(hg_handle_t handle, hg_return_t (*done_cb)(hg_handle_t))
 
     if (hg_private_data->extra_bulk_buf) {
         /* We were forwarding to ourself and the extra buf is already set */
+#ifdef HG_HAS_COMPRESSION
+        if (hg_private_data->extra_bulk_buf_orig_size) {
+            ret = hg_decompress_extra_buf(hg_private_data);
+            if (ret != HG_SUCCESS) {
+                HG_LOG_ERROR("Could not decompress extra input");
+                goto done;
+            }
+        }
+#endif
         ret = done_cb(handle);
         if (ret != HG_SUCCESS) {
             HG_LOG_ERROR("Could not execute more data done callback");
@@ -334,6 +524,7 @@ hg_get_struct(hg_handle_t handle, struct hg_private_data *hg_private_data,
     struct hg_header_hash *hg_header_hash = NULL;
 #endif
     hg_size_t header_offset = hg_header_get_size(op);
+    hg_uint8_t proc_flags = 0;
     hg_return_t ret = HG_SUCCESS;
 
     switch (op) {
@@ -382,6 +573,15 @@ hg_get_struct(hg_handle_t handle, struct hg_private_data *hg_private_data,
         goto done;
     }
 
+#ifdef HG_HAS_EAGER_BULK
+    /* Keep track of bulk handles received with input */
+    if (op == HG_INPUT) {
+        hg_proc_clear_bulks(proc);
+        if (hg_eager_push_enabled(handle, hg_proc_info))
+            proc_flags |= HG_PROC_EAGER_PUSH;
+    }
+#endif
+
     /* Reset header */
     hg_header_reset(hg_header, op);
 
@@ -410,6 +610,11 @@ hg_get_struct(hg_handle_t handle, struct hg_private_data *hg_private_data,
         goto done;
     }
 
+    /* Use compact encoding if requested */
+    if (hg_proc_info->compact)
+        proc_flags |= HG_PROC_COMPACT;
+    hg_proc_set_flags(proc, proc_flags);
+
     /* Decode parameters */
     ret = proc_cb(proc, struct_ptr);
     if (ret != HG_SUCCESS) {
@@ -457,6 +662,7 @@ hg_set_struct(hg_handle_t handle, struct hg_private_data *hg_private_data,
     struct hg_header_hash *hg_header_hash = NULL;
 #endif
     hg_size_t header_offset = hg_header_get_size(op);
+    hg_uint8_t proc_flags = 0;
     hg_return_t ret = HG_SUCCESS;
 
     switch (op) {
@@ -499,6 +705,17 @@ hg_set_struct(hg_handle_t handle, struct hg_private_data *hg_private_data,
             ret = HG_INVALID_PARAM;
             goto done;
     }
+#ifdef HG_HAS_EAGER_BULK
+    /* Keep track of bulk handles sent with input */
+    if (op == HG_INPUT) {
+        hg_proc_clear_bulks(proc);
+        if (hg_eager_push_enabled(handle, hg_proc_info)) {
+            proc_flags |= HG_PROC_EAGER_PUSH;
+            if (hg_proc_info->eager_push_rw)
+                proc_flags |= HG_PROC_EAGER_PUSH_RW;
+        }
+    }
+#endif
     if (!proc_cb || !struct_ptr) {
         /* Silently skip */
         *payload_size = 0;
@@ -519,6 +736,11 @@ hg_set_struct(hg_handle_t handle, struct hg_private_data *hg_private_data,
         goto done;
     }
 
+    /* Use compact encoding if requested */
+    if (hg_proc_info->compact)
+        proc_flags |= HG_PROC_COMPACT;
+    hg_proc_set_flags(proc, proc_flags);
+
     /* Encode parameters */
     ret = proc_cb(proc, struct_ptr);
     if (ret != HG_SUCCESS) {
@@ -564,6 +786,20 @@ hg_set_struct(hg_handle_t handle, struct hg_private_data *hg_private_data,
         /* Prevent buffer from being freed when proc_reset is called */
         hg_proc_set_extra_buf_is_mine(proc, HG_TRUE);
 
+#ifdef HG_HAS_COMPRESSION
+        /* Compress extra input if requested (more data is not supported yet
+         * on output) */
+        hg_private_data->extra_bulk_buf_orig_size = 0;
+        if (op == HG_INPUT && hg_proc_info->compress
+            && hg_private_data->extra_bulk_buf_size >= HG_COMPRESS_THRESHOLD) {
+            ret = hg_compress_extra_buf(hg_private_data);
+            if (ret != HG_SUCCESS) {
+                HG_LOG_ERROR("Could not compress extra input");
+                goto done;
+            }
+        }
+#endif
+
         /* Create bulk descriptor */
         ret = HG_Bulk_create(hg_info->hg_class, 1,
             &hg_private_data->extra_bulk_buf,
@@ -590,6 +826,18 @@ hg_set_struct(hg_handle_t handle, struct hg_private_data *hg_private_data,
             goto done;
         }
 
+#ifdef HG_HAS_COMPRESSION
+        /* Encode uncompressed size */
+        if (op == HG_INPUT && hg_proc_info->compress) {
+            ret = hg_proc_hg_uint64_t(proc,
+                &hg_private_data->extra_bulk_buf_orig_size);
+            if (ret != HG_SUCCESS) {
+                HG_LOG_ERROR("Could not process extra bulk size");
+                goto done;
+            }
+        }
+#endif
+
         ret = hg_proc_flush(proc);
         if (ret != HG_SUCCESS) {
             HG_LOG_ERROR("Error in proc flush");
@@ -621,6 +869,55 @@ done:
     return ret;
 }
 
+/*---------------------------------------------------------------------------*/
+static hg_return_t
+hg_set_header(hg_handle_t handle, struct hg_private_data *hg_private_data,
+    hg_op_t op, hg_size_t *payload_size)
+{
+    void *buf;
+    hg_size_t buf_size;
+    struct hg_header *hg_header = &hg_private_data->hg_header;
+    hg_return_t ret = HG_SUCCESS;
+
+    switch (op) {
+        case HG_INPUT:
+            /* Get core input buffer */
+            ret = HG_Core_get_input(handle, &buf, &buf_size);
+            if (ret != HG_SUCCESS) {
+                HG_LOG_ERROR("Could not get input buffer");
+                goto done;
+            }
+            break;
+        case HG_OUTPUT:
+            /* Get core output buffer */
+            ret = HG_Core_get_output(handle, &buf, &buf_size);
+            if (ret != HG_SUCCESS) {
+                HG_LOG_ERROR("Could not get output buffer");
+                goto done;
+            }
+            break;
+        default:
+            HG_LOG_ERROR("Invalid HG op");
+            ret = HG_INVALID_PARAM;
+            goto done;
+    }
+
+    /* Reset header */
+    hg_header_reset(hg_header, op);
+
+    /* Encode header */
+    ret = hg_header_proc(HG_ENCODE, buf, buf_size, hg_header);
+    if (ret != HG_SUCCESS) {
+        HG_LOG_ERROR("Could not process header");
+        goto done;
+    }
+
+    *payload_size = hg_header_get_size(op);
+
+done:
+    return ret;
+}
+
 /*---------------------------------------------------------------------------*/
 static hg_return_t
 hg_free_struct(hg_handle_t handle, struct hg_private_data *hg_private_data,
@@ -683,6 +980,9 @@ hg_get_extra_input(hg_handle_t handle, struct hg_private_data *hg_private_data,
     hg_return_t (*done_cb)(hg_handle_t handle))
 {
     hg_proc_t proc = hg_private_data->in_proc;
+#ifdef HG_HAS_COMPRESSION
+    struct hg_proc_info *hg_proc_info;
+#endif
     void *in_buf;
     hg_size_t in_buf_size;
     hg_size_t header_offset = hg_header_get_size(HG_INPUT);
@@ -691,6 +991,17 @@ hg_get_extra_input(hg_handle_t handle, struct hg_private_data *hg_private_data,
     hg_bulk_t local_in_handle = HG_BULK_NULL;
     hg_return_t ret = HG_SUCCESS;
 
+#ifdef HG_HAS_COMPRESSION
+    /* Retrieve RPC data (not yet attached to handle at this point) */
+    hg_proc_info = (struct hg_proc_info *) HG_Core_registered_data(
+        hg_info->hg_class, hg_info->id);
+    if (!hg_proc_info) {
+        HG_LOG_ERROR("Could not get proc info");
+        ret = HG_PROTOCOL_ERROR;
+        goto done;
+    }
+#endif
+
     /* Get core input buffer */
     ret = HG_Core_get_input(handle, &in_buf, &in_buf_size);
     if (ret != HG_SUCCESS) {
@@ -715,6 +1026,29 @@ hg_get_extra_input(hg_handle_t handle, struct hg_private_data *hg_private_data,
         goto done;
     }
 
+#ifdef HG_HAS_COMPRESSION
+    /* Decode uncompressed size */
+    hg_private_data->extra_bulk_buf_orig_size = 0;
+    if (hg_proc_info->compress) {
+        ret = hg_proc_hg_uint64_t(proc,
+            &hg_private_data->extra_bulk_buf_orig_size);
+        if (ret != HG_SUCCESS) {
+            HG_LOG_ERROR("Could not process extra bulk size");
+            goto done;
+        }
+        /* Size comes from the peer, do not let it drive allocations */
+        if (hg_private_data->extra_bulk_buf_orig_size
+            > (hg_uint64_t) HG_COMPRESS_MAX_SIZE) {
+            HG_LOG_ERROR("Uncompressed size (%lu) exceeds limit (%lu)",
+                (unsigned long) hg_private_data->extra_bulk_buf_orig_size,
+                (unsigned long) HG_COMPRESS_MAX_SIZE);
+            hg_private_data->extra_bulk_buf_orig_size = 0;
+            ret = HG_PROTOCOL_ERROR;
+            goto done;
+        }
+    }
+#endif
+
     ret = hg_proc_flush(proc);
     if (ret != HG_SUCCESS) {
         HG_LOG_ERROR("Error in proc flush");
@@ -775,6 +1109,17 @@ hg_get_extra_input_cb(const struct hg_cb_info *callback_info)
         goto done;
     }
 
+#ifdef HG_HAS_COMPRESSION
+    /* Decompress extra input before it gets decoded */
+    if (hg_private_data->extra_bulk_buf_orig_size) {
+        ret = hg_decompress_extra_buf(hg_private_data);
+        if (ret != HG_SUCCESS) {
+            HG_LOG_ERROR("Could not decompress extra input");
+            goto done;
+        }
+    }
+#endif
+
     ret = hg_private_data->extra_bulk_transfer_cb(handle);
     if (ret != HG_SUCCESS) {
         HG_LOG_ERROR("Could not execute bulk transfer callback");
@@ -797,77 +1142,590 @@ hg_free_extra_input(struct hg_private_data *hg_private_data)
     }
 }
 
+#ifdef HG_HAS_COMPRESSION
 /*---------------------------------------------------------------------------*/
 static hg_return_t
-hg_forward_cb(const struct hg_cb_info *callback_info)
+hg_compress_extra_buf(struct hg_private_data *hg_private_data)
 {
-    struct hg_private_data *hg_private_data =
-            (struct hg_private_data *) callback_info->arg;
+    hg_size_t page_size = (hg_size_t) hg_mem_get_page_size();
+    void *buf = NULL;
+    hg_size_t buf_size = hg_private_data->extra_bulk_buf_size;
     hg_return_t ret = HG_SUCCESS;
 
-    /* Free eventual extra input buffer and handle */
-    if (hg_private_data->extra_bulk_buf) {
-        HG_Bulk_free(hg_private_data->extra_bulk_handle);
-        hg_private_data->extra_bulk_handle = HG_BULK_NULL;
-        hg_mem_aligned_free(hg_private_data->extra_bulk_buf);
-        hg_private_data->extra_bulk_buf = NULL,
-        hg_private_data->extra_bulk_buf_size = 0;
+    buf = hg_mem_aligned_alloc(page_size, buf_size);
+    if (!buf) {
+        HG_LOG_ERROR("Could not allocate compression buffer");
+        ret = HG_NOMEM_ERROR;
+        goto done;
     }
 
-    /* Execute callback */
-    if (hg_private_data->forward_cb) {
-        struct hg_cb_info hg_cb_info;
-
-        hg_cb_info.arg = hg_private_data->forward_arg;
-        hg_cb_info.ret = callback_info->ret;
-        hg_cb_info.type = callback_info->type;
-        hg_cb_info.info = callback_info->info;
-
-        hg_private_data->forward_cb(&hg_cb_info);
+    /* Compressed data must be smaller than original data, keep original
+     * buffer otherwise */
+    ret = hg_compress(hg_private_data->extra_bulk_buf,
+        hg_private_data->extra_bulk_buf_size, buf, buf_size, &buf_size);
+    if (ret == HG_SIZE_ERROR || (ret == HG_SUCCESS
+        && buf_size >= hg_private_data->extra_bulk_buf_size)) {
+        ret = HG_SUCCESS;
+        goto done;
+    } else if (ret != HG_SUCCESS) {
+        HG_LOG_ERROR("Could not compress buffer");
+        goto done;
     }
 
+    hg_mem_aligned_free(hg_private_data->extra_bulk_buf);
+    hg_private_data->extra_bulk_buf_orig_size =
+        (hg_uint64_t) hg_private_data->extra_bulk_buf_size;
+    hg_private_data->extra_bulk_buf = buf;
+    hg_private_data->extra_bulk_buf_size = buf_size;
+    buf = NULL;
+
+done:
+    hg_mem_aligned_free(buf);
     return ret;
 }
 
 /*---------------------------------------------------------------------------*/
 static hg_return_t
-hg_respond_cb(const struct hg_cb_info *callback_info)
+hg_decompress_extra_buf(struct hg_private_data *hg_private_data)
 {
-    struct hg_private_data *hg_private_data =
-            (struct hg_private_data *) callback_info->arg;
+    hg_size_t page_size = (hg_size_t) hg_mem_get_page_size();
+    void *buf = NULL;
+    hg_size_t buf_size = (hg_size_t) hg_private_data->extra_bulk_buf_orig_size;
     hg_return_t ret = HG_SUCCESS;
 
-    /* Execute callback */
-    if (hg_private_data->respond_cb) {
-        struct hg_cb_info hg_cb_info;
+    /* Only buffers that shrank were sent compressed */
+    if (buf_size <= hg_private_data->extra_bulk_buf_size
+        || buf_size > HG_COMPRESS_MAX_SIZE) {
+        HG_LOG_ERROR("Invalid uncompressed size (%lu)",
+            (unsigned long) buf_size);
+        ret = HG_PROTOCOL_ERROR;
+        goto done;
+    }
 
-        hg_cb_info.arg = hg_private_data->respond_arg;
-        hg_cb_info.ret = callback_info->ret;
-        hg_cb_info.type = callback_info->type;
-        hg_cb_info.info = callback_info->info;
+    buf = hg_mem_aligned_alloc(page_size, buf_size);
+    if (!buf) {
+        HG_LOG_ERROR("Could not allocate decompression buffer");
+        ret = HG_NOMEM_ERROR;
+        goto done;
+    }
 
-        hg_private_data->respond_cb(&hg_cb_info);
+    ret = hg_decompress(hg_private_data->extra_bulk_buf,
+        hg_private_data->extra_bulk_buf_size, buf, buf_size);
+    if (ret != HG_SUCCESS) {
+        HG_LOG_ERROR("Could not decompress buffer");
+        goto done;
     }
 
+    hg_mem_aligned_free(hg_private_data->extra_bulk_buf);
+    hg_private_data->extra_bulk_buf = buf;
+    hg_private_data->extra_bulk_buf_size = buf_size;
+    hg_private_data->extra_bulk_buf_orig_size = 0;
+    buf = NULL;
+
+done:
+    hg_mem_aligned_free(buf);
     return ret;
 }
+#endif
 
+#ifdef HG_HAS_EAGER_BULK
 /*---------------------------------------------------------------------------*/
-hg_return_t
-HG_Version_get(unsigned int *major, unsigned int *minor, unsigned int *patch)
+static hg_bool_t
+hg_eager_push_enabled(hg_handle_t handle, struct hg_proc_info *hg_proc_info)
 {
-    hg_return_t ret = HG_SUCCESS;
+    const struct hg_info *hg_info = HG_Core_get_info(handle);
 
-    if (major) *major = HG_VERSION_MAJOR;
-    if (minor) *minor = HG_VERSION_MINOR;
-    if (patch) *patch = HG_VERSION_PATCH;
+    /* Pushed data is returned with the response, self RPCs directly access
+     * origin memory */
+    if (hg_proc_info->no_response || !hg_info || !hg_info->addr)
+        return HG_FALSE;
 
-    return ret;
+    return (hg_bool_t) !NA_Addr_is_self(
+        HG_Core_addr_get_na_class(hg_info->addr),
+        HG_Core_addr_get_na(hg_info->addr));
 }
 
 /*---------------------------------------------------------------------------*/
-const char *
-HG_Error_to_string(hg_return_t errnum)
+static void
+hg_eager_push_copy(hg_bulk_t handle, hg_size_t offset, void *buf,
+    hg_size_t size, hg_bool_t to_bulk)
+{
+    char *buf_ptr = (char *) buf;
+
+    while (size) {
+        void *segment_ptr;
+        hg_size_t segment_size;
+        hg_uint32_t count;
+
+        /* Get next contiguous piece of the region */
+        HG_Bulk_access(handle, offset, size, HG_BULK_READWRITE, 1,
+            &segment_ptr, &segment_size, &count);
+        if (!count || !segment_size)
+            break;
+        if (to_bulk)
+            memcpy(segment_ptr, buf_ptr, segment_size);
+        else
+            memcpy(buf_ptr, segment_ptr, segment_size);
+        buf_ptr += segment_size;
+        offset += segment_size;
+        size -= segment_size;
+    }
+}
+
+/*---------------------------------------------------------------------------*/
+static hg_return_t
+hg_reset_eager_push(hg_handle_t handle)
+{
+    struct hg_header hg_header;
+    void *buf;
+    hg_size_t buf_size;
+    hg_return_t ret = HG_SUCCESS;
+
+    /* Get core output buffer */
+    ret = HG_Core_get_output(handle, &buf, &buf_size);
+    if (ret != HG_SUCCESS) {
+        HG_LOG_ERROR("Could not get output buffer");
+        goto done;
+    }
+
+    /* A response that does not carry a header must not be mistaken for one
+     * that has eager push data */
+    hg_header_reset(&hg_header, HG_OUTPUT);
+    ret = hg_header_proc(HG_ENCODE, buf, buf_size, &hg_header);
+    if (ret != HG_SUCCESS) {
+        HG_LOG_ERROR("Could not process header");
+        goto done;
+    }
+
+done:
+    return ret;
+}
+
+/*---------------------------------------------------------------------------*/
+static hg_return_t
+hg_set_eager_push(hg_handle_t handle, struct hg_private_data *hg_private_data,
+    hg_uint8_t flags, hg_size_t *payload_size, hg_bool_t *deferred)
+{
+    hg_proc_t proc = hg_private_data->in_proc;
+    hg_uint32_t bulk_count = hg_proc_get_bulk_count(proc), count = 0, i;
+    struct hg_header *hg_header = &hg_private_data->hg_header;
+    hg_size_t header_offset = hg_header_get_size(HG_OUTPUT);
+    hg_size_t record_size = sizeof(i) + 2 * sizeof(hg_uint64_t);
+    char *buf, *buf_ptr;
+    hg_size_t buf_size;
+    hg_return_t respond_ret, ret = HG_SUCCESS;
+
+    *deferred = HG_FALSE;
+    if (!bulk_count)
+        goto done;
+
+    /* Get core output buffer */
+    ret = HG_Core_get_output(handle, (void **) &buf, &buf_size);
+    if (ret != HG_SUCCESS) {
+        HG_LOG_ERROR("Could not get output buffer");
+        goto done;
+    }
+
+    /* Header is not encoded if there is no output payload */
+    if (*payload_size < header_offset) {
+        hg_header_reset(hg_header, HG_OUTPUT);
+        *payload_size = header_offset;
+    }
+
+    /* Records are: index, offset, size, data */
+    hg_private_data->push_ret = HG_SUCCESS;
+    buf_ptr = buf + *payload_size + sizeof(count);
+    for (i = 0; i < bulk_count; i++) {
+        hg_bulk_t bulk_handle = hg_proc_get_bulk(proc, i);
+        hg_uint64_t push_offset, push_size;
+        hg_size_t offset, size, handle_size = 0;
+        hg_uint32_t j;
+
+        /* Only ranges that were pushed are returned, data in between is left
+         * untouched on the origin */
+        for (j = 0; hg_bulk_get_eager_push_range(bulk_handle, j, &offset,
+            &size); j++)
+            handle_size += record_size + size;
+        if (!j)
+            continue;
+
+        /* Data of handles that do not fit into what is left of the response
+         * is put to origin memory instead */
+        if ((hg_size_t) (buf_ptr - buf) + handle_size > buf_size) {
+            ret = hg_flush_eager_push(handle, hg_private_data, bulk_handle, j);
+            if (ret != HG_SUCCESS) {
+                HG_LOG_ERROR("Could not flush eager push data");
+                goto done;
+            }
+            continue;
+        }
+
+        for (j = 0; hg_bulk_get_eager_push_range(bulk_handle, j, &offset,
+            &size); j++) {
+            push_offset = (hg_uint64_t) offset;
+            push_size = (hg_uint64_t) size;
+            memcpy(buf_ptr, &i, sizeof(i));
+            buf_ptr += sizeof(i);
+            memcpy(buf_ptr, &push_offset, sizeof(push_offset));
+            buf_ptr += sizeof(push_offset);
+            memcpy(buf_ptr, &push_size, sizeof(push_size));
+            buf_ptr += sizeof(push_size);
+            hg_eager_push_copy(bulk_handle, offset, buf_ptr, size, HG_FALSE);
+            buf_ptr += size;
+            count++;
+        }
+    }
+
+    if (count) {
+        memcpy(buf + *payload_size, &count, sizeof(count));
+        hg_header->msg.output.eager_offset = (hg_uint32_t) *payload_size;
+        *payload_size = (hg_size_t) (buf_ptr - buf);
+    } else
+        hg_header->msg.output.eager_offset = 0;
+
+    /* Encode header */
+    ret = hg_header_proc(HG_ENCODE, buf, buf_size, hg_header);
+    if (ret != HG_SUCCESS) {
+        HG_LOG_ERROR("Could not process header");
+        goto done;
+    }
+
+done:
+    /* Response is sent by whoever completes last, puts or this call */
+    if (hg_atomic_get32(&hg_private_data->push_pending)) {
+        hg_private_data->push_ret = ret;
+        hg_private_data->respond_flags = flags;
+        hg_private_data->respond_payload_size = *payload_size;
+        *deferred = HG_TRUE;
+        respond_ret = hg_respond_eager_push(hg_private_data);
+        if (ret == HG_SUCCESS)
+            ret = respond_ret;
+    }
+    hg_proc_clear_bulks(proc);
+    return ret;
+}
+
+/*---------------------------------------------------------------------------*/
+static hg_return_t
+hg_flush_eager_push(hg_handle_t handle, struct hg_private_data *hg_private_data,
+    hg_bulk_t bulk_handle, hg_uint32_t count)
+{
+    const struct hg_info *hg_info = HG_Core_get_info(handle);
+    hg_uint32_t flush_count = 0;
+    hg_return_t ret = HG_SUCCESS;
+
+    /* First flush keeps the handle alive and holds back the response until
+     * hg_set_eager_push() is done */
+    if (!hg_atomic_get32(&hg_private_data->push_pending)) {
+        HG_Core_ref_incr(handle);
+        hg_atomic_set32(&hg_private_data->push_pending, 1);
+    }
+
+    /* Account for all puts before any of them can complete */
+    hg_atomic_add32(&hg_private_data->push_pending, (hg_util_int32_t) count);
+    ret = hg_bulk_eager_push_flush(hg_info->context, hg_info->addr,
+        (struct hg_bulk *) bulk_handle, hg_flush_eager_push_cb,
+        hg_private_data, &flush_count);
+    if (flush_count < count)
+        hg_atomic_add32(&hg_private_data->push_pending,
+            (hg_util_int32_t) flush_count - (hg_util_int32_t) count);
+
+    return ret;
+}
+
+/*---------------------------------------------------------------------------*/
+static hg_return_t
+hg_flush_eager_push_cb(const struct hg_cb_info *callback_info)
+{
+    struct hg_private_data *hg_private_data =
+        (struct hg_private_data *) callback_info->arg;
+
+    /* Response is still sent so that the origin does not wait forever */
+    if (callback_info->ret != HG_SUCCESS)
+        HG_LOG_ERROR("Could not put eager push data");
+
+    return hg_respond_eager_push(hg_private_data);
+}
+
+/*---------------------------------------------------------------------------*/
+static hg_return_t
+hg_respond_eager_push(struct hg_private_data *hg_private_data)
+{
+    hg_handle_t handle = hg_private_data->handle;
+    hg_return_t ret = HG_SUCCESS;
+
+    if (hg_atomic_decr32(&hg_private_data->push_pending))
+        goto done;
+
+    if (hg_private_data->push_ret == HG_SUCCESS) {
+        ret = HG_Core_respond(handle, hg_respond_cb, hg_private_data,
+            hg_private_data->respond_flags,
+            hg_private_data->respond_payload_size);
+        if (ret != HG_SUCCESS)
+            HG_LOG_ERROR("Could not respond");
+    }
+
+    /* Release reference taken when response was deferred */
+    HG_Core_destroy(handle);
+
+done:
+    return ret;
+}
+
+/*---------------------------------------------------------------------------*/
+static hg_return_t
+hg_get_eager_push(hg_handle_t handle, struct hg_private_data *hg_private_data)
+{
+    hg_proc_t proc = hg_private_data->in_proc;
+    hg_uint32_t bulk_count = hg_proc_get_bulk_count(proc), count, i;
+    struct hg_header hg_header;
+    char *buf, *buf_ptr;
+    hg_size_t buf_size;
+    hg_return_t ret = HG_SUCCESS;
+
+    if (!bulk_count)
+        goto done;
+
+    /* Get core output buffer */
+    ret = HG_Core_get_output(handle, (void **) &buf, &buf_size);
+    if (ret != HG_SUCCESS) {
+        HG_LOG_ERROR("Could not get output buffer");
+        goto done;
+    }
+
+    /* Get offset of eager push data from header */
+    hg_header_reset(&hg_header, HG_OUTPUT);
+    ret = hg_header_proc(HG_DECODE, buf, buf_size, &hg_header);
+    if (ret != HG_SUCCESS) {
+        HG_LOG_ERROR("Could not process header");
+        goto done;
+    }
+    if (!hg_header.msg.output.eager_offset)
+        goto done;
+    if (hg_header.msg.output.eager_offset + sizeof(count) > buf_size) {
+        HG_LOG_ERROR("Invalid eager push offset");
+        ret = HG_PROTOCOL_ERROR;
+        goto done;
+    }
+
+    buf_ptr = buf + hg_header.msg.output.eager_offset;
+    memcpy(&count, buf_ptr, sizeof(count));
+    buf_ptr += sizeof(count);
+    for (i = 0; i < count; i++) {
+        hg_uint32_t index;
+        hg_uint64_t push_offset, push_size;
+        hg_bulk_t bulk_handle;
+
+        if ((hg_size_t) (buf_ptr - buf) + sizeof(index) + sizeof(push_offset)
+            + sizeof(push_size) > buf_size) {
+            HG_LOG_ERROR("Eager push data exceeds response size");
+            ret = HG_PROTOCOL_ERROR;
+            goto done;
+        }
+        memcpy(&index, buf_ptr, sizeof(index));
+        buf_ptr += sizeof(index);
+        memcpy(&push_offset, buf_ptr, sizeof(push_offset));
+        buf_ptr += sizeof(push_offset);
+        memcpy(&push_size, buf_ptr, sizeof(push_size));
+        buf_ptr += sizeof(push_size);
+
+        bulk_handle = hg_proc_get_bulk(proc, index);
+        if (bulk_handle == HG_BULK_NULL
+            || push_offset + push_size > HG_Bulk_get_size(bulk_handle)
+            || (hg_size_t) (buf_ptr - buf) + push_size > buf_size) {
+            HG_LOG_ERROR("Invalid eager push data");
+            ret = HG_PROTOCOL_ERROR;
+            goto done;
+        }
+        hg_eager_push_copy(bulk_handle, (hg_size_t) push_offset, buf_ptr,
+            (hg_size_t) push_size, HG_TRUE);
+        buf_ptr += push_size;
+    }
+
+done:
+    hg_proc_clear_bulks(proc);
+    return ret;
+}
+#endif
+
+/*---------------------------------------------------------------------------*/
+static hg_return_t
+hg_forward(hg_handle_t handle, hg_cb_t callback, void *arg, void *in_struct,
+    unsigned int timeout)
+{
+    struct hg_private_data *hg_private_data;
+    struct hg_proc_info *hg_proc_info;
+    hg_size_t payload_size;
+    hg_bool_t more_data = HG_FALSE;
+    hg_uint8_t flags = 0;
+    hg_return_t ret = HG_SUCCESS;
+
+    /* Retrieve private data */
+    hg_private_data = (struct hg_private_data *) HG_Core_get_data(handle);
+    if (!hg_private_data) {
+        HG_LOG_ERROR("Could not get private data");
+        ret = HG_PROTOCOL_ERROR;
+        goto done;
+    }
+    hg_private_data->forward_cb = callback;
+    hg_private_data->forward_arg = arg;
+
+    /* Retrieve RPC data */
+    hg_proc_info = (struct hg_proc_info *) hg_core_get_rpc_data(handle);
+    if (!hg_proc_info) {
+        HG_LOG_ERROR("Could not get proc info");
+        ret = HG_PROTOCOL_ERROR;
+        goto done;
+    }
+
+    /* Set input struct */
+    ret = hg_set_struct(handle, hg_private_data, hg_proc_info, HG_INPUT,
+        in_struct, &payload_size, &more_data);
+    if (ret != HG_SUCCESS) {
+        HG_LOG_ERROR("Could not set input");
+        goto done;
+    }
+
+#ifdef HG_HAS_EAGER_BULK
+    /* Clear output header if pushed data may be returned with response */
+    if (hg_proc_get_bulk_count(hg_private_data->in_proc)) {
+        ret = hg_reset_eager_push(handle);
+        if (ret != HG_SUCCESS) {
+            HG_LOG_ERROR("Could not reset output header");
+            goto done;
+        }
+    }
+#endif
+
+    /* Set more data flag on handle so that handle_more_callback is triggered */
+    if (more_data)
+        flags |= HG_CORE_MORE_DATA;
+
+    /* Set no response flag if no response required */
+    if (hg_proc_info->no_response)
+        flags |= HG_CORE_NO_RESPONSE;
+
+    /* Send request */
+    ret = HG_Core_forward_timed(handle, hg_forward_cb, hg_private_data, flags,
+        payload_size, timeout);
+    if (ret != HG_SUCCESS) {
+        HG_LOG_ERROR("Could not forward call");
+        goto done;
+    }
+
+done:
+    return ret;
+}
+
+/*---------------------------------------------------------------------------*/
+static hg_return_t
+hg_forward_cb(const struct hg_cb_info *callback_info)
+{
+    struct hg_private_data *hg_private_data =
+            (struct hg_private_data *) callback_info->arg;
+    hg_return_t ret = HG_SUCCESS;
+
+    /* Free eventual extra input buffer and handle */
+    if (hg_private_data->extra_bulk_buf) {
+        HG_Bulk_free(hg_private_data->extra_bulk_handle);
+        hg_private_data->extra_bulk_handle = HG_BULK_NULL;
+        hg_mem_aligned_free(hg_private_data->extra_bulk_buf);
+        hg_private_data->extra_bulk_buf = NULL,
+        hg_private_data->extra_bulk_buf_size = 0;
+    }
+
+#ifdef HG_HAS_EAGER_BULK
+    /* Copy data pushed by target to eager bulk handles */
+    if (callback_info->ret == HG_SUCCESS) {
+        ret = hg_get_eager_push(callback_info->info.forward.handle,
+            hg_private_data);
+        if (ret != HG_SUCCESS)
+            HG_LOG_ERROR("Could not get eager push data");
+    } else
+        hg_proc_clear_bulks(hg_private_data->in_proc);
+#endif
+
+    /* Execute callback */
+    if (hg_private_data->forward_cb) {
+        struct hg_cb_info hg_cb_info;
+
+        hg_cb_info.arg = hg_private_data->forward_arg;
+        hg_cb_info.ret = callback_info->ret;
+        hg_cb_info.type = callback_info->type;
+        hg_cb_info.info = callback_info->info;
+
+        hg_private_data->forward_cb(&hg_cb_info);
+    }
+
+    return ret;
+}
+
+/*---------------------------------------------------------------------------*/
+static hg_return_t
+hg_forward_multi_cb(const struct hg_cb_info *callback_info)
+{
+    struct hg_private_data *hg_private_data =
+            (struct hg_private_data *) callback_info->arg;
+
+#ifdef HG_HAS_EAGER_BULK
+    /* Data pushed by several targets is not returned */
+    hg_proc_clear_bulks(hg_private_data->in_proc);
+#endif
+
+    /* Execute callback */
+    if (hg_private_data->forward_cb) {
+        struct hg_cb_info hg_cb_info;
+
+        hg_cb_info.arg = hg_private_data->forward_arg;
+        hg_cb_info.ret = callback_info->ret;
+        hg_cb_info.type = callback_info->type;
+        hg_cb_info.info = callback_info->info;
+
+        hg_private_data->forward_cb(&hg_cb_info);
+    }
+
+    return HG_SUCCESS;
+}
+
+/*---------------------------------------------------------------------------*/
+static hg_return_t
+hg_respond_cb(const struct hg_cb_info *callback_info)
+{
+    struct hg_private_data *hg_private_data =
+            (struct hg_private_data *) callback_info->arg;
+    hg_return_t ret = HG_SUCCESS;
+
+    /* Execute callback */
+    if (hg_private_data->respond_cb) {
+        struct hg_cb_info hg_cb_info;
+
+        hg_cb_info.arg = hg_private_data->respond_arg;
+        hg_cb_info.ret = callback_info->ret;
+        hg_cb_info.type = callback_info->type;
+        hg_cb_info.info = callback_info->info;
+
+        hg_private_data->respond_cb(&hg_cb_info);
+    }
+
+    return ret;
+}
+
+/*---------------------------------------------------------------------------*/
+hg_return_t
+HG_Version_get(unsigned int *major, unsigned int *minor, unsigned int *patch)
+{
+    hg_return_t ret = HG_SUCCESS;
+
+    if (major) *major = HG_VERSION_MAJOR;
+    if (minor) *minor = HG_VERSION_MINOR;
+    if (patch) *patch = HG_VERSION_PATCH;
+
+    return ret;
+}
+
+/*---------------------------------------------------------------------------*/
+const char *
+HG_Error_to_string(hg_return_t errnum)
 {
     const char *hg_error_string = "UNDEFINED/UNRECOGNIZED NA ERROR";
 
@@ -882,6 +1740,7 @@ HG_Error_to_string(hg_return_t errnum)
     HG_ERROR_STRING_MACRO(HG_CHECKSUM_ERROR, errnum, hg_error_string);
     HG_ERROR_STRING_MACRO(HG_CANCELED, errnum, hg_error_string);
     HG_ERROR_STRING_MACRO(HG_OTHER_ERROR, errnum, hg_error_string);
+    HG_ERROR_STRING_MACRO(HG_BUSY, errnum, hg_error_string);
 
     return hg_error_string;
 }
@@ -1044,25 +1903,49 @@ HG_Context_destroy(hg_context_t *context)
 }
 
 /*---------------------------------------------------------------------------*/
-hg_class_t *
-HG_Context_get_class(const hg_context_t *context)
+hg_class_t *
+HG_Context_get_class(const hg_context_t *context)
+{
+    return HG_Core_context_get_class(context);
+}
+
+/*---------------------------------------------------------------------------*/
+hg_uint8_t
+HG_Context_get_id(const hg_context_t *context)
+{
+    return HG_Core_context_get_id(context);
+}
+
+/*---------------------------------------------------------------------------*/
+hg_return_t
+HG_Context_set_data(hg_context_t *context, void *data,
+    void (*free_callback)(void *))
+{
+    return HG_Core_context_set_data(context, data, free_callback);
+}
+
+/*---------------------------------------------------------------------------*/
+hg_return_t
+HG_Context_set_handler_threads(hg_context_t *context,
+    unsigned int thread_count)
 {
-    return HG_Core_context_get_class(context);
+    return HG_Core_context_set_handler_threads(context, thread_count);
 }
 
 /*---------------------------------------------------------------------------*/
-hg_uint8_t
-HG_Context_get_id(const hg_context_t *context)
+hg_return_t
+HG_Context_set_coalescing(hg_context_t *context, hg_bool_t enable,
+    unsigned int window)
 {
-    return HG_Core_context_get_id(context);
+    return HG_Core_context_set_coalescing(context, enable, window);
 }
 
 /*---------------------------------------------------------------------------*/
 hg_return_t
-HG_Context_set_data(hg_context_t *context, void *data,
-    void (*free_callback)(void *))
+HG_Context_set_queue_limit(hg_context_t *context,
+    hg_handler_priority_t priority, unsigned int limit)
 {
-    return HG_Core_context_set_data(context, data, free_callback);
+    return HG_Core_context_set_queue_limit(context, priority, limit);
 }
 
 /*---------------------------------------------------------------------------*/
@@ -1280,6 +2163,133 @@ done:
     return ret;
 }
 
+/*---------------------------------------------------------------------------*/
+hg_return_t
+HG_Registered_compact_encoding(hg_class_t *hg_class, hg_id_t id,
+    hg_bool_t enable)
+{
+    struct hg_proc_info *hg_proc_info = NULL;
+    hg_return_t ret = HG_SUCCESS;
+
+    /* Retrieve proc function from function map */
+    hg_proc_info =
+        (struct hg_proc_info *) HG_Core_registered_data(hg_class, id);
+    if (!hg_proc_info) {
+        HG_LOG_ERROR("Could not get registered data");
+        ret = HG_NO_MATCH;
+        goto done;
+    }
+
+    hg_proc_info->compact = enable;
+
+done:
+    return ret;
+}
+
+/*---------------------------------------------------------------------------*/
+hg_return_t
+HG_Registered_compress(hg_class_t *hg_class, hg_id_t id, hg_bool_t enable)
+{
+    struct hg_proc_info *hg_proc_info = NULL;
+    hg_return_t ret = HG_SUCCESS;
+
+#ifndef HG_HAS_COMPRESSION
+    if (enable) {
+        HG_LOG_ERROR("Compression support was not enabled");
+        ret = HG_INVALID_PARAM;
+        goto done;
+    }
+#endif
+
+    /* Retrieve proc function from function map */
+    hg_proc_info =
+        (struct hg_proc_info *) HG_Core_registered_data(hg_class, id);
+    if (!hg_proc_info) {
+        HG_LOG_ERROR("Could not get registered data");
+        ret = HG_NO_MATCH;
+        goto done;
+    }
+
+    hg_proc_info->compress = enable;
+
+done:
+    return ret;
+}
+
+/*---------------------------------------------------------------------------*/
+hg_return_t
+HG_Registered_eager_push_rw(hg_class_t *hg_class, hg_id_t id,
+    hg_bool_t enable)
+{
+    struct hg_proc_info *hg_proc_info = NULL;
+    hg_return_t ret = HG_SUCCESS;
+
+#ifndef HG_HAS_EAGER_BULK
+    if (enable) {
+        HG_LOG_ERROR("Eager bulk support was not enabled");
+        ret = HG_INVALID_PARAM;
+        goto done;
+    }
+#endif
+
+    /* Retrieve proc function from function map */
+    hg_proc_info =
+        (struct hg_proc_info *) HG_Core_registered_data(hg_class, id);
+    if (!hg_proc_info) {
+        HG_LOG_ERROR("Could not get registered data");
+        ret = HG_NO_MATCH;
+        goto done;
+    }
+
+    hg_proc_info->eager_push_rw = enable;
+
+done:
+    return ret;
+}
+
+/*---------------------------------------------------------------------------*/
+hg_return_t
+HG_Registered_handler_hints(hg_class_t *hg_class, hg_id_t id,
+    hg_handler_priority_t priority, unsigned int affinity)
+{
+    return HG_Core_registered_handler_hints(hg_class, id, priority, affinity);
+}
+
+/*---------------------------------------------------------------------------*/
+hg_return_t
+HG_Stats_get(hg_class_t *hg_class, hg_context_t *context, hg_id_t id,
+    struct hg_stats *stats)
+{
+    return HG_Core_stats_get(hg_class, context, id, stats);
+}
+
+/*---------------------------------------------------------------------------*/
+hg_return_t
+HG_Stats_reset(hg_class_t *hg_class, hg_context_t *context, hg_id_t id)
+{
+    return HG_Core_stats_reset(hg_class, context, id);
+}
+
+/*---------------------------------------------------------------------------*/
+hg_uint64_t
+HG_Stats_percentile(const struct hg_stats_hist *hist, double percentile)
+{
+#ifdef HG_HAS_COLLECT_STATS
+    return hist ? hg_stats_hist_percentile(hist, percentile) : 0;
+#else
+    (void) hist;
+    (void) percentile;
+    return 0;
+#endif
+}
+
+/*---------------------------------------------------------------------------*/
+hg_return_t
+HG_Trace_dump(const char *filename)
+{
+    return HG_Core_trace_dump(filename);
+}
+
 /*---------------------------------------------------------------------------*/
 hg_return_t
 HG_Addr_lookup(hg_context_t *context, hg_cb_t callback, void *arg,
@@ -1288,6 +2298,15 @@ HG_Addr_lookup(hg_context_t *context, hg_cb_t callback, void *arg,
     return HG_Core_addr_lookup(context, callback, arg, name, op_id);
 }
 
+/*---------------------------------------------------------------------------*/
+hg_return_t
+HG_Addr_lookup_batch(hg_context_t *context, hg_cb_t callback, void *arg,
+    const char *const names[], unsigned int count, hg_addr_t addrs[])
+{
+    return HG_Core_addr_lookup_batch(context, callback, arg, names, count,
+        addrs);
+}
+
 /*---------------------------------------------------------------------------*/
 hg_return_t
 HG_Addr_free(hg_class_t *hg_class, hg_addr_t addr)
@@ -1295,6 +2314,13 @@ HG_Addr_free(hg_class_t *hg_class, hg_addr_t addr)
     return HG_Core_addr_free(hg_class, addr);
 }
 
+/*---------------------------------------------------------------------------*/
+hg_return_t
+HG_Addr_cache_invalidate(hg_class_t *hg_class, const char *name)
+{
+    return HG_Core_addr_cache_invalidate(hg_class, name);
+}
+
 /*---------------------------------------------------------------------------*/
 hg_return_t
 HG_Addr_self(hg_class_t *hg_class, hg_addr_t *addr)
@@ -1357,6 +2383,13 @@ HG_Reset(hg_handle_t handle, hg_addr_t addr, hg_id_t id)
     return HG_Core_reset(handle, addr, id);
 }
 
+/*---------------------------------------------------------------------------*/
+hg_return_t
+HG_Prepare(hg_handle_t handle)
+{
+    return HG_Core_prepare(handle);
+}
+
 /*---------------------------------------------------------------------------*/
 hg_return_t
 HG_Ref_incr(hg_handle_t handle)
@@ -1639,6 +2672,22 @@ HG_Set_target_id(hg_handle_t handle, hg_uint8_t target_id)
 /*---------------------------------------------------------------------------*/
 hg_return_t
 HG_Forward(hg_handle_t handle, hg_cb_t callback, void *arg, void *in_struct)
+{
+    return hg_forward(handle, callback, arg, in_struct, 0);
+}
+
+/*---------------------------------------------------------------------------*/
+hg_return_t
+HG_Forward_timed(hg_handle_t handle, hg_cb_t callback, void *arg,
+    void *in_struct, unsigned int timeout)
+{
+    return hg_forward(handle, callback, arg, in_struct, timeout);
+}
+
+/*---------------------------------------------------------------------------*/
+hg_return_t
+HG_Forward_multi(hg_handle_t handle, hg_cb_t callback, void *arg,
+    void *in_struct, hg_addr_t *addrs, unsigned int count, unsigned int fanout)
 {
     struct hg_private_data *hg_private_data;
     struct hg_proc_info *hg_proc_info;
@@ -1665,7 +2714,7 @@ HG_Forward(hg_handle_t handle, hg_cb_t callback, void *arg, void *in_struct)
         goto done;
     }
 
-    /* Set input struct */
+    /* Set input struct once for all targets */
     ret = hg_set_struct(handle, hg_private_data, hg_proc_info, HG_INPUT,
         in_struct, &payload_size, &more_data);
     if (ret != HG_SUCCESS) {
@@ -1673,17 +2722,23 @@ HG_Forward(hg_handle_t handle, hg_cb_t callback, void *arg, void *in_struct)
         goto done;
     }
 
-    /* Set more data flag on handle so that handle_more_callback is triggered */
-    if (more_data)
-        flags |= HG_CORE_MORE_DATA;
+    /* Extra input buffer would have to be pulled from every target */
+    if (more_data) {
+        HG_LOG_ERROR("Input does not fit into input buffer");
+        HG_Bulk_free(hg_private_data->extra_bulk_handle);
+        hg_private_data->extra_bulk_handle = HG_BULK_NULL;
+        hg_free_extra_input(hg_private_data);
+        ret = HG_SIZE_ERROR;
+        goto done;
+    }
 
     /* Set no response flag if no response required */
     if (hg_proc_info->no_response)
         flags |= HG_CORE_NO_RESPONSE;
 
     /* Send request */
-    ret = HG_Core_forward(handle, hg_forward_cb, hg_private_data, flags,
-        payload_size);
+    ret = HG_Core_forward_multi(handle, hg_forward_multi_cb, hg_private_data,
+        flags, payload_size, addrs, count, fanout);
     if (ret != HG_SUCCESS) {
         HG_LOG_ERROR("Could not forward call");
         goto done;
@@ -1701,6 +2756,9 @@ HG_Respond(hg_handle_t handle, hg_cb_t callback, void *arg, void *out_struct)
     struct hg_proc_info *hg_proc_info;
     hg_size_t payload_size;
     hg_bool_t more_data = HG_FALSE;
+#ifdef HG_HAS_EAGER_BULK
+    hg_bool_t deferred = HG_FALSE;
+#endif
     hg_uint8_t flags = 0;
     hg_return_t ret = HG_SUCCESS;
 
@@ -1734,6 +2792,19 @@ HG_Respond(hg_handle_t handle, hg_cb_t callback, void *arg, void *out_struct)
     if (more_data)
         flags |= HG_CORE_MORE_DATA;
 
+#ifdef HG_HAS_EAGER_BULK
+    /* Return data pushed to eager bulk handles along with output, response
+     * may have to wait for data that did not fit to be put to the origin */
+    ret = hg_set_eager_push(handle, hg_private_data, flags, &payload_size,
+        &deferred);
+    if (ret != HG_SUCCESS) {
+        HG_LOG_ERROR("Could not set eager push data");
+        goto done;
+    }
+    if (deferred)
+        goto done;
+#endif
+
     /* Send response back */
     ret = HG_Core_respond(handle, hg_respond_cb, hg_private_data, flags,
         payload_size);
@@ -1746,6 +2817,133 @@ done:
     return ret;
 }
 
+/*---------------------------------------------------------------------------*/
+hg_return_t
+HG_Forward_iov(hg_handle_t handle, hg_cb_t callback, void *arg,
+    hg_uint32_t count, void **buf_ptrs, const hg_size_t *buf_sizes)
+{
+    struct hg_private_data *hg_private_data;
+    struct hg_proc_info *hg_proc_info;
+    hg_size_t payload_size;
+    hg_uint8_t flags = 0;
+    hg_return_t ret = HG_SUCCESS;
+
+    /* Retrieve private data */
+    hg_private_data = (struct hg_private_data *) HG_Core_get_data(handle);
+    if (!hg_private_data) {
+        HG_LOG_ERROR("Could not get private data");
+        ret = HG_PROTOCOL_ERROR;
+        goto done;
+    }
+    hg_private_data->forward_cb = callback;
+    hg_private_data->forward_arg = arg;
+
+    /* Retrieve RPC data */
+    hg_proc_info = (struct hg_proc_info *) hg_core_get_rpc_data(handle);
+    if (!hg_proc_info) {
+        HG_LOG_ERROR("Could not get proc info");
+        ret = HG_PROTOCOL_ERROR;
+        goto done;
+    }
+
+    /* Set input header, user buffers make up the payload */
+    ret = hg_set_header(handle, hg_private_data, HG_INPUT, &payload_size);
+    if (ret != HG_SUCCESS) {
+        HG_LOG_ERROR("Could not set input header");
+        goto done;
+    }
+
+    /* Set no response flag if no response required */
+    if (hg_proc_info->no_response)
+        flags |= HG_CORE_NO_RESPONSE;
+
+    /* Send request */
+    ret = HG_Core_forward_iov(handle, hg_forward_cb, hg_private_data, flags,
+        payload_size, count, buf_ptrs, buf_sizes);
+    if (ret != HG_SUCCESS) {
+        HG_LOG_ERROR("Could not forward call");
+        goto done;
+    }
+
+done:
+    return ret;
+}
+
+/*---------------------------------------------------------------------------*/
+hg_return_t
+HG_Respond_iov(hg_handle_t handle, hg_cb_t callback, void *arg,
+    hg_uint32_t count, void **buf_ptrs, const hg_size_t *buf_sizes)
+{
+    struct hg_private_data *hg_private_data;
+    struct hg_proc_info *hg_proc_info;
+    hg_size_t payload_size;
+    hg_return_t ret = HG_SUCCESS;
+
+    /* Retrieve private data */
+    hg_private_data = (struct hg_private_data *) HG_Core_get_data(handle);
+    if (!hg_private_data) {
+        HG_LOG_ERROR("Could not get private data");
+        ret = HG_PROTOCOL_ERROR;
+        goto done;
+    }
+    hg_private_data->respond_cb = callback;
+    hg_private_data->respond_arg = arg;
+
+    /* Retrieve RPC data */
+    hg_proc_info = (struct hg_proc_info *) hg_core_get_rpc_data(handle);
+    if (!hg_proc_info) {
+        HG_LOG_ERROR("Could not get proc info");
+        ret = HG_PROTOCOL_ERROR;
+        goto done;
+    }
+
+    /* Cannot respond if no_response flag set */
+    if (hg_proc_info->no_response) {
+        HG_LOG_ERROR("No output was produced on that RPC (no response)");
+        ret = HG_PROTOCOL_ERROR;
+        goto done;
+    }
+
+#ifdef HG_HAS_EAGER_BULK
+    /* Data pushed to eager bulk handles cannot be returned with user buffers */
+    if (hg_proc_get_bulk_count(hg_private_data->in_proc)) {
+        hg_proc_t proc = hg_private_data->in_proc;
+        hg_size_t offset, size;
+        hg_uint32_t i;
+
+        for (i = 0; i < hg_proc_get_bulk_count(proc); i++) {
+            if (hg_bulk_get_eager_push_range(hg_proc_get_bulk(proc, i), 0,
+                &offset, &size)) {
+                HG_LOG_ERROR("Eager push data cannot be sent with user buffers");
+                ret = HG_PROTOCOL_ERROR;
+                break;
+            }
+        }
+        hg_proc_clear_bulks(proc);
+        if (ret != HG_SUCCESS)
+            goto done;
+    }
+#endif
+
+    /* Set output header, user buffers make up the payload */
+    ret = hg_set_header(handle, hg_private_data, HG_OUTPUT, &payload_size);
+    if (ret != HG_SUCCESS) {
+        HG_LOG_ERROR("Could not set output header");
+        goto done;
+    }
+
+    /* Send response back */
+    ret = HG_Core_respond_iov(handle, hg_respond_cb, hg_private_data, 0,
+        payload_size, count, buf_ptrs, buf_sizes);
+    if (ret != HG_SUCCESS) {
+        HG_LOG_ERROR("Could not respond");
+        goto done;
+    }
+
+done:
+    return ret;
+}
+
 /*---------------------------------------------------------------------------*/
 hg_return_t
 HG_Progress(hg_context_t *context, unsigned int timeout)
@@ -1761,6 +2959,20 @@ HG_Trigger(hg_context_t *context, unsigned int timeout, unsigned int max_count,
     return HG_Core_trigger(context, timeout, max_count, actual_count);
 }
 
+/*---------------------------------------------------------------------------*/
+hg_return_t
+HG_Progress_stats_get(hg_context_t *context, struct hg_progress_stats *stats)
+{
+    return HG_Core_progress_stats_get(context, stats);
+}
+
+/*---------------------------------------------------------------------------*/
+hg_return_t
+HG_Progress_stats_reset(hg_context_t *context)
+{
+    return HG_Core_progress_stats_reset(context);
+}
+
 /*---------------------------------------------------------------------------*/
 hg_return_t
 HG_Cancel(hg_handle_t handle)
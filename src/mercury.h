@@ -287,6 +287,69 @@ HG_Context_set_data(
         void (*free_callback)(void *)
         );
 
+/**
+ * Run RPC callbacks of handles received on context on thread_count handler
+ * threads instead of the thread calling HG_Trigger(), so that a slow RPC
+ * callback does not delay progress and other RPCs. Handler threads keep one
+ * queue per thread and steal queued RPCs from each other when idle.
+ * Forward, respond and bulk callbacks are still run by HG_Trigger(). Passing
+ * 0 (default) runs all callbacks inline. RPC callbacks already posted are run
+ * before previous handler threads exit. May be called while other threads
+ * make progress, but not from an RPC callback run by a handler thread. See
+ * also HG_Registered_handler_hints().
+ *
+ * \param context [IN]          pointer to HG context
+ * \param thread_count [IN]     number of handler threads
+ *
+ * \return HG_SUCCESS or corresponding HG error code
+ */
+HG_EXPORT hg_return_t
+HG_Context_set_handler_threads(
+        hg_context_t *context,
+        unsigned int thread_count
+        );
+
+/**
+ * Coalesce small forwards issued on context to the same target into a single
+ * message. A forward is held for up to window ms (or until the next
+ * HG_Progress() call if window is 0) so that other forwards to that target
+ * can be packed with it, the message is sent earlier if it reaches the max
+ * unexpected size. Each forward still gets its own response. Disabled by
+ * default.
+ *
+ * \param context [IN]          pointer to HG context
+ * \param enable [IN]           boolean
+ * \param window [IN]           max time forwards are held (in milliseconds)
+ *
+ * \return HG_SUCCESS or corresponding HG error code
+ */
+HG_EXPORT hg_return_t
+HG_Context_set_coalescing(
+        hg_context_t *context,
+        hg_bool_t enable,
+        unsigned int window
+        );
+
+/**
+ * Limit the number of received RPCs of a given priority class that may wait
+ * on context to be run. RPCs received beyond that limit are not run but
+ * answered right away with HG_BUSY (or dropped if they expect no response).
+ * HG_HANDLER_HIGH RPCs form one class, HG_HANDLER_NORMAL and
+ * HG_HANDLER_INLINE RPCs the other. Passing 0 (default) removes the limit.
+ *
+ * \param context [IN]          pointer to HG context
+ * \param priority [IN]         handler priority of RPCs to limit
+ * \param limit [IN]            max number of RPCs waiting to be run
+ *
+ * \return HG_SUCCESS or corresponding HG error code
+ */
+HG_EXPORT hg_return_t
+HG_Context_set_queue_limit(
+        hg_context_t *context,
+        hg_handler_priority_t priority,
+        unsigned int limit
+        );
+
 /**
  * Retrieve previously associated data from a given context.
  *
@@ -435,10 +498,188 @@ HG_Registered_disable_response(
         hg_bool_t disable
         );
 
+/**
+ * Enable compact encoding of input and output arguments for a given RPC ID.
+ * Integers (16, 32 and 64-bit) are then encoded as LEB128 varints (zigzag
+ * encoded for signed types), which also applies to the length prefix of
+ * strings and arrays, so that payloads of mostly small values take less
+ * space and are more likely to fit into the eager buffer. Compact encoding
+ * must be enabled on both origin and target, and is ignored when XDR is used.
+ * By default, integers are encoded at full width.
+ *
+ * \param hg_class [IN]         pointer to HG class
+ * \param id [IN]               registered function ID
+ * \param enable [IN]           boolean (HG_TRUE to enable
+ *                                       HG_FALSE to disable)
+ *
+ * \return HG_SUCCESS or corresponding HG error code
+ */
+HG_EXPORT hg_return_t
+HG_Registered_compact_encoding(
+        hg_class_t *hg_class,
+        hg_id_t id,
+        hg_bool_t enable
+        );
+
+/**
+ * Enable compression of input arguments for a given RPC ID. When the encoded
+ * input does not fit into the eager buffer and exceeds the compression
+ * threshold (MERCURY_COMPRESSION_THRESHOLD), the extra buffer that is pulled
+ * by the target is compressed before being exposed and decompressed on the
+ * target before being decoded. Buffers that do not shrink are sent as is.
+ * Compression must be enabled on both origin and target and requires mercury
+ * to be built with MERCURY_USE_COMPRESSION, HG_INVALID_PARAM is returned
+ * otherwise. By default, compression is disabled.
+ *
+ * \param hg_class [IN]         pointer to HG class
+ * \param id [IN]               registered function ID
+ * \param enable [IN]           boolean (HG_TRUE to enable
+ *                                       HG_FALSE to disable)
+ *
+ * \return HG_SUCCESS or corresponding HG error code
+ */
+HG_EXPORT hg_return_t
+HG_Registered_compress(
+        hg_class_t *hg_class,
+        hg_id_t id,
+        hg_bool_t enable
+        );
+
+/**
+ * Let read/write bulk handles of at most MERCURY_EAGER_PUSH_SIZE bytes that
+ * are sent with the input of a given RPC ID have their pushed data returned
+ * with the response, as write only handles do. The content of these handles
+ * is then encoded with the input so that the target has a complete copy,
+ * which grows the request. Only the origin needs to enable it and mercury
+ * must be built with MERCURY_USE_EAGER_BULK, HG_INVALID_PARAM is returned
+ * otherwise. By default, read/write handles are transferred through bulk.
+ *
+ * \param hg_class [IN]         pointer to HG class
+ * \param id [IN]               registered function ID
+ * \param enable [IN]           boolean (HG_TRUE to enable
+ *                                       HG_FALSE to disable)
+ *
+ * \return HG_SUCCESS or corresponding HG error code
+ */
+HG_EXPORT hg_return_t
+HG_Registered_eager_push_rw(
+        hg_class_t *hg_class,
+        hg_id_t id,
+        hg_bool_t enable
+        );
+
+/**
+ * Set handler hints for a given RPC ID. HG_HANDLER_HIGH RPCs are run before
+ * queued HG_HANDLER_NORMAL RPCs, by HG_Trigger() as well as by handler threads
+ * if the context has any (see HG_Context_set_handler_threads()),
+ * HG_HANDLER_INLINE RPCs are run by the thread calling HG_Trigger(). See also
+ * HG_Context_set_queue_limit(). affinity selects the handler thread
+ * (modulo the number of threads) that RPCs are queued to, so that RPCs
+ * sharing state can be run by the same thread; idle threads may still steal
+ * them. By default, RPCs have HG_HANDLER_NORMAL priority and
+ * HG_HANDLER_ANY_THREAD affinity.
+ *
+ * \param hg_class [IN]         pointer to HG class
+ * \param id [IN]               registered function ID
+ * \param priority [IN]         handler priority
+ * \param affinity [IN]         handler thread index or HG_HANDLER_ANY_THREAD
+ *
+ * \return HG_SUCCESS or corresponding HG error code
+ */
+HG_EXPORT hg_return_t
+HG_Registered_handler_hints(
+        hg_class_t *hg_class,
+        hg_id_t id,
+        hg_handler_priority_t priority,
+        unsigned int affinity
+        );
+
+/**
+ * Get stats collected for a given context and RPC ID: forward, receive and
+ * response counts, and latency histograms of the time spent by received RPCs
+ * in the completion queue, of the time spent in the RPC callback until the
+ * response is sent, and of the time between HG_Forward() and the forward
+ * callback on the origin. Passing a NULL context merges stats of all the
+ * contexts of the class (including destroyed ones), passing HG_STATS_ANY
+ * merges stats of all RPC IDs (including bulk transfers). Requires mercury to
+ * be built with MERCURY_ENABLE_STATS, HG_INVALID_PARAM is returned otherwise.
+ *
+ * \param hg_class [IN]         pointer to HG class
+ * \param context [IN]          pointer to HG context
+ * \param id [IN]               registered function ID
+ * \param stats [OUT]           pointer to returned stats
+ *
+ * \return HG_SUCCESS or corresponding HG error code
+ */
+HG_EXPORT hg_return_t
+HG_Stats_get(
+        hg_class_t *hg_class,
+        hg_context_t *context,
+        hg_id_t id,
+        struct hg_stats *stats
+        );
+
+/**
+ * Reset stats collected for a given context and RPC ID. NULL context and
+ * HG_STATS_ANY can be passed as for HG_Stats_get().
+ *
+ * \param hg_class [IN]         pointer to HG class
+ * \param context [IN]          pointer to HG context
+ * \param id [IN]               registered function ID
+ *
+ * \return HG_SUCCESS or corresponding HG error code
+ */
+HG_EXPORT hg_return_t
+HG_Stats_reset(
+        hg_class_t *hg_class,
+        hg_context_t *context,
+        hg_id_t id
+        );
+
+/**
+ * Get an upper bound of the value below which a given percentage of the
+ * samples of a stats histogram fall. The bound is within 25% of the actual
+ * value.
+ *
+ * \param hist [IN]             pointer to stats histogram
+ * \param percentile [IN]       percentile (between 0 and 100)
+ *
+ * \return Value in microseconds
+ */
+HG_EXPORT hg_uint64_t
+HG_Stats_percentile(
+        const struct hg_stats_hist *hist,
+        double percentile
+        );
+
+/**
+ * Dump trace events recorded by all threads to file. Each thread records
+ * handle creation, forward, NA send post and completion, request and
+ * response reception, trigger, RPC callback entry and exit, response and
+ * bulk transfer start and completion into a ring of the last
+ * MERCURY_TRACE_RING_SIZE events. Events are also dumped at exit to the file
+ * named by the HG_TRACE_FILE environment variable if set. Dump files can be
+ * converted to Chrome trace JSON format (chrome://tracing or Perfetto) with
+ * the hg_trace2json tool. Requires mercury to be built with
+ * MERCURY_ENABLE_TRACE, HG_INVALID_PARAM is returned otherwise.
+ *
+ * \param filename [IN]         file name
+ *
+ * \return HG_SUCCESS or corresponding HG error code
+ */
+HG_EXPORT hg_return_t
+HG_Trace_dump(
+        const char *filename
+        );
+
 /**
  * Lookup an addr from a peer address/name. Addresses need to be
  * freed by calling HG_Addr_free(). After completion, user callback is
  * placed into a completion queue and can be triggered using HG_Trigger().
+ * If the class was initialized with addr_cache set, lookups of a name that
+ * was already resolved return the same (reference counted) addr, concurrent
+ * lookups of the same name are completed by a single lookup, and failed
+ * lookups keep failing with the same error for addr_cache_neg_ttl ms.
  *
  * \param context [IN]          pointer to context of execution
  * \param callback [IN]         pointer to function callback
@@ -457,6 +698,35 @@ HG_Addr_lookup(
         hg_op_id_t   *op_id
         );
 
+/**
+ * Lookup count addrs at once. All the lookups are started before progress is
+ * made so that connection setup with each peer proceeds concurrently, and a
+ * single user callback is placed into the completion queue once all of them
+ * have completed. On completion addrs[i] holds the addr of names[i] or
+ * HG_ADDR_NULL if that lookup failed, in which case the callback's ret is set
+ * to the first error encountered. Addrs need to be freed by calling
+ * HG_Addr_free(). The addrs array must remain valid until the callback is
+ * triggered, the addr passed to the callback is HG_ADDR_NULL.
+ *
+ * \param context [IN]          pointer to context of execution
+ * \param callback [IN]         pointer to function callback
+ * \param arg [IN]              pointer to data passed to callback
+ * \param names [IN]            array of lookup names
+ * \param count [IN]            number of names
+ * \param addrs [OUT]           array of count returned addrs
+ *
+ * \return HG_SUCCESS or corresponding HG error code
+ */
+HG_EXPORT hg_return_t
+HG_Addr_lookup_batch(
+        hg_context_t      *context,
+        hg_cb_t            callback,
+        void              *arg,
+        const char *const  names[],
+        unsigned int       count,
+        hg_addr_t          addrs[]
+        );
+
 /**
  * Free the addr from the list of peers.
  *
@@ -471,6 +741,23 @@ HG_Addr_free(
         hg_addr_t   addr
         );
 
+/**
+ * Remove name from the addr cache so that the next HG_Addr_lookup() of name
+ * issues a new lookup, passing NULL removes all the entries. Addrs that were
+ * already returned remain valid until freed. Does nothing if the addr cache
+ * is not enabled.
+ *
+ * \param hg_class [IN]         pointer to HG class
+ * \param name [IN]             lookup name
+ *
+ * \return HG_SUCCESS or corresponding HG error code
+ */
+HG_EXPORT hg_return_t
+HG_Addr_cache_invalidate(
+        hg_class_t *hg_class,
+        const char *name
+        );
+
 /**
  * Access self address. Address must be freed with HG_Addr_free().
  *
@@ -579,6 +866,23 @@ HG_Reset(
         hg_id_t id
         );
 
+/**
+ * Prepare an existing HG handle for forwarding the same RPC to the same
+ * target repeatedly. Address, RPC info and proc callbacks are already
+ * resolved by the handle, the request header is in addition encoded once and
+ * kept, so that following calls to HG_Forward() only encode the input
+ * struct. A prepared handle can be forwarded again once the callback of its
+ * previous forward has been triggered, without calling HG_Reset().
+ *
+ * \param handle [IN]           HG handle
+ *
+ * \return HG_SUCCESS or corresponding HG error code
+ */
+HG_EXPORT hg_return_t
+HG_Prepare(
+        hg_handle_t handle
+        );
+
 /**
  * Increment ref count on handle.
  *
@@ -739,6 +1043,8 @@ HG_Set_target_id(
  * registered input proc. After completion, user callback is placed into a
  * completion queue and can be triggered using HG_Trigger(). RPC output can
  * be queried using HG_Get_output() and freed using HG_Free_output().
+ * Each target tells in its responses how many calls it can take from us,
+ * calls beyond that are queued locally and sent when earlier calls complete.
  *
  * \remark This routine is internally equivalent to:
  *   - HG_Core_get_input()
@@ -760,6 +1066,65 @@ HG_Forward(
         void *in_struct
         );
 
+/**
+ * Forward a call to a local/remote target using an existing HG handle, see
+ * HG_Forward(). If no response was received after timeout ms, the call is
+ * canceled and the user callback is triggered with HG_TIMEOUT. Deadlines of
+ * all outstanding calls are kept in a timer wheel of the context and checked
+ * during HG_Progress(), at constant cost per call. A timeout of 0 is
+ * equivalent to HG_Forward().
+ *
+ * \param handle [IN]           HG handle
+ * \param callback [IN]         pointer to function callback
+ * \param arg [IN]              pointer to data passed to callback
+ * \param in_struct [IN]        pointer to input structure
+ * \param timeout [IN]          timeout (in milliseconds)
+ *
+ * \return HG_SUCCESS or corresponding HG error code
+ */
+HG_EXPORT hg_return_t
+HG_Forward_timed(
+        hg_handle_t handle,
+        hg_cb_t callback,
+        void *arg,
+        void *in_struct,
+        unsigned int timeout
+        );
+
+/**
+ * Forward the same call to count local/remote targets using an existing HG
+ * handle, whose addr is not used. The input structure is serialized once and
+ * the resulting buffer is sent to every target. If fanout is 0 or not less
+ * than count, all targets are sent the call directly, otherwise the call is
+ * only sent to fanout targets, which forward it again to their own part of
+ * the remaining targets (k-ary tree) so that the origin does not send count
+ * messages; targets respond once their subtree has responded. The user
+ * callback is triggered once after all targets are done, with the first
+ * error returned by any of them, HG_Get_output() cannot be used on handle.
+ * Serialized input (and addr names of a subtree when fanout is used) must
+ * fit into the buffer returned by HG_Get_input_buf().
+ *
+ * \param handle [IN]           HG handle
+ * \param callback [IN]         pointer to function callback
+ * \param arg [IN]              pointer to data passed to callback
+ * \param in_struct [IN]        pointer to input structure
+ * \param addrs [IN]            array of target addrs
+ * \param count [IN]            number of addrs
+ * \param fanout [IN]           number of children per node (0 if flat)
+ *
+ * \return HG_SUCCESS or corresponding HG error code
+ */
+HG_EXPORT hg_return_t
+HG_Forward_multi(
+        hg_handle_t handle,
+        hg_cb_t callback,
+        void *arg,
+        void *in_struct,
+        hg_addr_t *addrs,
+        unsigned int count,
+        unsigned int fanout
+        );
+
 /**
  * Respond back to origin using an existing HG handle.
  * Output structure can be passed and parameters serialized using a previously
@@ -786,6 +1151,59 @@ HG_Respond(
         void *out_struct
         );
 
+/**
+ * Forward a call to a local/remote target using an existing HG handle,
+ * sending the count buffers described by buf_ptrs and buf_sizes as the
+ * payload instead of serializing an input structure. Buffers are not copied
+ * into the input buffer when the NA plugin supports it, they must therefore
+ * remain valid until the user callback is triggered. The total size must not
+ * exceed the size of the buffer returned by HG_Get_input_buf(), which the
+ * target can then use to access the payload.
+ *
+ * \param handle [IN]           HG handle
+ * \param callback [IN]         pointer to function callback
+ * \param arg [IN]              pointer to data passed to callback
+ * \param count [IN]            number of buffers
+ * \param buf_ptrs [IN]         array of pointers
+ * \param buf_sizes [IN]        array of sizes
+ *
+ * \return HG_SUCCESS or corresponding HG error code
+ */
+HG_EXPORT hg_return_t
+HG_Forward_iov(
+        hg_handle_t handle,
+        hg_cb_t callback,
+        void *arg,
+        hg_uint32_t count,
+        void **buf_ptrs,
+        const hg_size_t *buf_sizes
+        );
+
+/**
+ * Respond back to origin using an existing HG handle, sending the count
+ * buffers described by buf_ptrs and buf_sizes as the payload instead of
+ * serializing an output structure. See HG_Forward_iov() for buffer semantics,
+ * the origin can access the payload with HG_Get_output_buf().
+ *
+ * \param handle [IN]           HG handle
+ * \param callback [IN]         pointer to function callback
+ * \param arg [IN]              pointer to data passed to callback
+ * \param count [IN]            number of buffers
+ * \param buf_ptrs [IN]         array of pointers
+ * \param buf_sizes [IN]        array of sizes
+ *
+ * \return HG_SUCCESS or corresponding HG error code
+ */
+HG_EXPORT hg_return_t
+HG_Respond_iov(
+        hg_handle_t handle,
+        hg_cb_t callback,
+        void *arg,
+        hg_uint32_t count,
+        void **buf_ptrs,
+        const hg_size_t *buf_sizes
+        );
+
 /**
  * Try to progress RPC execution for at most timeout until timeout is reached or
  * any completion has occurred.
@@ -824,6 +1242,38 @@ HG_Trigger(
         unsigned int *actual_count
         );
 
+/**
+ * Get progress accounting of a context, to tell whether progress threads are
+ * saturated or spinning: number of and time spent in HG_Progress() calls, and
+ * how much of that was spent in calls that did not progress anything, time
+ * blocked in system poll calls (e.g., epoll_wait()), in NA plugin progress and
+ * in NA callbacks, and number of and time spent in callbacks executed by
+ * HG_Trigger(). Requires mercury to be built with MERCURY_ENABLE_STATS,
+ * HG_INVALID_PARAM is returned otherwise.
+ *
+ * \param context [IN]          pointer to HG context
+ * \param stats [OUT]           pointer to returned stats
+ *
+ * \return HG_SUCCESS or corresponding HG error code
+ */
+HG_EXPORT hg_return_t
+HG_Progress_stats_get(
+        hg_context_t *context,
+        struct hg_progress_stats *stats
+        );
+
+/**
+ * Reset progress accounting of a context.
+ *
+ * \param context [IN]          pointer to HG context
+ *
+ * \return HG_SUCCESS or corresponding HG error code
+ */
+HG_EXPORT hg_return_t
+HG_Progress_stats_reset(
+        hg_context_t *context
+        );
+
 /**
  * Cancel an ongoing operation.
  *
@@ -12,6 +12,7 @@
 #include "mercury_core.h"
 #include "mercury_private.h"
 #include "mercury_error.h"
+#include "mercury_trace.h"
 
 #include "na_private.h"
 
@@ -65,6 +66,12 @@ struct hg_bulk_segment {
     hg_size_t size;   /* size of the segment in bytes */
 };
 
+/* Range of data pushed to an eager push handle */
+struct hg_bulk_push_range {
+    hg_size_t offset; /* offset of the range in the region */
+    hg_size_t size;   /* size of the range in bytes */
+};
+
 /* Wrapper on top of NA layer */
 typedef na_return_t (*na_bulk_op_t)(
         na_class_t      *na_class,
@@ -96,7 +103,10 @@ struct hg_bulk {
     hg_bool_t segment_published;         /* NA memory handles published */
     hg_bool_t segment_alloc;             /* Allocated memory to mirror data */
     hg_uint8_t flags;                    /* Permission flags */
-    hg_bool_t eager_mode;                /* Eager transfer */
+    hg_uint8_t eager_mode;               /* Eager transfer flags */
+    struct hg_bulk_push_range *push_ranges; /* Sorted ranges pushed (eager) */
+    hg_uint32_t push_count;              /* Number of ranges pushed */
+    hg_uint32_t push_max;                /* Size of push_ranges array */
     hg_atomic_int32_t ref_count;         /* Reference count */
 };
 
@@ -132,6 +142,50 @@ hg_bulk_free(
         struct hg_bulk *hg_bulk
         );
 
+/**
+ * Get eager flags that can be used for serializing handle.
+ */
+static HG_INLINE hg_uint8_t
+hg_bulk_get_eager_mode(
+        struct hg_bulk *hg_bulk,
+        hg_uint8_t request_eager
+        );
+
+/**
+ * Record range of data pushed to handle in eager push mode.
+ */
+static hg_return_t
+hg_bulk_add_eager_push_range(
+        struct hg_bulk *hg_bulk,
+        hg_size_t offset,
+        hg_size_t size
+        );
+
+/**
+ * Get index-th range of data pushed to handle in eager push mode.
+ */
+hg_bool_t
+hg_bulk_get_eager_push_range(
+        struct hg_bulk *hg_bulk,
+        hg_uint32_t index,
+        hg_size_t *offset,
+        hg_size_t *size
+        );
+
+/**
+ * Put data pushed to handle in eager push mode to origin memory. Callback is
+ * called once per range and count is set to the number of ranges put.
+ */
+hg_return_t
+hg_bulk_eager_push_flush(
+        hg_context_t *context,
+        struct hg_addr *origin_addr,
+        struct hg_bulk *hg_bulk,
+        hg_cb_t callback,
+        void *arg,
+        hg_uint32_t *count
+        );
+
 /**
  * Get info for bulk transfer.
  */
@@ -605,12 +659,172 @@ hg_bulk_free(struct hg_bulk *hg_bulk)
         }
     }
     free(hg_bulk->segments);
+    free(hg_bulk->push_ranges);
     free(hg_bulk);
 
 done:
     return ret;
 }
 
+/*---------------------------------------------------------------------------*/
+static HG_INLINE hg_uint8_t
+hg_bulk_get_eager_mode(struct hg_bulk *hg_bulk, hg_uint8_t request_eager)
+{
+    hg_uint8_t eager_mode = 0;
+
+    /* Pushed data can be returned with the response if region is small, data
+     * of read/write regions must also be sent so that the target has a
+     * complete local copy, which grows the request and must be asked for */
+    if ((request_eager & HG_BULK_EAGER_PUSH) && !hg_bulk->eager_mode
+        && hg_bulk->total_size <= HG_EAGER_PUSH_SIZE
+        && ((hg_bulk->flags == HG_BULK_WRITE_ONLY)
+            || (hg_bulk->flags == HG_BULK_READWRITE
+                && (request_eager & HG_BULK_EAGER_PUSH_RW)
+                && (request_eager & HG_BULK_EAGER))))
+        eager_mode |= HG_BULK_EAGER_PUSH;
+
+    /* Data is only serialized for HG_BULK_READ_ONLY and eager push regions */
+    if ((request_eager & HG_BULK_EAGER)
+        && ((hg_bulk->flags == HG_BULK_READ_ONLY)
+            || (hg_bulk->flags == HG_BULK_READWRITE
+                && (eager_mode & HG_BULK_EAGER_PUSH))))
+        eager_mode |= HG_BULK_EAGER;
+
+    return eager_mode;
+}
+
+/*---------------------------------------------------------------------------*/
+static hg_return_t
+hg_bulk_add_eager_push_range(struct hg_bulk *hg_bulk, hg_size_t offset,
+    hg_size_t size)
+{
+    struct hg_bulk_push_range *ranges = hg_bulk->push_ranges;
+    hg_size_t end = offset + size;
+    hg_uint32_t first, last;
+    hg_return_t ret = HG_SUCCESS;
+
+    if (!size)
+        goto done;
+
+    /* Ranges are kept sorted and disjoint, find the ones that overlap or
+     * touch [offset, end) so that they can be merged */
+    for (first = 0; first < hg_bulk->push_count
+        && ranges[first].offset + ranges[first].size < offset; first++)
+        continue;
+    for (last = first; last < hg_bulk->push_count
+        && ranges[last].offset <= end; last++)
+        continue;
+
+    if (first < last) {
+        hg_size_t last_end = ranges[last - 1].offset + ranges[last - 1].size;
+
+        ranges[first].offset = HG_BULK_MIN(ranges[first].offset, offset);
+        ranges[first].size = ((last_end > end) ? last_end : end)
+            - ranges[first].offset;
+        memmove(&ranges[first + 1], &ranges[last],
+            (hg_bulk->push_count - last) * sizeof(*ranges));
+        hg_bulk->push_count -= last - first - 1;
+        goto done;
+    }
+
+    /* Insert new range */
+    if (hg_bulk->push_count == hg_bulk->push_max) {
+        hg_uint32_t new_max = (hg_bulk->push_max) ? 2 * hg_bulk->push_max : 4;
+
+        ranges = (struct hg_bulk_push_range *) realloc(ranges,
+            new_max * sizeof(*ranges));
+        if (!ranges) {
+            HG_LOG_ERROR("Could not allocate push ranges");
+            ret = HG_NOMEM_ERROR;
+            goto done;
+        }
+        hg_bulk->push_ranges = ranges;
+        hg_bulk->push_max = new_max;
+    }
+    memmove(&ranges[first + 1], &ranges[first],
+        (hg_bulk->push_count - first) * sizeof(*ranges));
+    ranges[first].offset = offset;
+    ranges[first].size = size;
+    hg_bulk->push_count++;
+
+done:
+    return ret;
+}
+
+/*---------------------------------------------------------------------------*/
+hg_bool_t
+hg_bulk_get_eager_push_range(struct hg_bulk *hg_bulk, hg_uint32_t index,
+    hg_size_t *offset, hg_size_t *size)
+{
+    if (!(hg_bulk->eager_mode & HG_BULK_EAGER_PUSH)
+        || index >= hg_bulk->push_count)
+        return HG_FALSE;
+
+    *offset = hg_bulk->push_ranges[index].offset;
+    *size = hg_bulk->push_ranges[index].size;
+
+    return HG_TRUE;
+}
+
+/*---------------------------------------------------------------------------*/
+hg_return_t
+hg_bulk_eager_push_flush(hg_context_t *context, struct hg_addr *origin_addr,
+    struct hg_bulk *hg_bulk, hg_cb_t callback, void *arg, hg_uint32_t *count)
+{
+    struct hg_bulk *hg_bulk_local = NULL;
+    void **buf_ptrs = NULL;
+    hg_size_t *buf_sizes = NULL;
+    hg_uint32_t i;
+    hg_return_t ret = HG_SUCCESS;
+
+    *count = 0;
+    if (!(hg_bulk->eager_mode & HG_BULK_EAGER_PUSH) || !hg_bulk->push_count)
+        goto done;
+
+    /* Register the local mirror so that it can be used as source of a put,
+     * both handles have the same layout */
+    buf_ptrs = (void **) malloc(hg_bulk->segment_count * sizeof(void *));
+    buf_sizes = (hg_size_t *) malloc(hg_bulk->segment_count * sizeof(hg_size_t));
+    if (!buf_ptrs || !buf_sizes) {
+        HG_LOG_ERROR("Could not allocate segment arrays");
+        ret = HG_NOMEM_ERROR;
+        goto done;
+    }
+    for (i = 0; i < hg_bulk->segment_count; i++) {
+        buf_ptrs[i] = (void *) hg_bulk->segments[i].address;
+        buf_sizes[i] = hg_bulk->segments[i].size;
+    }
+    ret = hg_bulk_create(hg_bulk->hg_class, hg_bulk->segment_count, buf_ptrs,
+        buf_sizes, HG_BULK_READ_ONLY, &hg_bulk_local);
+    if (ret != HG_SUCCESS) {
+        HG_LOG_ERROR("Could not create bulk handle");
+        goto done;
+    }
+
+    /* Origin memory is accessed directly from now on, mirror segments are
+     * kept alive by the references that transfers hold on the handle */
+    hg_bulk->eager_mode = 0;
+    for (i = 0; i < hg_bulk->push_count; i++) {
+        ret = hg_bulk_transfer(context, callback, arg, HG_BULK_PUSH,
+            origin_addr, hg_bulk, hg_bulk->push_ranges[i].offset,
+            hg_bulk_local, hg_bulk->push_ranges[i].offset,
+            hg_bulk->push_ranges[i].size, HG_OP_ID_IGNORE);
+        if (ret != HG_SUCCESS) {
+            HG_LOG_ERROR("Could not put eager push data");
+            break;
+        }
+        (*count)++;
+    }
+    hg_bulk->push_count = 0;
+
+done:
+    if (hg_bulk_local)
+        hg_bulk_free(hg_bulk_local);
+    free(buf_ptrs);
+    free(buf_sizes);
+    return ret;
+}
+
 /*---------------------------------------------------------------------------*/
 static HG_INLINE void
 hg_bulk_offset_translate(struct hg_bulk *hg_bulk, hg_size_t offset,
@@ -842,26 +1056,38 @@ hg_bulk_transfer(hg_context_t *context, hg_cb_t callback, void *arg,
 #endif
     na_class_t *na_origin_addr_class = HG_Core_addr_get_na_class(origin_addr);
     hg_bool_t is_self = NA_Addr_is_self(na_origin_addr_class, na_origin_addr);
-    hg_bool_t scatter_gather =
-        (na_class->mem_handle_create_segments && !is_self) ? HG_TRUE : HG_FALSE;
+    hg_bool_t use_memcpy = is_self;
+    hg_bool_t scatter_gather;
     hg_return_t ret = HG_SUCCESS;
     unsigned int i;
 
     /* Map op to NA op */
     switch (op) {
         case HG_BULK_PUSH:
-            na_bulk_op = (is_self) ? hg_bulk_memcpy_put : hg_bulk_na_put;
+            /* In eager push mode, data is copied to the local mirror of the
+             * origin region and sent back with the response */
+            if (hg_bulk_origin->eager_mode & HG_BULK_EAGER_PUSH) {
+                ret = hg_bulk_add_eager_push_range(hg_bulk_origin,
+                    origin_offset, size);
+                if (ret != HG_SUCCESS)
+                    goto done;
+                use_memcpy = HG_TRUE;
+            }
+            na_bulk_op = (use_memcpy) ? hg_bulk_memcpy_put : hg_bulk_na_put;
             break;
         case HG_BULK_PULL:
             /* Eager mode can only be used when data is pulled from origin */
-            na_bulk_op = (is_self || hg_bulk_origin->eager_mode) ?
-                hg_bulk_memcpy_get : hg_bulk_na_get;
+            if (hg_bulk_origin->eager_mode & HG_BULK_EAGER)
+                use_memcpy = HG_TRUE;
+            na_bulk_op = (use_memcpy) ? hg_bulk_memcpy_get : hg_bulk_na_get;
             break;
         default:
             HG_LOG_ERROR("Unknown bulk operation");
             ret = HG_INVALID_PARAM;
             goto done;
     }
+    scatter_gather = (na_class->mem_handle_create_segments && !use_memcpy) ?
+        HG_TRUE : HG_FALSE;
 
     /* Allocate op_id */
     hg_bulk_op_id = (struct hg_bulk_op_id *) malloc(
@@ -937,6 +1163,7 @@ hg_bulk_transfer(hg_context_t *context, hg_cb_t callback, void *arg,
     if (op_id && op_id != HG_OP_ID_IGNORE) *op_id = (hg_op_id_t) hg_bulk_op_id;
 
     /* Do actual transfer */
+    HG_TRACE(HG_TRACE_BULK_START, hg_bulk_op_id, 0, size);
     ret = hg_bulk_transfer_pieces(na_bulk_op, na_origin_addr, use_sm,
         hg_bulk_origin, origin_segment_start_index, origin_segment_start_offset,
         hg_bulk_local, local_segment_start_index, local_segment_start_offset,
@@ -963,6 +1190,8 @@ hg_bulk_complete(struct hg_bulk_op_id *hg_bulk_op_id)
 
     /* Mark operation as completed */
     hg_atomic_incr32(&hg_bulk_op_id->completed);
+    HG_TRACE(HG_TRACE_BULK_COMPLETE, hg_bulk_op_id, 0,
+        hg_atomic_get32(&hg_bulk_op_id->canceled));
 
     if (hg_bulk_op_id->hg_bulk_origin->eager_mode) {
         /* In the case of eager bulk transfer, directly trigger the operation
@@ -1190,7 +1419,7 @@ done:
 
 /*---------------------------------------------------------------------------*/
 hg_size_t
-HG_Bulk_get_serialize_size(hg_bulk_t handle, hg_bool_t request_eager)
+HG_Bulk_get_serialize_size(hg_bulk_t handle, hg_uint8_t request_eager)
 {
     struct hg_bulk *hg_bulk = (struct hg_bulk *) handle;
     hg_size_t ret = 0;
@@ -1231,7 +1460,7 @@ HG_Bulk_get_serialize_size(hg_bulk_t handle, hg_bool_t request_eager)
 
     /* Eager mode */
     ret += sizeof(hg_bulk->eager_mode);
-    if (request_eager && (hg_bulk->flags == HG_BULK_READ_ONLY))
+    if (hg_bulk_get_eager_mode(hg_bulk, request_eager) & HG_BULK_EAGER)
         ret += hg_bulk->total_size;
 
 done:
@@ -1240,14 +1469,14 @@ done:
 
 /*---------------------------------------------------------------------------*/
 hg_return_t
-HG_Bulk_serialize(void *buf, hg_size_t buf_size, hg_bool_t request_eager,
+HG_Bulk_serialize(void *buf, hg_size_t buf_size, hg_uint8_t request_eager,
     hg_bulk_t handle)
 {
     struct hg_bulk *hg_bulk = (struct hg_bulk *) handle;
     char *buf_ptr = (char *) buf;
     ssize_t buf_size_left = (ssize_t) buf_size;
     hg_return_t ret = HG_SUCCESS;
-    hg_bool_t eager_mode;
+    hg_uint8_t eager_mode;
     na_class_t *na_class;
 #ifdef HG_HAS_SM_ROUTING
     na_class_t *na_sm_class;
@@ -1391,17 +1620,17 @@ HG_Bulk_serialize(void *buf, hg_size_t buf_size, hg_bool_t request_eager,
 #endif
     }
 
-    /* Eager mode is used only when data is set to HG_BULK_READ_ONLY */
-    eager_mode = (request_eager && (hg_bulk->flags == HG_BULK_READ_ONLY));
+    /* Eager mode depends on permission flags and size of region */
+    eager_mode = hg_bulk_get_eager_mode(hg_bulk, request_eager);
     ret = hg_bulk_serialize_memcpy(&buf_ptr, &buf_size_left, &eager_mode,
         sizeof(eager_mode));
     if (ret != HG_SUCCESS) {
-        HG_LOG_ERROR("Could not encode eager_mode bool");
+        HG_LOG_ERROR("Could not encode eager_mode flags");
         goto done;
     }
 
     /* Add the serialized data */
-    if (eager_mode) {
+    if (eager_mode & HG_BULK_EAGER) {
         for (i = 0; i < hg_bulk->segment_count; i++) {
             if (!hg_bulk->segments[i].size)
                 continue;
@@ -1582,11 +1811,12 @@ HG_Bulk_deserialize(hg_class_t *hg_class, hg_bulk_t *handle, const void *buf,
     ret = hg_bulk_deserialize_memcpy(&buf_ptr, &buf_size_left,
         &hg_bulk->eager_mode, sizeof(hg_bulk->eager_mode));
     if (ret != HG_SUCCESS) {
-        HG_LOG_ERROR("Could not decode eager_mode bool");
+        HG_LOG_ERROR("Could not decode eager_mode flags");
         goto done;
     }
 
-    /* Get the serialized data */
+    /* Get the serialized data, in eager push mode, memory is allocated to
+     * mirror the origin region so that pushed data can be copied locally */
     if (hg_bulk->eager_mode) {
         hg_bulk->segment_alloc = HG_TRUE;
         for (i = 0; i < hg_bulk->segment_count; i++) {
@@ -1601,6 +1831,8 @@ HG_Bulk_deserialize(hg_class_t *hg_class, hg_bulk_t *handle, const void *buf,
                 ret = HG_NOMEM_ERROR;
                 goto done;
             }
+            if (!(hg_bulk->eager_mode & HG_BULK_EAGER))
+                continue;
             ret = hg_bulk_deserialize_memcpy(&buf_ptr, &buf_size_left,
                 (void *) hg_bulk->segments[i].address,
                 hg_bulk->segments[i].size);
@@ -133,16 +133,16 @@ HG_Bulk_get_segment_count(
  * Get size required to serialize bulk handle.
  *
  * \param handle [IN]           abstract bulk handle
- * \param request_eager [IN]    boolean (passing HG_TRUE adds size of encoding
- *                              actual data along the handle if handle meets
- *                              HG_BULK_READ_ONLY flag condition)
+ * \param request_eager [IN]    eager flags (see HG_Bulk_serialize(), passing
+ *                              HG_BULK_EAGER adds size of encoding actual data
+ *                              along the handle if handle meets flag condition)
  *
  * \return Non-negative value
  */
 HG_EXPORT hg_size_t
 HG_Bulk_get_serialize_size(
         hg_bulk_t handle,
-        hg_bool_t request_eager
+        hg_uint8_t request_eager
         );
 
 /**
@@ -150,10 +150,22 @@ HG_Bulk_get_serialize_size(
  *
  * \param buf [IN/OUT]          pointer to buffer
  * \param buf_size [IN]         buffer size
- * \param request_eager [IN]    boolean (passing HG_TRUE encodes actual data
- *                              along the handle, which is more efficient for
- *                              small data, this is only valid if bulk handle
- *                              has HG_BULK_READ_ONLY permission)
+ * \param request_eager [IN]    bitwise OR of eager flags (HG_TRUE is
+ *                              equivalent to HG_BULK_EAGER):
+ *                                - HG_BULK_EAGER encodes actual data along the
+ *                                  handle, which is more efficient for small
+ *                                  data, this is only valid if bulk handle has
+ *                                  HG_BULK_READ_ONLY permission, or if it is
+ *                                  combined with HG_BULK_EAGER_PUSH
+ *                                - HG_BULK_EAGER_PUSH marks handles with
+ *                                  HG_BULK_WRITE_ONLY permission and at most
+ *                                  HG_EAGER_PUSH_SIZE bytes so that data pushed
+ *                                  by the target is copied locally and sent
+ *                                  back with the RPC response
+ *                                - HG_BULK_EAGER_PUSH_RW also applies
+ *                                  HG_BULK_EAGER_PUSH to HG_BULK_READWRITE
+ *                                  handles, this requires HG_BULK_EAGER since
+ *                                  their data is then encoded as well
  * \param handle [IN]           abstract bulk handle
  *
  * \return HG_SUCCESS or corresponding HG error code
@@ -162,7 +174,7 @@ HG_EXPORT hg_return_t
 HG_Bulk_serialize(
         void *buf,
         hg_size_t buf_size,
-        hg_bool_t request_eager,
+        hg_uint8_t request_eager,
         hg_bulk_t handle
         );
 
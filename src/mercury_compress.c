@@ -0,0 +1,205 @@
+/*
+ * Copyright (C) 2013-2017 Argonne National Laboratory, Department of Energy,
+ *                    UChicago Argonne, LLC and The HDF Group.
+ * All rights reserved.
+ *
+ * The full copyright notice, including terms governing use, modification,
+ * and redistribution, is contained in the COPYING file that can be
+ * found at the root of the source code distribution tree.
+ */
+
+#include "mercury_compress.h"
+#include "mercury_error.h"
+
+#ifdef HG_HAS_COLLECT_STATS
+#include "mercury_atomic.h"
+#include "mercury_time.h"
+#endif
+
+#if defined(HG_HAS_LZ4)
+# include <lz4.h>
+#elif defined(HG_HAS_ZLIB)
+# include <zlib.h>
+#else
+# error "No compression codec defined"
+#endif
+#include <limits.h>
+#include <stdio.h>
+
+/****************/
+/* Local Macros */
+/****************/
+
+/* Map stat type to either 32-bit atomic or 64-bit */
+#ifdef HG_HAS_COLLECT_STATS
+#ifndef HG_UTIL_HAS_OPA_PRIMITIVES_H
+typedef hg_atomic_int64_t hg_compress_stat_t;
+#define hg_compress_stat_add(x, v) hg_atomic_add64(x, (hg_util_int64_t) v)
+#define hg_compress_stat_get hg_atomic_get64
+#else
+typedef hg_atomic_int32_t hg_compress_stat_t;
+#define hg_compress_stat_add(x, v) hg_atomic_add32(x, (hg_util_int32_t) v)
+#define hg_compress_stat_get hg_atomic_get32
+#endif
+#define HG_COMPRESS_STAT_INIT HG_ATOMIC_VAR_INIT
+
+/* Elapsed time in microseconds */
+#define HG_COMPRESS_USEC(t1, t2) \
+    (hg_time_to_double(hg_time_subtract(t2, t1)) * 1000000.0)
+#endif
+
+/*******************/
+/* Local Variables */
+/*******************/
+
+#ifdef HG_HAS_COLLECT_STATS
+static hg_compress_stat_t hg_compress_count_g = HG_COMPRESS_STAT_INIT(0);
+static hg_compress_stat_t hg_compress_bytes_in_g = HG_COMPRESS_STAT_INIT(0);
+static hg_compress_stat_t hg_compress_bytes_out_g = HG_COMPRESS_STAT_INIT(0);
+static hg_compress_stat_t hg_compress_usec_g = HG_COMPRESS_STAT_INIT(0);
+static hg_compress_stat_t hg_decompress_count_g = HG_COMPRESS_STAT_INIT(0);
+static hg_compress_stat_t hg_decompress_usec_g = HG_COMPRESS_STAT_INIT(0);
+#endif
+
+/*---------------------------------------------------------------------------*/
+hg_size_t
+hg_compress_bound(hg_size_t src_size)
+{
+#if defined(HG_HAS_LZ4)
+    return (hg_size_t) LZ4_compressBound((int) src_size);
+#elif defined(HG_HAS_ZLIB)
+    return (hg_size_t) compressBound((uLong) src_size);
+#endif
+}
+
+/*---------------------------------------------------------------------------*/
+hg_return_t
+hg_compress(const void *src, hg_size_t src_size, void *dest,
+    hg_size_t dest_size, hg_size_t *actual_size)
+{
+#ifdef HG_HAS_COLLECT_STATS
+    hg_time_t t1, t2;
+#endif
+    hg_return_t ret = HG_SUCCESS;
+
+    if (src_size > INT_MAX || dest_size > INT_MAX) {
+        HG_LOG_ERROR("Buffer size exceeds compression limit");
+        ret = HG_SIZE_ERROR;
+        goto done;
+    }
+
+#ifdef HG_HAS_COLLECT_STATS
+    hg_time_get_current(&t1);
+#endif
+
+#if defined(HG_HAS_LZ4)
+    {
+        int lz4_ret = LZ4_compress_default((const char *) src, (char *) dest,
+            (int) src_size, (int) dest_size);
+        if (lz4_ret <= 0) {
+            ret = HG_SIZE_ERROR;
+            goto done;
+        }
+        *actual_size = (hg_size_t) lz4_ret;
+    }
+#elif defined(HG_HAS_ZLIB)
+    {
+        uLongf zlib_size = (uLongf) dest_size;
+        int zlib_ret = compress2((Bytef *) dest, &zlib_size,
+            (const Bytef *) src, (uLong) src_size, Z_BEST_SPEED);
+        if (zlib_ret != Z_OK) {
+            ret = (zlib_ret == Z_BUF_ERROR) ? HG_SIZE_ERROR : HG_PROTOCOL_ERROR;
+            goto done;
+        }
+        *actual_size = (hg_size_t) zlib_size;
+    }
+#endif
+
+#ifdef HG_HAS_COLLECT_STATS
+    hg_time_get_current(&t2);
+    hg_compress_stat_add(&hg_compress_count_g, 1);
+    hg_compress_stat_add(&hg_compress_bytes_in_g, src_size);
+    hg_compress_stat_add(&hg_compress_bytes_out_g, *actual_size);
+    hg_compress_stat_add(&hg_compress_usec_g, HG_COMPRESS_USEC(t1, t2));
+#endif
+
+done:
+    return ret;
+}
+
+/*---------------------------------------------------------------------------*/
+hg_return_t
+hg_decompress(const void *src, hg_size_t src_size, void *dest,
+    hg_size_t dest_size)
+{
+#ifdef HG_HAS_COLLECT_STATS
+    hg_time_t t1, t2;
+#endif
+    hg_return_t ret = HG_SUCCESS;
+
+    if (src_size > INT_MAX || dest_size > INT_MAX) {
+        HG_LOG_ERROR("Buffer size exceeds compression limit");
+        ret = HG_SIZE_ERROR;
+        goto done;
+    }
+
+#ifdef HG_HAS_COLLECT_STATS
+    hg_time_get_current(&t1);
+#endif
+
+#if defined(HG_HAS_LZ4)
+    {
+        int lz4_ret = LZ4_decompress_safe((const char *) src, (char *) dest,
+            (int) src_size, (int) dest_size);
+        if (lz4_ret < 0 || (hg_size_t) lz4_ret != dest_size) {
+            HG_LOG_ERROR("Could not decompress buffer");
+            ret = HG_PROTOCOL_ERROR;
+            goto done;
+        }
+    }
+#elif defined(HG_HAS_ZLIB)
+    {
+        uLongf zlib_size = (uLongf) dest_size;
+        int zlib_ret = uncompress((Bytef *) dest, &zlib_size,
+            (const Bytef *) src, (uLong) src_size);
+        if (zlib_ret != Z_OK || (hg_size_t) zlib_size != dest_size) {
+            HG_LOG_ERROR("Could not decompress buffer");
+            ret = HG_PROTOCOL_ERROR;
+            goto done;
+        }
+    }
+#endif
+
+#ifdef HG_HAS_COLLECT_STATS
+    hg_time_get_current(&t2);
+    hg_compress_stat_add(&hg_decompress_count_g, 1);
+    hg_compress_stat_add(&hg_decompress_usec_g, HG_COMPRESS_USEC(t1, t2));
+#endif
+
+done:
+    return ret;
+}
+
+/*---------------------------------------------------------------------------*/
+#ifdef HG_HAS_COLLECT_STATS
+void
+hg_compress_print_stats(void)
+{
+    unsigned long bytes_in =
+        (unsigned long) hg_compress_stat_get(&hg_compress_bytes_in_g);
+    unsigned long bytes_out =
+        (unsigned long) hg_compress_stat_get(&hg_compress_bytes_out_g);
+
+    printf("Compression count:    %lu\n",
+        (unsigned long) hg_compress_stat_get(&hg_compress_count_g));
+    printf("Compression ratio:    %.2f (%lu -> %lu bytes)\n",
+        bytes_out ? (double) bytes_in / (double) bytes_out : 0., bytes_in,
+        bytes_out);
+    printf("Compression time:     %lu us\n",
+        (unsigned long) hg_compress_stat_get(&hg_compress_usec_g));
+    printf("Decompression count:  %lu\n",
+        (unsigned long) hg_compress_stat_get(&hg_decompress_count_g));
+    printf("Decompression time:   %lu us\n",
+        (unsigned long) hg_compress_stat_get(&hg_decompress_usec_g));
+}
+#endif
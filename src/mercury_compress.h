@@ -0,0 +1,97 @@
+/*
+ * Copyright (C) 2013-2017 Argonne National Laboratory, Department of Energy,
+ *                    UChicago Argonne, LLC and The HDF Group.
+ * All rights reserved.
+ *
+ * The full copyright notice, including terms governing use, modification,
+ * and redistribution, is contained in the COPYING file that can be
+ * found at the root of the source code distribution tree.
+ */
+
+#ifndef MERCURY_COMPRESS_H
+#define MERCURY_COMPRESS_H
+
+#include "mercury_types.h"
+
+/*****************/
+/* Public Macros */
+/*****************/
+
+/* Payloads smaller than this threshold are not compressed */
+#define HG_COMPRESS_THRESHOLD HG_COMPRESSION_THRESHOLD
+
+/* Uncompressed sizes received from peers above this limit are rejected */
+#define HG_COMPRESS_MAX_SIZE HG_COMPRESSION_MAX_SIZE
+
+/*********************/
+/* Public Prototypes */
+/*********************/
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * Get maximum compressed size for a buffer of size src_size.
+ *
+ * \param src_size [IN]         source buffer size
+ *
+ * \return Non-negative size value
+ */
+HG_EXPORT hg_size_t
+hg_compress_bound(
+        hg_size_t src_size
+        );
+
+/**
+ * Compress buffer. Fails with HG_SIZE_ERROR if compressed data does not fit
+ * into dest_size.
+ *
+ * \param src [IN]              source buffer
+ * \param src_size [IN]         source buffer size
+ * \param dest [OUT]            destination buffer
+ * \param dest_size [IN]        destination buffer size
+ * \param actual_size [OUT]     size of compressed data
+ *
+ * \return HG_SUCCESS or corresponding HG error code
+ */
+HG_EXPORT hg_return_t
+hg_compress(
+        const void *src,
+        hg_size_t src_size,
+        void *dest,
+        hg_size_t dest_size,
+        hg_size_t *actual_size
+        );
+
+/**
+ * Decompress buffer. Decompressed data must be exactly dest_size.
+ *
+ * \param src [IN]              source buffer
+ * \param src_size [IN]         source buffer size
+ * \param dest [OUT]            destination buffer
+ * \param dest_size [IN]        destination buffer size
+ *
+ * \return HG_SUCCESS or corresponding HG error code
+ */
+HG_EXPORT hg_return_t
+hg_decompress(
+        const void *src,
+        hg_size_t src_size,
+        void *dest,
+        hg_size_t dest_size
+        );
+
+#ifdef HG_HAS_COLLECT_STATS
+/**
+ * Print compression stats.
+ */
+HG_EXPORT void
+hg_compress_print_stats(void);
+#endif
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* MERCURY_COMPRESS_H */
@@ -12,21 +12,29 @@
 #include "mercury_core_header.h"
 #include "mercury_private.h"
 #include "mercury_error.h"
+#include "mercury_trace.h"
+#ifdef HG_HAS_COLLECT_STATS
+#include "mercury_stats.h"
+#ifdef HG_HAS_COMPRESSION
+#include "mercury_compress.h"
+#endif
+#endif
 
 #include "mercury_hash_table.h"
+#include "mercury_hash_string.h"
 #include "mercury_atomic.h"
 #include "mercury_queue.h"
 #include "mercury_list.h"
 #include "mercury_thread_mutex.h"
 #include "mercury_thread_spin.h"
+#include "mercury_thread_rwlock.h"
 #include "mercury_thread_condition.h"
 #include "mercury_time.h"
 #include "mercury_atomic.h"
 #include "mercury_poll.h"
 #include "mercury_thread_pool.h"
-#ifdef HG_HAS_SELF_FORWARD
+#include "mercury_executor.h"
 #include "mercury_event.h"
-#endif
 #include "mercury_atomic_queue.h"
 #include "mercury_mem.h"
 
@@ -45,6 +53,17 @@
 #define HG_CORE_MASK_NBITS          8
 #define HG_CORE_ATOMIC_QUEUE_SIZE   1024
 #define HG_CORE_PENDING_INCR        256
+#define HG_CORE_TIMER_TICK          10      /* Timer wheel resolution (ms) */
+#define HG_CORE_TIMER_SLOTS         256     /* Number of timer wheel slots */
+#define HG_CORE_CREDITS_INIT        16      /* Credits before first response */
+#define HG_CORE_CREDITS_MAX         255     /* Max credits granted */
+#define HG_CORE_IOV_SEGMENTS_MAX    8       /* Max segments gathered by NA */
+#define HG_CORE_BATCH_POOL_MAX      64      /* Max handles kept for batches */
+
+/* Classes of received RPCs, HG_HANDLER_HIGH RPCs are triggered first */
+#define HG_CORE_RPC_CLASS_NORMAL    0
+#define HG_CORE_RPC_CLASS_HIGH      1
+#define HG_CORE_RPC_CLASSES         2
 #ifdef HG_HAS_SM_ROUTING
 # define HG_CORE_UUID_MAX_LEN       36
 # define HG_CORE_ADDR_MAX_SIZE      256
@@ -73,6 +92,15 @@ typedef hg_atomic_int32_t hg_core_stat_t;
 #define hg_core_stat_get hg_atomic_get32
 #endif
 #define HG_CORE_STAT_INIT HG_ATOMIC_VAR_INIT
+
+/* Record stats of (class, context, RPC ID) of handle */
+#define HG_CORE_STATS_INCR(hg_handle, counter)                      \
+    hg_stats_incr(hg_handle->hg_info.hg_class, hg_handle->hg_info.context, \
+        hg_handle->hg_info.id, counter)
+#define HG_CORE_STATS_RECORD(hg_handle, type, t1, t2)               \
+    hg_stats_record(hg_handle->hg_info.hg_class,                    \
+        hg_handle->hg_info.context, hg_handle->hg_info.id, type,    \
+        HG_STATS_USEC(t1, t2))
 #endif
 
 /************************************/
@@ -101,6 +129,9 @@ struct hg_class {
     void (*data_free_callback)(void *); /* User data free callback */
     hg_atomic_int32_t n_contexts;       /* Atomic used for number of contexts */
     hg_atomic_int32_t n_addrs;          /* Atomic used for number of addrs */
+    hg_hash_table_t *addr_cache;        /* Looked up addrs (NULL if disabled) */
+    hg_thread_mutex_t addr_cache_mutex; /* Addr cache mutex */
+    double addr_cache_neg_ttl;          /* Time failed lookups are kept (s) */
 
     /* Callbacks */
     hg_return_t (*create)(
@@ -116,6 +147,32 @@ struct hg_class {
         ); /* more_data_release */
 };
 
+/* Timer wheel of forwards with a deadline, handles are hashed by expiration
+ * tick into one of the slots so that arming / disarming is O(1) */
+struct hg_core_timer_wheel {
+    HG_LIST_HEAD(hg_handle) slots[HG_CORE_TIMER_SLOTS]; /* Armed handles */
+    hg_time_t start;                    /* Time of tick 0 */
+    hg_util_uint64_t tick;              /* Last tick expired */
+    hg_atomic_int32_t count;            /* Number of armed handles */
+    hg_thread_spin_t lock;              /* Wheel lock */
+};
+
+#ifdef HG_HAS_COLLECT_STATS
+/* Progress accounting counters (times in microseconds) */
+struct hg_core_progress_acct {
+    hg_atomic_int64_t progress_count;   /* HG_Core_progress() calls */
+    hg_atomic_int64_t empty_count;      /* Calls that progressed nothing */
+    hg_atomic_int64_t progress_time;    /* Time in HG_Core_progress() */
+    hg_atomic_int64_t empty_time;       /* Time in calls that progressed nothing */
+    hg_atomic_int64_t trigger_count;    /* Callbacks triggered */
+    hg_atomic_int64_t trigger_time;     /* Time in callbacks */
+    hg_atomic_int64_t batch_count;      /* Coalesced messages sent */
+    hg_atomic_int64_t batch_rpc_count;  /* Forwards sent in them */
+    hg_atomic_int64_t header_reuse_count; /* Forwards of prepared headers */
+    hg_atomic_int64_t wait_time_base;   /* Poll set wait time at reset */
+};
+#endif
+
 /* HG context */
 struct hg_context {
     struct hg_class *hg_class;                    /* HG class */
@@ -134,18 +191,38 @@ struct hg_context {
     hg_thread_mutex_t completion_queue_mutex;     /* Completion queue mutex */
     hg_thread_cond_t  completion_queue_cond;      /* Completion queue cond */
     hg_atomic_int32_t trigger_waiting;            /* Waiting in trigger */
+    HG_QUEUE_HEAD(hg_completion_entry) priority_queue; /* High priority RPCs */
+    hg_atomic_int32_t priority_queue_count;       /* Priority queue count */
+    hg_atomic_int32_t rpc_queued[HG_CORE_RPC_CLASSES]; /* RPCs not started */
+    unsigned int rpc_queue_limit[HG_CORE_RPC_CLASSES]; /* Max RPCs not started */
+    HG_LIST_HEAD(hg_core_batch) batch_list;       /* Batches being filled */
+    hg_thread_mutex_t batch_mutex;                /* Batch list mutex */
+    unsigned int batch_window;                    /* Coalescing window (ms) */
+    hg_bool_t coalesce;                           /* Coalesce forwards */
+    HG_LIST_HEAD(hg_handle) batch_pool;           /* Handles of batch requests */
+    unsigned int batch_pool_count;                /* Number of pooled handles */
+    hg_thread_spin_t batch_pool_lock;             /* Batch pool lock */
     HG_LIST_HEAD(hg_handle) pending_list;         /* List of pending handles */
     hg_thread_spin_t pending_list_lock;           /* Pending list lock */
     HG_LIST_HEAD(hg_handle) processing_list;      /* List of handles being processed */
     hg_thread_spin_t processing_list_lock;        /* Processing list lock */
+    int completion_queue_notify;                  /* Wakes up progress */
 #ifdef HG_HAS_SELF_FORWARD
-    int completion_queue_notify;                  /* Self notification */
     hg_thread_pool_t *self_processing_pool;       /* Thread pool for self processing */
 #endif
+    hg_executor_t *executor;                      /* RPC handler threads */
+    hg_thread_rwlock_t executor_lock;             /* Executor swap lock */
     void *data;                                   /* User data */
     void (*data_free_callback)(void *);           /* User data free callback */
     hg_bool_t finalizing;                         /* Prevent reposts */
     hg_atomic_int32_t n_handles;                  /* Atomic used for number of handles */
+    hg_atomic_int32_t pending_count;              /* Number of pending handles */
+    hg_hash_table_t *origin_table;                /* Origins being served */
+    hg_thread_mutex_t origin_mutex;               /* Origin table mutex */
+    struct hg_core_timer_wheel timer_wheel;       /* Deadlines of forwards */
+#ifdef HG_HAS_COLLECT_STATS
+    struct hg_core_progress_acct acct;            /* Progress accounting */
+#endif
 };
 
 /* Info for function map */
@@ -153,6 +230,8 @@ struct hg_rpc_info {
     hg_rpc_cb_t rpc_cb;             /* RPC callback */
     void *data;                     /* User data */
     void (*free_callback)(void *);  /* User data free callback */
+    unsigned int affinity;          /* Handler thread hint */
+    hg_handler_priority_t priority; /* Handler priority */
 };
 
 #ifdef HG_HAS_SELF_FORWARD
@@ -175,6 +254,43 @@ struct hg_addr {
 #endif
     hg_bool_t is_mine;                  /* Created internally or not */
     hg_atomic_int32_t ref_count;        /* Reference count */
+    unsigned int credits;               /* Forwards target allows in flight */
+    unsigned int in_flight;             /* Forwards in flight */
+    HG_QUEUE_HEAD(hg_handle) credit_queue; /* Forwards waiting for credits */
+    hg_thread_spin_t credit_lock;       /* Credit lock */
+};
+
+/* Origin of requests being processed, credits are shared among origins */
+struct hg_core_origin {
+    na_addr_t na_addr;                  /* NA address of origin */
+    unsigned int count;                 /* Requests being processed */
+};
+
+/* Addr cache entry state */
+typedef enum {
+    HG_CORE_ADDR_PENDING,       /*!< lookup in progress */
+    HG_CORE_ADDR_RESOLVED,      /*!< addr resolved */
+    HG_CORE_ADDR_FAILED         /*!< lookup failed (negative entry) */
+} hg_core_addr_state_t;
+
+/* Addr cache entry */
+struct hg_addr_cache_entry {
+    char *name;                         /* Lookup name (key) */
+    struct hg_addr *hg_addr;            /* Resolved addr (holds a ref) */
+    hg_core_addr_state_t state;         /* Entry state */
+    hg_return_t ret;                    /* Error of failed lookup */
+    double expire;                      /* Expiration of failed lookup */
+    struct hg_op_id *waiters;           /* Lookups waiting on pending entry */
+    hg_bool_t invalidated;              /* Removed from cache while pending */
+};
+
+/* Batch of addr lookups */
+struct hg_core_lookup_batch {
+    struct hg_op_id *hg_op_id;          /* Op completed once all are done */
+    struct hg_addr **addrs;             /* User array of resolved addrs */
+    unsigned int count;                 /* Number of lookups */
+    hg_atomic_int32_t pending;          /* Lookups not completed yet */
+    hg_atomic_int32_t ret;              /* First lookup error */
 };
 
 /* HG core op type */
@@ -190,6 +306,13 @@ typedef enum {
 } hg_core_op_type_t;
 
 /* HG handle */
+/* Extra segments sent along with input/output buffer (not copied) */
+struct hg_core_iov {
+    void **buf_ptrs;                    /* Segment pointers */
+    const hg_size_t *buf_sizes;         /* Segment sizes */
+    hg_uint32_t count;                  /* Number of segments */
+};
+
 struct hg_handle {
     struct hg_info hg_info;             /* HG info */
     na_class_t *na_class;               /* NA class */
@@ -208,6 +331,21 @@ struct hg_handle {
     hg_bool_t is_self;                  /* Self processed */
     hg_atomic_int32_t in_use;           /* Is in use */
     hg_bool_t no_response;              /* Require response or not */
+    HG_LIST_ENTRY(hg_handle) timer_entry; /* Entry in timer wheel slot */
+    hg_util_uint64_t timer_tick;        /* Expiration tick of deadline */
+    hg_bool_t timer_armed;              /* In timer wheel */
+    hg_bool_t timed_out;                /* Deadline was reached */
+    HG_QUEUE_ENTRY(hg_handle) credit_entry; /* Entry in addr credit queue */
+    hg_bool_t credit_queued;            /* Waiting for credits */
+    hg_bool_t credit_deferred;          /* Forwarded after waiting */
+    hg_bool_t credit_held;              /* Holds a credit of target addr */
+    hg_bool_t credit_exempt;            /* Never waits for credits */
+    hg_bool_t credit_dispatching;       /* Got a credit, not sent yet */
+    hg_bool_t credit_canceled;          /* Canceled while dispatching */
+    struct hg_core_origin *origin;      /* Origin of request (target) */
+    hg_bool_t prepared;                 /* Keeps request header encoded */
+    hg_bool_t header_encoded;           /* Request header is in in_buf */
+    hg_uint8_t header_flags;            /* Flags of encoded request header */
 
     void *in_buf;                       /* Input buffer */
     void *in_buf_plugin_data;           /* Input buffer NA plugin data */
@@ -219,6 +357,8 @@ struct hg_handle {
     na_size_t out_buf_size;             /* Output buffer size */
     na_size_t na_out_header_offset;     /* Output NA header offset */
     na_size_t out_buf_used;             /* Amount of output buffer used */
+    struct hg_core_iov in_iov;          /* Extra input segments */
+    struct hg_core_iov out_iov;         /* Extra output segments */
 
     na_op_id_t na_send_op_id;           /* Operation ID for send */
     na_op_id_t na_recv_op_id;           /* Operation ID for recv */
@@ -232,10 +372,23 @@ struct hg_handle {
     struct hg_core_header out_header;   /* Output header */
 
     struct hg_rpc_info *hg_rpc_info;    /* Associated RPC info */
+    unsigned int rpc_class;             /* Class of received RPC */
+    hg_bool_t rpc_queued;               /* Counted as not started */
+    HG_QUEUE_ENTRY(hg_handle) batch_entry; /* Entry in batch */
+    struct hg_core_batch *batch;        /* Batch being filled (origin) */
+    na_size_t batch_offset;             /* Offset of entry in batch buffer */
+    hg_bool_t pooled;                   /* Kept for next batch (target) */
+    struct hg_core_multi *multi;        /* Multi forward of handle */
     void *data;                         /* User data */
     void (*data_free_callback)(void *); /* User data free callback */
 
     struct hg_thread_work thread_work;  /* Used for self processing and testing */
+    struct hg_thread_work executor_work; /* Used by handler threads */
+#ifdef HG_HAS_COLLECT_STATS
+    hg_time_t stats_forward;            /* Time of forward (origin) */
+    hg_time_t stats_recv;               /* Time input was received (target) */
+    hg_time_t stats_process;            /* Time RPC callback started (target) */
+#endif
 
     /* Callbacks */
     hg_return_t (*forward)(
@@ -249,10 +402,69 @@ struct hg_handle {
         ); /* no_respond */
 };
 
+/* Forwards to the same addr coalesced into one unexpected message */
+struct hg_core_batch {
+    struct hg_class *hg_class;          /* HG class */
+    struct hg_context *context;         /* HG context */
+    struct hg_addr *addr;               /* Target addr (holds a ref) */
+    na_class_t *na_class;               /* NA class */
+    na_context_t *na_context;           /* NA context */
+    void *buf;                          /* Message buffer */
+    void *buf_plugin_data;              /* Message buffer plugin data */
+    na_size_t buf_size;                 /* Message buffer size */
+    na_size_t buf_used;                 /* Message buffer used */
+    na_size_t header_offset;            /* NA header offset */
+    na_tag_t tag;                       /* Tag of message */
+    struct hg_core_header_batch header; /* Batch header */
+    hg_time_t deadline;                 /* Time batch must be sent */
+    HG_QUEUE_HEAD(hg_handle) handle_queue; /* Forwards in batch */
+    HG_LIST_ENTRY(hg_core_batch) entry; /* Entry in context batch list */
+};
+
+/* Child of a multi forward, root of a subtree */
+struct hg_core_multi_child {
+    unsigned int index;                 /* Index of child addr */
+    const char *names;                  /* Addr names of subtree */
+    hg_size_t names_size;               /* Size of addr names */
+    hg_uint16_t count;                  /* Number of addrs in subtree */
+};
+
+/* Same input forwarded to several addrs */
+struct hg_core_multi {
+    struct hg_handle *hg_handle;        /* Handle completed or responding */
+    struct hg_context *context;         /* Context of children */
+    hg_id_t id;                         /* RPC ID */
+    char *buf;                          /* Copy of payload and addr names */
+    hg_size_t payload_size;             /* Size of payload */
+    hg_size_t names_size;               /* Size of addr names */
+    hg_uint8_t flags;                   /* Flags of children */
+    hg_uint16_t fanout;                 /* Children per node (0 if flat) */
+    hg_bool_t is_origin;                /* Complete handle once done */
+    struct hg_core_multi_child *children; /* Children */
+    unsigned int child_count;           /* Number of children */
+    const char **child_names;           /* Names of children to look up */
+    struct hg_addr **child_addrs;       /* Looked up addrs of children */
+    unsigned int pending;               /* Children not done yet */
+    hg_return_t ret;                    /* First error of children */
+    hg_bool_t respond_deferred;         /* Respond once children are done */
+    hg_cb_t respond_callback;           /* Deferred respond callback */
+    void *respond_arg;                  /* Deferred respond arguments */
+    hg_uint8_t respond_flags;           /* Deferred respond flags */
+    hg_size_t respond_payload_size;     /* Deferred respond payload size */
+    hg_thread_spin_t lock;              /* Lock */
+    hg_atomic_int32_t ref_count;        /* Reference count */
+};
+
 /* HG op id */
 struct hg_op_info_lookup {
     struct hg_addr *hg_addr;            /* Address */
     na_op_id_t na_lookup_op_id;         /* Operation ID for lookup */
+    hg_return_t ret;                    /* Return code */
+    hg_bool_t noentry;                  /* Failed as name does not exist */
+    struct hg_addr_cache_entry *cache_entry; /* Cache entry being resolved */
+    struct hg_op_id *next;              /* Next waiter on cache entry */
+    struct hg_core_lookup_batch *batch; /* Batch this lookup is part of */
+    unsigned int index;                 /* Index of lookup in batch */
 };
 
 struct hg_op_id {
@@ -399,6 +611,26 @@ hg_core_addr_create(
         struct hg_class *hg_class
         );
 
+/**
+ * Create addr lookup op.
+ */
+static struct hg_op_id *
+hg_core_addr_lookup_op_create(
+        struct hg_context *context,
+        hg_cb_t callback,
+        void *arg
+        );
+
+/**
+ * Start addr lookup, op is freed on failure.
+ */
+static hg_return_t
+hg_core_addr_lookup_start(
+        struct hg_context *context,
+        struct hg_op_id *hg_op_id,
+        const char *name
+        );
+
 /**
  * Lookup addr.
  */
@@ -411,6 +643,32 @@ hg_core_addr_lookup(
         hg_op_id_t *op_id
         );
 
+/**
+ * Lookup array of addrs.
+ */
+static hg_return_t
+hg_core_addr_lookup_batch(
+        struct hg_context *context,
+        hg_cb_t callback,
+        void *arg,
+        const char *const names[],
+        unsigned int count,
+        struct hg_addr *addrs[]
+        );
+
+/**
+ * Complete one lookup of a batch, complete batch op if it was the last one
+ * (see hg_core_addr_lookup_complete() for notify).
+ */
+static hg_return_t
+hg_core_addr_lookup_batch_complete(
+        struct hg_core_lookup_batch *batch,
+        unsigned int index,
+        struct hg_addr *hg_addr,
+        hg_return_t lookup_ret,
+        hg_bool_t notify
+        );
+
 /**
  * Lookup callback.
  */
@@ -420,11 +678,13 @@ hg_core_addr_lookup_cb(
         );
 
 /**
- * Complete addr lookup.
+ * Complete addr lookup. Notify must be set when not completing from an NA
+ * callback, so that a thread blocked in progress wakes up to trigger it.
  */
 static hg_return_t
 hg_core_addr_lookup_complete(
-        struct hg_op_id *hg_op_id
+        struct hg_op_id *hg_op_id,
+        hg_bool_t notify
         );
 
 /**
@@ -436,6 +696,67 @@ hg_core_addr_free(
         struct hg_addr *hg_addr
         );
 
+/**
+ * Equal function for addr cache.
+ */
+static HG_INLINE int
+hg_core_addr_cache_equal(
+        void *vlocation1,
+        void *vlocation2
+        );
+
+/**
+ * Hash function for addr cache.
+ */
+static HG_INLINE unsigned int
+hg_core_addr_cache_hash(
+        void *vlocation
+        );
+
+/**
+ * Free addr cache entry.
+ */
+static void
+hg_core_addr_cache_entry_free(
+        struct hg_class *hg_class,
+        struct hg_addr_cache_entry *entry
+        );
+
+/**
+ * Look for name in addr cache. Lookups that are resolved from the cache or
+ * attached to a pending lookup of the same name are completed later, owner
+ * is set if the caller must issue the NA lookup and complete the entry.
+ */
+static hg_return_t
+hg_core_addr_cache_lookup(
+        struct hg_context *context,
+        struct hg_op_id *hg_op_id,
+        const char *name,
+        hg_bool_t *owner
+        );
+
+/**
+ * Complete pending addr cache entry and lookups waiting on it. Failures are
+ * only kept as negative entries if the name does not exist (noentry).
+ */
+static void
+hg_core_addr_cache_complete(
+        struct hg_class *hg_class,
+        struct hg_addr_cache_entry *entry,
+        struct hg_addr *hg_addr,
+        hg_return_t lookup_ret,
+        hg_bool_t noentry
+        );
+
+/**
+ * Remove name (or all entries if NULL) from addr cache.
+ */
+static void
+hg_core_addr_cache_invalidate(
+        struct hg_class *hg_class,
+        const char *name
+        );
+
 /**
  * Self addr.
  */
@@ -518,6 +839,69 @@ hg_core_get_thread_work(
         hg_handle_t handle
         );
 
+/**
+ * Forward handle, sending count extra segments after payload. Forward is
+ * canceled and completes with HG_TIMEOUT if timeout (ms) is not 0 and no
+ * response was received by then.
+ */
+static hg_return_t
+hg_core_forward(
+        struct hg_handle *hg_handle,
+        hg_cb_t callback,
+        void *arg,
+        hg_uint8_t flags,
+        hg_size_t payload_size,
+        hg_uint32_t count,
+        void **buf_ptrs,
+        const hg_size_t *buf_sizes,
+        unsigned int timeout
+        );
+
+/**
+ * Respond, sending count extra segments after payload.
+ */
+static hg_return_t
+hg_core_respond(
+        struct hg_handle *hg_handle,
+        hg_cb_t callback,
+        void *arg,
+        hg_uint8_t flags,
+        hg_size_t payload_size,
+        hg_uint32_t count,
+        void **buf_ptrs,
+        const hg_size_t *buf_sizes
+        );
+
+/**
+ * Set extra segments of buf. Segments are gathered at buf + *buf_used if
+ * they cannot be sent separately, in which case *buf_used is updated.
+ */
+static hg_return_t
+hg_core_set_iov(
+        struct hg_handle *hg_handle,
+        struct hg_core_iov *hg_core_iov,
+        void *buf,
+        na_size_t buf_size,
+        na_size_t *buf_used,
+        hg_uint32_t count,
+        void **buf_ptrs,
+        const hg_size_t *buf_sizes
+        );
+
+/**
+ * Send buf followed by extra segments.
+ */
+static na_return_t
+hg_core_send_iov(
+        struct hg_handle *hg_handle,
+        na_bool_t unexpected,
+        na_cb_t callback,
+        void *buf,
+        na_size_t buf_size,
+        void *plugin_data,
+        const struct hg_core_iov *hg_core_iov
+        );
+
 #ifdef HG_HAS_SELF_FORWARD
 /**
  * Forward handle locally.
@@ -536,6 +920,117 @@ hg_core_forward_na(
         struct hg_handle *hg_handle
         );
 
+/**
+ * Check whether forward can be coalesced with other forwards.
+ */
+static HG_INLINE hg_bool_t
+hg_core_batch_can_add(
+        struct hg_handle *hg_handle
+        );
+
+/**
+ * Add encoded forward to the batch of its target addr.
+ */
+static na_return_t
+hg_core_batch_add(
+        struct hg_handle *hg_handle
+        );
+
+/**
+ * Take batch out of context list, its forwards can no longer be canceled
+ * from it. Must be called with batch mutex held.
+ */
+static void
+hg_core_batch_remove(
+        struct hg_core_batch *hg_core_batch
+        );
+
+/**
+ * Send batch, batch is freed once sent.
+ */
+static void
+hg_core_batch_send(
+        struct hg_core_batch *hg_core_batch
+        );
+
+/**
+ * Send batches whose window has elapsed (all batches if force is set).
+ */
+static void
+hg_core_batch_flush(
+        struct hg_context *context,
+        hg_bool_t force
+        );
+
+/**
+ * Complete forwards of a batch that could not be sent.
+ */
+static void
+hg_core_batch_fail(
+        struct hg_core_batch *hg_core_batch
+        );
+
+/**
+ * Complete forward that will not be sent with its batch.
+ */
+static void
+hg_core_batch_drop(
+        struct hg_handle *hg_handle,
+        hg_return_t ret
+        );
+
+/**
+ * Take forward out of the batch being filled. Return HG_TRUE if it was
+ * still waiting there, it is then completed with HG_CANCELED.
+ */
+static hg_bool_t
+hg_core_batch_cancel(
+        struct hg_handle *hg_handle
+        );
+
+/**
+ * Free batch.
+ */
+static void
+hg_core_batch_free(
+        struct hg_core_batch *hg_core_batch
+        );
+
+/**
+ * Batch send callback, completes the send of each forward.
+ */
+static int
+hg_core_batch_send_cb(
+        const struct na_cb_info *callback_info
+        );
+
+/**
+ * Get handle for a request received in a batch, handles of previous batches
+ * are reused.
+ */
+static struct hg_handle *
+hg_core_batch_pool_get(
+        struct hg_context *context,
+        hg_bool_t use_sm
+        );
+
+/**
+ * Keep handle of a batch request for next batches. Return HG_FALSE if the
+ * handle must be freed instead.
+ */
+static hg_bool_t
+hg_core_batch_pool_put(
+        struct hg_handle *hg_handle
+        );
+
+/**
+ * Free handles kept for batch requests.
+ */
+static void
+hg_core_batch_pool_free(
+        struct hg_context *context
+        );
+
 #ifdef HG_HAS_SELF_FORWARD
 /**
  * Send response locally.
@@ -595,6 +1090,42 @@ hg_core_process_input(
         hg_bool_t *completed
         );
 
+/**
+ * Process each request of a batch on a handle of its own.
+ */
+static hg_return_t
+hg_core_process_batch(
+        struct hg_handle *hg_handle,
+        unsigned int *completed_count
+        );
+
+/**
+ * Count received RPC in its class. Return HG_FALSE if too many RPCs of that
+ * class are waiting to be run.
+ */
+static hg_bool_t
+hg_core_admit(
+        struct hg_handle *hg_handle
+        );
+
+/**
+ * Count RPC of handle as no longer waiting to be run.
+ */
+static HG_INLINE void
+hg_core_admit_release(
+        struct hg_handle *hg_handle
+        );
+
+/**
+ * Answer RPC with an error (HG_BUSY if it was not admitted) without
+ * running it.
+ */
+static hg_return_t
+hg_core_shed(
+        struct hg_handle *hg_handle,
+        hg_return_t error
+        );
+
 /**
  * Send output callback.
  */
@@ -638,6 +1169,14 @@ hg_core_process_thread(
         );
 #endif
 
+/**
+ * Check whether all completion queues of context are empty.
+ */
+static HG_INLINE hg_bool_t
+hg_core_completion_queue_is_empty(
+        struct hg_context *context
+        );
+
 /**
  * Process handle.
  */
@@ -646,6 +1185,31 @@ hg_core_process(
         struct hg_handle *hg_handle
         );
 
+/**
+ * Run RPC callback and respond or complete handle on error.
+ */
+static hg_return_t
+hg_core_process_entry(
+        struct hg_handle *hg_handle
+        );
+
+/**
+ * Process handle thread (used for handler threads).
+ */
+static HG_THREAD_RETURN_TYPE
+hg_core_process_executor(
+        void *arg
+        );
+
+/**
+ * Post handle to handler threads. RPC callback must be run inline if
+ * HG_SUCCESS is not returned.
+ */
+static hg_return_t
+hg_core_process_post(
+        struct hg_handle *hg_handle
+        );
+
 /**
  * Complete handle and add to completion queue.
  */
@@ -699,7 +1263,6 @@ hg_core_progress_na(
         unsigned int timeout
         );
 
-#ifdef HG_HAS_SELF_FORWARD
 /**
  * Completion queue notification callback.
  */
@@ -709,7 +1272,6 @@ hg_core_completion_queue_notify_cb(
         unsigned int timeout,
         hg_util_bool_t *progressed
         );
-#endif
 
 /**
  * Progress callback on NA layer when hg_core_progress_poll() is used.
@@ -793,13 +1355,226 @@ hg_core_cancel(
         struct hg_handle *hg_handle
         );
 
-#ifdef HG_HAS_COLLECT_STATS
 /**
- * Print stats.
+ * Equal function for origin table.
  */
-static void
-hg_core_print_stats(void);
-#endif
+static HG_INLINE int
+hg_core_origin_equal(
+        void *vlocation1,
+        void *vlocation2
+        );
+
+/**
+ * Hash function for origin table.
+ */
+static HG_INLINE unsigned int
+hg_core_origin_hash(
+        void *vlocation
+        );
+
+/**
+ * Count request of handle against its origin.
+ */
+static void
+hg_core_origin_acquire(
+        struct hg_handle *hg_handle
+        );
+
+/**
+ * Release request of handle from its origin.
+ */
+static void
+hg_core_origin_release(
+        struct hg_handle *hg_handle
+        );
+
+/**
+ * Get credits that target grants to origin of handle in response.
+ */
+static HG_INLINE hg_uint8_t
+hg_core_credits_grant(
+        struct hg_handle *hg_handle
+        );
+
+/**
+ * Update credits of addr from response, dispatch waiting forwards.
+ */
+static void
+hg_core_credits_update(
+        struct hg_addr *hg_addr,
+        hg_uint8_t credits
+        );
+
+/**
+ * Take a credit of target addr, queue handle if none is left. Return HG_TRUE
+ * if handle can be forwarded.
+ */
+static hg_bool_t
+hg_core_credit_acquire(
+        struct hg_handle *hg_handle
+        );
+
+/**
+ * Return credit of handle and forward waiting handles.
+ */
+static void
+hg_core_credit_release(
+        struct hg_handle *hg_handle
+        );
+
+/**
+ * Cancel handle that waits for a credit or was not sent yet. Return HG_TRUE
+ * if handle completes as canceled.
+ */
+static hg_bool_t
+hg_core_credit_cancel(
+        struct hg_handle *hg_handle
+        );
+
+/**
+ * Forward handles that got a credit.
+ */
+static void
+hg_core_credit_dispatch(
+        struct hg_addr *hg_addr
+        );
+
+/**
+ * Get current tick of timer wheel.
+ */
+static HG_INLINE hg_util_uint64_t
+hg_core_timer_get_tick(
+        struct hg_core_timer_wheel *timer_wheel
+        );
+
+/**
+ * Arm deadline of forwarded handle.
+ */
+static void
+hg_core_timer_arm(
+        struct hg_handle *hg_handle,
+        unsigned int timeout
+        );
+
+/**
+ * Disarm deadline of handle if armed.
+ */
+static void
+hg_core_timer_disarm(
+        struct hg_handle *hg_handle
+        );
+
+/**
+ * Cancel forwards whose deadline is reached.
+ */
+static void
+hg_core_timer_expire(
+        struct hg_context *context
+        );
+
+/**
+ * Create multi forward of payload, names are the addr names of the subtree
+ * (NULL if flat).
+ */
+static struct hg_core_multi *
+hg_core_multi_create(
+        struct hg_handle *hg_handle,
+        const void *payload,
+        hg_size_t payload_size,
+        const char *names,
+        hg_size_t names_size,
+        hg_uint8_t flags,
+        hg_uint16_t fanout,
+        hg_bool_t is_origin
+        );
+
+/**
+ * Release reference to multi forward.
+ */
+static void
+hg_core_multi_release(
+        struct hg_core_multi *multi
+        );
+
+/**
+ * Split count addrs into children and their subtrees.
+ */
+static hg_return_t
+hg_core_multi_split(
+        struct hg_core_multi *multi,
+        unsigned int count
+        );
+
+/**
+ * Forward payload to child addr along with the subtree of that child.
+ */
+static hg_return_t
+hg_core_multi_forward_child(
+        struct hg_core_multi *multi,
+        struct hg_addr *hg_addr,
+        const struct hg_core_multi_child *child
+        );
+
+/**
+ * Forward to child callback.
+ */
+static hg_return_t
+hg_core_multi_forward_cb(
+        const struct hg_cb_info *callback_info
+        );
+
+/**
+ * Lookup of children callback.
+ */
+static hg_return_t
+hg_core_multi_lookup_cb(
+        const struct hg_cb_info *callback_info
+        );
+
+/**
+ * Child is done, complete or respond on handle once all children are done.
+ */
+static void
+hg_core_multi_done(
+        struct hg_core_multi *multi,
+        hg_return_t ret
+        );
+
+/**
+ * Forward received request to the subtree appended to it.
+ */
+static hg_return_t
+hg_core_tree_forward(
+        struct hg_handle *hg_handle
+        );
+
+#ifdef HG_HAS_COLLECT_STATS
+/**
+ * Reset progress accounting of context (including its NA contexts).
+ */
+static void
+hg_core_progress_acct_reset(
+        struct hg_context *context
+        );
+
+/**
+ * Add progress accounting of NA context.
+ */
+static void
+hg_core_progress_acct_add_na(
+        na_class_t *na_class,
+        na_context_t *na_context,
+        struct hg_progress_stats *stats
+        );
+#endif
+
+#ifdef HG_HAS_COLLECT_STATS
+/**
+ * Print stats.
+ */
+static void
+hg_core_print_stats(void);
+#endif
 
 /*******************/
 /* Local Variables */
@@ -826,6 +1601,10 @@ hg_core_print_stats(void)
         (unsigned long) hg_core_stat_get(&hg_core_rpc_extra_count_g));
     printf("Bulk transfer count:  %lu\n",
         (unsigned long) hg_core_stat_get(&hg_core_bulk_count_g));
+#ifdef HG_HAS_COMPRESSION
+    hg_compress_print_stats();
+#endif
+    hg_stats_print();
 }
 #endif
 
@@ -1023,6 +1802,7 @@ hg_core_pending_list_cancel(struct hg_context *context)
     while (!HG_LIST_IS_EMPTY(&context->pending_list)) {
         struct hg_handle *hg_handle = HG_LIST_FIRST(&context->pending_list);
         HG_LIST_REMOVE(hg_handle, entry);
+        hg_atomic_decr32(&context->pending_count);
 
         /* Prevent reposts */
         hg_handle->repost = HG_FALSE;
@@ -1096,6 +1876,23 @@ hg_core_init(const char *na_info_string, hg_bool_t na_listen,
     }
     memset(hg_class, 0, sizeof(struct hg_class));
 
+#ifdef HG_HAS_COLLECT_STATS
+    /* Initialize per-RPC stats */
+    ret = hg_stats_init();
+    if (ret != HG_SUCCESS) {
+        HG_LOG_ERROR("Could not initialize stats");
+        goto done;
+    }
+#endif
+#ifdef HG_HAS_TRACE
+    /* Initialize tracing */
+    ret = hg_trace_init();
+    if (ret != HG_SUCCESS) {
+        HG_LOG_ERROR("Could not initialize tracing");
+        goto done;
+    }
+#endif
+
     /* Parse options */
     if (hg_init_info) {
         /* External NA class */
@@ -1107,6 +1904,18 @@ hg_core_init(const char *na_info_string, hg_bool_t na_listen,
 #ifdef HG_HAS_SM_ROUTING
         auto_sm = hg_init_info->auto_sm;
 #endif
+        if (hg_init_info->addr_cache) {
+            hg_class->addr_cache = hg_hash_table_new(hg_core_addr_cache_hash,
+                hg_core_addr_cache_equal);
+            if (!hg_class->addr_cache) {
+                HG_LOG_ERROR("Could not create addr cache");
+                ret = HG_NOMEM_ERROR;
+                goto done;
+            }
+            hg_thread_mutex_init(&hg_class->addr_cache_mutex);
+            hg_class->addr_cache_neg_ttl =
+                (double) hg_init_info->addr_cache_neg_ttl / 1000.0;
+        }
 #ifdef HG_HAS_COLLECT_STATS
         hg_class->stats = hg_init_info->stats;
         if (hg_class->stats && !hg_core_print_stats_registered_g) {
@@ -1224,6 +2033,10 @@ hg_core_finalize(struct hg_class *hg_class)
         goto done;
     }
 
+    /* Release addrs held by the cache */
+    if (hg_class->addr_cache)
+        hg_core_addr_cache_invalidate(hg_class, NULL);
+
     n_addrs = hg_atomic_get32(&hg_class->n_addrs);
     if (n_addrs != 0) {
         HG_LOG_ERROR("HG addrs must be freed before finalizing HG"
@@ -1232,6 +2045,11 @@ hg_core_finalize(struct hg_class *hg_class)
         goto done;
     }
 
+#ifdef HG_HAS_COLLECT_STATS
+    /* Keep stats of class for the stat report */
+    hg_stats_retire(hg_class, NULL);
+#endif
+
     /* Delete function map */
     if(hg_class->func_map)
         hg_hash_table_free(hg_class->func_map);
@@ -1244,6 +2062,13 @@ hg_core_finalize(struct hg_class *hg_class)
     /* Destroy mutex */
     hg_thread_spin_destroy(&hg_class->func_map_lock);
 
+    /* Delete addr cache */
+    if (hg_class->addr_cache) {
+        hg_hash_table_free(hg_class->addr_cache);
+        hg_class->addr_cache = NULL;
+        hg_thread_mutex_destroy(&hg_class->addr_cache_mutex);
+    }
+
     if (!hg_class->na_ext_init) {
         /* Finalize interface */
         if (NA_Finalize(hg_class->na_class) != NA_SUCCESS) {
@@ -1287,6 +2112,9 @@ hg_core_addr_create(struct hg_class *hg_class)
     hg_addr->na_sm_addr = NA_ADDR_NULL;
 #endif
     hg_atomic_init32(&hg_addr->ref_count, 1);
+    hg_addr->credits = HG_CORE_CREDITS_INIT;
+    HG_QUEUE_INIT(&hg_addr->credit_queue);
+    hg_thread_spin_init(&hg_addr->credit_lock);
 
     /* Increment N addrs from HG class */
     hg_atomic_incr32(&hg_class->n_addrs);
@@ -1296,26 +2124,15 @@ done:
 }
 
 /*---------------------------------------------------------------------------*/
-static hg_return_t
-hg_core_addr_lookup(struct hg_context *context, hg_cb_t callback, void *arg,
-    const char *name, hg_op_id_t *op_id)
+static struct hg_op_id *
+hg_core_addr_lookup_op_create(struct hg_context *context, hg_cb_t callback,
+    void *arg)
 {
-    na_class_t *na_class = context->hg_class->na_class;
-    na_context_t *na_context = context->na_context;
-    struct hg_op_id *hg_op_id = NULL;
-    struct hg_addr *hg_addr = NULL;
-    na_return_t na_ret;
-#ifdef HG_HAS_SM_ROUTING
-    char lookup_name[HG_CORE_ADDR_MAX_SIZE] = {'\0'};
-#endif
-    const char *name_str = name;
-    hg_return_t ret = HG_SUCCESS, progress_ret;
+    struct hg_op_id *hg_op_id;
 
-    /* Allocate op_id */
     hg_op_id = (struct hg_op_id *) malloc(sizeof(struct hg_op_id));
     if (!hg_op_id) {
         HG_LOG_ERROR("Could not allocate HG operation ID");
-        ret = HG_NOMEM_ERROR;
         goto done;
     }
     hg_op_id->context = context;
@@ -1325,6 +2142,43 @@ hg_core_addr_lookup(struct hg_context *context, hg_cb_t callback, void *arg,
     hg_atomic_init32(&hg_op_id->completed, 0);
     hg_op_id->info.lookup.hg_addr = NULL;
     hg_op_id->info.lookup.na_lookup_op_id = NA_OP_ID_NULL;
+    hg_op_id->info.lookup.ret = HG_SUCCESS;
+    hg_op_id->info.lookup.noentry = HG_FALSE;
+    hg_op_id->info.lookup.cache_entry = NULL;
+    hg_op_id->info.lookup.next = NULL;
+    hg_op_id->info.lookup.batch = NULL;
+    hg_op_id->info.lookup.index = 0;
+
+done:
+    return hg_op_id;
+}
+
+/*---------------------------------------------------------------------------*/
+static hg_return_t
+hg_core_addr_lookup_start(struct hg_context *context,
+    struct hg_op_id *hg_op_id, const char *name)
+{
+    na_class_t *na_class = context->hg_class->na_class;
+    na_context_t *na_context = context->na_context;
+    struct hg_addr *hg_addr = NULL;
+    na_return_t na_ret;
+#ifdef HG_HAS_SM_ROUTING
+    char lookup_name[HG_CORE_ADDR_MAX_SIZE] = {'\0'};
+#endif
+    const char *name_str = name;
+    hg_return_t ret = HG_SUCCESS;
+
+    /* Try to resolve from cache or join lookup already in progress */
+    if (context->hg_class->addr_cache) {
+        hg_bool_t owner = HG_FALSE;
+
+        ret = hg_core_addr_cache_lookup(context, hg_op_id, name, &owner);
+        if (ret != HG_SUCCESS || !owner) {
+            if (ret == HG_SUCCESS)
+                hg_op_id = NULL; /* Completed later */
+            goto done;
+        }
+    }
 
     /* Allocate addr */
     hg_addr = hg_core_addr_create(context->hg_class);
@@ -1374,29 +2228,22 @@ hg_core_addr_lookup(struct hg_context *context, hg_cb_t callback, void *arg,
     /* Assign corresponding NA class */
     hg_addr->na_class = na_class;
 
-    /* Assign op_id */
-    if (op_id && op_id != HG_OP_ID_IGNORE)
-        *op_id = (hg_op_id_t) hg_op_id;
-
     na_ret = NA_Addr_lookup(na_class, na_context, hg_core_addr_lookup_cb,
         hg_op_id, name_str, &hg_op_id->info.lookup.na_lookup_op_id);
     if (na_ret != NA_SUCCESS) {
         HG_LOG_ERROR("Could not start lookup for address %s", name_str);
+        hg_op_id->info.lookup.noentry = (na_ret == NA_NOENTRY_ERROR);
         ret = HG_NA_ERROR;
         goto done;
     }
 
-    /* TODO to avoid blocking after lookup make progress on the HG layer with
-     * timeout of 0 */
-    progress_ret = context->progress(context, 0);
-    if (progress_ret != HG_SUCCESS && progress_ret != HG_TIMEOUT) {
-        HG_LOG_ERROR("Could not make progress");
-        ret = progress_ret;
-        goto done;
-    }
-
 done:
-    if (ret != HG_SUCCESS) {
+    if (ret != HG_SUCCESS && hg_op_id) {
+        /* Fail lookups that joined this one */
+        if (hg_op_id->info.lookup.cache_entry)
+            hg_core_addr_cache_complete(context->hg_class,
+                hg_op_id->info.lookup.cache_entry, NULL, ret,
+                hg_op_id->info.lookup.noentry);
         free(hg_op_id);
         if (hg_addr != NULL)
             hg_core_addr_free(context->hg_class, hg_addr);
@@ -1406,50 +2253,218 @@ done:
 }
 
 /*---------------------------------------------------------------------------*/
-static int
-hg_core_addr_lookup_cb(const struct na_cb_info *callback_info)
+static hg_return_t
+hg_core_addr_lookup(struct hg_context *context, hg_cb_t callback, void *arg,
+    const char *name, hg_op_id_t *op_id)
 {
-    struct hg_op_id *hg_op_id = (struct hg_op_id *) callback_info->arg;
-    na_return_t na_ret = NA_SUCCESS;
-    int ret = 0;
+    struct hg_op_id *hg_op_id = NULL;
+    hg_return_t ret = HG_SUCCESS, progress_ret;
 
-    if (callback_info->ret != NA_SUCCESS) {
-        return ret;
+    /* Allocate op_id */
+    hg_op_id = hg_core_addr_lookup_op_create(context, callback, arg);
+    if (!hg_op_id) {
+        ret = HG_NOMEM_ERROR;
+        goto done;
     }
 
-    /* Assign addr */
-    hg_op_id->info.lookup.hg_addr->na_addr = callback_info->info.lookup.addr;
+    /* Op is freed on failure */
+    ret = hg_core_addr_lookup_start(context, hg_op_id, name);
+    if (ret != HG_SUCCESS)
+        goto done;
 
-    /* Mark as completed */
-    if (hg_core_addr_lookup_complete(hg_op_id) != HG_SUCCESS) {
-        HG_LOG_ERROR("Could not complete operation");
+    /* Assign op_id */
+    if (op_id && op_id != HG_OP_ID_IGNORE)
+        *op_id = (hg_op_id_t) hg_op_id;
+
+    /* TODO to avoid blocking after lookup make progress on the HG layer with
+     * timeout of 0 */
+    progress_ret = context->progress(context, 0);
+    if (progress_ret != HG_SUCCESS && progress_ret != HG_TIMEOUT) {
+        HG_LOG_ERROR("Could not make progress");
+        ret = progress_ret;
         goto done;
     }
-    ret++;
 
 done:
-    (void) na_ret;
     return ret;
 }
 
 /*---------------------------------------------------------------------------*/
 static hg_return_t
-hg_core_addr_lookup_complete(struct hg_op_id *hg_op_id)
+hg_core_addr_lookup_batch(struct hg_context *context, hg_cb_t callback,
+    void *arg, const char *const names[], unsigned int count,
+    struct hg_addr *addrs[])
 {
-    hg_context_t *context = hg_op_id->context;
-    struct hg_completion_entry *hg_completion_entry =
-        &hg_op_id->hg_completion_entry;
-    hg_return_t ret = HG_SUCCESS;
-
-    /* Mark operation as completed */
-    hg_atomic_incr32(&hg_op_id->completed);
+    struct hg_core_lookup_batch *batch = NULL;
+    unsigned int i;
+    hg_return_t ret = HG_SUCCESS, progress_ret;
 
-    hg_completion_entry->op_type = HG_ADDR;
-    hg_completion_entry->op_id.hg_op_id = hg_op_id;
+    batch = (struct hg_core_lookup_batch *) malloc(
+        sizeof(struct hg_core_lookup_batch));
+    if (!batch) {
+        HG_LOG_ERROR("Could not allocate lookup batch");
+        ret = HG_NOMEM_ERROR;
+        goto done;
+    }
+    batch->addrs = addrs;
+    batch->count = count;
+    hg_atomic_init32(&batch->ret, HG_SUCCESS);
+    /* Extra count keeps the batch from completing while lookups are posted */
+    hg_atomic_init32(&batch->pending, (hg_util_int32_t) count + 1);
 
-    ret = hg_core_completion_add(context, hg_completion_entry, HG_FALSE);
-    if (ret != HG_SUCCESS) {
-        HG_LOG_ERROR("Could not add HG completion entry to completion queue");
+    /* Op on which user callback is triggered */
+    batch->hg_op_id = hg_core_addr_lookup_op_create(context, callback, arg);
+    if (!batch->hg_op_id) {
+        ret = HG_NOMEM_ERROR;
+        goto done;
+    }
+
+    /* Post all lookups first so that they can all progress concurrently */
+    for (i = 0; i < count; i++) {
+        struct hg_op_id *hg_op_id;
+        hg_return_t lookup_ret = HG_NOMEM_ERROR;
+
+        addrs[i] = HG_ADDR_NULL;
+        hg_op_id = hg_core_addr_lookup_op_create(context, NULL, NULL);
+        if (hg_op_id) {
+            hg_op_id->info.lookup.batch = batch;
+            hg_op_id->info.lookup.index = i;
+            lookup_ret = hg_core_addr_lookup_start(context, hg_op_id,
+                names[i]);
+        }
+        if (lookup_ret != HG_SUCCESS) {
+            HG_LOG_ERROR("Could not start lookup for address %s", names[i]);
+            hg_core_addr_lookup_batch_complete(batch, i, NULL, lookup_ret,
+                HG_TRUE);
+        }
+    }
+
+    /* Single progress call for the whole batch */
+    progress_ret = context->progress(context, 0);
+    if (progress_ret != HG_SUCCESS && progress_ret != HG_TIMEOUT)
+        HG_LOG_ERROR("Could not make progress");
+
+    /* Release extra count, batch completes here if all lookups did */
+    hg_core_addr_lookup_batch_complete(batch, count, NULL, HG_SUCCESS,
+        HG_TRUE);
+    batch = NULL;
+
+done:
+    if (batch) {
+        free(batch->hg_op_id);
+        free(batch);
+    }
+    return ret;
+}
+
+/*---------------------------------------------------------------------------*/
+static hg_return_t
+hg_core_addr_lookup_batch_complete(struct hg_core_lookup_batch *batch,
+    unsigned int index, struct hg_addr *hg_addr, hg_return_t lookup_ret,
+    hg_bool_t notify)
+{
+    struct hg_op_id *hg_op_id = batch->hg_op_id;
+    hg_return_t ret = HG_SUCCESS;
+
+    /* Index past the end only releases the extra count */
+    if (index < batch->count) {
+        batch->addrs[index] = hg_addr;
+        if (lookup_ret != HG_SUCCESS)
+            hg_atomic_cas32(&batch->ret, HG_SUCCESS, lookup_ret);
+    }
+
+    if (hg_atomic_decr32(&batch->pending))
+        goto done;
+
+    /* All lookups are done, report first error if any */
+    hg_op_id->info.lookup.ret = (hg_return_t) hg_atomic_get32(&batch->ret);
+    free(batch);
+
+    ret = hg_core_addr_lookup_complete(hg_op_id, notify);
+    if (ret != HG_SUCCESS) {
+        HG_LOG_ERROR("Could not complete operation");
+        goto done;
+    }
+
+done:
+    return ret;
+}
+
+/*---------------------------------------------------------------------------*/
+static int
+hg_core_addr_lookup_cb(const struct na_cb_info *callback_info)
+{
+    struct hg_op_id *hg_op_id = (struct hg_op_id *) callback_info->arg;
+    na_return_t na_ret = NA_SUCCESS;
+    int ret = 0;
+
+    if (callback_info->ret != NA_SUCCESS) {
+        /* Report failure */
+        hg_op_id->info.lookup.ret = (callback_info->ret == NA_CANCELED) ?
+            HG_CANCELED : HG_NA_ERROR;
+        hg_op_id->info.lookup.noentry =
+            (callback_info->ret == NA_NOENTRY_ERROR);
+        hg_core_addr_free(hg_op_id->context->hg_class,
+            hg_op_id->info.lookup.hg_addr);
+        hg_op_id->info.lookup.hg_addr = NULL;
+    } else {
+        /* Assign addr */
+        hg_op_id->info.lookup.hg_addr->na_addr =
+            callback_info->info.lookup.addr;
+    }
+
+    /* Complete cache entry and lookups waiting on it */
+    if (hg_op_id->info.lookup.cache_entry)
+        hg_core_addr_cache_complete(hg_op_id->context->hg_class,
+            hg_op_id->info.lookup.cache_entry, hg_op_id->info.lookup.hg_addr,
+            hg_op_id->info.lookup.ret, hg_op_id->info.lookup.noentry);
+
+    /* Mark as completed */
+    if (hg_core_addr_lookup_complete(hg_op_id, HG_FALSE) != HG_SUCCESS) {
+        HG_LOG_ERROR("Could not complete operation");
+        goto done;
+    }
+    ret++;
+
+done:
+    (void) na_ret;
+    return ret;
+}
+
+/*---------------------------------------------------------------------------*/
+static hg_return_t
+hg_core_addr_lookup_complete(struct hg_op_id *hg_op_id, hg_bool_t notify)
+{
+    hg_context_t *context = hg_op_id->context;
+    struct hg_completion_entry *hg_completion_entry =
+        &hg_op_id->hg_completion_entry;
+    hg_return_t ret = HG_SUCCESS;
+
+    /* Lookups of a batch are only reported through the batch op */
+    if (hg_op_id->info.lookup.batch) {
+        struct hg_core_lookup_batch *batch = hg_op_id->info.lookup.batch;
+        unsigned int index = hg_op_id->info.lookup.index;
+        struct hg_addr *hg_addr = hg_op_id->info.lookup.hg_addr;
+        hg_return_t lookup_ret = hg_op_id->info.lookup.ret;
+
+        /* Op id and addr now belong to the batch, its errors must not be
+         * reported to the caller, who would free them again */
+        free(hg_op_id);
+        if (hg_core_addr_lookup_batch_complete(batch, index, hg_addr,
+            lookup_ret, notify) != HG_SUCCESS)
+            HG_LOG_ERROR("Could not complete batch operation");
+        goto done;
+    }
+
+    /* Mark operation as completed */
+    hg_atomic_incr32(&hg_op_id->completed);
+
+    hg_completion_entry->op_type = HG_ADDR;
+    hg_completion_entry->op_id.hg_op_id = hg_op_id;
+
+    ret = hg_core_completion_add(context, hg_completion_entry, notify);
+    if (ret != HG_SUCCESS) {
+        HG_LOG_ERROR("Could not add HG completion entry to completion queue");
         goto done;
     }
 
@@ -1492,12 +2507,240 @@ hg_core_addr_free(struct hg_class *hg_class, struct hg_addr *hg_addr)
         ret = HG_NA_ERROR;
         goto done;
     }
+    hg_thread_spin_destroy(&hg_addr->credit_lock);
     free(hg_addr);
 
 done:
     return ret;
 }
 
+/*---------------------------------------------------------------------------*/
+static HG_INLINE int
+hg_core_addr_cache_equal(void *vlocation1, void *vlocation2)
+{
+    return strcmp((const char *) vlocation1, (const char *) vlocation2) == 0;
+}
+
+/*---------------------------------------------------------------------------*/
+static HG_INLINE unsigned int
+hg_core_addr_cache_hash(void *vlocation)
+{
+    return hg_hash_string((const char *) vlocation);
+}
+
+/*---------------------------------------------------------------------------*/
+static void
+hg_core_addr_cache_entry_free(struct hg_class *hg_class,
+    struct hg_addr_cache_entry *entry)
+{
+    if (entry->hg_addr)
+        hg_core_addr_free(hg_class, entry->hg_addr);
+    free(entry->name);
+    free(entry);
+}
+
+/*---------------------------------------------------------------------------*/
+static hg_return_t
+hg_core_addr_cache_lookup(struct hg_context *context,
+    struct hg_op_id *hg_op_id, const char *name, hg_bool_t *owner)
+{
+    struct hg_class *hg_class = context->hg_class;
+    struct hg_addr_cache_entry *entry;
+    hg_bool_t complete = HG_FALSE;
+    hg_return_t ret = HG_SUCCESS;
+
+    hg_thread_mutex_lock(&hg_class->addr_cache_mutex);
+
+    entry = (struct hg_addr_cache_entry *) hg_hash_table_lookup(
+        hg_class->addr_cache, (hg_hash_table_key_t) (uintptr_t) name);
+
+    /* Negative entries are retried once expired */
+    if (entry && entry->state == HG_CORE_ADDR_FAILED) {
+        hg_time_t now;
+
+        hg_time_get_current(&now);
+        if (hg_time_to_double(now) >= entry->expire) {
+            hg_hash_table_remove(hg_class->addr_cache,
+                (hg_hash_table_key_t) entry->name);
+            hg_core_addr_cache_entry_free(hg_class, entry);
+            entry = NULL;
+        }
+    }
+
+    if (!entry) {
+        /* Caller issues the lookup */
+        entry = (struct hg_addr_cache_entry *) malloc(
+            sizeof(struct hg_addr_cache_entry));
+        if (!entry) {
+            HG_LOG_ERROR("Could not allocate addr cache entry");
+            ret = HG_NOMEM_ERROR;
+            goto unlock;
+        }
+        memset(entry, 0, sizeof(struct hg_addr_cache_entry));
+        entry->name = strdup(name);
+        if (!entry->name) {
+            HG_LOG_ERROR("Could not duplicate lookup name");
+            free(entry);
+            ret = HG_NOMEM_ERROR;
+            goto unlock;
+        }
+        entry->state = HG_CORE_ADDR_PENDING;
+        if (!hg_hash_table_insert(hg_class->addr_cache,
+            (hg_hash_table_key_t) entry->name, entry)) {
+            HG_LOG_ERROR("Could not insert addr cache entry");
+            free(entry->name);
+            free(entry);
+            ret = HG_NOMEM_ERROR;
+            goto unlock;
+        }
+        hg_op_id->info.lookup.cache_entry = entry;
+        *owner = HG_TRUE;
+        goto unlock;
+    }
+
+    switch (entry->state) {
+        case HG_CORE_ADDR_RESOLVED:
+            hg_atomic_incr32(&entry->hg_addr->ref_count);
+            hg_op_id->info.lookup.hg_addr = entry->hg_addr;
+            complete = HG_TRUE;
+            break;
+        case HG_CORE_ADDR_PENDING:
+            /* Coalesce with lookup in progress */
+            hg_op_id->info.lookup.next = entry->waiters;
+            entry->waiters = hg_op_id;
+            break;
+        case HG_CORE_ADDR_FAILED:
+        default:
+            /* Reported through the callback like any other failure */
+            hg_op_id->info.lookup.ret = entry->ret;
+            complete = HG_TRUE;
+            break;
+    }
+    *owner = HG_FALSE;
+
+unlock:
+    hg_thread_mutex_unlock(&hg_class->addr_cache_mutex);
+
+    /* Not called from progress */
+    if (complete) {
+        ret = hg_core_addr_lookup_complete(hg_op_id, HG_TRUE);
+        if (ret != HG_SUCCESS) {
+            HG_LOG_ERROR("Could not complete operation");
+            hg_core_addr_free(hg_class, hg_op_id->info.lookup.hg_addr);
+        }
+    }
+
+    return ret;
+}
+
+/*---------------------------------------------------------------------------*/
+static void
+hg_core_addr_cache_complete(struct hg_class *hg_class,
+    struct hg_addr_cache_entry *entry, struct hg_addr *hg_addr,
+    hg_return_t lookup_ret, hg_bool_t noentry)
+{
+    struct hg_op_id *waiters, *hg_op_id;
+    hg_bool_t remove = HG_FALSE;
+
+    hg_thread_mutex_lock(&hg_class->addr_cache_mutex);
+
+    waiters = entry->waiters;
+    entry->waiters = NULL;
+    for (hg_op_id = waiters; hg_op_id; hg_op_id = hg_op_id->info.lookup.next) {
+        hg_op_id->info.lookup.ret = lookup_ret;
+        if (lookup_ret == HG_SUCCESS) {
+            hg_atomic_incr32(&hg_addr->ref_count);
+            hg_op_id->info.lookup.hg_addr = hg_addr;
+        }
+    }
+
+    if (lookup_ret == HG_SUCCESS) {
+        hg_atomic_incr32(&hg_addr->ref_count);
+        entry->hg_addr = hg_addr;
+        entry->state = HG_CORE_ADDR_RESOLVED;
+    } else {
+        hg_time_t now;
+
+        hg_time_get_current(&now);
+        entry->state = HG_CORE_ADDR_FAILED;
+        entry->ret = lookup_ret;
+        entry->expire = hg_time_to_double(now) + hg_class->addr_cache_neg_ttl;
+
+        /* Only names that do not exist are kept, transient failures (e.g.,
+         * no memory, canceled) are retried by the next lookup */
+        remove = (!noentry || hg_class->addr_cache_neg_ttl <= 0);
+    }
+
+    if (remove && !entry->invalidated)
+        hg_hash_table_remove(hg_class->addr_cache,
+            (hg_hash_table_key_t) entry->name);
+
+    /* Entry was already removed from the cache if invalidated */
+    remove = (remove || entry->invalidated);
+
+    hg_thread_mutex_unlock(&hg_class->addr_cache_mutex);
+
+    if (remove)
+        hg_core_addr_cache_entry_free(hg_class, entry);
+
+    /* Waiters may belong to other contexts */
+    while (waiters) {
+        hg_op_id = waiters;
+        waiters = hg_op_id->info.lookup.next;
+        if (hg_core_addr_lookup_complete(hg_op_id, HG_TRUE) != HG_SUCCESS)
+            HG_LOG_ERROR("Could not complete operation");
+    }
+}
+
+/*---------------------------------------------------------------------------*/
+static void
+hg_core_addr_cache_invalidate(struct hg_class *hg_class, const char *name)
+{
+    struct hg_addr_cache_entry *entry;
+
+    hg_thread_mutex_lock(&hg_class->addr_cache_mutex);
+
+    if (name) {
+        entry = (struct hg_addr_cache_entry *) hg_hash_table_lookup(
+            hg_class->addr_cache, (hg_hash_table_key_t) (uintptr_t) name);
+        if (entry) {
+            hg_hash_table_remove(hg_class->addr_cache,
+                (hg_hash_table_key_t) entry->name);
+            /* Pending entries are freed by their lookup owner */
+            if (entry->state == HG_CORE_ADDR_PENDING)
+                entry->invalidated = HG_TRUE;
+            else
+                hg_core_addr_cache_entry_free(hg_class, entry);
+        }
+    } else {
+        hg_hash_table_t *addr_cache = hg_class->addr_cache;
+        hg_hash_table_iter_t iter;
+
+        hg_class->addr_cache = hg_hash_table_new(hg_core_addr_cache_hash,
+            hg_core_addr_cache_equal);
+        if (!hg_class->addr_cache) {
+            /* Keep cache as is */
+            HG_LOG_ERROR("Could not create addr cache");
+            hg_class->addr_cache = addr_cache;
+            goto unlock;
+        }
+
+        hg_hash_table_iterate(addr_cache, &iter);
+        while (hg_hash_table_iter_has_more(&iter)) {
+            entry = (struct hg_addr_cache_entry *) hg_hash_table_iter_next(
+                &iter);
+            if (entry->state == HG_CORE_ADDR_PENDING)
+                entry->invalidated = HG_TRUE;
+            else
+                hg_core_addr_cache_entry_free(hg_class, entry);
+        }
+        hg_hash_table_free(addr_cache);
+    }
+
+unlock:
+    hg_thread_mutex_unlock(&hg_class->addr_cache_mutex);
+}
+
 /*---------------------------------------------------------------------------*/
 static hg_return_t
 hg_core_addr_self(struct hg_class *hg_class, struct hg_addr **self_addr)
@@ -1770,12 +3013,23 @@ hg_core_destroy(struct hg_handle *hg_handle)
         goto done;
     }
 
+    /* Handle of a batch request is kept for the next batches */
+    if (hg_handle->pooled && hg_core_batch_pool_put(hg_handle))
+        goto done;
+
     /* Decrement N handles from HG context */
     hg_atomic_decr32(&hg_handle->hg_info.context->n_handles);
 
+    /* Request was dropped before it was answered */
+    hg_core_origin_release(hg_handle);
+
     /* Remove reference to HG addr */
     hg_core_addr_free(hg_handle->hg_info.hg_class, hg_handle->hg_info.addr);
 
+    /* Remove reference to multi forward */
+    if (hg_handle->multi)
+        hg_core_multi_release(hg_handle->multi);
+
     na_ret = NA_Op_destroy(hg_handle->na_class, hg_handle->na_send_op_id);
     if (na_ret != NA_SUCCESS)
         HG_LOG_ERROR("Could not destroy NA op ID");
@@ -1827,6 +3081,7 @@ hg_core_reset(struct hg_handle *hg_handle, hg_bool_t reset_info)
 
     /* Reset source address */
     if (reset_info) {
+        hg_core_origin_release(hg_handle);
         if (hg_handle->hg_info.addr != HG_ADDR_NULL
             && hg_handle->hg_info.addr->na_addr != NA_ADDR_NULL) {
             NA_Addr_free(hg_handle->na_class, hg_handle->hg_info.addr->na_addr);
@@ -1848,6 +3103,10 @@ hg_core_reset(struct hg_handle *hg_handle, hg_bool_t reset_info)
     hg_handle->na_op_count = 1; /* Default (no response) */
     hg_atomic_set32(&hg_handle->na_op_completed_count, 0);
     hg_handle->no_response = HG_FALSE;
+    if (hg_handle->multi) {
+        hg_core_multi_release(hg_handle->multi);
+        hg_handle->multi = NULL;
+    }
 
     /* Free extra data here if needed */
     if (hg_handle->hg_info.hg_class->more_data_release)
@@ -1907,6 +3166,9 @@ hg_core_set_rpc(struct hg_handle *hg_handle, hg_addr_t addr, hg_id_t id)
 
         /* Cache RPC info */
         hg_handle->hg_rpc_info = hg_rpc_info;
+
+        /* Encoded request header no longer matches */
+        hg_handle->header_encoded = HG_FALSE;
     }
 
 done:
@@ -1932,6 +3194,86 @@ hg_core_get_thread_work(hg_handle_t handle)
     return &((struct hg_handle *) handle)->thread_work;
 }
 
+/*---------------------------------------------------------------------------*/
+static hg_return_t
+hg_core_set_iov(struct hg_handle *hg_handle, struct hg_core_iov *hg_core_iov,
+    void *buf, na_size_t buf_size, na_size_t *buf_used, hg_uint32_t count,
+    void **buf_ptrs, const hg_size_t *buf_sizes)
+{
+    na_size_t iov_size = 0;
+    hg_uint32_t i;
+    hg_return_t ret = HG_SUCCESS;
+
+    hg_core_iov->count = 0;
+    if (!count)
+        goto done;
+
+    for (i = 0; i < count; i++)
+        iov_size += buf_sizes[i];
+    if (*buf_used + iov_size > buf_size) {
+        HG_LOG_ERROR("Exceeding buffer size");
+        ret = HG_SIZE_ERROR;
+        goto done;
+    }
+
+    /* Self processing and plugins that cannot gather segments need the
+     * payload to be contiguous, so do long lists that would not fit into
+     * the segment array (header buffer takes one segment) */
+    if (hg_handle->is_self || count >= HG_CORE_IOV_SEGMENTS_MAX
+        || !NA_Check_feature(hg_handle->na_class, NA_HAS_MSG_SEGMENTS)) {
+        char *buf_ptr = (char *) buf + *buf_used;
+
+        for (i = 0; i < count; i++) {
+            memcpy(buf_ptr, buf_ptrs[i], buf_sizes[i]);
+            buf_ptr += buf_sizes[i];
+        }
+        *buf_used += iov_size;
+        goto done;
+    }
+
+    hg_core_iov->buf_ptrs = buf_ptrs;
+    hg_core_iov->buf_sizes = buf_sizes;
+    hg_core_iov->count = count;
+
+done:
+    return ret;
+}
+
+/*---------------------------------------------------------------------------*/
+static na_return_t
+hg_core_send_iov(struct hg_handle *hg_handle, na_bool_t unexpected,
+    na_cb_t callback, void *buf, na_size_t buf_size, void *plugin_data,
+    const struct hg_core_iov *hg_core_iov)
+{
+    /* Segment array is not referenced by NA once the send is posted, count
+     * is bounded by hg_core_set_iov() */
+    struct na_segment segments[HG_CORE_IOV_SEGMENTS_MAX];
+    hg_uint32_t i;
+    na_return_t ret;
+
+    segments[0].address = (na_ptr_t) buf;
+    segments[0].size = buf_size;
+    for (i = 0; i < hg_core_iov->count; i++) {
+        segments[i + 1].address = (na_ptr_t) hg_core_iov->buf_ptrs[i];
+        segments[i + 1].size = hg_core_iov->buf_sizes[i];
+    }
+
+    if (unexpected)
+        ret = NA_Msg_send_unexpected_segments(hg_handle->na_class,
+            hg_handle->na_context, callback, hg_handle, segments,
+            hg_core_iov->count + 1, plugin_data,
+            hg_handle->hg_info.addr->na_addr, hg_handle->tag,
+            &hg_handle->na_send_op_id);
+    else
+        ret = NA_Msg_send_expected_segments(hg_handle->na_class,
+            hg_handle->na_context, callback, hg_handle, segments,
+            hg_core_iov->count + 1, plugin_data,
+            hg_handle->hg_info.addr->na_addr, hg_handle->tag,
+            &hg_handle->na_send_op_id);
+
+    return ret;
+}
+
 /*---------------------------------------------------------------------------*/
 #ifdef HG_HAS_SELF_FORWARD
 static hg_return_t
@@ -1997,19 +3339,37 @@ hg_core_forward_na(struct hg_handle *hg_handle)
     }
 
     /* And post the send message (input) */
-    na_ret = NA_Msg_send_unexpected(hg_handle->na_class, hg_handle->na_context,
-        hg_core_send_input_cb, hg_handle, hg_handle->in_buf,
-        hg_handle->in_buf_used, hg_handle->in_buf_plugin_data,
-        hg_handle->hg_info.addr->na_addr, hg_handle->tag,
-        &hg_handle->na_send_op_id);
+    HG_TRACE(HG_TRACE_SEND_POST, hg_handle, hg_handle->hg_info.id,
+        hg_handle->in_buf_used);
+    if (hg_core_batch_can_add(hg_handle))
+        na_ret = hg_core_batch_add(hg_handle);
+    else if (hg_handle->in_iov.count)
+        na_ret = hg_core_send_iov(hg_handle, NA_TRUE, hg_core_send_input_cb,
+            hg_handle->in_buf, hg_handle->in_buf_used,
+            hg_handle->in_buf_plugin_data, &hg_handle->in_iov);
+    else
+        na_ret = NA_Msg_send_unexpected(hg_handle->na_class,
+            hg_handle->na_context, hg_core_send_input_cb, hg_handle,
+            hg_handle->in_buf, hg_handle->in_buf_used,
+            hg_handle->in_buf_plugin_data, hg_handle->hg_info.addr->na_addr,
+            hg_handle->tag, &hg_handle->na_send_op_id);
     if (na_ret != NA_SUCCESS) {
         HG_LOG_ERROR("Could not post send for input buffer");
+        /* Forward was delayed for credits and must complete with an error,
+         * either through the canceled recv or directly */
+        if (hg_handle->credit_deferred) {
+            hg_handle->ret = HG_NA_ERROR;
+            if (!hg_handle->no_response)
+                hg_handle->na_op_count--;
+        }
         /* Cancel the above posted recv op */
         na_ret = NA_Cancel(hg_handle->na_class, hg_handle->na_context,
             hg_handle->na_recv_op_id);
         if (na_ret != NA_SUCCESS) {
             HG_LOG_ERROR("Could not cancel recv op id");
         }
+        if (hg_handle->credit_deferred && hg_handle->no_response)
+            hg_core_complete(hg_handle);
         ret = HG_NA_ERROR;
         goto done;
     }
@@ -2019,75 +3379,452 @@ done:
 }
 
 /*---------------------------------------------------------------------------*/
-#ifdef HG_HAS_SELF_FORWARD
-static hg_return_t
-hg_core_respond_self(struct hg_handle *hg_handle)
+static HG_INLINE hg_bool_t
+hg_core_batch_can_add(struct hg_handle *hg_handle)
 {
-    hg_return_t ret = HG_SUCCESS;
+    /* Extra segments and data are not copied, request must also fit in a
+     * batch on its own */
+    return hg_handle->hg_info.context->coalesce && !hg_handle->in_iov.count
+        && !(hg_handle->in_header.msg.request.flags & HG_CORE_MORE_DATA)
+        && hg_handle->in_buf_used + hg_core_header_batch_get_size()
+            + hg_core_header_batch_entry_get_size() <= hg_handle->in_buf_size;
+}
 
-    /* Set operation type for trigger */
-    hg_handle->op_type = HG_CORE_RESPOND_SELF;
+/*---------------------------------------------------------------------------*/
+static na_return_t
+hg_core_batch_add(struct hg_handle *hg_handle)
+{
+    struct hg_context *context = hg_handle->hg_info.context;
+    struct hg_core_batch *hg_core_batch, *full_batch = NULL;
+    struct hg_core_header_batch_entry entry;
+    na_size_t size = hg_handle->in_buf_used - hg_handle->na_in_header_offset;
+    na_return_t ret = NA_SUCCESS;
 
-    /* Remove handle from processing list */
-    hg_thread_spin_lock(&hg_handle->hg_info.context->processing_list_lock);
-    HG_LIST_REMOVE(hg_handle, entry);
-    hg_thread_spin_unlock(&hg_handle->hg_info.context->processing_list_lock);
+    hg_thread_mutex_lock(&context->batch_mutex);
 
-    /* Complete and add to completion queue */
-    ret = hg_core_complete(hg_handle);
-    if (ret != HG_SUCCESS) {
-        HG_LOG_ERROR("Could not complete handle");
-        goto done;
-    }
+    HG_LIST_FOREACH(hg_core_batch, &context->batch_list, entry)
+        if (hg_core_batch->addr == hg_handle->hg_info.addr
+            && hg_core_batch->na_class == hg_handle->na_class)
+            break;
+
+    /* Send current batch first if request does not fit */
+    if (hg_core_batch && hg_core_batch->buf_used
+        + hg_core_header_batch_entry_get_size() + size
+        > hg_core_batch->buf_size) {
+        hg_core_batch_remove(hg_core_batch);
+        full_batch = hg_core_batch;
+        hg_core_batch = NULL;
+    }
+
+    if (!hg_core_batch) {
+        hg_core_batch = (struct hg_core_batch *) malloc(
+            sizeof(struct hg_core_batch));
+        if (!hg_core_batch) {
+            HG_LOG_ERROR("Could not allocate batch");
+            ret = NA_NOMEM_ERROR;
+            goto unlock;
+        }
+        memset(hg_core_batch, 0, sizeof(struct hg_core_batch));
+        hg_core_batch->hg_class = hg_handle->hg_info.hg_class;
+        hg_core_batch->context = context;
+        hg_core_batch->na_class = hg_handle->na_class;
+        hg_core_batch->na_context = hg_handle->na_context;
+        hg_core_batch->buf_size = hg_handle->in_buf_size;
+        hg_core_batch->buf = NA_Msg_buf_alloc(hg_core_batch->na_class,
+            hg_core_batch->buf_size, &hg_core_batch->buf_plugin_data);
+        if (!hg_core_batch->buf) {
+            HG_LOG_ERROR("Could not allocate buffer for batch");
+            free(hg_core_batch);
+            ret = NA_NOMEM_ERROR;
+            goto unlock;
+        }
+        NA_Msg_init_unexpected(hg_core_batch->na_class, hg_core_batch->buf,
+            hg_core_batch->buf_size);
+        hg_core_batch->header_offset = hg_handle->na_in_header_offset;
+        hg_core_batch->buf_used = hg_core_batch->header_offset
+            + hg_core_header_batch_get_size();
+        hg_core_batch->tag = hg_handle->tag;
+        HG_QUEUE_INIT(&hg_core_batch->handle_queue);
+
+        /* Keep addr until batch is sent */
+        hg_core_batch->addr = hg_handle->hg_info.addr;
+        hg_atomic_incr32(&hg_core_batch->addr->ref_count);
+
+        hg_time_get_current(&hg_core_batch->deadline);
+        hg_core_batch->deadline = hg_time_add(hg_core_batch->deadline,
+            hg_time_from_double(context->batch_window / 1000.0));
+
+        HG_LIST_INSERT_HEAD(&context->batch_list, hg_core_batch, entry);
+    }
+
+    /* Append request, response is sent to its own tag */
+    entry.tag = (hg_uint32_t) hg_handle->tag;
+    entry.size = (hg_uint32_t) size;
+    hg_handle->batch = hg_core_batch;
+    hg_handle->batch_offset = hg_core_batch->buf_used;
+    hg_core_header_batch_entry_proc(HG_ENCODE,
+        (char *) hg_core_batch->buf + hg_core_batch->buf_used,
+        hg_core_batch->buf_size - hg_core_batch->buf_used, &entry);
+    hg_core_batch->buf_used += hg_core_header_batch_entry_get_size();
+    memcpy((char *) hg_core_batch->buf + hg_core_batch->buf_used,
+        (char *) hg_handle->in_buf + hg_handle->na_in_header_offset, size);
+    hg_core_batch->buf_used += size;
+    hg_core_batch->header.count++;
+    HG_QUEUE_PUSH_TAIL(&hg_core_batch->handle_queue, hg_handle, batch_entry);
+
+unlock:
+    hg_thread_mutex_unlock(&context->batch_mutex);
+
+    if (full_batch)
+        hg_core_batch_send(full_batch);
 
-done:
     return ret;
 }
 
 /*---------------------------------------------------------------------------*/
-static hg_return_t
-hg_core_no_respond_self(struct hg_handle *hg_handle)
+static void
+hg_core_batch_remove(struct hg_core_batch *hg_core_batch)
 {
-    hg_return_t ret = HG_SUCCESS;
-
-    /* Set operation type for trigger */
-    hg_handle->op_type = HG_CORE_FORWARD_SELF;
-
-    /* Remove handle from processing list */
-    hg_thread_spin_lock(&hg_handle->hg_info.context->processing_list_lock);
-    HG_LIST_REMOVE(hg_handle, entry);
-    hg_thread_spin_unlock(&hg_handle->hg_info.context->processing_list_lock);
+    struct hg_handle *hg_handle;
 
-    /* Complete and add to completion queue */
-    ret = hg_core_complete(hg_handle);
-    if (ret != HG_SUCCESS) {
-        HG_LOG_ERROR("Could not complete handle");
-        goto done;
-    }
-
-done:
-    return ret;
+    HG_LIST_REMOVE(hg_core_batch, entry);
+    HG_QUEUE_FOREACH(hg_handle, &hg_core_batch->handle_queue, batch_entry)
+        hg_handle->batch = NULL;
 }
-#endif
 
 /*---------------------------------------------------------------------------*/
-static hg_return_t
-hg_core_respond_na(struct hg_handle *hg_handle)
+static void
+hg_core_batch_send(struct hg_core_batch *hg_core_batch)
 {
-    hg_return_t ret = HG_SUCCESS;
     na_return_t na_ret;
 
-    /* Set operation type for trigger */
-    hg_handle->op_type = HG_CORE_RESPOND;
+    hg_core_header_batch_proc(HG_ENCODE,
+        (char *) hg_core_batch->buf + hg_core_batch->header_offset,
+        hg_core_batch->buf_size - hg_core_batch->header_offset,
+        &hg_core_batch->header);
+
+    na_ret = NA_Msg_send_unexpected(hg_core_batch->na_class,
+        hg_core_batch->na_context, hg_core_batch_send_cb, hg_core_batch,
+        hg_core_batch->buf, hg_core_batch->buf_used,
+        hg_core_batch->buf_plugin_data, hg_core_batch->addr->na_addr,
+        hg_core_batch->tag, NA_OP_ID_IGNORE);
+    if (na_ret != NA_SUCCESS) {
+        HG_LOG_ERROR("Could not post send for batch");
+        hg_core_batch_fail(hg_core_batch);
+        hg_core_batch_free(hg_core_batch);
+        return;
+    }
+#ifdef HG_HAS_COLLECT_STATS
+    hg_atomic_incr64(&hg_core_batch->context->acct.batch_count);
+    hg_atomic_add64(&hg_core_batch->context->acct.batch_rpc_count,
+        (hg_util_int64_t) hg_core_batch->header.count);
+#endif
+}
+
+/*---------------------------------------------------------------------------*/
+static void
+hg_core_batch_flush(struct hg_context *context, hg_bool_t force)
+{
+    HG_LIST_HEAD(hg_core_batch) send_list;
+    struct hg_core_batch *hg_core_batch, *hg_core_batch_next;
+    hg_time_t now;
+
+    if (HG_LIST_IS_EMPTY(&context->batch_list))
+        return;
+
+    HG_LIST_INIT(&send_list);
+    hg_time_get_current(&now);
+
+    hg_thread_mutex_lock(&context->batch_mutex);
+    hg_core_batch = HG_LIST_FIRST(&context->batch_list);
+    while (hg_core_batch) {
+        hg_core_batch_next = HG_LIST_NEXT(hg_core_batch, entry);
+        if (force || !hg_time_less(now, hg_core_batch->deadline)) {
+            hg_core_batch_remove(hg_core_batch);
+            HG_LIST_INSERT_HEAD(&send_list, hg_core_batch, entry);
+        }
+        hg_core_batch = hg_core_batch_next;
+    }
+    hg_thread_mutex_unlock(&context->batch_mutex);
+
+    /* Send outside of lock */
+    hg_core_batch = HG_LIST_FIRST(&send_list);
+    while (hg_core_batch) {
+        hg_core_batch_next = HG_LIST_NEXT(hg_core_batch, entry);
+        hg_core_batch_send(hg_core_batch);
+        hg_core_batch = hg_core_batch_next;
+    }
+}
+
+/*---------------------------------------------------------------------------*/
+static void
+hg_core_batch_fail(struct hg_core_batch *hg_core_batch)
+{
+    while (!HG_QUEUE_IS_EMPTY(&hg_core_batch->handle_queue)) {
+        struct hg_handle *hg_handle =
+            HG_QUEUE_FIRST(&hg_core_batch->handle_queue);
+
+        HG_QUEUE_POP_HEAD(&hg_core_batch->handle_queue, batch_entry);
+        hg_core_batch_drop(hg_handle, HG_NA_ERROR);
+    }
+}
+
+/*---------------------------------------------------------------------------*/
+static void
+hg_core_batch_drop(struct hg_handle *hg_handle, hg_return_t ret)
+{
+    /* Complete either through the canceled recv or directly */
+    hg_handle->ret = ret;
+    if (hg_handle->no_response)
+        hg_core_complete(hg_handle);
+    else {
+        hg_handle->na_op_count--;
+        if (NA_Cancel(hg_handle->na_class, hg_handle->na_context,
+            hg_handle->na_recv_op_id) != NA_SUCCESS)
+            HG_LOG_ERROR("Could not cancel recv op id");
+    }
+}
+
+/*---------------------------------------------------------------------------*/
+static hg_bool_t
+hg_core_batch_cancel(struct hg_handle *hg_handle)
+{
+    struct hg_context *context = hg_handle->hg_info.context;
+    struct hg_core_batch *hg_core_batch, *empty_batch = NULL;
+    struct hg_handle *hg_next_handle;
+    na_size_t entry_size, entry_end;
+
+    hg_thread_mutex_lock(&context->batch_mutex);
+    hg_core_batch = hg_handle->batch;
+    if (!hg_core_batch) {
+        /* Not coalesced or batch already sent */
+        hg_thread_mutex_unlock(&context->batch_mutex);
+        return HG_FALSE;
+    }
+
+    /* Close the gap left by the entry, later entries move down */
+    entry_size = hg_core_header_batch_entry_get_size()
+        + hg_handle->in_buf_used - hg_handle->na_in_header_offset;
+    entry_end = hg_handle->batch_offset + entry_size;
+    memmove((char *) hg_core_batch->buf + hg_handle->batch_offset,
+        (char *) hg_core_batch->buf + entry_end,
+        hg_core_batch->buf_used - entry_end);
+    hg_core_batch->buf_used -= entry_size;
+    hg_core_batch->header.count--;
+    HG_QUEUE_FOREACH(hg_next_handle, &hg_core_batch->handle_queue, batch_entry)
+        if (hg_next_handle->batch_offset > hg_handle->batch_offset)
+            hg_next_handle->batch_offset -= entry_size;
+    HG_QUEUE_REMOVE(&hg_core_batch->handle_queue, hg_handle, hg_handle,
+        batch_entry);
+    hg_handle->batch = NULL;
+
+    if (HG_QUEUE_IS_EMPTY(&hg_core_batch->handle_queue)) {
+        HG_LIST_REMOVE(hg_core_batch, entry);
+        empty_batch = hg_core_batch;
+    }
+    hg_thread_mutex_unlock(&context->batch_mutex);
+
+    if (empty_batch)
+        hg_core_batch_free(empty_batch);
+    hg_core_batch_drop(hg_handle, HG_CANCELED);
+
+    return HG_TRUE;
+}
+
+/*---------------------------------------------------------------------------*/
+static void
+hg_core_batch_free(struct hg_core_batch *hg_core_batch)
+{
+    NA_Msg_buf_free(hg_core_batch->na_class, hg_core_batch->buf,
+        hg_core_batch->buf_plugin_data);
+    hg_core_addr_free(hg_core_batch->hg_class, hg_core_batch->addr);
+    free(hg_core_batch);
+}
+
+/*---------------------------------------------------------------------------*/
+static int
+hg_core_batch_send_cb(const struct na_cb_info *callback_info)
+{
+    struct hg_core_batch *hg_core_batch =
+        (struct hg_core_batch *) callback_info->arg;
+    struct na_cb_info handle_cb_info = *callback_info;
+    int ret = 0;
+
+    /* Each forward completes its send as if it had been sent alone */
+    while (!HG_QUEUE_IS_EMPTY(&hg_core_batch->handle_queue)) {
+        struct hg_handle *hg_handle =
+            HG_QUEUE_FIRST(&hg_core_batch->handle_queue);
+
+        HG_QUEUE_POP_HEAD(&hg_core_batch->handle_queue, batch_entry);
+        handle_cb_info.arg = hg_handle;
+        ret += hg_core_send_input_cb(&handle_cb_info);
+    }
+    hg_core_batch_free(hg_core_batch);
+
+    return ret;
+}
+
+/*---------------------------------------------------------------------------*/
+static struct hg_handle *
+hg_core_batch_pool_get(struct hg_context *context, hg_bool_t use_sm)
+{
+    na_class_t *na_class = context->hg_class->na_class;
+    struct hg_handle *hg_handle;
+
+#ifdef HG_HAS_SM_ROUTING
+    if (use_sm)
+        na_class = context->hg_class->na_sm_class;
+#endif
+
+    hg_thread_spin_lock(&context->batch_pool_lock);
+    HG_LIST_FOREACH(hg_handle, &context->batch_pool, entry)
+        if (hg_handle->na_class == na_class)
+            break;
+    if (hg_handle) {
+        HG_LIST_REMOVE(hg_handle, entry);
+        context->batch_pool_count--;
+    }
+    hg_thread_spin_unlock(&context->batch_pool_lock);
+
+    if (!hg_handle) {
+        hg_handle = hg_core_create(context, use_sm);
+        if (!hg_handle) {
+            HG_LOG_ERROR("Could not create HG handle");
+            goto done;
+        }
+        hg_handle->pooled = HG_TRUE;
+    }
+
+done:
+    return hg_handle;
+}
+
+/*---------------------------------------------------------------------------*/
+static hg_bool_t
+hg_core_batch_pool_put(struct hg_handle *hg_handle)
+{
+    struct hg_context *context = hg_handle->hg_info.context;
+    hg_bool_t ret = HG_FALSE;
+
+    /* Addr is shared with other requests of the batch, only drop ref */
+    hg_core_origin_release(hg_handle);
+    hg_core_addr_free(hg_handle->hg_info.hg_class, hg_handle->hg_info.addr);
+    hg_handle->hg_info.addr = HG_ADDR_NULL;
+    if (hg_core_reset(hg_handle, HG_TRUE) != HG_SUCCESS)
+        goto done;
+    hg_atomic_set32(&hg_handle->ref_count, 1);
+    hg_handle->hg_rpc_info = NULL;
+
+    hg_thread_spin_lock(&context->batch_pool_lock);
+    if (!context->finalizing
+        && context->batch_pool_count < HG_CORE_BATCH_POOL_MAX) {
+        HG_LIST_INSERT_HEAD(&context->batch_pool, hg_handle, entry);
+        context->batch_pool_count++;
+        ret = HG_TRUE;
+    }
+    hg_thread_spin_unlock(&context->batch_pool_lock);
+
+done:
+    return ret;
+}
+
+/*---------------------------------------------------------------------------*/
+static void
+hg_core_batch_pool_free(struct hg_context *context)
+{
+    hg_thread_spin_lock(&context->batch_pool_lock);
+    while (!HG_LIST_IS_EMPTY(&context->batch_pool)) {
+        struct hg_handle *hg_handle = HG_LIST_FIRST(&context->batch_pool);
+
+        HG_LIST_REMOVE(hg_handle, entry);
+        context->batch_pool_count--;
+        hg_thread_spin_unlock(&context->batch_pool_lock);
+
+        hg_handle->pooled = HG_FALSE;
+        hg_core_destroy(hg_handle);
+
+        hg_thread_spin_lock(&context->batch_pool_lock);
+    }
+    hg_thread_spin_unlock(&context->batch_pool_lock);
+}
+
+/*---------------------------------------------------------------------------*/
+#ifdef HG_HAS_SELF_FORWARD
+static hg_return_t
+hg_core_respond_self(struct hg_handle *hg_handle)
+{
+    hg_return_t ret = HG_SUCCESS;
+
+    /* Set operation type for trigger */
+    hg_handle->op_type = HG_CORE_RESPOND_SELF;
+
+    /* Remove handle from processing list */
+    hg_thread_spin_lock(&hg_handle->hg_info.context->processing_list_lock);
+    HG_LIST_REMOVE(hg_handle, entry);
+    hg_thread_spin_unlock(&hg_handle->hg_info.context->processing_list_lock);
+
+    /* Complete and add to completion queue */
+    ret = hg_core_complete(hg_handle);
+    if (ret != HG_SUCCESS) {
+        HG_LOG_ERROR("Could not complete handle");
+        goto done;
+    }
+
+done:
+    return ret;
+}
+
+/*---------------------------------------------------------------------------*/
+static hg_return_t
+hg_core_no_respond_self(struct hg_handle *hg_handle)
+{
+    hg_return_t ret = HG_SUCCESS;
+
+    /* Set operation type for trigger */
+    hg_handle->op_type = HG_CORE_FORWARD_SELF;
+
+    /* Remove handle from processing list */
+    hg_thread_spin_lock(&hg_handle->hg_info.context->processing_list_lock);
+    HG_LIST_REMOVE(hg_handle, entry);
+    hg_thread_spin_unlock(&hg_handle->hg_info.context->processing_list_lock);
+
+    /* Complete and add to completion queue */
+    ret = hg_core_complete(hg_handle);
+    if (ret != HG_SUCCESS) {
+        HG_LOG_ERROR("Could not complete handle");
+        goto done;
+    }
+
+done:
+    return ret;
+}
+#endif
+
+/*---------------------------------------------------------------------------*/
+static hg_return_t
+hg_core_respond_na(struct hg_handle *hg_handle)
+{
+    hg_return_t ret = HG_SUCCESS;
+    na_return_t na_ret;
+
+    /* Set operation type for trigger */
+    hg_handle->op_type = HG_CORE_RESPOND;
 
     /* TODO Post extra buffer expected recv */
 
     /* Respond back */
-    na_ret = NA_Msg_send_expected(hg_handle->na_class, hg_handle->na_context,
-            hg_core_send_output_cb, hg_handle, hg_handle->out_buf,
-            hg_handle->out_buf_used, hg_handle->out_buf_plugin_data,
-            hg_handle->hg_info.addr->na_addr, hg_handle->tag,
-            &hg_handle->na_send_op_id);
+    HG_TRACE(HG_TRACE_SEND_POST, hg_handle, hg_handle->hg_info.id,
+        hg_handle->out_buf_used);
+    if (hg_handle->out_iov.count)
+        na_ret = hg_core_send_iov(hg_handle, NA_FALSE, hg_core_send_output_cb,
+            hg_handle->out_buf, hg_handle->out_buf_used,
+            hg_handle->out_buf_plugin_data, &hg_handle->out_iov);
+    else
+        na_ret = NA_Msg_send_expected(hg_handle->na_class,
+            hg_handle->na_context, hg_core_send_output_cb, hg_handle,
+            hg_handle->out_buf, hg_handle->out_buf_used,
+            hg_handle->out_buf_plugin_data, hg_handle->hg_info.addr->na_addr,
+            hg_handle->tag, &hg_handle->na_send_op_id);
     if (na_ret != NA_SUCCESS) {
         HG_LOG_ERROR("Could not post send for output buffer");
         ret = HG_NA_ERROR;
@@ -2113,6 +3850,7 @@ hg_core_no_respond_na(struct hg_handle *hg_handle)
     hg_thread_spin_lock(&hg_handle->hg_info.context->processing_list_lock);
     HG_LIST_REMOVE(hg_handle, entry);
     hg_thread_spin_unlock(&hg_handle->hg_info.context->processing_list_lock);
+    hg_core_origin_release(hg_handle);
 
     ret = hg_core_complete(hg_handle);
     if (ret != HG_SUCCESS) {
@@ -2136,6 +3874,9 @@ hg_core_send_input_cb(const struct na_cb_info *callback_info)
     if (!hg_handle->na_op_id_mine)
         hg_handle->na_send_op_id = NA_OP_ID_NULL;
 
+    HG_TRACE(HG_TRACE_SEND_COMPLETE, hg_handle, hg_handle->hg_info.id,
+        callback_info->ret);
+
     if (callback_info->ret == NA_CANCELED) {
         /* If canceled, mark handle as canceled */
         hg_handle->ret = HG_CANCELED;
@@ -2208,6 +3949,7 @@ hg_core_recv_input_cb(const struct na_cb_info *callback_info)
     /* Move handle from pending list to processing list */
     hg_thread_spin_lock(&hg_context->pending_list_lock);
     HG_LIST_REMOVE(hg_handle, entry);
+    hg_atomic_decr32(&hg_context->pending_count);
 #ifndef HG_HAS_POST_LIMIT
     pending_empty = HG_LIST_IS_EMPTY(&hg_context->pending_list);
 #endif
@@ -2227,8 +3969,24 @@ hg_core_recv_input_cb(const struct na_cb_info *callback_info)
     }
 #endif
 
+    /* Split coalesced forwards, handle itself can be reposted right away */
+    if (hg_core_header_is_batch(
+        (char *) hg_handle->in_buf + hg_handle->na_in_header_offset)) {
+        unsigned int completed_count = 0;
+
+        if (hg_core_process_batch(hg_handle, &completed_count) != HG_SUCCESS)
+            HG_LOG_ERROR("Could not process batch");
+        if (hg_core_no_respond_na(hg_handle) != HG_SUCCESS) {
+            HG_LOG_ERROR("Could not complete handle");
+            goto done;
+        }
+        ret = (int) completed_count + 1;
+        goto done;
+    }
+
     /* Set operation type for trigger */
     hg_handle->op_type = HG_CORE_PROCESS;
+    hg_core_origin_acquire(hg_handle);
 
     /* Process input information */
     if (hg_core_process_input(hg_handle, &completed) != HG_SUCCESS) {
@@ -2270,6 +4028,13 @@ hg_core_process_input(struct hg_handle *hg_handle, hg_bool_t *completed)
     /* TODO assign target ID from cookie directly for now */
     hg_handle->hg_info.target_id = hg_handle->cookie;
 
+    HG_TRACE(HG_TRACE_RECV_UNEXPECTED, hg_handle, hg_handle->hg_info.id,
+        hg_handle->in_buf_used);
+#ifdef HG_HAS_COLLECT_STATS
+    hg_time_get_current(&hg_handle->stats_recv);
+    HG_CORE_STATS_INCR(hg_handle, HG_STATS_RECV);
+#endif
+
     /* Parse flags */
     hg_handle->no_response = hg_handle->in_header.msg.request.flags
         & HG_CORE_NO_RESPONSE;
@@ -2287,6 +4052,18 @@ hg_core_process_input(struct hg_handle *hg_handle, hg_bool_t *completed)
     hg_handle->no_respond = hg_core_no_respond_na;
 #endif
 
+    /* Answer right away rather than run RPC late if its class is full */
+    if (!hg_core_admit(hg_handle)) {
+        ret = hg_core_shed(hg_handle, HG_BUSY);
+        if (ret != HG_SUCCESS) {
+            HG_LOG_ERROR("Could not shed RPC");
+            goto done;
+        }
+        if (completed)
+            *completed = HG_FALSE;
+        goto done;
+    }
+
     /* Must let upper layer get extra payload if HG_CORE_MORE_DATA is set */
     if (hg_handle->in_header.msg.request.flags & HG_CORE_MORE_DATA) {
         if (!hg_context->hg_class->more_data_acquire) {
@@ -2297,6 +4074,7 @@ hg_core_process_input(struct hg_handle *hg_handle, hg_bool_t *completed)
 #ifdef HG_HAS_COLLECT_STATS
         /* Increment counter */
         hg_core_stat_incr(&hg_core_rpc_extra_count_g);
+        HG_CORE_STATS_INCR(hg_handle, HG_STATS_RECV_EXTRA);
 #endif
         ret = hg_context->hg_class->more_data_acquire((hg_handle_t) hg_handle,
             hg_core_complete);
@@ -2317,74 +4095,277 @@ hg_core_process_input(struct hg_handle *hg_handle, hg_bool_t *completed)
     }
 
 done:
+    /* RPC will never be run */
+    if (ret != HG_SUCCESS)
+        hg_core_admit_release(hg_handle);
     return ret;
 }
 
 /*---------------------------------------------------------------------------*/
-static int
-hg_core_send_output_cb(const struct na_cb_info *callback_info)
+static hg_return_t
+hg_core_process_batch(struct hg_handle *hg_handle,
+    unsigned int *completed_count)
 {
-    struct hg_handle *hg_handle = (struct hg_handle *) callback_info->arg;
-    na_return_t na_ret = NA_SUCCESS;
-    int ret = 0;
+    struct hg_context *context = hg_handle->hg_info.context;
+    char *buf = (char *) hg_handle->in_buf + hg_handle->na_in_header_offset;
+    size_t buf_size = hg_handle->in_buf_used - hg_handle->na_in_header_offset;
+    struct hg_core_header_batch header;
+    struct hg_addr *hg_addr = NULL;
+    hg_bool_t use_sm = HG_FALSE;
+    unsigned int i;
+    hg_return_t ret = HG_SUCCESS;
 
-    /* Reset op ID value */
-    if (!hg_handle->na_op_id_mine)
-        hg_handle->na_send_op_id = NA_OP_ID_NULL;
+    ret = hg_core_header_batch_proc(HG_DECODE, buf, buf_size, &header);
+    if (ret != HG_SUCCESS) {
+        HG_LOG_ERROR("Could not decode batch header");
+        goto done;
+    }
+    buf += hg_core_header_batch_get_size();
+    buf_size -= hg_core_header_batch_get_size();
+#ifdef HG_HAS_SM_ROUTING
+    use_sm = (hg_handle->na_class == context->hg_class->na_sm_class);
+#endif
 
-    if (callback_info->ret == NA_CANCELED) {
-        /* If canceled, mark handle as canceled */
-        hg_handle->ret = HG_CANCELED;
-    } else if (callback_info->ret != NA_SUCCESS) {
-        HG_LOG_ERROR("Error in NA callback");
-        na_ret = NA_PROTOCOL_ERROR;
+    /* Requests share the source addr, taken over from handle */
+    hg_addr = hg_core_addr_create(context->hg_class);
+    if (!hg_addr) {
+        HG_LOG_ERROR("Could not create HG addr");
+        ret = HG_NOMEM_ERROR;
         goto done;
     }
+    hg_addr->is_mine = HG_TRUE;
+    hg_addr->na_class = hg_handle->na_class;
+    hg_addr->na_addr = hg_handle->hg_info.addr->na_addr;
+    hg_handle->hg_info.addr->na_addr = NA_ADDR_NULL;
 
-    /* TODO common code with hg_core_no_respond_na */
+    for (i = 0; i < header.count; i++) {
+        struct hg_core_header_batch_entry entry;
+        struct hg_handle *hg_entry_handle;
+        hg_bool_t completed = HG_FALSE;
+        hg_return_t entry_ret;
 
-    /* Remove handle from processing list
-     * NB. Whichever state we're in, reaching that stage means that the
-     * handle was processed. */
-    hg_thread_spin_lock(&hg_handle->hg_info.context->processing_list_lock);
-    HG_LIST_REMOVE(hg_handle, entry);
-    hg_thread_spin_unlock(&hg_handle->hg_info.context->processing_list_lock);
+        /* Entries that follow cannot be located past that point */
+        ret = hg_core_header_batch_entry_proc(HG_DECODE, buf, buf_size,
+            &entry);
+        if (ret != HG_SUCCESS) {
+            HG_LOG_ERROR("Could not decode batch entry");
+            goto done;
+        }
+        buf += hg_core_header_batch_entry_get_size();
+        buf_size -= hg_core_header_batch_entry_get_size();
+
+        hg_entry_handle = hg_core_batch_pool_get(context, use_sm);
+        if (!hg_entry_handle) {
+            HG_LOG_ERROR("Could not get HG handle for batch entry");
+            if (entry.size > buf_size) {
+                ret = HG_SIZE_ERROR;
+                goto done;
+            }
+            buf += entry.size;
+            buf_size -= entry.size;
+            continue;
+        }
+        hg_entry_handle->hg_info.addr = hg_addr;
+        hg_atomic_incr32(&hg_addr->ref_count);
+        hg_entry_handle->tag = (na_tag_t) entry.tag;
+        hg_entry_handle->respond = hg_core_respond_na;
+        hg_entry_handle->no_respond = hg_core_no_respond_na;
 
-    /* Mark as completed (sanity check for NA op completed count) */
-    if (hg_atomic_incr32(&hg_handle->na_op_completed_count)
-        != (hg_util_int32_t) hg_handle->na_op_count) {
-        HG_LOG_ERROR("Invalid NA operation count (completed %d, expected %u)",
-            hg_atomic_get32(&hg_handle->na_op_completed_count),
-            hg_handle->na_op_count);
-    }
+        /* Same state as a handle that received its request */
+        hg_atomic_set32(&hg_entry_handle->in_use, HG_TRUE);
+        hg_atomic_incr32(&hg_entry_handle->na_op_completed_count);
+        hg_thread_spin_lock(&context->processing_list_lock);
+        HG_LIST_INSERT_HEAD(&context->processing_list, hg_entry_handle, entry);
+        hg_thread_spin_unlock(&context->processing_list_lock);
+        hg_entry_handle->op_type = HG_CORE_PROCESS;
+        hg_core_origin_acquire(hg_entry_handle);
 
-    if (hg_core_complete(hg_handle) != HG_SUCCESS) {
-        HG_LOG_ERROR("Could not complete operation");
-        goto done;
+        if (entry.size > buf_size) {
+            HG_LOG_ERROR("Batch entry exceeds message size");
+            entry_ret = HG_SIZE_ERROR;
+        } else {
+            memcpy((char *) hg_entry_handle->in_buf
+                + hg_entry_handle->na_in_header_offset, buf, entry.size);
+            hg_entry_handle->in_buf_used =
+                hg_entry_handle->na_in_header_offset + entry.size;
+            buf += entry.size;
+            buf_size -= entry.size;
+
+            entry_ret = hg_core_process_input(hg_entry_handle, &completed);
+            if (entry_ret != HG_SUCCESS)
+                HG_LOG_ERROR("Could not process input of batch entry");
+        }
+
+        /* Request header was not decoded, answer its origin with the error
+         * rather than let it wait for a response */
+        if (entry_ret != HG_SUCCESS && !hg_entry_handle->no_response
+            && hg_entry_handle->na_op_count == 1) {
+            hg_entry_handle->na_op_count++;
+            if (hg_core_shed(hg_entry_handle, entry_ret) != HG_SUCCESS)
+                HG_LOG_ERROR("Could not answer batch entry");
+        }
+        if (entry_ret == HG_SIZE_ERROR) {
+            ret = entry_ret;
+            goto done;
+        }
+        if (completed)
+            (*completed_count)++;
     }
-    /* Increment number of entries added to completion queue */
-    ret++;
 
 done:
-    (void) na_ret;
+    hg_core_addr_free(context->hg_class, hg_addr);
     return ret;
 }
 
 /*---------------------------------------------------------------------------*/
-static int
-hg_core_recv_output_cb(const struct na_cb_info *callback_info)
+static hg_bool_t
+hg_core_admit(struct hg_handle *hg_handle)
 {
-    struct hg_handle *hg_handle = (struct hg_handle *) callback_info->arg;
-    na_return_t na_ret = NA_SUCCESS;
+    struct hg_context *context = hg_handle->hg_info.context;
+    struct hg_class *hg_class = hg_handle->hg_info.hg_class;
+    struct hg_rpc_info *hg_rpc_info;
+    unsigned int limit;
+
+    /* Retrieve RPC info once, it is cached for processing */
+    hg_thread_spin_lock(&hg_class->func_map_lock);
+    hg_rpc_info = (struct hg_rpc_info *) hg_hash_table_lookup(
+        hg_class->func_map, (hg_hash_table_key_t) &hg_handle->hg_info.id);
+    hg_thread_spin_unlock(&hg_class->func_map_lock);
+    hg_handle->hg_rpc_info = hg_rpc_info;
+    hg_handle->rpc_class = (hg_rpc_info
+        && hg_rpc_info->priority == HG_HANDLER_HIGH) ? HG_CORE_RPC_CLASS_HIGH
+            : HG_CORE_RPC_CLASS_NORMAL;
+
+    limit = context->rpc_queue_limit[hg_handle->rpc_class];
+    if (limit && (unsigned int) hg_atomic_incr32(
+        &context->rpc_queued[hg_handle->rpc_class]) > limit) {
+        hg_atomic_decr32(&context->rpc_queued[hg_handle->rpc_class]);
+        return HG_FALSE;
+    }
+    hg_handle->rpc_queued = (limit != 0);
+
+    return HG_TRUE;
+}
+
+/*---------------------------------------------------------------------------*/
+static HG_INLINE void
+hg_core_admit_release(struct hg_handle *hg_handle)
+{
+    if (hg_handle->rpc_queued) {
+        hg_atomic_decr32(
+            &hg_handle->hg_info.context->rpc_queued[hg_handle->rpc_class]);
+        hg_handle->rpc_queued = HG_FALSE;
+    }
+}
+
+/*---------------------------------------------------------------------------*/
+static hg_return_t
+hg_core_shed(struct hg_handle *hg_handle, hg_return_t error)
+{
+    hg_return_t ret = HG_SUCCESS;
+
+    HG_LOG_DEBUG("Shedding RPC %d (error %d)", (int) hg_handle->hg_info.id,
+        (int) error);
+#ifdef HG_HAS_COLLECT_STATS
+    hg_time_get_current(&hg_handle->stats_process);
+#endif
+
+    if (hg_handle->no_response) {
+        /* Nobody to tell, drop it */
+        ret = hg_handle->no_respond(hg_handle);
+        if (ret != HG_SUCCESS) {
+            HG_LOG_ERROR("Could not complete handle");
+            goto done;
+        }
+    } else {
+        hg_size_t header_size = hg_core_header_response_get_size() +
+            hg_handle->na_out_header_offset;
+
+        hg_handle->ret = error;
+        ret = HG_Core_respond(hg_handle, NULL, NULL, 0, header_size);
+        if (ret != HG_SUCCESS) {
+            HG_LOG_ERROR("Could not respond");
+            goto done;
+        }
+    }
+
+done:
+    return ret;
+}
+
+/*---------------------------------------------------------------------------*/
+static int
+hg_core_send_output_cb(const struct na_cb_info *callback_info)
+{
+    struct hg_handle *hg_handle = (struct hg_handle *) callback_info->arg;
+    na_return_t na_ret = NA_SUCCESS;
     int ret = 0;
 
     /* Reset op ID value */
     if (!hg_handle->na_op_id_mine)
-        hg_handle->na_recv_op_id = NA_OP_ID_NULL;
+        hg_handle->na_send_op_id = NA_OP_ID_NULL;
+
+    HG_TRACE(HG_TRACE_SEND_COMPLETE, hg_handle, hg_handle->hg_info.id,
+        callback_info->ret);
 
     if (callback_info->ret == NA_CANCELED) {
         /* If canceled, mark handle as canceled */
         hg_handle->ret = HG_CANCELED;
+    } else if (callback_info->ret != NA_SUCCESS) {
+        HG_LOG_ERROR("Error in NA callback");
+        na_ret = NA_PROTOCOL_ERROR;
+        goto done;
+    }
+
+    /* TODO common code with hg_core_no_respond_na */
+
+    /* Remove handle from processing list
+     * NB. Whichever state we're in, reaching that stage means that the
+     * handle was processed. */
+    hg_thread_spin_lock(&hg_handle->hg_info.context->processing_list_lock);
+    HG_LIST_REMOVE(hg_handle, entry);
+    hg_thread_spin_unlock(&hg_handle->hg_info.context->processing_list_lock);
+    hg_core_origin_release(hg_handle);
+
+    /* Mark as completed (sanity check for NA op completed count) */
+    if (hg_atomic_incr32(&hg_handle->na_op_completed_count)
+        != (hg_util_int32_t) hg_handle->na_op_count) {
+        HG_LOG_ERROR("Invalid NA operation count (completed %d, expected %u)",
+            hg_atomic_get32(&hg_handle->na_op_completed_count),
+            hg_handle->na_op_count);
+    }
+
+    if (hg_core_complete(hg_handle) != HG_SUCCESS) {
+        HG_LOG_ERROR("Could not complete operation");
+        goto done;
+    }
+    /* Increment number of entries added to completion queue */
+    ret++;
+
+done:
+    (void) na_ret;
+    return ret;
+}
+
+/*---------------------------------------------------------------------------*/
+static int
+hg_core_recv_output_cb(const struct na_cb_info *callback_info)
+{
+    struct hg_handle *hg_handle = (struct hg_handle *) callback_info->arg;
+    na_return_t na_ret = NA_SUCCESS;
+    int ret = 0;
+
+    /* Reset op ID value */
+    if (!hg_handle->na_op_id_mine)
+        hg_handle->na_recv_op_id = NA_OP_ID_NULL;
+
+    HG_TRACE(HG_TRACE_RECV_EXPECTED, hg_handle, hg_handle->hg_info.id,
+        callback_info->ret);
+
+    if (callback_info->ret == NA_CANCELED) {
+        /* If canceled, mark handle as canceled (unless send failed) */
+        if (hg_handle->ret == HG_SUCCESS)
+            hg_handle->ret = HG_CANCELED;
     } else if (callback_info->ret == NA_SUCCESS) {
         if (hg_core_process_output(hg_handle, NULL) != HG_SUCCESS) {
             HG_LOG_ERROR("Could not process output");
@@ -2432,6 +4413,10 @@ hg_core_process_output(struct hg_handle *hg_handle, hg_bool_t *completed)
     /* Get return code from header */
     hg_handle->ret = (hg_return_t) hg_handle->out_header.msg.response.ret_code;
 
+    /* Target tells how many forwards it can take from us */
+    hg_core_credits_update(hg_handle->hg_info.addr,
+        hg_handle->out_header.msg.response.credits);
+
     /* Parse flags */
 
     /* TODO Must let upper layer get extra payload if HG_CORE_MORE_DATA is set */
@@ -2532,11 +4517,26 @@ hg_core_process(struct hg_handle *hg_handle)
     struct hg_rpc_info *hg_rpc_info;
     hg_return_t ret = HG_SUCCESS;
 
-    /* Retrieve exe function from function map */
-    hg_thread_spin_lock(&hg_class->func_map_lock);
-    hg_rpc_info = (struct hg_rpc_info *) hg_hash_table_lookup(
-        hg_class->func_map, (hg_hash_table_key_t) &hg_handle->hg_info.id);
-    hg_thread_spin_unlock(&hg_class->func_map_lock);
+    /* RPC is no longer waiting */
+    hg_core_admit_release(hg_handle);
+
+#ifdef HG_HAS_COLLECT_STATS
+    /* Time spent in completion queue (also start handler time for error
+     * responses) */
+    hg_time_get_current(&hg_handle->stats_process);
+    HG_CORE_STATS_RECORD(hg_handle, HG_STATS_QUEUE_TIME,
+        hg_handle->stats_recv, hg_handle->stats_process);
+#endif
+
+    /* Retrieve exe function from function map (unless already cached when
+     * posting to handler threads) */
+    hg_rpc_info = hg_handle->hg_rpc_info;
+    if (!hg_rpc_info) {
+        hg_thread_spin_lock(&hg_class->func_map_lock);
+        hg_rpc_info = (struct hg_rpc_info *) hg_hash_table_lookup(
+            hg_class->func_map, (hg_hash_table_key_t) &hg_handle->hg_info.id);
+        hg_thread_spin_unlock(&hg_class->func_map_lock);
+    }
     if (!hg_rpc_info) {
         HG_LOG_WARNING("Could not find RPC ID in function map");
         ret = HG_NO_MATCH;
@@ -2552,17 +4552,138 @@ hg_core_process(struct hg_handle *hg_handle)
     /* Cache RPC info */
     hg_handle->hg_rpc_info = hg_rpc_info;
 
+    /* Forward to subtree first so that it runs RPC concurrently */
+    if (hg_handle->in_header.msg.request.flags & HG_CORE_TREE_FORWARD) {
+        ret = hg_core_tree_forward(hg_handle);
+        if (ret != HG_SUCCESS) {
+            HG_LOG_ERROR("Could not forward to subtree");
+            /* Subtree was never reached and request cannot be trusted,
+             * error goes back in the response instead of running RPC */
+            if (!hg_handle->multi)
+                goto done;
+            /* Otherwise error is returned with response once subtree is
+             * done */
+            ret = HG_SUCCESS;
+        }
+    }
+
     /* Increment ref count here so that a call to HG_Destroy in user's RPC
      * callback does not free the handle but only schedules its completion */
     hg_atomic_incr32(&hg_handle->ref_count);
 
     /* Execute RPC callback */
+    HG_TRACE(HG_TRACE_RPC_BEGIN, hg_handle, hg_handle->hg_info.id, 0);
     ret = hg_rpc_info->rpc_cb((hg_handle_t) hg_handle);
+    HG_TRACE(HG_TRACE_RPC_END, hg_handle, hg_handle->hg_info.id, ret);
     if (ret != HG_SUCCESS) {
         HG_LOG_ERROR("Error while executing RPC callback");
         goto done;
     }
 
+#ifdef HG_HAS_COLLECT_STATS
+    /* Without response, handler time ends when callback returns */
+    if (hg_handle->no_response) {
+        hg_time_t now;
+
+        hg_time_get_current(&now);
+        HG_CORE_STATS_RECORD(hg_handle, HG_STATS_HANDLER_TIME,
+            hg_handle->stats_process, now);
+    }
+#endif
+
+done:
+    return ret;
+}
+
+/*---------------------------------------------------------------------------*/
+static hg_return_t
+hg_core_process_entry(struct hg_handle *hg_handle)
+{
+    hg_return_t ret;
+
+    /* Run RPC callback */
+    ret = hg_core_process(hg_handle);
+    if (ret != HG_SUCCESS && !hg_handle->no_response) {
+        hg_size_t header_size = hg_core_header_response_get_size() +
+            hg_handle->na_out_header_offset;
+
+        /* Respond in case of error */
+        hg_handle->ret = ret;
+        ret = HG_Core_respond(hg_handle, NULL, NULL, 0, header_size);
+        if (ret != HG_SUCCESS) {
+            HG_LOG_ERROR("Could not respond");
+            goto done;
+        }
+    }
+
+    /* No response callback */
+    if (hg_handle->no_response) {
+        ret = hg_handle->no_respond(hg_handle);
+        if (ret != HG_SUCCESS) {
+            HG_LOG_ERROR("Could not complete handle");
+            goto done;
+        }
+    }
+
+done:
+    return ret;
+}
+
+/*---------------------------------------------------------------------------*/
+static HG_THREAD_RETURN_TYPE
+hg_core_process_executor(void *arg)
+{
+    hg_thread_ret_t thread_ret = (hg_thread_ret_t) 0;
+    struct hg_handle *hg_handle = (struct hg_handle *) arg;
+
+    if (hg_core_process_entry(hg_handle) != HG_SUCCESS) {
+        HG_LOG_ERROR("Could not process handle");
+    }
+
+    return thread_ret;
+}
+
+/*---------------------------------------------------------------------------*/
+static hg_return_t
+hg_core_process_post(struct hg_handle *hg_handle)
+{
+    struct hg_class *hg_class = hg_handle->hg_info.hg_class;
+    struct hg_context *context = hg_handle->hg_info.context;
+    struct hg_rpc_info *hg_rpc_info;
+    hg_return_t ret = HG_SUCCESS;
+
+    /* Retrieve handler hints from function map, unknown RPCs get their error
+     * response inline */
+    hg_thread_spin_lock(&hg_class->func_map_lock);
+    hg_rpc_info = (struct hg_rpc_info *) hg_hash_table_lookup(
+        hg_class->func_map, (hg_hash_table_key_t) &hg_handle->hg_info.id);
+    hg_thread_spin_unlock(&hg_class->func_map_lock);
+    if (!hg_rpc_info || hg_rpc_info->priority == HG_HANDLER_INLINE) {
+        ret = HG_NO_MATCH;
+        goto done;
+    }
+    hg_handle->hg_rpc_info = hg_rpc_info;
+
+    hg_handle->executor_work.func = hg_core_process_executor;
+    hg_handle->executor_work.args = hg_handle;
+
+    /* Handler threads may be replaced concurrently */
+    hg_thread_rwlock_rdlock(&context->executor_lock);
+    if (!context->executor) {
+        ret = HG_NO_MATCH;
+        goto unlock;
+    }
+    if (hg_executor_post(context->executor, &hg_handle->executor_work,
+        hg_rpc_info->affinity, (hg_rpc_info->priority == HG_HANDLER_HIGH) ?
+            HG_EXECUTOR_HIGH : HG_EXECUTOR_NORMAL) != HG_UTIL_SUCCESS) {
+        HG_LOG_ERROR("Could not post handle to handler threads");
+        ret = HG_PROTOCOL_ERROR;
+        goto unlock;
+    }
+
+unlock:
+    hg_thread_rwlock_release_rdlock(&context->executor_lock);
+
 done:
     return ret;
 }
@@ -2579,6 +4700,12 @@ hg_core_complete(struct hg_handle *hg_handle)
     hg_completion_entry->op_type = HG_RPC;
     hg_completion_entry->op_id.hg_handle = hg_handle;
 
+    /* Forward completed before its deadline, give credit back */
+    if (hg_handle->op_type == HG_CORE_FORWARD) {
+        hg_core_timer_disarm(hg_handle);
+        hg_core_credit_release(hg_handle);
+    }
+
     ret = hg_core_completion_add(context, hg_completion_entry,
         hg_handle->is_self);
     if (ret != HG_SUCCESS) {
@@ -2590,6 +4717,15 @@ done:
     return ret;
 }
 
+/*---------------------------------------------------------------------------*/
+static HG_INLINE hg_bool_t
+hg_core_completion_queue_is_empty(struct hg_context *context)
+{
+    return hg_atomic_queue_is_empty(context->completion_queue)
+        && !hg_atomic_get32(&context->backfill_queue_count)
+        && !hg_atomic_get32(&context->priority_queue_count);
+}
+
 /*---------------------------------------------------------------------------*/
 hg_return_t
 hg_core_completion_add(struct hg_context *context,
@@ -2599,12 +4735,24 @@ hg_core_completion_add(struct hg_context *context,
 
 #ifdef HG_HAS_COLLECT_STATS
     /* Increment counter */
-    if (hg_completion_entry->op_type == HG_BULK)
+    if (hg_completion_entry->op_type == HG_BULK) {
         hg_core_stat_incr(&hg_core_bulk_count_g);
+        hg_stats_incr(context->hg_class, context, HG_STATS_ANY, HG_STATS_BULK);
+    }
 #endif
 
-    if (hg_atomic_queue_push(context->completion_queue, hg_completion_entry)
-        != HG_UTIL_SUCCESS) {
+    if (hg_completion_entry->op_type == HG_RPC
+        && hg_completion_entry->op_id.hg_handle->op_type == HG_CORE_PROCESS
+        && hg_completion_entry->op_id.hg_handle->rpc_class
+            == HG_CORE_RPC_CLASS_HIGH) {
+        /* Triggered before anything else */
+        hg_thread_mutex_lock(&context->completion_queue_mutex);
+        HG_QUEUE_PUSH_TAIL(&context->priority_queue, hg_completion_entry,
+            entry);
+        hg_atomic_incr32(&context->priority_queue_count);
+        hg_thread_mutex_unlock(&context->completion_queue_mutex);
+    } else if (hg_atomic_queue_push(context->completion_queue,
+        hg_completion_entry) != HG_UTIL_SUCCESS) {
         /* Queue is full */
         hg_thread_mutex_lock(&context->completion_queue_mutex);
         HG_QUEUE_PUSH_TAIL(&context->backfill_queue, hg_completion_entry,
@@ -2621,16 +4769,13 @@ hg_core_completion_add(struct hg_context *context,
         hg_thread_mutex_unlock(&context->completion_queue_mutex);
     }
 
-#ifdef HG_HAS_SELF_FORWARD
-    /* TODO could prevent from self notifying if hg_poll_wait() not entered */
+    /* Completions that do not come from progress must wake it up
+     * TODO could prevent from self notifying if hg_poll_wait() not entered */
     if (self_notify && context->completion_queue_notify
         && hg_event_set(context->completion_queue_notify) != HG_UTIL_SUCCESS) {
         HG_LOG_ERROR("Could not signal completion queue");
         ret = HG_PROTOCOL_ERROR;
     }
-#else
-    (void) self_notify;
-#endif
 
     return ret;
 }
@@ -2705,6 +4850,7 @@ hg_core_post(struct hg_handle *hg_handle)
     hg_thread_spin_lock(&context->pending_list_lock);
     HG_LIST_INSERT_HEAD(&context->pending_list, hg_handle, entry);
     hg_thread_spin_unlock(&context->pending_list_lock);
+    hg_atomic_incr32(&context->pending_count);
 
     /* Post a new unexpected receive */
     na_ret = NA_Msg_recv_unexpected(hg_handle->na_class, hg_handle->na_context,
@@ -2751,7 +4897,6 @@ done:
 }
 
 /*---------------------------------------------------------------------------*/
-#ifdef HG_HAS_SELF_FORWARD
 static int
 hg_core_completion_queue_notify_cb(void *arg, unsigned int timeout,
     hg_util_bool_t *progressed)
@@ -2766,8 +4911,7 @@ hg_core_completion_queue_notify_cb(void *arg, unsigned int timeout,
         ret = HG_PROTOCOL_ERROR;
         goto done;
     }
-    if (notified || !hg_atomic_queue_is_empty(context->completion_queue)
-        || hg_atomic_get32(&context->backfill_queue_count)) {
+    if (notified || !hg_core_completion_queue_is_empty(context)) {
         *progressed = HG_UTIL_TRUE; /* Progressed */
         goto done;
     }
@@ -2777,7 +4921,6 @@ hg_core_completion_queue_notify_cb(void *arg, unsigned int timeout,
 done:
     return ret;
 }
-#endif
 
 /*---------------------------------------------------------------------------*/
 static int
@@ -2817,8 +4960,7 @@ hg_core_progress_na_cb(void *arg, unsigned int timeout,
     /* We can't only verify that the completion queue is not empty, we need
      * to check what was added to the completion queue, as the completion queue
      * may have been concurrently emptied */
-    if (!completed_count && hg_atomic_queue_is_empty(context->completion_queue)
-        && !hg_atomic_get32(&context->backfill_queue_count)) {
+    if (!completed_count && hg_core_completion_queue_is_empty(context)) {
         /* Nothing progressed */
         *progressed = HG_UTIL_FALSE;
         goto done;
@@ -2869,8 +5011,7 @@ hg_core_progress_na_sm_cb(void *arg, unsigned int timeout,
     /* We can't only verify that the completion queue is not empty, we need
      * to check what was added to the completion queue, as the completion queue
      * may have been concurrently emptied */
-    if (!completed_count && hg_atomic_queue_is_empty(context->completion_queue)
-        && !hg_atomic_get32(&context->backfill_queue_count)) {
+    if (!completed_count && hg_core_completion_queue_is_empty(context)) {
         /* Nothing progressed */
         *progressed = HG_UTIL_FALSE;
         goto done;
@@ -2920,9 +5061,7 @@ hg_core_progress_na(struct hg_context *context, unsigned int timeout)
         /* We can't only verify that the completion queue is not empty, we need
          * to check what was added to the completion queue, as the completion
          * queue may have been concurrently emptied */
-        if (completed_count
-            || !hg_atomic_queue_is_empty(context->completion_queue)
-            || hg_atomic_get32(&context->backfill_queue_count)) {
+        if (completed_count || !hg_core_completion_queue_is_empty(context)) {
             ret = HG_SUCCESS; /* Progressed */
             break;
         }
@@ -2976,8 +5115,7 @@ hg_core_poll_try_wait_cb(void *arg)
         return NA_FALSE;
 
     /* Something is in one of the completion queues */
-    if (!hg_atomic_queue_is_empty(hg_context->completion_queue) ||
-        hg_atomic_get32(&hg_context->backfill_queue_count)) {
+    if (!hg_core_completion_queue_is_empty(hg_context)) {
         return NA_FALSE;
     }
 
@@ -3059,9 +5197,23 @@ hg_core_trigger(struct hg_context *context, unsigned int timeout,
 
     while (count < max_count) {
         struct hg_completion_entry *hg_completion_entry = NULL;
+#ifdef HG_HAS_COLLECT_STATS
+        hg_time_t cb_t1, cb_t2;
+#endif
 
-        hg_completion_entry =
-            hg_atomic_queue_pop_mc(context->completion_queue);
+        /* High priority RPCs first */
+        if (hg_atomic_get32(&context->priority_queue_count)) {
+            hg_thread_mutex_lock(&context->completion_queue_mutex);
+            hg_completion_entry = HG_QUEUE_FIRST(&context->priority_queue);
+            if (hg_completion_entry) {
+                HG_QUEUE_POP_HEAD(&context->priority_queue, entry);
+                hg_atomic_decr32(&context->priority_queue_count);
+            }
+            hg_thread_mutex_unlock(&context->completion_queue_mutex);
+        }
+        if (!hg_completion_entry)
+            hg_completion_entry =
+                hg_atomic_queue_pop_mc(context->completion_queue);
         if (!hg_completion_entry) {
             /* Check backfill queue */
             if (hg_atomic_get32(&context->backfill_queue_count)) {
@@ -3090,8 +5242,7 @@ hg_core_trigger(struct hg_context *context, unsigned int timeout,
                 hg_atomic_incr32(&context->trigger_waiting);
                 hg_thread_mutex_lock(&context->completion_queue_mutex);
                 /* Otherwise wait timeout ms */
-                while (hg_atomic_queue_is_empty(context->completion_queue) &&
-                    !hg_atomic_get32(&context->backfill_queue_count)) {
+                while (hg_core_completion_queue_is_empty(context)) {
                     if (hg_thread_cond_timedwait(&context->completion_queue_cond,
                         &context->completion_queue_mutex, timeout)
                         != HG_UTIL_SUCCESS) {
@@ -3118,6 +5269,10 @@ hg_core_trigger(struct hg_context *context, unsigned int timeout,
             goto done;
         }
 
+#ifdef HG_HAS_COLLECT_STATS
+        hg_time_get_current(&cb_t1);
+#endif
+
         /* Trigger entry */
         switch(hg_completion_entry->op_type) {
             case HG_ADDR:
@@ -3147,6 +5302,13 @@ hg_core_trigger(struct hg_context *context, unsigned int timeout,
                 goto done;
         }
 
+#ifdef HG_HAS_COLLECT_STATS
+        hg_time_get_current(&cb_t2);
+        hg_atomic_incr64(&context->acct.trigger_count);
+        hg_atomic_add64(&context->acct.trigger_time,
+            (hg_util_int64_t) HG_STATS_USEC(cb_t1, cb_t2));
+#endif
+
         count++;
     }
 
@@ -3167,7 +5329,7 @@ hg_core_trigger_lookup_entry(struct hg_op_id *hg_op_id)
         struct hg_cb_info hg_cb_info;
 
         hg_cb_info.arg = hg_op_id->arg;
-        hg_cb_info.ret =  HG_SUCCESS; /* TODO report failure */
+        hg_cb_info.ret = hg_op_id->info.lookup.ret;
         hg_cb_info.type = HG_CB_LOOKUP;
         hg_cb_info.info.lookup.addr = hg_op_id->info.lookup.hg_addr;
 
@@ -3185,30 +5347,17 @@ hg_core_trigger_entry(struct hg_handle *hg_handle)
 {
     hg_return_t ret = HG_SUCCESS;
 
+    HG_TRACE(HG_TRACE_TRIGGER, hg_handle, hg_handle->hg_info.id,
+        hg_handle->op_type);
+
     if (hg_handle->op_type == HG_CORE_PROCESS) {
-        /* Run RPC callback */
-        ret = hg_core_process(hg_handle);
-        if (ret != HG_SUCCESS && !hg_handle->no_response) {
-            hg_size_t header_size = hg_core_header_response_get_size() +
-                hg_handle->na_out_header_offset;
-
-            /* Respond in case of error */
-            hg_handle->ret = ret;
-            ret = HG_Core_respond(hg_handle, NULL, NULL, 0, header_size);
-            if (ret != HG_SUCCESS) {
-                HG_LOG_ERROR("Could not respond");
-                goto done;
-            }
-        }
+        /* Hand RPC callback over to handler threads if any */
+        if (hg_handle->hg_info.context->executor
+            && hg_core_process_post(hg_handle) == HG_SUCCESS)
+            goto done;
 
-        /* No response callback */
-        if (hg_handle->no_response) {
-            ret = hg_handle->no_respond(hg_handle);
-            if (ret != HG_SUCCESS) {
-                HG_LOG_ERROR("Could not complete handle");
-                goto done;
-            }
-        }
+        /* Run RPC callback */
+        ret = hg_core_process_entry(hg_handle);
     } else {
         hg_cb_t hg_cb = NULL;
         struct hg_cb_info hg_cb_info;
@@ -3226,6 +5375,24 @@ hg_core_trigger_entry(struct hg_handle *hg_handle)
                 hg_cb_info.arg = hg_handle->request_arg;
                 hg_cb_info.type = HG_CB_FORWARD;
                 hg_cb_info.info.forward.handle = (hg_handle_t) hg_handle;
+                /* Canceled because deadline was reached */
+                if (hg_handle->timed_out && hg_handle->ret == HG_CANCELED) {
+                    hg_handle->ret = HG_TIMEOUT;
+                    hg_cb_info.ret = HG_TIMEOUT;
+                }
+#ifdef HG_HAS_COLLECT_STATS
+                {
+                    hg_time_t now;
+
+                    hg_time_get_current(&now);
+                    HG_CORE_STATS_RECORD(hg_handle, HG_STATS_FORWARD_TIME,
+                        hg_handle->stats_forward, now);
+                    if (hg_handle->ret != HG_SUCCESS)
+                        HG_CORE_STATS_INCR(hg_handle, HG_STATS_FORWARD_ERROR);
+                }
+#endif
+                HG_TRACE(HG_TRACE_FORWARD_COMPLETE, hg_handle,
+                    hg_handle->hg_info.id, hg_handle->ret);
                 break;
             case HG_CORE_RESPOND:
                 hg_cb = hg_handle->response_callback;
@@ -3277,6 +5444,17 @@ hg_core_cancel(struct hg_handle *hg_handle)
 {
     hg_return_t ret = HG_SUCCESS;
 
+    /* Children of a multi forward are not canceled */
+    if (hg_handle->multi && hg_handle->multi->is_origin) {
+        HG_LOG_ERROR("Cannot cancel multi forward");
+        ret = HG_INVALID_PARAM;
+        goto done;
+    }
+
+    /* Forward was not sent yet */
+    if (hg_core_credit_cancel(hg_handle) || hg_core_batch_cancel(hg_handle))
+        goto done;
+
     /* Cancel all NA operations issued */
     if (hg_handle->na_recv_op_id != NA_OP_ID_NULL) {
         na_return_t na_ret;
@@ -3290,22 +5468,763 @@ hg_core_cancel(struct hg_handle *hg_handle)
         }
     }
 
-    if (hg_handle->na_send_op_id != NA_OP_ID_NULL) {
-        na_return_t na_ret;
-
-        na_ret = NA_Cancel(hg_handle->na_class, hg_handle->na_context,
-            hg_handle->na_send_op_id);
-        if (na_ret != NA_SUCCESS) {
-            HG_LOG_ERROR("Could not cancel send op id");
-            ret = HG_NA_ERROR;
-            goto done;
+    if (hg_handle->na_send_op_id != NA_OP_ID_NULL) {
+        na_return_t na_ret;
+
+        na_ret = NA_Cancel(hg_handle->na_class, hg_handle->na_context,
+            hg_handle->na_send_op_id);
+        if (na_ret != NA_SUCCESS) {
+            HG_LOG_ERROR("Could not cancel send op id");
+            ret = HG_NA_ERROR;
+            goto done;
+        }
+    }
+
+done:
+    return ret;
+}
+
+/*---------------------------------------------------------------------------*/
+static HG_INLINE int
+hg_core_origin_equal(void *vlocation1, void *vlocation2)
+{
+    return ((struct hg_core_origin *) vlocation1)->na_addr
+        == ((struct hg_core_origin *) vlocation2)->na_addr;
+}
+
+/*---------------------------------------------------------------------------*/
+static HG_INLINE unsigned int
+hg_core_origin_hash(void *vlocation)
+{
+    /* Low bits of addresses are alignment */
+    return (unsigned int) ((size_t) ((struct hg_core_origin *) vlocation)->na_addr
+        >> 4);
+}
+
+/*---------------------------------------------------------------------------*/
+static void
+hg_core_origin_acquire(struct hg_handle *hg_handle)
+{
+    struct hg_context *context = hg_handle->hg_info.context;
+    struct hg_core_origin *origin, origin_key;
+
+    origin_key.na_addr = hg_handle->hg_info.addr->na_addr;
+
+    /* Plugins that return the same source addr for a peer get one entry per
+     * peer, others count each request as an origin (smaller grants) */
+    hg_thread_mutex_lock(&context->origin_mutex);
+    origin = (struct hg_core_origin *) hg_hash_table_lookup(
+        context->origin_table, (hg_hash_table_key_t) &origin_key);
+    if (origin == HG_HASH_TABLE_NULL) {
+        origin = (struct hg_core_origin *) malloc(
+            sizeof(struct hg_core_origin));
+        if (!origin) {
+            /* Request is still served, only its grant is off */
+            hg_thread_mutex_unlock(&context->origin_mutex);
+            return;
+        }
+        origin->na_addr = origin_key.na_addr;
+        origin->count = 0;
+        if (!hg_hash_table_insert(context->origin_table,
+            (hg_hash_table_key_t) origin, (hg_hash_table_value_t) origin)) {
+            free(origin);
+            hg_thread_mutex_unlock(&context->origin_mutex);
+            return;
+        }
+    }
+    origin->count++;
+    hg_handle->origin = origin;
+    hg_thread_mutex_unlock(&context->origin_mutex);
+}
+
+/*---------------------------------------------------------------------------*/
+static void
+hg_core_origin_release(struct hg_handle *hg_handle)
+{
+    struct hg_context *context = hg_handle->hg_info.context;
+    struct hg_core_origin *origin = hg_handle->origin;
+
+    if (!origin)
+        return;
+
+    hg_thread_mutex_lock(&context->origin_mutex);
+    hg_handle->origin = NULL;
+    if (--origin->count == 0) {
+        hg_hash_table_remove(context->origin_table,
+            (hg_hash_table_key_t) origin);
+        free(origin);
+    }
+    hg_thread_mutex_unlock(&context->origin_mutex);
+}
+
+/*---------------------------------------------------------------------------*/
+static HG_INLINE hg_uint8_t
+hg_core_credits_grant(struct hg_handle *hg_handle)
+{
+    struct hg_context *context = hg_handle->hg_info.context;
+    hg_util_int32_t pending_count = hg_atomic_get32(&context->pending_count);
+    unsigned int origin_count, credits = 0;
+
+    /* Split handles still posted among origins being served, each origin
+     * keeps what it already has in progress */
+    hg_thread_mutex_lock(&context->origin_mutex);
+    origin_count = hg_hash_table_num_entries(context->origin_table);
+    if (hg_handle->origin)
+        credits = hg_handle->origin->count;
+    hg_thread_mutex_unlock(&context->origin_mutex);
+    if (origin_count < 1)
+        origin_count = 1;
+    if (pending_count > 0)
+        credits += (unsigned int) pending_count / origin_count;
+
+    /* Always let origin make progress */
+    if (credits < 1)
+        return 1;
+    if (credits > HG_CORE_CREDITS_MAX)
+        return HG_CORE_CREDITS_MAX;
+
+    return (hg_uint8_t) credits;
+}
+
+/*---------------------------------------------------------------------------*/
+static void
+hg_core_credits_update(struct hg_addr *hg_addr, hg_uint8_t credits)
+{
+    /* Older targets or self responses do not grant anything */
+    if (!hg_addr || !credits)
+        return;
+
+    hg_thread_spin_lock(&hg_addr->credit_lock);
+    hg_addr->credits = credits;
+    hg_thread_spin_unlock(&hg_addr->credit_lock);
+
+    hg_core_credit_dispatch(hg_addr);
+}
+
+/*---------------------------------------------------------------------------*/
+static hg_bool_t
+hg_core_credit_acquire(struct hg_handle *hg_handle)
+{
+    struct hg_addr *hg_addr = hg_handle->hg_info.addr;
+    hg_bool_t ret = HG_TRUE;
+
+    hg_thread_spin_lock(&hg_addr->credit_lock);
+    if (hg_addr->in_flight < hg_addr->credits
+        && HG_QUEUE_IS_EMPTY(&hg_addr->credit_queue)) {
+        hg_addr->in_flight++;
+        hg_handle->credit_held = HG_TRUE;
+    } else {
+        HG_QUEUE_PUSH_TAIL(&hg_addr->credit_queue, hg_handle, credit_entry);
+        hg_handle->credit_queued = HG_TRUE;
+        ret = HG_FALSE;
+    }
+    hg_thread_spin_unlock(&hg_addr->credit_lock);
+
+    return ret;
+}
+
+/*---------------------------------------------------------------------------*/
+static void
+hg_core_credit_release(struct hg_handle *hg_handle)
+{
+    struct hg_addr *hg_addr = hg_handle->hg_info.addr;
+
+    if (!hg_handle->credit_held)
+        return;
+
+    hg_thread_spin_lock(&hg_addr->credit_lock);
+    hg_handle->credit_held = HG_FALSE;
+    hg_addr->in_flight--;
+    hg_thread_spin_unlock(&hg_addr->credit_lock);
+
+    hg_core_credit_dispatch(hg_addr);
+}
+
+/*---------------------------------------------------------------------------*/
+static hg_bool_t
+hg_core_credit_cancel(struct hg_handle *hg_handle)
+{
+    struct hg_addr *hg_addr = hg_handle->hg_info.addr;
+    hg_bool_t dequeued = HG_FALSE, ret = HG_FALSE;
+
+    if (!hg_handle->credit_queued && !hg_handle->credit_dispatching)
+        return ret;
+
+    hg_thread_spin_lock(&hg_addr->credit_lock);
+    if (hg_handle->credit_queued) {
+        HG_QUEUE_REMOVE(&hg_addr->credit_queue, hg_handle, hg_handle,
+            credit_entry);
+        hg_handle->credit_queued = HG_FALSE;
+        dequeued = HG_TRUE;
+        ret = HG_TRUE;
+    } else if (hg_handle->credit_dispatching) {
+        /* Dispatch completes it instead of sending it */
+        hg_handle->credit_canceled = HG_TRUE;
+        ret = HG_TRUE;
+    }
+    hg_thread_spin_unlock(&hg_addr->credit_lock);
+
+    if (dequeued) {
+        hg_handle->ret = HG_CANCELED;
+        if (hg_core_complete(hg_handle) != HG_SUCCESS)
+            HG_LOG_ERROR("Could not complete handle");
+    }
+
+    return ret;
+}
+
+/*---------------------------------------------------------------------------*/
+static void
+hg_core_credit_dispatch(struct hg_addr *hg_addr)
+{
+    HG_QUEUE_HEAD(hg_handle) dispatch_queue;
+    struct hg_handle *hg_handle;
+
+    if (HG_QUEUE_IS_EMPTY(&hg_addr->credit_queue))
+        return;
+
+    HG_QUEUE_INIT(&dispatch_queue);
+
+    hg_thread_spin_lock(&hg_addr->credit_lock);
+    while (hg_addr->in_flight < hg_addr->credits
+        && !HG_QUEUE_IS_EMPTY(&hg_addr->credit_queue)) {
+        hg_handle = HG_QUEUE_FIRST(&hg_addr->credit_queue);
+        HG_QUEUE_POP_HEAD(&hg_addr->credit_queue, credit_entry);
+        hg_handle->credit_queued = HG_FALSE;
+        hg_handle->credit_dispatching = HG_TRUE;
+        hg_handle->credit_held = HG_TRUE;
+        hg_handle->credit_deferred = HG_TRUE;
+        hg_addr->in_flight++;
+        HG_QUEUE_PUSH_TAIL(&dispatch_queue, hg_handle, credit_entry);
+    }
+    hg_thread_spin_unlock(&hg_addr->credit_lock);
+
+    /* Post outside of lock, completion may release credits again */
+    while (!HG_QUEUE_IS_EMPTY(&dispatch_queue)) {
+        hg_bool_t canceled;
+
+        hg_handle = HG_QUEUE_FIRST(&dispatch_queue);
+        HG_QUEUE_POP_HEAD(&dispatch_queue, credit_entry);
+
+        hg_thread_spin_lock(&hg_addr->credit_lock);
+        hg_handle->credit_dispatching = HG_FALSE;
+        canceled = hg_handle->credit_canceled;
+        hg_thread_spin_unlock(&hg_addr->credit_lock);
+
+        if (canceled) {
+            hg_handle->ret = HG_CANCELED;
+            if (hg_core_complete(hg_handle) != HG_SUCCESS)
+                HG_LOG_ERROR("Could not complete handle");
+        } else if (hg_handle->forward(hg_handle) != HG_SUCCESS)
+            HG_LOG_ERROR("Could not forward buffer");
+    }
+}
+
+/*---------------------------------------------------------------------------*/
+static HG_INLINE hg_util_uint64_t
+hg_core_timer_get_tick(struct hg_core_timer_wheel *timer_wheel)
+{
+    hg_time_t now;
+
+    hg_time_get_current(&now);
+
+    return (hg_util_uint64_t) (hg_time_to_double(
+        hg_time_subtract(now, timer_wheel->start)) * 1000.0
+        / HG_CORE_TIMER_TICK);
+}
+
+/*---------------------------------------------------------------------------*/
+static void
+hg_core_timer_arm(struct hg_handle *hg_handle, unsigned int timeout)
+{
+    struct hg_core_timer_wheel *timer_wheel =
+        &hg_handle->hg_info.context->timer_wheel;
+    hg_util_uint64_t tick;
+
+    /* Round up so that the deadline never expires early */
+    tick = hg_core_timer_get_tick(timer_wheel)
+        + (timeout + HG_CORE_TIMER_TICK - 1) / HG_CORE_TIMER_TICK + 1;
+
+    hg_thread_spin_lock(&timer_wheel->lock);
+    hg_handle->timer_tick = tick;
+    HG_LIST_INSERT_HEAD(&timer_wheel->slots[tick % HG_CORE_TIMER_SLOTS],
+        hg_handle, timer_entry);
+    hg_handle->timer_armed = HG_TRUE;
+    hg_atomic_incr32(&timer_wheel->count);
+    hg_thread_spin_unlock(&timer_wheel->lock);
+}
+
+/*---------------------------------------------------------------------------*/
+static void
+hg_core_timer_disarm(struct hg_handle *hg_handle)
+{
+    struct hg_core_timer_wheel *timer_wheel =
+        &hg_handle->hg_info.context->timer_wheel;
+
+    if (!hg_handle->timer_armed)
+        return;
+
+    hg_thread_spin_lock(&timer_wheel->lock);
+    if (hg_handle->timer_armed) {
+        HG_LIST_REMOVE(hg_handle, timer_entry);
+        hg_handle->timer_armed = HG_FALSE;
+        hg_atomic_decr32(&timer_wheel->count);
+    }
+    hg_thread_spin_unlock(&timer_wheel->lock);
+}
+
+/*---------------------------------------------------------------------------*/
+static void
+hg_core_timer_expire(struct hg_context *context)
+{
+    struct hg_core_timer_wheel *timer_wheel = &context->timer_wheel;
+    HG_LIST_HEAD(hg_handle) expired_list;
+    struct hg_handle *hg_handle;
+    hg_util_uint64_t tick, now;
+
+    if (!hg_atomic_get32(&timer_wheel->count))
+        return;
+
+    now = hg_core_timer_get_tick(timer_wheel);
+    HG_LIST_INIT(&expired_list);
+
+    hg_thread_spin_lock(&timer_wheel->lock);
+    /* Visit each slot at most once */
+    tick = timer_wheel->tick;
+    if (now - tick > HG_CORE_TIMER_SLOTS)
+        tick = now - HG_CORE_TIMER_SLOTS;
+    while (tick < now) {
+        struct hg_handle *hg_handle_next;
+
+        tick++;
+        hg_handle = HG_LIST_FIRST(&timer_wheel->slots[tick % HG_CORE_TIMER_SLOTS]);
+        while (hg_handle) {
+            hg_handle_next = HG_LIST_NEXT(hg_handle, timer_entry);
+            /* Skip handles that expire in a later round */
+            if (hg_handle->timer_tick <= now) {
+                HG_LIST_REMOVE(hg_handle, timer_entry);
+                hg_handle->timer_armed = HG_FALSE;
+                hg_handle->timed_out = HG_TRUE;
+                hg_atomic_decr32(&timer_wheel->count);
+                /* Keep handle valid until it is canceled */
+                hg_atomic_incr32(&hg_handle->ref_count);
+                HG_LIST_INSERT_HEAD(&expired_list, hg_handle, timer_entry);
+            }
+            hg_handle = hg_handle_next;
+        }
+    }
+    timer_wheel->tick = now;
+    hg_thread_spin_unlock(&timer_wheel->lock);
+
+    /* Cancel expired forwards, they complete with HG_TIMEOUT */
+    hg_handle = HG_LIST_FIRST(&expired_list);
+    while (hg_handle) {
+        struct hg_handle *hg_handle_next =
+            HG_LIST_NEXT(hg_handle, timer_entry);
+
+        if (hg_core_cancel(hg_handle) != HG_SUCCESS)
+            HG_LOG_ERROR("Could not cancel expired handle");
+        hg_core_destroy(hg_handle);
+        hg_handle = hg_handle_next;
+    }
+}
+
+/*---------------------------------------------------------------------------*/
+static struct hg_core_multi *
+hg_core_multi_create(struct hg_handle *hg_handle, const void *payload,
+    hg_size_t payload_size, const char *names, hg_size_t names_size,
+    hg_uint8_t flags, hg_uint16_t fanout, hg_bool_t is_origin)
+{
+    struct hg_core_multi *multi = NULL;
+
+    multi = (struct hg_core_multi *) malloc(sizeof(struct hg_core_multi));
+    if (!multi) {
+        HG_LOG_ERROR("Could not allocate multi forward");
+        goto done;
+    }
+    memset(multi, 0, sizeof(struct hg_core_multi));
+
+    /* Keep a copy, handle may be reposted before children are forwarded */
+    multi->buf = (char *) malloc(payload_size + names_size + 1);
+    if (!multi->buf) {
+        HG_LOG_ERROR("Could not allocate multi forward buffer");
+        free(multi);
+        multi = NULL;
+        goto done;
+    }
+    memcpy(multi->buf, payload, payload_size);
+    if (names_size)
+        memcpy(multi->buf + payload_size, names, names_size);
+
+    multi->hg_handle = hg_handle;
+    multi->context = hg_handle->hg_info.context;
+    multi->id = hg_handle->hg_info.id;
+    multi->payload_size = payload_size;
+    multi->names_size = names_size;
+    multi->flags = flags;
+    multi->fanout = fanout;
+    multi->is_origin = is_origin;
+    multi->ret = HG_SUCCESS;
+    /* Extra count keeps multi from completing while children are started */
+    multi->pending = 1;
+    hg_thread_spin_init(&multi->lock);
+    /* Released once all children are done */
+    hg_atomic_init32(&multi->ref_count, 1);
+
+done:
+    return multi;
+}
+
+/*---------------------------------------------------------------------------*/
+static void
+hg_core_multi_release(struct hg_core_multi *multi)
+{
+    if (hg_atomic_decr32(&multi->ref_count))
+        return;
+
+    hg_thread_spin_destroy(&multi->lock);
+    free(multi->child_addrs);
+    free(multi->child_names);
+    free(multi->children);
+    free(multi->buf);
+    free(multi);
+}
+
+/*---------------------------------------------------------------------------*/
+static hg_return_t
+hg_core_multi_split(struct hg_core_multi *multi, unsigned int count)
+{
+    const char *name = multi->names_size ?
+        multi->buf + multi->payload_size : NULL;
+    unsigned int child_count, first = 0, i;
+    hg_return_t ret = HG_SUCCESS;
+
+    /* Flat unless there are more addrs than children per node */
+    child_count = (multi->fanout && multi->fanout < count) ?
+        multi->fanout : count;
+
+    multi->children = (struct hg_core_multi_child *) malloc(
+        child_count * sizeof(struct hg_core_multi_child));
+    multi->child_names = (const char **) malloc(
+        child_count * sizeof(const char *));
+    if (!multi->children || !multi->child_names) {
+        HG_LOG_ERROR("Could not allocate children");
+        ret = HG_NOMEM_ERROR;
+        goto done;
+    }
+
+    /* Each child is the first addr of a contiguous range, the rest of the
+     * range is its subtree */
+    for (i = 0; i < child_count; i++) {
+        struct hg_core_multi_child *child = &multi->children[i];
+        unsigned int size = count / child_count + (i < count % child_count);
+        unsigned int j;
+
+        child->index = first;
+        child->names = NULL;
+        child->names_size = 0;
+        child->count = (hg_uint16_t) (size - 1);
+        multi->child_names[i] = name;
+        if (name) {
+            name += strlen(name) + 1;
+            child->names = name;
+            for (j = 1; j < size; j++)
+                name += strlen(name) + 1;
+            child->names_size = (hg_size_t) (name - child->names);
+        }
+        first += size;
+    }
+    multi->child_count = child_count;
+
+done:
+    return ret;
+}
+
+/*---------------------------------------------------------------------------*/
+static hg_return_t
+hg_core_multi_forward_child(struct hg_core_multi *multi,
+    struct hg_addr *hg_addr, const struct hg_core_multi_child *child)
+{
+    struct hg_handle *hg_handle = NULL;
+    hg_size_t header_offset, payload_size = multi->payload_size;
+    hg_uint8_t flags = multi->flags;
+    char *buf;
+    hg_return_t ret = HG_SUCCESS;
+
+    ret = HG_Core_create(multi->context, hg_addr, multi->id,
+        (hg_handle_t *) &hg_handle);
+    if (ret != HG_SUCCESS) {
+        HG_LOG_ERROR("Could not create child handle");
+        goto done;
+    }
+
+    /* Response of target waits for its subtree, which must not wait for
+     * credits held by forwards of the same tree */
+    hg_handle->credit_exempt = !multi->is_origin;
+
+    header_offset = hg_core_header_request_get_size() +
+        hg_handle->na_in_header_offset;
+    if (child->count)
+        payload_size += child->names_size + hg_core_header_tree_get_size();
+    if (header_offset + payload_size > hg_handle->in_buf_size) {
+        HG_LOG_ERROR("Subtree does not fit into input buffer");
+        ret = HG_SIZE_ERROR;
+        goto done;
+    }
+
+    /* Input was encoded once, only copy it */
+    buf = (char *) hg_handle->in_buf + header_offset;
+    memcpy(buf, multi->buf, multi->payload_size);
+
+    /* Child forwards again to its subtree */
+    if (child->count) {
+        struct hg_core_header_tree header;
+
+        memcpy(buf + multi->payload_size, child->names, child->names_size);
+        header.size = (hg_uint32_t) child->names_size;
+        header.count = child->count;
+        header.fanout = multi->fanout;
+        ret = hg_core_header_tree_proc(HG_ENCODE,
+            buf + multi->payload_size + child->names_size,
+            hg_core_header_tree_get_size(), &header);
+        if (ret != HG_SUCCESS) {
+            HG_LOG_ERROR("Could not encode tree header");
+            goto done;
+        }
+        flags |= HG_CORE_TREE_FORWARD;
+    }
+
+    ret = hg_core_forward(hg_handle, hg_core_multi_forward_cb, multi, flags,
+        payload_size, 0, NULL, NULL, 0);
+    if (ret != HG_SUCCESS) {
+        HG_LOG_ERROR("Could not forward to child");
+        goto done;
+    }
+
+done:
+    if (ret != HG_SUCCESS)
+        hg_core_destroy(hg_handle);
+    return ret;
+}
+
+/*---------------------------------------------------------------------------*/
+static hg_return_t
+hg_core_multi_forward_cb(const struct hg_cb_info *callback_info)
+{
+    struct hg_core_multi *multi = (struct hg_core_multi *) callback_info->arg;
+
+    hg_core_multi_done(multi, callback_info->ret);
+    hg_core_destroy((struct hg_handle *) callback_info->info.forward.handle);
+
+    return HG_SUCCESS;
+}
+
+/*---------------------------------------------------------------------------*/
+static hg_return_t
+hg_core_multi_lookup_cb(const struct hg_cb_info *callback_info)
+{
+    struct hg_core_multi *multi = (struct hg_core_multi *) callback_info->arg;
+    unsigned int i;
+
+    /* Keep multi from completing while children are forwarded */
+    hg_thread_spin_lock(&multi->lock);
+    multi->pending++;
+    hg_thread_spin_unlock(&multi->lock);
+
+    for (i = 0; i < multi->child_count; i++) {
+        struct hg_addr *hg_addr = multi->child_addrs[i];
+        hg_return_t ret;
+
+        if (hg_addr == HG_ADDR_NULL) {
+            HG_LOG_ERROR("Could not lookup child %s", multi->child_names[i]);
+            hg_core_multi_done(multi, callback_info->ret);
+            continue;
+        }
+        ret = hg_core_multi_forward_child(multi, hg_addr, &multi->children[i]);
+        hg_core_addr_free(multi->context->hg_class, hg_addr);
+        if (ret != HG_SUCCESS)
+            hg_core_multi_done(multi, ret);
+    }
+
+    hg_core_multi_done(multi, HG_SUCCESS);
+
+    return HG_SUCCESS;
+}
+
+/*---------------------------------------------------------------------------*/
+static void
+hg_core_multi_done(struct hg_core_multi *multi, hg_return_t ret)
+{
+    struct hg_handle *hg_handle = multi->hg_handle;
+    hg_bool_t last, respond = HG_FALSE;
+
+    hg_thread_spin_lock(&multi->lock);
+    if (ret != HG_SUCCESS && multi->ret == HG_SUCCESS)
+        multi->ret = ret;
+    last = (--multi->pending == 0);
+    if (last) {
+        respond = multi->respond_deferred;
+        multi->respond_deferred = HG_FALSE;
+    }
+    hg_thread_spin_unlock(&multi->lock);
+    if (!last)
+        return;
+
+    if (multi->is_origin) {
+        /* Complete forward with first error of children */
+        hg_handle->ret = multi->ret;
+        hg_handle->multi = NULL;
+        hg_core_multi_release(multi);
+        if (hg_core_complete(hg_handle) != HG_SUCCESS)
+            HG_LOG_ERROR("Could not complete multi forward");
+    } else if (respond) {
+        /* Send response that waited for subtree */
+        if (hg_core_respond(hg_handle, multi->respond_callback,
+            multi->respond_arg, multi->respond_flags,
+            multi->respond_payload_size, 0, NULL, NULL) != HG_SUCCESS)
+            HG_LOG_ERROR("Could not send deferred response");
+    }
+    hg_core_multi_release(multi);
+}
+
+/*---------------------------------------------------------------------------*/
+static hg_return_t
+hg_core_tree_forward(struct hg_handle *hg_handle)
+{
+    struct hg_core_header_tree header;
+    struct hg_core_multi *multi;
+    hg_size_t header_offset = hg_core_header_request_get_size() +
+        hg_handle->na_in_header_offset;
+    hg_size_t tree_size = hg_core_header_tree_get_size();
+    const char *names;
+    unsigned int i, n = 0;
+    hg_return_t ret = HG_SUCCESS;
+
+    if (hg_handle->in_buf_used < header_offset + tree_size) {
+        HG_LOG_ERROR("Request too small for tree header");
+        ret = HG_SIZE_ERROR;
+        goto done;
+    }
+    ret = hg_core_header_tree_proc(HG_DECODE,
+        (char *) hg_handle->in_buf + hg_handle->in_buf_used - tree_size,
+        tree_size, &header);
+    if (ret != HG_SUCCESS) {
+        HG_LOG_ERROR("Could not decode tree header");
+        goto done;
+    }
+    if (header.size > hg_handle->in_buf_used - header_offset - tree_size) {
+        HG_LOG_ERROR("Invalid tree header");
+        ret = HG_PROTOCOL_ERROR;
+        goto done;
+    }
+
+    /* Names must be count null terminated strings */
+    names = (const char *) hg_handle->in_buf + hg_handle->in_buf_used
+        - tree_size - header.size;
+    for (i = 0; i < header.size; i++)
+        if (names[i] == '\0')
+            n++;
+    if (!header.count || n != header.count || names[header.size - 1] != '\0') {
+        HG_LOG_ERROR("Invalid subtree addr names");
+        ret = HG_PROTOCOL_ERROR;
+        goto done;
+    }
+
+    /* Only payload is left to decode */
+    hg_handle->in_buf_used -= tree_size + header.size;
+
+    multi = hg_core_multi_create(hg_handle,
+        (char *) hg_handle->in_buf + header_offset,
+        hg_handle->in_buf_used - header_offset, names, header.size,
+        hg_handle->in_header.msg.request.flags & HG_CORE_NO_RESPONSE,
+        header.fanout, HG_FALSE);
+    if (!multi) {
+        ret = HG_NOMEM_ERROR;
+        goto done;
+    }
+
+    /* Response waits for multi */
+    hg_atomic_incr32(&multi->ref_count);
+    hg_handle->multi = multi;
+
+    ret = hg_core_multi_split(multi, header.count);
+    if (ret == HG_SUCCESS) {
+        multi->child_addrs = (struct hg_addr **) malloc(
+            multi->child_count * sizeof(struct hg_addr *));
+        if (!multi->child_addrs) {
+            HG_LOG_ERROR("Could not allocate children addrs");
+            ret = HG_NOMEM_ERROR;
+        }
+    }
+
+    /* Look up all children at once */
+    if (ret == HG_SUCCESS) {
+        multi->pending++;
+        ret = hg_core_addr_lookup_batch(multi->context,
+            hg_core_multi_lookup_cb, multi,
+            (const char *const *) multi->child_names, multi->child_count,
+            multi->child_addrs);
+        if (ret != HG_SUCCESS) {
+            HG_LOG_ERROR("Could not lookup children");
+            multi->pending--;
         }
     }
 
+    /* Subtree error is returned with response */
+    hg_core_multi_done(multi, ret);
+
 done:
     return ret;
 }
 
+/*---------------------------------------------------------------------------*/
+#ifdef HG_HAS_COLLECT_STATS
+static void
+hg_core_progress_acct_reset(struct hg_context *context)
+{
+    struct hg_core_progress_acct *acct = &context->acct;
+    struct hg_poll_stats poll_stats = {0, 0};
+
+    hg_poll_get_stats(context->poll_set, &poll_stats);
+    hg_atomic_set64(&acct->progress_count, 0);
+    hg_atomic_set64(&acct->empty_count, 0);
+    hg_atomic_set64(&acct->progress_time, 0);
+    hg_atomic_set64(&acct->empty_time, 0);
+    hg_atomic_set64(&acct->trigger_count, 0);
+    hg_atomic_set64(&acct->trigger_time, 0);
+    hg_atomic_set64(&acct->batch_count, 0);
+    hg_atomic_set64(&acct->batch_rpc_count, 0);
+    hg_atomic_set64(&acct->header_reuse_count, 0);
+    hg_atomic_set64(&acct->wait_time_base,
+        (hg_util_int64_t) poll_stats.wait_time);
+
+    NA_Progress_stats_reset(context->hg_class->na_class, context->na_context);
+#ifdef HG_HAS_SM_ROUTING
+    if (context->na_sm_context)
+        NA_Progress_stats_reset(context->hg_class->na_sm_class,
+            context->na_sm_context);
+#endif
+}
+
+/*---------------------------------------------------------------------------*/
+static void
+hg_core_progress_acct_add_na(na_class_t *na_class, na_context_t *na_context,
+    struct hg_progress_stats *stats)
+{
+    struct na_progress_stats na_stats;
+
+    if (NA_Progress_stats_get(na_class, na_context, &na_stats) != NA_SUCCESS)
+        return;
+
+    /* Time blocked in the plugin is reported as wait time */
+    stats->wait_time += na_stats.wait_time;
+    if (na_stats.progress_time > na_stats.wait_time)
+        stats->na_progress_time += na_stats.progress_time - na_stats.wait_time;
+    stats->na_trigger_count += na_stats.trigger_count;
+    stats->na_trigger_time += na_stats.trigger_time;
+}
+#endif
+
 /*---------------------------------------------------------------------------*/
 hg_class_t *
 HG_Core_init(const char *na_info_string, hg_bool_t na_listen)
@@ -3555,9 +6474,8 @@ HG_Core_context_create(hg_class_t *hg_class)
     hg_return_t ret = HG_SUCCESS;
     struct hg_context *context = NULL;
     int na_poll_fd;
-#ifdef HG_HAS_SELF_FORWARD
+    unsigned int i;
     int fd;
-#endif
 
     if (!hg_class) {
         HG_LOG_ERROR("NULL HG class");
@@ -3582,11 +6500,28 @@ HG_Core_context_create(hg_class_t *hg_class)
     }
     HG_QUEUE_INIT(&context->backfill_queue);
     hg_atomic_init32(&context->backfill_queue_count, 0);
+    HG_QUEUE_INIT(&context->priority_queue);
+    hg_atomic_init32(&context->priority_queue_count, 0);
+    for (i = 0; i < HG_CORE_RPC_CLASSES; i++) {
+        hg_atomic_init32(&context->rpc_queued[i], 0);
+        context->rpc_queue_limit[i] = 0;
+    }
     HG_LIST_INIT(&context->pending_list);
     HG_LIST_INIT(&context->processing_list);
 
     /* No handle created yet */
     hg_atomic_init32(&context->n_handles, 0);
+    hg_atomic_init32(&context->pending_count, 0);
+
+    /* Origins being served */
+    context->origin_table = hg_hash_table_new(hg_core_origin_hash,
+        hg_core_origin_equal);
+    if (!context->origin_table) {
+        HG_LOG_ERROR("Could not create origin table");
+        ret = HG_NOMEM_ERROR;
+        goto done;
+    }
+    hg_thread_mutex_init(&context->origin_mutex);
 
     /* Initialize completion queue mutex/cond */
     hg_thread_mutex_init(&context->completion_queue_mutex);
@@ -3596,6 +6531,25 @@ HG_Core_context_create(hg_class_t *hg_class)
     hg_thread_spin_init(&context->pending_list_lock);
     hg_thread_spin_init(&context->processing_list_lock);
 
+    /* Initialize timer wheel */
+    for (i = 0; i < HG_CORE_TIMER_SLOTS; i++)
+        HG_LIST_INIT(&context->timer_wheel.slots[i]);
+    hg_time_get_current(&context->timer_wheel.start);
+    context->timer_wheel.tick = 0;
+    hg_atomic_init32(&context->timer_wheel.count, 0);
+    hg_thread_spin_init(&context->timer_wheel.lock);
+
+    /* No coalescing by default */
+    HG_LIST_INIT(&context->batch_list);
+    hg_thread_mutex_init(&context->batch_mutex);
+    context->batch_window = 0;
+    context->coalesce = HG_FALSE;
+    HG_LIST_INIT(&context->batch_pool);
+    context->batch_pool_count = 0;
+    hg_thread_spin_init(&context->batch_pool_lock);
+
+    hg_thread_rwlock_init(&context->executor_lock);
+
     context->na_context = NA_Context_create(hg_class->na_class);
     if (!context->na_context) {
         HG_LOG_ERROR("Could not create NA context");
@@ -3621,7 +6575,6 @@ HG_Core_context_create(hg_class_t *hg_class)
         goto done;
     }
 
-#ifdef HG_HAS_SELF_FORWARD
     /* Create event for completion queue notification */
     fd = hg_event_create();
     if (fd < 0) {
@@ -3634,7 +6587,6 @@ HG_Core_context_create(hg_class_t *hg_class)
     /* Add event to context poll set */
     hg_poll_add(context->poll_set, fd, HG_POLLIN,
         hg_core_completion_queue_notify_cb, context);
-#endif
 
     if (context->hg_class->progress_mode == NA_NO_BLOCK)
         /* Force to use progress poll */
@@ -3677,6 +6629,17 @@ HG_Core_context_create(hg_class_t *hg_class)
     }
 #endif
 
+#ifdef HG_HAS_COLLECT_STATS
+    /* Account time spent in NA progress and callbacks */
+    NA_Progress_stats_enable(hg_class->na_class, context->na_context, NA_TRUE);
+#ifdef HG_HAS_SM_ROUTING
+    if (context->na_sm_context)
+        NA_Progress_stats_enable(hg_class->na_sm_class, context->na_sm_context,
+            NA_TRUE);
+#endif
+    hg_core_progress_acct_reset(context);
+#endif
+
     /* Increment context count of parent class */
     hg_atomic_incr32(&hg_class->n_contexts);
 
@@ -3697,12 +6660,17 @@ HG_Core_context_destroy(hg_context_t *context)
     unsigned int actual_count;
     int na_poll_fd;
     hg_util_int32_t n_handles;
+    hg_executor_t *executor;
 
     if (!context) goto done;
 
     /* Prevent repost of handles */
     context->finalizing = HG_TRUE;
 
+    /* Send forwards still waiting to be coalesced */
+    context->coalesce = HG_FALSE;
+    hg_core_batch_flush(context, HG_TRUE);
+
     /* Check pending list and cancel posted handles */
     if (!HG_LIST_IS_EMPTY(&context->pending_list)) {
         ret = hg_core_pending_list_cancel(context);
@@ -3726,6 +6694,15 @@ HG_Core_context_destroy(hg_context_t *context)
     }
 #endif
 
+    /* Let handler threads run RPC callbacks already posted, RPCs that are
+     * still triggered from now on are processed inline */
+    hg_thread_rwlock_wrlock(&context->executor_lock);
+    executor = context->executor;
+    context->executor = NULL;
+    hg_thread_rwlock_release_wrlock(&context->executor_lock);
+    if (executor)
+        hg_executor_destroy(executor);
+
     /* Check that operations have completed */
     ret = hg_core_processing_list_wait(context);
     if (ret != HG_SUCCESS) {
@@ -3738,6 +6715,9 @@ HG_Core_context_destroy(hg_context_t *context)
     hg_thread_pool_destroy(context->self_processing_pool);
 #endif
 
+    /* Free handles kept for batch requests */
+    hg_core_batch_pool_free(context);
+
     /* Number of handles for that context should be 0 */
     n_handles = hg_atomic_get32(&context->n_handles);
     if (n_handles != 0) {
@@ -3757,7 +6737,8 @@ HG_Core_context_destroy(hg_context_t *context)
 
     /* Check that completion queue is empty now */
     hg_thread_mutex_lock(&context->completion_queue_mutex);
-    if (!HG_QUEUE_IS_EMPTY(&context->backfill_queue)) {
+    if (!HG_QUEUE_IS_EMPTY(&context->backfill_queue)
+        || !HG_QUEUE_IS_EMPTY(&context->priority_queue)) {
         HG_LOG_ERROR("Completion queue should be empty");
         ret = HG_PROTOCOL_ERROR;
         hg_thread_mutex_unlock(&context->completion_queue_mutex);
@@ -3765,21 +6746,19 @@ HG_Core_context_destroy(hg_context_t *context)
     }
     hg_thread_mutex_unlock(&context->completion_queue_mutex);
 
-#ifdef HG_HAS_SELF_FORWARD
     if (context->completion_queue_notify > 0) {
         if (hg_poll_remove(context->poll_set, context->completion_queue_notify)
             != HG_UTIL_SUCCESS) {
-            HG_LOG_ERROR("Could not remove self processing event from poll set");
+            HG_LOG_ERROR("Could not remove completion queue event from poll set");
             ret = HG_PROTOCOL_ERROR;
             goto done;
         }
         if (hg_event_destroy(context->completion_queue_notify) != HG_UTIL_SUCCESS) {
-            HG_LOG_ERROR("Could not destroy self processing event");
+            HG_LOG_ERROR("Could not destroy completion queue event");
             ret = HG_PROTOCOL_ERROR;
             goto done;
         }
     }
-#endif
 
     if (context->hg_class->progress_mode == NA_NO_BLOCK)
         /* Was forced to use progress poll */
@@ -3847,6 +6826,18 @@ HG_Core_context_destroy(hg_context_t *context)
     hg_thread_cond_destroy(&context->completion_queue_cond);
     hg_thread_spin_destroy(&context->pending_list_lock);
     hg_thread_spin_destroy(&context->processing_list_lock);
+    hg_thread_spin_destroy(&context->timer_wheel.lock);
+    hg_thread_mutex_destroy(&context->batch_mutex);
+    hg_thread_spin_destroy(&context->batch_pool_lock);
+    hg_thread_rwlock_destroy(&context->executor_lock);
+    hg_thread_mutex_destroy(&context->origin_mutex);
+    if (context->origin_table)
+        hg_hash_table_free(context->origin_table);
+
+#ifdef HG_HAS_COLLECT_STATS
+    /* Keep stats of context in class stats */
+    hg_stats_retire(context->hg_class, context);
+#endif
 
     /* Decrement context count of parent class */
     hg_atomic_decr32(&context->hg_class->n_contexts);
@@ -3969,6 +6960,90 @@ HG_Core_context_set_data(hg_context_t *context, void *data,
     return ret;
 }
 
+/*---------------------------------------------------------------------------*/
+hg_return_t
+HG_Core_context_set_handler_threads(hg_context_t *context,
+    unsigned int thread_count)
+{
+    hg_executor_t *executor = NULL, *old_executor;
+    hg_return_t ret = HG_SUCCESS;
+
+    if (!context) {
+        HG_LOG_ERROR("NULL HG context");
+        ret = HG_INVALID_PARAM;
+        goto done;
+    }
+
+    if (thread_count
+        && hg_executor_create(thread_count, &executor) != HG_UTIL_SUCCESS) {
+        HG_LOG_ERROR("Could not create handler threads");
+        ret = HG_NOMEM_ERROR;
+        goto done;
+    }
+
+    /* Swap under the lock so that no RPC is posted to the previous handler
+     * threads once they are destroyed, they run posted RPC callbacks before
+     * exiting */
+    hg_thread_rwlock_wrlock(&context->executor_lock);
+    old_executor = context->executor;
+    context->executor = executor;
+    hg_thread_rwlock_release_wrlock(&context->executor_lock);
+    if (old_executor)
+        hg_executor_destroy(old_executor);
+
+ done:
+    return ret;
+}
+
+/*---------------------------------------------------------------------------*/
+hg_return_t
+HG_Core_context_set_coalescing(hg_context_t *context, hg_bool_t enable,
+    unsigned int window)
+{
+    hg_return_t ret = HG_SUCCESS;
+
+    if (!context) {
+        HG_LOG_ERROR("NULL HG context");
+        ret = HG_INVALID_PARAM;
+        goto done;
+    }
+
+    context->batch_window = window;
+    context->coalesce = enable;
+
+    /* Do not keep forwards waiting once disabled */
+    if (!enable)
+        hg_core_batch_flush(context, HG_TRUE);
+
+ done:
+    return ret;
+}
+
+/*---------------------------------------------------------------------------*/
+hg_return_t
+HG_Core_context_set_queue_limit(hg_context_t *context,
+    hg_handler_priority_t priority, unsigned int limit)
+{
+    hg_return_t ret = HG_SUCCESS;
+
+    if (!context) {
+        HG_LOG_ERROR("NULL HG context");
+        ret = HG_INVALID_PARAM;
+        goto done;
+    }
+    if (priority > HG_HANDLER_INLINE) {
+        HG_LOG_ERROR("Invalid handler priority");
+        ret = HG_INVALID_PARAM;
+        goto done;
+    }
+
+    context->rpc_queue_limit[(priority == HG_HANDLER_HIGH) ?
+        HG_CORE_RPC_CLASS_HIGH : HG_CORE_RPC_CLASS_NORMAL] = limit;
+
+ done:
+    return ret;
+}
+
 /*---------------------------------------------------------------------------*/
 void *
 HG_Core_context_get_data(const hg_context_t *context)
@@ -4058,6 +7133,8 @@ HG_Core_register(hg_class_t *hg_class, hg_id_t id, hg_rpc_cb_t rpc_cb)
         hg_rpc_info->rpc_cb = rpc_cb;
         hg_rpc_info->data = NULL;
         hg_rpc_info->free_callback = NULL;
+        hg_rpc_info->affinity = HG_HANDLER_ANY_THREAD;
+        hg_rpc_info->priority = HG_HANDLER_NORMAL;
 
         hg_thread_spin_lock(&hg_class->func_map_lock);
         hash_ret = hg_hash_table_insert(hg_class->func_map,
@@ -4137,6 +7214,44 @@ done:
     return ret;
 }
 
+/*---------------------------------------------------------------------------*/
+hg_return_t
+HG_Core_registered_handler_hints(hg_class_t *hg_class, hg_id_t id,
+    hg_handler_priority_t priority, unsigned int affinity)
+{
+    struct hg_rpc_info *hg_rpc_info = NULL;
+    hg_return_t ret = HG_SUCCESS;
+
+    if (!hg_class) {
+        HG_LOG_ERROR("NULL HG class");
+        ret = HG_INVALID_PARAM;
+        goto done;
+    }
+
+    if (priority > HG_HANDLER_INLINE) {
+        HG_LOG_ERROR("Invalid handler priority");
+        ret = HG_INVALID_PARAM;
+        goto done;
+    }
+
+    hg_thread_spin_lock(&hg_class->func_map_lock);
+    hg_rpc_info = (struct hg_rpc_info *) hg_hash_table_lookup(hg_class->func_map,
+            (hg_hash_table_key_t) &id);
+    if (hg_rpc_info) {
+        hg_rpc_info->priority = priority;
+        hg_rpc_info->affinity = affinity;
+    }
+    hg_thread_spin_unlock(&hg_class->func_map_lock);
+    if (!hg_rpc_info) {
+        HG_LOG_ERROR("Could not find RPC ID in function map");
+        ret = HG_NO_MATCH;
+        goto done;
+    }
+
+done:
+    return ret;
+}
+
 /*---------------------------------------------------------------------------*/
 void *
 HG_Core_registered_data(hg_class_t *hg_class, hg_id_t id)
@@ -4164,6 +7279,93 @@ done:
    return data;
 }
 
+/*---------------------------------------------------------------------------*/
+hg_return_t
+HG_Core_stats_get(hg_class_t *hg_class, hg_context_t *context, hg_id_t id,
+    struct hg_stats *stats)
+{
+    hg_return_t ret = HG_SUCCESS;
+
+    if (!hg_class) {
+        HG_LOG_ERROR("NULL HG class");
+        ret = HG_INVALID_PARAM;
+        goto done;
+    }
+    if (!stats) {
+        HG_LOG_ERROR("NULL pointer to stats");
+        ret = HG_INVALID_PARAM;
+        goto done;
+    }
+    if (context && context->hg_class != hg_class) {
+        HG_LOG_ERROR("Context does not belong to HG class");
+        ret = HG_INVALID_PARAM;
+        goto done;
+    }
+
+#ifdef HG_HAS_COLLECT_STATS
+    hg_stats_get(hg_class, context, id, stats);
+#else
+    (void) id;
+    HG_LOG_ERROR("Stats collection was not enabled");
+    ret = HG_INVALID_PARAM;
+#endif
+
+done:
+    return ret;
+}
+
+/*---------------------------------------------------------------------------*/
+hg_return_t
+HG_Core_stats_reset(hg_class_t *hg_class, hg_context_t *context, hg_id_t id)
+{
+    hg_return_t ret = HG_SUCCESS;
+
+    if (!hg_class) {
+        HG_LOG_ERROR("NULL HG class");
+        ret = HG_INVALID_PARAM;
+        goto done;
+    }
+    if (context && context->hg_class != hg_class) {
+        HG_LOG_ERROR("Context does not belong to HG class");
+        ret = HG_INVALID_PARAM;
+        goto done;
+    }
+
+#ifdef HG_HAS_COLLECT_STATS
+    hg_stats_reset(hg_class, context, id);
+#else
+    (void) id;
+    HG_LOG_ERROR("Stats collection was not enabled");
+    ret = HG_INVALID_PARAM;
+#endif
+
+done:
+    return ret;
+}
+
+/*---------------------------------------------------------------------------*/
+hg_return_t
+HG_Core_trace_dump(const char *filename)
+{
+    hg_return_t ret = HG_SUCCESS;
+
+    if (!filename) {
+        HG_LOG_ERROR("NULL file name");
+        ret = HG_INVALID_PARAM;
+        goto done;
+    }
+
+#ifdef HG_HAS_TRACE
+    ret = hg_trace_dump(filename);
+#else
+    HG_LOG_ERROR("Tracing was not enabled");
+    ret = HG_INVALID_PARAM;
+#endif
+
+done:
+    return ret;
+}
+
 /*---------------------------------------------------------------------------*/
 hg_return_t
 HG_Core_addr_lookup(hg_context_t *context, hg_cb_t callback, void *arg,
@@ -4197,6 +7399,48 @@ done:
     return ret;
 }
 
+/*---------------------------------------------------------------------------*/
+hg_return_t
+HG_Core_addr_lookup_batch(hg_context_t *context, hg_cb_t callback, void *arg,
+    const char *const names[], unsigned int count, hg_addr_t addrs[])
+{
+    unsigned int i;
+    hg_return_t ret = HG_SUCCESS;
+
+    if (!context) {
+        HG_LOG_ERROR("NULL HG context");
+        ret = HG_INVALID_PARAM;
+        goto done;
+    }
+    if (!callback) {
+        HG_LOG_ERROR("NULL callback");
+        ret = HG_INVALID_PARAM;
+        goto done;
+    }
+    if (count && (!names || !addrs)) {
+        HG_LOG_ERROR("NULL lookup names or addrs");
+        ret = HG_INVALID_PARAM;
+        goto done;
+    }
+    for (i = 0; i < count; i++) {
+        if (!names[i]) {
+            HG_LOG_ERROR("NULL lookup name");
+            ret = HG_INVALID_PARAM;
+            goto done;
+        }
+    }
+
+    ret = hg_core_addr_lookup_batch(context, callback, arg, names, count,
+        addrs);
+    if (ret != HG_SUCCESS) {
+        HG_LOG_ERROR("Could not lookup addresses");
+        goto done;
+    }
+
+done:
+    return ret;
+}
+
 /*---------------------------------------------------------------------------*/
 hg_return_t
 HG_Core_addr_free(hg_class_t *hg_class, hg_addr_t addr)
@@ -4209,11 +7453,30 @@ HG_Core_addr_free(hg_class_t *hg_class, hg_addr_t addr)
         goto done;
     }
 
-    ret = hg_core_addr_free(hg_class, addr);
-    if (ret != HG_SUCCESS) {
-        HG_LOG_ERROR("Could not free address");
-        goto done;
-    }
+    ret = hg_core_addr_free(hg_class, addr);
+    if (ret != HG_SUCCESS) {
+        HG_LOG_ERROR("Could not free address");
+        goto done;
+    }
+
+done:
+    return ret;
+}
+
+/*---------------------------------------------------------------------------*/
+hg_return_t
+HG_Core_addr_cache_invalidate(hg_class_t *hg_class, const char *name)
+{
+    hg_return_t ret = HG_SUCCESS;
+
+    if (!hg_class) {
+        HG_LOG_ERROR("NULL HG class");
+        ret = HG_INVALID_PARAM;
+        goto done;
+    }
+
+    if (hg_class->addr_cache)
+        hg_core_addr_cache_invalidate(hg_class, name);
 
 done:
     return ret;
@@ -4377,6 +7640,7 @@ HG_Core_create(hg_context_t *context, hg_addr_t addr, hg_id_t id,
         HG_LOG_ERROR("Could not set rpc to handle");
         goto done;
     }
+    HG_TRACE(HG_TRACE_CREATE, hg_handle, id, 0);
 
     *handle = (hg_handle_t) hg_handle;
 
@@ -4456,6 +7720,26 @@ done:
     return ret;
 }
 
+/*---------------------------------------------------------------------------*/
+hg_return_t
+HG_Core_prepare(hg_handle_t handle)
+{
+    struct hg_handle *hg_handle = (struct hg_handle *) handle;
+    hg_return_t ret = HG_SUCCESS;
+
+    if (!handle) {
+        HG_LOG_ERROR("NULL HG handle");
+        ret = HG_INVALID_PARAM;
+        goto done;
+    }
+
+    /* Header is kept once encoded by next forward */
+    hg_handle->prepared = HG_TRUE;
+
+done:
+    return ret;
+}
+
 /*---------------------------------------------------------------------------*/
 hg_return_t
 HG_Core_ref_incr(hg_handle_t handle)
@@ -4547,6 +7831,9 @@ HG_Core_set_target_id(hg_handle_t handle, hg_uint8_t target_id)
 
     hg_handle->hg_info.target_id = target_id;
 
+    /* Encoded request header no longer matches */
+    hg_handle->header_encoded = HG_FALSE;
+
 done:
     return ret;
 }
@@ -4602,11 +7889,11 @@ done:
 }
 
 /*---------------------------------------------------------------------------*/
-hg_return_t
-HG_Core_forward(hg_handle_t handle, hg_cb_t callback, void *arg,
-    hg_uint8_t flags, hg_size_t payload_size)
+static hg_return_t
+hg_core_forward(struct hg_handle *hg_handle, hg_cb_t callback, void *arg,
+    hg_uint8_t flags, hg_size_t payload_size, hg_uint32_t count,
+    void **buf_ptrs, const hg_size_t *buf_sizes, unsigned int timeout)
 {
-    struct hg_handle *hg_handle = (struct hg_handle *) handle;
     hg_size_t header_size;
     hg_return_t ret = HG_SUCCESS;
 
@@ -4655,6 +7942,15 @@ HG_Core_forward(hg_handle_t handle, hg_cb_t callback, void *arg,
         goto done;
     }
 
+    /* Set extra segments */
+    ret = hg_core_set_iov(hg_handle, &hg_handle->in_iov, hg_handle->in_buf,
+        hg_handle->in_buf_size, &hg_handle->in_buf_used, count, buf_ptrs,
+        buf_sizes);
+    if (ret != HG_SUCCESS) {
+        HG_LOG_ERROR("Could not set extra input segments");
+        goto done;
+    }
+
     /* Parse flags */
     if (flags & HG_CORE_NO_RESPONSE)
         hg_handle->no_response = HG_TRUE;
@@ -4671,13 +7967,22 @@ HG_Core_forward(hg_handle_t handle, hg_cb_t callback, void *arg,
     hg_handle->in_header.msg.request.flags = flags;
     hg_handle->in_header.msg.request.cookie = hg_handle->hg_info.target_id;
 
-    /* Encode request header */
-    ret = hg_core_proc_header_request(hg_handle, &hg_handle->in_header,
-        HG_ENCODE);
-    if (ret != HG_SUCCESS) {
-        HG_LOG_ERROR("Could not encode header");
-        goto done;
+    /* Encode request header, prepared handles still have it in their buffer
+     * from previous forward if flags did not change */
+    if (!hg_handle->header_encoded || hg_handle->header_flags != flags) {
+        ret = hg_core_proc_header_request(hg_handle, &hg_handle->in_header,
+            HG_ENCODE);
+        if (ret != HG_SUCCESS) {
+            HG_LOG_ERROR("Could not encode header");
+            goto done;
+        }
+        hg_handle->header_encoded = hg_handle->prepared;
+        hg_handle->header_flags = flags;
     }
+#ifdef HG_HAS_COLLECT_STATS
+    else
+        hg_atomic_incr64(&hg_handle->hg_info.context->acct.header_reuse_count);
+#endif
 
     /* Increase ref count here so that a call to HG_Destroy does not free the
      * handle but only schedules its completion
@@ -4687,11 +7992,39 @@ HG_Core_forward(hg_handle_t handle, hg_cb_t callback, void *arg,
     /* Handle is now in use */
     hg_atomic_set32(&hg_handle->in_use, HG_TRUE);
 
+    HG_TRACE(HG_TRACE_FORWARD, hg_handle, hg_handle->hg_info.id,
+        hg_handle->in_buf_used);
+#ifdef HG_HAS_COLLECT_STATS
+    HG_CORE_STATS_INCR(hg_handle, HG_STATS_FORWARD);
+    hg_time_get_current(&hg_handle->stats_forward);
+#endif
+
+    /* Arm deadline before posting so that completion can disarm it (self
+     * forwards cannot be canceled and are not timed) */
+    hg_handle->timed_out = HG_FALSE;
+    if (timeout && !hg_handle->is_self)
+        hg_core_timer_arm(hg_handle, timeout);
+
+    /* Wait for a credit if target cannot take more forwards from us (extra
+     * segments are only valid during this call and cannot wait) */
+    hg_handle->ret = HG_SUCCESS;
+    hg_handle->credit_deferred = HG_FALSE;
+    hg_handle->credit_canceled = HG_FALSE;
+    /* Forwards waiting for credits must trigger as forwards */
+    if (!hg_handle->is_self)
+        hg_handle->op_type = HG_CORE_FORWARD;
+    if (!hg_handle->is_self && !hg_handle->in_iov.count
+        && !hg_handle->credit_exempt && !hg_core_credit_acquire(hg_handle))
+        goto done;
+
     /* If addr is self, forward locally, otherwise send the encoded buffer
      * through NA and pre-post response */
     ret = hg_handle->forward(hg_handle);
+    hg_handle->in_iov.count = 0;
     if (ret != HG_SUCCESS) {
         HG_LOG_ERROR("Could not forward buffer");
+        hg_core_timer_disarm(hg_handle);
+        hg_core_credit_release(hg_handle);
         /* Handle is no longer in use */
         hg_atomic_set32(&hg_handle->in_use, HG_FALSE);
         /* Rollback ref_count taken above */
@@ -4705,10 +8038,190 @@ done:
 
 /*---------------------------------------------------------------------------*/
 hg_return_t
-HG_Core_respond(hg_handle_t handle, hg_cb_t callback, void *arg,
+HG_Core_forward(hg_handle_t handle, hg_cb_t callback, void *arg,
     hg_uint8_t flags, hg_size_t payload_size)
+{
+    return hg_core_forward((struct hg_handle *) handle, callback, arg, flags,
+        payload_size, 0, NULL, NULL, 0);
+}
+
+/*---------------------------------------------------------------------------*/
+hg_return_t
+HG_Core_forward_timed(hg_handle_t handle, hg_cb_t callback, void *arg,
+    hg_uint8_t flags, hg_size_t payload_size, unsigned int timeout)
+{
+    return hg_core_forward((struct hg_handle *) handle, callback, arg, flags,
+        payload_size, 0, NULL, NULL, timeout);
+}
+
+/*---------------------------------------------------------------------------*/
+hg_return_t
+HG_Core_forward_iov(hg_handle_t handle, hg_cb_t callback, void *arg,
+    hg_uint8_t flags, hg_size_t payload_size, hg_uint32_t count,
+    void **buf_ptrs, const hg_size_t *buf_sizes)
+{
+    hg_return_t ret = HG_SUCCESS;
+
+    if (count && (!buf_ptrs || !buf_sizes)) {
+        HG_LOG_ERROR("NULL segments");
+        ret = HG_INVALID_PARAM;
+        goto done;
+    }
+
+    ret = hg_core_forward((struct hg_handle *) handle, callback, arg, flags,
+        payload_size, count, buf_ptrs, buf_sizes, 0);
+
+done:
+    return ret;
+}
+
+/*---------------------------------------------------------------------------*/
+hg_return_t
+HG_Core_forward_multi(hg_handle_t handle, hg_cb_t callback, void *arg,
+    hg_uint8_t flags, hg_size_t payload_size, hg_addr_t *addrs,
+    unsigned int count, unsigned int fanout)
 {
     struct hg_handle *hg_handle = (struct hg_handle *) handle;
+    struct hg_core_multi *multi = NULL;
+    char *names = NULL;
+    hg_size_t header_offset, names_size = 0;
+    unsigned int i;
+    hg_return_t ret = HG_SUCCESS;
+
+    if (!hg_handle) {
+        HG_LOG_ERROR("NULL handle");
+        ret = HG_INVALID_PARAM;
+        goto done;
+    }
+    if (!hg_handle->hg_info.id) {
+        HG_LOG_ERROR("NULL RPC ID");
+        ret = HG_INVALID_PARAM;
+        goto done;
+    }
+    if (!addrs || !count || count > 0xFFFF || fanout > 0xFFFF) {
+        HG_LOG_ERROR("Invalid target addrs");
+        ret = HG_INVALID_PARAM;
+        goto done;
+    }
+    for (i = 0; i < count; i++) {
+        if (addrs[i] == HG_ADDR_NULL) {
+            HG_LOG_ERROR("NULL target addr");
+            ret = HG_INVALID_PARAM;
+            goto done;
+        }
+    }
+    if (flags & HG_CORE_MORE_DATA) {
+        HG_LOG_ERROR("Input of multi forward must fit into input buffer");
+        ret = HG_SIZE_ERROR;
+        goto done;
+    }
+    if (hg_atomic_get32(&hg_handle->in_use)) {
+        HG_LOG_ERROR("Handle is still in use");
+        ret = HG_PROTOCOL_ERROR;
+        goto done;
+    }
+
+    header_offset = hg_core_header_request_get_size() +
+        hg_handle->na_in_header_offset;
+    if (header_offset + payload_size > hg_handle->in_buf_size) {
+        HG_LOG_ERROR("Exceeding input buffer size");
+        ret = HG_SIZE_ERROR;
+        goto done;
+    }
+
+    /* Children forward again if there are more addrs than children, pass
+     * names of all addrs so that subtrees can be sent along */
+    if (fanout && fanout < count) {
+        char *name;
+
+        for (i = 0; i < count; i++) {
+            hg_size_t size = 0;
+
+            ret = hg_core_addr_to_string(hg_handle->hg_info.hg_class, NULL,
+                &size, addrs[i]);
+            if (ret != HG_SUCCESS) {
+                HG_LOG_ERROR("Could not get addr string size");
+                goto done;
+            }
+            names_size += size;
+        }
+        names = (char *) malloc(names_size);
+        if (!names) {
+            HG_LOG_ERROR("Could not allocate addr names");
+            ret = HG_NOMEM_ERROR;
+            goto done;
+        }
+        name = names;
+        for (i = 0; i < count; i++) {
+            hg_size_t size = names_size - (hg_size_t) (name - names);
+
+            ret = hg_core_addr_to_string(hg_handle->hg_info.hg_class, name,
+                &size, addrs[i]);
+            if (ret != HG_SUCCESS) {
+                HG_LOG_ERROR("Could not convert addr to string");
+                goto done;
+            }
+            name += strlen(name) + 1;
+        }
+        names_size = (hg_size_t) (name - names);
+    }
+
+    multi = hg_core_multi_create(hg_handle, (char *) hg_handle->in_buf +
+        header_offset, payload_size, names, names_size,
+        flags & HG_CORE_NO_RESPONSE, (hg_uint16_t) fanout, HG_TRUE);
+    if (!multi) {
+        ret = HG_NOMEM_ERROR;
+        goto done;
+    }
+    ret = hg_core_multi_split(multi, count);
+    if (ret != HG_SUCCESS) {
+        HG_LOG_ERROR("Could not split addrs");
+        hg_core_multi_release(multi);
+        goto done;
+    }
+
+    hg_handle->request_callback = callback;
+    hg_handle->request_arg = arg;
+    hg_handle->op_type = HG_CORE_FORWARD;
+    hg_handle->ret = HG_SUCCESS;
+    hg_handle->timed_out = HG_FALSE;
+    hg_handle->no_response = (flags & HG_CORE_NO_RESPONSE) ? HG_TRUE : HG_FALSE;
+#ifdef HG_HAS_COLLECT_STATS
+    hg_time_get_current(&hg_handle->stats_forward);
+#endif
+
+    /* Handle is completed once all children are done (same as forward) */
+    hg_atomic_incr32(&hg_handle->ref_count);
+    hg_atomic_set32(&hg_handle->in_use, HG_TRUE);
+    hg_atomic_incr32(&multi->ref_count);
+    hg_handle->multi = multi;
+
+    /* Children are known, forward to them directly */
+    multi->pending += multi->child_count;
+    for (i = 0; i < multi->child_count; i++) {
+        struct hg_core_multi_child *child = &multi->children[i];
+        hg_return_t child_ret;
+
+        child_ret = hg_core_multi_forward_child(multi, addrs[child->index],
+            child);
+        if (child_ret != HG_SUCCESS) {
+            HG_LOG_ERROR("Could not forward to child");
+            hg_core_multi_done(multi, child_ret);
+        }
+    }
+    hg_core_multi_done(multi, HG_SUCCESS);
+
+done:
+    free(names);
+    return ret;
+}
+
+/*---------------------------------------------------------------------------*/
+static hg_return_t
+hg_core_respond(struct hg_handle *hg_handle, hg_cb_t callback, void *arg,
+    hg_uint8_t flags, hg_size_t payload_size, hg_uint32_t count,
+    void **buf_ptrs, const hg_size_t *buf_sizes)
+{
     hg_size_t header_size;
     hg_return_t ret = HG_SUCCESS;
 
@@ -4732,6 +8245,29 @@ HG_Core_respond(hg_handle_t handle, hg_cb_t callback, void *arg,
         goto done;
     }
 
+    /* Respond once subtree is done, with its first error if any */
+    if (hg_handle->multi) {
+        struct hg_core_multi *multi = hg_handle->multi;
+        hg_bool_t deferred = HG_FALSE;
+
+        hg_thread_spin_lock(&multi->lock);
+        if (multi->pending && count) {
+            HG_LOG_ERROR("Cannot wait for subtree with extra segments");
+            ret = HG_PROTOCOL_ERROR;
+        } else if (multi->pending) {
+            multi->respond_deferred = HG_TRUE;
+            multi->respond_callback = callback;
+            multi->respond_arg = arg;
+            multi->respond_flags = flags;
+            multi->respond_payload_size = payload_size;
+            deferred = HG_TRUE;
+        } else if (hg_handle->ret == HG_SUCCESS)
+            hg_handle->ret = multi->ret;
+        hg_thread_spin_unlock(&multi->lock);
+        if (ret != HG_SUCCESS || deferred)
+            goto done;
+    }
+
     /* Set header size */
     header_size = hg_core_header_response_get_size() +
         hg_handle->na_out_header_offset;
@@ -4744,6 +8280,15 @@ HG_Core_respond(hg_handle_t handle, hg_cb_t callback, void *arg,
         goto done;
     }
 
+    /* Set extra segments */
+    ret = hg_core_set_iov(hg_handle, &hg_handle->out_iov, hg_handle->out_buf,
+        hg_handle->out_buf_size, &hg_handle->out_buf_used, count, buf_ptrs,
+        buf_sizes);
+    if (ret != HG_SUCCESS) {
+        HG_LOG_ERROR("Could not set extra output segments");
+        goto done;
+    }
+
     /* Set callback, keep request and response callbacks separate so that
      * they do not get overwritten when forwarding to ourself */
     hg_handle->response_callback = callback;
@@ -4753,6 +8298,8 @@ HG_Core_respond(hg_handle_t handle, hg_cb_t callback, void *arg,
     hg_handle->out_header.msg.response.ret_code = hg_handle->ret;
     hg_handle->out_header.msg.response.flags = flags;
     hg_handle->out_header.msg.response.cookie = hg_handle->cookie;
+    hg_handle->out_header.msg.response.credits =
+        hg_core_credits_grant(hg_handle);
 
     /* Encode response header */
     ret = hg_core_proc_header_response(hg_handle, &hg_handle->out_header,
@@ -4762,9 +8309,23 @@ HG_Core_respond(hg_handle_t handle, hg_cb_t callback, void *arg,
         goto done;
     }
 
+    HG_TRACE(HG_TRACE_RESPOND, hg_handle, hg_handle->hg_info.id,
+        hg_handle->ret);
+#ifdef HG_HAS_COLLECT_STATS
+    {
+        hg_time_t now;
+
+        hg_time_get_current(&now);
+        HG_CORE_STATS_INCR(hg_handle, HG_STATS_RESPOND);
+        HG_CORE_STATS_RECORD(hg_handle, HG_STATS_HANDLER_TIME,
+            hg_handle->stats_process, now);
+    }
+#endif
+
     /* If addr is self, forward locally, otherwise send the encoded buffer
      * through NA and pre-post response */
     ret = hg_handle->respond(hg_handle);
+    hg_handle->out_iov.count = 0;
     if (ret != HG_SUCCESS) {
         HG_LOG_ERROR("Could not respond");
         goto done;
@@ -4774,10 +8335,45 @@ done:
     return ret;
 }
 
+/*---------------------------------------------------------------------------*/
+hg_return_t
+HG_Core_respond(hg_handle_t handle, hg_cb_t callback, void *arg,
+    hg_uint8_t flags, hg_size_t payload_size)
+{
+    return hg_core_respond((struct hg_handle *) handle, callback, arg, flags,
+        payload_size, 0, NULL, NULL);
+}
+
+/*---------------------------------------------------------------------------*/
+hg_return_t
+HG_Core_respond_iov(hg_handle_t handle, hg_cb_t callback, void *arg,
+    hg_uint8_t flags, hg_size_t payload_size, hg_uint32_t count,
+    void **buf_ptrs, const hg_size_t *buf_sizes)
+{
+    hg_return_t ret = HG_SUCCESS;
+
+    if (count && (!buf_ptrs || !buf_sizes)) {
+        HG_LOG_ERROR("NULL segments");
+        ret = HG_INVALID_PARAM;
+        goto done;
+    }
+
+    ret = hg_core_respond((struct hg_handle *) handle, callback, arg, flags,
+        payload_size, count, buf_ptrs, buf_sizes);
+
+done:
+    return ret;
+}
+
 /*---------------------------------------------------------------------------*/
 hg_return_t
 HG_Core_progress(hg_context_t *context, unsigned int timeout)
 {
+#ifdef HG_HAS_COLLECT_STATS
+    hg_time_t t1, t2;
+    hg_util_int64_t elapsed;
+#endif
+    unsigned int remaining = timeout;
     hg_return_t ret = HG_SUCCESS;
 
     if (!context) {
@@ -4786,12 +8382,52 @@ HG_Core_progress(hg_context_t *context, unsigned int timeout)
         goto done;
     }
 
-    /* Make progress on the HG layer */
-    ret = context->progress(context, timeout);
-    if (ret != HG_SUCCESS && ret != HG_TIMEOUT) {
-        HG_LOG_ERROR("Could not make progress");
-        goto done;
+#ifdef HG_HAS_COLLECT_STATS
+    hg_time_get_current(&t1);
+#endif
+
+    for (;;) {
+        unsigned int slice = remaining;
+
+        /* Send coalesced forwards whose window has elapsed */
+        hg_core_batch_flush(context, HG_FALSE);
+
+        /* Wake up at each tick to expire deadlines while forwards are timed */
+        if (hg_atomic_get32(&context->timer_wheel.count)
+            && slice > HG_CORE_TIMER_TICK
+            && context->hg_class->progress_mode != NA_NO_BLOCK)
+            slice = HG_CORE_TIMER_TICK;
+
+        /* Do not block past the window of pending batches */
+        if (!HG_LIST_IS_EMPTY(&context->batch_list)
+            && slice > context->batch_window)
+            slice = context->batch_window;
+
+        /* Make progress on the HG layer */
+        ret = context->progress(context, slice);
+        if (ret != HG_SUCCESS && ret != HG_TIMEOUT) {
+            HG_LOG_ERROR("Could not make progress");
+            goto done;
+        }
+
+        /* Cancel forwards whose deadline is reached */
+        hg_core_timer_expire(context);
+
+        if (ret == HG_SUCCESS || slice == remaining)
+            break;
+        remaining -= slice;
+    }
+
+#ifdef HG_HAS_COLLECT_STATS
+    hg_time_get_current(&t2);
+    elapsed = (hg_util_int64_t) HG_STATS_USEC(t1, t2);
+    hg_atomic_incr64(&context->acct.progress_count);
+    hg_atomic_add64(&context->acct.progress_time, elapsed);
+    if (ret == HG_TIMEOUT) {
+        hg_atomic_incr64(&context->acct.empty_count);
+        hg_atomic_add64(&context->acct.empty_time, elapsed);
     }
+#endif
 
 done:
     return ret;
@@ -4820,6 +8456,95 @@ done:
     return ret;
 }
 
+/*---------------------------------------------------------------------------*/
+hg_return_t
+HG_Core_progress_stats_get(hg_context_t *context,
+    struct hg_progress_stats *stats)
+{
+#ifdef HG_HAS_COLLECT_STATS
+    struct hg_poll_stats poll_stats = {0, 0};
+    hg_uint64_t wait_time_base;
+#endif
+    hg_return_t ret = HG_SUCCESS;
+
+    if (!context) {
+        HG_LOG_ERROR("NULL HG context");
+        ret = HG_INVALID_PARAM;
+        goto done;
+    }
+    if (!stats) {
+        HG_LOG_ERROR("NULL pointer to stats");
+        ret = HG_INVALID_PARAM;
+        goto done;
+    }
+
+#ifdef HG_HAS_COLLECT_STATS
+    memset(stats, 0, sizeof(*stats));
+    stats->progress_count =
+        (hg_uint64_t) hg_atomic_get64(&context->acct.progress_count);
+    stats->empty_count =
+        (hg_uint64_t) hg_atomic_get64(&context->acct.empty_count);
+    stats->progress_time =
+        (hg_uint64_t) hg_atomic_get64(&context->acct.progress_time);
+    stats->empty_time =
+        (hg_uint64_t) hg_atomic_get64(&context->acct.empty_time);
+    stats->trigger_count =
+        (hg_uint64_t) hg_atomic_get64(&context->acct.trigger_count);
+    stats->trigger_time =
+        (hg_uint64_t) hg_atomic_get64(&context->acct.trigger_time);
+    stats->batch_count =
+        (hg_uint64_t) hg_atomic_get64(&context->acct.batch_count);
+    stats->batch_rpc_count =
+        (hg_uint64_t) hg_atomic_get64(&context->acct.batch_rpc_count);
+    stats->header_reuse_count =
+        (hg_uint64_t) hg_atomic_get64(&context->acct.header_reuse_count);
+
+    /* Time blocked on the context poll set */
+    hg_poll_get_stats(context->poll_set, &poll_stats);
+    wait_time_base =
+        (hg_uint64_t) hg_atomic_get64(&context->acct.wait_time_base);
+    if (poll_stats.wait_time > wait_time_base)
+        stats->wait_time = poll_stats.wait_time - wait_time_base;
+
+    hg_core_progress_acct_add_na(context->hg_class->na_class,
+        context->na_context, stats);
+#ifdef HG_HAS_SM_ROUTING
+    if (context->na_sm_context)
+        hg_core_progress_acct_add_na(context->hg_class->na_sm_class,
+            context->na_sm_context, stats);
+#endif
+#else
+    HG_LOG_ERROR("Stats collection was not enabled");
+    ret = HG_INVALID_PARAM;
+#endif
+
+done:
+    return ret;
+}
+
+/*---------------------------------------------------------------------------*/
+hg_return_t
+HG_Core_progress_stats_reset(hg_context_t *context)
+{
+    hg_return_t ret = HG_SUCCESS;
+
+    if (!context) {
+        HG_LOG_ERROR("NULL HG context");
+        ret = HG_INVALID_PARAM;
+        goto done;
+    }
+
+#ifdef HG_HAS_COLLECT_STATS
+    hg_core_progress_acct_reset(context);
+#else
+    HG_LOG_ERROR("Stats collection was not enabled");
+    ret = HG_INVALID_PARAM;
+#endif
+
+done:
+    return ret;
+}
+
 /*---------------------------------------------------------------------------*/
 hg_return_t
 HG_Core_cancel(hg_handle_t handle)
@@ -311,6 +311,72 @@ HG_Core_context_set_data(
         void (*free_callback)(void *)
         );
 
+/**
+ * Run RPC callbacks of handles received on context on thread_count handler
+ * threads instead of the thread calling HG_Core_trigger(), so that a slow
+ * RPC callback does not delay progress and other RPCs. Handler threads keep
+ * one queue per thread and steal queued RPCs from each other when idle.
+ * Completion callbacks of origin operations are still run by
+ * HG_Core_trigger(). Passing 0 (default) runs all callbacks inline. RPC
+ * callbacks already posted are run before previous handler threads exit.
+ * May be called while other threads make progress, but not from an RPC
+ * callback run by a handler thread. See also
+ * HG_Core_registered_handler_hints().
+ *
+ * \param context [IN]          pointer to HG context
+ * \param thread_count [IN]     number of handler threads
+ *
+ * \return HG_SUCCESS or corresponding HG error code
+ */
+HG_EXPORT hg_return_t
+HG_Core_context_set_handler_threads(
+        hg_context_t *context,
+        unsigned int thread_count
+        );
+
+/**
+ * Coalesce small forwards issued on context to the same target into a single
+ * message. A forward is held for up to window ms (or until the next
+ * HG_Core_progress() call if window is 0) so that other forwards to that
+ * target can be packed with it, the message is sent earlier if it reaches the
+ * max unexpected size. Targets split the message back into one handle per
+ * forward, each forward gets its own response. Forwards with extra data or
+ * segments are never coalesced. Disabled by default.
+ *
+ * \param context [IN]          pointer to HG context
+ * \param enable [IN]           boolean
+ * \param window [IN]           max time forwards are held (in milliseconds)
+ *
+ * \return HG_SUCCESS or corresponding HG error code
+ */
+HG_EXPORT hg_return_t
+HG_Core_context_set_coalescing(
+        hg_context_t *context,
+        hg_bool_t enable,
+        unsigned int window
+        );
+
+/**
+ * Limit the number of received RPCs of a given priority class that may wait
+ * on context to be run. RPCs received beyond that limit are not run but
+ * answered right away with HG_BUSY (or dropped if they expect no response),
+ * so that origins can back off instead of getting a late answer.
+ * HG_HANDLER_HIGH RPCs form one class, HG_HANDLER_NORMAL and
+ * HG_HANDLER_INLINE RPCs the other. Passing 0 (default) removes the limit.
+ *
+ * \param context [IN]          pointer to HG context
+ * \param priority [IN]         handler priority of RPCs to limit
+ * \param limit [IN]            max number of RPCs waiting to be run
+ *
+ * \return HG_SUCCESS or corresponding HG error code
+ */
+HG_EXPORT hg_return_t
+HG_Core_context_set_queue_limit(
+        hg_context_t *context,
+        hg_handler_priority_t priority,
+        unsigned int limit
+        );
+
 /**
  * Retrieve previously associated data from a given context.
  *
@@ -394,6 +460,32 @@ HG_Core_register_data(
         void (*free_callback)(void *)
         );
 
+/**
+ * Set handler hints for a given RPC ID. HG_HANDLER_HIGH RPCs are run before
+ * queued HG_HANDLER_NORMAL RPCs, by HG_Core_trigger() as well as by handler
+ * threads if the context has any (see HG_Core_context_set_handler_threads()),
+ * HG_HANDLER_INLINE RPCs are run by the thread calling HG_Core_trigger().
+ * See also HG_Core_context_set_queue_limit(). affinity selects the handler
+ * thread (modulo the number of threads) that RPCs are queued to, so that RPCs
+ * sharing state can be run by the same thread; idle threads may still steal
+ * them. By default, RPCs have HG_HANDLER_NORMAL priority and
+ * HG_HANDLER_ANY_THREAD affinity.
+ *
+ * \param hg_class [IN]         pointer to HG class
+ * \param id [IN]               registered function ID
+ * \param priority [IN]         handler priority
+ * \param affinity [IN]         handler thread index or HG_HANDLER_ANY_THREAD
+ *
+ * \return HG_SUCCESS or corresponding HG error code
+ */
+HG_EXPORT hg_return_t
+HG_Core_registered_handler_hints(
+        hg_class_t *hg_class,
+        hg_id_t id,
+        hg_handler_priority_t priority,
+        unsigned int affinity
+        );
+
 /**
  * Indicate whether HG_Core_register_data() has been called and return
  * associated data.
@@ -409,10 +501,68 @@ HG_Core_registered_data(
         hg_id_t id
         );
 
+/**
+ * Get stats collected for a given context and RPC ID. Passing a NULL context
+ * merges stats of all the contexts of the class (including destroyed ones),
+ * passing HG_STATS_ANY merges stats of all RPC IDs (including bulk transfers).
+ * Stats are collected in per-thread shards that are merged on each call.
+ * Requires mercury to be built with MERCURY_ENABLE_STATS, HG_INVALID_PARAM is
+ * returned otherwise.
+ *
+ * \param hg_class [IN]         pointer to HG class
+ * \param context [IN]          pointer to HG context
+ * \param id [IN]               registered function ID
+ * \param stats [OUT]           pointer to returned stats
+ *
+ * \return HG_SUCCESS or corresponding HG error code
+ */
+HG_EXPORT hg_return_t
+HG_Core_stats_get(
+        hg_class_t *hg_class,
+        hg_context_t *context,
+        hg_id_t id,
+        struct hg_stats *stats
+        );
+
+/**
+ * Reset stats collected for a given context and RPC ID. NULL context and
+ * HG_STATS_ANY can be passed as for HG_Core_stats_get().
+ *
+ * \param hg_class [IN]         pointer to HG class
+ * \param context [IN]          pointer to HG context
+ * \param id [IN]               registered function ID
+ *
+ * \return HG_SUCCESS or corresponding HG error code
+ */
+HG_EXPORT hg_return_t
+HG_Core_stats_reset(
+        hg_class_t *hg_class,
+        hg_context_t *context,
+        hg_id_t id
+        );
+
+/**
+ * Dump events recorded by all threads to file, see HG_Trace_dump(). Requires
+ * mercury to be built with MERCURY_ENABLE_TRACE, HG_INVALID_PARAM is returned
+ * otherwise.
+ *
+ * \param filename [IN]         file name
+ *
+ * \return HG_SUCCESS or corresponding HG error code
+ */
+HG_EXPORT hg_return_t
+HG_Core_trace_dump(
+        const char *filename
+        );
+
 /**
  * Lookup an addr from a peer address/name. Addresses need to be
  * freed by calling HG_Core_addr_free(). After completion, user callback is
  * placed into a completion queue and can be triggered using HG_Core_trigger().
+ * If the class was initialized with addr_cache set, lookups of a name that
+ * was already resolved return the same (reference counted) addr, concurrent
+ * lookups of the same name are completed by a single lookup, and failed
+ * lookups keep failing with the same error for addr_cache_neg_ttl ms.
  *
  * \param context [IN]          pointer to context of execution
  * \param callback [IN]         pointer to function callback
@@ -431,6 +581,35 @@ HG_Core_addr_lookup(
         hg_op_id_t   *op_id
         );
 
+/**
+ * Lookup count addrs at once. All the lookups are started before progress is
+ * made so that connection setup with each peer proceeds concurrently, and a
+ * single user callback is placed into the completion queue once all of them
+ * have completed. On completion addrs[i] holds the addr of names[i] or
+ * HG_ADDR_NULL if that lookup failed, in which case the callback's ret
+ * is set to the first error encountered. Addrs need to be freed by calling
+ * HG_Core_addr_free(). The addrs array must remain valid until the callback
+ * is triggered, the addr passed to the callback is HG_ADDR_NULL.
+ *
+ * \param context [IN]          pointer to context of execution
+ * \param callback [IN]         pointer to function callback
+ * \param arg [IN]              pointer to data passed to callback
+ * \param names [IN]            array of lookup names
+ * \param count [IN]            number of names
+ * \param addrs [OUT]           array of count returned addrs
+ *
+ * \return HG_SUCCESS or corresponding HG error code
+ */
+HG_EXPORT hg_return_t
+HG_Core_addr_lookup_batch(
+        hg_context_t      *context,
+        hg_cb_t            callback,
+        void              *arg,
+        const char *const  names[],
+        unsigned int       count,
+        hg_addr_t          addrs[]
+        );
+
 /**
  * Free the addr from the list of peers.
  *
@@ -445,6 +624,23 @@ HG_Core_addr_free(
         hg_addr_t   addr
         );
 
+/**
+ * Remove name from the addr cache so that the next HG_Core_addr_lookup() of
+ * name issues a new lookup, passing NULL removes all the entries. Addrs that
+ * were already returned remain valid until freed. Does nothing if the addr
+ * cache is not enabled.
+ *
+ * \param hg_class [IN]         pointer to HG class
+ * \param name [IN]             lookup name
+ *
+ * \return HG_SUCCESS or corresponding HG error code
+ */
+HG_EXPORT hg_return_t
+HG_Core_addr_cache_invalidate(
+        hg_class_t *hg_class,
+        const char *name
+        );
+
 /**
  * Obtain the underlying NA address from an HG address.
  *
@@ -576,6 +772,22 @@ HG_Core_reset(
         hg_id_t id
         );
 
+/**
+ * Prepare an HG handle for repeated forwards of the same RPC. The request
+ * header is encoded by the next forward and kept in the handle's buffer, so
+ * that following forwards with the same flags only need the payload to be
+ * encoded. The handle remains prepared after HG_Core_reset(), changing its
+ * RPC ID or target ID causes the header to be encoded again.
+ *
+ * \param handle [IN]           HG handle
+ *
+ * \return HG_SUCCESS or corresponding HG error code
+ */
+HG_EXPORT hg_return_t
+HG_Core_prepare(
+        hg_handle_t handle
+        );
+
 /**
  * Increment ref count on handle.
  *
@@ -689,7 +901,9 @@ HG_Core_get_output(
  * than the queried input buffer size.
  * After completion, the handle must be freed using HG_Core_destroy(), the user
  * callback is placed into a completion queue and can be triggered using
- * HG_Core_trigger().
+ * HG_Core_trigger(). The call is queued locally if the target address has no
+ * credits left, i.e., if it did not grant more calls in flight in its last
+ * response.
  *
  * \param handle [IN]           HG handle
  * \param callback [IN]         pointer to function callback
@@ -707,6 +921,98 @@ HG_Core_forward(
         hg_size_t payload_size
         );
 
+/**
+ * Forward a call using an existing HG handle, see HG_Core_forward(). If no
+ * response was received after timeout ms, operations are canceled and the
+ * user callback is triggered with HG_TIMEOUT. Deadlines are checked during
+ * HG_Core_progress() with a resolution of a few ms. A timeout of 0 is
+ * equivalent to HG_Core_forward(). Forwards to self are not timed.
+ *
+ * \param handle [IN]           HG handle
+ * \param callback [IN]         pointer to function callback
+ * \param arg [IN]              pointer to data passed to callback
+ * \param flags [IN]            flags
+ * \param payload_size [IN]     size of payload to send
+ * \param timeout [IN]          timeout (in milliseconds)
+ *
+ * \return HG_SUCCESS or corresponding HG error code
+ */
+HG_EXPORT hg_return_t
+HG_Core_forward_timed(
+        hg_handle_t handle,
+        hg_cb_t callback,
+        void *arg,
+        hg_uint8_t flags,
+        hg_size_t payload_size,
+        unsigned int timeout
+        );
+
+/**
+ * Forward a call using an existing HG handle, see HG_Core_forward(). The count
+ * buffers described by buf_ptrs and buf_sizes are sent after the payload
+ * without being copied into the input buffer when the NA plugin supports it,
+ * they must remain valid until the user callback is triggered. The total size
+ * must not exceed the input buffer size.
+ *
+ * \param handle [IN]           HG handle
+ * \param callback [IN]         pointer to function callback
+ * \param arg [IN]              pointer to data passed to callback
+ * \param flags [IN]            flags
+ * \param payload_size [IN]     size of payload to send
+ * \param count [IN]            number of extra segments
+ * \param buf_ptrs [IN]         array of pointers
+ * \param buf_sizes [IN]        array of sizes
+ *
+ * \return HG_SUCCESS or corresponding HG error code
+ */
+HG_EXPORT hg_return_t
+HG_Core_forward_iov(
+        hg_handle_t handle,
+        hg_cb_t callback,
+        void *arg,
+        hg_uint8_t flags,
+        hg_size_t payload_size,
+        hg_uint32_t count,
+        void **buf_ptrs,
+        const hg_size_t *buf_sizes
+        );
+
+/**
+ * Forward the payload encoded in the input buffer of handle to count addrs,
+ * the addr of handle is not used. The payload is copied to each target
+ * without being encoded again. If fanout is 0 or not less than count, the
+ * payload is sent to every addr, otherwise it is only sent to fanout addrs
+ * and each of them forwards it again to the part of the remaining addrs that
+ * is its subtree (k-ary tree) before running the RPC; the addr names of a
+ * subtree are sent along with the payload and must fit into the input buffer.
+ * A target responds once its subtree has responded. The user callback is
+ * triggered once on handle after all targets are done, with the first error
+ * returned by any of them; no output is available on handle.
+ * HG_CORE_MORE_DATA cannot be set and the call cannot be canceled.
+ *
+ * \param handle [IN]           HG handle
+ * \param callback [IN]         pointer to function callback
+ * \param arg [IN]              pointer to data passed to callback
+ * \param flags [IN]            flags
+ * \param payload_size [IN]     size of payload to send
+ * \param addrs [IN]            array of target addrs
+ * \param count [IN]            number of addrs
+ * \param fanout [IN]           number of children per node (0 if flat)
+ *
+ * \return HG_SUCCESS or corresponding HG error code
+ */
+HG_EXPORT hg_return_t
+HG_Core_forward_multi(
+        hg_handle_t handle,
+        hg_cb_t callback,
+        void *arg,
+        hg_uint8_t flags,
+        hg_size_t payload_size,
+        hg_addr_t *addrs,
+        unsigned int count,
+        unsigned int fanout
+        );
+
 /**
  * Respond back to the origin. The output buffer, which can be used to encode
  * the response, must first be queried using HG_Core_get_output().
@@ -729,6 +1035,36 @@ HG_Core_respond(
         hg_size_t payload_size
         );
 
+/**
+ * Respond back to the origin, see HG_Core_respond(). The count buffers
+ * described by buf_ptrs and buf_sizes are sent after the payload without
+ * being copied into the output buffer when the NA plugin supports it, they
+ * must remain valid until the user callback is triggered. The total size must
+ * not exceed the output buffer size.
+ *
+ * \param handle [IN]           HG handle
+ * \param callback [IN]         pointer to function callback
+ * \param arg [IN]              pointer to data passed to callback
+ * \param flags [IN]            flags
+ * \param payload_size [IN]     size of payload to send
+ * \param count [IN]            number of extra segments
+ * \param buf_ptrs [IN]         array of pointers
+ * \param buf_sizes [IN]        array of sizes
+ *
+ * \return HG_SUCCESS or corresponding HG error code
+ */
+HG_EXPORT hg_return_t
+HG_Core_respond_iov(
+        hg_handle_t handle,
+        hg_cb_t callback,
+        void *arg,
+        hg_uint8_t flags,
+        hg_size_t payload_size,
+        hg_uint32_t count,
+        void **buf_ptrs,
+        const hg_size_t *buf_sizes
+        );
+
 /**
  * Try to progress RPC execution for at most timeout until timeout is reached or
  * any completion has occurred.
@@ -767,6 +1103,38 @@ HG_Core_trigger(
         unsigned int *actual_count
         );
 
+/**
+ * Get progress accounting of a context, to tell whether progress threads are
+ * saturated or spinning: number of and time spent in HG_Core_progress() calls, and
+ * how much of that was spent in calls that did not progress anything, time
+ * blocked in system poll calls (e.g., epoll_wait()), in NA plugin progress and
+ * in NA callbacks, and number of and time spent in callbacks executed by
+ * HG_Core_trigger(). Requires mercury to be built with MERCURY_ENABLE_STATS,
+ * HG_INVALID_PARAM is returned otherwise.
+ *
+ * \param context [IN]          pointer to HG context
+ * \param stats [OUT]           pointer to returned stats
+ *
+ * \return HG_SUCCESS or corresponding HG error code
+ */
+HG_EXPORT hg_return_t
+HG_Core_progress_stats_get(
+        hg_context_t *context,
+        struct hg_progress_stats *stats
+        );
+
+/**
+ * Reset progress accounting of a context.
+ *
+ * \param context [IN]          pointer to HG context
+ *
+ * \return HG_SUCCESS or corresponding HG error code
+ */
+HG_EXPORT hg_return_t
+HG_Core_progress_stats_reset(
+        hg_context_t *context
+        );
+
 /**
  * Cancel an ongoing operation.
  *
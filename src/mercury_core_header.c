@@ -230,8 +230,11 @@ hg_core_header_response_proc(hg_proc_op_t op, void *buf, size_t buf_size,
     /* Flags */
     HG_CORE_HEADER_PROC(hg_core_header, buf_ptr, header->flags, op);
 
-    /* Convert cookie to network byte order */
-    HG_CORE_HEADER_PROC16(hg_core_header, buf_ptr, header->cookie, op, tmp);
+    /* Cookie */
+    HG_CORE_HEADER_PROC(hg_core_header, buf_ptr, header->cookie, op);
+
+    /* Credits */
+    HG_CORE_HEADER_PROC(hg_core_header, buf_ptr, header->credits, op);
 
 #ifdef HG_HAS_CHECKSUMS
     /* Checksum of header */
@@ -256,6 +259,108 @@ done:
     return ret;
 }
 
+/*---------------------------------------------------------------------------*/
+hg_return_t
+hg_core_header_batch_proc(hg_proc_op_t op, void *buf, size_t buf_size,
+    struct hg_core_header_batch *header)
+{
+    void *buf_ptr = buf;
+    hg_uint16_t n_count;
+    hg_return_t ret = HG_SUCCESS;
+
+    if (buf_size < sizeof(struct hg_core_header_batch)) {
+        HG_LOG_ERROR("Invalid buffer size");
+        ret = HG_SIZE_ERROR;
+        goto done;
+    }
+
+    if (op == HG_ENCODE) {
+        header->hg = HG_CORE_BATCH_IDENTIFIER;
+        header->protocol = HG_CORE_PROTOCOL_VERSION;
+        n_count = htons(header->count);
+    }
+    buf_ptr = hg_proc_buf_memcpy(buf_ptr, &header->hg, sizeof(header->hg), op);
+    buf_ptr = hg_proc_buf_memcpy(buf_ptr, &header->protocol,
+        sizeof(header->protocol), op);
+    buf_ptr = hg_proc_buf_memcpy(buf_ptr, &n_count, sizeof(n_count), op);
+    if (op == HG_DECODE) {
+        header->count = ntohs(n_count);
+        if (header->hg != HG_CORE_BATCH_IDENTIFIER
+            || header->protocol != HG_CORE_PROTOCOL_VERSION) {
+            HG_LOG_ERROR("Invalid batch header");
+            ret = HG_NO_MATCH;
+            goto done;
+        }
+    }
+
+done:
+    return ret;
+}
+
+/*---------------------------------------------------------------------------*/
+hg_return_t
+hg_core_header_batch_entry_proc(hg_proc_op_t op, void *buf, size_t buf_size,
+    struct hg_core_header_batch_entry *entry)
+{
+    void *buf_ptr = buf;
+    hg_uint32_t n_tag, n_size;
+    hg_return_t ret = HG_SUCCESS;
+
+    if (buf_size < sizeof(struct hg_core_header_batch_entry)) {
+        HG_LOG_ERROR("Invalid buffer size");
+        ret = HG_SIZE_ERROR;
+        goto done;
+    }
+
+    if (op == HG_ENCODE) {
+        n_tag = htonl(entry->tag);
+        n_size = htonl(entry->size);
+    }
+    buf_ptr = hg_proc_buf_memcpy(buf_ptr, &n_tag, sizeof(n_tag), op);
+    buf_ptr = hg_proc_buf_memcpy(buf_ptr, &n_size, sizeof(n_size), op);
+    if (op == HG_DECODE) {
+        entry->tag = ntohl(n_tag);
+        entry->size = ntohl(n_size);
+    }
+
+done:
+    return ret;
+}
+
+/*---------------------------------------------------------------------------*/
+hg_return_t
+hg_core_header_tree_proc(hg_proc_op_t op, void *buf, size_t buf_size,
+    struct hg_core_header_tree *header)
+{
+    void *buf_ptr = buf;
+    hg_uint32_t n_size;
+    hg_uint16_t n_count, n_fanout;
+    hg_return_t ret = HG_SUCCESS;
+
+    if (buf_size < sizeof(struct hg_core_header_tree)) {
+        HG_LOG_ERROR("Invalid buffer size");
+        ret = HG_SIZE_ERROR;
+        goto done;
+    }
+
+    if (op == HG_ENCODE) {
+        n_size = htonl(header->size);
+        n_count = htons(header->count);
+        n_fanout = htons(header->fanout);
+    }
+    buf_ptr = hg_proc_buf_memcpy(buf_ptr, &n_size, sizeof(n_size), op);
+    buf_ptr = hg_proc_buf_memcpy(buf_ptr, &n_count, sizeof(n_count), op);
+    buf_ptr = hg_proc_buf_memcpy(buf_ptr, &n_fanout, sizeof(n_fanout), op);
+    if (op == HG_DECODE) {
+        header->size = ntohl(n_size);
+        header->count = ntohs(n_count);
+        header->fanout = ntohs(n_fanout);
+    }
+
+done:
+    return ret;
+}
+
 /*---------------------------------------------------------------------------*/
 hg_return_t
 hg_core_header_request_verify(const struct hg_core_header *hg_core_header)
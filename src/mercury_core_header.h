@@ -49,12 +49,32 @@ struct hg_core_header_request {
 struct hg_core_header_response {
     hg_int8_t   ret_code;       /* Return code */
     hg_uint8_t  flags;          /* Flags */
-    hg_uint16_t cookie;         /* Cookie */
+    hg_uint8_t  cookie;         /* Cookie */
+    hg_uint8_t  credits;        /* Forwards origin may have in flight */
 #ifdef HG_HAS_CHECKSUMS
     union hg_core_header_hash hash; /* Hash */
 #endif
     /* 64/32 bits here */
 };
+
+/* Requests coalesced into one message, each request is preceded by an entry */
+struct hg_core_header_batch {
+    hg_uint8_t  hg;             /* Mercury batch identifier */
+    hg_uint8_t  protocol;       /* Version number */
+    hg_uint16_t count;          /* Number of requests */
+};
+
+struct hg_core_header_batch_entry {
+    hg_uint32_t tag;            /* Tag to respond with */
+    hg_uint32_t size;           /* Size of request */
+};
+
+/* Subtree of a multi forward, placed at the end of the request */
+struct hg_core_header_tree {
+    hg_uint32_t size;           /* Size of addr names preceding header */
+    hg_uint16_t count;          /* Number of addrs in subtree */
+    hg_uint16_t fanout;         /* Number of children per node */
+};
 #if defined(__GNUC__) || defined(_WIN32)
 # pragma pack(pop)
 #endif
@@ -81,7 +101,14 @@ struct hg_core_header {
  * mercury byte / protocol version number / rpc id / flags / cookie / checksum
  *
  * Response:
- * flags / return code / cookie / checksum
+ * flags / return code / cookie / credits / checksum
+ *
+ * Batch:
+ * mercury batch byte / protocol version number / count, followed for each
+ * request by: tag / size / request
+ *
+ * Tree (end of request if HG_CORE_TREE_FORWARD is set):
+ * addr names of subtree / size of names / count / fanout
  */
 
 /*****************/
@@ -90,12 +117,14 @@ struct hg_core_header {
 
 /* Mercury identifier for packets sent */
 #define HG_CORE_IDENTIFIER (('H' << 1) | ('G')) /* 0xD7 */
+#define HG_CORE_BATCH_IDENTIFIER (('H' << 1) | ('B')) /* 0xD2 */
 
 /* Mercury protocol version number */
-#define HG_CORE_PROTOCOL_VERSION 0x03
+#define HG_CORE_PROTOCOL_VERSION 0x04
 
 /* Flags */
 #define HG_CORE_SELF_FORWARD 0x80   /* Forward to self */
+#define HG_CORE_TREE_FORWARD 0x40   /* Forward again to subtree */
 
 /*********************/
 /* Public Prototypes */
@@ -107,6 +136,10 @@ extern "C" {
 
 static HG_INLINE size_t hg_core_header_request_get_size(void);
 static HG_INLINE size_t hg_core_header_response_get_size(void);
+static HG_INLINE size_t hg_core_header_batch_get_size(void);
+static HG_INLINE size_t hg_core_header_batch_entry_get_size(void);
+static HG_INLINE hg_bool_t hg_core_header_is_batch(const void *buf);
+static HG_INLINE size_t hg_core_header_tree_get_size(void);
 
 /**
  * Get size reserved for request header (separate user data stored in payload).
@@ -130,6 +163,53 @@ hg_core_header_response_get_size(void)
     return sizeof(struct hg_core_header_response);
 }
 
+/**
+ * Get size of batch header.
+ *
+ * \return Non-negative size value
+ */
+static HG_INLINE size_t
+hg_core_header_batch_get_size(void)
+{
+    return sizeof(struct hg_core_header_batch);
+}
+
+/**
+ * Get size of header preceding each request of a batch.
+ *
+ * \return Non-negative size value
+ */
+static HG_INLINE size_t
+hg_core_header_batch_entry_get_size(void)
+{
+    return sizeof(struct hg_core_header_batch_entry);
+}
+
+/**
+ * Check whether buffer starts with a batch header rather than a request
+ * header.
+ *
+ * \param buf [IN]              buffer
+ *
+ * \return HG_TRUE if buffer contains a batch
+ */
+static HG_INLINE hg_bool_t
+hg_core_header_is_batch(const void *buf)
+{
+    return (*(const hg_uint8_t *) buf == HG_CORE_BATCH_IDENTIFIER);
+}
+
+/**
+ * Get size of header ending a request forwarded to a subtree.
+ *
+ * \return Non-negative size value
+ */
+static HG_INLINE size_t
+hg_core_header_tree_get_size(void)
+{
+    return sizeof(struct hg_core_header_tree);
+}
+
 /**
  * Initialize RPC request header.
  *
@@ -233,6 +313,61 @@ hg_core_header_response_proc(
         struct hg_core_header *hg_core_header
         );
 
+/**
+ * Process header of a batch of requests. Identifier and protocol version are
+ * verified when decoding.
+ *
+ * \param op [IN]               operation type: HG_ENCODE / HG_DECODE
+ * \param buf [IN/OUT]          buffer
+ * \param buf_size [IN]         buffer size
+ * \param header [IN/OUT]       pointer to batch header structure
+ *
+ * \return HG_SUCCESS or corresponding HG error code
+ */
+HG_EXPORT hg_return_t
+hg_core_header_batch_proc(
+        hg_proc_op_t op,
+        void *buf,
+        size_t buf_size,
+        struct hg_core_header_batch *header
+        );
+
+/**
+ * Process header preceding a request in a batch.
+ *
+ * \param op [IN]               operation type: HG_ENCODE / HG_DECODE
+ * \param buf [IN/OUT]          buffer
+ * \param buf_size [IN]         buffer size
+ * \param entry [IN/OUT]        pointer to entry header structure
+ *
+ * \return HG_SUCCESS or corresponding HG error code
+ */
+HG_EXPORT hg_return_t
+hg_core_header_batch_entry_proc(
+        hg_proc_op_t op,
+        void *buf,
+        size_t buf_size,
+        struct hg_core_header_batch_entry *entry
+        );
+
+/**
+ * Process header ending a request forwarded to a subtree.
+ *
+ * \param op [IN]               operation type: HG_ENCODE / HG_DECODE
+ * \param buf [IN/OUT]          buffer
+ * \param buf_size [IN]         buffer size
+ * \param header [IN/OUT]       pointer to tree header structure
+ *
+ * \return HG_SUCCESS or corresponding HG error code
+ */
+HG_EXPORT hg_return_t
+hg_core_header_tree_proc(
+        hg_proc_op_t op,
+        void *buf,
+        size_t buf_size,
+        struct hg_core_header_tree *header
+        );
+
 /**
  * Verify private information from request header.
  *
@@ -48,7 +48,7 @@ struct hg_header_output {
 #ifdef HG_HAS_CHECKSUMS
     struct hg_header_hash hash; /* Hash */
 #endif
-    hg_uint32_t pad;
+    hg_uint32_t eager_offset;   /* Offset of eager push data (0 if none) */
     /* 128/64 bits here */
 };
 #if defined(__GNUC__) || defined(_WIN32)
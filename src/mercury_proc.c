@@ -21,6 +21,9 @@
 /* Local Macros */
 /****************/
 
+/* Max size of a LEB128 encoded 64-bit integer */
+#define HG_PROC_VARINT_MAX 10
+
 /************************************/
 /* Local Type and Struct Definition */
 /************************************/
@@ -39,9 +42,13 @@ struct hg_proc_buf {
 struct hg_proc {
     hg_class_t *hg_class;               /* HG class */
     hg_proc_op_t op;
+    hg_uint8_t flags;                   /* Proc flags */
     struct hg_proc_buf proc_buf;
     struct hg_proc_buf extra_buf;
     struct hg_proc_buf *current_buf;
+    hg_bulk_t *bulks;                   /* Bulk handles processed */
+    hg_uint32_t bulk_count;             /* Number of bulk handles */
+    hg_uint32_t bulk_max;               /* Size of bulk handle array */
 #ifdef HG_HAS_CHECKSUMS
     mchecksum_object_t checksum;    /* Checksum */
     void *checksum_hash;            /* Base checksum buf */
@@ -194,6 +201,10 @@ hg_proc_free(hg_proc_t proc)
     if (hg_proc->extra_buf.buf && hg_proc->extra_buf.is_mine)
         hg_mem_aligned_free(hg_proc->extra_buf.buf);
 
+    /* Release bulk handles */
+    hg_proc_clear_bulks(proc);
+    free(hg_proc->bulks);
+
     /* Free proc */
     free(hg_proc);
 
@@ -216,6 +227,7 @@ hg_proc_reset(hg_proc_t proc, void *buf, hg_size_t buf_size, hg_proc_op_t op)
         goto done;
     }
     hg_proc->op = op;
+    hg_proc->flags = 0;
 #ifdef HG_HAS_XDR
     switch (op) {
         case HG_ENCODE:
@@ -395,6 +407,43 @@ done:
     return ret;
 }
 
+/*---------------------------------------------------------------------------*/
+hg_return_t
+hg_proc_set_flags(hg_proc_t proc, hg_uint8_t flags)
+{
+    struct hg_proc *hg_proc = (struct hg_proc *) proc;
+    hg_return_t ret = HG_SUCCESS;
+
+    if (!hg_proc) {
+        HG_LOG_ERROR("Proc is not initialized");
+        ret = HG_INVALID_PARAM;
+        goto done;
+    }
+
+    hg_proc->flags = flags;
+
+done:
+    return ret;
+}
+
+/*---------------------------------------------------------------------------*/
+hg_uint8_t
+hg_proc_get_flags(hg_proc_t proc)
+{
+    struct hg_proc *hg_proc = (struct hg_proc *) proc;
+    hg_uint8_t flags = 0;
+
+    if (!hg_proc) {
+        HG_LOG_ERROR("Proc is not initialized");
+        goto done;
+    }
+
+    flags = hg_proc->flags;
+
+done:
+    return flags;
+}
+
 /*---------------------------------------------------------------------------*/
 hg_size_t
 hg_proc_get_size_left(hg_proc_t proc)
@@ -522,6 +571,78 @@ done:
     return ret;
 }
 
+/*---------------------------------------------------------------------------*/
+hg_return_t
+hg_proc_add_bulk(hg_proc_t proc, hg_bulk_t handle)
+{
+    struct hg_proc *hg_proc = (struct hg_proc *) proc;
+    hg_return_t ret = HG_SUCCESS;
+
+    if (handle == HG_BULK_NULL)
+        goto done;
+
+    if (hg_proc->bulk_count == hg_proc->bulk_max) {
+        hg_uint32_t new_max = hg_proc->bulk_max ? 2 * hg_proc->bulk_max : 4;
+        hg_bulk_t *new_bulks;
+
+        new_bulks = (hg_bulk_t *) realloc(hg_proc->bulks,
+            new_max * sizeof(hg_bulk_t));
+        if (!new_bulks) {
+            HG_LOG_ERROR("Could not reallocate bulk handle array");
+            ret = HG_NOMEM_ERROR;
+            goto done;
+        }
+        hg_proc->bulks = new_bulks;
+        hg_proc->bulk_max = new_max;
+    }
+
+    ret = HG_Bulk_ref_incr(handle);
+    if (ret != HG_SUCCESS) {
+        HG_LOG_ERROR("Could not increment bulk handle ref count");
+        goto done;
+    }
+    hg_proc->bulks[hg_proc->bulk_count++] = handle;
+
+done:
+    return ret;
+}
+
+/*---------------------------------------------------------------------------*/
+hg_uint32_t
+hg_proc_get_bulk_count(hg_proc_t proc)
+{
+    struct hg_proc *hg_proc = (struct hg_proc *) proc;
+
+    return hg_proc ? hg_proc->bulk_count : 0;
+}
+
+/*---------------------------------------------------------------------------*/
+hg_bulk_t
+hg_proc_get_bulk(hg_proc_t proc, hg_uint32_t index)
+{
+    struct hg_proc *hg_proc = (struct hg_proc *) proc;
+
+    if (!hg_proc || index >= hg_proc->bulk_count)
+        return HG_BULK_NULL;
+
+    return hg_proc->bulks[index];
+}
+
+/*---------------------------------------------------------------------------*/
+void
+hg_proc_clear_bulks(hg_proc_t proc)
+{
+    struct hg_proc *hg_proc = (struct hg_proc *) proc;
+    hg_uint32_t i;
+
+    if (!hg_proc)
+        return;
+
+    for (i = 0; i < hg_proc->bulk_count; i++)
+        HG_Bulk_free(hg_proc->bulks[i]);
+    hg_proc->bulk_count = 0;
+}
+
 /*---------------------------------------------------------------------------*/
 hg_return_t
 hg_proc_flush(hg_proc_t proc)
@@ -591,6 +712,214 @@ done:
     return ret;
 }
 
+/*---------------------------------------------------------------------------*/
+hg_return_t
+hg_proc_integer(hg_proc_t proc, void *data, hg_size_t data_size,
+    hg_bool_t is_signed)
+{
+    struct hg_proc *hg_proc = (struct hg_proc *) proc;
+    hg_uint8_t varint[HG_PROC_VARINT_MAX];
+    hg_uint8_t *buf_ptr;
+    hg_uint64_t value = 0;
+    hg_size_t len = 0;
+    unsigned int shift = 0;
+    hg_return_t ret = HG_SUCCESS;
+
+    if (!hg_proc) {
+        HG_LOG_ERROR("Proc is not initialized");
+        ret = HG_INVALID_PARAM;
+        goto done;
+    }
+
+    /* Default to memcpy if compact encoding is not requested */
+    if (!(hg_proc->flags & HG_PROC_COMPACT))
+        return hg_proc_memcpy(proc, data, data_size);
+
+    switch (hg_proc->op) {
+        case HG_ENCODE:
+            switch (data_size) {
+                case sizeof(hg_uint16_t):
+                    value = is_signed ? (hg_uint64_t) (hg_int64_t)
+                        *(hg_int16_t *) data : *(hg_uint16_t *) data;
+                    break;
+                case sizeof(hg_uint32_t):
+                    value = is_signed ? (hg_uint64_t) (hg_int64_t)
+                        *(hg_int32_t *) data : *(hg_uint32_t *) data;
+                    break;
+                case sizeof(hg_uint64_t):
+                    value = *(hg_uint64_t *) data;
+                    break;
+                default:
+                    HG_LOG_ERROR("Unsupported integer size");
+                    ret = HG_INVALID_PARAM;
+                    goto done;
+            }
+            /* Zigzag so that small negative values remain small */
+            if (is_signed)
+                value = (value << 1) ^ (hg_uint64_t) ((hg_int64_t) value >> 63);
+            do {
+                varint[len] = (hg_uint8_t) (value & 0x7f);
+                value >>= 7;
+                if (value)
+                    varint[len] |= 0x80;
+                len++;
+            } while (value);
+
+            buf_ptr = (hg_uint8_t *) hg_proc_save_ptr(proc, len);
+            if (!buf_ptr) {
+                HG_LOG_ERROR("Could not get proc buffer");
+                ret = HG_SIZE_ERROR;
+                goto done;
+            }
+            memcpy(buf_ptr, varint, len);
+            break;
+        case HG_DECODE:
+            buf_ptr = (hg_uint8_t *) hg_proc->current_buf->buf_ptr;
+            do {
+                if (len == hg_proc->current_buf->size_left
+                    || len == HG_PROC_VARINT_MAX) {
+                    HG_LOG_ERROR("Invalid or truncated varint");
+                    ret = HG_PROTOCOL_ERROR;
+                    goto done;
+                }
+                /* Last byte only holds bit 63 */
+                if (len == HG_PROC_VARINT_MAX - 1 && buf_ptr[len] > 1) {
+                    HG_LOG_ERROR("Varint exceeds 64 bits");
+                    ret = HG_PROTOCOL_ERROR;
+                    goto done;
+                }
+                value |= (hg_uint64_t) (buf_ptr[len] & 0x7f) << shift;
+                shift += 7;
+            } while (buf_ptr[len++] & 0x80);
+            hg_proc_save_ptr(proc, len);
+
+            if (is_signed)
+                value = (value >> 1) ^ (~(value & 1) + 1);
+            if (data_size < sizeof(hg_uint64_t)) {
+                /* Check that value fits into data_size */
+                hg_uint64_t max = (hg_uint64_t) 1
+                    << (data_size * 8 - (is_signed ? 1 : 0));
+
+                if (is_signed ? ((hg_int64_t) value >= (hg_int64_t) max
+                    || (hg_int64_t) value < -(hg_int64_t) max)
+                    : value >= max) {
+                    HG_LOG_ERROR("Decoded value exceeds integer size");
+                    ret = HG_PROTOCOL_ERROR;
+                    goto done;
+                }
+            }
+            switch (data_size) {
+                case sizeof(hg_uint16_t):
+                    *(hg_uint16_t *) data = (hg_uint16_t) value;
+                    break;
+                case sizeof(hg_uint32_t):
+                    *(hg_uint32_t *) data = (hg_uint32_t) value;
+                    break;
+                case sizeof(hg_uint64_t):
+                    *(hg_uint64_t *) data = value;
+                    break;
+                default:
+                    HG_LOG_ERROR("Unsupported integer size");
+                    ret = HG_INVALID_PARAM;
+                    goto done;
+            }
+            break;
+        case HG_FREE:
+        default:
+            goto done;
+    }
+
+#ifdef HG_HAS_CHECKSUMS
+    /* Checksum the integer value so that it does not depend on encoding */
+    ret = hg_proc_checksum_update(proc, data, data_size);
+    if (ret != HG_SUCCESS) {
+        HG_LOG_ERROR("Could not update checksum");
+        goto done;
+    }
+#endif
+
+done:
+    return ret;
+}
+
+/*---------------------------------------------------------------------------*/
+hg_return_t
+hg_proc_packed_array(hg_proc_t proc, void **data, hg_uint64_t *count,
+    hg_size_t elem_size, hg_bool_t is_signed)
+{
+    struct hg_proc *hg_proc = (struct hg_proc *) proc;
+    hg_bool_t compact;
+    hg_uint64_t i;
+    hg_return_t ret = HG_SUCCESS;
+
+    if (!hg_proc) {
+        HG_LOG_ERROR("Proc is not initialized");
+        ret = HG_INVALID_PARAM;
+        goto done;
+    }
+    if (!data || !count || (elem_size != sizeof(hg_uint8_t)
+        && elem_size != sizeof(hg_uint16_t) && elem_size != sizeof(hg_uint32_t)
+        && elem_size != sizeof(hg_uint64_t))) {
+        HG_LOG_ERROR("Invalid array");
+        ret = HG_INVALID_PARAM;
+        goto done;
+    }
+
+    if (hg_proc->op == HG_FREE) {
+        free(*data);
+        *data = NULL;
+        goto done;
+    }
+
+    /* Bytes are never worth encoding as varints */
+    compact = (hg_proc->flags & HG_PROC_COMPACT)
+        && elem_size > sizeof(hg_uint8_t);
+
+    /* Length prefix */
+    ret = hg_proc_integer(proc, count, sizeof(hg_uint64_t), HG_FALSE);
+    if (ret != HG_SUCCESS) {
+        HG_LOG_ERROR("Could not proc array count");
+        goto done;
+    }
+
+    if (hg_proc->op == HG_DECODE) {
+        *data = NULL;
+        if (!*count)
+            goto done;
+
+        /* Each element takes at least one byte, do not trust count */
+        if (*count > hg_proc_get_size_left(proc) / (compact ? 1 : elem_size)) {
+            HG_LOG_ERROR("Array count exceeds buffer size");
+            ret = HG_PROTOCOL_ERROR;
+            goto done;
+        }
+        *data = malloc(*count * elem_size);
+        if (!*data) {
+            HG_LOG_ERROR("Could not allocate array");
+            ret = HG_NOMEM_ERROR;
+            goto done;
+        }
+    }
+
+    if (!compact)
+        ret = hg_proc_memcpy(proc, *data, *count * elem_size);
+    else
+        for (i = 0; i < *count && ret == HG_SUCCESS; i++)
+            ret = hg_proc_integer(proc, (char *) *data + i * elem_size,
+                elem_size, is_signed);
+    if (ret != HG_SUCCESS) {
+        HG_LOG_ERROR("Could not proc array elements");
+        if (hg_proc->op == HG_DECODE) {
+            free(*data);
+            *data = NULL;
+        }
+        goto done;
+    }
+
+done:
+    return ret;
+}
+
 #ifdef HG_HAS_CHECKSUMS
 /*---------------------------------------------------------------------------*/
 static HG_INLINE hg_return_t
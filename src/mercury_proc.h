@@ -40,6 +40,11 @@
 #define HG_VERSION ((HG_VERSION_MAJOR << 24) | (HG_VERSION_MINOR << 16) \
         | HG_VERSION_PATCH)
 
+/* Proc flags */
+#define HG_PROC_COMPACT (1 << 0) /* Encode integers as varints (no XDR) */
+#define HG_PROC_EAGER_PUSH (1 << 1) /* Keep track of bulk handles processed */
+#define HG_PROC_EAGER_PUSH_RW (1 << 2) /* Push read/write handles eagerly */
+
 /*********************/
 /* Public Prototypes */
 /*********************/
@@ -186,6 +191,34 @@ hg_proc_set_size(
         hg_size_t buf_size
         );
 
+/**
+ * Set flags (e.g., HG_PROC_COMPACT) that control how data is processed.
+ * \remark Flags are cleared by hg_proc_reset() and must be set again after
+ * each reset. Encoding and decoding sides must use the same flags.
+ *
+ * \param proc [IN/OUT]         abstract processor object
+ * \param flags [IN]            bitwise OR of HG_PROC_XXX flags
+ *
+ * \return HG_SUCCESS or corresponding HG error code
+ */
+HG_EXPORT hg_return_t
+hg_proc_set_flags(
+        hg_proc_t proc,
+        hg_uint8_t flags
+        );
+
+/**
+ * Get flags currently set on the processor.
+ *
+ * \param proc [IN]             abstract processor object
+ *
+ * \return Bitwise OR of HG_PROC_XXX flags
+ */
+HG_EXPORT hg_uint8_t
+hg_proc_get_flags(
+        hg_proc_t proc
+        );
+
 /**
  * Get size left for processing.
  *
@@ -280,6 +313,60 @@ hg_proc_set_extra_buf_is_mine(
         hg_bool_t mine
         );
 
+/**
+ * Add bulk handle to the list of handles processed (used when
+ * HG_PROC_EAGER_PUSH is set). A reference is taken on the handle until
+ * hg_proc_clear_bulks() or hg_proc_free() is called. The list is not cleared
+ * by hg_proc_reset().
+ *
+ * \param proc [IN/OUT]         abstract processor object
+ * \param handle [IN]           abstract bulk handle
+ *
+ * \return HG_SUCCESS or corresponding HG error code
+ */
+HG_EXPORT hg_return_t
+hg_proc_add_bulk(
+        hg_proc_t proc,
+        hg_bulk_t handle
+        );
+
+/**
+ * Get number of bulk handles added with hg_proc_add_bulk().
+ *
+ * \param proc [IN]             abstract processor object
+ *
+ * \return Non-negative value
+ */
+HG_EXPORT hg_uint32_t
+hg_proc_get_bulk_count(
+        hg_proc_t proc
+        );
+
+/**
+ * Get bulk handle added with hg_proc_add_bulk().
+ *
+ * \param proc [IN]             abstract processor object
+ * \param index [IN]            index of handle in order of processing
+ *
+ * \return Bulk handle or HG_BULK_NULL if index is out of range
+ */
+HG_EXPORT hg_bulk_t
+hg_proc_get_bulk(
+        hg_proc_t proc,
+        hg_uint32_t index
+        );
+
+/**
+ * Release references to bulk handles added with hg_proc_add_bulk() and clear
+ * the list.
+ *
+ * \param proc [IN/OUT]         abstract processor object
+ */
+HG_EXPORT void
+hg_proc_clear_bulks(
+        hg_proc_t proc
+        );
+
 /**
  * Flush the proc after data has been encoded or decoded and finalize internal
  * checksum if checksum of data processed was initially requested.
@@ -310,6 +397,50 @@ hg_proc_memcpy(
         hg_size_t data_size
         );
 
+/**
+ * Base proc routine for integers of data_size bytes. Uses memcpy() unless
+ * HG_PROC_COMPACT is set, in which case integers are encoded as LEB128
+ * varints (zigzag encoded if is_signed is true).
+ *
+ * \param proc [IN/OUT]         abstract processor object
+ * \param data [IN/OUT]         pointer to data
+ * \param data_size [IN]        data size (2, 4 or 8)
+ * \param is_signed [IN]        signed integer
+ *
+ * \return HG_SUCCESS or corresponding HG error code
+ */
+HG_EXPORT hg_return_t
+hg_proc_integer(
+        hg_proc_t proc,
+        void *data,
+        hg_size_t data_size,
+        hg_bool_t is_signed
+        );
+
+/**
+ * Proc routine for a length-prefixed array of count integers of elem_size
+ * bytes. Count is encoded first, elements then follow with a single memcpy()
+ * unless HG_PROC_COMPACT is set, in which case each element is encoded as a
+ * varint (see hg_proc_integer()). When decoding, the array is allocated and
+ * must be released by processing it again with HG_FREE.
+ *
+ * \param proc [IN/OUT]         abstract processor object
+ * \param data [IN/OUT]         pointer to array pointer
+ * \param count [IN/OUT]        pointer to number of elements
+ * \param elem_size [IN]        element size (1, 2, 4 or 8)
+ * \param is_signed [IN]        signed integers
+ *
+ * \return HG_SUCCESS or corresponding HG error code
+ */
+HG_EXPORT hg_return_t
+hg_proc_packed_array(
+        hg_proc_t proc,
+        void **data,
+        hg_uint64_t *count,
+        hg_size_t elem_size,
+        hg_bool_t is_signed
+        );
+
 #ifdef HG_HAS_CHECKSUMS
 /**
  * Retrieve internal proc checksum hash.
@@ -450,7 +581,7 @@ hg_proc_hg_int16_t(hg_proc_t proc, void *data)
 #ifdef HG_HAS_XDR
     ret = xdr_int16_t(hg_proc_get_xdr_ptr(proc), data) ? HG_SUCCESS : HG_PROTOCOL_ERROR;
 #else
-    ret = hg_proc_memcpy(proc, data, sizeof(hg_int16_t));
+    ret = hg_proc_integer(proc, data, sizeof(hg_int16_t), HG_TRUE);
 #endif
     return ret;
 }
@@ -470,7 +601,7 @@ hg_proc_hg_uint16_t(hg_proc_t proc, void *data)
 #ifdef HG_HAS_XDR
     ret = xdr_uint16_t(hg_proc_get_xdr_ptr(proc), data) ? HG_SUCCESS : HG_PROTOCOL_ERROR;
 #else
-    ret = hg_proc_memcpy(proc, data, sizeof(hg_uint16_t));
+    ret = hg_proc_integer(proc, data, sizeof(hg_uint16_t), HG_FALSE);
 #endif
     return ret;
 }
@@ -490,7 +621,7 @@ hg_proc_hg_int32_t(hg_proc_t proc, void *data)
 #ifdef HG_HAS_XDR
     ret = xdr_int32_t(hg_proc_get_xdr_ptr(proc), data) ? HG_SUCCESS : HG_PROTOCOL_ERROR;
 #else
-    ret = hg_proc_memcpy(proc, data, sizeof(hg_int32_t));
+    ret = hg_proc_integer(proc, data, sizeof(hg_int32_t), HG_TRUE);
 #endif
     return ret;
 }
@@ -510,7 +641,7 @@ hg_proc_hg_uint32_t(hg_proc_t proc, void *data)
 #ifdef HG_HAS_XDR
     ret = xdr_uint32_t(hg_proc_get_xdr_ptr(proc), data) ? HG_SUCCESS : HG_PROTOCOL_ERROR;
 #else
-    ret = hg_proc_memcpy(proc, data, sizeof(hg_uint32_t));
+    ret = hg_proc_integer(proc, data, sizeof(hg_uint32_t), HG_FALSE);
 #endif
     return ret;
 }
@@ -530,7 +661,7 @@ hg_proc_hg_int64_t(hg_proc_t proc, void *data)
 #ifdef HG_HAS_XDR
     ret = xdr_int64_t(hg_proc_get_xdr_ptr(proc), data) ? HG_SUCCESS : HG_PROTOCOL_ERROR;
 #else
-    ret = hg_proc_memcpy(proc, data, sizeof(hg_int64_t));
+    ret = hg_proc_integer(proc, data, sizeof(hg_int64_t), HG_TRUE);
 #endif
     return ret;
 }
@@ -550,7 +681,7 @@ hg_proc_hg_uint64_t(hg_proc_t proc, void *data)
 #ifdef HG_HAS_XDR
     ret = xdr_uint64_t(hg_proc_get_xdr_ptr(proc), data) ? HG_SUCCESS : HG_PROTOCOL_ERROR;
 #else
-    ret = hg_proc_memcpy(proc, data, sizeof(hg_uint64_t));
+    ret = hg_proc_integer(proc, data, sizeof(hg_uint64_t), HG_FALSE);
 #endif
     return ret;
 }
@@ -573,16 +704,20 @@ hg_proc_hg_bulk_t(hg_proc_t proc, void *data)
 
     switch (hg_proc_get_op(proc)) {
         case HG_ENCODE: {
-            hg_bool_t request_eager = HG_FALSE;
+            hg_uint8_t request_eager = 0;
 
             if (*bulk_ptr == HG_BULK_NULL) {
                 /* If HG_BULK_NULL set 0 to buf_size */
                 buf_size = 0;
             } else {
 #ifdef HG_HAS_EAGER_BULK
-                request_eager = (hg_proc_get_size_left(proc)
-                    > HG_Bulk_get_serialize_size(*bulk_ptr, HG_TRUE))
-                    ? HG_TRUE : HG_FALSE;
+                if (hg_proc_get_flags(proc) & HG_PROC_EAGER_PUSH)
+                    request_eager |= HG_BULK_EAGER_PUSH;
+                if (hg_proc_get_flags(proc) & HG_PROC_EAGER_PUSH_RW)
+                    request_eager |= HG_BULK_EAGER_PUSH_RW;
+                if (hg_proc_get_size_left(proc) > HG_Bulk_get_serialize_size(
+                    *bulk_ptr, request_eager | HG_BULK_EAGER))
+                    request_eager |= HG_BULK_EAGER;
 #endif
                 buf_size = HG_Bulk_get_serialize_size(*bulk_ptr, request_eager);
             }
@@ -600,6 +735,15 @@ hg_proc_hg_bulk_t(hg_proc_t proc, void *data)
                     return ret;
                 }
                 hg_proc_restore_ptr(proc, buf, buf_size);
+#ifdef HG_HAS_EAGER_BULK
+                if (hg_proc_get_flags(proc) & HG_PROC_EAGER_PUSH) {
+                    ret = hg_proc_add_bulk(proc, *bulk_ptr);
+                    if (ret != HG_SUCCESS) {
+                        HG_LOG_ERROR("Could not add bulk handle");
+                        return ret;
+                    }
+                }
+#endif
             }
         }
         break;
@@ -620,6 +764,15 @@ hg_proc_hg_bulk_t(hg_proc_t proc, void *data)
                     return ret;
                 }
                 hg_proc_restore_ptr(proc, buf, buf_size);
+#ifdef HG_HAS_EAGER_BULK
+                if (hg_proc_get_flags(proc) & HG_PROC_EAGER_PUSH) {
+                    ret = hg_proc_add_bulk(proc, *bulk_ptr);
+                    if (ret != HG_SUCCESS) {
+                        HG_LOG_ERROR("Could not add bulk handle");
+                        return ret;
+                    }
+                }
+#endif
             } else {
                 /* If buf_size is 0, define handle to HG_BULK_NULL */
                 *bulk_ptr = HG_BULK_NULL;
@@ -0,0 +1,604 @@
+/*
+ * Copyright (C) 2013-2017 Argonne National Laboratory, Department of Energy,
+ *                    UChicago Argonne, LLC and The HDF Group.
+ * All rights reserved.
+ *
+ * The full copyright notice, including terms governing use, modification,
+ * and redistribution, is contained in the COPYING file that can be
+ * found at the root of the source code distribution tree.
+ */
+
+#include "mercury_stats.h"
+#include "mercury_error.h"
+
+#include "mercury_atomic.h"
+#include "mercury_histogram.h"
+#include "mercury_hash_table.h"
+#include "mercury_list.h"
+#include "mercury_thread.h"
+#include "mercury_thread_mutex.h"
+#include "mercury_thread_spin.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/****************/
+/* Local Macros */
+/****************/
+
+/* Init states */
+#define HG_STATS_UNINIT     0
+#define HG_STATS_INITING    1
+#define HG_STATS_INITED     2
+#define HG_STATS_FAILED     3
+
+/************************************/
+/* Local Type and Struct Definition */
+/************************************/
+
+/* Stats entry key */
+struct hg_stats_key {
+    hg_class_t *hg_class;               /* HG class */
+    hg_context_t *context;              /* HG context */
+    hg_id_t id;                         /* RPC ID */
+};
+
+/* Stats entry */
+struct hg_stats_entry {
+    struct hg_stats_key key;            /* Entry key */
+    struct hg_stats stats;              /* Entry stats */
+    HG_LIST_ENTRY(hg_stats_entry) entry; /* Entry in shard list */
+};
+
+/* Per-thread stats shard */
+struct hg_stats_shard {
+    hg_thread_spin_t lock;              /* Lock taken by owner and readers */
+    hg_hash_table_t *table;             /* Entries indexed by key */
+    HG_LIST_HEAD(hg_stats_entry) entries; /* List of entries */
+    HG_LIST_ENTRY(hg_stats_shard) entry; /* Entry in shard list */
+};
+
+/********************/
+/* Local Prototypes */
+/********************/
+
+/**
+ * Hash function for stats table.
+ */
+static unsigned int
+hg_stats_key_hash(
+        hg_hash_table_key_t vkey
+        );
+
+/**
+ * Equal function for stats table.
+ */
+static int
+hg_stats_key_equal(
+        hg_hash_table_key_t vkey1,
+        hg_hash_table_key_t vkey2
+        );
+
+/**
+ * Check whether key matches filter (NULL context / HG_STATS_ANY match any).
+ */
+static HG_INLINE hg_bool_t
+hg_stats_key_match(
+        const struct hg_stats_key *key,
+        hg_class_t *hg_class,
+        hg_context_t *context,
+        hg_id_t id
+        );
+
+/**
+ * Get shard of calling thread, create it if needed.
+ */
+static struct hg_stats_shard *
+hg_stats_shard_get(void);
+
+/**
+ * Get entry from shard, create it if needed. Must be called with shard lock.
+ */
+static struct hg_stats_entry *
+hg_stats_entry_get(
+        struct hg_stats_shard *shard,
+        struct hg_stats_key *key
+        );
+
+/**
+ * Remove entry from shard. Must be called with shard lock.
+ */
+static void
+hg_stats_entry_remove(
+        struct hg_stats_shard *shard,
+        struct hg_stats_entry *entry
+        );
+
+/**
+ * Merge histogram into another one.
+ */
+static void
+hg_stats_hist_merge(
+        struct hg_stats_hist *dest,
+        const struct hg_stats_hist *src
+        );
+
+/**
+ * Merge stats into another one.
+ */
+static void
+hg_stats_merge(
+        struct hg_stats *dest,
+        const struct hg_stats *src
+        );
+
+/**
+ * Print histogram.
+ */
+static void
+hg_stats_hist_print(
+        const char *name,
+        const struct hg_stats_hist *hist
+        );
+
+/*******************/
+/* Local Variables */
+/*******************/
+
+static hg_atomic_int32_t hg_stats_init_g = HG_ATOMIC_VAR_INIT(HG_STATS_UNINIT);
+static hg_thread_key_t hg_stats_key_g;
+static hg_thread_mutex_t hg_stats_shards_mutex_g;
+static HG_LIST_HEAD(hg_stats_shard) hg_stats_shards_g =
+    HG_LIST_HEAD_INITIALIZER(hg_stats_shards_g);
+
+/*---------------------------------------------------------------------------*/
+static unsigned int
+hg_stats_key_hash(hg_hash_table_key_t vkey)
+{
+    struct hg_stats_key *key = (struct hg_stats_key *) vkey;
+
+    return (unsigned int) (((size_t) key->hg_class >> 4)
+        ^ ((size_t) key->context >> 4) ^ (key->id * 2654435761U));
+}
+
+/*---------------------------------------------------------------------------*/
+static int
+hg_stats_key_equal(hg_hash_table_key_t vkey1, hg_hash_table_key_t vkey2)
+{
+    struct hg_stats_key *key1 = (struct hg_stats_key *) vkey1;
+    struct hg_stats_key *key2 = (struct hg_stats_key *) vkey2;
+
+    return key1->hg_class == key2->hg_class && key1->context == key2->context
+        && key1->id == key2->id;
+}
+
+/*---------------------------------------------------------------------------*/
+static HG_INLINE hg_bool_t
+hg_stats_key_match(const struct hg_stats_key *key, hg_class_t *hg_class,
+    hg_context_t *context, hg_id_t id)
+{
+    return (key->hg_class == hg_class)
+        && (!context || key->context == context)
+        && (id == HG_STATS_ANY || key->id == id);
+}
+
+/*---------------------------------------------------------------------------*/
+static struct hg_stats_shard *
+hg_stats_shard_get(void)
+{
+    struct hg_stats_shard *shard;
+
+    shard = (struct hg_stats_shard *) hg_thread_getspecific(hg_stats_key_g);
+    if (shard)
+        goto done;
+
+    shard = (struct hg_stats_shard *) malloc(sizeof(struct hg_stats_shard));
+    if (!shard) {
+        HG_LOG_ERROR("Could not allocate stats shard");
+        goto done;
+    }
+    memset(shard, 0, sizeof(struct hg_stats_shard));
+    shard->table = hg_hash_table_new(hg_stats_key_hash, hg_stats_key_equal);
+    if (!shard->table) {
+        HG_LOG_ERROR("Could not create stats table");
+        free(shard);
+        shard = NULL;
+        goto done;
+    }
+    hg_thread_spin_init(&shard->lock);
+    HG_LIST_INIT(&shard->entries);
+
+    hg_thread_mutex_lock(&hg_stats_shards_mutex_g);
+    HG_LIST_INSERT_HEAD(&hg_stats_shards_g, shard, entry);
+    hg_thread_mutex_unlock(&hg_stats_shards_mutex_g);
+
+    hg_thread_setspecific(hg_stats_key_g, shard);
+
+done:
+    return shard;
+}
+
+/*---------------------------------------------------------------------------*/
+static struct hg_stats_entry *
+hg_stats_entry_get(struct hg_stats_shard *shard,
+    struct hg_stats_key *key)
+{
+    struct hg_stats_entry *entry;
+
+    entry = (struct hg_stats_entry *) hg_hash_table_lookup(shard->table,
+        (hg_hash_table_key_t) key);
+    if (entry)
+        goto done;
+
+    entry = (struct hg_stats_entry *) malloc(sizeof(struct hg_stats_entry));
+    if (!entry) {
+        HG_LOG_ERROR("Could not allocate stats entry");
+        goto done;
+    }
+    memset(entry, 0, sizeof(struct hg_stats_entry));
+    entry->key = *key;
+
+    if (!hg_hash_table_insert(shard->table, (hg_hash_table_key_t) &entry->key,
+        (hg_hash_table_value_t) entry)) {
+        HG_LOG_ERROR("Could not insert stats entry");
+        free(entry);
+        entry = NULL;
+        goto done;
+    }
+    HG_LIST_INSERT_HEAD(&shard->entries, entry, entry);
+
+done:
+    return entry;
+}
+
+/*---------------------------------------------------------------------------*/
+static void
+hg_stats_entry_remove(struct hg_stats_shard *shard,
+    struct hg_stats_entry *entry)
+{
+    hg_hash_table_remove(shard->table, (hg_hash_table_key_t) &entry->key);
+    HG_LIST_REMOVE(entry, entry);
+    free(entry);
+}
+
+/*---------------------------------------------------------------------------*/
+static void
+hg_stats_hist_merge(struct hg_stats_hist *dest,
+    const struct hg_stats_hist *src)
+{
+    unsigned int i;
+
+    if (!src->count)
+        return;
+
+    if (!dest->count || src->min < dest->min)
+        dest->min = src->min;
+    if (src->max > dest->max)
+        dest->max = src->max;
+    dest->count += src->count;
+    dest->sum += src->sum;
+    for (i = 0; i < HG_STATS_HIST_BUCKETS; i++)
+        dest->buckets[i] += src->buckets[i];
+}
+
+/*---------------------------------------------------------------------------*/
+static void
+hg_stats_merge(struct hg_stats *dest, const struct hg_stats *src)
+{
+    dest->forward_count += src->forward_count;
+    dest->forward_error_count += src->forward_error_count;
+    dest->recv_count += src->recv_count;
+    dest->recv_extra_count += src->recv_extra_count;
+    dest->respond_count += src->respond_count;
+    dest->bulk_count += src->bulk_count;
+    hg_stats_hist_merge(&dest->queue_time, &src->queue_time);
+    hg_stats_hist_merge(&dest->handler_time, &src->handler_time);
+    hg_stats_hist_merge(&dest->forward_time, &src->forward_time);
+}
+
+/*---------------------------------------------------------------------------*/
+static void
+hg_stats_hist_print(const char *name, const struct hg_stats_hist *hist)
+{
+    if (!hist->count)
+        return;
+
+    printf("  %-14s avg %lu, p50 %lu, p99 %lu, max %lu (us)\n", name,
+        (unsigned long) (hist->sum / hist->count),
+        (unsigned long) hg_stats_hist_percentile(hist, 50.0),
+        (unsigned long) hg_stats_hist_percentile(hist, 99.0),
+        (unsigned long) hist->max);
+}
+
+/*---------------------------------------------------------------------------*/
+hg_return_t
+hg_stats_init(void)
+{
+    hg_return_t ret = HG_SUCCESS;
+
+    /* A failed initialization can be retried */
+    if (!hg_atomic_cas32(&hg_stats_init_g, HG_STATS_UNINIT, HG_STATS_INITING)
+        && !hg_atomic_cas32(&hg_stats_init_g, HG_STATS_FAILED,
+            HG_STATS_INITING)) {
+        /* Someone else is initializing */
+        while (hg_atomic_get32(&hg_stats_init_g) == HG_STATS_INITING)
+            continue;
+        if (hg_atomic_get32(&hg_stats_init_g) != HG_STATS_INITED) {
+            HG_LOG_ERROR("Stats initialization failed");
+            ret = HG_PROTOCOL_ERROR;
+        }
+        goto done;
+    }
+
+    if (hg_thread_key_create(&hg_stats_key_g) != HG_UTIL_SUCCESS) {
+        HG_LOG_ERROR("Could not create stats thread key");
+        hg_atomic_set32(&hg_stats_init_g, HG_STATS_FAILED);
+        ret = HG_NOMEM_ERROR;
+        goto done;
+    }
+    hg_thread_mutex_init(&hg_stats_shards_mutex_g);
+
+    hg_atomic_set32(&hg_stats_init_g, HG_STATS_INITED);
+
+done:
+    return ret;
+}
+
+/*---------------------------------------------------------------------------*/
+void
+hg_stats_incr(hg_class_t *hg_class, hg_context_t *context, hg_id_t id,
+    hg_stats_counter_t counter)
+{
+    struct hg_stats_shard *shard = hg_stats_shard_get();
+    struct hg_stats_key key;
+    struct hg_stats_entry *entry;
+
+    if (!shard)
+        return;
+
+    key.hg_class = hg_class;
+    key.context = context;
+    key.id = id;
+
+    hg_thread_spin_lock(&shard->lock);
+    entry = hg_stats_entry_get(shard, &key);
+    if (entry) {
+        switch (counter) {
+            case HG_STATS_FORWARD:
+                entry->stats.forward_count++;
+                break;
+            case HG_STATS_FORWARD_ERROR:
+                entry->stats.forward_error_count++;
+                break;
+            case HG_STATS_RECV:
+                entry->stats.recv_count++;
+                break;
+            case HG_STATS_RECV_EXTRA:
+                entry->stats.recv_extra_count++;
+                break;
+            case HG_STATS_RESPOND:
+                entry->stats.respond_count++;
+                break;
+            case HG_STATS_BULK:
+                entry->stats.bulk_count++;
+                break;
+            default:
+                break;
+        }
+    }
+    hg_thread_spin_unlock(&shard->lock);
+}
+
+/*---------------------------------------------------------------------------*/
+void
+hg_stats_record(hg_class_t *hg_class, hg_context_t *context, hg_id_t id,
+    hg_stats_hist_type_t type, hg_uint64_t usec)
+{
+    struct hg_stats_shard *shard = hg_stats_shard_get();
+    struct hg_stats_key key;
+    struct hg_stats_entry *entry;
+    struct hg_stats_hist *hist;
+
+    if (!shard)
+        return;
+
+    key.hg_class = hg_class;
+    key.context = context;
+    key.id = id;
+
+    hg_thread_spin_lock(&shard->lock);
+    entry = hg_stats_entry_get(shard, &key);
+    if (!entry)
+        goto unlock;
+
+    switch (type) {
+        case HG_STATS_QUEUE_TIME:
+            hist = &entry->stats.queue_time;
+            break;
+        case HG_STATS_HANDLER_TIME:
+            hist = &entry->stats.handler_time;
+            break;
+        case HG_STATS_FORWARD_TIME:
+            hist = &entry->stats.forward_time;
+            break;
+        default:
+            goto unlock;
+    }
+
+    if (!hist->count || usec < hist->min)
+        hist->min = usec;
+    if (usec > hist->max)
+        hist->max = usec;
+    hist->count++;
+    hist->sum += usec;
+    hist->buckets[hg_histogram_index(usec, HG_STATS_HIST_SUB_BITS,
+        HG_STATS_HIST_MAX_BITS)]++;
+
+unlock:
+    hg_thread_spin_unlock(&shard->lock);
+}
+
+/*---------------------------------------------------------------------------*/
+void
+hg_stats_get(hg_class_t *hg_class, hg_context_t *context, hg_id_t id,
+    struct hg_stats *stats)
+{
+    struct hg_stats_shard *shard;
+
+    memset(stats, 0, sizeof(struct hg_stats));
+
+    if (hg_atomic_get32(&hg_stats_init_g) != HG_STATS_INITED)
+        return;
+
+    hg_thread_mutex_lock(&hg_stats_shards_mutex_g);
+    HG_LIST_FOREACH(shard, &hg_stats_shards_g, entry) {
+        struct hg_stats_entry *entry;
+
+        hg_thread_spin_lock(&shard->lock);
+        HG_LIST_FOREACH(entry, &shard->entries, entry) {
+            if (hg_stats_key_match(&entry->key, hg_class, context, id))
+                hg_stats_merge(stats, &entry->stats);
+        }
+        hg_thread_spin_unlock(&shard->lock);
+    }
+    hg_thread_mutex_unlock(&hg_stats_shards_mutex_g);
+}
+
+/*---------------------------------------------------------------------------*/
+void
+hg_stats_reset(hg_class_t *hg_class, hg_context_t *context, hg_id_t id)
+{
+    struct hg_stats_shard *shard;
+
+    if (hg_atomic_get32(&hg_stats_init_g) != HG_STATS_INITED)
+        return;
+
+    hg_thread_mutex_lock(&hg_stats_shards_mutex_g);
+    HG_LIST_FOREACH(shard, &hg_stats_shards_g, entry) {
+        struct hg_stats_entry *entry, *next;
+
+        hg_thread_spin_lock(&shard->lock);
+        for (entry = HG_LIST_FIRST(&shard->entries); entry; entry = next) {
+            next = HG_LIST_NEXT(entry, entry);
+            if (hg_stats_key_match(&entry->key, hg_class, context, id))
+                hg_stats_entry_remove(shard, entry);
+        }
+        hg_thread_spin_unlock(&shard->lock);
+    }
+    hg_thread_mutex_unlock(&hg_stats_shards_mutex_g);
+}
+
+/*---------------------------------------------------------------------------*/
+void
+hg_stats_retire(hg_class_t *hg_class, hg_context_t *context)
+{
+    struct hg_stats_shard *shard;
+
+    if (hg_atomic_get32(&hg_stats_init_g) != HG_STATS_INITED)
+        return;
+
+    hg_thread_mutex_lock(&hg_stats_shards_mutex_g);
+    HG_LIST_FOREACH(shard, &hg_stats_shards_g, entry) {
+        struct hg_stats_entry *entry, *next;
+
+        hg_thread_spin_lock(&shard->lock);
+        for (entry = HG_LIST_FIRST(&shard->entries); entry; entry = next) {
+            struct hg_stats_key key;
+            struct hg_stats_entry *retired;
+
+            next = HG_LIST_NEXT(entry, entry);
+            if (!hg_stats_key_match(&entry->key, hg_class, context,
+                HG_STATS_ANY))
+                continue;
+
+            /* Retired context stats go to the class, retired class stats
+             * go to the process (new entries never match and are inserted
+             * at the head of the list, i.e., before the current entry) */
+            key.hg_class = context ? hg_class : NULL;
+            key.context = NULL;
+            key.id = entry->key.id;
+            retired = hg_stats_entry_get(shard, &key);
+            if (retired)
+                hg_stats_merge(&retired->stats, &entry->stats);
+            hg_stats_entry_remove(shard, entry);
+        }
+        hg_thread_spin_unlock(&shard->lock);
+    }
+    hg_thread_mutex_unlock(&hg_stats_shards_mutex_g);
+}
+
+/*---------------------------------------------------------------------------*/
+hg_uint64_t
+hg_stats_hist_percentile(const struct hg_stats_hist *hist, double percentile)
+{
+    return hg_histogram_percentile(hist->buckets, HG_STATS_HIST_SUB_BITS,
+        HG_STATS_HIST_MAX_BITS, hist->count, hist->max, percentile);
+}
+
+/*---------------------------------------------------------------------------*/
+void
+hg_stats_print(void)
+{
+    struct hg_stats_entry *merged = NULL;
+    unsigned int merged_count = 0, merged_max = 0, i;
+    struct hg_stats_shard *shard;
+
+    if (hg_atomic_get32(&hg_stats_init_g) != HG_STATS_INITED)
+        return;
+
+    /* Merge entries of all classes, contexts and threads by RPC ID */
+    hg_thread_mutex_lock(&hg_stats_shards_mutex_g);
+    HG_LIST_FOREACH(shard, &hg_stats_shards_g, entry) {
+        struct hg_stats_entry *entry;
+
+        hg_thread_spin_lock(&shard->lock);
+        HG_LIST_FOREACH(entry, &shard->entries, entry) {
+            for (i = 0; i < merged_count; i++)
+                if (merged[i].key.id == entry->key.id)
+                    break;
+            if (i == merged_count) {
+                if (merged_count == merged_max) {
+                    unsigned int new_max = merged_max ? merged_max * 2 : 16;
+                    struct hg_stats_entry *new_merged =
+                        (struct hg_stats_entry *) realloc(merged,
+                            new_max * sizeof(struct hg_stats_entry));
+
+                    if (!new_merged)
+                        continue;
+                    merged = new_merged;
+                    merged_max = new_max;
+                }
+                memset(&merged[i], 0, sizeof(struct hg_stats_entry));
+                merged[i].key.id = entry->key.id;
+                merged_count++;
+            }
+            hg_stats_merge(&merged[i].stats, &entry->stats);
+        }
+        hg_thread_spin_unlock(&shard->lock);
+    }
+    hg_thread_mutex_unlock(&hg_stats_shards_mutex_g);
+
+    for (i = 0; i < merged_count; i++) {
+        const struct hg_stats *stats = &merged[i].stats;
+
+        if (merged[i].key.id == HG_STATS_ANY) {
+            if (stats->bulk_count)
+                printf("Bulk transfers:       %lu\n",
+                    (unsigned long) stats->bulk_count);
+            continue;
+        }
+        printf("RPC ID 0x%08x: forward %lu (%lu errors), recv %lu "
+            "(%lu overflow), respond %lu\n", (unsigned int) merged[i].key.id,
+            (unsigned long) stats->forward_count,
+            (unsigned long) stats->forward_error_count,
+            (unsigned long) stats->recv_count,
+            (unsigned long) stats->recv_extra_count,
+            (unsigned long) stats->respond_count);
+        hg_stats_hist_print("queue time", &stats->queue_time);
+        hg_stats_hist_print("handler time", &stats->handler_time);
+        hg_stats_hist_print("forward time", &stats->forward_time);
+    }
+
+    free(merged);
+}
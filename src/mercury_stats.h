@@ -0,0 +1,170 @@
+/*
+ * Copyright (C) 2013-2017 Argonne National Laboratory, Department of Energy,
+ *                    UChicago Argonne, LLC and The HDF Group.
+ * All rights reserved.
+ *
+ * The full copyright notice, including terms governing use, modification,
+ * and redistribution, is contained in the COPYING file that can be
+ * found at the root of the source code distribution tree.
+ */
+
+#ifndef MERCURY_STATS_H
+#define MERCURY_STATS_H
+
+#include "mercury_types.h"
+#include "mercury_time.h"
+
+/*************************************/
+/* Public Type and Struct Definition */
+/*************************************/
+
+/* Stats counters */
+typedef enum {
+    HG_STATS_FORWARD,           /*!< RPC forwarded */
+    HG_STATS_FORWARD_ERROR,     /*!< RPC completed with error */
+    HG_STATS_RECV,              /*!< RPC received */
+    HG_STATS_RECV_EXTRA,        /*!< RPC received with overflow */
+    HG_STATS_RESPOND,           /*!< RPC responded */
+    HG_STATS_BULK               /*!< Bulk transfer completed */
+} hg_stats_counter_t;
+
+/* Stats histograms */
+typedef enum {
+    HG_STATS_QUEUE_TIME,        /*!< NA completion to RPC callback */
+    HG_STATS_HANDLER_TIME,      /*!< RPC callback to response */
+    HG_STATS_FORWARD_TIME       /*!< Forward to forward callback */
+} hg_stats_hist_type_t;
+
+/*****************/
+/* Public Macros */
+/*****************/
+
+/* Elapsed time in microseconds */
+#define HG_STATS_USEC(t1, t2) \
+    ((hg_uint64_t) (hg_time_to_double(hg_time_subtract(t2, t1)) * 1000000.0))
+
+/*********************/
+/* Public Prototypes */
+/*********************/
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * Initialize stats collection. Thread shards are never released so that
+ * stats of exited threads remain visible until the process exits.
+ *
+ * \return HG_SUCCESS or corresponding HG error code
+ */
+hg_return_t
+hg_stats_init(void);
+
+/**
+ * Increment counter of (class, context, RPC ID) entry. Updates only go to
+ * the calling thread's shard and only contend with concurrent readers.
+ *
+ * \param hg_class [IN]         pointer to HG class
+ * \param context [IN]          pointer to HG context
+ * \param id [IN]               RPC ID
+ * \param counter [IN]          counter type
+ */
+void
+hg_stats_incr(
+        hg_class_t *hg_class,
+        hg_context_t *context,
+        hg_id_t id,
+        hg_stats_counter_t counter
+        );
+
+/**
+ * Add a latency sample to histogram of (class, context, RPC ID) entry.
+ *
+ * \param hg_class [IN]         pointer to HG class
+ * \param context [IN]          pointer to HG context
+ * \param id [IN]               RPC ID
+ * \param type [IN]             histogram type
+ * \param usec [IN]             sample in microseconds
+ */
+void
+hg_stats_record(
+        hg_class_t *hg_class,
+        hg_context_t *context,
+        hg_id_t id,
+        hg_stats_hist_type_t type,
+        hg_uint64_t usec
+        );
+
+/**
+ * Merge stats of all thread shards. NULL context and HG_STATS_ANY act as
+ * wildcards.
+ *
+ * \param hg_class [IN]         pointer to HG class
+ * \param context [IN]          pointer to HG context
+ * \param id [IN]               RPC ID
+ * \param stats [OUT]           pointer to merged stats
+ */
+void
+hg_stats_get(
+        hg_class_t *hg_class,
+        hg_context_t *context,
+        hg_id_t id,
+        struct hg_stats *stats
+        );
+
+/**
+ * Reset stats of all thread shards. NULL context and HG_STATS_ANY act as
+ * wildcards.
+ *
+ * \param hg_class [IN]         pointer to HG class
+ * \param context [IN]          pointer to HG context
+ * \param id [IN]               RPC ID
+ */
+void
+hg_stats_reset(
+        hg_class_t *hg_class,
+        hg_context_t *context,
+        hg_id_t id
+        );
+
+/**
+ * Fold stats of a context that is being destroyed into the class stats, or
+ * stats of a class that is being finalized (NULL context) into the
+ * process-wide stats, so that a new object allocated at the same address
+ * starts from empty stats.
+ *
+ * \param hg_class [IN]         pointer to HG class
+ * \param context [IN]          pointer to HG context
+ */
+void
+hg_stats_retire(
+        hg_class_t *hg_class,
+        hg_context_t *context
+        );
+
+/**
+ * Get an upper bound of the value below which a given percentage of the
+ * histogram samples fall.
+ *
+ * \param hist [IN]             pointer to histogram
+ * \param percentile [IN]       percentile (between 0 and 100)
+ *
+ * \return Value in microseconds
+ */
+hg_uint64_t
+hg_stats_hist_percentile(
+        const struct hg_stats_hist *hist,
+        double percentile
+        );
+
+/**
+ * Print per-RPC stats.
+ */
+void
+hg_stats_print(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* MERCURY_STATS_H */
@@ -0,0 +1,300 @@
+/*
+ * Copyright (C) 2013-2017 Argonne National Laboratory, Department of Energy,
+ *                    UChicago Argonne, LLC and The HDF Group.
+ * All rights reserved.
+ *
+ * The full copyright notice, including terms governing use, modification,
+ * and redistribution, is contained in the COPYING file that can be
+ * found at the root of the source code distribution tree.
+ */
+
+#include "mercury_trace.h"
+#include "mercury_error.h"
+
+#include "mercury_atomic.h"
+#include "mercury_list.h"
+#include "mercury_thread.h"
+#include "mercury_thread_mutex.h"
+#include "mercury_time.h"
+
+#if defined(HG_UTIL_HAS_TIME_H) && defined(HG_UTIL_HAS_CLOCK_GETTIME)
+# include <time.h>
+#endif
+#ifdef _WIN32
+# include <process.h>
+#else
+# include <unistd.h>
+#endif
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/****************/
+/* Local Macros */
+/****************/
+
+#if (HG_TRACE_RING_SIZE & (HG_TRACE_RING_SIZE - 1)) != 0
+# error "HG_TRACE_RING_SIZE must be a power of two"
+#endif
+#define HG_TRACE_RING_MASK (HG_TRACE_RING_SIZE - 1)
+
+/* Init states */
+#define HG_TRACE_UNINIT     0
+#define HG_TRACE_INITING    1
+#define HG_TRACE_INITED     2
+#define HG_TRACE_FAILED     3
+
+/************************************/
+/* Local Type and Struct Definition */
+/************************************/
+
+/* Per-thread event ring */
+struct hg_trace_ring {
+    hg_atomic_int32_t index;            /* Index of next event (wraps) */
+    hg_bool_t full;                     /* Ring has wrapped once */
+    hg_uint32_t tid;                    /* Thread index */
+    HG_LIST_ENTRY(hg_trace_ring) entry; /* Entry in ring list */
+    struct hg_trace_event events[HG_TRACE_RING_SIZE]; /* Events */
+};
+
+/********************/
+/* Local Prototypes */
+/********************/
+
+/**
+ * Get monotonic time in nanoseconds.
+ */
+static HG_INLINE hg_uint64_t
+hg_trace_time(void);
+
+/**
+ * Get ring of calling thread, create it if needed.
+ */
+static struct hg_trace_ring *
+hg_trace_ring_get(void);
+
+/**
+ * Dump traces to file set by HG_TRACE_FILE at exit.
+ */
+static void
+hg_trace_dump_at_exit(void);
+
+/*******************/
+/* Local Variables */
+/*******************/
+
+static hg_atomic_int32_t hg_trace_init_g = HG_ATOMIC_VAR_INIT(HG_TRACE_UNINIT);
+static hg_atomic_int32_t hg_trace_tid_g = HG_ATOMIC_VAR_INIT(0);
+static hg_thread_key_t hg_trace_key_g;
+static hg_thread_mutex_t hg_trace_rings_mutex_g;
+static HG_LIST_HEAD(hg_trace_ring) hg_trace_rings_g =
+    HG_LIST_HEAD_INITIALIZER(hg_trace_rings_g);
+
+/*---------------------------------------------------------------------------*/
+static HG_INLINE hg_uint64_t
+hg_trace_time(void)
+{
+#if defined(HG_UTIL_HAS_TIME_H) && defined(HG_UTIL_HAS_CLOCK_GETTIME)
+    struct timespec tp;
+
+    /* Served from the vdso, without system call */
+    clock_gettime(CLOCK_MONOTONIC, &tp);
+    return (hg_uint64_t) tp.tv_sec * 1000000000ULL + (hg_uint64_t) tp.tv_nsec;
+#else
+    hg_time_t tv;
+
+    hg_time_get_current(&tv);
+    return (hg_uint64_t) tv.tv_sec * 1000000000ULL
+        + (hg_uint64_t) tv.tv_usec * 1000ULL;
+#endif
+}
+
+/*---------------------------------------------------------------------------*/
+static struct hg_trace_ring *
+hg_trace_ring_get(void)
+{
+    struct hg_trace_ring *ring;
+
+    ring = (struct hg_trace_ring *) hg_thread_getspecific(hg_trace_key_g);
+    if (ring)
+        goto done;
+
+    ring = (struct hg_trace_ring *) malloc(sizeof(struct hg_trace_ring));
+    if (!ring) {
+        HG_LOG_ERROR("Could not allocate trace ring");
+        goto done;
+    }
+    memset(ring, 0, sizeof(struct hg_trace_ring));
+    hg_atomic_init32(&ring->index, 0);
+    ring->tid = (hg_uint32_t) hg_atomic_incr32(&hg_trace_tid_g);
+
+    hg_thread_mutex_lock(&hg_trace_rings_mutex_g);
+    HG_LIST_INSERT_HEAD(&hg_trace_rings_g, ring, entry);
+    hg_thread_mutex_unlock(&hg_trace_rings_mutex_g);
+
+    hg_thread_setspecific(hg_trace_key_g, ring);
+
+done:
+    return ring;
+}
+
+/*---------------------------------------------------------------------------*/
+static void
+hg_trace_dump_at_exit(void)
+{
+    const char *filename = getenv(HG_TRACE_FILE_ENV);
+
+    if (filename && hg_trace_dump(filename) != HG_SUCCESS)
+        HG_LOG_ERROR("Could not dump traces to %s", filename);
+}
+
+/*---------------------------------------------------------------------------*/
+hg_return_t
+hg_trace_init(void)
+{
+    hg_bool_t owner = HG_FALSE, key_created = HG_FALSE;
+    hg_return_t ret = HG_SUCCESS;
+
+    /* A failed initialization can be retried */
+    if (!hg_atomic_cas32(&hg_trace_init_g, HG_TRACE_UNINIT, HG_TRACE_INITING)
+        && !hg_atomic_cas32(&hg_trace_init_g, HG_TRACE_FAILED,
+            HG_TRACE_INITING)) {
+        /* Someone else is initializing */
+        while (hg_atomic_get32(&hg_trace_init_g) == HG_TRACE_INITING)
+            continue;
+        if (hg_atomic_get32(&hg_trace_init_g) != HG_TRACE_INITED) {
+            HG_LOG_ERROR("Tracing initialization failed");
+            ret = HG_PROTOCOL_ERROR;
+        }
+        goto done;
+    }
+    owner = HG_TRUE;
+
+    if (hg_thread_key_create(&hg_trace_key_g) != HG_UTIL_SUCCESS) {
+        HG_LOG_ERROR("Could not create trace thread key");
+        ret = HG_NOMEM_ERROR;
+        goto done;
+    }
+    key_created = HG_TRUE;
+    hg_thread_mutex_init(&hg_trace_rings_mutex_g);
+
+    if (getenv(HG_TRACE_FILE_ENV) && atexit(hg_trace_dump_at_exit) != 0) {
+        HG_LOG_ERROR("Could not register hg_trace_dump_at_exit");
+        ret = HG_PROTOCOL_ERROR;
+        goto done;
+    }
+
+    hg_atomic_set32(&hg_trace_init_g, HG_TRACE_INITED);
+
+done:
+    if (owner && ret != HG_SUCCESS) {
+        /* Events are only recorded once initialized so no ring was created,
+         * release the key and mutex and let waiters fail */
+        if (key_created) {
+            hg_thread_mutex_destroy(&hg_trace_rings_mutex_g);
+            hg_thread_key_delete(hg_trace_key_g);
+        }
+        hg_atomic_set32(&hg_trace_init_g, HG_TRACE_FAILED);
+    }
+    return ret;
+}
+
+/*---------------------------------------------------------------------------*/
+void
+hg_trace_record(hg_trace_type_t type, const void *object, hg_id_t id,
+    hg_uint64_t arg)
+{
+    struct hg_trace_ring *ring;
+    struct hg_trace_event *event;
+    hg_uint32_t index;
+
+    if (hg_atomic_get32(&hg_trace_init_g) != HG_TRACE_INITED)
+        return;
+
+    ring = hg_trace_ring_get();
+    if (!ring)
+        return;
+
+    /* Only the owner thread writes, publish event once filled */
+    index = (hg_uint32_t) hg_atomic_get32(&ring->index);
+    event = &ring->events[index & HG_TRACE_RING_MASK];
+    event->time = hg_trace_time();
+    event->object = (hg_uint64_t) (size_t) object;
+    event->arg = arg;
+    event->id = id;
+    event->type = (hg_uint32_t) type;
+    if ((index & HG_TRACE_RING_MASK) == HG_TRACE_RING_MASK)
+        ring->full = HG_TRUE;
+    hg_atomic_set32(&ring->index, (hg_util_int32_t) (index + 1));
+}
+
+/*---------------------------------------------------------------------------*/
+hg_return_t
+hg_trace_dump(const char *filename)
+{
+    struct hg_trace_dump_header header;
+    struct hg_trace_ring *ring;
+    FILE *file = NULL;
+    hg_return_t ret = HG_SUCCESS;
+
+    if (hg_atomic_get32(&hg_trace_init_g) != HG_TRACE_INITED) {
+        HG_LOG_ERROR("Tracing was not initialized");
+        ret = HG_PROTOCOL_ERROR;
+        goto done;
+    }
+
+    file = fopen(filename, "wb");
+    if (!file) {
+        HG_LOG_ERROR("Could not open %s", filename);
+        ret = HG_INVALID_PARAM;
+        goto done;
+    }
+
+    hg_thread_mutex_lock(&hg_trace_rings_mutex_g);
+
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, HG_TRACE_DUMP_MAGIC, sizeof(header.magic));
+    header.event_size = (hg_uint32_t) sizeof(struct hg_trace_event);
+    HG_LIST_FOREACH(ring, &hg_trace_rings_g, entry)
+        header.thread_count++;
+#ifdef _WIN32
+    header.pid = (hg_uint64_t) _getpid();
+#else
+    header.pid = (hg_uint64_t) getpid();
+#endif
+    if (fwrite(&header, sizeof(header), 1, file) != 1)
+        ret = HG_PROTOCOL_ERROR;
+
+    HG_LIST_FOREACH(ring, &hg_trace_rings_g, entry) {
+        struct hg_trace_dump_thread thread;
+        hg_uint32_t index = (hg_uint32_t) hg_atomic_get32(&ring->index);
+        hg_uint32_t first = ring->full ? (index & HG_TRACE_RING_MASK) : 0;
+
+        if (ret != HG_SUCCESS)
+            break;
+
+        thread.tid = ring->tid;
+        thread.event_count = ring->full ? HG_TRACE_RING_SIZE : index;
+        if (fwrite(&thread, sizeof(thread), 1, file) != 1) {
+            ret = HG_PROTOCOL_ERROR;
+            break;
+        }
+
+        /* Write oldest events first */
+        if (fwrite(&ring->events[first], sizeof(struct hg_trace_event),
+                thread.event_count - first, file) != thread.event_count - first
+            || fwrite(ring->events, sizeof(struct hg_trace_event), first,
+                file) != first)
+            ret = HG_PROTOCOL_ERROR;
+    }
+
+    hg_thread_mutex_unlock(&hg_trace_rings_mutex_g);
+
+    if (ret != HG_SUCCESS)
+        HG_LOG_ERROR("Could not write to %s", filename);
+
+done:
+    if (file)
+        fclose(file);
+    return ret;
+}
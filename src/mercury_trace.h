@@ -0,0 +1,129 @@
+/*
+ * Copyright (C) 2013-2017 Argonne National Laboratory, Department of Energy,
+ *                    UChicago Argonne, LLC and The HDF Group.
+ * All rights reserved.
+ *
+ * The full copyright notice, including terms governing use, modification,
+ * and redistribution, is contained in the COPYING file that can be
+ * found at the root of the source code distribution tree.
+ */
+
+#ifndef MERCURY_TRACE_H
+#define MERCURY_TRACE_H
+
+#include "mercury_types.h"
+
+/*************************************/
+/* Public Type and Struct Definition */
+/*************************************/
+
+/* Trace event types */
+typedef enum {
+    HG_TRACE_CREATE,            /*!< handle created */
+    HG_TRACE_FORWARD,           /*!< RPC forwarded */
+    HG_TRACE_SEND_POST,         /*!< NA send posted */
+    HG_TRACE_SEND_COMPLETE,     /*!< NA send completed */
+    HG_TRACE_RECV_UNEXPECTED,   /*!< RPC request received */
+    HG_TRACE_RECV_EXPECTED,     /*!< RPC response received */
+    HG_TRACE_TRIGGER,           /*!< completion triggered */
+    HG_TRACE_RPC_BEGIN,         /*!< RPC callback entered */
+    HG_TRACE_RPC_END,           /*!< RPC callback returned */
+    HG_TRACE_RESPOND,           /*!< RPC response sent */
+    HG_TRACE_FORWARD_COMPLETE,  /*!< forward callback executed */
+    HG_TRACE_BULK_START,        /*!< bulk transfer started */
+    HG_TRACE_BULK_COMPLETE,     /*!< bulk transfer completed */
+    HG_TRACE_MAX
+} hg_trace_type_t;
+
+/* Trace event (as written into dump files) */
+struct hg_trace_event {
+    hg_uint64_t time;           /* Monotonic time in nanoseconds */
+    hg_uint64_t object;         /* Address of handle or bulk operation */
+    hg_uint64_t arg;            /* Event argument (size, return code) */
+    hg_uint32_t id;             /* RPC ID */
+    hg_uint32_t type;           /* Event type */
+};
+
+/* Dump file header, followed for each thread by an hg_trace_dump_thread
+ * header and its events in chronological order */
+#define HG_TRACE_DUMP_MAGIC "HGTRACE1"
+
+struct hg_trace_dump_header {
+    char magic[8];              /* HG_TRACE_DUMP_MAGIC */
+    hg_uint32_t event_size;     /* sizeof(struct hg_trace_event) */
+    hg_uint32_t thread_count;   /* Number of threads */
+    hg_uint64_t pid;            /* Process ID */
+};
+
+struct hg_trace_dump_thread {
+    hg_uint32_t tid;            /* Thread index */
+    hg_uint32_t event_count;    /* Number of events */
+};
+
+/*****************/
+/* Public Macros */
+/*****************/
+
+/* Environment variable naming the file that traces are dumped to at exit */
+#define HG_TRACE_FILE_ENV "HG_TRACE_FILE"
+
+#ifdef HG_HAS_TRACE
+# define HG_TRACE(type, object, id, arg) \
+    hg_trace_record(type, (const void *) (object), id, (hg_uint64_t) (arg))
+#else
+# define HG_TRACE(type, object, id, arg) (void) 0
+#endif
+
+/*********************/
+/* Public Prototypes */
+/*********************/
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * Initialize tracing. If HG_TRACE_FILE is set, traces are dumped to that
+ * file when the process exits.
+ *
+ * \return HG_SUCCESS or corresponding HG error code
+ */
+hg_return_t
+hg_trace_init(void);
+
+/**
+ * Record event into the ring buffer of the calling thread. Rings have a
+ * single writer and are never locked, older events get overwritten once
+ * HG_TRACE_RING_SIZE events have been recorded.
+ *
+ * \param type [IN]             event type
+ * \param object [IN]           handle or operation the event refers to
+ * \param id [IN]               RPC ID
+ * \param arg [IN]              event argument
+ */
+void
+hg_trace_record(
+        hg_trace_type_t type,
+        const void *object,
+        hg_id_t id,
+        hg_uint64_t arg
+        );
+
+/**
+ * Dump events of all threads to file. Events recorded concurrently may
+ * appear partially written in the dump.
+ *
+ * \param filename [IN]         file name
+ *
+ * \return HG_SUCCESS or corresponding HG error code
+ */
+hg_return_t
+hg_trace_dump(
+        const char *filename
+        );
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* MERCURY_TRACE_H */
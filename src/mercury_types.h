@@ -35,6 +35,8 @@ struct hg_init_info {
     na_class_t *na_class;               /* NA class */
     hg_bool_t auto_sm;                  /* Use NA SM plugin with local addrs */
     hg_bool_t stats;                    /* (Debug) Print stats at exit */
+    hg_bool_t addr_cache;               /* Cache addrs looked up by name */
+    unsigned int addr_cache_neg_ttl;    /* Time failed lookups are cached (ms) */
 };
 
 /* HG info struct */
@@ -86,7 +88,8 @@ typedef enum hg_return {
     HG_NO_MATCH,        /*!< no function match */
     HG_CHECKSUM_ERROR,  /*!< checksum error */
     HG_CANCELED,        /*!< operation was canceled */
-    HG_OTHER_ERROR      /*!< error from mercury_util or external to mercury */
+    HG_OTHER_ERROR,     /*!< error from mercury_util or external to mercury */
+    HG_BUSY             /*!< target is overloaded */
 } hg_return_t;
 
 /* Callback operation type */
@@ -97,6 +100,13 @@ typedef enum hg_cb_type {
     HG_CB_BULK          /*!< bulk transfer callback */
 } hg_cb_type_t;
 
+/* RPC handler priority, used when RPC callbacks are run by handler threads */
+typedef enum hg_handler_priority {
+    HG_HANDLER_NORMAL,  /*!< run by handler threads */
+    HG_HANDLER_HIGH,    /*!< run by handler threads before normal handlers */
+    HG_HANDLER_INLINE   /*!< run by the thread calling HG_Trigger() */
+} hg_handler_priority_t;
+
 /* Callback info structs */
 struct hg_cb_info_lookup {
     hg_addr_t addr;     /* HG address */
@@ -135,6 +145,54 @@ typedef hg_return_t (*hg_cb_t)(const struct hg_cb_info *callback_info);
 /* Proc callback for serializing/deserializing parameters */
 typedef hg_return_t (*hg_proc_cb_t)(hg_proc_t proc, void *data);
 
+/* Log-linear latency histogram: values below 2^HG_STATS_HIST_SUB_BITS get
+ * their own bucket, each following power of two is split into
+ * 2^HG_STATS_HIST_SUB_BITS linear buckets */
+#define HG_STATS_HIST_SUB_BITS  2
+#define HG_STATS_HIST_MAX_BITS  32
+#define HG_STATS_HIST_BUCKETS   \
+    ((HG_STATS_HIST_MAX_BITS - HG_STATS_HIST_SUB_BITS + 1) \
+        << HG_STATS_HIST_SUB_BITS)
+
+/* Stats histogram struct (values in microseconds) */
+struct hg_stats_hist {
+    hg_uint64_t count;                          /* Number of samples */
+    hg_uint64_t sum;                            /* Sum of samples */
+    hg_uint64_t min;                            /* Min sample */
+    hg_uint64_t max;                            /* Max sample */
+    hg_uint64_t buckets[HG_STATS_HIST_BUCKETS]; /* Sample counts */
+};
+
+/* Stats struct */
+struct hg_stats {
+    hg_uint64_t forward_count;          /* RPCs forwarded (origin) */
+    hg_uint64_t forward_error_count;    /* RPCs completed with error (origin) */
+    hg_uint64_t recv_count;             /* RPCs received (target) */
+    hg_uint64_t recv_extra_count;       /* RPCs received with overflow */
+    hg_uint64_t respond_count;          /* RPCs responded (target) */
+    hg_uint64_t bulk_count;             /* Bulk transfers completed */
+    struct hg_stats_hist queue_time;    /* NA completion to RPC callback */
+    struct hg_stats_hist handler_time;  /* RPC callback to response */
+    struct hg_stats_hist forward_time;  /* Forward to forward callback */
+};
+
+/* Progress accounting struct (times in microseconds) */
+struct hg_progress_stats {
+    hg_uint64_t progress_count;     /* Calls to HG_Progress() */
+    hg_uint64_t empty_count;        /* Calls that progressed nothing */
+    hg_uint64_t progress_time;      /* Time spent in HG_Progress() */
+    hg_uint64_t empty_time;         /* Time spent in calls that progressed nothing */
+    hg_uint64_t wait_time;          /* Time blocked in system poll calls */
+    hg_uint64_t na_progress_time;   /* Time in NA plugin progress (no wait) */
+    hg_uint64_t na_trigger_count;   /* NA callbacks executed */
+    hg_uint64_t na_trigger_time;    /* Time spent in NA callbacks */
+    hg_uint64_t trigger_count;      /* Callbacks executed by HG_Trigger() */
+    hg_uint64_t trigger_time;       /* Time spent in those callbacks */
+    hg_uint64_t batch_count;        /* Messages of coalesced forwards sent */
+    hg_uint64_t batch_rpc_count;    /* Forwards sent in those messages */
+    hg_uint64_t header_reuse_count; /* Forwards that kept a prepared header */
+};
+
 /*****************/
 /* Public Macros */
 /*****************/
@@ -146,6 +204,8 @@ typedef hg_return_t (*hg_proc_cb_t)(hg_proc_t proc, void *data);
 #define HG_PROC_NULL        ((hg_proc_t)0)
 #define HG_OP_ID_NULL       ((hg_op_id_t)0)
 #define HG_OP_ID_IGNORE     ((hg_op_id_t *)1)
+#define HG_STATS_ANY        ((hg_id_t)-1)
+#define HG_HANDLER_ANY_THREAD ((unsigned int)-1)
 
 /* Max timeout */
 #define HG_MAX_IDLE_TIME    (3600*1000)
@@ -159,4 +219,13 @@ typedef hg_return_t (*hg_proc_cb_t)(hg_proc_t proc, void *data);
 #define HG_BULK_WRITE_ONLY  0x02
 #define HG_BULK_READWRITE   0x03
 
+/* Eager flags used when serializing a bulk handle: HG_BULK_EAGER encodes the
+ * data of read only regions along the handle, HG_BULK_EAGER_PUSH lets small
+ * write regions have their pushed data returned with the RPC response,
+ * HG_BULK_EAGER_PUSH_RW extends it to read/write regions, whose data must
+ * then be encoded as well */
+#define HG_BULK_EAGER         0x01
+#define HG_BULK_EAGER_PUSH    0x02
+#define HG_BULK_EAGER_PUSH_RW 0x04
+
 #endif /* MERCURY_TYPES_H */
@@ -41,6 +41,11 @@
 
 #define NA_PROGRESS_LOCK 0x80000000 /* 32-bit lock value for serial progress */
 
+/* Elapsed time in microseconds */
+#define NA_USEC(t1, t2) \
+    ((hg_util_int64_t) (hg_time_to_double(hg_time_subtract(t2, t1)) \
+        * 1000000.0))
+
 /************************************/
 /* Local Type and Struct Definition */
 /************************************/
@@ -52,6 +57,18 @@ struct na_private_class {
     na_progress_mode_t progress_mode;           /* NA progress mode */
 };
 
+/* Progress accounting counters (times in microseconds) */
+struct na_progress_acct {
+    hg_atomic_int32_t enabled;                  /* Accounting enabled */
+    hg_atomic_int64_t progress_count;           /* NA_Progress() calls */
+    hg_atomic_int64_t empty_count;              /* Calls that timed out */
+    hg_atomic_int64_t progress_time;            /* Time in NA_Progress() */
+    hg_atomic_int64_t empty_time;               /* Time in calls that timed out */
+    hg_atomic_int64_t trigger_count;            /* Callbacks triggered */
+    hg_atomic_int64_t trigger_time;             /* Time in callbacks */
+    hg_atomic_int64_t wait_time_base;           /* Plugin wait time at reset */
+};
+
 /* Private context / do not expose private members to plugins */
 struct na_private_context {
     struct na_context context;                  /* Must remain as first field */
@@ -67,6 +84,7 @@ struct na_private_context {
     hg_thread_cond_t  progress_cond;            /* Progress cond */
     hg_atomic_int32_t progressing;              /* Progressing count */
 #endif
+    struct na_progress_acct acct;               /* Progress accounting */
 };
 
 /********************/
@@ -92,6 +110,13 @@ static void
 na_info_print(struct na_info *na_info);
 #endif
 
+/* Reset progress accounting */
+static void
+na_progress_acct_reset(
+    na_class_t *na_class,
+    struct na_private_context *na_private_context
+    );
+
 /*******************/
 /* Local Variables */
 /*******************/
@@ -258,6 +283,25 @@ na_info_print(struct na_info *na_info)
 }
 #endif
 
+/*---------------------------------------------------------------------------*/
+static void
+na_progress_acct_reset(na_class_t *na_class,
+    struct na_private_context *na_private_context)
+{
+    struct na_progress_acct *acct = &na_private_context->acct;
+    na_uint64_t wait_time = (na_class->na_poll_wait_time) ?
+        na_class->na_poll_wait_time(na_class,
+            (na_context_t *) na_private_context) : 0;
+
+    hg_atomic_set64(&acct->progress_count, 0);
+    hg_atomic_set64(&acct->empty_count, 0);
+    hg_atomic_set64(&acct->progress_time, 0);
+    hg_atomic_set64(&acct->empty_time, 0);
+    hg_atomic_set64(&acct->trigger_count, 0);
+    hg_atomic_set64(&acct->trigger_time, 0);
+    hg_atomic_set64(&acct->wait_time_base, (hg_util_int64_t) wait_time);
+}
+
 /*---------------------------------------------------------------------------*/
 na_class_t *
 NA_Initialize(const char *info_string, na_bool_t listen)
@@ -566,6 +610,9 @@ NA_Context_create(na_class_t *na_class)
     hg_atomic_init32(&na_private_context->progressing, 0);
 #endif
 
+    /* Progress accounting is disabled by default */
+    hg_atomic_init32(&na_private_context->acct.enabled, 0);
+
 done:
     if (ret != NA_SUCCESS) {
         free(na_private_context);
@@ -1316,6 +1363,102 @@ done:
     return ret;
 }
 
+/*---------------------------------------------------------------------------*/
+na_return_t
+NA_Msg_send_unexpected_segments(na_class_t *na_class, na_context_t *context,
+    na_cb_t callback, void *arg, const struct na_segment *segments,
+    na_size_t segment_count, void *plugin_data, na_addr_t dest, na_tag_t tag,
+    na_op_id_t *op_id)
+{
+    na_return_t ret = NA_SUCCESS;
+
+    if (!na_class) {
+        NA_LOG_ERROR("NULL NA class");
+        ret = NA_INVALID_PARAM;
+        goto done;
+    }
+    if (!context) {
+        NA_LOG_ERROR("NULL context");
+        ret = NA_INVALID_PARAM;
+        goto done;
+    }
+    if (!segments) {
+        NA_LOG_ERROR("NULL segments");
+        ret = NA_INVALID_PARAM;
+        goto done;
+    }
+    if (!segment_count) {
+        NA_LOG_ERROR("NULL segment count");
+        ret = NA_INVALID_PARAM;
+        goto done;
+    }
+    if (dest == NA_ADDR_NULL) {
+        NA_LOG_ERROR("NULL NA address");
+        ret = NA_INVALID_PARAM;
+        goto done;
+    }
+    if (!na_class->msg_send_unexpected_segments) {
+        NA_LOG_ERROR("msg_send_unexpected_segments plugin callback is not "
+            "defined");
+        ret = NA_PROTOCOL_ERROR;
+        goto done;
+    }
+
+    ret = na_class->msg_send_unexpected_segments(na_class, context, callback,
+        arg, segments, segment_count, plugin_data, dest, tag, op_id);
+
+done:
+    return ret;
+}
+
+/*---------------------------------------------------------------------------*/
+na_return_t
+NA_Msg_send_expected_segments(na_class_t *na_class, na_context_t *context,
+    na_cb_t callback, void *arg, const struct na_segment *segments,
+    na_size_t segment_count, void *plugin_data, na_addr_t dest, na_tag_t tag,
+    na_op_id_t *op_id)
+{
+    na_return_t ret = NA_SUCCESS;
+
+    if (!na_class) {
+        NA_LOG_ERROR("NULL NA class");
+        ret = NA_INVALID_PARAM;
+        goto done;
+    }
+    if (!context) {
+        NA_LOG_ERROR("NULL context");
+        ret = NA_INVALID_PARAM;
+        goto done;
+    }
+    if (!segments) {
+        NA_LOG_ERROR("NULL segments");
+        ret = NA_INVALID_PARAM;
+        goto done;
+    }
+    if (!segment_count) {
+        NA_LOG_ERROR("NULL segment count");
+        ret = NA_INVALID_PARAM;
+        goto done;
+    }
+    if (dest == NA_ADDR_NULL) {
+        NA_LOG_ERROR("NULL NA address");
+        ret = NA_INVALID_PARAM;
+        goto done;
+    }
+    if (!na_class->msg_send_expected_segments) {
+        NA_LOG_ERROR("msg_send_expected_segments plugin callback is not "
+            "defined");
+        ret = NA_PROTOCOL_ERROR;
+        goto done;
+    }
+
+    ret = na_class->msg_send_expected_segments(na_class, context, callback,
+        arg, segments, segment_count, plugin_data, dest, tag, op_id);
+
+done:
+    return ret;
+}
+
 /*---------------------------------------------------------------------------*/
 na_return_t
 NA_Mem_handle_create(na_class_t *na_class, void *buf, na_size_t buf_size,
@@ -1802,6 +1945,8 @@ NA_Progress(na_class_t *na_class, na_context_t *context, unsigned int timeout)
 #ifdef NA_HAS_MULTI_PROGRESS
     hg_util_int32_t old, num;
 #endif
+    hg_time_t acct_start = {0, 0};
+    na_bool_t acct = NA_FALSE;
     na_return_t ret = NA_TIMEOUT;
 
     if (!na_class) {
@@ -1820,6 +1965,11 @@ NA_Progress(na_class_t *na_class, na_context_t *context, unsigned int timeout)
         goto done;
     }
 
+    if (hg_atomic_get32(&na_private_context->acct.enabled)) {
+        acct = NA_TRUE;
+        hg_time_get_current(&acct_start);
+    }
+
     /* Do not block if NA_NO_BLOCK option is passed */
     if (na_private_class->progress_mode == NA_NO_BLOCK) {
         timeout = 0;
@@ -1904,6 +2054,19 @@ unlock:
 #endif
 
 done:
+    if (acct && (ret == NA_SUCCESS || ret == NA_TIMEOUT)) {
+        hg_time_t acct_end;
+        hg_util_int64_t elapsed;
+
+        hg_time_get_current(&acct_end);
+        elapsed = NA_USEC(acct_start, acct_end);
+        hg_atomic_incr64(&na_private_context->acct.progress_count);
+        hg_atomic_add64(&na_private_context->acct.progress_time, elapsed);
+        if (ret == NA_TIMEOUT) {
+            hg_atomic_incr64(&na_private_context->acct.empty_count);
+            hg_atomic_add64(&na_private_context->acct.empty_time, elapsed);
+        }
+    }
     return ret;
 }
 
@@ -1916,6 +2079,8 @@ NA_Trigger(na_context_t *context, unsigned int timeout, unsigned int max_count,
     struct na_private_context *na_private_context =
         (struct na_private_context *) context;
     double remaining;
+    hg_time_t acct_start;
+    na_bool_t acct;
     na_return_t ret = NA_SUCCESS;
     unsigned int count = 0;
 
@@ -1924,6 +2089,7 @@ NA_Trigger(na_context_t *context, unsigned int timeout, unsigned int max_count,
         ret = NA_INVALID_PARAM;
         goto done;
     }
+    acct = (na_bool_t) hg_atomic_get32(&na_private_context->acct.enabled);
 
     /* Do not block if NA_NO_BLOCK option is passed */
     na_private_class = (struct na_private_class *) na_private_context->na_class;
@@ -2003,6 +2169,9 @@ NA_Trigger(na_context_t *context, unsigned int timeout, unsigned int max_count,
             goto done;
         }
 
+        if (acct)
+            hg_time_get_current(&acct_start);
+
         /* Execute callback */
         if (completion_data->callback) {
             int cb_ret =
@@ -2021,6 +2190,15 @@ NA_Trigger(na_context_t *context, unsigned int timeout, unsigned int max_count,
             completion_data->plugin_callback(
                 completion_data->plugin_callback_args);
 
+        if (acct) {
+            hg_time_t acct_end;
+
+            hg_time_get_current(&acct_end);
+            hg_atomic_incr64(&na_private_context->acct.trigger_count);
+            hg_atomic_add64(&na_private_context->acct.trigger_time,
+                NA_USEC(acct_start, acct_end));
+        }
+
         count++;
     }
 
@@ -2030,6 +2208,101 @@ done:
     return ret;
 }
 
+/*---------------------------------------------------------------------------*/
+na_return_t
+NA_Progress_stats_enable(na_class_t *na_class, na_context_t *context,
+    na_bool_t enable)
+{
+    struct na_private_context *na_private_context =
+        (struct na_private_context *) context;
+    na_return_t ret = NA_SUCCESS;
+
+    if (!na_class) {
+        NA_LOG_ERROR("NULL NA class");
+        ret = NA_INVALID_PARAM;
+        goto done;
+    }
+    if (!context) {
+        NA_LOG_ERROR("NULL context");
+        ret = NA_INVALID_PARAM;
+        goto done;
+    }
+
+    if (enable)
+        na_progress_acct_reset(na_class, na_private_context);
+    hg_atomic_set32(&na_private_context->acct.enabled, (enable) ? 1 : 0);
+
+done:
+    return ret;
+}
+
+/*---------------------------------------------------------------------------*/
+na_return_t
+NA_Progress_stats_get(na_class_t *na_class, na_context_t *context,
+    struct na_progress_stats *stats)
+{
+    struct na_private_context *na_private_context =
+        (struct na_private_context *) context;
+    struct na_progress_acct *acct;
+    na_return_t ret = NA_SUCCESS;
+
+    if (!na_class) {
+        NA_LOG_ERROR("NULL NA class");
+        ret = NA_INVALID_PARAM;
+        goto done;
+    }
+    if (!context) {
+        NA_LOG_ERROR("NULL context");
+        ret = NA_INVALID_PARAM;
+        goto done;
+    }
+    if (!stats) {
+        NA_LOG_ERROR("NULL pointer to stats");
+        ret = NA_INVALID_PARAM;
+        goto done;
+    }
+
+    acct = &na_private_context->acct;
+    stats->progress_count =
+        (na_uint64_t) hg_atomic_get64(&acct->progress_count);
+    stats->empty_count = (na_uint64_t) hg_atomic_get64(&acct->empty_count);
+    stats->progress_time = (na_uint64_t) hg_atomic_get64(&acct->progress_time);
+    stats->empty_time = (na_uint64_t) hg_atomic_get64(&acct->empty_time);
+    stats->trigger_count = (na_uint64_t) hg_atomic_get64(&acct->trigger_count);
+    stats->trigger_time = (na_uint64_t) hg_atomic_get64(&acct->trigger_time);
+    stats->wait_time = 0;
+    if (na_class->na_poll_wait_time
+        && hg_atomic_get32(&acct->enabled))
+        stats->wait_time = na_class->na_poll_wait_time(na_class, context)
+            - (na_uint64_t) hg_atomic_get64(&acct->wait_time_base);
+
+done:
+    return ret;
+}
+
+/*---------------------------------------------------------------------------*/
+na_return_t
+NA_Progress_stats_reset(na_class_t *na_class, na_context_t *context)
+{
+    na_return_t ret = NA_SUCCESS;
+
+    if (!na_class) {
+        NA_LOG_ERROR("NULL NA class");
+        ret = NA_INVALID_PARAM;
+        goto done;
+    }
+    if (!context) {
+        NA_LOG_ERROR("NULL context");
+        ret = NA_INVALID_PARAM;
+        goto done;
+    }
+
+    na_progress_acct_reset(na_class, (struct na_private_context *) context);
+
+done:
+    return ret;
+}
+
 /*---------------------------------------------------------------------------*/
 na_return_t
 NA_Cancel(na_class_t *na_class, na_context_t *context, na_op_id_t op_id)
@@ -2079,6 +2352,7 @@ NA_Error_to_string(na_return_t errnum)
     NA_ERROR_STRING_MACRO(NA_NOMEM_ERROR, errnum, na_error_string);
     NA_ERROR_STRING_MACRO(NA_PROTOCOL_ERROR, errnum, na_error_string);
     NA_ERROR_STRING_MACRO(NA_ADDRINUSE_ERROR, errnum, na_error_string);
+    NA_ERROR_STRING_MACRO(NA_NOENTRY_ERROR, errnum, na_error_string);
 
     return na_error_string;
 }
@@ -39,6 +39,7 @@ typedef enum na_progress_mode {
 struct na_init_info {
     na_progress_mode_t progress_mode;   /* Progress mode */
     const char *auth_key;               /* Authorization key */
+    na_bool_t sm_shared_recv;           /* SM: one inbound ring for all peers */
 };
 
 /* Segment */
@@ -47,6 +48,17 @@ struct na_segment {
     na_size_t size;     /* Size of the segment in bytes */
 };
 
+/* Progress accounting (times in microseconds) */
+struct na_progress_stats {
+    na_uint64_t progress_count; /* Calls to NA_Progress() */
+    na_uint64_t empty_count;    /* Calls to NA_Progress() that timed out */
+    na_uint64_t progress_time;  /* Time spent in NA_Progress() */
+    na_uint64_t empty_time;     /* Time spent in calls that timed out */
+    na_uint64_t wait_time;      /* Time blocked in system poll calls */
+    na_uint64_t trigger_count;  /* Callbacks executed by NA_Trigger() */
+    na_uint64_t trigger_time;   /* Time spent in those callbacks */
+};
+
 /* Error return codes:
  * Functions return 0 for success or NA_XXX_ERROR for failure */
 typedef enum na_return {
@@ -59,7 +71,8 @@ typedef enum na_return {
     NA_NOMEM_ERROR,         /*!< no memory error */
     NA_PROTOCOL_ERROR,      /*!< unknown error reported from the protocol layer */
     NA_CANCELED,            /*!< operation was canceled */
-    NA_ADDRINUSE_ERROR      /*!< address already in use */
+    NA_ADDRINUSE_ERROR,     /*!< address already in use */
+    NA_NOENTRY_ERROR        /*!< address does not exist */
 } na_return_t;
 
 /* Callback operation type */
@@ -123,6 +136,7 @@ typedef int (*na_cb_t)(const struct na_cb_info *callback_info);
 
 /* Supported features */
 #define NA_HAS_TAG_MASK    0x01
+#define NA_HAS_MSG_SEGMENTS 0x02
 
 /*********************/
 /* Public Prototypes */
@@ -232,6 +246,7 @@ NA_Is_listening(
  * Test whether NA feature is supported by plugin or not.
  * List of queryable features are:
  *      - NA_HAS_TAG_MASK
+ *      - NA_HAS_MSG_SEGMENTS
  *
  * \param na_class [IN/OUT]     pointer to NA class
  * \param feature  [IN]         ID of requested feature
@@ -721,6 +736,80 @@ NA_Msg_recv_expected(
         na_op_id_t   *op_id
         );
 
+/**
+ * Send an unexpected message to dest, gathering its content from a list of
+ * segments so that headers and payload do not need to be contiguous. The
+ * first segment must point to a buffer returned by NA_Msg_buf_alloc() and
+ * initialized with NA_Msg_init_unexpected(), plugin_data refers to that
+ * buffer. The total size of all segments must not exceed
+ * NA_Msg_get_max_unexpected_size(). Plugins may bound the number of
+ * segments and return NA_SIZE_ERROR above it, up to 8 segments are always
+ * accepted. The segment array itself may be released once the call returns
+ * but the memory it describes must remain valid until completion. Support for this call can be queried with NA_Check_feature()
+ * and NA_HAS_MSG_SEGMENTS. See NA_Msg_send_unexpected() for other semantics.
+ *
+ * \param na_class [IN/OUT]     pointer to NA class
+ * \param context [IN/OUT]      pointer to context of execution
+ * \param callback [IN]         pointer to function callback
+ * \param arg [IN]              pointer to data passed to callback
+ * \param segments [IN]         pointer to array of segments
+ * \param segment_count [IN]    number of segments
+ * \param plugin_data [IN]      pointer to internal plugin data
+ * \param dest [IN]             abstract address of destination
+ * \param tag [IN]              tag attached to message
+ * \param op_id [IN/OUT]        pointer to operation ID
+ *
+ * \return NA_SUCCESS or corresponding NA error code
+ */
+NA_EXPORT na_return_t
+NA_Msg_send_unexpected_segments(
+        na_class_t              *na_class,
+        na_context_t            *context,
+        na_cb_t                  callback,
+        void                    *arg,
+        const struct na_segment *segments,
+        na_size_t                segment_count,
+        void                    *plugin_data,
+        na_addr_t                dest,
+        na_tag_t                 tag,
+        na_op_id_t              *op_id
+        );
+
+/**
+ * Send an expected message to dest, gathering its content from a list of
+ * segments. The first segment must point to a buffer returned by
+ * NA_Msg_buf_alloc() and initialized with NA_Msg_init_expected(), the total
+ * size of all segments must not exceed NA_Msg_get_max_expected_size().
+ * See NA_Msg_send_unexpected_segments() and NA_Msg_send_expected() for other
+ * semantics.
+ *
+ * \param na_class [IN/OUT]     pointer to NA class
+ * \param context [IN/OUT]      pointer to context of execution
+ * \param callback [IN]         pointer to function callback
+ * \param arg [IN]              pointer to data passed to callback
+ * \param segments [IN]         pointer to array of segments
+ * \param segment_count [IN]    number of segments
+ * \param plugin_data [IN]      pointer to internal plugin data
+ * \param dest [IN]             abstract address of destination
+ * \param tag [IN]              tag attached to message
+ * \param op_id [IN/OUT]        pointer to operation ID
+ *
+ * \return NA_SUCCESS or corresponding NA error code
+ */
+NA_EXPORT na_return_t
+NA_Msg_send_expected_segments(
+        na_class_t              *na_class,
+        na_context_t            *context,
+        na_cb_t                  callback,
+        void                    *arg,
+        const struct na_segment *segments,
+        na_size_t                segment_count,
+        void                    *plugin_data,
+        na_addr_t                dest,
+        na_tag_t                 tag,
+        na_op_id_t              *op_id
+        );
+
 /**
  * Create memory handle for RMA operations.
  * For non-contiguous memory, use NA_Mem_handle_create_segments() instead.
@@ -1058,6 +1147,59 @@ NA_Trigger(
         unsigned int *actual_count
         );
 
+/**
+ * Enable or disable progress accounting on a context. Accounting is disabled
+ * by default as it requires reading the clock around every NA_Progress() call
+ * and every callback executed by NA_Trigger(). Enabling it resets the stats.
+ *
+ * \param na_class [IN/OUT]     pointer to NA class
+ * \param context [IN/OUT]      pointer to context of execution
+ * \param enable [IN]           enable / disable accounting
+ *
+ * \return NA_SUCCESS or corresponding NA error code
+ */
+NA_EXPORT na_return_t
+NA_Progress_stats_enable(
+        na_class_t   *na_class,
+        na_context_t *context,
+        na_bool_t     enable
+        );
+
+/**
+ * Get progress accounting of a context: time spent in NA_Progress(), split
+ * between time blocked in the plugin's system poll call (e.g., epoll_wait(),
+ * if the plugin reports it) and time spent making progress, time wasted in
+ * calls that did not complete anything, and time spent in callbacks executed
+ * by NA_Trigger(). Plugins that share a poll set between contexts report the
+ * wait time of the whole class.
+ *
+ * \param na_class [IN/OUT]     pointer to NA class
+ * \param context [IN/OUT]      pointer to context of execution
+ * \param stats [OUT]           pointer to returned stats
+ *
+ * \return NA_SUCCESS or corresponding NA error code
+ */
+NA_EXPORT na_return_t
+NA_Progress_stats_get(
+        na_class_t               *na_class,
+        na_context_t             *context,
+        struct na_progress_stats *stats
+        );
+
+/**
+ * Reset progress accounting of a context.
+ *
+ * \param na_class [IN/OUT]     pointer to NA class
+ * \param context [IN/OUT]      pointer to context of execution
+ *
+ * \return NA_SUCCESS or corresponding NA error code
+ */
+NA_EXPORT na_return_t
+NA_Progress_stats_reset(
+        na_class_t   *na_class,
+        na_context_t *context
+        );
+
 /**
  * Cancel an ongoing operation.
  *
@@ -38,6 +38,9 @@
 #define NA_BMI_UNEXPECTED_SIZE 4096
 #define NA_BMI_EXPECTED_SIZE   NA_BMI_UNEXPECTED_SIZE
 
+/* Max number of segments per message */
+#define NA_BMI_MAX_SEGMENTS 8
+
 /* Max tag */
 #define NA_BMI_MAX_TAG (NA_TAG_UB >> 2)
 
@@ -95,6 +98,8 @@ struct na_bmi_info_lookup {
 
 struct na_bmi_info_send_unexpected {
     bmi_op_id_t op_id; /* BMI operation ID */
+    const void *buffer_list[NA_BMI_MAX_SEGMENTS]; /* Segment buffers */
+    bmi_size_t size_list[NA_BMI_MAX_SEGMENTS];    /* Segment sizes */
 };
 
 struct na_bmi_info_recv_unexpected {
@@ -105,6 +110,8 @@ struct na_bmi_info_recv_unexpected {
 
 struct na_bmi_info_send_expected {
     bmi_op_id_t op_id; /* BMI operation ID */
+    const void *buffer_list[NA_BMI_MAX_SEGMENTS]; /* Segment buffers */
+    bmi_size_t size_list[NA_BMI_MAX_SEGMENTS];    /* Segment sizes */
 };
 
 struct na_bmi_info_recv_expected {
@@ -192,6 +199,13 @@ na_bmi_finalize(
         na_class_t *na_class
         );
 
+/* check_feature */
+static na_bool_t
+na_bmi_check_feature(
+        na_class_t *na_class,
+        na_uint8_t  feature
+        );
+
 static na_return_t
 na_bmi_context_create(
         na_class_t          *na_class,
@@ -297,6 +311,21 @@ na_bmi_msg_send_unexpected(
         na_op_id_t   *op_id
         );
 
+/* msg_send_unexpected_segments */
+static na_return_t
+na_bmi_msg_send_unexpected_segments(
+        na_class_t              *na_class,
+        na_context_t            *context,
+        na_cb_t                  callback,
+        void                    *arg,
+        const struct na_segment *segments,
+        na_size_t                segment_count,
+        void                    *plugin_data,
+        na_addr_t                dest,
+        na_tag_t                 tag,
+        na_op_id_t              *op_id
+        );
+
 /* msg_recv_unexpected */
 static na_return_t
 na_bmi_msg_recv_unexpected(
@@ -326,6 +355,21 @@ na_bmi_msg_send_expected(
         na_op_id_t   *op_id
         );
 
+/* msg_send_expected_segments */
+static na_return_t
+na_bmi_msg_send_expected_segments(
+        na_class_t              *na_class,
+        na_context_t            *context,
+        na_cb_t                  callback,
+        void                    *arg,
+        const struct na_segment *segments,
+        na_size_t                segment_count,
+        void                    *plugin_data,
+        na_addr_t                dest,
+        na_tag_t                 tag,
+        na_op_id_t              *op_id
+        );
+
 /* msg_recv_expected */
 static na_return_t
 na_bmi_msg_recv_expected(
@@ -508,7 +552,7 @@ const na_class_t na_bmi_class_g = {
         na_bmi_initialize,                    /* initialize */
         na_bmi_finalize,                      /* finalize */
         NULL,                                 /* cleanup */
-        NULL,                                 /* check_feature */
+        na_bmi_check_feature,                 /* check_feature */
         na_bmi_context_create,                /* context_create */
         na_bmi_context_destroy,               /* context_destroy */
         na_bmi_op_create,                     /* op_create */
@@ -532,6 +576,8 @@ const na_class_t na_bmi_class_g = {
         NULL,                                 /* msg_init_expected */
         na_bmi_msg_send_expected,             /* msg_send_expected */
         na_bmi_msg_recv_expected,             /* msg_recv_expected */
+        na_bmi_msg_send_unexpected_segments,  /* msg_send_unexpected_segments */
+        na_bmi_msg_send_expected_segments,    /* msg_send_expected_segments */
         na_bmi_mem_handle_create,             /* mem_handle_create */
         NULL,                                 /* mem_handle_create_segment */
         na_bmi_mem_handle_free,               /* mem_handle_free */
@@ -546,6 +592,7 @@ const na_class_t na_bmi_class_g = {
         na_bmi_get,                           /* get */
         NULL,                                 /* poll_get_fd */
         NULL,                                 /* poll_try_wait */
+        NULL,                                 /* poll_wait_time */
         na_bmi_progress,                      /* progress */
         na_bmi_cancel                         /* cancel */
 };
@@ -783,6 +830,23 @@ done:
     return ret;
 }
 
+/*---------------------------------------------------------------------------*/
+static na_bool_t
+na_bmi_check_feature(na_class_t NA_UNUSED *na_class, na_uint8_t feature)
+{
+    na_bool_t ret = NA_FALSE;
+
+    switch (feature) {
+        case NA_HAS_MSG_SEGMENTS:
+            ret = NA_TRUE;
+            break;
+        default:
+            break;
+    }
+
+    return ret;
+}
+
 /*---------------------------------------------------------------------------*/
 static na_return_t
 na_bmi_context_create(na_class_t NA_UNUSED *na_class, void **context)
@@ -1159,6 +1223,96 @@ done:
     return ret;
 }
 
+/*---------------------------------------------------------------------------*/
+static na_return_t
+na_bmi_msg_send_unexpected_segments(na_class_t *na_class,
+        na_context_t *context, na_cb_t callback, void *arg,
+        const struct na_segment *segments, na_size_t segment_count,
+        void NA_UNUSED *plugin_data, na_addr_t dest, na_tag_t tag,
+        na_op_id_t *op_id)
+{
+    bmi_context_id *bmi_context = (bmi_context_id *) context->plugin_context;
+    bmi_size_t bmi_buf_size = 0;
+    struct na_bmi_addr *na_bmi_addr = (struct na_bmi_addr*) dest;
+    bmi_msg_tag_t bmi_tag = (bmi_msg_tag_t) tag;
+    struct na_bmi_op_id *na_bmi_op_id = NULL;
+    na_size_t i;
+    na_return_t ret = NA_SUCCESS;
+    int bmi_ret;
+
+    if (segment_count > NA_BMI_MAX_SEGMENTS) {
+        NA_LOG_ERROR("Exceeds max number of segments");
+        ret = NA_SIZE_ERROR;
+        goto done;
+    }
+
+    /* Allocate op_id if not provided */
+    if (op_id && op_id != NA_OP_ID_IGNORE && *op_id != NA_OP_ID_NULL) {
+        na_bmi_op_id = (struct na_bmi_op_id *) *op_id;
+        hg_atomic_incr32(&na_bmi_op_id->ref_count);
+    } else {
+        na_bmi_op_id = (struct na_bmi_op_id *) na_bmi_op_create(na_class);
+        if (!na_bmi_op_id) {
+            NA_LOG_ERROR("Could not allocate NA BMI operation ID");
+            ret = NA_NOMEM_ERROR;
+            goto done;
+        }
+    }
+    na_bmi_op_id->context = context;
+    na_bmi_op_id->type = NA_CB_SEND_UNEXPECTED;
+    na_bmi_op_id->callback = callback;
+    na_bmi_op_id->arg = arg;
+    hg_atomic_set32(&na_bmi_op_id->completed, 0);
+    na_bmi_op_id->info.send_unexpected.op_id = 0;
+    na_bmi_op_id->cancel = 0;
+
+    /* BMI keeps a reference to the lists until completion */
+    for (i = 0; i < segment_count; i++) {
+        na_bmi_op_id->info.send_unexpected.buffer_list[i] =
+            (const void *) segments[i].address;
+        na_bmi_op_id->info.send_unexpected.size_list[i] =
+            (bmi_size_t) segments[i].size;
+        bmi_buf_size += (bmi_size_t) segments[i].size;
+    }
+    if (bmi_buf_size > NA_BMI_UNEXPECTED_SIZE) {
+        NA_LOG_ERROR("Exceeds unexpected size");
+        ret = NA_SIZE_ERROR;
+        goto done;
+    }
+
+    /* Assign op_id */
+    if (op_id && op_id != NA_OP_ID_IGNORE && *op_id == NA_OP_ID_NULL)
+        *op_id = na_bmi_op_id;
+
+    /* Post the BMI unexpected send request */
+    bmi_ret = BMI_post_sendunexpected_list(
+            &na_bmi_op_id->info.send_unexpected.op_id, na_bmi_addr->bmi_addr,
+            na_bmi_op_id->info.send_unexpected.buffer_list,
+            na_bmi_op_id->info.send_unexpected.size_list, (int) segment_count,
+            bmi_buf_size, BMI_EXT_ALLOC, bmi_tag, na_bmi_op_id, *bmi_context,
+            NULL);
+    if (bmi_ret < 0) {
+        NA_LOG_ERROR("BMI_post_sendunexpected_list() failed");
+        ret = NA_PROTOCOL_ERROR;
+        goto done;
+    }
+
+    /* If immediate completion, directly add to completion queue */
+    if (bmi_ret) {
+        ret = na_bmi_complete(na_bmi_op_id);
+        if (ret != NA_SUCCESS) {
+            NA_LOG_ERROR("Could not complete operation");
+            goto done;
+        }
+    }
+
+done:
+    if (ret != NA_SUCCESS && na_bmi_op_id) {
+        na_bmi_op_destroy(na_class, (na_op_id_t) na_bmi_op_id);
+    }
+    return ret;
+}
+
 /*---------------------------------------------------------------------------*/
 static na_return_t
 na_bmi_msg_recv_unexpected(na_class_t *na_class, na_context_t *context,
@@ -1385,6 +1539,96 @@ done:
     return ret;
 }
 
+/*---------------------------------------------------------------------------*/
+static na_return_t
+na_bmi_msg_send_expected_segments(na_class_t *na_class,
+        na_context_t *context, na_cb_t callback, void *arg,
+        const struct na_segment *segments, na_size_t segment_count,
+        void NA_UNUSED *plugin_data, na_addr_t dest, na_tag_t tag,
+        na_op_id_t *op_id)
+{
+    bmi_context_id *bmi_context = (bmi_context_id *) context->plugin_context;
+    bmi_size_t bmi_buf_size = 0;
+    struct na_bmi_addr *na_bmi_addr = (struct na_bmi_addr*) dest;
+    bmi_msg_tag_t bmi_tag = (bmi_msg_tag_t) tag;
+    struct na_bmi_op_id *na_bmi_op_id = NULL;
+    na_size_t i;
+    na_return_t ret = NA_SUCCESS;
+    int bmi_ret;
+
+    if (segment_count > NA_BMI_MAX_SEGMENTS) {
+        NA_LOG_ERROR("Exceeds max number of segments");
+        ret = NA_SIZE_ERROR;
+        goto done;
+    }
+
+    /* Allocate op_id if not provided */
+    if (op_id && op_id != NA_OP_ID_IGNORE && *op_id != NA_OP_ID_NULL) {
+        na_bmi_op_id = (struct na_bmi_op_id *) *op_id;
+        hg_atomic_incr32(&na_bmi_op_id->ref_count);
+    } else {
+        na_bmi_op_id = (struct na_bmi_op_id *) na_bmi_op_create(na_class);
+        if (!na_bmi_op_id) {
+            NA_LOG_ERROR("Could not allocate NA BMI operation ID");
+            ret = NA_NOMEM_ERROR;
+            goto done;
+        }
+    }
+    na_bmi_op_id->context = context;
+    na_bmi_op_id->type = NA_CB_SEND_EXPECTED;
+    na_bmi_op_id->callback = callback;
+    na_bmi_op_id->arg = arg;
+    hg_atomic_set32(&na_bmi_op_id->completed, 0);
+    na_bmi_op_id->info.send_expected.op_id = 0;
+    na_bmi_op_id->cancel = 0;
+
+    /* BMI keeps a reference to the lists until completion */
+    for (i = 0; i < segment_count; i++) {
+        na_bmi_op_id->info.send_expected.buffer_list[i] =
+            (const void *) segments[i].address;
+        na_bmi_op_id->info.send_expected.size_list[i] =
+            (bmi_size_t) segments[i].size;
+        bmi_buf_size += (bmi_size_t) segments[i].size;
+    }
+    if (bmi_buf_size > NA_BMI_EXPECTED_SIZE) {
+        NA_LOG_ERROR("Exceeds expected size");
+        ret = NA_SIZE_ERROR;
+        goto done;
+    }
+
+    /* Assign op_id */
+    if (op_id && op_id != NA_OP_ID_IGNORE && *op_id == NA_OP_ID_NULL)
+        *op_id = na_bmi_op_id;
+
+    /* Post the BMI send request */
+    bmi_ret = BMI_post_send_list(
+            &na_bmi_op_id->info.send_expected.op_id, na_bmi_addr->bmi_addr,
+            na_bmi_op_id->info.send_expected.buffer_list,
+            na_bmi_op_id->info.send_expected.size_list, (int) segment_count,
+            bmi_buf_size, BMI_EXT_ALLOC, bmi_tag, na_bmi_op_id, *bmi_context,
+            NULL);
+    if (bmi_ret < 0) {
+        NA_LOG_ERROR("BMI_post_send_list() failed");
+        ret = NA_PROTOCOL_ERROR;
+        goto done;
+    }
+
+    /* If immediate completion, directly add to completion queue */
+    if (bmi_ret) {
+        ret = na_bmi_complete(na_bmi_op_id);
+        if (ret != NA_SUCCESS) {
+            NA_LOG_ERROR("Could not complete operation");
+            goto done;
+        }
+    }
+
+done:
+    if (ret != NA_SUCCESS && na_bmi_op_id) {
+        na_bmi_op_destroy(na_class, (na_op_id_t) na_bmi_op_id);
+    }
+    return ret;
+}
+
 /*---------------------------------------------------------------------------*/
 static na_return_t
 na_bmi_msg_recv_expected(na_class_t *na_class, na_context_t *context,
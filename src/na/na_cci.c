@@ -390,6 +390,8 @@ const na_class_t na_cci_class_g = {
     NULL,                                   /* msg_init_expected */
     na_cci_msg_send_expected,               /* msg_send_expected */
     na_cci_msg_recv_expected,               /* msg_recv_expected */
+    NULL,                                   /* msg_send_unexpected_segments */
+    NULL,                                   /* msg_send_expected_segments */
     na_cci_mem_handle_create,               /* mem_handle_create */
     NULL,                                   /* mem_handle_create_segment */
     na_cci_mem_handle_free,                 /* mem_handle_free */
@@ -404,6 +406,7 @@ const na_class_t na_cci_class_g = {
     na_cci_get,                             /* get */
     na_cci_poll_get_fd,                     /* poll_get_fd */
     NULL,                                   /* poll_try_wait */
+    NULL,                                   /* poll_wait_time */
     na_cci_progress,                        /* progress */
     na_cci_cancel                           /* cancel */
 };
@@ -564,6 +564,8 @@ const na_class_t na_mpi_class_g = {
         NULL,                                 /* msg_init_expected */
         na_mpi_msg_send_expected,             /* msg_send_expected */
         na_mpi_msg_recv_expected,             /* msg_recv_expected */
+        NULL,                                 /* msg_send_unexpected_segments */
+        NULL,                                 /* msg_send_expected_segments */
         na_mpi_mem_handle_create,             /* mem_handle_create */
         NULL,                                 /* mem_handle_create_segment */
         na_mpi_mem_handle_free,               /* mem_handle_free */
@@ -578,6 +580,7 @@ const na_class_t na_mpi_class_g = {
         na_mpi_get,                           /* get */
         NULL,                                 /* poll_get_fd */
         NULL,                                 /* poll_try_wait */
+        NULL,                                 /* poll_wait_time */
         na_mpi_progress,                      /* progress */
         na_mpi_cancel                         /* cancel */
 };
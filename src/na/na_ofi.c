@@ -108,6 +108,9 @@
 /* Max tag */
 #define NA_OFI_MAX_TAG ((1 << 30) -1)
 
+/* Max number of segments gathered by a single message send */
+#define NA_OFI_MSG_SEGMENTS_MAX (8)
+
 #define NA_OFI_UNEXPECTED_SIZE 4096
 #define NA_OFI_EXPECTED_TAG_FLAG (0x100000000ULL)
 #define NA_OFI_UNEXPECTED_TAG_IGNORE (0xFFFFFFFFULL)
@@ -579,6 +582,10 @@ na_ofi_initialize(na_class_t *na_class, const struct na_info *na_info,
 static na_return_t
 na_ofi_finalize(na_class_t *na_class);
 
+/* check_feature */
+static na_bool_t
+na_ofi_check_feature(na_class_t *na_class, na_uint8_t feature);
+
 /* op_create */
 static na_op_id_t
 na_ofi_op_create(na_class_t *na_class);
@@ -665,6 +672,27 @@ na_ofi_msg_recv_expected(na_class_t *na_class, na_context_t *context,
     na_cb_t callback, void *arg, void *buf, na_size_t buf_size,
     void *plugin_data, na_addr_t source, na_tag_t tag, na_op_id_t *op_id);
 
+/* msg_send_segments */
+static na_return_t
+na_ofi_msg_send_segments(na_class_t *na_class, na_context_t *context,
+    na_cb_type_t cb_type, na_cb_t callback, void *arg,
+    const struct na_segment *segments, na_size_t segment_count,
+    void *plugin_data, na_addr_t dest, na_uint64_t tag, na_op_id_t *op_id);
+
+/* msg_send_unexpected_segments */
+static na_return_t
+na_ofi_msg_send_unexpected_segments(na_class_t *na_class,
+    na_context_t *context, na_cb_t callback, void *arg,
+    const struct na_segment *segments, na_size_t segment_count,
+    void *plugin_data, na_addr_t dest, na_tag_t tag, na_op_id_t *op_id);
+
+/* msg_send_expected_segments */
+static na_return_t
+na_ofi_msg_send_expected_segments(na_class_t *na_class, na_context_t *context,
+    na_cb_t callback, void *arg, const struct na_segment *segments,
+    na_size_t segment_count, void *plugin_data, na_addr_t dest, na_tag_t tag,
+    na_op_id_t *op_id);
+
 /* mem_handle */
 static na_return_t
 na_ofi_mem_handle_create(na_class_t *na_class, void *buf, na_size_t buf_size,
@@ -741,7 +769,7 @@ const na_class_t na_ofi_class_g = {
     na_ofi_initialize,                      /* initialize */
     na_ofi_finalize,                        /* finalize */
     NULL,                                   /* cleanup */
-    NULL,                                   /* check_feature */
+    na_ofi_check_feature,                   /* check_feature */
     NULL,                                   /* context_create */
     NULL,                                   /* context_destroy */
     na_ofi_op_create,                       /* op_create */
@@ -765,6 +793,8 @@ const na_class_t na_ofi_class_g = {
     NULL,                                   /* msg_init_expected */
     na_ofi_msg_send_expected,               /* msg_send_expected */
     na_ofi_msg_recv_expected,               /* msg_recv_expected */
+    na_ofi_msg_send_unexpected_segments,    /* msg_send_unexpected_segments */
+    na_ofi_msg_send_expected_segments,      /* msg_send_expected_segments */
     na_ofi_mem_handle_create,               /* mem_handle_create */
     NULL,                                   /* mem_handle_create_segment */
     na_ofi_mem_handle_free,                 /* mem_handle_free */
@@ -779,6 +809,7 @@ const na_class_t na_ofi_class_g = {
     na_ofi_get,                             /* get */
     na_ofi_poll_get_fd,                     /* poll_get_fd */
     na_ofi_poll_try_wait,                   /* poll_try_wait */
+    NULL,                                   /* poll_wait_time */
     na_ofi_progress,                        /* progress */
     na_ofi_cancel                           /* cancel */
 };
@@ -1950,6 +1981,29 @@ na_ofi_op_id_valid(struct na_ofi_op_id *na_ofi_op_id)
     return NA_TRUE;
 }
 
+/*---------------------------------------------------------------------------*/
+static na_bool_t
+na_ofi_check_feature(na_class_t *na_class, na_uint8_t feature)
+{
+    struct na_ofi_domain *domain = NA_OFI_PRIVATE_DATA(na_class)->nop_domain;
+    na_bool_t ret = NA_FALSE;
+
+    switch (feature) {
+        case NA_HAS_MSG_SEGMENTS:
+            /* Segments other than the message buffer are not registered,
+             * only providers that do not need local descriptors can send
+             * them */
+            ret = (domain->nod_mr_mode == NA_OFI_MR_SCALABLE
+                && domain->nod_prov->tx_attr->iov_limit
+                    >= NA_OFI_MSG_SEGMENTS_MAX);
+            break;
+        default:
+            break;
+    }
+
+    return ret;
+}
+
 /*---------------------------------------------------------------------------*/
 static na_op_id_t
 na_ofi_op_create(na_class_t NA_UNUSED *na_class)
@@ -2753,6 +2807,114 @@ out:
     return ret;
 }
 
+/*---------------------------------------------------------------------------*/
+static na_return_t
+na_ofi_msg_send_segments(na_class_t *na_class, na_context_t *context,
+    na_cb_type_t cb_type, na_cb_t callback, void *arg,
+    const struct na_segment *segments, na_size_t segment_count,
+    void *plugin_data, na_addr_t dest, na_uint64_t tag, na_op_id_t *op_id)
+{
+    struct na_ofi_private_data *priv = NA_OFI_PRIVATE_DATA(na_class);
+    struct fid_ep *ep_hdl = priv->nop_endpoint->noe_ep;
+    struct na_ofi_addr *na_ofi_addr = (struct na_ofi_addr *)dest;
+    struct na_ofi_op_id *na_ofi_op_id = NULL;
+    struct iovec iov[NA_OFI_MSG_SEGMENTS_MAX];
+    void *desc[NA_OFI_MSG_SEGMENTS_MAX];
+    na_size_t i;
+    na_return_t ret = NA_SUCCESS;
+    ssize_t rc;
+
+    if (segment_count > NA_OFI_MSG_SEGMENTS_MAX) {
+        NA_LOG_ERROR("Exceeding max number of segments (%lu)",
+            (unsigned long) segment_count);
+        return NA_SIZE_ERROR;
+    }
+
+    /* Only the first segment is a registered message buffer */
+    for (i = 0; i < segment_count; i++) {
+        iov[i].iov_base = (void *) segments[i].address;
+        iov[i].iov_len = (size_t) segments[i].size;
+        desc[i] = (i == 0) ? plugin_data : NULL;
+    }
+
+    na_ofi_addr_addref(na_ofi_addr); /* decref in na_ofi_complete() */
+
+    /* Allocate op_id if not provided */
+    if (op_id && op_id != NA_OP_ID_IGNORE && *op_id != NA_OP_ID_NULL) {
+        na_ofi_op_id = (struct na_ofi_op_id *) *op_id;
+        na_ofi_op_id_addref(na_ofi_op_id);
+    } else {
+        na_ofi_op_id = (struct na_ofi_op_id *)na_ofi_op_create(na_class);
+        if (!na_ofi_op_id) {
+            NA_LOG_ERROR("Could not create NA OFI operation ID");
+            ret = NA_NOMEM_ERROR;
+            goto out;
+        }
+    }
+
+    na_ofi_op_id->noo_context = context;
+    na_ofi_op_id->noo_type = cb_type;
+    na_ofi_op_id->noo_callback = callback;
+    na_ofi_op_id->noo_arg = arg;
+    na_ofi_op_id->noo_addr = dest;
+    hg_atomic_set32(&na_ofi_op_id->noo_completed, 0);
+    hg_atomic_set32(&na_ofi_op_id->noo_canceled, 0);
+
+    /* Assign op_id */
+    if (op_id && op_id != NA_OP_ID_IGNORE && *op_id == NA_OP_ID_NULL)
+        *op_id = (na_op_id_t) na_ofi_op_id;
+
+    /* Post the FI send request, iov is copied by the provider */
+    do {
+        na_ofi_class_lock(na_class);
+        rc = fi_tsendv(ep_hdl, iov, desc, (size_t) segment_count,
+                       na_ofi_addr->noa_addr, tag, &na_ofi_op_id->noo_fi_ctx);
+        na_ofi_class_unlock(na_class);
+        /* for EAGAIN, progress and do it again */
+        if (rc == -FI_EAGAIN)
+            na_ofi_progress(na_class, context, 0);
+        else
+            break;
+    } while (1);
+    if (rc) {
+        NA_LOG_ERROR("fi_tsendv to %s failed, rc: %d(%s)",
+                     na_ofi_addr->noa_uri, rc, fi_strerror((int) -rc));
+        ret = NA_PROTOCOL_ERROR;
+    }
+
+out:
+    if (ret != NA_SUCCESS) {
+        na_ofi_addr_decref(na_ofi_addr);
+        if (na_ofi_op_id != NULL)
+            na_ofi_op_id_decref(na_ofi_op_id);
+    }
+    return ret;
+}
+
+/*---------------------------------------------------------------------------*/
+static na_return_t
+na_ofi_msg_send_unexpected_segments(na_class_t *na_class,
+    na_context_t *context, na_cb_t callback, void *arg,
+    const struct na_segment *segments, na_size_t segment_count,
+    void *plugin_data, na_addr_t dest, na_tag_t tag, na_op_id_t *op_id)
+{
+    return na_ofi_msg_send_segments(na_class, context, NA_CB_SEND_UNEXPECTED,
+        callback, arg, segments, segment_count, plugin_data, dest,
+        (na_uint64_t) tag, op_id);
+}
+
+/*---------------------------------------------------------------------------*/
+static na_return_t
+na_ofi_msg_send_expected_segments(na_class_t *na_class, na_context_t *context,
+    na_cb_t callback, void *arg, const struct na_segment *segments,
+    na_size_t segment_count, void *plugin_data, na_addr_t dest, na_tag_t tag,
+    na_op_id_t *op_id)
+{
+    return na_ofi_msg_send_segments(na_class, context, NA_CB_SEND_EXPECTED,
+        callback, arg, segments, segment_count, plugin_data, dest,
+        NA_OFI_EXPECTED_TAG_FLAG | tag, op_id);
+}
+
 /*---------------------------------------------------------------------------*/
 static na_return_t
 na_ofi_mem_handle_create(na_class_t NA_UNUSED *na_class, void *buf,
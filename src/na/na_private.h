@@ -229,6 +229,32 @@ struct na_class {
             na_op_id_t   *op_id
             );
     na_return_t
+    (*msg_send_unexpected_segments)(
+            na_class_t              *na_class,
+            na_context_t            *context,
+            na_cb_t                  callback,
+            void                    *arg,
+            const struct na_segment *segments,
+            na_size_t                segment_count,
+            void                    *plugin_data,
+            na_addr_t                dest,
+            na_tag_t                 tag,
+            na_op_id_t              *op_id
+            );
+    na_return_t
+    (*msg_send_expected_segments)(
+            na_class_t              *na_class,
+            na_context_t            *context,
+            na_cb_t                  callback,
+            void                    *arg,
+            const struct na_segment *segments,
+            na_size_t                segment_count,
+            void                    *plugin_data,
+            na_addr_t                dest,
+            na_tag_t                 tag,
+            na_op_id_t              *op_id
+            );
+    na_return_t
     (*mem_handle_create)(
             na_class_t      *na_class,
             void            *buf,
@@ -326,6 +352,11 @@ struct na_class {
             na_class_t      *na_class,
             na_context_t    *context
             );
+    na_uint64_t
+    (*na_poll_wait_time)(
+            na_class_t      *na_class,
+            na_context_t    *context
+            );
     na_return_t
     (*progress)(
             na_class_t   *na_class,
@@ -24,6 +24,7 @@
 #include "mercury_poll.h"
 #include "mercury_event.h"
 #include "mercury_mem.h"
+#include "mercury_hash_table.h"
 
 #include <stdlib.h>
 #include <string.h>
@@ -59,6 +60,8 @@
 #define NA_SM_RING_BUF_SIZE \
     (sizeof(struct na_sm_ring_buf) + NA_SM_NUM_BUFS * HG_ATOMIC_QUEUE_ELT_SIZE)
 #define NA_SM_COPY_BUF_SIZE     4096
+/* Each entry of the shared ring refers to a message held in a copy buf */
+#define NA_SM_SHARED_RING_SIZE  (2 * NA_SM_NUM_BUFS)
 #define NA_SM_CLEANUP_NFDS      16
 
 #define NA_SM_LISTEN_BACKLOG    64
@@ -71,10 +74,19 @@
 /* Max tag */
 #define NA_SM_MAX_TAG           NA_TAG_UB
 
+/* Expected recvs posted on an addr are matched directly by tag */
+#define NA_SM_REPLY_SLOTS       64  /* Must be a power of 2 */
+#define NA_SM_REPLY_SLOT(na_sm_addr, tag) \
+    (&(na_sm_addr)->reply_slots[(tag) & (NA_SM_REPLY_SLOTS - 1)])
+
 /* Private data access */
 #define NA_SM_PRIVATE_DATA(na_class) \
     ((struct na_sm_private_data *)(na_class->private_data))
 
+/* Messages from accepted addr are announced on the shared ring */
+#define NA_SM_SHARED_RECV(na_class, na_sm_addr) \
+    (NA_SM_PRIVATE_DATA(na_class)->shared_recv && (na_sm_addr)->accepted)
+
 /* Min macro */
 #define NA_SM_MIN(a, b) \
     (a < b) ? a : b
@@ -147,10 +159,19 @@ struct na_sm_ring_buf {
              - NA_SM_NUM_BUFS * HG_ATOMIC_QUEUE_ELT_SIZE];
 };
 
+/* Shared ring of connection IDs, read by the listening process */
+struct na_sm_shared_ring {
+    na_sm_cacheline_atomic_int32_t enabled;         /* Ring is used */
+    struct hg_atomic_queue queue;
+    char pad[NA_SM_COPY_BUF_SIZE - NA_SM_CACHE_LINE_SIZE
+             - sizeof(struct hg_atomic_queue)];
+};
+
 /* Shared copy buffer */
 struct na_sm_copy_buf {
     na_sm_cacheline_atomic_int64_t available;       /* Atomic bitmask */
     char buf[NA_SM_NUM_BUFS][NA_SM_COPY_BUF_SIZE];  /* Buffer used for msgs */
+    struct na_sm_shared_ring shared_ring;           /* Inbound msg ring */
     char pad[NA_SM_COPY_BUF_SIZE - NA_SM_CACHE_LINE_SIZE];
 };
 
@@ -158,7 +179,8 @@ struct na_sm_copy_buf {
 typedef enum na_sm_poll_type {
     NA_SM_ACCEPT = 1,
     NA_SM_SOCK,
-    NA_SM_NOTIFY
+    NA_SM_NOTIFY,
+    NA_SM_SHARED_NOTIFY
 } na_sm_poll_type_t;
 
 /* Poll data */
@@ -191,6 +213,10 @@ struct na_sm_addr {
     int local_notify;                       /* Local notify fd */
     struct na_sm_poll_data *local_notify_poll_data; /* Notify poll data */
     int remote_notify;                      /* Remote notify fd */
+    int shared_notify;                      /* Shared ring notify fd (self) */
+    struct na_sm_poll_data *shared_notify_poll_data; /* Shared poll data */
+    na_bool_t shared_recv;                  /* Remote reads shared ring */
+    struct na_sm_op_id *reply_slots[NA_SM_REPLY_SLOTS]; /* Expected recvs */
     hg_atomic_int32_t ref_count;            /* Ref count */
     HG_QUEUE_ENTRY(na_sm_addr) entry;       /* Next queue entry */
     HG_QUEUE_ENTRY(na_sm_addr) poll_entry;  /* Next poll queue entry */
@@ -256,6 +282,13 @@ struct na_sm_op_id {
     HG_QUEUE_ENTRY(na_sm_op_id) entry;
 };
 
+#ifdef HG_UTIL_HAS_STATS
+/* Context (contexts share the class poll set but account their own waits) */
+struct na_sm_context {
+    hg_atomic_int64_t wait_time;            /* Time blocked in poll (usec) */
+};
+#endif
+
 /* Private data */
 struct na_sm_private_data {
     struct na_sm_addr *self_addr;
@@ -273,8 +306,13 @@ struct na_sm_private_data {
     hg_thread_spin_t unexpected_op_queue_lock;
     hg_thread_spin_t expected_op_queue_lock;
     hg_thread_spin_t copy_buf_lock;
+    hg_hash_table_t *peer_addr_table;       /* Looked up addrs by PID / ID */
+    hg_thread_mutex_t peer_addr_lock;
+    hg_hash_table_t *conn_addr_table;       /* Accepted addrs by conn ID */
+    hg_thread_spin_t conn_addr_table_lock;
     hg_time_t last_accept_time;
     na_bool_t no_wait;
+    na_bool_t shared_recv;                  /* Read all conns from shared ring */
 };
 
 /********************/
@@ -442,6 +480,49 @@ na_sm_recv_conn_id(
     na_bool_t *received
     );
 
+/**
+ * Hash function for peer addr table.
+ */
+static NA_INLINE unsigned int
+na_sm_peer_hash(
+    hg_hash_table_key_t vlocation
+    );
+
+/**
+ * Equal function for peer addr table.
+ */
+static NA_INLINE int
+na_sm_peer_equal(
+    hg_hash_table_key_t vlocation1,
+    hg_hash_table_key_t vlocation2
+    );
+
+/**
+ * Hash function for conn addr table.
+ */
+static NA_INLINE unsigned int
+na_sm_conn_hash(
+    hg_hash_table_key_t vlocation
+    );
+
+/**
+ * Equal function for conn addr table.
+ */
+static NA_INLINE int
+na_sm_conn_equal(
+    hg_hash_table_key_t vlocation1,
+    hg_hash_table_key_t vlocation2
+    );
+
+/**
+ * Initialize atomic queue of count entries placed in shared memory.
+ */
+static void
+na_sm_queue_init(
+    struct hg_atomic_queue *hg_atomic_queue,
+    unsigned int count
+    );
+
 /**
  * Initialize ring buffer.
  */
@@ -477,14 +558,14 @@ na_sm_ring_buf_is_empty(
     );
 
 /**
- * Reserve shared copy buf.
+ * Reserve shared copy buf and gather segments into it.
  */
 static NA_INLINE na_return_t
 na_sm_reserve_and_copy_buf(
     na_class_t *na_class,
     struct na_sm_copy_buf *na_sm_copy_buf,
-    const void *buf,
-    size_t buf_size,
+    const struct na_segment *segments,
+    na_size_t segment_count,
     unsigned int *idx_reserved
     );
 
@@ -552,6 +633,26 @@ na_sm_progress_notify(
     na_bool_t *progressed
     );
 
+/**
+ * Progress on shared ring notifications.
+ */
+static na_return_t
+na_sm_progress_shared(
+    na_class_t *na_class,
+    struct na_sm_addr *poll_addr,
+    na_bool_t *progressed
+    );
+
+/**
+ * Progress on next message received from addr.
+ */
+static na_return_t
+na_sm_progress_msg(
+    na_class_t *na_class,
+    struct na_sm_addr *poll_addr,
+    na_bool_t *progressed
+    );
+
 /**
  * Progress on unexpected messages.
  */
@@ -621,6 +722,22 @@ na_sm_check_feature(
     na_uint8_t feature
     );
 
+#ifdef HG_UTIL_HAS_STATS
+/* context_create */
+static na_return_t
+na_sm_context_create(
+    na_class_t *na_class,
+    void **plugin_context
+    );
+
+/* context_destroy */
+static na_return_t
+na_sm_context_destroy(
+    na_class_t *na_class,
+    void *plugin_context
+    );
+#endif
+
 /* op_create */
 static na_op_id_t
 na_sm_op_create(
@@ -716,6 +833,21 @@ na_sm_msg_send_unexpected(
     na_op_id_t *op_id
     );
 
+/* msg_send_unexpected_segments */
+static na_return_t
+na_sm_msg_send_unexpected_segments(
+    na_class_t *na_class,
+    na_context_t *context,
+    na_cb_t callback,
+    void *arg,
+    const struct na_segment *segments,
+    na_size_t segment_count,
+    void *plugin_data,
+    na_addr_t dest,
+    na_tag_t tag,
+    na_op_id_t *op_id
+    );
+
 /* msg_recv_unexpected */
 static na_return_t
 na_sm_msg_recv_unexpected(
@@ -745,6 +877,21 @@ na_sm_msg_send_expected(
     na_op_id_t *op_id
     );
 
+/* msg_send_expected_segments */
+static na_return_t
+na_sm_msg_send_expected_segments(
+    na_class_t *na_class,
+    na_context_t *context,
+    na_cb_t callback,
+    void *arg,
+    const struct na_segment *segments,
+    na_size_t segment_count,
+    void *plugin_data,
+    na_addr_t dest,
+    na_tag_t tag,
+    na_op_id_t *op_id
+    );
+
 /* msg_recv_expected */
 static na_return_t
 na_sm_msg_recv_expected(
@@ -860,6 +1007,15 @@ na_sm_poll_try_wait(
     na_context_t    *context
     );
 
+#ifdef HG_UTIL_HAS_STATS
+/* poll_wait_time */
+static na_uint64_t
+na_sm_poll_wait_time(
+    na_class_t      *na_class,
+    na_context_t    *context
+    );
+#endif
+
 /* progress */
 static na_return_t
 na_sm_progress(
@@ -888,8 +1044,13 @@ const na_class_t na_sm_class_g = {
     na_sm_finalize,                         /* finalize */
     na_sm_cleanup,                          /* cleanup */
     na_sm_check_feature,                    /* check_feature */
+#ifdef HG_UTIL_HAS_STATS
+    na_sm_context_create,                   /* context_create */
+    na_sm_context_destroy,                  /* context_destroy */
+#else
     NULL,                                   /* context_create */
     NULL,                                   /* context_destroy */
+#endif
     na_sm_op_create,                        /* op_create */
     na_sm_op_destroy,                       /* op_destroy */
     na_sm_addr_lookup,                      /* addr_lookup */
@@ -911,6 +1072,8 @@ const na_class_t na_sm_class_g = {
     NULL,                                   /* msg_init_expected */
     na_sm_msg_send_expected,                /* msg_send_expected */
     na_sm_msg_recv_expected,                /* msg_recv_expected */
+    na_sm_msg_send_unexpected_segments,     /* msg_send_unexpected_segments */
+    na_sm_msg_send_expected_segments,       /* msg_send_expected_segments */
     na_sm_mem_handle_create,                /* mem_handle_create */
 #ifdef NA_SM_HAS_CMA
     na_sm_mem_handle_create_segments,       /* mem_handle_create_segments */
@@ -929,6 +1092,11 @@ const na_class_t na_sm_class_g = {
     na_sm_get,                              /* get */
     na_sm_poll_get_fd,                      /* poll_get_fd */
     na_sm_poll_try_wait,                    /* poll_try_wait */
+#ifdef HG_UTIL_HAS_STATS
+    na_sm_poll_wait_time,                   /* poll_wait_time */
+#else
+    NULL,                                   /* poll_wait_time */
+#endif
     na_sm_progress,                         /* progress */
     na_sm_cancel                            /* cancel */
 };
@@ -1092,6 +1260,10 @@ na_sm_close_sock(int sock, const char *pathname)
 {
     na_return_t ret = NA_SUCCESS;
 
+    /* Self addr of a class that does not listen has no sock */
+    if (sock < 0)
+        goto done;
+
     if (close(sock) == -1) {
         NA_LOG_ERROR("close() failed (%s)", strerror(errno));
         ret = NA_PROTOCOL_ERROR;
@@ -1274,6 +1446,10 @@ na_sm_poll_register(na_class_t *na_class, na_sm_poll_type_t poll_type,
             fd = na_sm_addr->local_notify;
             na_sm_poll_data_ptr = &na_sm_addr->local_notify_poll_data;
             break;
+        case NA_SM_SHARED_NOTIFY:
+            fd = na_sm_addr->shared_notify;
+            na_sm_poll_data_ptr = &na_sm_addr->shared_notify_poll_data;
+            break;
         default:
             NA_LOG_ERROR("Invalid poll type");
             ret = NA_INVALID_PARAM;
@@ -1324,6 +1500,10 @@ na_sm_poll_deregister(na_class_t *na_class, na_sm_poll_type_t poll_type,
             na_sm_poll_data = na_sm_addr->local_notify_poll_data;
             fd = na_sm_addr->local_notify;
             break;
+        case NA_SM_SHARED_NOTIFY:
+            na_sm_poll_data = na_sm_addr->shared_notify_poll_data;
+            fd = na_sm_addr->shared_notify;
+            break;
         default:
             NA_LOG_ERROR("Invalid poll type");
             ret = NA_INVALID_PARAM;
@@ -1364,6 +1544,12 @@ na_sm_setup_shm(na_class_t *na_class, struct na_sm_addr *na_sm_addr)
     hg_atomic_init64(&na_sm_copy_buf->available.val, ~((hg_util_int64_t)0));
     na_sm_addr->na_sm_copy_buf = na_sm_copy_buf;
 
+    /* Initialize shared ring, peers look at enabled when connecting */
+    na_sm_queue_init(&na_sm_copy_buf->shared_ring.queue,
+        NA_SM_SHARED_RING_SIZE);
+    hg_atomic_init32(&na_sm_copy_buf->shared_ring.enabled.val,
+        NA_SM_PRIVATE_DATA(na_class)->shared_recv);
+
     /* Create SHM sock */
     NA_SM_GEN_SOCK_PATH(pathname, na_sm_addr);
     ret = na_sm_create_sock(pathname, NA_TRUE, &listen_sock);
@@ -1551,12 +1737,45 @@ done:
 }
 
 /*---------------------------------------------------------------------------*/
-static void
-na_sm_ring_buf_init(struct na_sm_ring_buf *na_sm_ring_buf)
+static NA_INLINE unsigned int
+na_sm_peer_hash(hg_hash_table_key_t vlocation)
 {
-    struct hg_atomic_queue *hg_atomic_queue = &na_sm_ring_buf->queue;
-    unsigned int count = NA_SM_NUM_BUFS;
+    struct na_sm_addr *na_sm_addr = (struct na_sm_addr *) vlocation;
 
+    return (unsigned int) na_sm_addr->pid * 31 + na_sm_addr->id;
+}
+
+/*---------------------------------------------------------------------------*/
+static NA_INLINE int
+na_sm_peer_equal(hg_hash_table_key_t vlocation1,
+    hg_hash_table_key_t vlocation2)
+{
+    struct na_sm_addr *na_sm_addr1 = (struct na_sm_addr *) vlocation1;
+    struct na_sm_addr *na_sm_addr2 = (struct na_sm_addr *) vlocation2;
+
+    return (na_sm_addr1->pid == na_sm_addr2->pid)
+        && (na_sm_addr1->id == na_sm_addr2->id);
+}
+
+/*---------------------------------------------------------------------------*/
+static NA_INLINE unsigned int
+na_sm_conn_hash(hg_hash_table_key_t vlocation)
+{
+    return *((unsigned int *) vlocation);
+}
+
+/*---------------------------------------------------------------------------*/
+static NA_INLINE int
+na_sm_conn_equal(hg_hash_table_key_t vlocation1,
+    hg_hash_table_key_t vlocation2)
+{
+    return *((unsigned int *) vlocation1) == *((unsigned int *) vlocation2);
+}
+
+/*---------------------------------------------------------------------------*/
+static void
+na_sm_queue_init(struct hg_atomic_queue *hg_atomic_queue, unsigned int count)
+{
     hg_atomic_queue->prod_size = hg_atomic_queue->cons_size = count;
     hg_atomic_queue->prod_mask = hg_atomic_queue->cons_mask = count - 1;
     hg_atomic_init32(&hg_atomic_queue->prod_head, 0);
@@ -1565,6 +1784,13 @@ na_sm_ring_buf_init(struct na_sm_ring_buf *na_sm_ring_buf)
     hg_atomic_init32(&hg_atomic_queue->cons_tail, 0);
 }
 
+/*---------------------------------------------------------------------------*/
+static void
+na_sm_ring_buf_init(struct na_sm_ring_buf *na_sm_ring_buf)
+{
+    na_sm_queue_init(&na_sm_ring_buf->queue, NA_SM_NUM_BUFS);
+}
+
 /*---------------------------------------------------------------------------*/
 static NA_INLINE na_bool_t
 na_sm_ring_buf_push(struct na_sm_ring_buf *na_sm_ring_buf,
@@ -1610,8 +1836,8 @@ na_sm_ring_buf_is_empty(struct na_sm_ring_buf *na_sm_ring_buf)
 /*---------------------------------------------------------------------------*/
 static NA_INLINE na_return_t
 na_sm_reserve_and_copy_buf(na_class_t *na_class,
-    struct na_sm_copy_buf *na_sm_copy_buf, const void *buf, size_t buf_size,
-    unsigned int *idx_reserved)
+    struct na_sm_copy_buf *na_sm_copy_buf, const struct na_segment *segments,
+    na_size_t segment_count, unsigned int *idx_reserved)
 {
     hg_util_int64_t bits = 1LL;
     na_return_t ret = NA_SIZE_ERROR;
@@ -1635,8 +1861,15 @@ na_sm_reserve_and_copy_buf(na_class_t *na_class,
 
         if (hg_atomic_cas64(&na_sm_copy_buf->available.val, available,
             available & ~bits)) {
-            /* Reservation succeeded, copy buffer */
-            memcpy(na_sm_copy_buf->buf[i], buf, buf_size);
+            char *copy_buf = na_sm_copy_buf->buf[i];
+            na_size_t j;
+
+            /* Reservation succeeded, copy segments */
+            for (j = 0; j < segment_count; j++) {
+                memcpy(copy_buf, (const void *) segments[j].address,
+                    segments[j].size);
+                copy_buf += segments[j].size;
+            }
             *idx_reserved = i;
 //            NA_LOG_DEBUG("Reserved %u is:\n%s", i,
 //                itoa(hg_atomic_get64(&na_sm_copy_buf->available.val), 2));
@@ -1664,7 +1897,8 @@ na_sm_copy_and_free_buf(na_class_t *na_class,
 
     hg_thread_spin_lock(&NA_SM_PRIVATE_DATA(na_class)->copy_buf_lock);
 
-    memcpy(buf, na_sm_copy_buf->buf[idx_reserved], buf_size);
+    if (buf_size)
+        memcpy(buf, na_sm_copy_buf->buf[idx_reserved], buf_size);
 
 #if !defined(HG_UTIL_HAS_OPA_PRIMITIVES_H)
     hg_atomic_or64(&na_sm_copy_buf->available.val, bits);
@@ -1698,6 +1932,15 @@ na_sm_msg_insert(na_class_t *na_class, struct na_sm_op_id *na_sm_op_id,
         goto done;
     }
 
+    /* Tell remote which connection to read from if it uses a shared ring */
+    if (na_sm_addr->shared_recv && hg_atomic_queue_push(
+        &na_sm_addr->na_sm_copy_buf->shared_ring.queue,
+        (void *) (uintptr_t) (na_sm_addr->conn_id + 1)) != HG_UTIL_SUCCESS) {
+        NA_LOG_ERROR("Full shared ring buffer");
+        ret = NA_PROTOCOL_ERROR;
+        goto done;
+    }
+
     /* Immediate completion, add directly to completion queue. */
     ret = na_sm_complete(na_sm_op_id);
     if (ret != NA_SUCCESS) {
@@ -1814,6 +2057,14 @@ na_sm_progress_cb(void *arg, unsigned int NA_UNUSED timeout,
                 goto done;
             }
             break;
+        case NA_SM_SHARED_NOTIFY:
+            na_ret = na_sm_progress_shared(na_class, na_sm_poll_data->addr,
+                (hg_util_bool_t *) progressed);
+            if (na_ret != NA_SUCCESS) {
+                NA_LOG_ERROR("Could not make progress on shared notify");
+                goto done;
+            }
+            break;
         default:
             NA_LOG_ERROR("Unknown poll data type");
             na_ret = NA_PROTOCOL_ERROR;
@@ -1928,7 +2179,11 @@ na_sm_progress_accept(na_class_t *na_class, struct na_sm_addr *poll_addr,
 
     /* Create local signal event */
 #ifdef HG_UTIL_HAS_SYSEVENTFD_H
-    local_notify = hg_event_create();
+    if (NA_SM_SHARED_RECV(na_class, na_sm_addr))
+        /* Peer signals the shared ring event, which is not owned by addr */
+        local_notify = NA_SM_PRIVATE_DATA(na_class)->self_addr->shared_notify;
+    else
+        local_notify = hg_event_create();
     if (local_notify == HG_UTIL_FAIL) {
         NA_LOG_ERROR("hg_event_create() failed");
         ret = NA_PROTOCOL_ERROR;
@@ -1976,11 +2231,28 @@ na_sm_progress_accept(na_class_t *na_class, struct na_sm_addr *poll_addr,
 #endif
     na_sm_addr->remote_notify = remote_notify;
 
-    /* Add local notify to poll set */
-    ret = na_sm_poll_register(na_class, NA_SM_NOTIFY, na_sm_addr);
-    if (ret != NA_SUCCESS) {
-        NA_LOG_ERROR("Could not add notify to poll set");
-        goto done;
+    if (NA_SM_SHARED_RECV(na_class, na_sm_addr)) {
+        /* Messages are found through conn ID popped from shared ring */
+        hg_thread_spin_lock(
+            &NA_SM_PRIVATE_DATA(na_class)->conn_addr_table_lock);
+        if (!hg_hash_table_insert(NA_SM_PRIVATE_DATA(na_class)->conn_addr_table,
+            (hg_hash_table_key_t) &na_sm_addr->conn_id,
+            (hg_hash_table_value_t) na_sm_addr)) {
+            hg_thread_spin_unlock(
+                &NA_SM_PRIVATE_DATA(na_class)->conn_addr_table_lock);
+            NA_LOG_ERROR("Could not insert addr into conn table");
+            ret = NA_NOMEM_ERROR;
+            goto done;
+        }
+        hg_thread_spin_unlock(
+            &NA_SM_PRIVATE_DATA(na_class)->conn_addr_table_lock);
+    } else {
+        /* Add local notify to poll set */
+        ret = na_sm_poll_register(na_class, NA_SM_NOTIFY, na_sm_addr);
+        if (ret != NA_SUCCESS) {
+            NA_LOG_ERROR("Could not add notify to poll set");
+            goto done;
+        }
     }
 
     /* Send connection ID / event IDs */
@@ -2037,13 +2309,16 @@ na_sm_progress_sock(na_class_t *na_class, struct na_sm_addr *poll_addr,
 
             poll_addr->sock_progress = NA_SM_SOCK_DONE;
 
-            /* Add addr to poll addr queue */
-            hg_thread_spin_lock(
-                &NA_SM_PRIVATE_DATA(na_class)->poll_addr_queue_lock);
-            HG_QUEUE_PUSH_TAIL(&NA_SM_PRIVATE_DATA(na_class)->poll_addr_queue,
-                poll_addr, poll_entry);
-            hg_thread_spin_unlock(
-                &NA_SM_PRIVATE_DATA(na_class)->poll_addr_queue_lock);
+            /* Add addr to poll addr queue, shared ring is checked instead */
+            if (!NA_SM_SHARED_RECV(na_class, poll_addr)) {
+                hg_thread_spin_lock(
+                    &NA_SM_PRIVATE_DATA(na_class)->poll_addr_queue_lock);
+                HG_QUEUE_PUSH_TAIL(
+                    &NA_SM_PRIVATE_DATA(na_class)->poll_addr_queue,
+                    poll_addr, poll_entry);
+                hg_thread_spin_unlock(
+                    &NA_SM_PRIVATE_DATA(na_class)->poll_addr_queue_lock);
+            }
 
             /* Progressed */
             *progressed = NA_TRUE;
@@ -2052,7 +2327,8 @@ na_sm_progress_sock(na_class_t *na_class, struct na_sm_addr *poll_addr,
         case NA_SM_CONN_ID: {
             char filename[NA_SM_MAX_FILENAME];
             struct na_sm_ring_buf *na_sm_ring_buf;
-            struct na_sm_op_id *na_sm_op_id = NULL;
+            struct na_sm_op_id *na_sm_op_id, *na_sm_next_op_id;
+            HG_QUEUE_HEAD(na_sm_op_id) complete_op_queue;
             na_bool_t received = NA_FALSE;
 
             /* Receive connection ID / event IDs */
@@ -2066,29 +2342,6 @@ na_sm_progress_sock(na_class_t *na_class, struct na_sm_addr *poll_addr,
                 *progressed = NA_FALSE;
                 goto done;
             }
-            poll_addr->sock_progress = NA_SM_SOCK_DONE;
-
-            /* Find op ID that corresponds to addr */
-            hg_thread_spin_lock(
-                &NA_SM_PRIVATE_DATA(na_class)->lookup_op_queue_lock);
-            HG_QUEUE_FOREACH(na_sm_op_id,
-                &NA_SM_PRIVATE_DATA(na_class)->lookup_op_queue, entry) {
-                if (na_sm_op_id->info.lookup.na_sm_addr == poll_addr) {
-                    HG_QUEUE_REMOVE(
-                        &NA_SM_PRIVATE_DATA(na_class)->lookup_op_queue,
-                        na_sm_op_id, na_sm_op_id, entry);
-                    break;
-                }
-            }
-            hg_thread_spin_unlock(
-                &NA_SM_PRIVATE_DATA(na_class)->lookup_op_queue_lock);
-
-            if (!na_sm_op_id) {
-                NA_LOG_ERROR("Could not find lookup op ID, conn ID=%u, PID=%u",
-                    poll_addr->conn_id, (unsigned int) poll_addr->pid);
-                ret = NA_PROTOCOL_ERROR;
-                goto done;
-            }
 
             /* Open remote ring buf pair (send and recv names correspond to
              * remote ring buffer pair) */
@@ -2127,13 +2380,46 @@ na_sm_progress_sock(na_class_t *na_class, struct na_sm_addr *poll_addr,
             hg_thread_spin_unlock(
                 &NA_SM_PRIVATE_DATA(na_class)->poll_addr_queue_lock);
 
-            /* Completion */
-            ret = na_sm_complete(na_sm_op_id);
-            if (ret != NA_SUCCESS) {
-                NA_LOG_ERROR("Could not complete operation");
+            /* Connection is ready, take all the lookups waiting on it (later
+             * lookups of the same peer complete immediately) */
+            HG_QUEUE_INIT(&complete_op_queue);
+            hg_thread_spin_lock(
+                &NA_SM_PRIVATE_DATA(na_class)->lookup_op_queue_lock);
+            poll_addr->sock_progress = NA_SM_SOCK_DONE;
+            na_sm_op_id = HG_QUEUE_FIRST(
+                &NA_SM_PRIVATE_DATA(na_class)->lookup_op_queue);
+            while (na_sm_op_id) {
+                na_sm_next_op_id = HG_QUEUE_NEXT(na_sm_op_id, entry);
+                if (na_sm_op_id->info.lookup.na_sm_addr == poll_addr) {
+                    HG_QUEUE_REMOVE(
+                        &NA_SM_PRIVATE_DATA(na_class)->lookup_op_queue,
+                        na_sm_op_id, na_sm_op_id, entry);
+                    HG_QUEUE_PUSH_TAIL(&complete_op_queue, na_sm_op_id,
+                        entry);
+                }
+                na_sm_op_id = na_sm_next_op_id;
+            }
+            hg_thread_spin_unlock(
+                &NA_SM_PRIVATE_DATA(na_class)->lookup_op_queue_lock);
+
+            if (HG_QUEUE_IS_EMPTY(&complete_op_queue)) {
+                NA_LOG_ERROR("Could not find lookup op ID, conn ID=%u, PID=%u",
+                    poll_addr->conn_id, (unsigned int) poll_addr->pid);
+                ret = NA_PROTOCOL_ERROR;
                 goto done;
             }
 
+            /* Completion */
+            while (!HG_QUEUE_IS_EMPTY(&complete_op_queue)) {
+                na_sm_op_id = HG_QUEUE_FIRST(&complete_op_queue);
+                HG_QUEUE_POP_HEAD(&complete_op_queue, entry);
+                ret = na_sm_complete(na_sm_op_id);
+                if (ret != NA_SUCCESS) {
+                    NA_LOG_ERROR("Could not complete operation");
+                    goto done;
+                }
+            }
+
             /* Progressed */
             *progressed = NA_TRUE;
         }
@@ -2153,7 +2439,6 @@ static na_return_t
 na_sm_progress_notify(na_class_t *na_class, struct na_sm_addr *poll_addr,
     na_bool_t *progressed)
 {
-    na_sm_cacheline_hdr_t na_sm_hdr;
     na_bool_t notified = NA_FALSE;
     na_return_t ret = NA_SUCCESS;
 
@@ -2197,6 +2482,70 @@ na_sm_progress_notify(na_class_t *na_class, struct na_sm_addr *poll_addr,
         }
     }
 
+    ret = na_sm_progress_msg(na_class, poll_addr, progressed);
+
+done:
+    return ret;
+}
+
+/*---------------------------------------------------------------------------*/
+static na_return_t
+na_sm_progress_shared(na_class_t *na_class, struct na_sm_addr *poll_addr,
+    na_bool_t *progressed)
+{
+    struct na_sm_addr *na_sm_addr;
+    na_bool_t notified = NA_FALSE;
+    unsigned int conn_id;
+    void *entry;
+    na_return_t ret = NA_SUCCESS;
+
+    if (!NA_SM_PRIVATE_DATA(na_class)->no_wait) {
+        if (hg_event_get(poll_addr->shared_notify,
+            (hg_util_bool_t *) &notified) != HG_UTIL_SUCCESS) {
+            NA_LOG_ERROR("Could not get shared notification");
+            ret = NA_PROTOCOL_ERROR;
+            goto done;
+        }
+        if (!notified) {
+            *progressed = NA_FALSE;
+            goto done;
+        }
+    }
+
+    /* Each entry announces one message on the connection it refers to */
+    entry = hg_atomic_queue_pop_mc(
+        &poll_addr->na_sm_copy_buf->shared_ring.queue);
+    if (!entry) {
+        *progressed = NA_FALSE;
+        goto done;
+    }
+    conn_id = (unsigned int) ((uintptr_t) entry - 1);
+
+    hg_thread_spin_lock(&NA_SM_PRIVATE_DATA(na_class)->conn_addr_table_lock);
+    na_sm_addr = (struct na_sm_addr *) hg_hash_table_lookup(
+        NA_SM_PRIVATE_DATA(na_class)->conn_addr_table,
+        (hg_hash_table_key_t) &conn_id);
+    hg_thread_spin_unlock(&NA_SM_PRIVATE_DATA(na_class)->conn_addr_table_lock);
+    if (!na_sm_addr) {
+        NA_LOG_ERROR("Could not find addr for conn ID=%u", conn_id);
+        ret = NA_PROTOCOL_ERROR;
+        goto done;
+    }
+
+    ret = na_sm_progress_msg(na_class, na_sm_addr, progressed);
+
+done:
+    return ret;
+}
+
+/*---------------------------------------------------------------------------*/
+static na_return_t
+na_sm_progress_msg(na_class_t *na_class, struct na_sm_addr *poll_addr,
+    na_bool_t *progressed)
+{
+    na_sm_cacheline_hdr_t na_sm_hdr;
+    na_return_t ret = NA_SUCCESS;
+
     if (!na_sm_ring_buf_pop(poll_addr->na_sm_recv_ring_buf, &na_sm_hdr)) {
         *progressed = NA_FALSE;
         goto done;
@@ -2288,18 +2637,28 @@ static na_return_t
 na_sm_progress_expected(na_class_t *na_class, struct na_sm_addr *poll_addr,
     na_sm_cacheline_hdr_t na_sm_hdr)
 {
+    struct na_sm_op_id **reply_slot =
+        NA_SM_REPLY_SLOT(poll_addr, na_sm_hdr.hdr.tag);
     struct na_sm_op_id *na_sm_op_id = NULL;
     na_return_t ret = NA_SUCCESS;
 
     hg_thread_spin_lock(
         &NA_SM_PRIVATE_DATA(na_class)->expected_op_queue_lock);
-    HG_QUEUE_FOREACH(na_sm_op_id,
-        &NA_SM_PRIVATE_DATA(na_class)->expected_op_queue, entry) {
-        if (na_sm_op_id->info.recv_expected.na_sm_addr == poll_addr &&
-            na_sm_op_id->info.recv_expected.tag == na_sm_hdr.hdr.tag) {
-            HG_QUEUE_REMOVE(&NA_SM_PRIVATE_DATA(na_class)->expected_op_queue,
-                na_sm_op_id, na_sm_op_id, entry);
-            break;
+    if (*reply_slot
+        && (*reply_slot)->info.recv_expected.tag == na_sm_hdr.hdr.tag) {
+        /* Recv was posted in the slot of its tag */
+        na_sm_op_id = *reply_slot;
+        *reply_slot = NULL;
+    } else {
+        HG_QUEUE_FOREACH(na_sm_op_id,
+            &NA_SM_PRIVATE_DATA(na_class)->expected_op_queue, entry) {
+            if (na_sm_op_id->info.recv_expected.na_sm_addr == poll_addr &&
+                na_sm_op_id->info.recv_expected.tag == na_sm_hdr.hdr.tag) {
+                HG_QUEUE_REMOVE(
+                    &NA_SM_PRIVATE_DATA(na_class)->expected_op_queue,
+                    na_sm_op_id, na_sm_op_id, entry);
+                break;
+            }
         }
     }
     hg_thread_spin_unlock(
@@ -2310,6 +2669,9 @@ na_sm_progress_expected(na_class_t *na_class, struct na_sm_addr *poll_addr,
         NA_LOG_WARNING("Ignored expected message received (canceled?)");
 //        NA_LOG_DEBUG("Expected: pid=%d, tag=%d", poll_addr->pid,
 //            na_sm_hdr.hdr.tag);
+        /* Release copy buf so that late messages do not exhaust it */
+        na_sm_copy_and_free_buf(na_class, poll_addr->na_sm_copy_buf, NULL, 0,
+            na_sm_hdr.hdr.buf_idx);
         goto done;
     }
 
@@ -2440,7 +2802,7 @@ na_sm_initialize(na_class_t *na_class, const struct na_info NA_UNUSED *na_info,
     struct na_sm_addr *na_sm_addr = NULL;
     pid_t pid;
     hg_poll_set_t *poll_set;
-    na_bool_t no_wait = NA_FALSE;
+    na_bool_t no_wait = NA_FALSE, shared_recv = NA_FALSE;
     int local_notify;
     na_return_t ret = NA_SUCCESS;
 
@@ -2451,6 +2813,11 @@ na_sm_initialize(na_class_t *na_class, const struct na_info NA_UNUSED *na_info,
         /* Progress mode */
         if (na_info->na_init_info->progress_mode == NA_NO_BLOCK)
             no_wait = NA_TRUE;
+#ifdef HG_UTIL_HAS_SYSEVENTFD_H
+        /* Shared ring (requires event fds that can be passed to peers) */
+        if (listen)
+            shared_recv = na_info->na_init_info->sm_shared_recv;
+#endif
     }
 
     /* Get PID */
@@ -2468,6 +2835,19 @@ na_sm_initialize(na_class_t *na_class, const struct na_info NA_UNUSED *na_info,
     }
     memset(na_class->private_data, 0, sizeof(struct na_sm_private_data));
     NA_SM_PRIVATE_DATA(na_class)->no_wait = no_wait;
+    NA_SM_PRIVATE_DATA(na_class)->shared_recv = shared_recv;
+
+    /* Create addr tables */
+    NA_SM_PRIVATE_DATA(na_class)->peer_addr_table = hg_hash_table_new(
+        na_sm_peer_hash, na_sm_peer_equal);
+    NA_SM_PRIVATE_DATA(na_class)->conn_addr_table = hg_hash_table_new(
+        na_sm_conn_hash, na_sm_conn_equal);
+    if (!NA_SM_PRIVATE_DATA(na_class)->peer_addr_table
+        || !NA_SM_PRIVATE_DATA(na_class)->conn_addr_table) {
+        NA_LOG_ERROR("Could not create addr tables");
+        ret = NA_NOMEM_ERROR;
+        goto done;
+    }
 
     /* Create poll set to wait for events */
     poll_set = hg_poll_create();
@@ -2489,6 +2869,8 @@ na_sm_initialize(na_class_t *na_class, const struct na_info NA_UNUSED *na_info,
     na_sm_addr->pid = pid;
     na_sm_addr->id = (unsigned int) hg_atomic_incr32(&id) - 1;
     na_sm_addr->self = NA_TRUE;
+    na_sm_addr->sock = -1;
+    na_sm_addr->shared_notify = -1;
     hg_atomic_init32(&na_sm_addr->ref_count, 1);
     /* If we're listening, create a new shm region */
     if (listen) {
@@ -2513,6 +2895,21 @@ na_sm_initialize(na_class_t *na_class, const struct na_info NA_UNUSED *na_info,
         NA_LOG_ERROR("Could not add notify to poll set");
         goto done;
     }
+
+    /* Create event signaled by all peers writing to the shared ring */
+    if (shared_recv) {
+        na_sm_addr->shared_notify = hg_event_create();
+        if (na_sm_addr->shared_notify == HG_UTIL_FAIL) {
+            NA_LOG_ERROR("hg_event_create() failed");
+            ret = NA_PROTOCOL_ERROR;
+            goto done;
+        }
+        ret = na_sm_poll_register(na_class, NA_SM_SHARED_NOTIFY, na_sm_addr);
+        if (ret != NA_SUCCESS) {
+            NA_LOG_ERROR("Could not add shared notify to poll set");
+            goto done;
+        }
+    }
     NA_SM_PRIVATE_DATA(na_class)->self_addr = na_sm_addr;
 
     /* Initialize queues */
@@ -2538,6 +2935,9 @@ na_sm_initialize(na_class_t *na_class, const struct na_info NA_UNUSED *na_info,
             &NA_SM_PRIVATE_DATA(na_class)->expected_op_queue_lock);
     hg_thread_spin_init(
              &NA_SM_PRIVATE_DATA(na_class)->copy_buf_lock);
+    hg_thread_mutex_init(&NA_SM_PRIVATE_DATA(na_class)->peer_addr_lock);
+    hg_thread_spin_init(
+            &NA_SM_PRIVATE_DATA(na_class)->conn_addr_table_lock);
 
 done:
     return ret;
@@ -2622,6 +3022,13 @@ na_sm_finalize(na_class_t *na_class)
             &NA_SM_PRIVATE_DATA(na_class)->expected_op_queue_lock);
     hg_thread_spin_destroy(
              &NA_SM_PRIVATE_DATA(na_class)->copy_buf_lock);
+    hg_thread_mutex_destroy(&NA_SM_PRIVATE_DATA(na_class)->peer_addr_lock);
+    hg_thread_spin_destroy(
+            &NA_SM_PRIVATE_DATA(na_class)->conn_addr_table_lock);
+
+    /* Free addr tables */
+    hg_hash_table_free(NA_SM_PRIVATE_DATA(na_class)->peer_addr_table);
+    hg_hash_table_free(NA_SM_PRIVATE_DATA(na_class)->conn_addr_table);
 
     free(na_class->private_data);
 
@@ -2660,6 +3067,9 @@ na_sm_check_feature(na_class_t NA_UNUSED *na_class, na_uint8_t feature)
         case NA_HAS_TAG_MASK:
             ret = NA_FALSE;
             break;
+        case NA_HAS_MSG_SEGMENTS:
+            ret = NA_TRUE;
+            break;
         default:
             break;
     }
@@ -2667,6 +3077,39 @@ na_sm_check_feature(na_class_t NA_UNUSED *na_class, na_uint8_t feature)
     return ret;
 }
 
+#ifdef HG_UTIL_HAS_STATS
+/*---------------------------------------------------------------------------*/
+static na_return_t
+na_sm_context_create(na_class_t NA_UNUSED *na_class, void **plugin_context)
+{
+    struct na_sm_context *na_sm_context = NULL;
+    na_return_t ret = NA_SUCCESS;
+
+    na_sm_context = (struct na_sm_context *) malloc(
+        sizeof(struct na_sm_context));
+    if (!na_sm_context) {
+        NA_LOG_ERROR("Could not allocate NA SM context");
+        ret = NA_NOMEM_ERROR;
+        goto done;
+    }
+    hg_atomic_init64(&na_sm_context->wait_time, 0);
+
+    *plugin_context = na_sm_context;
+
+done:
+    return ret;
+}
+
+/*---------------------------------------------------------------------------*/
+static na_return_t
+na_sm_context_destroy(na_class_t NA_UNUSED *na_class, void *plugin_context)
+{
+    free(plugin_context);
+
+    return NA_SUCCESS;
+}
+#endif
+
 /*---------------------------------------------------------------------------*/
 static na_op_id_t
 na_sm_op_create(na_class_t *na_class)
@@ -2714,12 +3157,13 @@ na_sm_addr_lookup(na_class_t *na_class, na_context_t *context,
     na_cb_t callback, void *arg, const char *name, na_op_id_t *op_id)
 {
     struct na_sm_op_id *na_sm_op_id = NULL;
-    struct na_sm_addr *na_sm_addr = NULL;
+    struct na_sm_addr *na_sm_addr = NULL, peer_key;
     struct na_sm_copy_buf *na_sm_copy_buf = NULL;
     char filename[NA_SM_MAX_FILENAME];
     char pathname[NA_SM_MAX_FILENAME];
     int conn_sock;
     char *name_string = NULL, *short_name = NULL;
+    na_bool_t peer_locked = NA_FALSE, connected = NA_FALSE;
     na_return_t ret = NA_SUCCESS;
 
     /* Allocate op_id if not provided */
@@ -2743,17 +3187,6 @@ na_sm_addr_lookup(na_class_t *na_class, na_context_t *context,
     hg_atomic_set32(&na_sm_op_id->completed, NA_FALSE);
     hg_atomic_set32(&na_sm_op_id->canceled, NA_FALSE);
 
-    /* Allocate addr */
-    na_sm_addr = (struct na_sm_addr *) malloc(sizeof(struct na_sm_addr));
-    if (!na_sm_addr) {
-        NA_LOG_ERROR("Could not allocate NA SM addr");
-        ret = NA_NOMEM_ERROR;
-        goto done;
-    }
-    memset(na_sm_addr, 0, sizeof(struct na_sm_addr));
-    hg_atomic_init32(&na_sm_addr->ref_count, 1);
-    na_sm_op_id->info.lookup.na_sm_addr = na_sm_addr;
-
     /**
      * Clean up name, strings can be of the format:
      *   <protocol>://<host string>
@@ -2771,18 +3204,86 @@ na_sm_addr_lookup(na_class_t *na_class, na_context_t *context,
          short_name = name_string;
 
     /* Get PID / ID from name */
-    sscanf(short_name, "%d/%u", &na_sm_addr->pid, &na_sm_addr->id);
+    memset(&peer_key, 0, sizeof(struct na_sm_addr));
+    sscanf(short_name, "%d/%u", &peer_key.pid, &peer_key.id);
+
+    /* Share the connection if the peer was already looked up */
+    hg_thread_mutex_lock(&NA_SM_PRIVATE_DATA(na_class)->peer_addr_lock);
+    peer_locked = NA_TRUE;
+    na_sm_addr = (struct na_sm_addr *) hg_hash_table_lookup(
+        NA_SM_PRIVATE_DATA(na_class)->peer_addr_table,
+        (hg_hash_table_key_t) &peer_key);
+    if (na_sm_addr != HG_HASH_TABLE_NULL) {
+        hg_atomic_incr32(&na_sm_addr->ref_count);
+        na_sm_op_id->info.lookup.na_sm_addr = na_sm_addr;
+
+        /* Wait for the connection if it is still being established */
+        hg_thread_spin_lock(
+            &NA_SM_PRIVATE_DATA(na_class)->lookup_op_queue_lock);
+        if (na_sm_addr->sock_progress == NA_SM_SOCK_DONE)
+            connected = NA_TRUE;
+        else
+            HG_QUEUE_PUSH_TAIL(&NA_SM_PRIVATE_DATA(na_class)->lookup_op_queue,
+                na_sm_op_id, entry);
+        hg_thread_spin_unlock(
+            &NA_SM_PRIVATE_DATA(na_class)->lookup_op_queue_lock);
+        hg_thread_mutex_unlock(&NA_SM_PRIVATE_DATA(na_class)->peer_addr_lock);
+        peer_locked = NA_FALSE;
+
+        /* Assign op_id */
+        if (op_id && op_id != NA_OP_ID_IGNORE && *op_id == NA_OP_ID_NULL)
+            *op_id = na_sm_op_id;
+
+        if (connected) {
+            /* Immediate completion */
+            ret = na_sm_complete(na_sm_op_id);
+            if (ret != NA_SUCCESS) {
+                NA_LOG_ERROR("Could not complete operation");
+                /* Release reference taken for the lookup */
+                hg_atomic_decr32(&na_sm_addr->ref_count);
+                goto done;
+            }
+
+            /* Notify local completion */
+            if (!NA_SM_PRIVATE_DATA(na_class)->no_wait
+                && (hg_event_set(
+                    NA_SM_PRIVATE_DATA(na_class)->self_addr->local_notify)
+                != HG_UTIL_SUCCESS)) {
+                NA_LOG_ERROR("Could not signal local completion");
+                ret = NA_PROTOCOL_ERROR;
+                goto done;
+            }
+        }
+        goto done;
+    }
+
+    /* Allocate addr */
+    na_sm_addr = (struct na_sm_addr *) malloc(sizeof(struct na_sm_addr));
+    if (!na_sm_addr) {
+        NA_LOG_ERROR("Could not allocate NA SM addr");
+        ret = NA_NOMEM_ERROR;
+        goto done;
+    }
+    memset(na_sm_addr, 0, sizeof(struct na_sm_addr));
+    hg_atomic_init32(&na_sm_addr->ref_count, 1);
+    na_sm_addr->pid = peer_key.pid;
+    na_sm_addr->id = peer_key.id;
+    na_sm_op_id->info.lookup.na_sm_addr = na_sm_addr;
 
     /* Open shared copy buf */
     NA_SM_GEN_SHM_NAME(filename, na_sm_addr);
     na_sm_copy_buf = (struct na_sm_copy_buf *) na_sm_open_shared_buf(
         filename, sizeof(struct na_sm_copy_buf), NA_FALSE);
     if (!na_sm_copy_buf) {
+        /* No peer was ever created with that name */
+        ret = (errno == ENOENT) ? NA_NOENTRY_ERROR : NA_PROTOCOL_ERROR;
         NA_LOG_ERROR("Could not open copy buf");
-        ret = NA_PROTOCOL_ERROR;
         goto done;
     }
     na_sm_addr->na_sm_copy_buf = na_sm_copy_buf;
+    /* Peer reads all our messages from its shared ring if enabled */
+    na_sm_addr->shared_recv = (na_bool_t) hg_atomic_get32(
+        &na_sm_copy_buf->shared_ring.enabled.val);
 
     /* Open SHM sock */
     NA_SM_GEN_SOCK_PATH(pathname, na_sm_addr);
@@ -2821,9 +3322,20 @@ na_sm_addr_lookup(na_class_t *na_class, na_context_t *context,
         goto done;
     }
 
+    /* Later lookups of that peer share this addr */
+    if (!hg_hash_table_insert(NA_SM_PRIVATE_DATA(na_class)->peer_addr_table,
+        (hg_hash_table_key_t) na_sm_addr, (hg_hash_table_value_t) na_sm_addr)) {
+        NA_LOG_ERROR("Could not insert addr into peer table");
+        ret = NA_NOMEM_ERROR;
+        goto done;
+    }
+
 done:
+    if (peer_locked)
+        hg_thread_mutex_unlock(&NA_SM_PRIVATE_DATA(na_class)->peer_addr_lock);
     if (ret != NA_SUCCESS) {
-        free(na_sm_addr);
+        if (!connected)
+            free(na_sm_addr);
         na_sm_op_destroy(na_class, (na_op_id_t) na_sm_op_id);
     }
     free(name_string);
@@ -2849,26 +3361,41 @@ na_sm_addr_free(na_class_t *na_class, na_addr_t addr)
         goto done;
     }
 
-    if (hg_atomic_decr32(&na_sm_addr->ref_count)) {
+    if (!na_sm_addr->self && !na_sm_addr->accepted) {
+        /* Lookup addrs are shared, remove from peer table on last release */
+        hg_thread_mutex_lock(&NA_SM_PRIVATE_DATA(na_class)->peer_addr_lock);
+        if (hg_atomic_decr32(&na_sm_addr->ref_count)) {
+            hg_thread_mutex_unlock(
+                &NA_SM_PRIVATE_DATA(na_class)->peer_addr_lock);
+            /* Cannot free yet */
+            goto done;
+        }
+        hg_hash_table_remove(NA_SM_PRIVATE_DATA(na_class)->peer_addr_table,
+            (hg_hash_table_key_t) na_sm_addr);
+        hg_thread_mutex_unlock(&NA_SM_PRIVATE_DATA(na_class)->peer_addr_lock);
+    } else if (hg_atomic_decr32(&na_sm_addr->ref_count)) {
         /* Cannot free yet */
         goto done;
     }
 
-    /* Deregister event file descriptors from poll set */
-    ret = na_sm_poll_deregister(na_class, NA_SM_NOTIFY, na_sm_addr);
-    if (ret != NA_SUCCESS) {
-        NA_LOG_ERROR("Could not delete notify from poll set");
-        goto done;
-    }
+    /* Accepted addrs of a shared ring use the shared notify of self addr */
+    if (!NA_SM_SHARED_RECV(na_class, na_sm_addr)) {
+        /* Deregister event file descriptors from poll set */
+        ret = na_sm_poll_deregister(na_class, NA_SM_NOTIFY, na_sm_addr);
+        if (ret != NA_SUCCESS) {
+            NA_LOG_ERROR("Could not delete notify from poll set");
+            goto done;
+        }
 
-    /* Destroy local event */
+        /* Destroy local event */
 #ifdef HG_UTIL_HAS_SYSEVENTFD_H
-    if (hg_event_destroy(na_sm_addr->local_notify) == HG_UTIL_FAIL) {
-        NA_LOG_ERROR("hg_event_destroy() failed");
-        ret = NA_PROTOCOL_ERROR;
-        goto done;
-    }
+        if (hg_event_destroy(na_sm_addr->local_notify) == HG_UTIL_FAIL) {
+            NA_LOG_ERROR("hg_event_destroy() failed");
+            ret = NA_PROTOCOL_ERROR;
+            goto done;
+        }
 #endif
+    }
 
     if (!na_sm_addr->self) { /* Created by lookup/connect or accept */
 #ifndef HG_UTIL_HAS_SYSEVENTFD_H
@@ -2884,13 +3411,23 @@ na_sm_addr_free(na_class_t *na_class, na_addr_t addr)
             goto done;
         }
 
-        /* Remove addr from poll addr queue */
-        hg_thread_spin_lock(
-            &NA_SM_PRIVATE_DATA(na_class)->poll_addr_queue_lock);
-        HG_QUEUE_REMOVE(&NA_SM_PRIVATE_DATA(na_class)->poll_addr_queue,
-            na_sm_addr, na_sm_addr, poll_entry);
-        hg_thread_spin_unlock(
-            &NA_SM_PRIVATE_DATA(na_class)->poll_addr_queue_lock);
+        if (NA_SM_SHARED_RECV(na_class, na_sm_addr)) {
+            /* Remove addr from conn addr table */
+            hg_thread_spin_lock(
+                &NA_SM_PRIVATE_DATA(na_class)->conn_addr_table_lock);
+            hg_hash_table_remove(NA_SM_PRIVATE_DATA(na_class)->conn_addr_table,
+                (hg_hash_table_key_t) &na_sm_addr->conn_id);
+            hg_thread_spin_unlock(
+                &NA_SM_PRIVATE_DATA(na_class)->conn_addr_table_lock);
+        } else {
+            /* Remove addr from poll addr queue */
+            hg_thread_spin_lock(
+                &NA_SM_PRIVATE_DATA(na_class)->poll_addr_queue_lock);
+            HG_QUEUE_REMOVE(&NA_SM_PRIVATE_DATA(na_class)->poll_addr_queue,
+                na_sm_addr, na_sm_addr, poll_entry);
+            hg_thread_spin_unlock(
+                &NA_SM_PRIVATE_DATA(na_class)->poll_addr_queue_lock);
+        }
 
         if (na_sm_addr->accepted) { /* Create by accept */
             /* Get file names from ring bufs / events to delete files */
@@ -2959,6 +3496,22 @@ na_sm_addr_free(na_class_t *na_class, na_addr_t addr)
                 goto done;
             }
 
+            if (NA_SM_PRIVATE_DATA(na_class)->shared_recv) {
+                ret = na_sm_poll_deregister(na_class, NA_SM_SHARED_NOTIFY,
+                    na_sm_addr);
+                if (ret != NA_SUCCESS) {
+                    NA_LOG_ERROR("Could not delete shared notify from poll set");
+                    goto done;
+                }
+
+                if (hg_event_destroy(na_sm_addr->shared_notify)
+                    == HG_UTIL_FAIL) {
+                    NA_LOG_ERROR("hg_event_destroy() failed");
+                    ret = NA_PROTOCOL_ERROR;
+                    goto done;
+                }
+            }
+
             NA_SM_GEN_SHM_NAME(na_sm_copy_buf_name, na_sm_addr);
             copy_buf_name = na_sm_copy_buf_name;
             NA_SM_GEN_SOCK_PATH(na_sock_name, na_sm_addr);
@@ -3096,14 +3649,32 @@ na_sm_msg_get_max_tag(const na_class_t NA_UNUSED *na_class)
 static na_return_t
 na_sm_msg_send_unexpected(na_class_t *na_class, na_context_t *context,
     na_cb_t callback, void *arg, const void *buf, na_size_t buf_size,
-    void NA_UNUSED *plugin_data, na_addr_t dest, na_tag_t tag,
-    na_op_id_t *op_id)
+    void *plugin_data, na_addr_t dest, na_tag_t tag, na_op_id_t *op_id)
+{
+    struct na_segment segment;
+
+    segment.address = (na_ptr_t) buf;
+    segment.size = buf_size;
+
+    return na_sm_msg_send_unexpected_segments(na_class, context, callback, arg,
+        &segment, 1, plugin_data, dest, tag, op_id);
+}
+
+/*---------------------------------------------------------------------------*/
+static na_return_t
+na_sm_msg_send_unexpected_segments(na_class_t *na_class, na_context_t *context,
+    na_cb_t callback, void *arg, const struct na_segment *segments,
+    na_size_t segment_count, void NA_UNUSED *plugin_data, na_addr_t dest,
+    na_tag_t tag, na_op_id_t *op_id)
 {
     struct na_sm_op_id *na_sm_op_id = NULL;
     struct na_sm_addr *na_sm_addr = (struct na_sm_addr *) dest;
+    na_size_t buf_size = 0, i;
     unsigned int idx_reserved;
     na_return_t ret = NA_SUCCESS;
 
+    for (i = 0; i < segment_count; i++)
+        buf_size += segments[i].size;
     if (buf_size > NA_SM_UNEXPECTED_SIZE) {
         NA_LOG_ERROR("Exceeds unexpected size");
         ret = NA_SIZE_ERROR;
@@ -3138,7 +3709,7 @@ na_sm_msg_send_unexpected(na_class_t *na_class, na_context_t *context,
     /* Try to reserve buffer atomically */
     do {
         ret = na_sm_reserve_and_copy_buf(na_class, na_sm_addr->na_sm_copy_buf,
-            buf, buf_size, &idx_reserved);
+            segments, segment_count, &idx_reserved);
         if (ret != NA_SUCCESS) {
             na_return_t progress_ret = na_sm_progress(na_class, context, 0);
 
@@ -3250,16 +3821,34 @@ done:
 
 /*---------------------------------------------------------------------------*/
 static na_return_t
-na_sm_msg_send_expected(na_class_t NA_UNUSED *na_class, na_context_t *context,
+na_sm_msg_send_expected(na_class_t *na_class, na_context_t *context,
     na_cb_t callback, void *arg, const void *buf, na_size_t buf_size,
-    void NA_UNUSED *plugin_data, na_addr_t dest, na_tag_t tag,
-    na_op_id_t *op_id)
+    void *plugin_data, na_addr_t dest, na_tag_t tag, na_op_id_t *op_id)
+{
+    struct na_segment segment;
+
+    segment.address = (na_ptr_t) buf;
+    segment.size = buf_size;
+
+    return na_sm_msg_send_expected_segments(na_class, context, callback, arg,
+        &segment, 1, plugin_data, dest, tag, op_id);
+}
+
+/*---------------------------------------------------------------------------*/
+static na_return_t
+na_sm_msg_send_expected_segments(na_class_t *na_class, na_context_t *context,
+    na_cb_t callback, void *arg, const struct na_segment *segments,
+    na_size_t segment_count, void NA_UNUSED *plugin_data, na_addr_t dest,
+    na_tag_t tag, na_op_id_t *op_id)
 {
     struct na_sm_op_id *na_sm_op_id = NULL;
     struct na_sm_addr *na_sm_addr = (struct na_sm_addr *) dest;
+    na_size_t buf_size = 0, i;
     unsigned int idx_reserved;
     na_return_t ret = NA_SUCCESS;
 
+    for (i = 0; i < segment_count; i++)
+        buf_size += segments[i].size;
     if (buf_size > NA_SM_EXPECTED_SIZE) {
         NA_LOG_ERROR("Exceeds expected size");
         ret = NA_SIZE_ERROR;
@@ -3294,7 +3883,7 @@ na_sm_msg_send_expected(na_class_t NA_UNUSED *na_class, na_context_t *context,
     /* Try to reserve buffer atomically */
     do {
         ret = na_sm_reserve_and_copy_buf(na_class, na_sm_addr->na_sm_copy_buf,
-            buf, buf_size, &idx_reserved);
+            segments, segment_count, &idx_reserved);
         if (ret != NA_SUCCESS) {
             na_return_t progress_ret = na_sm_progress(na_class, context, 0);
 
@@ -3369,12 +3958,17 @@ na_sm_msg_recv_expected(na_class_t *na_class, na_context_t *context,
         *op_id = na_sm_op_id;
 
     /* Expected messages must always be pre-posted, therefore a message should
-     * never arrive before that call returns (not completes), simply add
-     * op_id to queue */
+     * never arrive before that call returns (not completes). Tags of recvs
+     * in flight usually differ in their low bits, so store op_id in the slot
+     * of its tag on source addr so that it is matched without searching,
+     * only add op_id to queue if that slot is taken */
     hg_thread_spin_lock(
         &NA_SM_PRIVATE_DATA(na_class)->expected_op_queue_lock);
-    HG_QUEUE_PUSH_TAIL(&NA_SM_PRIVATE_DATA(na_class)->expected_op_queue,
-        na_sm_op_id, entry);
+    if (source && !*NA_SM_REPLY_SLOT((struct na_sm_addr *) source, tag))
+        *NA_SM_REPLY_SLOT((struct na_sm_addr *) source, tag) = na_sm_op_id;
+    else
+        HG_QUEUE_PUSH_TAIL(&NA_SM_PRIVATE_DATA(na_class)->expected_op_queue,
+            na_sm_op_id, entry);
     hg_thread_spin_unlock(
         &NA_SM_PRIVATE_DATA(na_class)->expected_op_queue_lock);
 
@@ -3921,6 +4515,12 @@ na_sm_poll_try_wait(na_class_t *na_class, na_context_t NA_UNUSED *context)
     struct na_sm_addr *na_sm_addr;
     na_bool_t ret = NA_TRUE;
 
+    /* Check whether something was announced on the shared ring */
+    if (NA_SM_PRIVATE_DATA(na_class)->shared_recv
+        && !hg_atomic_queue_is_empty(&NA_SM_PRIVATE_DATA(na_class)->self_addr
+            ->na_sm_copy_buf->shared_ring.queue))
+        return NA_FALSE;
+
     /* Check whether something is in one of the ring buffers */
     hg_thread_spin_lock(&NA_SM_PRIVATE_DATA(na_class)->poll_addr_queue_lock);
     HG_QUEUE_FOREACH(na_sm_addr, &NA_SM_PRIVATE_DATA(na_class)->poll_addr_queue,
@@ -3935,14 +4535,38 @@ na_sm_poll_try_wait(na_class_t *na_class, na_context_t NA_UNUSED *context)
     return ret;
 }
 
+#ifdef HG_UTIL_HAS_STATS
+/*---------------------------------------------------------------------------*/
+static na_uint64_t
+na_sm_poll_wait_time(na_class_t NA_UNUSED *na_class, na_context_t *context)
+{
+    struct na_sm_context *na_sm_context =
+        (struct na_sm_context *) context->plugin_context;
+
+    return (na_uint64_t) hg_atomic_get64(&na_sm_context->wait_time);
+}
+#endif
+
 /*---------------------------------------------------------------------------*/
 static na_return_t
-na_sm_progress(na_class_t *na_class, na_context_t NA_UNUSED *context,
+na_sm_progress(na_class_t *na_class, na_context_t *context,
     unsigned int timeout)
 {
     double remaining = timeout / 1000.0; /* Convert timeout in ms into seconds */
+#ifdef HG_UTIL_HAS_STATS
+    struct na_sm_context *na_sm_context =
+        (struct na_sm_context *) context->plugin_context;
+    hg_util_uint64_t wait_time = 0;
+    hg_util_uint64_t *wait_time_ptr = &wait_time;
+#else
+    hg_util_uint64_t *wait_time_ptr = NULL;
+#endif
     na_return_t ret = NA_TIMEOUT;
 
+#ifndef HG_UTIL_HAS_STATS
+    (void) context;
+#endif
+
     do {
         hg_time_t t1, t2;
         hg_util_bool_t progressed;
@@ -3950,8 +4574,9 @@ na_sm_progress(na_class_t *na_class, na_context_t NA_UNUSED *context,
         if (timeout)
             hg_time_get_current(&t1);
 
-        if (hg_poll_wait(NA_SM_PRIVATE_DATA(na_class)->poll_set,
-            (unsigned int) (remaining * 1000.0), &progressed) != HG_UTIL_SUCCESS) {
+        if (hg_poll_wait_timed(NA_SM_PRIVATE_DATA(na_class)->poll_set,
+            (unsigned int) (remaining * 1000.0), &progressed, wait_time_ptr)
+            != HG_UTIL_SUCCESS) {
             NA_LOG_ERROR("hg_poll_wait() failed");
             ret = NA_PROTOCOL_ERROR;
             goto done;
@@ -3970,6 +4595,11 @@ na_sm_progress(na_class_t *na_class, na_context_t NA_UNUSED *context,
     } while ((int)(remaining * 1000.0) > 0);
 
 done:
+#ifdef HG_UTIL_HAS_STATS
+    if (wait_time)
+        hg_atomic_add64(&na_sm_context->wait_time,
+            (hg_util_int64_t) wait_time);
+#endif
     return ret;
 }
 
@@ -4023,17 +4653,28 @@ na_sm_cancel(na_class_t *na_class, na_context_t NA_UNUSED *context,
             /* Nothing */
             break;
         case NA_CB_RECV_EXPECTED: {
+            struct na_sm_addr *na_sm_addr =
+                na_sm_op_id->info.recv_expected.na_sm_addr;
             struct na_sm_op_id *na_sm_var_op_id = NULL;
 
-            /* Must remove op_id from unexpected op_id queue */
+            /* Must remove op_id from its reply slot or from expected op_id
+             * queue */
             hg_thread_spin_lock(
                 &NA_SM_PRIVATE_DATA(na_class)->expected_op_queue_lock);
-            HG_QUEUE_FOREACH(na_sm_var_op_id,
-                &NA_SM_PRIVATE_DATA(na_class)->expected_op_queue, entry) {
-                if (na_sm_var_op_id == na_sm_op_id) {
-                    HG_QUEUE_REMOVE(&NA_SM_PRIVATE_DATA(na_class)->expected_op_queue,
-                        na_sm_var_op_id, na_sm_op_id, entry);
-                    break;
+            if (na_sm_addr && *NA_SM_REPLY_SLOT(na_sm_addr,
+                na_sm_op_id->info.recv_expected.tag) == na_sm_op_id) {
+                *NA_SM_REPLY_SLOT(na_sm_addr,
+                    na_sm_op_id->info.recv_expected.tag) = NULL;
+                na_sm_var_op_id = na_sm_op_id;
+            } else {
+                HG_QUEUE_FOREACH(na_sm_var_op_id,
+                    &NA_SM_PRIVATE_DATA(na_class)->expected_op_queue, entry) {
+                    if (na_sm_var_op_id == na_sm_op_id) {
+                        HG_QUEUE_REMOVE(
+                            &NA_SM_PRIVATE_DATA(na_class)->expected_op_queue,
+                            na_sm_var_op_id, na_sm_op_id, entry);
+                        break;
+                    }
                 }
             }
             hg_thread_spin_unlock(
@@ -0,0 +1,629 @@
+/*
+ * Copyright (C) 2013-2017 Argonne National Laboratory, Department of Energy,
+ *                    UChicago Argonne, LLC and The HDF Group.
+ * All rights reserved.
+ *
+ * The full copyright notice, including terms governing use, modification,
+ * and redistribution, is contained in the COPYING file that can be
+ * found at the root of the source code distribution tree.
+ */
+
+/*
+ * hg_proc_gen: generate proc routines from a schema description.
+ *
+ * The schema is a list of struct definitions, for instance:
+ *
+ *   # comment
+ *   struct rpc_handle_t {
+ *       hg_uint64_t cookie;
+ *   };
+ *
+ *   struct rpc_open_in_t {
+ *       hg_const_string_t path;
+ *       rpc_handle_t handle;
+ *       hg_uint32_t flags[4];
+ *   };
+ *
+ * For each struct, a typedef and an hg_proc_<name>() routine are emitted.
+ * Consecutive fixed-size fields (integers and fixed-size arrays of integers)
+ * are grouped into a single section that is bounds-checked once and copied
+ * with plain memcpy(), or with a single memcpy() if the section is laid out
+ * without padding. Other fields fall back to their hg_proc_<type>() routine.
+ * The wire format is identical to the one produced by MERCURY_GEN_PROC.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+#include <stdarg.h>
+
+/****************/
+/* Local Macros */
+/****************/
+
+#define HG_GEN_MAX_NAME     64
+#define HG_GEN_MAX_FIELDS   128
+#define HG_GEN_MAX_STRUCTS  256
+
+/************************************/
+/* Local Type and Struct Definition */
+/************************************/
+
+struct hg_gen_field {
+    char type[HG_GEN_MAX_NAME];
+    char name[HG_GEN_MAX_NAME];
+    unsigned long count;        /* Array count (0 if scalar) */
+    size_t type_size;           /* Size of fixed-size type (0 otherwise) */
+};
+
+struct hg_gen_struct {
+    char name[HG_GEN_MAX_NAME];
+    struct hg_gen_field fields[HG_GEN_MAX_FIELDS];
+    unsigned int n_fields;
+};
+
+struct hg_gen_parser {
+    FILE *file;
+    const char *file_name;
+    unsigned int line;
+    char token[HG_GEN_MAX_NAME];
+};
+
+struct hg_gen_type {
+    const char *name;
+    size_t size;
+};
+
+/********************/
+/* Local Prototypes */
+/********************/
+
+/**
+ * Print error and exit.
+ */
+static void
+hg_gen_error(
+        const struct hg_gen_parser *parser,
+        const char *fmt,
+        ...
+        );
+
+/**
+ * Read next token, return 0 at end of file.
+ */
+static int
+hg_gen_next_token(
+        struct hg_gen_parser *parser
+        );
+
+/**
+ * Read next token and check that it matches expected.
+ */
+static void
+hg_gen_expect(
+        struct hg_gen_parser *parser,
+        const char *expected
+        );
+
+/**
+ * Get size of fixed-size type (0 if not fixed).
+ */
+static size_t
+hg_gen_type_size(
+        const char *type
+        );
+
+/**
+ * Parse schema.
+ */
+static unsigned int
+hg_gen_parse(
+        struct hg_gen_parser *parser,
+        struct hg_gen_struct *structs,
+        unsigned int max_structs
+        );
+
+/**
+ * Get encoded size of fixed-size field.
+ */
+static size_t
+hg_gen_field_size(
+        const struct hg_gen_field *field
+        );
+
+/**
+ * Write section of consecutive fixed-size fields.
+ */
+static void
+hg_gen_write_section(
+        FILE *out,
+        const struct hg_gen_struct *gen_struct,
+        unsigned int first,
+        unsigned int last
+        );
+
+/**
+ * Write proc call for a single field.
+ */
+static void
+hg_gen_write_field(
+        FILE *out,
+        const struct hg_gen_field *field,
+        const char *indent
+        );
+
+/**
+ * Write struct definition and proc routine.
+ */
+static void
+hg_gen_write_struct(
+        FILE *out,
+        const struct hg_gen_struct *gen_struct
+        );
+
+/**
+ * Write header.
+ */
+static void
+hg_gen_write(
+        FILE *out,
+        const char *guard,
+        const struct hg_gen_struct *structs,
+        unsigned int n_structs
+        );
+
+/*******************/
+/* Local Variables */
+/*******************/
+
+/* Fixed-size types that are encoded with memcpy */
+static const struct hg_gen_type hg_gen_fixed_types_g[] = {
+    { "hg_int8_t",      1 },
+    { "hg_uint8_t",     1 },
+    { "hg_int16_t",     2 },
+    { "hg_uint16_t",    2 },
+    { "hg_int32_t",     4 },
+    { "hg_uint32_t",    4 },
+    { "hg_int64_t",     8 },
+    { "hg_uint64_t",    8 },
+    { "int8_t",         1 },
+    { "uint8_t",        1 },
+    { "int16_t",        2 },
+    { "uint16_t",       2 },
+    { "int32_t",        4 },
+    { "uint32_t",       4 },
+    { "int64_t",        8 },
+    { "uint64_t",       8 },
+    { "hg_bool_t",      1 },
+    { "hg_id_t",        4 },
+    { "hg_size_t",      8 },
+    { "hg_ptr_t",       8 },
+    { NULL,             0 }
+};
+
+/*---------------------------------------------------------------------------*/
+static void
+hg_gen_error(const struct hg_gen_parser *parser, const char *fmt, ...)
+{
+    va_list ap;
+
+    fprintf(stderr, "%s:%u: error: ", parser->file_name, parser->line);
+    va_start(ap, fmt);
+    vfprintf(stderr, fmt, ap);
+    va_end(ap);
+    fprintf(stderr, "\n");
+
+    exit(EXIT_FAILURE);
+}
+
+/*---------------------------------------------------------------------------*/
+static int
+hg_gen_next_token(struct hg_gen_parser *parser)
+{
+    int c;
+    size_t len = 0;
+
+    /* Skip blanks and comments */
+    for (;;) {
+        c = fgetc(parser->file);
+        if (c == '\n')
+            parser->line++;
+        else if (c == '#') {
+            while ((c = fgetc(parser->file)) != EOF && c != '\n');
+            if (c == EOF)
+                return 0;
+            parser->line++;
+        } else if (c == EOF)
+            return 0;
+        else if (!isspace(c))
+            break;
+    }
+
+    if (isalnum(c) || c == '_') {
+        do {
+            if (len == HG_GEN_MAX_NAME - 1)
+                hg_gen_error(parser, "identifier too long");
+            parser->token[len++] = (char) c;
+            c = fgetc(parser->file);
+        } while (isalnum(c) || c == '_');
+        ungetc(c, parser->file);
+    } else if (strchr("{};[]", c))
+        parser->token[len++] = (char) c;
+    else
+        hg_gen_error(parser, "unexpected character '%c'", c);
+    parser->token[len] = '\0';
+
+    return 1;
+}
+
+/*---------------------------------------------------------------------------*/
+static void
+hg_gen_expect(struct hg_gen_parser *parser, const char *expected)
+{
+    if (!hg_gen_next_token(parser))
+        hg_gen_error(parser, "expected '%s' before end of file", expected);
+    if (strcmp(parser->token, expected))
+        hg_gen_error(parser, "expected '%s', found '%s'", expected,
+            parser->token);
+}
+
+/*---------------------------------------------------------------------------*/
+static size_t
+hg_gen_type_size(const char *type)
+{
+    const struct hg_gen_type *fixed_type;
+
+    for (fixed_type = hg_gen_fixed_types_g; fixed_type->name; fixed_type++)
+        if (!strcmp(fixed_type->name, type))
+            return fixed_type->size;
+
+    return 0;
+}
+
+/*---------------------------------------------------------------------------*/
+static unsigned int
+hg_gen_parse(struct hg_gen_parser *parser, struct hg_gen_struct *structs,
+    unsigned int max_structs)
+{
+    unsigned int n_structs = 0;
+
+    while (hg_gen_next_token(parser)) {
+        struct hg_gen_struct *gen_struct;
+
+        if (strcmp(parser->token, "struct"))
+            hg_gen_error(parser, "expected 'struct', found '%s'",
+                parser->token);
+        if (n_structs == max_structs)
+            hg_gen_error(parser, "too many structs");
+        gen_struct = &structs[n_structs++];
+        memset(gen_struct, 0, sizeof(*gen_struct));
+
+        if (!hg_gen_next_token(parser) || !(isalpha(parser->token[0])
+            || parser->token[0] == '_'))
+            hg_gen_error(parser, "expected struct name");
+        strcpy(gen_struct->name, parser->token);
+        hg_gen_expect(parser, "{");
+
+        for (;;) {
+            struct hg_gen_field *field;
+
+            if (!hg_gen_next_token(parser))
+                hg_gen_error(parser, "unterminated struct '%s'",
+                    gen_struct->name);
+            if (!strcmp(parser->token, "}"))
+                break;
+            if (gen_struct->n_fields == HG_GEN_MAX_FIELDS)
+                hg_gen_error(parser, "too many fields in '%s'",
+                    gen_struct->name);
+            field = &gen_struct->fields[gen_struct->n_fields++];
+
+            /* Type */
+            strcpy(field->type, parser->token);
+            field->type_size = hg_gen_type_size(field->type);
+
+            /* Name */
+            if (!hg_gen_next_token(parser) || !(isalpha(parser->token[0])
+                || parser->token[0] == '_'))
+                hg_gen_error(parser, "expected field name");
+            strcpy(field->name, parser->token);
+
+            /* Optional array count */
+            if (!hg_gen_next_token(parser))
+                hg_gen_error(parser, "unexpected end of file");
+            if (!strcmp(parser->token, "[")) {
+                char *end;
+
+                if (!hg_gen_next_token(parser))
+                    hg_gen_error(parser, "unexpected end of file");
+                field->count = strtoul(parser->token, &end, 10);
+                if (*end != '\0' || !field->count)
+                    hg_gen_error(parser, "invalid array count '%s'",
+                        parser->token);
+                hg_gen_expect(parser, "]");
+                hg_gen_expect(parser, ";");
+            } else if (strcmp(parser->token, ";"))
+                hg_gen_error(parser, "expected ';', found '%s'",
+                    parser->token);
+        }
+        if (!gen_struct->n_fields)
+            hg_gen_error(parser, "struct '%s' has no fields", gen_struct->name);
+        hg_gen_expect(parser, ";");
+    }
+
+    return n_structs;
+}
+
+/*---------------------------------------------------------------------------*/
+static size_t
+hg_gen_field_size(const struct hg_gen_field *field)
+{
+    return field->type_size * (field->count ? field->count : 1);
+}
+
+/*---------------------------------------------------------------------------*/
+static void
+hg_gen_write_section(FILE *out, const struct hg_gen_struct *gen_struct,
+    unsigned int first, unsigned int last)
+{
+    const struct hg_gen_field *fields = gen_struct->fields;
+    size_t section_size = 0, offset;
+    unsigned int i;
+
+    for (i = first; i <= last; i++)
+        section_size += hg_gen_field_size(&fields[i]);
+
+    fprintf(out, "    /* Fixed-size section:");
+    for (i = first; i <= last; i++)
+        fprintf(out, " %s%s", fields[i].name, (i < last) ? "," : "");
+    fprintf(out, " */\n");
+    fprintf(out, "#ifndef HG_HAS_XDR\n");
+    fprintf(out, "    if (!compact) {\n");
+    fprintf(out, "        if (op != HG_FREE) {\n");
+    fprintf(out, "            if (op == HG_DECODE\n");
+    fprintf(out, "                && hg_proc_get_size_left(proc) < %lu) {\n",
+        (unsigned long) section_size);
+    fprintf(out, "                HG_LOG_ERROR(\"Not enough data left to decode\");\n");
+    fprintf(out, "                return HG_SIZE_ERROR;\n");
+    fprintf(out, "            }\n");
+    fprintf(out, "            buf_ptr = (char *) hg_proc_save_ptr(proc, %lu);\n",
+        (unsigned long) section_size);
+    fprintf(out, "            if (!buf_ptr) {\n");
+    fprintf(out, "                HG_LOG_ERROR(\"Could not get proc buffer\");\n");
+    fprintf(out, "                return HG_SIZE_ERROR;\n");
+    fprintf(out, "            }\n");
+
+    /* Single memcpy if the section has no padding */
+    if (first != last) {
+        fprintf(out, "            if (offsetof(%s, %s) + sizeof(struct_data->%s)\n",
+            gen_struct->name, fields[last].name, fields[last].name);
+        fprintf(out, "                - offsetof(%s, %s) == %lu) {\n",
+            gen_struct->name, fields[first].name,
+            (unsigned long) section_size);
+        fprintf(out, "                if (op == HG_ENCODE)\n");
+        fprintf(out, "                    memcpy(buf_ptr, &struct_data->%s, %lu);\n",
+            fields[first].name, (unsigned long) section_size);
+        fprintf(out, "                else\n");
+        fprintf(out, "                    memcpy(&struct_data->%s, buf_ptr, %lu);\n",
+            fields[first].name, (unsigned long) section_size);
+        fprintf(out, "            } else ");
+    } else
+        fprintf(out, "            ");
+
+    fprintf(out, "if (op == HG_ENCODE) {\n");
+    for (i = first, offset = 0; i <= last; i++) {
+        fprintf(out, "                memcpy(buf_ptr + %lu, &struct_data->%s, %lu);\n",
+            (unsigned long) offset, fields[i].name,
+            (unsigned long) hg_gen_field_size(&fields[i]));
+        offset += hg_gen_field_size(&fields[i]);
+    }
+    fprintf(out, "            } else {\n");
+    for (i = first, offset = 0; i <= last; i++) {
+        fprintf(out, "                memcpy(&struct_data->%s, buf_ptr + %lu, %lu);\n",
+            fields[i].name, (unsigned long) offset,
+            (unsigned long) hg_gen_field_size(&fields[i]));
+        offset += hg_gen_field_size(&fields[i]);
+    }
+    fprintf(out, "            }\n");
+    fprintf(out, "            ret = hg_proc_restore_ptr(proc, buf_ptr, %lu);\n",
+        (unsigned long) section_size);
+    fprintf(out, "            if (ret != HG_SUCCESS) {\n");
+    fprintf(out, "                HG_LOG_ERROR(\"Proc error\");\n");
+    fprintf(out, "                return ret;\n");
+    fprintf(out, "            }\n");
+    fprintf(out, "        }\n");
+    fprintf(out, "    } else\n");
+    fprintf(out, "#endif\n");
+
+    /* Per-field routines for compact and XDR encoding */
+    fprintf(out, "    {\n");
+    for (i = first; i <= last; i++)
+        hg_gen_write_field(out, &fields[i], "    ");
+    fprintf(out, "    }\n\n");
+}
+
+/*---------------------------------------------------------------------------*/
+static void
+hg_gen_write_field(FILE *out, const struct hg_gen_field *field,
+    const char *indent)
+{
+    if (field->count) {
+        fprintf(out, "%s    for (i = 0; i < %lu; i++) {\n", indent,
+            field->count);
+        fprintf(out, "%s        ret = hg_proc_%s(proc, &struct_data->%s[i]);\n",
+            indent, field->type, field->name);
+        fprintf(out, "%s        if (ret != HG_SUCCESS) {\n", indent);
+        fprintf(out, "%s            HG_LOG_ERROR(\"Proc error\");\n", indent);
+        fprintf(out, "%s            return ret;\n", indent);
+        fprintf(out, "%s        }\n", indent);
+        fprintf(out, "%s    }\n", indent);
+    } else {
+        fprintf(out, "%s    ret = hg_proc_%s(proc, &struct_data->%s);\n",
+            indent, field->type, field->name);
+        fprintf(out, "%s    if (ret != HG_SUCCESS) {\n", indent);
+        fprintf(out, "%s        HG_LOG_ERROR(\"Proc error\");\n", indent);
+        fprintf(out, "%s        return ret;\n", indent);
+        fprintf(out, "%s    }\n", indent);
+    }
+}
+
+/*---------------------------------------------------------------------------*/
+static void
+hg_gen_write_struct(FILE *out, const struct hg_gen_struct *gen_struct)
+{
+    const struct hg_gen_field *fields = gen_struct->fields;
+    int has_fixed = 0, has_array = 0;
+    unsigned int i;
+
+    for (i = 0; i < gen_struct->n_fields; i++) {
+        if (fields[i].type_size)
+            has_fixed = 1;
+        if (fields[i].count)
+            has_array = 1;
+    }
+
+    /* Struct definition */
+    fprintf(out, "/* Define %s */\n", gen_struct->name);
+    fprintf(out, "typedef struct {\n");
+    for (i = 0; i < gen_struct->n_fields; i++) {
+        if (fields[i].count)
+            fprintf(out, "    %s %s[%lu];\n", fields[i].type, fields[i].name,
+                fields[i].count);
+        else
+            fprintf(out, "    %s %s;\n", fields[i].type, fields[i].name);
+    }
+    fprintf(out, "} %s;\n\n", gen_struct->name);
+
+    /* Proc routine */
+    fprintf(out, "/* Define hg_proc_%s */\n", gen_struct->name);
+    fprintf(out, "static HG_INLINE hg_return_t\n");
+    fprintf(out, "hg_proc_%s(hg_proc_t proc, void *data)\n", gen_struct->name);
+    fprintf(out, "{\n");
+    fprintf(out, "    %s *struct_data = (%s *) data;\n", gen_struct->name,
+        gen_struct->name);
+    if (has_fixed) {
+        fprintf(out, "#ifndef HG_HAS_XDR\n");
+        fprintf(out, "    hg_proc_op_t op = hg_proc_get_op(proc);\n");
+        fprintf(out, "    hg_bool_t compact =\n");
+        fprintf(out, "        (hg_proc_get_flags(proc) & HG_PROC_COMPACT) ? HG_TRUE : HG_FALSE;\n");
+        fprintf(out, "    char *buf_ptr;\n");
+        fprintf(out, "#endif\n");
+    }
+    if (has_array)
+        fprintf(out, "    unsigned long i;\n");
+    fprintf(out, "    hg_return_t ret = HG_SUCCESS;\n\n");
+
+    for (i = 0; i < gen_struct->n_fields; ) {
+        if (fields[i].type_size) {
+            unsigned int last = i;
+
+            while (last + 1 < gen_struct->n_fields
+                && fields[last + 1].type_size)
+                last++;
+            hg_gen_write_section(out, gen_struct, i, last);
+            i = last + 1;
+        } else {
+            hg_gen_write_field(out, &fields[i], "");
+            fprintf(out, "\n");
+            i++;
+        }
+    }
+
+    fprintf(out, "    return ret;\n");
+    fprintf(out, "}\n\n");
+}
+
+/*---------------------------------------------------------------------------*/
+static void
+hg_gen_write(FILE *out, const char *guard, const struct hg_gen_struct *structs,
+    unsigned int n_structs)
+{
+    unsigned int i;
+
+    fprintf(out, "/* Generated file. Only edit the schema file. */\n\n");
+    fprintf(out, "#ifndef %s\n", guard);
+    fprintf(out, "#define %s\n\n", guard);
+    fprintf(out, "#include \"mercury_proc.h\"\n");
+    fprintf(out, "#include \"mercury_proc_string.h\"\n\n");
+    fprintf(out, "#include <stddef.h>\n");
+    fprintf(out, "#include <string.h>\n\n");
+
+    for (i = 0; i < n_structs; i++)
+        hg_gen_write_struct(out, &structs[i]);
+
+    fprintf(out, "#endif /* %s */\n", guard);
+}
+
+/*---------------------------------------------------------------------------*/
+static void
+hg_gen_usage(const char *exec_name)
+{
+    fprintf(stderr, "Usage: %s [-o <output header>] <schema>\n", exec_name);
+}
+
+/*---------------------------------------------------------------------------*/
+int
+main(int argc, char *argv[])
+{
+    static struct hg_gen_struct structs[HG_GEN_MAX_STRUCTS];
+    struct hg_gen_parser parser;
+    const char *output_name = NULL, *schema_name = NULL, *base_name;
+    char guard[256];
+    unsigned int n_structs, i;
+    size_t len;
+    FILE *out = stdout;
+    int arg;
+
+    for (arg = 1; arg < argc; arg++) {
+        if (!strcmp(argv[arg], "-o") && arg + 1 < argc)
+            output_name = argv[++arg];
+        else if (argv[arg][0] == '-' || schema_name) {
+            hg_gen_usage(argv[0]);
+            return EXIT_FAILURE;
+        } else
+            schema_name = argv[arg];
+    }
+    if (!schema_name) {
+        hg_gen_usage(argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    /* Parse schema */
+    parser.file = fopen(schema_name, "r");
+    if (!parser.file) {
+        fprintf(stderr, "Could not open %s\n", schema_name);
+        return EXIT_FAILURE;
+    }
+    parser.file_name = schema_name;
+    parser.line = 1;
+    n_structs = hg_gen_parse(&parser, structs, HG_GEN_MAX_STRUCTS);
+    fclose(parser.file);
+
+    /* Make include guard from output name */
+    base_name = output_name ? output_name : schema_name;
+    if (strrchr(base_name, '/'))
+        base_name = strrchr(base_name, '/') + 1;
+    len = strlen(base_name);
+    if (len > sizeof(guard) - 1)
+        len = sizeof(guard) - 1;
+    for (i = 0; i < len; i++)
+        guard[i] = isalnum((unsigned char) base_name[i])
+            ? (char) toupper((unsigned char) base_name[i]) : '_';
+    guard[len] = '\0';
+
+    if (output_name) {
+        out = fopen(output_name, "w");
+        if (!out) {
+            fprintf(stderr, "Could not open %s\n", output_name);
+            return EXIT_FAILURE;
+        }
+    }
+    hg_gen_write(out, guard, structs, n_structs);
+    if (output_name && fclose(out)) {
+        fprintf(stderr, "Could not write %s\n", output_name);
+        remove(output_name);
+        return EXIT_FAILURE;
+    }
+
+    return EXIT_SUCCESS;
+}
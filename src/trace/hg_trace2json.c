@@ -0,0 +1,270 @@
+/*
+ * Copyright (C) 2013-2017 Argonne National Laboratory, Department of Energy,
+ *                    UChicago Argonne, LLC and The HDF Group.
+ * All rights reserved.
+ *
+ * The full copyright notice, including terms governing use, modification,
+ * and redistribution, is contained in the COPYING file that can be
+ * found at the root of the source code distribution tree.
+ */
+
+/*
+ * hg_trace2json: convert trace dumps (see HG_Trace_dump()) to Chrome trace
+ * JSON format, which can be loaded into chrome://tracing or Perfetto.
+ *
+ * Several dumps (e.g., from origin and target processes running on the same
+ * node) can be merged into one output file, events of each process then
+ * appear under their own PID. RPC callbacks are shown as slices on the
+ * thread that executed them, forwards (from HG_Forward() to the forward
+ * callback) and bulk transfers as async slices, other events as instants.
+ */
+
+#include "mercury_trace.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/************************************/
+/* Local Type and Struct Definition */
+/************************************/
+
+struct hg_trace_thread {
+    hg_uint64_t pid;
+    hg_uint32_t tid;
+    hg_uint32_t event_count;
+    struct hg_trace_event *events;
+};
+
+/********************/
+/* Local Prototypes */
+/********************/
+
+static void
+hg_trace_usage(const char *name);
+
+static int
+hg_trace_read(const char *file_name, struct hg_trace_thread **threads,
+    unsigned int *thread_count);
+
+static void
+hg_trace_write_event(FILE *out, const struct hg_trace_thread *thread,
+    const struct hg_trace_event *event, hg_uint64_t time_origin, int first);
+
+/*******************/
+/* Local Variables */
+/*******************/
+
+static const char * const hg_trace_names[HG_TRACE_MAX] = {
+    "create",
+    "forward",
+    "send_post",
+    "send_complete",
+    "recv_unexpected",
+    "recv_expected",
+    "trigger",
+    "rpc",
+    "rpc",
+    "respond",
+    "forward",
+    "bulk",
+    "bulk"
+};
+
+/*---------------------------------------------------------------------------*/
+static void
+hg_trace_usage(const char *name)
+{
+    fprintf(stderr, "usage: %s [-o <output.json>] <trace> [<trace> ...]\n",
+        name);
+}
+
+/*---------------------------------------------------------------------------*/
+static int
+hg_trace_read(const char *file_name, struct hg_trace_thread **threads,
+    unsigned int *thread_count)
+{
+    struct hg_trace_dump_header header;
+    FILE *file;
+    unsigned int i;
+    int ret = -1;
+
+    file = fopen(file_name, "rb");
+    if (!file) {
+        fprintf(stderr, "Could not open %s\n", file_name);
+        return ret;
+    }
+
+    if (fread(&header, sizeof(header), 1, file) != 1
+        || memcmp(header.magic, HG_TRACE_DUMP_MAGIC, sizeof(header.magic))
+        || header.event_size != sizeof(struct hg_trace_event)) {
+        fprintf(stderr, "%s is not a trace dump\n", file_name);
+        goto done;
+    }
+
+    for (i = 0; i < header.thread_count; i++) {
+        struct hg_trace_dump_thread dump_thread;
+        struct hg_trace_thread *new_threads, *thread;
+
+        if (fread(&dump_thread, sizeof(dump_thread), 1, file) != 1) {
+            fprintf(stderr, "Truncated trace dump %s\n", file_name);
+            goto done;
+        }
+        new_threads = (struct hg_trace_thread *) realloc(*threads,
+            (*thread_count + 1) * sizeof(struct hg_trace_thread));
+        if (!new_threads) {
+            fprintf(stderr, "Could not allocate threads\n");
+            goto done;
+        }
+        *threads = new_threads;
+        thread = &new_threads[*thread_count];
+        thread->pid = header.pid;
+        thread->tid = dump_thread.tid;
+        thread->event_count = dump_thread.event_count;
+        thread->events = (struct hg_trace_event *) malloc(
+            dump_thread.event_count * sizeof(struct hg_trace_event) + 1);
+        if (!thread->events) {
+            fprintf(stderr, "Could not allocate events\n");
+            goto done;
+        }
+        (*thread_count)++;
+        if (fread(thread->events, sizeof(struct hg_trace_event),
+            dump_thread.event_count, file) != dump_thread.event_count) {
+            fprintf(stderr, "Truncated trace dump %s\n", file_name);
+            goto done;
+        }
+    }
+    ret = 0;
+
+done:
+    fclose(file);
+    return ret;
+}
+
+/*---------------------------------------------------------------------------*/
+static void
+hg_trace_write_event(FILE *out, const struct hg_trace_thread *thread,
+    const struct hg_trace_event *event, hg_uint64_t time_origin, int first)
+{
+    hg_uint64_t time = event->time - time_origin;
+    const char *name = hg_trace_names[event->type];
+    const char *cat = "hg";
+    const char *ph = "i";
+
+    switch (event->type) {
+        case HG_TRACE_RPC_BEGIN:
+            ph = "B";
+            break;
+        case HG_TRACE_RPC_END:
+            ph = "E";
+            break;
+        case HG_TRACE_FORWARD:
+            cat = "forward";
+            ph = "b";
+            break;
+        case HG_TRACE_FORWARD_COMPLETE:
+            cat = "forward";
+            ph = "e";
+            break;
+        case HG_TRACE_BULK_START:
+            cat = "bulk";
+            ph = "b";
+            break;
+        case HG_TRACE_BULK_COMPLETE:
+            cat = "bulk";
+            ph = "e";
+            break;
+        default:
+            break;
+    }
+
+    fprintf(out, "%s\n{\"name\":\"%s\",\"cat\":\"%s\",\"ph\":\"%s\","
+        "\"ts\":%llu.%03u,\"pid\":%llu,\"tid\":%u",
+        first ? "" : ",", name, cat, ph,
+        (unsigned long long) (time / 1000), (unsigned int) (time % 1000),
+        (unsigned long long) thread->pid, thread->tid);
+    if (ph[0] == 'b' || ph[0] == 'e')
+        fprintf(out, ",\"id\":\"0x%llx\"",
+            (unsigned long long) event->object);
+    else if (ph[0] == 'i')
+        fprintf(out, ",\"s\":\"t\"");
+    fprintf(out, ",\"args\":{\"rpc_id\":\"0x%08x\",\"object\":\"0x%llx\","
+        "\"arg\":%llu}}", event->id, (unsigned long long) event->object,
+        (unsigned long long) event->arg);
+}
+
+/*---------------------------------------------------------------------------*/
+int
+main(int argc, char *argv[])
+{
+    struct hg_trace_thread *threads = NULL;
+    unsigned int thread_count = 0, i, j;
+    const char *output_name = NULL;
+    hg_uint64_t time_origin = 0;
+    int arg, n_inputs = 0, first = 1, ret = EXIT_SUCCESS;
+    FILE *out = stdout;
+
+    for (arg = 1; arg < argc; arg++) {
+        if (!strcmp(argv[arg], "-o") && arg + 1 < argc)
+            output_name = argv[++arg];
+        else if (argv[arg][0] == '-') {
+            hg_trace_usage(argv[0]);
+            return EXIT_FAILURE;
+        } else {
+            if (hg_trace_read(argv[arg], &threads, &thread_count) != 0) {
+                ret = EXIT_FAILURE;
+                goto done;
+            }
+            n_inputs++;
+        }
+    }
+    if (!n_inputs) {
+        hg_trace_usage(argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    /* Make timestamps relative to first event */
+    for (i = 0; i < thread_count; i++)
+        for (j = 0; j < threads[i].event_count; j++)
+            if (!time_origin || threads[i].events[j].time < time_origin)
+                time_origin = threads[i].events[j].time;
+
+    if (output_name) {
+        out = fopen(output_name, "w");
+        if (!out) {
+            fprintf(stderr, "Could not open %s\n", output_name);
+            ret = EXIT_FAILURE;
+            goto done;
+        }
+    }
+
+    fprintf(out, "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[");
+    for (i = 0; i < thread_count; i++) {
+        fprintf(out, "%s\n{\"name\":\"thread_name\",\"ph\":\"M\","
+            "\"pid\":%llu,\"tid\":%u,\"args\":{\"name\":\"hg thread %u\"}}",
+            first ? "" : ",", (unsigned long long) threads[i].pid,
+            threads[i].tid, threads[i].tid);
+        first = 0;
+        for (j = 0; j < threads[i].event_count; j++) {
+            /* Skip events that were being written while dumping */
+            if (threads[i].events[j].type >= HG_TRACE_MAX
+                || threads[i].events[j].time < time_origin)
+                continue;
+            hg_trace_write_event(out, &threads[i], &threads[i].events[j],
+                time_origin, first);
+        }
+    }
+    fprintf(out, "\n]}\n");
+
+    if (output_name && fclose(out)) {
+        fprintf(stderr, "Could not write %s\n", output_name);
+        remove(output_name);
+        ret = EXIT_FAILURE;
+    }
+
+done:
+    for (i = 0; i < thread_count; i++)
+        free(threads[i].events);
+    free(threads);
+    return ret;
+}
@@ -94,6 +94,17 @@ hg_atomic_incr32(hg_atomic_int32_t *ptr);
 static HG_UTIL_INLINE hg_util_int32_t
 hg_atomic_decr32(hg_atomic_int32_t *ptr);
 
+/**
+ * Add to atomic value (32-bit integer).
+ *
+ * \param ptr [IN/OUT]          pointer to an atomic32 integer
+ * \param value [IN]            value to add
+ *
+ * \return Resulting value
+ */
+static HG_UTIL_INLINE hg_util_int32_t
+hg_atomic_add32(hg_atomic_int32_t *ptr, hg_util_int32_t value);
+
 #if !defined(HG_UTIL_HAS_OPA_PRIMITIVES_H)
 /**
  * OR atomic value (32-bit integer).
@@ -192,6 +203,17 @@ hg_atomic_incr64(hg_atomic_int64_t *ptr);
 static HG_UTIL_INLINE hg_util_int64_t
 hg_atomic_decr64(hg_atomic_int64_t *ptr);
 
+/**
+ * Add to atomic value (64-bit integer).
+ *
+ * \param ptr [IN/OUT]          pointer to an atomic64 integer
+ * \param value [IN]            value to add
+ *
+ * \return Resulting value
+ */
+static HG_UTIL_INLINE hg_util_int64_t
+hg_atomic_add64(hg_atomic_int64_t *ptr, hg_util_int64_t value);
+
 #if defined(_WIN32) || defined(HG_UTIL_HAS_STDATOMIC_H)
 /**
  * OR atomic value (64-bit integer).
@@ -341,6 +363,27 @@ hg_atomic_decr32(hg_atomic_int32_t *ptr)
     return ret;
 }
 
+/*---------------------------------------------------------------------------*/
+static HG_UTIL_INLINE hg_util_int32_t
+hg_atomic_add32(hg_atomic_int32_t *ptr, hg_util_int32_t value)
+{
+    hg_util_int32_t ret;
+
+#if defined(_WIN32)
+    ret = InterlockedExchangeAddNoFence(&ptr->value, value) + value;
+#elif defined(HG_UTIL_HAS_OPA_PRIMITIVES_H)
+    ret = OPA_fetch_and_add_int(ptr, value) + value;
+#elif defined(HG_UTIL_HAS_STDATOMIC_H)
+    ret = atomic_fetch_add_explicit(ptr, value, memory_order_acq_rel) + value;
+#elif defined(__APPLE__)
+    ret = OSAtomicAdd32(value, &ptr->value);
+#else
+    #error "Not supported on this platform."
+#endif
+
+    return ret;
+}
+
 #if !defined(HG_UTIL_HAS_OPA_PRIMITIVES_H)
 /*---------------------------------------------------------------------------*/
 static HG_UTIL_INLINE hg_util_int32_t
@@ -512,6 +555,25 @@ hg_atomic_decr64(hg_atomic_int64_t *ptr)
     return ret;
 }
 
+/*---------------------------------------------------------------------------*/
+static HG_UTIL_INLINE hg_util_int64_t
+hg_atomic_add64(hg_atomic_int64_t *ptr, hg_util_int64_t value)
+{
+    hg_util_int64_t ret;
+
+#if defined(_WIN32)
+    ret = InterlockedExchangeAddNoFence64(&ptr->value, value) + value;
+#elif defined(HG_UTIL_HAS_STDATOMIC_H)
+    ret = atomic_fetch_add_explicit(ptr, value, memory_order_acq_rel) + value;
+#elif defined(__APPLE__)
+    ret = OSAtomicAdd64(value, &ptr->value);
+#else
+    #error "Not supported on this platform."
+#endif
+
+    return ret;
+}
+
 #if defined(_WIN32) || defined(HG_UTIL_HAS_STDATOMIC_H)
 /*---------------------------------------------------------------------------*/
 static HG_UTIL_INLINE hg_util_int64_t
@@ -0,0 +1,452 @@
+/*
+ * Copyright (C) 2013-2017 Argonne National Laboratory, Department of Energy,
+ *                    UChicago Argonne, LLC and The HDF Group.
+ * All rights reserved.
+ *
+ * The full copyright notice, including terms governing use, modification,
+ * and redistribution, is contained in the COPYING file that can be
+ * found at the root of the source code distribution tree.
+ */
+
+#include "mercury_executor.h"
+#include "mercury_atomic.h"
+#include "mercury_thread_condition.h"
+#include "mercury_thread_spin.h"
+#include "mercury_util_error.h"
+
+#include <stdlib.h>
+
+/****************/
+/* Local Macros */
+/****************/
+
+/* Initial deque capacity (must be a power of 2) */
+#define HG_EXECUTOR_DEQUE_SIZE 64
+
+/************************************/
+/* Local Type and Struct Definition */
+/************************************/
+
+/* Growable ring of work pointers, owner pops from the head, thieves from
+ * the tail */
+struct hg_executor_deque {
+    struct hg_thread_work **ring;
+    unsigned int mask;
+    unsigned int head;
+    unsigned int count;
+    hg_thread_spin_t lock;
+};
+
+struct hg_executor_worker {
+    struct hg_executor_deque deques[HG_EXECUTOR_PRIORITIES];
+    struct hg_executor *executor;
+    unsigned int index;
+    hg_thread_t thread;
+    hg_util_bool_t started;
+};
+
+struct hg_executor {
+    struct hg_executor_worker *workers;
+    unsigned int thread_count;
+    hg_atomic_int32_t next;             /* Round-robin worker index */
+    hg_atomic_int32_t pending;          /* Queued work count */
+    hg_atomic_int32_t sleeping;         /* Sleeping worker count */
+    hg_atomic_int32_t shutdown;
+    hg_thread_mutex_t mutex;
+    hg_thread_cond_t cond;
+};
+
+/********************/
+/* Local Prototypes */
+/********************/
+
+/**
+ * Initialize deque.
+ */
+static int
+hg_executor_deque_init(struct hg_executor_deque *deque);
+
+/**
+ * Finalize deque.
+ */
+static void
+hg_executor_deque_finalize(struct hg_executor_deque *deque);
+
+/**
+ * Push work at the tail of deque.
+ */
+static int
+hg_executor_deque_push(struct hg_executor_deque *deque,
+    struct hg_thread_work *work);
+
+/**
+ * Pop work from the head (owner) or the tail (thief) of deque.
+ */
+static struct hg_thread_work *
+hg_executor_deque_pop(struct hg_executor_deque *deque, hg_util_bool_t steal);
+
+/**
+ * Get next work for worker, stealing from other workers if needed.
+ */
+static struct hg_thread_work *
+hg_executor_get_work(struct hg_executor_worker *worker);
+
+/**
+ * Worker thread.
+ */
+static HG_THREAD_RETURN_TYPE
+hg_executor_worker(void *args);
+
+/*---------------------------------------------------------------------------*/
+static int
+hg_executor_deque_init(struct hg_executor_deque *deque)
+{
+    int ret = HG_UTIL_SUCCESS;
+
+    deque->ring = (struct hg_thread_work **) malloc(
+        HG_EXECUTOR_DEQUE_SIZE * sizeof(struct hg_thread_work *));
+    if (!deque->ring) {
+        HG_UTIL_LOG_ERROR("Could not allocate deque");
+        ret = HG_UTIL_FAIL;
+        goto done;
+    }
+    deque->mask = HG_EXECUTOR_DEQUE_SIZE - 1;
+    deque->head = 0;
+    deque->count = 0;
+    hg_thread_spin_init(&deque->lock);
+
+done:
+    return ret;
+}
+
+/*---------------------------------------------------------------------------*/
+static void
+hg_executor_deque_finalize(struct hg_executor_deque *deque)
+{
+    if (!deque->ring)
+        return;
+    hg_thread_spin_destroy(&deque->lock);
+    free(deque->ring);
+    deque->ring = NULL;
+}
+
+/*---------------------------------------------------------------------------*/
+static int
+hg_executor_deque_push(struct hg_executor_deque *deque,
+    struct hg_thread_work *work)
+{
+    int ret = HG_UTIL_SUCCESS;
+
+    hg_thread_spin_lock(&deque->lock);
+
+    if (deque->count > deque->mask) {
+        unsigned int size = (deque->mask + 1) * 2, i;
+        struct hg_thread_work **ring = (struct hg_thread_work **) malloc(
+            size * sizeof(struct hg_thread_work *));
+
+        if (!ring) {
+            HG_UTIL_LOG_ERROR("Could not grow deque");
+            ret = HG_UTIL_FAIL;
+            goto unlock;
+        }
+        for (i = 0; i < deque->count; i++)
+            ring[i] = deque->ring[(deque->head + i) & deque->mask];
+        free(deque->ring);
+        deque->ring = ring;
+        deque->mask = size - 1;
+        deque->head = 0;
+    }
+    deque->ring[(deque->head + deque->count) & deque->mask] = work;
+    deque->count++;
+
+unlock:
+    hg_thread_spin_unlock(&deque->lock);
+    return ret;
+}
+
+/*---------------------------------------------------------------------------*/
+static struct hg_thread_work *
+hg_executor_deque_pop(struct hg_executor_deque *deque, hg_util_bool_t steal)
+{
+    struct hg_thread_work *work = NULL;
+
+    /* Unlocked check, avoids contending on empty deques while stealing */
+    if (!deque->count)
+        return NULL;
+
+    hg_thread_spin_lock(&deque->lock);
+    if (deque->count) {
+        if (steal)
+            work = deque->ring[(deque->head + deque->count - 1) & deque->mask];
+        else {
+            work = deque->ring[deque->head];
+            deque->head = (deque->head + 1) & deque->mask;
+        }
+        deque->count--;
+    }
+    hg_thread_spin_unlock(&deque->lock);
+
+    return work;
+}
+
+/*---------------------------------------------------------------------------*/
+static struct hg_thread_work *
+hg_executor_get_work(struct hg_executor_worker *worker)
+{
+    struct hg_executor *executor = worker->executor;
+    struct hg_thread_work *work = NULL;
+    int priority;
+
+    /* Own work first, then other workers' work, high priority first */
+    for (priority = HG_EXECUTOR_PRIORITIES - 1; priority >= 0; priority--) {
+        unsigned int i;
+
+        work = hg_executor_deque_pop(&worker->deques[priority], HG_UTIL_FALSE);
+        if (work)
+            break;
+
+        for (i = 1; i < executor->thread_count; i++) {
+            struct hg_executor_worker *victim = &executor->workers[
+                (worker->index + i) % executor->thread_count];
+
+            work = hg_executor_deque_pop(&victim->deques[priority],
+                HG_UTIL_TRUE);
+            if (work)
+                break;
+        }
+        if (work)
+            break;
+    }
+
+    if (work)
+        hg_atomic_decr32(&executor->pending);
+
+    return work;
+}
+
+/*---------------------------------------------------------------------------*/
+static HG_THREAD_RETURN_TYPE
+hg_executor_worker(void *args)
+{
+    hg_thread_ret_t ret = 0;
+    struct hg_executor_worker *worker = (struct hg_executor_worker *) args;
+    struct hg_executor *executor = worker->executor;
+    struct hg_thread_work *work;
+
+    while (1) {
+        if (hg_atomic_get32(&executor->pending) > 0) {
+            work = hg_executor_get_work(worker);
+            /* Work may have been taken by another worker in the meantime */
+            if (work)
+                (*work->func)(work->args);
+            continue;
+        }
+
+        hg_thread_mutex_lock(&executor->mutex);
+
+        /* Sleeping count is incremented before checking for work so that
+         * post either sees a sleeping worker or the worker sees the work */
+        hg_atomic_incr32(&executor->sleeping);
+        while (hg_atomic_get32(&executor->pending) == 0
+            && !hg_atomic_get32(&executor->shutdown)) {
+            if (hg_thread_cond_wait(&executor->cond, &executor->mutex)
+                != HG_UTIL_SUCCESS) {
+                HG_UTIL_LOG_ERROR("Thread cannot wait on condition variable");
+                hg_atomic_decr32(&executor->sleeping);
+                goto unlock;
+            }
+        }
+        hg_atomic_decr32(&executor->sleeping);
+
+        /* Only exit once all work has been executed */
+        if (hg_atomic_get32(&executor->shutdown)
+            && hg_atomic_get32(&executor->pending) == 0)
+            goto unlock;
+
+        hg_thread_mutex_unlock(&executor->mutex);
+    }
+
+unlock:
+    hg_thread_mutex_unlock(&executor->mutex);
+    hg_thread_exit(ret);
+    return ret;
+}
+
+/*---------------------------------------------------------------------------*/
+int
+hg_executor_create(unsigned int thread_count, hg_executor_t **executor)
+{
+    int ret = HG_UTIL_SUCCESS;
+    hg_executor_t *priv_executor = NULL;
+    unsigned int i, j;
+
+    if (!executor || !thread_count) {
+        HG_UTIL_LOG_ERROR("Invalid parameters");
+        ret = HG_UTIL_FAIL;
+        goto done;
+    }
+
+    priv_executor = (hg_executor_t *) malloc(sizeof(hg_executor_t));
+    if (!priv_executor) {
+        HG_UTIL_LOG_ERROR("Could not allocate executor");
+        ret = HG_UTIL_FAIL;
+        goto done;
+    }
+    priv_executor->thread_count = thread_count;
+    hg_atomic_init32(&priv_executor->next, 0);
+    hg_atomic_init32(&priv_executor->pending, 0);
+    hg_atomic_init32(&priv_executor->sleeping, 0);
+    hg_atomic_init32(&priv_executor->shutdown, 0);
+    hg_thread_mutex_init(&priv_executor->mutex);
+    hg_thread_cond_init(&priv_executor->cond);
+
+    priv_executor->workers = (struct hg_executor_worker *) calloc(thread_count,
+        sizeof(struct hg_executor_worker));
+    if (!priv_executor->workers) {
+        HG_UTIL_LOG_ERROR("Could not allocate executor workers");
+        ret = HG_UTIL_FAIL;
+        goto done;
+    }
+
+    /* Create all deques before starting workers as they steal from each
+     * other */
+    for (i = 0; i < thread_count; i++) {
+        struct hg_executor_worker *worker = &priv_executor->workers[i];
+
+        worker->executor = priv_executor;
+        worker->index = i;
+        for (j = 0; j < HG_EXECUTOR_PRIORITIES; j++) {
+            ret = hg_executor_deque_init(&worker->deques[j]);
+            if (ret != HG_UTIL_SUCCESS)
+                goto done;
+        }
+    }
+
+    for (i = 0; i < thread_count; i++) {
+        struct hg_executor_worker *worker = &priv_executor->workers[i];
+
+        if (hg_thread_create(&worker->thread, hg_executor_worker,
+            (void *) worker) != HG_UTIL_SUCCESS) {
+            HG_UTIL_LOG_ERROR("Could not create thread");
+            ret = HG_UTIL_FAIL;
+            goto done;
+        }
+        worker->started = HG_UTIL_TRUE;
+    }
+
+    *executor = priv_executor;
+
+done:
+    if (ret != HG_UTIL_SUCCESS && priv_executor)
+        hg_executor_destroy(priv_executor);
+    return ret;
+}
+
+/*---------------------------------------------------------------------------*/
+int
+hg_executor_destroy(hg_executor_t *executor)
+{
+    int ret = HG_UTIL_SUCCESS;
+    unsigned int i, j;
+
+    if (!executor)
+        goto done;
+
+    if (executor->workers) {
+        hg_thread_mutex_lock(&executor->mutex);
+        hg_atomic_set32(&executor->shutdown, 1);
+        if (hg_thread_cond_broadcast(&executor->cond) != HG_UTIL_SUCCESS) {
+            HG_UTIL_LOG_ERROR("Could not broadcast condition signal");
+            ret = HG_UTIL_FAIL;
+        }
+        hg_thread_mutex_unlock(&executor->mutex);
+
+        if (ret != HG_UTIL_SUCCESS)
+            goto done;
+
+        for (i = 0; i < executor->thread_count; i++) {
+            struct hg_executor_worker *worker = &executor->workers[i];
+
+            if (worker->started
+                && hg_thread_join(worker->thread) != HG_UTIL_SUCCESS) {
+                HG_UTIL_LOG_ERROR("Could not join thread");
+                ret = HG_UTIL_FAIL;
+                goto done;
+            }
+        }
+
+        for (i = 0; i < executor->thread_count; i++)
+            for (j = 0; j < HG_EXECUTOR_PRIORITIES; j++)
+                hg_executor_deque_finalize(&executor->workers[i].deques[j]);
+        free(executor->workers);
+    }
+
+    hg_thread_mutex_destroy(&executor->mutex);
+    hg_thread_cond_destroy(&executor->cond);
+    free(executor);
+
+done:
+    return ret;
+}
+
+/*---------------------------------------------------------------------------*/
+unsigned int
+hg_executor_get_thread_count(hg_executor_t *executor)
+{
+    return executor ? executor->thread_count : 0;
+}
+
+/*---------------------------------------------------------------------------*/
+int
+hg_executor_post(hg_executor_t *executor, struct hg_thread_work *work,
+    unsigned int affinity, unsigned int priority)
+{
+    int ret = HG_UTIL_SUCCESS;
+    struct hg_executor_worker *worker;
+
+    if (!executor) {
+        HG_UTIL_LOG_ERROR("Executor not initialized");
+        ret = HG_UTIL_FAIL;
+        goto done;
+    }
+
+    if (!work || !work->func) {
+        HG_UTIL_LOG_ERROR("Thread work and function pointer cannot be NULL");
+        ret = HG_UTIL_FAIL;
+        goto done;
+    }
+
+    if (priority >= HG_EXECUTOR_PRIORITIES) {
+        HG_UTIL_LOG_ERROR("Invalid priority");
+        ret = HG_UTIL_FAIL;
+        goto done;
+    }
+
+    if (hg_atomic_get32(&executor->shutdown)) {
+        HG_UTIL_LOG_ERROR("Executor is shutting down");
+        ret = HG_UTIL_FAIL;
+        goto done;
+    }
+
+    if (affinity == HG_EXECUTOR_ANY)
+        affinity = (unsigned int) hg_atomic_incr32(&executor->next);
+    worker = &executor->workers[affinity % executor->thread_count];
+
+    ret = hg_executor_deque_push(&worker->deques[priority], work);
+    if (ret != HG_UTIL_SUCCESS)
+        goto done;
+
+    /* Wake up a sleeping worker */
+    hg_atomic_incr32(&executor->pending);
+    if (hg_atomic_get32(&executor->sleeping) > 0) {
+        hg_thread_mutex_lock(&executor->mutex);
+        if (hg_thread_cond_signal(&executor->cond) != HG_UTIL_SUCCESS) {
+            HG_UTIL_LOG_ERROR("Cannot signal executor condition");
+            ret = HG_UTIL_FAIL;
+        }
+        hg_thread_mutex_unlock(&executor->mutex);
+    }
+
+done:
+    return ret;
+}
@@ -0,0 +1,93 @@
+/*
+ * Copyright (C) 2013-2017 Argonne National Laboratory, Department of Energy,
+ *                    UChicago Argonne, LLC and The HDF Group.
+ * All rights reserved.
+ *
+ * The full copyright notice, including terms governing use, modification,
+ * and redistribution, is contained in the COPYING file that can be
+ * found at the root of the source code distribution tree.
+ */
+
+#ifndef MERCURY_EXECUTOR_H
+#define MERCURY_EXECUTOR_H
+
+#include "mercury_thread_pool.h"
+
+/**
+ * Purpose: work-stealing executor. Each worker thread owns one deque per
+ * priority, work is posted to the deque of a given worker (affinity) or of
+ * the next worker in round-robin order. Workers run their own work in FIFO
+ * order and steal from the other end of other workers' deques when they run
+ * out of work, so that a worker busy with a slow task does not hold back the
+ * tasks queued behind it. High priority work is always run before normal
+ * priority work.
+ */
+
+typedef struct hg_executor hg_executor_t;
+
+/* Work priorities */
+#define HG_EXECUTOR_NORMAL      0
+#define HG_EXECUTOR_HIGH        1
+#define HG_EXECUTOR_PRIORITIES  2
+
+/* Post work to any worker */
+#define HG_EXECUTOR_ANY         ((unsigned int) -1)
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * Create an executor and start its worker threads.
+ *
+ * \param thread_count [IN]     number of worker threads
+ * \param executor [OUT]        pointer to executor object
+ *
+ * \return Non-negative on success or negative on failure
+ */
+HG_UTIL_EXPORT int
+hg_executor_create(unsigned int thread_count, hg_executor_t **executor);
+
+/**
+ * Destroy the executor. Work that was already posted is run before worker
+ * threads exit.
+ *
+ * \param executor [IN/OUT]     pointer to executor object
+ *
+ * \return Non-negative on success or negative on failure
+ */
+HG_UTIL_EXPORT int
+hg_executor_destroy(hg_executor_t *executor);
+
+/**
+ * Get number of worker threads.
+ *
+ * \param executor [IN]         pointer to executor object
+ *
+ * \return Number of worker threads
+ */
+HG_UTIL_EXPORT unsigned int
+hg_executor_get_thread_count(hg_executor_t *executor);
+
+/**
+ * Post work to the executor. Work is queued on worker affinity modulo the
+ * number of workers, or on the next worker if affinity is HG_EXECUTOR_ANY.
+ * Affinity is only a hint as other workers may steal that work when idle.
+ * The work struct must remain valid until its function starts executing.
+ *
+ * \param executor [IN/OUT]     pointer to executor object
+ * \param work [IN]             pointer to work struct
+ * \param affinity [IN]         worker index or HG_EXECUTOR_ANY
+ * \param priority [IN]         HG_EXECUTOR_NORMAL or HG_EXECUTOR_HIGH
+ *
+ * \return Non-negative on success or negative on failure
+ */
+HG_UTIL_EXPORT int
+hg_executor_post(hg_executor_t *executor, struct hg_thread_work *work,
+    unsigned int affinity, unsigned int priority);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* MERCURY_EXECUTOR_H */
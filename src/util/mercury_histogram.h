@@ -0,0 +1,154 @@
+/*
+ * Copyright (C) 2013-2017 Argonne National Laboratory, Department of Energy,
+ *                    UChicago Argonne, LLC and The HDF Group.
+ * All rights reserved.
+ *
+ * The full copyright notice, including terms governing use, modification,
+ * and redistribution, is contained in the COPYING file that can be
+ * found at the root of the source code distribution tree.
+ */
+
+/* Log-linear histogram: values below 2^sub_bits get their own bucket, each
+ * following power of two up to 2^max_bits is split into 2^sub_bits linear
+ * buckets, so that the relative error of a bucket is below 2^-sub_bits.
+ * Callers own the bucket array (HG_HISTOGRAM_BUCKETS(sub_bits, max_bits)
+ * counters) and pick the precision that suits them. */
+
+#ifndef MERCURY_HISTOGRAM_H
+#define MERCURY_HISTOGRAM_H
+
+#include "mercury_util_config.h"
+
+/*****************/
+/* Public Macros */
+/*****************/
+
+#define HG_HISTOGRAM_BUCKETS(sub_bits, max_bits) \
+    (((max_bits) - (sub_bits) + 1) << (sub_bits))
+
+/*********************/
+/* Public Prototypes */
+/*********************/
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * Get histogram bucket index of value. Values of 2^max_bits and above fall
+ * into the last bucket.
+ *
+ * \param value [IN]            value
+ * \param sub_bits [IN]         log2 of linear buckets per power of two
+ * \param max_bits [IN]         log2 of largest tracked value
+ *
+ * \return Bucket index
+ */
+static HG_UTIL_INLINE unsigned int
+hg_histogram_index(hg_util_uint64_t value, unsigned int sub_bits,
+    unsigned int max_bits);
+
+/**
+ * Get largest value stored in histogram bucket.
+ *
+ * \param index [IN]            bucket index
+ * \param sub_bits [IN]         log2 of linear buckets per power of two
+ * \param max_bits [IN]         log2 of largest tracked value
+ *
+ * \return Largest value of bucket
+ */
+static HG_UTIL_INLINE hg_util_uint64_t
+hg_histogram_bucket_max(unsigned int index, unsigned int sub_bits,
+    unsigned int max_bits);
+
+/**
+ * Get an upper bound of the value below which a given percentage of the
+ * histogram samples fall.
+ *
+ * \param buckets [IN]          array of bucket counters
+ * \param sub_bits [IN]         log2 of linear buckets per power of two
+ * \param max_bits [IN]         log2 of largest tracked value
+ * \param count [IN]            number of samples
+ * \param max [IN]              largest sample
+ * \param percentile [IN]       percentile (between 0 and 100)
+ *
+ * \return Value (clamped to max)
+ */
+static HG_UTIL_INLINE hg_util_uint64_t
+hg_histogram_percentile(const hg_util_uint64_t *buckets, unsigned int sub_bits,
+    unsigned int max_bits, hg_util_uint64_t count, hg_util_uint64_t max,
+    double percentile);
+
+/*---------------------------------------------------------------------------*/
+static HG_UTIL_INLINE unsigned int
+hg_histogram_index(hg_util_uint64_t value, unsigned int sub_bits,
+    unsigned int max_bits)
+{
+    hg_util_uint64_t tmp = value;
+    unsigned int msb = 0;
+
+    if (value < ((hg_util_uint64_t) 1 << sub_bits))
+        return (unsigned int) value;
+
+    while (tmp >>= 1)
+        msb++;
+    if (msb >= max_bits)
+        return HG_HISTOGRAM_BUCKETS(sub_bits, max_bits) - 1;
+
+    /* Power of two selects the group, next bits select the linear bucket */
+    return ((msb - sub_bits + 1) << sub_bits)
+        + (unsigned int) (value >> (msb - sub_bits)) - (1U << sub_bits);
+}
+
+/*---------------------------------------------------------------------------*/
+static HG_UTIL_INLINE hg_util_uint64_t
+hg_histogram_bucket_max(unsigned int index, unsigned int sub_bits,
+    unsigned int max_bits)
+{
+    unsigned int next = index + 1, group;
+
+    if (next < (1U << sub_bits))
+        return index;
+    if (next >= HG_HISTOGRAM_BUCKETS(sub_bits, max_bits))
+        return ~((hg_util_uint64_t) 0);
+
+    /* Lowest value of next bucket minus one */
+    group = next >> sub_bits;
+    return ((((hg_util_uint64_t) 1 << sub_bits)
+        + (next & ((1U << sub_bits) - 1))) << (group - 1)) - 1;
+}
+
+/*---------------------------------------------------------------------------*/
+static HG_UTIL_INLINE hg_util_uint64_t
+hg_histogram_percentile(const hg_util_uint64_t *buckets, unsigned int sub_bits,
+    unsigned int max_bits, hg_util_uint64_t count, hg_util_uint64_t max,
+    double percentile)
+{
+    hg_util_uint64_t target, total = 0;
+    unsigned int i;
+
+    if (!count)
+        return 0;
+
+    target = (hg_util_uint64_t) ((double) count * percentile / 100.0 + 0.5);
+    if (target < 1)
+        target = 1;
+
+    for (i = 0; i < HG_HISTOGRAM_BUCKETS(sub_bits, max_bits); i++) {
+        total += buckets[i];
+        if (total >= target) {
+            hg_util_uint64_t value = hg_histogram_bucket_max(i, sub_bits,
+                max_bits);
+
+            return (value < max) ? value : max;
+        }
+    }
+
+    return max;
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* MERCURY_HISTOGRAM_H */
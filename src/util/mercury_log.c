@@ -9,8 +9,16 @@
  */
 
 #include "mercury_log.h"
+#include "mercury_time.h"
+#ifdef HG_UTIL_HAS_ASYNC_LOG
+# include "mercury_atomic_queue.h"
+# include "mercury_thread.h"
+# include "mercury_thread_condition.h"
+# include "mercury_thread_mutex.h"
+#endif
 
 #include <stdarg.h>
+#include <stdlib.h>
 
 /****************/
 /* Local Macros */
@@ -18,6 +26,84 @@
 
 #define HG_UTIL_LOG_MAX_BUF 256
 
+#ifdef HG_UTIL_HAS_ASYNC_LOG
+/* Number of records that can be queued (power of two) */
+# define HG_UTIL_LOG_QUEUE_SIZE 1024
+
+/* Max time the writer sleeps before checking the queue (ms) */
+# define HG_UTIL_LOG_WRITER_TIMEOUT 100
+
+/* Writer states */
+# define HG_UTIL_LOG_WRITER_UNINIT      0
+# define HG_UTIL_LOG_WRITER_STARTING    1
+# define HG_UTIL_LOG_WRITER_RUNNING     2
+# define HG_UTIL_LOG_WRITER_STOPPED     3
+#endif
+
+/************************************/
+/* Local Type and Struct Definition */
+/************************************/
+
+#ifdef HG_UTIL_HAS_ASYNC_LOG
+/* Queued log record, strings other than buf point to literals */
+struct hg_log_record {
+    hg_log_type_t log_type;
+    const char *module;
+    const char *file;
+    const char *func;
+    unsigned int line;
+    int suppressed;
+    char buf[HG_UTIL_LOG_MAX_BUF];
+};
+#endif
+
+/********************/
+/* Local Prototypes */
+/********************/
+
+/**
+ * Check rate limit of call site. Return number of messages suppressed since
+ * the last message from that site, or -1 if this message must be dropped.
+ */
+static int
+hg_log_rate_check(struct hg_log_site *site);
+
+/**
+ * Write message to log stream.
+ */
+static void
+hg_log_output(hg_log_type_t log_type, const char *module, const char *file,
+    unsigned int line, const char *func, const char *buf, int suppressed);
+
+/**
+ * Format message and write or queue it.
+ */
+static void
+hg_log_vwrite(struct hg_log_site *site, hg_log_type_t log_type,
+    const char *module, const char *file, unsigned int line, const char *func,
+    const char *format, va_list ap);
+
+#ifdef HG_UTIL_HAS_ASYNC_LOG
+/**
+ * Start writer thread, return HG_UTIL_FALSE if messages must be written
+ * synchronously.
+ */
+static hg_util_bool_t
+hg_log_writer_start(void);
+
+/**
+ * Writer thread.
+ */
+static HG_THREAD_RETURN_TYPE
+hg_log_writer(void *arg);
+
+/**
+ * Stop writer thread at exit after remaining messages are written.
+ */
+static void
+hg_log_writer_stop(void);
+#endif
+
 /*******************/
 /* Local Variables */
 /*******************/
@@ -27,44 +113,70 @@ static FILE *hg_log_stream_debug_g = NULL;
 static FILE *hg_log_stream_warning_g = NULL;
 static FILE *hg_log_stream_error_g = NULL;
 
-/*---------------------------------------------------------------------------*/
-void
-hg_log_set_func(int (*log_func)(FILE *stream, const char *format, ...))
-{
-    hg_log_func_g = log_func;
-}
+/* Rate limiting */
+static hg_atomic_int32_t hg_log_rate_limit_g =
+    HG_ATOMIC_VAR_INIT(HG_UTIL_LOG_RATE_LIMIT);
+static hg_atomic_int32_t hg_log_rate_limited_g = HG_ATOMIC_VAR_INIT(0);
+static hg_atomic_int32_t hg_log_queue_full_g = HG_ATOMIC_VAR_INIT(0);
 
-/*---------------------------------------------------------------------------*/
-void
-hg_log_set_stream_debug(FILE *stream)
-{
-    hg_log_stream_debug_g = stream;
-}
+#ifdef HG_UTIL_HAS_ASYNC_LOG
+/* Records are taken from the free queue and pushed to the pending queue */
+static struct hg_log_record *hg_log_records_g = NULL;
+static struct hg_atomic_queue *hg_log_free_queue_g = NULL;
+static struct hg_atomic_queue *hg_log_pending_queue_g = NULL;
+static hg_atomic_int32_t hg_log_queued_g = HG_ATOMIC_VAR_INIT(0);
+static hg_atomic_int32_t hg_log_written_g = HG_ATOMIC_VAR_INIT(0);
 
-/*---------------------------------------------------------------------------*/
-void
-hg_log_set_stream_warning(FILE *stream)
-{
-    hg_log_stream_warning_g = stream;
-}
+/* Writer thread */
+static hg_atomic_int32_t hg_log_writer_state_g =
+    HG_ATOMIC_VAR_INIT(HG_UTIL_LOG_WRITER_UNINIT);
+static hg_atomic_int32_t hg_log_writer_sleeping_g = HG_ATOMIC_VAR_INIT(0);
+static hg_atomic_int32_t hg_log_writer_stop_g = HG_ATOMIC_VAR_INIT(0);
+static hg_thread_t hg_log_writer_thread_g;
+static hg_thread_mutex_t hg_log_writer_mutex_g;
+static hg_thread_cond_t hg_log_writer_cond_g;
+#endif
 
 /*---------------------------------------------------------------------------*/
-void
-hg_log_set_stream_error(FILE *stream)
+static int
+hg_log_rate_check(struct hg_log_site *site)
 {
-    hg_log_stream_error_g = stream;
+    hg_util_int32_t limit = hg_atomic_get32(&hg_log_rate_limit_g);
+    hg_util_int32_t window, site_window, suppressed;
+    hg_time_t now;
+
+    if (!site || !limit)
+        return 0;
+
+    hg_time_get_current(&now);
+    window = (hg_util_int32_t) now.tv_sec;
+    site_window = hg_atomic_get32(&site->window);
+    if (site_window != window
+        && hg_atomic_cas32(&site->window, site_window, window))
+        hg_atomic_set32(&site->count, 0);
+
+    if (hg_atomic_incr32(&site->count) > limit) {
+        hg_atomic_incr32(&site->suppressed);
+        hg_atomic_incr32(&hg_log_rate_limited_g);
+        return -1;
+    }
+
+    /* Report messages suppressed since last message */
+    do {
+        suppressed = hg_atomic_get32(&site->suppressed);
+    } while (suppressed
+        && !hg_atomic_cas32(&site->suppressed, suppressed, 0));
+
+    return (int) suppressed;
 }
 
 /*---------------------------------------------------------------------------*/
-void
-hg_log_write(hg_log_type_t log_type, const char *module, const char *file,
-    unsigned int line, const char *func, const char *format, ...)
+static void
+hg_log_output(hg_log_type_t log_type, const char *module, const char *file,
+    unsigned int line, const char *func, const char *buf, int suppressed)
 {
-    char buf[HG_UTIL_LOG_MAX_BUF];
-    int desc_len;
     FILE *stream = NULL;
     const char *msg_type = NULL;
-    va_list ap;
 
     switch (log_type) {
         case HG_LOG_TYPE_DEBUG:
@@ -83,7 +195,48 @@ hg_log_write(hg_log_type_t log_type, const char *module, const char *file,
             return;
     };
 
-    va_start(ap, format);
+    if (suppressed > 0)
+        hg_log_func_g(stream, "# %s -- %s -- %s:%d\n"
+            " # %s(): %d similar message(s) suppressed\n", module, msg_type,
+            file, line, func, suppressed);
+
+    /* Print using logging function */
+    hg_log_func_g(stream, "# %s -- %s -- %s:%d\n"
+        " # %s(): %s\n", module, msg_type, file, line, func, buf);
+}
+
+/*---------------------------------------------------------------------------*/
+static void
+hg_log_vwrite(struct hg_log_site *site, hg_log_type_t log_type,
+    const char *module, const char *file, unsigned int line, const char *func,
+    const char *format, va_list ap)
+{
+    char local_buf[HG_UTIL_LOG_MAX_BUF];
+    char *buf = local_buf;
+    int desc_len, suppressed;
+#ifdef HG_UTIL_HAS_ASYNC_LOG
+    struct hg_log_record *record = NULL;
+#endif
+
+    /* Drop before formatting so that error storms remain cheap */
+    suppressed = hg_log_rate_check(site);
+    if (suppressed < 0)
+        return;
+
+#ifdef HG_UTIL_HAS_ASYNC_LOG
+    if (hg_log_writer_start()) {
+        record = (struct hg_log_record *) hg_atomic_queue_pop_mc(
+            hg_log_free_queue_g);
+        if (!record) {
+            hg_atomic_incr32(&hg_log_queue_full_g);
+            if (site)
+                hg_atomic_incr32(&site->suppressed);
+            return;
+        }
+        buf = record->buf;
+    }
+#endif
+
     desc_len = vsnprintf(buf, HG_UTIL_LOG_MAX_BUF, format, ap);
 #ifdef HG_UTIL_HAS_VERBOSE_ERROR
     if (desc_len > HG_UTIL_LOG_MAX_BUF)
@@ -92,9 +245,231 @@ hg_log_write(hg_log_type_t log_type, const char *module, const char *file,
 #else
     (void) desc_len;
 #endif
+
+#ifdef HG_UTIL_HAS_ASYNC_LOG
+    if (record) {
+        record->log_type = log_type;
+        record->module = module;
+        record->file = file;
+        record->func = func;
+        record->line = line;
+        record->suppressed = suppressed;
+
+        /* Cannot fail, queue can hold all records */
+        hg_atomic_incr32(&hg_log_queued_g);
+        hg_atomic_queue_push(hg_log_pending_queue_g, record);
+        if (hg_atomic_get32(&hg_log_writer_sleeping_g)) {
+            hg_thread_mutex_lock(&hg_log_writer_mutex_g);
+            hg_thread_cond_signal(&hg_log_writer_cond_g);
+            hg_thread_mutex_unlock(&hg_log_writer_mutex_g);
+        }
+        return;
+    }
+#endif
+
+    hg_log_output(log_type, module, file, line, func, buf, suppressed);
+}
+
+#ifdef HG_UTIL_HAS_ASYNC_LOG
+/*---------------------------------------------------------------------------*/
+static hg_util_bool_t
+hg_log_writer_start(void)
+{
+    unsigned int i;
+
+    switch (hg_atomic_get32(&hg_log_writer_state_g)) {
+        case HG_UTIL_LOG_WRITER_RUNNING:
+            return HG_UTIL_TRUE;
+        case HG_UTIL_LOG_WRITER_UNINIT:
+            break;
+        default:
+            /* Starting (by another thread) or stopped */
+            return HG_UTIL_FALSE;
+    }
+    if (!hg_atomic_cas32(&hg_log_writer_state_g, HG_UTIL_LOG_WRITER_UNINIT,
+        HG_UTIL_LOG_WRITER_STARTING))
+        return HG_UTIL_FALSE;
+
+    /* Queues hold one less entry than their size */
+    hg_log_records_g = (struct hg_log_record *) malloc(
+        HG_UTIL_LOG_QUEUE_SIZE * sizeof(struct hg_log_record));
+    hg_log_free_queue_g = hg_atomic_queue_alloc(HG_UTIL_LOG_QUEUE_SIZE * 2);
+    hg_log_pending_queue_g = hg_atomic_queue_alloc(HG_UTIL_LOG_QUEUE_SIZE * 2);
+    if (!hg_log_records_g || !hg_log_free_queue_g || !hg_log_pending_queue_g)
+        goto error;
+    for (i = 0; i < HG_UTIL_LOG_QUEUE_SIZE; i++)
+        hg_atomic_queue_push(hg_log_free_queue_g, &hg_log_records_g[i]);
+
+    hg_thread_mutex_init(&hg_log_writer_mutex_g);
+    hg_thread_cond_init(&hg_log_writer_cond_g);
+    if (hg_thread_create(&hg_log_writer_thread_g, hg_log_writer, NULL)
+        != HG_UTIL_SUCCESS) {
+        hg_thread_cond_destroy(&hg_log_writer_cond_g);
+        hg_thread_mutex_destroy(&hg_log_writer_mutex_g);
+        goto error;
+    }
+    if (atexit(hg_log_writer_stop) != 0) {
+        /* Messages could be lost at exit, stop now */
+        hg_atomic_set32(&hg_log_writer_state_g, HG_UTIL_LOG_WRITER_RUNNING);
+        hg_log_writer_stop();
+        return HG_UTIL_FALSE;
+    }
+
+    hg_atomic_set32(&hg_log_writer_state_g, HG_UTIL_LOG_WRITER_RUNNING);
+    return HG_UTIL_TRUE;
+
+error:
+    /* Fall back to synchronous writes */
+    free(hg_log_records_g);
+    hg_log_records_g = NULL;
+    hg_atomic_queue_free(hg_log_free_queue_g);
+    hg_atomic_queue_free(hg_log_pending_queue_g);
+    hg_atomic_set32(&hg_log_writer_state_g, HG_UTIL_LOG_WRITER_STOPPED);
+    return HG_UTIL_FALSE;
+}
+
+/*---------------------------------------------------------------------------*/
+static HG_THREAD_RETURN_TYPE
+hg_log_writer(void *arg)
+{
+    hg_thread_ret_t tret = (hg_thread_ret_t) 0;
+    struct hg_log_record *record;
+
+    (void) arg;
+
+    for (;;) {
+        while ((record = (struct hg_log_record *) hg_atomic_queue_pop_sc(
+            hg_log_pending_queue_g)) != NULL) {
+            hg_log_output(record->log_type, record->module, record->file,
+                record->line, record->func, record->buf, record->suppressed);
+            hg_atomic_queue_push(hg_log_free_queue_g, record);
+            hg_atomic_incr32(&hg_log_written_g);
+        }
+        if (hg_atomic_get32(&hg_log_writer_stop_g))
+            break;
+
+        /* Producers signal when they see the writer sleeping, the timeout
+         * only guards against wake-ups racing with the empty check */
+        hg_thread_mutex_lock(&hg_log_writer_mutex_g);
+        hg_atomic_set32(&hg_log_writer_sleeping_g, 1);
+        if (hg_atomic_queue_is_empty(hg_log_pending_queue_g)
+            && !hg_atomic_get32(&hg_log_writer_stop_g))
+            hg_thread_cond_timedwait(&hg_log_writer_cond_g,
+                &hg_log_writer_mutex_g, HG_UTIL_LOG_WRITER_TIMEOUT);
+        hg_atomic_set32(&hg_log_writer_sleeping_g, 0);
+        hg_thread_mutex_unlock(&hg_log_writer_mutex_g);
+    }
+
+    hg_thread_exit(tret);
+    return tret;
+}
+
+/*---------------------------------------------------------------------------*/
+static void
+hg_log_writer_stop(void)
+{
+    if (!hg_atomic_cas32(&hg_log_writer_state_g, HG_UTIL_LOG_WRITER_RUNNING,
+        HG_UTIL_LOG_WRITER_STOPPED))
+        return;
+
+    /* Writer drains the queue before exiting, records still being filled
+     * by other threads are dropped */
+    hg_thread_mutex_lock(&hg_log_writer_mutex_g);
+    hg_atomic_set32(&hg_log_writer_stop_g, 1);
+    hg_thread_cond_signal(&hg_log_writer_cond_g);
+    hg_thread_mutex_unlock(&hg_log_writer_mutex_g);
+    hg_thread_join(hg_log_writer_thread_g);
+}
+#endif
+
+/*---------------------------------------------------------------------------*/
+void
+hg_log_set_func(int (*log_func)(FILE *stream, const char *format, ...))
+{
+    hg_log_func_g = log_func;
+}
+
+/*---------------------------------------------------------------------------*/
+void
+hg_log_set_stream_debug(FILE *stream)
+{
+    hg_log_stream_debug_g = stream;
+}
+
+/*---------------------------------------------------------------------------*/
+void
+hg_log_set_stream_warning(FILE *stream)
+{
+    hg_log_stream_warning_g = stream;
+}
+
+/*---------------------------------------------------------------------------*/
+void
+hg_log_set_stream_error(FILE *stream)
+{
+    hg_log_stream_error_g = stream;
+}
+
+/*---------------------------------------------------------------------------*/
+void
+hg_log_set_rate_limit(unsigned int rate)
+{
+    hg_atomic_set32(&hg_log_rate_limit_g, (hg_util_int32_t) rate);
+}
+
+/*---------------------------------------------------------------------------*/
+void
+hg_log_get_dropped(unsigned long *rate_limited, unsigned long *queue_full)
+{
+    if (rate_limited)
+        *rate_limited =
+            (unsigned long) hg_atomic_get32(&hg_log_rate_limited_g);
+    if (queue_full)
+        *queue_full = (unsigned long) hg_atomic_get32(&hg_log_queue_full_g);
+}
+
+/*---------------------------------------------------------------------------*/
+void
+hg_log_flush(void)
+{
+#ifdef HG_UTIL_HAS_ASYNC_LOG
+    hg_util_int32_t queued = hg_atomic_get32(&hg_log_queued_g);
+
+    if (hg_atomic_get32(&hg_log_writer_state_g) != HG_UTIL_LOG_WRITER_RUNNING)
+        return;
+
+    hg_thread_mutex_lock(&hg_log_writer_mutex_g);
+    hg_thread_cond_signal(&hg_log_writer_cond_g);
+    hg_thread_mutex_unlock(&hg_log_writer_mutex_g);
+
+    while (hg_atomic_get32(&hg_log_written_g) - queued < 0
+        && hg_atomic_get32(&hg_log_writer_state_g)
+            == HG_UTIL_LOG_WRITER_RUNNING)
+        hg_thread_yield();
+#endif
+}
+
+/*---------------------------------------------------------------------------*/
+void
+hg_log_write(hg_log_type_t log_type, const char *module, const char *file,
+    unsigned int line, const char *func, const char *format, ...)
+{
+    va_list ap;
+
+    va_start(ap, format);
+    hg_log_vwrite(NULL, log_type, module, file, line, func, format, ap);
     va_end(ap);
+}
 
-    /* Print using logging function */
-    hg_log_func_g(stream, "# %s -- %s -- %s:%d\n"
-        " # %s(): %s\n", module, msg_type, file, line, func, buf);
+/*---------------------------------------------------------------------------*/
+void
+hg_log_write_site(struct hg_log_site *site, hg_log_type_t log_type,
+    const char *module, const char *file, unsigned int line, const char *func,
+    const char *format, ...)
+{
+    va_list ap;
+
+    va_start(ap, format);
+    hg_log_vwrite(site, log_type, module, file, line, func, format, ap);
+    va_end(ap);
 }
@@ -12,6 +12,7 @@
 #define MERCURY_LOG_H
 
 #include "mercury_util_config.h"
+#include "mercury_atomic.h"
 
 #include <stdio.h>
 
@@ -21,6 +22,13 @@ typedef enum {
     HG_LOG_TYPE_ERROR
 } hg_log_type_t;
 
+/* Per call site state used for rate limiting, zero initialized */
+struct hg_log_site {
+    hg_atomic_int32_t window;       /* Current one second window */
+    hg_atomic_int32_t count;        /* Messages logged in window */
+    hg_atomic_int32_t suppressed;   /* Messages dropped since last logged */
+};
+
 /* For compatibility */
 #if defined(__STDC_VERSION__) &&  (__STDC_VERSION__ < 199901L)
   #if defined(__GNUC__) && (__GNUC__ >= 2)
@@ -32,18 +40,17 @@ typedef enum {
   #define __func__ __FUNCTION__
 #endif
 
-#define HG_LOG_WRITE_ERROR(HG_LOG_MODULE_NAME, ...) do {                  \
-    hg_log_write(HG_LOG_TYPE_ERROR, HG_LOG_MODULE_NAME, __FILE__,         \
-        __LINE__, __func__, __VA_ARGS__);                                 \
-} while (0)
-#define HG_LOG_WRITE_DEBUG(HG_LOG_MODULE_NAME, ...) do {                  \
-    hg_log_write(HG_LOG_TYPE_DEBUG, HG_LOG_MODULE_NAME, __FILE__,         \
-        __LINE__, __func__, __VA_ARGS__);                                 \
-} while (0)
-#define HG_LOG_WRITE_WARNING(HG_LOG_MODULE_NAME, ...) do {                \
-    hg_log_write(HG_LOG_TYPE_WARNING, HG_LOG_MODULE_NAME, __FILE__,       \
-    __LINE__,  __func__, __VA_ARGS__);                                    \
+#define HG_LOG_WRITE(HG_LOG_TYPE, HG_LOG_MODULE_NAME, ...) do {           \
+    static struct hg_log_site hg_log_site_;                               \
+    hg_log_write_site(&hg_log_site_, HG_LOG_TYPE, HG_LOG_MODULE_NAME,     \
+        __FILE__, __LINE__, __func__, __VA_ARGS__);                       \
 } while (0)
+#define HG_LOG_WRITE_ERROR(HG_LOG_MODULE_NAME, ...)                       \
+    HG_LOG_WRITE(HG_LOG_TYPE_ERROR, HG_LOG_MODULE_NAME, __VA_ARGS__)
+#define HG_LOG_WRITE_DEBUG(HG_LOG_MODULE_NAME, ...)                       \
+    HG_LOG_WRITE(HG_LOG_TYPE_DEBUG, HG_LOG_MODULE_NAME, __VA_ARGS__)
+#define HG_LOG_WRITE_WARNING(HG_LOG_MODULE_NAME, ...)                     \
+    HG_LOG_WRITE(HG_LOG_TYPE_WARNING, HG_LOG_MODULE_NAME, __VA_ARGS__)
 
 #ifdef __cplusplus
 extern "C" {
@@ -81,6 +88,31 @@ hg_log_set_stream_warning(FILE *stream);
 HG_UTIL_EXPORT void
 hg_log_set_stream_error(FILE *stream);
 
+/**
+ * Set the maximum number of messages per second that can be logged from the
+ * same call site, messages in excess are dropped and counted.
+ *
+ * \param rate [IN]             messages per second (0 is unlimited)
+ */
+HG_UTIL_EXPORT void
+hg_log_set_rate_limit(unsigned int rate);
+
+/**
+ * Get the number of messages dropped so far.
+ *
+ * \param rate_limited [OUT]    messages dropped by rate limiting
+ * \param queue_full [OUT]      messages dropped because the log queue was full
+ */
+HG_UTIL_EXPORT void
+hg_log_get_dropped(unsigned long *rate_limited, unsigned long *queue_full);
+
+/**
+ * Wait until all messages queued so far have been written. Messages are
+ * written synchronously unless HG_UTIL_HAS_ASYNC_LOG is defined.
+ */
+HG_UTIL_EXPORT void
+hg_log_flush(void);
+
 /**
  * Write log.
  *
@@ -95,6 +127,24 @@ HG_UTIL_EXPORT void
 hg_log_write(hg_log_type_t log_type, const char *module, const char *file,
     unsigned int line, const char *func, const char *format, ...);
 
+/**
+ * Write log from call site. When messages are written asynchronously, module,
+ * file and func must remain valid until the message is written (string
+ * literals).
+ *
+ * \param site [IN/OUT]         pointer to call site state
+ * \param log_type [IN]         log type (HG_LOG_TYPE_DEBUG, etc)
+ * \param module [IN]           module name
+ * \param file [IN]             file name
+ * \param line [IN]             line number
+ * \param func [IN]             function name
+ * \param format [IN]           string format
+ */
+HG_UTIL_EXPORT void
+hg_log_write_site(struct hg_log_site *site, hg_log_type_t log_type,
+    const char *module, const char *file, unsigned int line, const char *func,
+    const char *format, ...);
+
 #ifdef __cplusplus
 }
 #endif
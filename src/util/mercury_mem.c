@@ -118,7 +118,10 @@ hg_mem_shm_map(const char *name, size_t size, hg_util_bool_t create)
 
     fd = shm_open(name, flags, S_IRUSR | S_IWUSR);
     if (fd < 0) {
-        HG_UTIL_LOG_ERROR("shm_open() failed (%s)", strerror(errno));
+        int err = errno;
+
+        HG_UTIL_LOG_ERROR("shm_open() failed (%s)", strerror(err));
+        errno = err; /* Callers may check for ENOENT */
         ret = HG_UTIL_FAIL;
         goto done;
     }
@@ -58,6 +58,7 @@ hg_mem_aligned_free(void *mem_ptr);
  * \param create [IN]           create file if not existing
  *
  * \return a pointer to the mapped memory region, or NULL in case of failure
+ * (errno is ENOENT if the file does not exist and create is not set)
  */
 void *
 hg_mem_shm_map(const char *name, size_t size, hg_util_bool_t create);
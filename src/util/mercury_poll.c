@@ -9,13 +9,27 @@
  */
 
 #include "mercury_poll.h"
+#include "mercury_atomic.h"
 #include "mercury_list.h"
+#include "mercury_time.h"
 #include "mercury_util_error.h"
 
 #include <stdlib.h>
 
 #define HG_POLL_MAX_EVENTS 64 /* TODO Make this configurable */
 
+/* Elapsed time in microseconds */
+#define HG_POLL_USEC(t1, t2) \
+    ((hg_util_int64_t) (hg_time_to_double(hg_time_subtract(t2, t1)) \
+        * 1000000.0))
+
+/* Read the clock around blocking calls only when someone accounts for it */
+#ifdef HG_UTIL_HAS_STATS
+# define HG_POLL_TIMED(wait_time) HG_UTIL_TRUE
+#else
+# define HG_POLL_TIMED(wait_time) (wait_time != NULL)
+#endif
+
 #if defined(_WIN32)
 /* TODO */
 #else
@@ -56,8 +70,29 @@ struct hg_poll_set {
     struct pollfd *poll_fds;
 #endif
     HG_LIST_HEAD(hg_poll_data) poll_data_list;
+#ifdef HG_UTIL_HAS_STATS
+    hg_atomic_int64_t wait_count;
+    hg_atomic_int64_t wait_time;
+#endif
 };
 
+/*---------------------------------------------------------------------------*/
+static HG_UTIL_INLINE void
+hg_poll_acct(struct hg_poll_set *poll_set, hg_util_uint64_t *wait_time,
+    hg_time_t t1, hg_time_t t2)
+{
+    hg_util_int64_t usec = HG_POLL_USEC(t1, t2);
+
+#ifdef HG_UTIL_HAS_STATS
+    hg_atomic_incr64(&poll_set->wait_count);
+    hg_atomic_add64(&poll_set->wait_time, usec);
+#else
+    (void) poll_set;
+#endif
+    if (wait_time)
+        *wait_time += (hg_util_uint64_t) usec;
+}
+
 /*---------------------------------------------------------------------------*/
 hg_poll_set_t *
 hg_poll_create(void)
@@ -78,6 +113,10 @@ hg_poll_create(void)
     HG_LIST_INIT(&hg_poll_set->poll_data_list);
     hg_poll_set->nfds = 0;
     hg_poll_set->try_wait_cb = NULL;
+#ifdef HG_UTIL_HAS_STATS
+    hg_atomic_init64(&hg_poll_set->wait_count, 0);
+    hg_atomic_init64(&hg_poll_set->wait_time, 0);
+#endif
 #if defined(HG_UTIL_HAS_SYSEPOLL_H)
     ret = epoll_create1(0);
     if (ret == -1) {
@@ -398,6 +437,15 @@ int
 hg_poll_wait(hg_poll_set_t *poll_set, unsigned int timeout,
     hg_util_bool_t *progressed)
 {
+    return hg_poll_wait_timed(poll_set, timeout, progressed, NULL);
+}
+
+/*---------------------------------------------------------------------------*/
+int
+hg_poll_wait_timed(hg_poll_set_t *poll_set, unsigned int timeout,
+    hg_util_bool_t *progressed, hg_util_uint64_t *wait_time)
+{
+    hg_util_bool_t timed = HG_POLL_TIMED(wait_time);
     hg_util_bool_t poll_progressed = HG_UTIL_FALSE;
     int ret = HG_UTIL_SUCCESS;
 
@@ -413,9 +461,16 @@ hg_poll_wait(hg_poll_set_t *poll_set, unsigned int timeout,
 
 #elif defined(HG_UTIL_HAS_SYSEPOLL_H)
         struct epoll_event events[HG_POLL_MAX_EVENTS];
+        hg_time_t t1, t2;
         int nfds, i;
 
+        if (timed)
+            hg_time_get_current(&t1);
         nfds = epoll_wait(poll_set->fd, events, HG_POLL_MAX_EVENTS, (int) timeout);
+        if (timed) {
+            hg_time_get_current(&t2);
+            hg_poll_acct(poll_set, wait_time, t1, t2);
+        }
         if (nfds == -1 && errno != EINTR) {
             HG_UTIL_LOG_ERROR("epoll_wait() failed (%s)", strerror(errno));
             ret = HG_UTIL_FAIL;
@@ -447,6 +502,7 @@ hg_poll_wait(hg_poll_set_t *poll_set, unsigned int timeout,
         struct kevent events[HG_POLL_MAX_EVENTS];
         int nfds, i;
         struct timespec timeout_spec;
+        hg_time_t t1, t2;
         ldiv_t ld;
 
         /* Get sec / nsec */
@@ -454,8 +510,14 @@ hg_poll_wait(hg_poll_set_t *poll_set, unsigned int timeout,
         timeout_spec.tv_sec = ld.quot;
         timeout_spec.tv_nsec = ld.rem * 1000000L;
 
+        if (timed)
+            hg_time_get_current(&t1);
         nfds = kevent(poll_set->fd, NULL, 0, events, HG_POLL_MAX_EVENTS,
             &timeout_spec);
+        if (timed) {
+            hg_time_get_current(&t2);
+            hg_poll_acct(poll_set, wait_time, t1, t2);
+        }
         if (nfds == -1 && errno != EINTR) {
             HG_UTIL_LOG_ERROR("kevent() failed (%s)", strerror(errno));
             ret = HG_UTIL_FAIL;
@@ -485,6 +547,7 @@ hg_poll_wait(hg_poll_set_t *poll_set, unsigned int timeout,
         }
 #else
         struct hg_poll_data *hg_poll_data = NULL;
+        hg_time_t t1, t2;
         int nfds;
         unsigned int i;
 
@@ -492,7 +555,13 @@ hg_poll_wait(hg_poll_set_t *poll_set, unsigned int timeout,
         for (i = 0; i < poll_set->nfds; i++)
             poll_set->poll_fds[i].revents = 0;
 
+        if (timed)
+            hg_time_get_current(&t1);
         nfds = poll(poll_set->poll_fds, poll_set->nfds, (int) timeout);
+        if (timed) {
+            hg_time_get_current(&t2);
+            hg_poll_acct(poll_set, wait_time, t1, t2);
+        }
         if (nfds == -1 && errno != EINTR) {
             HG_UTIL_LOG_ERROR("poll() failed (%s)", strerror(errno));
             ret = HG_UTIL_FAIL;
@@ -555,3 +624,34 @@ hg_poll_wait(hg_poll_set_t *poll_set, unsigned int timeout,
 done:
     return ret;
 }
+
+/*---------------------------------------------------------------------------*/
+int
+hg_poll_get_stats(hg_poll_set_t *poll_set, struct hg_poll_stats *stats)
+{
+    int ret = HG_UTIL_SUCCESS;
+
+    if (!poll_set) {
+        HG_UTIL_LOG_ERROR("NULL poll set");
+        ret = HG_UTIL_FAIL;
+        goto done;
+    }
+    if (!stats) {
+        HG_UTIL_LOG_ERROR("NULL pointer to stats");
+        ret = HG_UTIL_FAIL;
+        goto done;
+    }
+
+#ifdef HG_UTIL_HAS_STATS
+    stats->wait_count =
+        (hg_util_uint64_t) hg_atomic_get64(&poll_set->wait_count);
+    stats->wait_time =
+        (hg_util_uint64_t) hg_atomic_get64(&poll_set->wait_time);
+#else
+    stats->wait_count = 0;
+    stats->wait_time = 0;
+#endif
+
+done:
+    return ret;
+}
@@ -43,6 +43,14 @@ typedef hg_util_bool_t (*hg_poll_try_wait_cb_t)(void *arg);
 typedef int (*hg_poll_cb_t)(void *arg, unsigned int timeout,
     hg_util_bool_t *progressed);
 
+/**
+ * Poll set accounting, times in microseconds.
+ */
+struct hg_poll_stats {
+    hg_util_uint64_t wait_count;    /* Number of blocking system poll calls */
+    hg_util_uint64_t wait_time;     /* Time spent in blocking system poll calls */
+};
+
 /**
  * Polling events.
  */
@@ -140,6 +148,37 @@ HG_UTIL_EXPORT int
 hg_poll_wait(hg_poll_set_t *poll_set, unsigned int timeout,
     hg_util_bool_t *progressed);
 
+/**
+ * Same as hg_poll_wait() but also add to wait_time the time (in
+ * microseconds) that this call spent blocked in the system dependent polling
+ * function, so that callers sharing a poll set can account for their own
+ * waits.
+ *
+ * \param poll_set [IN]         pointer to poll set
+ * \param timeout [IN]          timeout (in milliseconds)
+ * \param progressed [OUT]      pointer to boolean indicating progress made
+ * \param wait_time [IN/OUT]    pointer to accumulated wait time (may be NULL)
+ *
+ * \return Non-negative on success or negative on failure
+ */
+HG_UTIL_EXPORT int
+hg_poll_wait_timed(hg_poll_set_t *poll_set, unsigned int timeout,
+    hg_util_bool_t *progressed, hg_util_uint64_t *wait_time);
+
+/**
+ * Get accounting of time spent blocked in the system dependent polling
+ * function (e.g., epoll_wait()) since the poll set was created. Time spent
+ * in polling callbacks is not included. Counters are only maintained when
+ * built with HG_UTIL_HAS_STATS, they are zero otherwise.
+ *
+ * \param poll_set [IN]         pointer to poll set
+ * \param stats [OUT]           pointer to returned stats
+ *
+ * \return Non-negative on success or negative on failure
+ */
+HG_UTIL_EXPORT int
+hg_poll_get_stats(hg_poll_set_t *poll_set, struct hg_poll_stats *stats);
+
 #ifdef __cplusplus
 }
 #endif
@@ -9,61 +9,225 @@
  */
 
 #include "mercury_thread_pool.h"
+#include "mercury_atomic_queue.h"
 #include "mercury_thread_condition.h"
 #include "mercury_util_error.h"
 
+#ifdef HG_UTIL_HAS_LINUX_FUTEX_H
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+#include <limits.h>
 #include <stdlib.h>
 
+/****************/
+/* Local Macros */
+/****************/
+
+/* Size of per-worker queues (must be a power of 2) */
+#define HG_THREAD_POOL_QUEUE_SIZE 1024
+
+/* Number of times a worker looks for work before yielding, and then before
+ * parking */
+#define HG_THREAD_POOL_SPIN_COUNT 100
+#define HG_THREAD_POOL_YIELD_COUNT 10
+
+#ifdef HG_UTIL_HAS_LINUX_FUTEX_H
+/* Futex word of atomic (cast through integer to drop _Atomic qualifier) */
+#define HG_THREAD_POOL_FUTEX(ptr) ((int *) (uintptr_t) (ptr))
+#endif
+
+/************************************/
+/* Local Type and Struct Definition */
+/************************************/
+
+struct hg_thread_pool_worker {
+    struct hg_atomic_queue *queue;      /* Local queue */
+    hg_thread_pool_t *pool;
+    unsigned int index;
+    hg_thread_t thread;
+    hg_util_bool_t started;
+};
+
+/* Work is posted to the local queue of the posting worker, or of the next
+ * worker if posted from outside the pool. Workers pop their own queue first
+ * and then other workers' queues. Work only goes through the mutex-protected
+ * overflow queue when local queues are full. Idle workers spin for a while
+ * and then park on an event count (futex if available). Posts count
+ * themselves in flight before checking the closing flag, destroy sets that
+ * flag before waiting for the count to drain and only then tells workers to
+ * exit, so that no work is enqueued after the final drain. */
 struct hg_thread_pool {
-    unsigned int sleeping_worker_count;
+    struct hg_thread_pool_worker *workers;
     unsigned int thread_count;
-    hg_thread_t *threads;
-    HG_QUEUE_HEAD(hg_thread_work) queue;
-    int shutdown;
-    hg_thread_mutex_t mutex;
+    hg_thread_key_t key;                /* Worker of calling thread */
+    hg_atomic_int32_t next;             /* Round-robin worker index */
+    hg_atomic_int32_t seq;              /* Event count, bumped to wake up */
+    hg_atomic_int32_t sleeping;         /* Parked worker count */
+    hg_atomic_int32_t overflow_count;
+    hg_atomic_int32_t posting;          /* Posts in flight */
+    hg_atomic_int32_t closing;          /* Posts are rejected */
+    hg_atomic_int32_t shutdown;         /* Workers exit once drained */
+    HG_QUEUE_HEAD(hg_thread_work) overflow;
+    hg_thread_mutex_t mutex;            /* Overflow queue / parking mutex */
+#ifndef HG_UTIL_HAS_LINUX_FUTEX_H
     hg_thread_cond_t cond;
+#endif
 };
 
+/********************/
+/* Local Prototypes */
+/********************/
+
+/**
+ * Get next work for worker.
+ */
+static struct hg_thread_work *
+hg_thread_pool_get_work(struct hg_thread_pool_worker *worker);
+
+/**
+ * Park calling worker until seq changes.
+ */
+static void
+hg_thread_pool_park(hg_thread_pool_t *pool, hg_util_int32_t seq);
+
+/**
+ * Wake up count parked workers.
+ */
+static void
+hg_thread_pool_wake(hg_thread_pool_t *pool, int count);
+
 /**
  * Worker thread run by the thread pool
  */
 static HG_THREAD_RETURN_TYPE
+hg_thread_pool_worker(void *args);
+
+/*---------------------------------------------------------------------------*/
+static struct hg_thread_work *
+hg_thread_pool_get_work(struct hg_thread_pool_worker *worker)
+{
+    hg_thread_pool_t *pool = worker->pool;
+    struct hg_thread_work *work;
+    unsigned int i;
+
+    work = (struct hg_thread_work *) hg_atomic_queue_pop_mc(worker->queue);
+    if (work)
+        goto done;
+
+    for (i = 1; i < pool->thread_count; i++) {
+        work = (struct hg_thread_work *) hg_atomic_queue_pop_mc(
+            pool->workers[(worker->index + i) % pool->thread_count].queue);
+        if (work)
+            goto done;
+    }
+
+    if (hg_atomic_get32(&pool->overflow_count) > 0) {
+        hg_thread_mutex_lock(&pool->mutex);
+        work = HG_QUEUE_FIRST(&pool->overflow);
+        if (work) {
+            HG_QUEUE_POP_HEAD(&pool->overflow, entry);
+            hg_atomic_decr32(&pool->overflow_count);
+        }
+        hg_thread_mutex_unlock(&pool->mutex);
+    }
+
+done:
+    return work;
+}
+
+/*---------------------------------------------------------------------------*/
+static void
+hg_thread_pool_park(hg_thread_pool_t *pool, hg_util_int32_t seq)
+{
+#ifdef HG_UTIL_HAS_LINUX_FUTEX_H
+    /* Returns immediately if seq has already changed */
+    syscall(SYS_futex, HG_THREAD_POOL_FUTEX(&pool->seq), FUTEX_WAIT_PRIVATE,
+        seq, NULL, NULL, 0);
+#else
+    hg_thread_mutex_lock(&pool->mutex);
+    while (hg_atomic_get32(&pool->seq) == seq)
+        hg_thread_cond_wait(&pool->cond, &pool->mutex);
+    hg_thread_mutex_unlock(&pool->mutex);
+#endif
+}
+
+/*---------------------------------------------------------------------------*/
+static void
+hg_thread_pool_wake(hg_thread_pool_t *pool, int count)
+{
+#ifdef HG_UTIL_HAS_LINUX_FUTEX_H
+    hg_atomic_incr32(&pool->seq);
+    syscall(SYS_futex, HG_THREAD_POOL_FUTEX(&pool->seq), FUTEX_WAKE_PRIVATE,
+        count, NULL, NULL, 0);
+#else
+    hg_thread_mutex_lock(&pool->mutex);
+    hg_atomic_incr32(&pool->seq);
+    if (count == 1)
+        hg_thread_cond_signal(&pool->cond);
+    else
+        hg_thread_cond_broadcast(&pool->cond);
+    hg_thread_mutex_unlock(&pool->mutex);
+#endif
+}
+
+/*---------------------------------------------------------------------------*/
+static HG_THREAD_RETURN_TYPE
 hg_thread_pool_worker(void *args)
 {
     hg_thread_ret_t ret = 0;
-    hg_thread_pool_t *pool = (hg_thread_pool_t*) args;
+    struct hg_thread_pool_worker *worker =
+        (struct hg_thread_pool_worker *) args;
+    hg_thread_pool_t *pool = worker->pool;
     struct hg_thread_work *work;
+    unsigned int spin = 0;
 
-    while (1) {
-        hg_thread_mutex_lock(&pool->mutex);
+    hg_thread_setspecific(pool->key, worker);
 
-        /* If not shutting down and nothing to do, worker sleeps */
-        while (!pool->shutdown && HG_QUEUE_IS_EMPTY(&pool->queue)) {
-            pool->sleeping_worker_count++;
-            if (hg_thread_cond_wait(&pool->cond, &pool->mutex) != HG_UTIL_SUCCESS) {
-                HG_UTIL_LOG_ERROR("Thread cannot wait on condition variable");
-                goto unlock;
-            }
-            pool->sleeping_worker_count--;
+    while (1) {
+        hg_util_int32_t seq;
+
+        work = hg_thread_pool_get_work(worker);
+        if (work) {
+            /* Get to work */
+            (*work->func)(work->args);
+            spin = 0;
+            continue;
         }
 
-        if (pool->shutdown && HG_QUEUE_IS_EMPTY(&pool->queue)) {
-            goto unlock;
+        /* Only exit once all work has been executed, posts completed before
+         * shutdown was set are visible at this point */
+        if (hg_atomic_get32(&pool->shutdown)) {
+            hg_atomic_fence();
+            work = hg_thread_pool_get_work(worker);
+            if (!work)
+                break;
+            (*work->func)(work->args);
+            continue;
         }
 
-        /* Grab our task */
-        work = HG_QUEUE_FIRST(&pool->queue);
-        HG_QUEUE_POP_HEAD(&pool->queue, entry);
-
-        /* Unlock */
-        hg_thread_mutex_unlock(&pool->mutex);
+        if (spin < HG_THREAD_POOL_SPIN_COUNT + HG_THREAD_POOL_YIELD_COUNT) {
+            if (spin++ < HG_THREAD_POOL_SPIN_COUNT) {
+                cpu_spinwait();
+            } else
+                hg_thread_yield();
+            continue;
+        }
 
-        /* Get to work */
-        (*work->func)(work->args);
+        /* Sleeping count is incremented before checking for work again so
+         * that post either sees a parked worker or the worker sees the work */
+        seq = hg_atomic_get32(&pool->seq);
+        hg_atomic_incr32(&pool->sleeping);
+        work = hg_thread_pool_get_work(worker);
+        if (!work && !hg_atomic_get32(&pool->shutdown))
+            hg_thread_pool_park(pool, seq);
+        hg_atomic_decr32(&pool->sleeping);
+        if (work)
+            (*work->func)(work->args);
+        spin = 0;
     }
 
-unlock:
-    hg_thread_mutex_unlock(&pool->mutex);
     hg_thread_exit(ret);
     return ret;
 }
@@ -76,8 +240,8 @@ hg_thread_pool_init(unsigned int thread_count, hg_thread_pool_t **pool)
     hg_thread_pool_t *priv_pool = NULL;
     unsigned int i;
 
-    if (!pool) {
-        HG_UTIL_LOG_ERROR("Cannot pass NULL pointer");
+    if (!pool || !thread_count) {
+        HG_UTIL_LOG_ERROR("Invalid parameters");
         ret = HG_UTIL_FAIL;
         goto done;
     }
@@ -88,38 +252,71 @@ hg_thread_pool_init(unsigned int thread_count, hg_thread_pool_t **pool)
         ret = HG_UTIL_FAIL;
         goto done;
     }
-    priv_pool->sleeping_worker_count = 0;
     priv_pool->thread_count = thread_count;
-    priv_pool->threads = NULL;
-    HG_QUEUE_INIT(&priv_pool->queue);
-    priv_pool->shutdown = 0;
-
+    priv_pool->workers = NULL;
+    hg_atomic_init32(&priv_pool->next, 0);
+    hg_atomic_init32(&priv_pool->seq, 0);
+    hg_atomic_init32(&priv_pool->sleeping, 0);
+    hg_atomic_init32(&priv_pool->overflow_count, 0);
+    hg_atomic_init32(&priv_pool->posting, 0);
+    hg_atomic_init32(&priv_pool->closing, 0);
+    hg_atomic_init32(&priv_pool->shutdown, 0);
+    HG_QUEUE_INIT(&priv_pool->overflow);
+
+    if (hg_thread_key_create(&priv_pool->key) != HG_UTIL_SUCCESS) {
+        HG_UTIL_LOG_ERROR("Could not create thread key");
+        free(priv_pool);
+        priv_pool = NULL;
+        ret = HG_UTIL_FAIL;
+        goto done;
+    }
     if (hg_thread_mutex_init(&priv_pool->mutex) != HG_UTIL_SUCCESS) {
         HG_UTIL_LOG_ERROR("Could not initialize mutex");
         ret = HG_UTIL_FAIL;
         goto done;
     }
+#ifndef HG_UTIL_HAS_LINUX_FUTEX_H
     if (hg_thread_cond_init(&priv_pool->cond) != HG_UTIL_SUCCESS) {
         HG_UTIL_LOG_ERROR("Could not initialize thread condition");
         ret = HG_UTIL_FAIL;
         goto done;
     }
+#endif
 
-    priv_pool->threads = (hg_thread_t*) malloc(thread_count * sizeof(hg_thread_t));
-    if (!priv_pool->threads) {
+    priv_pool->workers = (struct hg_thread_pool_worker *) calloc(thread_count,
+        sizeof(struct hg_thread_pool_worker));
+    if (!priv_pool->workers) {
         HG_UTIL_LOG_ERROR("Could not allocate thread pool array");
         ret = HG_UTIL_FAIL;
         goto done;
     }
 
+    /* Allocate all queues before starting workers as they pop from each
+     * other's queue */
+    for (i = 0; i < thread_count; i++) {
+        struct hg_thread_pool_worker *worker = &priv_pool->workers[i];
+
+        worker->pool = priv_pool;
+        worker->index = i;
+        worker->queue = hg_atomic_queue_alloc(HG_THREAD_POOL_QUEUE_SIZE);
+        if (!worker->queue) {
+            HG_UTIL_LOG_ERROR("Could not allocate worker queue");
+            ret = HG_UTIL_FAIL;
+            goto done;
+        }
+    }
+
     /* Start worker threads */
     for (i = 0; i < thread_count; i++) {
-        if (hg_thread_create(&priv_pool->threads[i], hg_thread_pool_worker,
-                (void*) priv_pool) != HG_UTIL_SUCCESS) {
+        struct hg_thread_pool_worker *worker = &priv_pool->workers[i];
+
+        if (hg_thread_create(&worker->thread, hg_thread_pool_worker,
+                (void*) worker) != HG_UTIL_SUCCESS) {
             HG_UTIL_LOG_ERROR("Could not create thread");
             ret = HG_UTIL_FAIL;
             goto done;
         }
+        worker->started = HG_UTIL_TRUE;
     }
 
     *pool = priv_pool;
@@ -143,42 +340,44 @@ hg_thread_pool_destroy(hg_thread_pool_t *pool)
 
     if (!pool) goto done;
 
-    if (pool->threads) {
-        hg_thread_mutex_lock(&pool->mutex);
-
-        pool->shutdown = 1;
-
-        if (hg_thread_cond_broadcast(&pool->cond) != HG_UTIL_SUCCESS) {
-            HG_UTIL_LOG_ERROR("Could not broadcast condition signal");
-            ret = HG_UTIL_FAIL;
-        }
-
-        hg_thread_mutex_unlock(&pool->mutex);
-
-        if (ret != HG_UTIL_SUCCESS) goto done;
-
-        for(i = 0; i < pool->thread_count; i++) {
-            if (hg_thread_join(pool->threads[i]) != HG_UTIL_SUCCESS) {
+    if (pool->workers) {
+        /* Later posts fail, wait for posts in progress */
+        hg_atomic_set32(&pool->closing, 1);
+        hg_atomic_fence();
+        while (hg_atomic_get32(&pool->posting))
+            hg_thread_yield();
+        hg_atomic_fence();
+        hg_atomic_set32(&pool->shutdown, 1);
+        hg_thread_pool_wake(pool, INT_MAX);
+
+        for (i = 0; i < pool->thread_count; i++) {
+            if (pool->workers[i].started
+                && hg_thread_join(pool->workers[i].thread) != HG_UTIL_SUCCESS) {
                 HG_UTIL_LOG_ERROR("Could not join thread");
                 ret = HG_UTIL_FAIL;
                 goto done;
             }
         }
-    }
 
-    free(pool->threads);
-    pool->threads = NULL;
+        for (i = 0; i < pool->thread_count; i++)
+            hg_atomic_queue_free(pool->workers[i].queue);
+        free(pool->workers);
+        pool->workers = NULL;
+    }
 
     if (hg_thread_mutex_destroy(&pool->mutex) != HG_UTIL_SUCCESS) {
         HG_UTIL_LOG_ERROR("Could not destroy mutex");
         ret = HG_UTIL_FAIL;
         goto done;
     }
+#ifndef HG_UTIL_HAS_LINUX_FUTEX_H
     if (hg_thread_cond_destroy(&pool->cond) != HG_UTIL_SUCCESS){
         HG_UTIL_LOG_ERROR("Could not destroy thread condition");
         ret = HG_UTIL_FAIL;
         goto done;
     }
+#endif
+    hg_thread_key_delete(pool->key);
 
     free(pool);
 
@@ -190,6 +389,8 @@ done:
 int
 hg_thread_pool_post(hg_thread_pool_t *pool, struct hg_thread_work *work)
 {
+    struct hg_thread_pool_worker *worker;
+    unsigned int index, i;
     int ret = HG_UTIL_SUCCESS;
 
     if (!pool) {
@@ -210,28 +411,42 @@ hg_thread_pool_post(hg_thread_pool_t *pool, struct hg_thread_work *work)
         goto done;
     }
 
-    hg_thread_mutex_lock(&pool->mutex);
-
-    /* Are we shutting down ? */
-    if (pool->shutdown) {
+    /* Are we shutting down ? Post is counted before checking, so that
+     * destroy either makes it fail or waits until work is enqueued */
+    hg_atomic_incr32(&pool->posting);
+    hg_atomic_fence();
+    if (hg_atomic_get32(&pool->closing)) {
+        hg_atomic_decr32(&pool->posting);
         HG_UTIL_LOG_ERROR("Pool is shutting down");
         ret = HG_UTIL_FAIL;
-        goto unlock;
+        goto done;
     }
 
-    /* Add task to task queue */
-    HG_QUEUE_PUSH_TAIL(&pool->queue, work, entry);
-
-    /* Wake up sleeping worker */
-    if (pool->sleeping_worker_count) {
-        if (hg_thread_cond_signal(&pool->cond) != HG_UTIL_SUCCESS) {
-            HG_UTIL_LOG_ERROR("Cannot signal pool condition");
-            ret = HG_UTIL_FAIL;
-        }
+    /* Add task to local queue of calling worker or of next worker */
+    worker = (struct hg_thread_pool_worker *) hg_thread_getspecific(pool->key);
+    if (!worker)
+        index = (unsigned int) hg_atomic_incr32(&pool->next);
+    else
+        index = worker->index;
+    for (i = 0; i < pool->thread_count; i++) {
+        /* Fall back to other workers' queues if full */
+        if (hg_atomic_queue_push(
+            pool->workers[(index + i) % pool->thread_count].queue, work)
+            == HG_UTIL_SUCCESS)
+            break;
+    }
+    if (i == pool->thread_count) {
+        hg_thread_mutex_lock(&pool->mutex);
+        HG_QUEUE_PUSH_TAIL(&pool->overflow, work, entry);
+        hg_atomic_incr32(&pool->overflow_count);
+        hg_thread_mutex_unlock(&pool->mutex);
     }
 
-unlock:
-    hg_thread_mutex_unlock(&pool->mutex);
+    /* Wake up parked worker */
+    hg_atomic_fence();
+    hg_atomic_decr32(&pool->posting);
+    if (hg_atomic_get32(&pool->sleeping) > 0)
+        hg_thread_pool_wake(pool, 1);
 
 done:
     return ret;